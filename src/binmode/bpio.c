@@ -111,8 +111,8 @@ static const struct bpio_mode_handlers_t bpio_mode_handlers[count_of(modes)] = {
         .bpio_handler = NULL, //bpio_hw3wire_transaction
     },
     [DIO]={
-        .bpio_configure = NULL,
-        .bpio_handler = NULL, //bpio_dio_transaction
+        .bpio_configure = bpio_dio_configure,
+        .bpio_handler = bpio_dio_transaction
     },
     [HWLED]={
         .bpio_configure = bpio_led_configure,
@@ -120,8 +120,8 @@ static const struct bpio_mode_handlers_t bpio_mode_handlers[count_of(modes)] = {
     },
     //need async handler in some way
     [INFRARED]={
-        .bpio_configure = NULL,
-        .bpio_handler = NULL, //bpio_infrared_transaction
+        .bpio_configure = bpio_infrared_configure,
+        .bpio_handler = bpio_infrared_transaction
     },
     [JTAG]={
         .bpio_configure = NULL,
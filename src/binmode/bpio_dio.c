@@ -1,19 +1,76 @@
 #include <stdio.h>
-#include <stdio.h>
 #include "pico/stdlib.h"
+#include "hardware/clocks.h"
 #include "pirate.h"
 #include "bytecode.h"
 #include "command_struct.h"
 #include "bpio_dio.h"
 #include "bpio_reader.h"
 #include "bpio_transactions.h"
+#include "pirate/bio.h"
+#include "lib/pattern/pattern.h"
+#include "wavegen.h"
+#include "mode/dio.h"
+
+// one BPIO write, played once
+#define BPIO_DIO_MAX_SAMPLES 512
+
+static uint32_t bpio_dio_rate = 1000000;
+
+bool bpio_dio_configure(bpio_mode_configuration_t *bpio_mode_config) {
+    pattern_clock_t clock;
+    // speed is the sample rate of writes, 0 keeps the last one
+    if(bpio_mode_config->speed) {
+        if(!pattern_clock(clock_get_hz(clk_sys), bpio_mode_config->speed, &clock)) {
+            if(bpio_mode_config->debug) printf("[DIO] Sample rate %lu Hz is too high\r\n", bpio_mode_config->speed);
+            return false;
+        }
+        bpio_dio_rate = bpio_mode_config->speed;
+    }
+    return true;
+}
 
 uint32_t bpio_dio_transaction(struct bpio_data_request_t *request, flatbuffers_uint8_vec_t data_write, uint8_t *data_read) {
-    if(request->debug) printf("[DIO] Transaction not implemented\r\n");
-    
-    // TODO: Implement DIO transaction logic
-    (void)data_write;  // Suppress unused parameter warning
-    (void)data_read;   // Suppress unused parameter warning
-    
+    if(request->debug) printf("[DIO] Performing transaction\r\n");
+
+    // WRITE: the bytes are vectors, played on the IO pins at the configured rate
+    if(request->bytes_write > 0) {
+        static uint32_t words[BPIO_DIO_MAX_SAMPLES / 4];
+        pattern_layout_t layout;
+        pattern_clock_t clock;
+        if(!pattern_layout(request->bytes_write, 1, sizeof(words), &layout) ||
+           !pattern_clock(clock_get_hz(clk_sys), bpio_dio_rate, &clock)) {
+            return true;
+        }
+        uint8_t mask = wavegen_pins(-1);
+        if(!mask || !wavegen_init()) {
+            if(request->debug) printf("[DIO] No IO pins or DMA channels\r\n");
+            return true;
+        }
+        if(request->debug) printf("[DIO] Writing %d samples at %lu Hz\r\n", request->bytes_write, bpio_dio_rate);
+        pattern_fill((uint8_t *)words, (const uint8_t *)data_write, &layout);
+        bool ok = wavegen_start(words, layout.bytes / 4, false, &clock, mask, 0, WAVEGEN_TRIGGER_NONE);
+        while(ok && wavegen_poll()) {
+            tight_loop_contents();
+        }
+        uint8_t levels = wavegen_stop();
+        uint32_t underruns = wavegen_underruns();
+        wavegen_cleanup();
+        dio_label_outputs(mask, levels);
+        if(!ok || underruns) {
+            if(request->debug) printf("[DIO] %s\r\n", ok ? "Output stalled" : "No room for the PIO program");
+            return true;
+        }
+    }
+
+    // READ: the IO pins, once per byte
+    for(uint32_t i = 0; i < request->bytes_read; i++) {
+        uint8_t data = 0;
+        for(uint8_t j = 0; j < 8; j++) {
+            data |= bio_get(j) << j;
+        }
+        data_read[i] = data;
+    }
+
     return false;
-}
\ No newline at end of file
+}
@@ -14,8 +14,17 @@
 // Forward declaration of the request structure (defined in bpio_transactions.h)
 struct bpio_data_request_t;
 
+/**
+ * @brief Configure DIO mode for BPIO.
+ * @param bpio_mode_config  speed is the sample rate of pattern writes in Hz
+ * @return                  false if the rate is above the system clock
+ */
+bool bpio_dio_configure(bpio_mode_configuration_t *bpio_mode_config);
+
 /**
  * @brief Perform a DIO (Digital I/O) transaction.
+ * @details Written bytes are vectors played once on the IO pins by the
+ *          pattern generator, read bytes are the IO pin levels.
  * @param request     Transaction request structure containing debug flags, byte counts, and control flags
  * @param data_write  Flatbuffer vector containing data to write
  * @param data_read   Buffer to store read data
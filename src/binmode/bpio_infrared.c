@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "pirate.h"
 #include "bytecode.h"
@@ -6,17 +7,62 @@
 #include "bpio_reader.h"
 #include "bpio_infrared.h"
 #include "bpio_transactions.h"
+#include "mode/infrared.h"
+#include "pirate/bio.h"
+#include "pirate/irio_pio.h"
+#include "lib/ir_frame/ir_frame.h"
+#include "commands/infrared/irtxrx.h"
+
+#define BPIO_INFRARED_MAX_PAIRS 128
 
 bool bpio_infrared_configure(bpio_mode_configuration_t *bpio_mode_config) {
-    // TODO: Implement Infrared configuration if needed
+    // protocol, sensor and carrier are set up by infrared_setup_exc()
     return true;
 }
 
+// data_write is one aIR packet ($38:900,1800,...;) sent as is, or the name of
+// a file saved by irrx (.irf or .air) that is replayed whole
 uint32_t bpio_infrared_transaction(struct bpio_data_request_t *request, flatbuffers_uint8_vec_t data_write, uint8_t *data_read) {
     if(request->debug) printf("[INFRARED] Performing transaction\r\n");
-    
-    // TODO: Implement Infrared transaction logic
-    // This is a placeholder implementation
-    
-    return 0;
+
+    if(request->bytes_write == 0) {
+        return 0;
+    }
+
+    const char *data = (const char *)data_write;
+    uint32_t pairs[BPIO_INFRARED_MAX_PAIRS];
+    uint32_t count;
+    uint8_t khz;
+    char file[13];
+    bool ok = true;
+
+    if(data[0] != '$') {
+        if(request->bytes_write >= sizeof(file)) {
+            if(request->debug) printf("[INFRARED] File name too long\r\n");
+            return 1;
+        }
+        memcpy(file, data, request->bytes_write);
+        file[request->bytes_write] = 0x00;
+    } else {
+        ir_air_status_t status = ir_air_parse(data, request->bytes_write, &khz, pairs, count_of(pairs), &count);
+        if(status != IR_AIR_OK) {
+            if(request->debug) printf("[INFRARED] %s\r\n", ir_air_error_str(status));
+            return 1;
+        }
+    }
+
+    // the protocol TX program is swapped for the raw one while sending
+    infrared_cleanup_temp();
+    irio_pio_tx_init(bio2bufiopin[BIO4], 38000);
+    if(data[0] != '$') {
+        if(request->debug) printf("[INFRARED] Replaying file %s\r\n", file);
+        ok = irtx_play_file(file, request->debug);
+    } else {
+        if(request->debug) printf("[INFRARED] Transmitting %d MARK/SPACE pairs at %dkHz\r\n", count, khz);
+        irio_pio_tx_frame_write((float)(khz * 1000), count, pairs);
+    }
+    irio_pio_tx_deinit(bio2bufiopin[BIO4]);
+    infrared_setup_resume();
+
+    return ok ? 0 : 1;
 }
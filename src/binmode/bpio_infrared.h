@@ -24,9 +24,11 @@ bool bpio_infrared_configure(bpio_mode_configuration_t *bpio_mode_config);
 /**
  * @brief Handle Infrared transaction.
  * @param request     Data request structure
+ * @details data_write is an aIR packet ($38:900,1800,...;) or the name of
+ *          a file saved by irrx (.irf or .air) to replay.
  * @param data_write  Data to write
  * @param data_read   Buffer for read data
- * @return            Number of bytes read
+ * @return            0 on success, non-zero on failure
  */
 uint32_t bpio_infrared_transaction(struct bpio_data_request_t *request, flatbuffers_uint8_vec_t data_write, uint8_t *data_read);
 
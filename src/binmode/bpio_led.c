@@ -11,6 +11,7 @@
 #include "ui/ui_format.h"
 #include "hardware/pio.h"
 #include "pio_config.h"
+#include "lib/led_frame/led_frame.h"
 
 // External references from hwled.c
 extern led_mode_config_t hwled_mode_config;
@@ -43,21 +44,39 @@ uint32_t bpio_led_transaction(struct bpio_data_request_t *request, flatbuffers_u
         led_devices[device].start();
     }
     
-    // Handle WRITE using device-specific function
+    // Handle WRITE: pack whole pixels and DMA them, packing the next chunk while one is sent
     if(request->bytes_write > 0) {
         const uint8_t *data = (const uint8_t *)data_write;
+        static uint32_t words[2][64];
         
         if(request->debug) printf("[LED] Writing %d bytes\r\n", request->bytes_write);
         
-        // All LED devices require 32-bit packed values:
-        // WS2812/ONBOARD: 3 bytes per pixel (RGB) - packed in lower 24 bits
+        // WS2812/ONBOARD: 3 bytes per pixel (RGB) - packed in the top 24 bits
         // APA102: 4 bytes per pixel (brightness + RGB) - packed in full 32 bits
         uint32_t bytes_per_pixel = (device == M_LED_APA102) ? 4 : 3;
-        uint32_t i = 0;
+        led_frame_format_t format = {
+            .device = (device == M_LED_APA102) ? LED_FRAME_APA102 : LED_FRAME_WS2812,
+            .channels = bytes_per_pixel,
+            .lut = NULL,
+        };
+        uint32_t pixels = request->bytes_write / bytes_per_pixel;
+        uint8_t cur = 0;
         
-        while(i < request->bytes_write) {
+        hwled_frame_begin(false); // falls back to pixel writes if there is no DMA channel
+        for(uint32_t i = 0; i < pixels; i += count_of(words[0])) {
+            uint32_t count = MIN(pixels - i, count_of(words[0]));
+            led_frame_pack(&format, &data[i * bytes_per_pixel], count, words[cur]);
+            hwled_frame_write(words[cur], count);
+            cur ^= 1;
+        }
+        hwled_frame_wait();
+        hwled_frame_end();
+        bytes_written = pixels * bytes_per_pixel;
+        
+        // a partial pixel at the end is sent left aligned, as before
+        uint32_t i = bytes_written;
+        if(i < request->bytes_write) {
             uint32_t color = 0;
-            // Pack bytes into 32-bit value
             for(uint32_t j = 0; j < bytes_per_pixel && i < request->bytes_write; j++) {
                 color |= ((uint32_t)data[i++] << (8 * ((bytes_per_pixel-1) - j)));
             }
@@ -5,6 +5,7 @@
 #include "hardware/uart.h"
 #include "pirate.h"
 #include "pirate/hwuart_pio.h"
+#include "pirate/hwuart_rx.h"
 #include "pirate/bio.h"
 #include "bpio_uart.h"
 #include "bpio_reader.h"
@@ -31,11 +32,11 @@ uint32_t bpio_hwuart_transaction(struct bpio_data_request_t *request, flatbuffer
         if(request->debug) printf("[UART] Reading %d bytes\r\n", request->bytes_read);
         for(uint32_t i = 0; i < request->bytes_read; i++) {
             // Wait for data with timeout (avoid blocking forever)
-            if(!uart_is_readable_within_us(M_UART_PORT, 1000000)) { // 1 second timeout
+            if(!hwuart_rx_wait(1000000)) { // 1 second timeout
                 if(request->debug) printf("[UART] Read timeout at byte %d\r\n", i);
                 return true; // Error - timeout
             }
-            data_read[i] = (uint8_t)uart_getc(M_UART_PORT);
+            hwuart_rx_get(&data_read[i], NULL);
         }
     }
 
@@ -45,29 +46,23 @@ uint32_t bpio_hwuart_transaction(struct bpio_data_request_t *request, flatbuffer
 // UART async handler for BPIO
 // Checks for unsolicited incoming UART data and reads it into buffer
 // Returns number of bytes read (0 if no data available)
-//TODO: UART is dispatched to multiple processes!!!
+// Bytes come from the UART mode receive ring, which holds them while we are busy
 uint32_t bpio_hwuart_async_handler(uint8_t *data_read) {
     // Check if UART has data available
-    if(!uart_is_readable(M_UART_PORT)) {
+    if(!hwuart_rx_get(&data_read[0], NULL)) {
         return 0;
     }
-    
-    // Read first byte
-    data_read[0] = (uint8_t)uart_getc(M_UART_PORT);
     uint32_t bytes_read = 1;
     
     // Wait up to 200us for more data to arrive and batch into single packet
     // Returns immediately if data arrives sooner, improving responsiveness
     // At 115200 baud: ~87us per byte, so typically captures 2-3 bytes
     // At 9600 baud: ~1042us per byte, so may not capture additional bytes
-    // Only wait if FIFO empty - then batch whatever arrives
-    if(!uart_is_readable(M_UART_PORT)) {
-        uart_is_readable_within_us(M_UART_PORT, 200);
-    }
+    hwuart_rx_wait(200);
 
     // Drain all available data
-    while(uart_is_readable(M_UART_PORT) && bytes_read < BPIO_MAX_READ_SIZE) {
-        data_read[bytes_read++] = (uint8_t)uart_getc(M_UART_PORT);
+    while(bytes_read < BPIO_MAX_READ_SIZE && hwuart_rx_get(&data_read[bytes_read], NULL)) {
+        bytes_read++;
     }
     
     return bytes_read;
@@ -13,6 +13,7 @@
 #include "binmode/binmodes.h"
 #include "binmode/logicanalyzer.h"
 #include "binmode/fala.h"
+#include "lib/la_change/la_change.h"
 #include "tusb.h"
 #include "ui/ui_term.h"
 #include "command_struct.h"
@@ -41,6 +42,13 @@ void fala_set_triggers(uint8_t trigger_pin, uint8_t trigger_level) {
 // start the logic analyzer
 void fala_start(void) {
     // configure and arm the logic analyzer
+    if (fala_config.change_capture) {
+        // change only: the buffer holds transitions, not samples, so idle time is free
+        fala_config.actual_sample_frequency =
+            logic_analyzer_configure_change(fala_config.base_frequency * fala_config.oversample, 0, 0);
+        logic_analyzer_arm(false);
+        return;
+    }
     fala_config.actual_sample_frequency = logic_analyzer_configure(
         fala_config.base_frequency * fala_config.oversample, LA_BUFFER_SIZE, 0x00, 0x00, false, false);
     logic_analyzer_arm(false);
@@ -54,6 +62,17 @@ void fala_stop(void) {
 
 // output printed to user terminal
 void fala_print_result(void) {
+    if (logic_analyzer_is_change_capture()) {
+        uint32_t count;
+        const uint32_t* records = logic_analyzer_get_change_records(&count);
+        printf("\r\n%sLogic analyzer:%s %lu transitions in %llu samples\r\n",
+               ui_term_color_info(),
+               ui_term_color_reset(),
+               (unsigned long)la_change_transitions(records, count),
+               (unsigned long long)la_change_total_samples(records, count));
+        return;
+    }
+
     // get samples count
     //uint32_t fala_samples = logic_analyzer_get_end_ptr();
     uint32_t fala_samples = logic_analyzer_get_samples_from_zero();
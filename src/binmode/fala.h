@@ -15,6 +15,7 @@ typedef struct {
     uint32_t oversample;             /**< Oversampling rate */
     uint32_t actual_sample_frequency; /**< Actual sampling frequency */
     uint8_t debug_level;             /**< Debug verbosity level */
+    bool change_capture;             /**< Record pin changes only (see lib/la_change) */
 } FalaConfig;
 
 extern FalaConfig fala_config;
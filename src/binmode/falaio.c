@@ -12,6 +12,7 @@
 #include "binmode/binmodes.h"
 #include "binmode/logicanalyzer.h"
 #include "binmode/fala.h"
+#include "lib/la_change/la_change.h"
 #include "tusb.h"
 #include "ui/ui_term.h"
 
@@ -21,13 +22,25 @@
 // binmode name to display
 const char falaio_name[] = "Follow along logic analyzer";
 
-// send notification packet at end of capture
-void falaio_notify(void) {
-    // get samples count
+// samples available for dump, change captures are expanded on the fly
+static uint32_t falaio_sample_count(void) {
+    if (logic_analyzer_is_change_capture()) {
+        uint32_t count;
+        const uint32_t* records = logic_analyzer_get_change_records(&count);
+        uint64_t total = la_change_total_samples(records, count);
+        return (total > UINT32_MAX) ? UINT32_MAX : (uint32_t)total;
+    }
     uint32_t fala_samples = logic_analyzer_get_samples_from_zero();
-    if(fala_samples > (LA_BUFFER_SIZE)) { //invalid sample count
+    if (fala_samples > (LA_BUFFER_SIZE)) { // invalid sample count
         fala_samples = 0;
     }
+    return fala_samples;
+}
+
+// send notification packet at end of capture
+void falaio_notify(void) {
+    // get samples count
+    uint32_t fala_samples = falaio_sample_count();
     // send notification packet
     //$FALADATA;{pins};{trigger pins};{trigger mask};{edge trigger (bool)}; {capture speed in hz};{samples};{pre-samples
     //(for trigger line)};
@@ -96,9 +109,16 @@ void falaio_cleanup(void) {
 }
 
 static uint32_t fala_dump_count;
+static la_change_reverse_t fala_change_src;
+static la_change_vcd_t fala_vcd;
 
 static uint falaio_tx8(uint8_t* buf, uint len) {
     uint32_t i, count;
+    if (logic_analyzer_is_change_capture()) {
+        count = la_change_reverse_expand(&fala_change_src, buf, MIN(len, fala_dump_count));
+        fala_dump_count = count ? fala_dump_count - count : 0;
+        return count;
+    }
     count = fala_dump_count;
     for (i = 0; i < len && count > 0; i++, count--) {
         logic_analyzer_dump(&buf[i]);
@@ -109,7 +129,8 @@ static uint falaio_tx8(uint8_t* buf, uint len) {
 
 enum fala_statemachine {
     FALA_IDLE = 0,
-    FALA_DUMP
+    FALA_DUMP,
+    FALA_DUMP_VCD
 };
 
 void falaio_service(void) {
@@ -138,9 +159,23 @@ void falaio_service(void) {
                         case '+':
                             // dump the buffer
                             logic_analyzer_reset_ptr(); // put pointer back to end of data buffer (last sample first)
-                            fala_dump_count = logic_analyzer_get_samples_from_zero();
+                            fala_dump_count = falaio_sample_count();
+                            if (logic_analyzer_is_change_capture()) {
+                                uint32_t count;
+                                const uint32_t* records = logic_analyzer_get_change_records(&count);
+                                la_change_reverse_init(&fala_change_src, records, count);
+                            }
                             state = FALA_DUMP;
                             break;
+                        case 'V':
+                            // dump a change capture as VCD text, oldest first
+                            if (logic_analyzer_is_change_capture()) {
+                                uint32_t count;
+                                const uint32_t* records = logic_analyzer_get_change_records(&count);
+                                la_change_vcd_init(&fala_vcd, records, count, fala_config.actual_sample_frequency);
+                                state = FALA_DUMP_VCD;
+                            }
+                            break;
                     }
                 }
             }
@@ -155,5 +190,16 @@ void falaio_service(void) {
                 state = FALA_IDLE;
             }
             break;
+        case FALA_DUMP_VCD:
+            if (tud_cdc_n_write_available(CDC_INTF) >= sizeof(buf)) {
+                uint8_t len = la_change_vcd_fill(&fala_vcd, (char*)buf, sizeof(buf));
+                if (len == 0) {
+                    state = FALA_IDLE;
+                    break;
+                }
+                tud_cdc_n_write(CDC_INTF, buf, len);
+                tud_cdc_n_write_flush(CDC_INTF);
+            }
+            break;
     }
 }
@@ -18,10 +18,18 @@
 #include "pirate/irio_pio.h"
 #include "pirate/bio.h"
 #include "pirate/psu.h"
+#include "pirate/mem.h"
+#include "lib/ir_frame/ir_frame.h"
+#include "command_struct.h"
+#include "commands/infrared/irtxrx.h"
 
 
 #define MAX_UART_PKT 64
 #define CDC_INTF 1
+#define AIR_MAX_PAIRS 2048 //pairs captured into the big buffer
+
+// DMA capture rings and captured pairs, NULL if the big buffer is taken
+static uint8_t* air_mem;
 
 // binmode name to display
 const char irtoy_air_name[] = "AIR capture (AnalysIR, etc)";
@@ -46,6 +54,8 @@ void irtoy_air_setup(void) {
     //psu_enable(5, 0, true);
     irio_pio_tx_init(bio2bufiopin[BIO4], 38000);
     irio_pio_rx_init(bio2bufiopin[BIO5]);
+    air_mem = mem_alloc(IRIO_RX_CAPTURE_MEM + AIR_MAX_PAIRS * sizeof(uint32_t), BP_BIG_BUFFER_IR);
+    irio_pio_rx_capture_start(air_mem);
 }
 
 // binmode cleanup on exit
@@ -53,6 +63,11 @@ void irtoy_air_cleanup(void) {
     system_bio_update_purpose_and_label(false, BIO1, BP_PIN_IO, pin_labels[0]);
     system_bio_update_purpose_and_label(false, BIO4, BP_PIN_IO, pin_labels[1]);
     system_bio_update_purpose_and_label(false, BIO5, BP_PIN_IO, pin_labels[2]);
+    irio_pio_rx_capture_stop();
+    if(air_mem){
+        mem_free(air_mem);
+        air_mem = NULL;
+    }
     irio_pio_rx_deinit(bio2bufiopin[BIO5]);
     irio_pio_tx_deinit(bio2bufiopin[BIO4]);
     //psu_disable();
@@ -64,108 +79,41 @@ void irtoy_air_cleanup(void) {
 #define HARDWARE_VERSION '3'
 #define FIRMWARE_VERSION_H '1'
 #define FIRMWARE_VERSION_L '0'
-enum {
-    AIR_OK = 0,
-    AIR_ERROR_START = 1,
-    AIR_ERROR_LENGTH = 2,
-    AIR_ERROR_MOD_FREQ,
-    AIR_ERROR_DATA,
-};
-/*
-printf("Unable to find start of data ($) in AIR packet\r\n");
-printf("Unable to find modulation frequency (:) in AIR packet\r\n");
-				printf("Unable to find end of MARK data (,) in AIR packet\r\n");
-*/
+
+//the receiver hears our own transmitter, stop it while sending
+static void air_tx_begin(void){
+    irio_pio_rx_capture_stop();
+    irio_pio_rx_deinit(bio2bufiopin[BIO5]);
+}
+
+static void air_tx_end(void){
+    irio_pio_rx_init(bio2bufiopin[BIO5]);
+    irio_pio_rx_capture_start(air_mem);
+}
+
 //buffer should be a NULL terminaled string
-static bool air_decode_transmit(char* air_buffer, uint32_t air_len, uint32_t *data, uint32_t data_len){
+static ir_air_status_t air_decode_transmit(char* air_buffer, uint32_t air_len, uint32_t *data, uint32_t data_len){
 	//parse the csv formatted values into 16 bit value pairs
-	uint16_t data_cnt=0;
+	uint32_t data_cnt;
 	uint8_t mod_freq;
-	uint16_t air_cnt=0;
-
-    //search start of frame
-	while(air_buffer[air_cnt]!='$'){
-		if(air_buffer[air_cnt]==0x00) return AIR_ERROR_START; //null terminated
-        air_cnt++;
-		if(air_cnt>=air_len) return AIR_ERROR_START;  //buffer length out of bounds      
-	}
-
-    //skip past the $ character
-	air_cnt++;
-    if(air_cnt>=air_len){
-        return AIR_ERROR_START;
-    }
 
-	//parse the ascii into an 8 bit value
-	while(air_buffer[air_cnt]!=':'){
-        if(air_buffer[air_cnt]==0x00||air_buffer[air_cnt]<'0'||air_buffer[air_cnt]>'9'){
-            return AIR_ERROR_MOD_FREQ;
-        }
-		mod_freq*=10;
-		mod_freq+=air_buffer[air_cnt]-0x30;
-		air_cnt++;
-        if(air_cnt>=air_len) return AIR_ERROR_MOD_FREQ;
-	} 
-
-    //skip past the : character
-	air_cnt++;
-    if(air_cnt>=air_len){
-        return AIR_ERROR_LENGTH;
-    }
-    
-    bool mark=true;
-    while(true){
-        uint16_t value=0;
-        while(air_buffer[air_cnt]!=','){
-			if(air_buffer[air_cnt]==0x00||air_buffer[air_cnt]<'0'||air_buffer[air_cnt]>'9'){
-				return AIR_ERROR_DATA;
-			}
-			value*=10;
-			value+=air_buffer[air_cnt]-0x30;
-			air_cnt++;
-            if(air_cnt>=air_len) return AIR_ERROR_DATA;
-		}
-        if(mark){
-            data[data_cnt] = (value<<16);//upper 16 bits are the mark
-            mark = false;
-        }else{
-            data[data_cnt] |= value;
-            data_cnt++;
-            if(data_cnt>=data_len){
-                return AIR_ERROR_DATA;
-            }
-            mark = true;
-        }
-        air_cnt++;
-        if(air_cnt>=air_len) return AIR_ERROR_DATA;
-        if(air_buffer[air_cnt]==';'){
-            //found end of AIR packet
-            if(!mark){
-                data[data_cnt] |= 0xffff;
-                data_cnt++;
-                if(data_cnt>=data_len){
-                    return AIR_ERROR_DATA;
-                }                
-            }
-            break;
-        }
+    ir_air_status_t status = ir_air_parse(air_buffer, air_len, &mod_freq, data, data_len, &data_cnt);
+    if(status != IR_AIR_OK){
+        return status;
     }
 
-	//debug: show loaded data packet
-	//printf("Read: %s", buffer);
-	/*
-    printf("\r\n$%u:", mod_freq);
-	for(uint16_t i=0; i<data_cnt; i++){
-		printf("%u,%u,", data[i]>>16, data[i]&0xffff);
-	}
-	printf(";\r\n\r\n");		
-	printf("Parsed AIR packet: modulation frequency %dkHz, %d MARK/SPACE pairs\r\nTransmitting...", mod_freq, data_cnt);
-    */
-    irio_pio_rx_deinit(bio2bufiopin[BIO5]);
+    air_tx_begin();
 	irio_pio_tx_frame_write((float)(mod_freq*1000), data_cnt, data);
-    irio_pio_rx_init(bio2bufiopin[BIO5]);
-	//printf("done\r\n");
-	return AIR_OK;
+    air_tx_end();
+	return IR_AIR_OK;
+}
+
+//@<file>; replays every frame of a file saved by irrx (.irf or .air)
+static bool air_play_file(char* file){
+    air_tx_begin();
+    bool ok = irtx_play_file(file, false);
+    air_tx_end();
+    return ok;
 }
 
 typedef struct _IR_PULSE {
@@ -232,9 +180,9 @@ ASCII decimals representing the lengths of pulse and no-pulse in uS CSV formatte
 void irtoy_air_service(void){
     float mod_freq;
     uint16_t us;
-    uint16_t pairs;
     uint32_t buffer[128];
     uint8_t air_buffer[512];
+    ir_capture_t capture;
     bool frame_found=false;
     uint16_t air_cnt;
     bool send_id;
@@ -247,6 +195,13 @@ void irtoy_air_service(void){
     modulation.measured_sample_count = 1;
     modulation.always_LF = '\n';
 
+    //frames of any length land in the big buffer, after the DMA rings
+    if(air_mem){
+        ir_capture_init(&capture, (uint32_t*)(air_mem + IRIO_RX_CAPTURE_MEM), AIR_MAX_PAIRS);
+    }else{
+        ir_capture_init(&capture, buffer, count_of(buffer));
+    }
+
     //let's talk about this loop
     //ideally we'd be co-op multitasking, but we're not
     //to multitask we'd need to make the buffer and air_buffer static
@@ -266,7 +221,9 @@ void irtoy_air_service(void){
             }
         }
 
-        if(irio_pio_rx_frame_buf(&mod_freq, &us, &pairs, buffer) ){
+        if(irio_pio_rx_capture_poll(&capture, &mod_freq, &us) ){
+            uint32_t pairs = capture.count;
+            uint32_t *frame = capture.pairs;
             #if 0
             //create the AIR packet
             uint8_t mod_freq_int = (uint8_t)roundf(mod_freq / 1000.0f);
@@ -288,9 +245,9 @@ void irtoy_air_service(void){
 
             //uint8_t mod_freq_int = (uint8_t)roundf(mod_freq / 1000.0f);
             pulse.entry_count=0;
-            for (uint16_t i = 0; i < (pairs); i++) {
-                ir_rx_pulse_packet(&pulse, true, (uint16_t)(buffer[i] >> 16));
-                ir_rx_pulse_packet(&pulse, false, (uint16_t)(buffer[i] & 0xffff));
+            for (uint32_t i = 0; i < (pairs); i++) {
+                ir_rx_pulse_packet(&pulse, true, (uint16_t)(frame[i] >> 16));
+                ir_rx_pulse_packet(&pulse, false, (uint16_t)(frame[i] & 0xffff));
             }
             //ir_rx_pulse_packet(&pulse, true, (uint16_t)(buffer[pairs-1] >> 16)); 
             //have us, want nano seconds
@@ -300,7 +257,7 @@ void irtoy_air_service(void){
         
         char c;
         while(bin_rx_fifo_try_get(&c)){
-            if(c=='$'){ //beginning of frame
+            if(c=='$' || c=='@'){ //beginning of frame, or of a file name to replay
                 frame_found=true;
                 air_cnt=0;
             }
@@ -319,7 +276,12 @@ void irtoy_air_service(void){
                         air_cnt=0;
                     }      
                     air_buffer[air_cnt]=0; //null terminate              
-                    air_decode_transmit(air_buffer, count_of(air_buffer), buffer, count_of(buffer));
+                    if(air_buffer[0]=='@'){
+                        air_buffer[air_cnt-2]=0; //drop the ';'
+                        air_play_file((char*)&air_buffer[1]);
+                    }else{
+                        air_decode_transmit((char*)air_buffer, count_of(air_buffer), buffer, count_of(buffer));
+                    }
                     frame_found=false;
                     air_cnt=0;
                 }
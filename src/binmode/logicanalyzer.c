@@ -22,6 +22,7 @@
 #include "ui/ui_cmdln.h"
 #include "pirate/intercore_helpers.h"
 #include "pio_config.h"
+#include "lib/la_change/la_change.h"
 
 static struct _pio_config pio_config;
 
@@ -47,6 +48,13 @@ bool status_leds_enabled = false;
 // for triggers, it is the number of samples after 0 
 uint32_t samples_from_zero = 0;
 
+// change-only capture: la_buf holds 32 bit transition records instead of samples
+static bool la_change_mode = false;
+static uint32_t la_change_count = 0;     // records in la_buf
+static uint64_t la_change_duration_us = 0; // capture window, 0 to run until the buffer is full
+static uint64_t la_change_deadline = 0;     // time_us_64() to stop at, 0 for none
+static uint32_t la_change_max_records = 0;
+
 // PIO pio = pio0;
 // uint sm = 0;
 // static uint offset = 0;
@@ -96,8 +104,67 @@ uint8_t logic_analyzer_read_ptr(uint32_t read_pointer) {
     return la_buf[read_pointer];
 }
 
+// stop a change-only capture and close the record stream
+static void logic_analyzer_change_done(void) {
+    uint32_t* records = (uint32_t*)la_buf;
+    uint32_t max = la_change_max_records;
+
+    if (la_sm_done) {
+        return;
+    }
+    pio_sm_set_enabled(pio_config.pio, pio_config.sm, false);
+    // the data channel is sized one short so there is always room for the end record
+    bool full = !dma_channel_is_busy(la_dma_data_channel);
+    if (!full) {
+        // let the DMA drain what is left in the FIFO before stopping it
+        uint32_t timeout = 0xfff;
+        while (!pio_sm_is_rx_fifo_empty(pio_config.pio, pio_config.sm) && timeout--) {
+            tight_loop_contents();
+        }
+    }
+    dma_channel_abort(la_dma_data_channel);
+    la_change_count = (max - 1) - dma_channel_hw_addr(la_dma_data_channel)->transfer_count;
+    while (!pio_sm_is_rx_fifo_empty(pio_config.pio, pio_config.sm) && la_change_count < max - 1) {
+        records[la_change_count++] = pio_sm_get(pio_config.pio, pio_config.sm);
+    }
+    if (!pio_sm_is_rx_fifo_empty(pio_config.pio, pio_config.sm)) {
+        full = true;
+    }
+
+    if (la_change_count == 0) {
+        // no start record, nothing was captured
+    } else if (full) {
+        // records were dropped once the buffer filled, end one sample after the last stored record
+        records[la_change_count] =
+            LA_CHANGE_RECORD(la_change_record_state(records[la_change_count - 1]), LA_CHANGE_COUNTER_MAX);
+        la_change_count++;
+    } else {
+        // push the live counter as the end record: mov isr, y / in osr, 24 / push
+        pio_sm_exec(pio_config.pio, pio_config.sm, pio_encode_mov(pio_isr, pio_y));
+        pio_sm_exec(pio_config.pio, pio_config.sm, pio_encode_in(pio_osr, LA_CHANGE_COUNTER_BITS));
+        pio_sm_exec(pio_config.pio, pio_config.sm, pio_encode_push(false, false));
+        records[la_change_count++] = pio_sm_get(pio_config.pio, pio_config.sm);
+    }
+
+    if (pio_config.program) {
+        pio_remove_program(pio_config.pio, pio_config.program, pio_config.offset);
+        pio_config.program = 0;
+    }
+
+    // raw sample accessors see an empty buffer
+    samples_from_zero = la_ptr_reset = la_ptr = 0;
+    if (status_leds_enabled) {
+        rgb_set_all(0x00, 0xff, 0); //,0x00FF00 green for dump
+    }
+    la_sm_done = true;
+}
+
 // this will probably need a mutex
 void logic_analyser_done(void) {
+    if (la_change_mode) {
+        logic_analyzer_change_done();
+        return;
+    }
     // turn off stuff!
     pio_interrupt_clear(pio_config.pio, 0);
     irq_set_enabled(PIO0_IRQ_0 + (PIO_NUM(pio_config.pio) * 2), false);
@@ -138,6 +205,13 @@ uint32_t logic_analyzer_get_dma_tail(void) {
 
 bool logic_analyzer_is_done(void) {
     static int32_t tail;
+    if (la_change_mode && !la_sm_done && la_status != LA_IDLE) {
+        // change capture has no PIO done interrupt, stop on time or a full buffer
+        if (!dma_channel_is_busy(la_dma_data_channel) ||
+            (la_change_deadline && time_us_64() >= la_change_deadline)) {
+            logic_analyser_done();
+        }
+    }
     if (la_status == LA_ARMED_INIT) {
         tail = logic_analyzer_get_dma_tail();
         la_status = LA_ARMED;
@@ -198,6 +272,7 @@ uint32_t logic_analyzer_configure(
     float freq, uint32_t samples, uint32_t trigger_mask, uint32_t trigger_direction, bool edge, bool interrupt) {
     uint32_t actual_frequency = 0;
     la_sm_done = false;
+    la_change_mode = false;
     memset((uint8_t*)la_buf, 0, LA_BUFFER_SIZE);
 
     irq_handler_installed=interrupt;
@@ -271,6 +346,68 @@ uint32_t logic_analyzer_configure(
     return actual_frequency;
 }
 
+uint32_t logic_analyzer_configure_change(float freq, uint32_t max_records, uint32_t duration_ms) {
+    uint32_t actual_frequency;
+    la_sm_done = false;
+    la_change_mode = true;
+    la_change_count = 0;
+    irq_handler_installed = false;
+
+    la_change_max_records = LA_BUFFER_SIZE / sizeof(uint32_t);
+    if (max_records >= 2 && max_records < la_change_max_records) {
+        la_change_max_records = max_records;
+    }
+
+    if (pio_config.program) {
+        pio_remove_program(pio_config.pio, pio_config.program, pio_config.offset);
+        pio_config.program = 0;
+    }
+
+    if (!pio_can_add_program(PIO_LOGIC_ANALYZER_PIO, &logicanalyzer_change_program)) {
+        // no room next to the frequency counter (RP2040), finish with an empty capture
+        la_sm_done = true;
+        return 0;
+    }
+
+    pio_config.pio = PIO_LOGIC_ANALYZER_PIO;
+    pio_config.sm = PIO_LOGIC_ANALYZER_SM;
+    pio_config.program = &logicanalyzer_change_program;
+    pio_config.offset = pio_add_program(pio_config.pio, pio_config.program);
+    actual_frequency =
+        logicanalyzer_change_program_init(pio_config.pio, pio_config.sm, pio_config.offset, la_base_pin, freq);
+#ifdef BP_PIO_SHOW_ASSIGNMENT
+    printf("pio %d, sm %d, offset %d\n", PIO_NUM(pio_config.pio), pio_config.sm, pio_config.offset);
+#endif
+
+    // single pass of 32 bit records, one slot kept back for the end record
+    dma_channel_abort(la_dma_control_channel);
+    dma_channel_abort(la_dma_data_channel);
+    dma_channel_config la_dma_data_config = dma_channel_get_default_config(la_dma_data_channel);
+    channel_config_set_transfer_data_size(&la_dma_data_config, DMA_SIZE_32);
+    channel_config_set_read_increment(&la_dma_data_config, false);
+    channel_config_set_write_increment(&la_dma_data_config, true);
+    channel_config_set_dreq(&la_dma_data_config, pio_get_dreq(pio_config.pio, pio_config.sm, false));
+    dma_channel_configure(la_dma_data_channel,
+                          &la_dma_data_config,
+                          la_buf,
+                          &pio_config.pio->rxf[pio_config.sm],
+                          la_change_max_records - 1,
+                          true);
+
+    la_change_duration_us = (uint64_t)duration_ms * 1000u;
+    la_change_deadline = 0;
+    return actual_frequency;
+}
+
+bool logic_analyzer_is_change_capture(void) {
+    return la_change_mode;
+}
+
+const uint32_t* logic_analyzer_get_change_records(uint32_t* count) {
+    *count = (la_change_mode && la_sm_done) ? la_change_count : 0;
+    return (const uint32_t*)la_buf;
+}
+
 void logic_analyzer_arm(bool led_indicator_enable) {
     la_status = LA_ARMED_INIT;
     status_leds_enabled = led_indicator_enable;
@@ -279,7 +416,12 @@ void logic_analyzer_arm(bool led_indicator_enable) {
         busy_wait_ms(5);
         rgb_set_all(0xff, 0, 0); // RED LEDs for armed
     }
-    pio_sm_set_enabled(pio_config.pio, pio_config.sm, true);
+    if (la_change_mode && la_change_duration_us) {
+        la_change_deadline = time_us_64() + la_change_duration_us;
+    }
+    if (pio_config.program) {
+        pio_sm_set_enabled(pio_config.pio, pio_config.sm, true);
+    }
 }
 
 bool logic_analyzer_cleanup(void) {
@@ -296,6 +438,7 @@ bool logic_analyzer_cleanup(void) {
     }
 
     mem_free((uint8_t*)la_buf);
+    la_change_mode = false;
 
     logicanalyzer_reset_led();
     return true;
@@ -318,12 +461,22 @@ bool logicanalyzer_setup(void) {
     return true;
 }
 
-uint32_t logic_analyzer_compute_actual_sample_frequency(float desired_frequency, float* div_out)
+static uint32_t logic_analyzer_compute_frequency(float desired_frequency, uint32_t cycles, float* div_out)
 {
-    float div = clock_get_hz(clk_sys) / (desired_frequency * 2); // 2 instructions per sample, run twice as fast as requested sampling rate
+    float div = clock_get_hz(clk_sys) / (desired_frequency * cycles); // run the PIO "cycles" times faster than the sampling rate
     div = (div >= 1.0) ? ((div < 10.0) ? floorf(div) : div) : 1.0;
     if (div_out) {
         *div_out = div;
     }
-    return clock_get_hz(clk_sys) / (2 * div);
-}
\ No newline at end of file
+    return clock_get_hz(clk_sys) / (cycles * div);
+}
+
+uint32_t logic_analyzer_compute_actual_sample_frequency(float desired_frequency, float* div_out)
+{
+    return logic_analyzer_compute_frequency(desired_frequency, 2, div_out); // 2 instructions per sample
+}
+
+uint32_t logic_analyzer_compute_actual_change_frequency(float desired_frequency, float* div_out)
+{
+    return logic_analyzer_compute_frequency(desired_frequency, LA_CHANGE_CYCLES_PER_SAMPLE, div_out);
+}
\ No newline at end of file
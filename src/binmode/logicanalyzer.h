@@ -17,4 +17,10 @@ void logic_analyzer_reset_ptr(void);
 uint8_t logic_analyzer_read_ptr(uint32_t read_pointer);
 void logic_analyzer_set_base_pin(uint8_t base_pin);
 uint32_t logic_analyzer_get_samples_from_zero(void);
-uint32_t logic_analyzer_compute_actual_sample_frequency(float desired_frequency, float* div_out);
\ No newline at end of file
+uint32_t logic_analyzer_compute_actual_sample_frequency(float desired_frequency, float* div_out);
+uint32_t logic_analyzer_compute_actual_change_frequency(float desired_frequency, float* div_out);
+// change-only capture, see lib/la_change/la_change.h for the record format
+// max_records 0 uses the whole buffer, duration_ms 0 runs until the buffer is full
+uint32_t logic_analyzer_configure_change(float freq, uint32_t max_records, uint32_t duration_ms);
+bool logic_analyzer_is_change_capture(void);
+const uint32_t* logic_analyzer_get_change_records(uint32_t* count);
\ No newline at end of file
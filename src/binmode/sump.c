@@ -48,6 +48,7 @@
 #include "modes.h"
 #include "pirate/psu.h"
 #include "binmode/logicanalyzer.h"
+#include "lib/la_change/la_change.h"
 #include "tusb.h"
 
 #define CDC_INTF 1
@@ -84,6 +85,8 @@ static struct _sump {
     uint8_t cmd_pos;        // command buffer position
     volatile uint8_t state; // SUMP_STATE_*
     uint8_t width;          // in bytes, 1 = 8 bits, 2 = 16 bits
+    bool rle;               // RLE flag set, capture changes only and send RLE samples
+    la_change_sump_t rle_tx;
     uint8_t trigger_index;
     uint32_t pio_prog_offset;
     uint32_t read_start;
@@ -196,6 +199,8 @@ static uint32_t sump_calc_sysclk_divider()
     return v;
 }*/
 
+static void sump_dump_start(void);
+
 static void sump_do_run(void) {
     uint8_t state;
     uint32_t i, tmask = 0;
@@ -204,7 +209,7 @@ static void sump_do_run(void) {
     uint32_t trigger_value = sump.trigger[0].value;
     if (sump.width == 0) {
         // invalid config, dump something nice
-        sump.state = SUMP_STATE_DUMP;
+        sump_dump_start();
         return;
     }
 
@@ -215,6 +220,15 @@ static void sump_do_run(void) {
 
     float freq = (100 * ONE_MHZ) / (sump.divider); // already added +1 when we rx the value...
 
+    if (sump.rle) {
+        // change-only capture runs until it has enough records for read_count RLE entries
+        // (or the buffer is full), triggers are not used: the first change is recorded anyway
+        sump.state = SUMP_STATE_SAMPLING;
+        logic_analyzer_configure_change(freq, sump.read_count + 2, 0);
+        logic_analyzer_arm(true);
+        return;
+    }
+
     if (tstart && tmask) {
         // test for 2 level triggering to achieve edge triggering
         // same masks and opposite values on level 1 and 2
@@ -234,9 +248,23 @@ static void sump_do_run(void) {
     return;
 }
 
+// prepare the sample source for the dump state
+static void sump_dump_start(void) {
+    if (sump.rle) {
+        uint32_t count;
+        const uint32_t* records = logic_analyzer_get_change_records(&count);
+        la_change_sump_init(&sump.rle_tx, records, count, sump.width, sump.read_count);
+    }
+    sump.state = SUMP_STATE_DUMP;
+}
+
 static void sump_do_finish(void) {
     if (sump.state == SUMP_STATE_TRIGGER || sump.state == SUMP_STATE_SAMPLING) {
-        sump.state = SUMP_STATE_DUMP;
+        if (sump.rle) {
+            // finish ends an RLE capture early
+            logic_analyser_done();
+        }
+        sump_dump_start();
         // sump_dma_done();
         return;
     }
@@ -280,6 +308,7 @@ static void sump_set_flags(uint32_t flags) {
     }
     // printf("%s(): sample %u bytes\n", __func__, width);
     sump.width = width;
+    sump.rle = (flags & SUMP_FLAG1_ENABLE_RLE) != 0;
 }
 
 static void sump_update_counts(uint32_t val) {
@@ -463,6 +492,14 @@ static uint sump_fill_tx(uint8_t* buf, uint len) {
     uint ret;
 
     assert((len & 3) == 0);
+    if (sump.rle && sump.state == SUMP_STATE_DUMP) {
+        ret = la_change_sump_fill(&sump.rle_tx, buf, len);
+        if (ret == 0) {
+            sump.state = SUMP_STATE_CONFIG;
+            logicanalyzer_reset_led();
+        }
+        return ret;
+    }
     if (sump.read_count == 0) {
         sump.state = SUMP_STATE_CONFIG;
         // rgb_irq_enable(true);
@@ -533,7 +570,7 @@ void cdc_sump_task(void) {
         if (logic_analyzer_is_done()) // get status from logic analyzer, move to cancel or dump
         {
             // rgb_set_all(0xff,0,0xff);
-            sump.state = SUMP_STATE_DUMP;
+            sump_dump_start();
         }
     } // else if (!sump.cdc_connected) {
       //   sump.cdc_connected = false;
@@ -51,11 +51,14 @@ struct _bytecode {
  * @brief Compile-time assertion to protect against RAM bloat
  * 
  * Ensures _bytecode structure doesn't exceed 28 bytes, preventing
- * unintentional RAM usage increases.
+ * unintentional RAM usage increases. Checked on the 32 bit target only,
+ * pointers are wider in host builds.
  */
+#if UINTPTR_MAX == 0xffffffffu
 static_assert(
     sizeof(struct _bytecode) <= 28,
     "sizeof(struct _bytecode) has increased.  This will impact RAM.  Review to ensure this is not avoidable.");
+#endif
 
 /**
  * @brief Bytecode output structure (alternative representation)
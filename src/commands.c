@@ -17,6 +17,8 @@
 #include "commands/global/a_auxio.h"
 #include "commands/global/v_adc.h"
 #include "commands/global/w_psu.h"
+#include "commands/global/psulog.h"
+#include "commands/global/journal.h"
 #include "commands/global/p_pullups.h"
 #include "commands/global/cmd_mcu.h"
 #include "commands/global/l_bitorder.h"
@@ -74,6 +76,7 @@ const struct _global_command_struct commands[] = {
 // IO: pin control, power, measurement
 { .command="W",         .allow_hiz=false, .func=&psucmd_enable_handler,              .def=&psucmd_enable_def, .category=CMD_CAT_IO },
 { .command="w",         .allow_hiz=false, .func=&psucmd_disable_handler,             .def=&psucmd_disable_def, .category=CMD_CAT_IO },
+{ .command="psulog",    .allow_hiz=false, .func=&psulog_handler,                     .def=&psulog_def, .category=CMD_CAT_IO },
 { .command="P",         .allow_hiz=false, .func=&pullups_enable_handler,             .def=&pullups_enable_def, .category=CMD_CAT_IO },
 { .command="p",         .allow_hiz=false, .func=&pullups_disable_handler,            .def=&pullups_disable_def, .category=CMD_CAT_IO },
 { .command="a",         .allow_hiz=false, .func=&auxio_low_handler,                  .def=&auxio_low_def, .category=CMD_CAT_IO },
@@ -122,6 +125,7 @@ const struct _global_command_struct commands[] = {
 { .command="hexedit",   .allow_hiz=true,  .func=&hexedit_handler,   .def=&hexedit_def,   .category=CMD_CAT_SCRIPT },
 // Tools: utilities and converters
 { .command="logic",     .allow_hiz=true,  .func=&logic_handler,                      .def=&logic_def, .category=CMD_CAT_TOOLS },
+{ .command="journal",   .allow_hiz=true,  .func=&journal_handler,                    .def=&journal_def, .category=CMD_CAT_TOOLS },
 { .command="toolbar",   .allow_hiz=true,  .func=&toolbar_cmd_handler,                .def=&toolbar_cmd_def, .category=CMD_CAT_TOOLS },
 { .command="life",      .allow_hiz=true,  .func=&life_handler,      .def=&life_def,      .category=CMD_CAT_TOOLS },
 { .command="snake",     .allow_hiz=true,  .func=&snake_handler,     .def=&snake_def,     .category=CMD_CAT_TOOLS },
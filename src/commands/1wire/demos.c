@@ -18,13 +18,20 @@
 #include "command_struct.h"
 #include "hardware/pio.h"
 #include "pirate/hw1wire_pio.h"
+#include "lib/ow_search/ow_search.h"
 #include "ui/ui_help.h"
 #include "lib/bp_args/bp_cmd.h"
 #include "binmode/fala.h"
 
 static const char* const ds18b20_usage[] = {
-    "ds18b20\t[-h(elp)]",
+    "ds18b20\t[-a(ll)] [-h(elp)]",
     "measure temperature (single sensor bus only):%s ds18b20",
+    "convert all sensors at once, then read each:%s ds18b20 -a",
+};
+
+static const bp_command_opt_t ds18b20_opts[] = {
+    { "all", 'a', BP_ARG_NONE, NULL, T_HELP_1WIRE_DS18B20_ALL },
+    { 0 }
 };
 
 const bp_command_def_t ds18b20_def = {
@@ -32,16 +39,101 @@ const bp_command_def_t ds18b20_def = {
     .description = T_HELP_1WIRE_DS18B20,
     .actions = NULL,
     .action_count = 0,
-    .opts = NULL,
+    .opts = ds18b20_opts,
     .usage = ds18b20_usage,
     .usage_count = count_of(ds18b20_usage),
 };
 
+// sensors read by -a, the ROMs are kept on the stack
+#define DS18B20_ALL_MAX 32
+
+/* Every temperature sensor on the bus: one ROM search, a single Skip ROM
+   Convert T so they all convert at the same time, then Match ROM and
+   Read Scratchpad for each one */
+static void ds18b20_convert_all(struct command_result* res) {
+    uint8_t roms[DS18B20_ALL_MAX][8];
+    uint8_t buf[OW_SCRATCHPAD_LEN];
+    const uint8_t convert[] = { 0xcc, 0x44 }; // Skip ROM, Convert T
+    struct owobj search_owobj;
+    int count = 0;
+    bool more = false;
+    int32_t temp;
+
+    int ret = OWFirst(&search_owobj);
+    while (ret) {
+        if (ow_temp_family(search_owobj.ROM_NO[0])) {
+            if (count < DS18B20_ALL_MAX) {
+                memcpy(roms[count++], search_owobj.ROM_NO, 8);
+            } else {
+                more = true;
+            }
+        }
+        ret = OWNext(&search_owobj);
+    }
+
+    if (count == 0) {
+        printf("No temperature sensors found\r\n");
+        return;
+    }
+
+    if (!onewire_reset()) {
+        res->error = true;
+        return;
+    }
+    onewire_tx_block(convert, sizeof(convert));
+    onewire_wait_for_idle();
+
+    // read slots return 0 while any sensor is still converting, 12bit: 750 ms
+    absolute_time_t deadline = make_timeout_time_ms(1000);
+    while (!onewire_rx_byte() && !time_reached(deadline)) {
+        sleep_ms(5);
+    }
+    onewire_wait_for_idle();
+
+    for (int i = 0; i < count; i++) {
+        printf("%d:", i + 1);
+        for (int j = 0; j < 8; j++) {
+            printf(" %.2x", roms[i][j]);
+        }
+        if (!onewire_select(roms[i])) {
+            printf("  no answer\r\n");
+            continue;
+        }
+        onewire_tx_byte(0xbe); // Read Scratchpad
+        onewire_rx_block(buf, sizeof(buf));
+        onewire_wait_for_idle();
+
+        switch (ow_temp_decode(roms[i][0], buf, &temp)) {
+            case OW_TEMP_OK:
+                printf("  %.3f\r\n", (float)temp / 16);
+                break;
+            case OW_TEMP_CRC:
+                printf("  CRC Fail\r\n");
+                break;
+            default:
+                printf("  no answer\r\n");
+                break;
+        }
+    }
+    if (more) {
+        printf("First %d sensors shown\r\n", DS18B20_ALL_MAX);
+    }
+}
+
 void onewire_test_ds18b20_conversion(struct command_result* res) {
     if (bp_cmd_help_check(&ds18b20_def, res->help_flag)) {
         return;
     }
 
+    if (bp_cmd_find_flag(&ds18b20_def, 'a')) {
+        //we manually control any FALA capture
+        fala_start_hook();
+        ds18b20_convert_all(res);
+        fala_stop_hook();
+        fala_notify_hook();
+        return;
+    }
+
     int i;
     unsigned char buf[9];
     int32_t temp;
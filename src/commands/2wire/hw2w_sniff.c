@@ -1,20 +1,66 @@
+/**
+ * @file hw2w_sniff.c
+ * @brief 2-wire (SLE4442 style) bus sniffer.
+ * @details Four PIO state machines watch SDA/SCL and push one word per
+ *          START, STOP or data byte:
+ *          - The main state machine's RX FIFO drains into a DMA ring in
+ *            the big buffer, the CPU only looks at the DMA transfer count
+ *            so nothing is lost while the terminal or the file system is
+ *            slow, a lapped ring is counted and marks the transaction
+ *          - lib/hw2w_decode frames the words into transactions (command
+ *            between START and STOP, then the response bytes), stamped
+ *            with the time they were taken from the ring
+ *          - Finished transactions wait in a queue until the terminal (or
+ *            the file) has room, a full queue is counted as an overrun
+ *
+ *          On exit the words, transactions, lost words, queue overruns
+ *          and PIO FIFO stalls are shown.
+ *
+ *          Based on pico-i2c-sniff by @jjsch-dev.
+ */
+
 #include <stdio.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "pirate.h"
 #include "system_config.h"
 #include "command_struct.h"
 #include "hardware/pio.h"
+#include "hardware/dma.h"
 #include "hardware/timer.h"
 #include "hardware/clocks.h"
-#include "hw2w_sniffer.pio.h" 
-#include "pio_config.h"  
-#include "bytecode.h" 
+#include "hw2w_sniffer.pio.h"
+#include "pio_config.h"
+#include "bytecode.h"
 #include "mode/hw2wire.h"
 #include "pirate/bio.h"
+#include "pirate/button.h"
+#include "pirate/file.h"
+#include "pirate/mem.h"
+#include "ui/ui_term.h"
 #include "ui/ui_help.h"    // Functions to display help in a standardized way
 #include "usb_rx.h"
 #include "usb_tx.h"
 #include "lib/bp_args/bp_cmd.h"
+#include "lib/hw2w_decode/hw2w_decode.h"
+
+// PIO words ring, the DMA wraps the write address so it must be aligned to its size
+#define SNIFF_RING_BITS 14
+#define SNIFF_RING_SIZE (1u << SNIFF_RING_BITS)
+#define SNIFF_RING_WORDS (SNIFF_RING_SIZE / sizeof(uint32_t))
+// the top 4 bits of the RP2350 transfer count are the mode, 0xf would be endless and never count down
+#if RPI_PLATFORM == RP2350
+#define SNIFF_COUNT_MASK 0x0fffffffu
+#else
+#define SNIFF_COUNT_MASK 0xffffffffu
+#endif
+// a multiple of the ring length, so the ring slot stays in step with the written count across re-arms
+#define SNIFF_RELOAD (SNIFF_COUNT_MASK & ~(SNIFF_RING_WORDS - 1))
+// finished transactions waiting for the terminal, power of 2
+#define SNIFF_QUEUE_SLOTS 64
+// text is written to the file in blocks this big
+#define SNIFF_LOG_SIZE 4096
+#define SNIFF_STATUS_US 500000
 
 static const char pin_labels[][5] = {
     "SDA",
@@ -25,12 +71,26 @@ static const char pin_labels[][5] = {
 
 //help variables
 static const char* const hw2w_sniff_help[] = {
-    "sniff [-q]",
+    "sniff [-i <us>] [-f <file>]",
     "Start the 2WIRE sniffer:%s sniff",
+    "End a response after 500us quiet:%s sniff -i 500",
+    "Save to a file:%s sniff -f sle.txt",
     "",
     "Sniffs SLE4442 style 8bit I2C-like protocols (no NAK/ACK)",
     "Based on pico-i2c-sniff by @jjsch-dev https://github.com/jjsch-dev/pico_i2c_sniffer",
     "Max speed:%s 500kHz",
+    "Exit:%s press x or the Bus Pirate button",
+};
+
+static const bp_val_constraint_t hw2w_sniff_idle_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 1, .max = 10000000, .def = 10000 },
+};
+
+static const bp_command_opt_t hw2w_sniff_opts[] = {
+    { "idle", 'i', BP_ARG_REQUIRED, "us",   T_HW2WIRE_SNIFF_IDLE, &hw2w_sniff_idle_range },
+    { "file", 'f', BP_ARG_REQUIRED, "file", T_HW2WIRE_SNIFF_FILE },
+    { 0 }
 };
 
 const bp_command_def_t hw2w_sniff_def = {
@@ -38,19 +98,235 @@ const bp_command_def_t hw2w_sniff_def = {
     .description  = T_HW2WIRE_SNIFF,
     .actions      = NULL,
     .action_count = 0,
-    .opts         = NULL,
+    .opts         = hw2w_sniff_opts,
     .usage        = hw2w_sniff_help,
     .usage_count  = count_of(hw2w_sniff_help),
 };
 
-void hw2w_sniff(struct command_result* res){ 
+typedef struct {
+    PIO pio;
+    uint sm;
+    int channel;
+    int control_channel;
+    const uint32_t* ring;
+    uint32_t last_count; // DMA transfer count at the last poll
+    uint32_t written;    // words written by the DMA, free running
+    uint32_t read;       // words taken from the ring, free running
+    uint32_t lost;
+    uint32_t stalls;     // the PIO FIFO filled up, the DMA was not fast enough
+    uint32_t peak;       // most words waiting in the ring
+} sniff_rx_t;
+
+static const uint32_t sniff_reload = SNIFF_RELOAD;
+
+static void sniff_rx_release(sniff_rx_t* rx) {
+    int* channels[] = { &rx->channel, &rx->control_channel };
+    for (uint32_t i = 0; i < count_of(channels); i++) {
+        if (*channels[i] >= 0) {
+            dma_channel_cleanup(*channels[i]);
+            dma_channel_unclaim(*channels[i]);
+            *channels[i] = -1;
+        }
+    }
+}
+
+static bool sniff_rx_setup(sniff_rx_t* rx, PIO pio, uint sm, uint32_t* ring) {
+    memset(rx, 0, sizeof(*rx));
+    rx->pio = pio;
+    rx->sm = sm;
+    rx->ring = ring;
+    rx->channel = dma_claim_unused_channel(false);
+    rx->control_channel = dma_claim_unused_channel(false);
+    if (rx->channel < 0 || rx->control_channel < 0) {
+        sniff_rx_release(rx);
+        return false;
+    }
+
+    // control channel re-arms the ring channel when its (very long) transfer completes
+    dma_channel_config c = dma_channel_get_default_config(rx->control_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(
+        rx->control_channel, &c, &dma_hw->ch[rx->channel].al1_transfer_count_trig, &sniff_reload, 1, false);
+
+    c = dma_channel_get_default_config(rx->channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, SNIFF_RING_BITS);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, false));
+    channel_config_set_chain_to(&c, rx->control_channel);
+    rx->last_count = sniff_reload;
+    dma_channel_configure(rx->channel, &c, ring, &pio->rxf[sm], sniff_reload, true);
+    return true;
+}
+
+// feed what the DMA wrote since the last poll to the decoder
+static void sniff_rx_poll(sniff_rx_t* rx, hw2w_dec_t* d, uint32_t now) {
+    // the DMA counts down, the control channel re-arms it at 0
+    uint32_t count = dma_channel_hw_addr(rx->channel)->transfer_count & SNIFF_COUNT_MASK;
+    rx->written += (count <= rx->last_count) ? rx->last_count - count : rx->last_count + sniff_reload - count;
+    rx->last_count = count;
+
+    uint32_t stall = 1u << (PIO_FDEBUG_RXSTALL_LSB + rx->sm);
+    if (rx->pio->fdebug & stall) {
+        rx->pio->fdebug = stall; // write 1 to clear
+        rx->stalls++;
+    }
+
+    uint32_t avail = rx->written - rx->read;
+    if (avail > rx->peak) {
+        rx->peak = avail;
+    }
+    if (avail > SNIFF_RING_WORDS - 16) {
+        // lapped, keep a margin from the word the DMA is writing now
+        uint32_t lost = avail - SNIFF_RING_WORDS / 2;
+        hw2w_dec_lost(d, lost);
+        rx->read += lost;
+        rx->lost += lost;
+        avail -= lost;
+    }
+
+    // the loop polls much faster than the bus, one time for the batch is close enough
+    while (avail--) {
+        hw2w_dec_word(d, rx->ring[rx->read & (SNIFF_RING_WORDS - 1)], now);
+        rx->read++;
+    }
+}
+
+static void sniff_queue_txn(void* ctx, const hw2w_txn_t* t) {
+    hw2w_txn_queue_push((hw2w_txn_queue_t*)ctx, t);
+}
+
+static bool sniff_cancelled(void) {
+    char c;
+    return button_get(0) || (rx_fifo_try_get(&c) && c == 'x');
+}
+
+// pio_main: the state machine whose RX FIFO carries the bus events
+static void sniff_run(const struct _pio_config* pio_main, const char* filename, uint32_t idle_us) {
+    uint8_t* mem = mem_alloc(BIG_BUFFER_SIZE, BP_BIG_BUFFER_SNIFF_2WIRE);
+    if (!mem) {
+        printf("Error: big buffer unavailable (in use by another command)\r\n");
+        return;
+    }
+    // ring first, aligned, then the decoder, the queue, the text and the file block
+    uint32_t* ring = (uint32_t*)(((uintptr_t)mem + SNIFF_RING_SIZE - 1) & ~(uintptr_t)(SNIFF_RING_SIZE - 1));
+    hw2w_dec_t* dec = (hw2w_dec_t*)&ring[SNIFF_RING_WORDS];
+    hw2w_txn_t* slots = (hw2w_txn_t*)&dec[1];
+    char* text = (char*)&slots[SNIFF_QUEUE_SLOTS];
+    uint8_t* log_buf = (uint8_t*)&text[HW2W_FMT_MAX];
+    uint32_t text_len = 0, text_sent = 0, log_len = 0;
+    hw2w_txn_queue_t queue;
+    FIL file;
+    bool logging = filename != NULL;
+    bool error = false;
+
+    sniff_rx_t rx;
+    if (!sniff_rx_setup(&rx, pio_main->pio, pio_main->sm, ring)) {
+        printf("Error: no free DMA channels\r\n");
+        mem_free(mem);
+        return;
+    }
+    if (logging && file_open(&file, filename, FA_CREATE_ALWAYS | FA_WRITE)) {
+        sniff_rx_release(&rx);
+        mem_free(mem);
+        return;
+    }
+
+    uint32_t t0 = time_us_32();
+    hw2w_txn_queue_init(&queue, slots, SNIFF_QUEUE_SLOTS);
+    hw2w_dec_init(dec, sniff_queue_txn, &queue);
+
+    printf("%s%s. Press x or the Bus Pirate button to exit%s\r\n",
+           ui_term_color_notice(),
+           logging ? filename : "Time [command] response",
+           ui_term_color_reset());
+
+    uint32_t status_us = t0;
+    bool done = false;
+    while (!error) {
+        uint32_t now = time_us_32();
+        if (!done) {
+            done = sniff_cancelled();
+            sniff_rx_poll(&rx, dec, now);
+            hw2w_dec_idle(dec, now, idle_us);
+            if (done) {
+                hw2w_dec_flush(dec);
+            }
+        }
+
+        // never wait on the terminal while the bus is running
+        const hw2w_txn_t* t = hw2w_txn_queue_peek(&queue);
+        if (!text_len && t) {
+            text_len = hw2w_txn_format(t, t0, text, HW2W_FMT_MAX);
+            text_sent = 0;
+            hw2w_txn_queue_pop(&queue);
+        }
+        if (text_len && logging) {
+            if (log_len + text_len > SNIFF_LOG_SIZE) {
+                error = file_write(&file, log_buf, log_len);
+                log_len = 0;
+            }
+            memcpy(&log_buf[log_len], text, text_len);
+            log_len += text_len;
+            text_len = 0;
+        } else if (text_len) {
+            text_sent += tx_fifo_try_write(&text[text_sent], text_len - text_sent);
+            if (text_sent == text_len) {
+                text_len = 0;
+            }
+        }
+
+        if (done && !text_len && !hw2w_txn_queue_peek(&queue)) {
+            break;
+        }
+        if (logging && now - status_us > SNIFF_STATUS_US) {
+            status_us = now;
+            printf("\r%lu transactions ", (unsigned long)dec->txns);
+        }
+    }
+
+    if (logging) {
+        if (!error && log_len) {
+            error = file_write(&file, log_buf, log_len);
+        }
+        if (!error) {
+            file_close(&file);
+        }
+        printf("\r\n");
+    }
+
+    sniff_rx_release(&rx);
+
+    printf("%lu words, %lu transactions, %lu words lost, %lu queue overruns, %lu PIO stalls, ring peak %lu%%\r\n",
+           (unsigned long)dec->words,
+           (unsigned long)dec->txns,
+           (unsigned long)rx.lost,
+           (unsigned long)queue.overruns,
+           (unsigned long)rx.stalls,
+           (unsigned long)(rx.peak * 100 / SNIFF_RING_WORDS));
+    mem_free(mem);
+}
+
+void hw2w_sniff(struct command_result* res){
     //if -h show help
     if (bp_cmd_help_check(&hw2w_sniff_def, res->help_flag)) {
         return;
     }
 
-    //check arguments for quiet mode
-    // bool quiet = cmdln_args_find_flag('q');
+    char filename[13];
+    bool save = bp_cmd_find_flag(&hw2w_sniff_def, 'f');
+    if (save && !bp_file_get_name_flag(&hw2w_sniff_def, 'f', filename, sizeof(filename))) {
+        res->error = true;
+        return;
+    }
+    uint32_t idle_us;
+    if (bp_cmd_flag(&hw2w_sniff_def, 'i', &idle_us) == BP_CMD_INVALID) {
+        res->error = true;
+        return;
+    }
 
     // Full speed for the PIO clock divider
     float div = 1;
@@ -63,7 +339,7 @@ void hw2w_sniff(struct command_result* res){
 
     //buffers to input/outputs
     bio_input(M_I2C_SDA); //SDA
-    bio_input(M_I2C_SCL); //SCL    
+    bio_input(M_I2C_SCL); //SCL
     bio_output(BIO2); //EVENT CODE 1
     bio_output(BIO3); //EVENT CODE 2
 
@@ -106,45 +382,14 @@ void hw2w_sniff(struct command_result* res){
     pio_sm_set_enabled(pio_stop.pio, pio_stop.sm, true);
     pio_sm_set_enabled(pio_data.pio, pio_data.sm, true);
 
-    printf("Press x to exit\r\n");
-
     //attempt to drain the FIFO of any spurious data
     busy_wait_ms(10);
     while(pio_sm_get_rx_fifo_level(pio_main.pio, pio_main.sm ) > 0){
         pio_sm_get(pio_main.pio, pio_main.sm);
     }
 
-    while(true){
-        bool new_val = (pio_sm_get_rx_fifo_level(pio_main.pio, pio_main.sm ) > 0);
-        if (new_val) {
-            uint32_t val = pio_sm_get(pio_main.pio, pio_main.sm);
-            // The format of the uint32_t returned by the sniffer is composed of two event
-            // code bits (EV1 = Bit12, EV0 = Bit11), and when it comes to data, the eight least
-            // significant bits correspond to bit 0, and the value 8 bits
-            // where (B0 = Bit0 and B7 = Bit7).
-            uint32_t ev_code = (val >> 10) & 0x03;
-            uint8_t  data = ((val) & 0xFF);
-            //printf("val: %x, ev_code: %x, data:%x\r\n", val, ev_code, data);
-            if (ev_code == EV_START) {
-                printf("[");
-            } else if (ev_code == EV_STOP) {
-                printf("]\r\n");
-            } else if (ev_code == EV_DATA) {
-                printf(" 0x%02X", data);
-            } else {
-                printf("U\r\n");
-            }            
-        }
-
-        // x to exit
-        char c;
-        if(rx_fifo_try_get(&c)){
-            if(c == 'x'){
-                break;
-            }
-        }
-
-    }
+    // the main state machine's words go through a DMA ring from here
+    sniff_run(&pio_main, save ? filename : NULL, idle_us);
 
     //remove pin labels
     system_bio_update_purpose_and_label(false, M_I2C_SDA, BP_PIN_MODE, 0);
@@ -153,6 +398,10 @@ void hw2w_sniff(struct command_result* res){
     system_bio_update_purpose_and_label(false, BIO3, BP_PIN_MODE, 0);
 
     //remove sniff PIO programs
+    pio_sm_set_enabled(pio_main.pio, pio_main.sm, false);
+    pio_sm_set_enabled(pio_data.pio, pio_data.sm, false);
+    pio_sm_set_enabled(pio_start.pio, pio_start.sm, false);
+    pio_sm_set_enabled(pio_stop.pio, pio_stop.sm, false);
     pio_remove_program(pio_main.pio, pio_main.program, pio_main.offset);
     pio_remove_program(pio_data.pio, pio_data.program, pio_data.offset);
     pio_remove_program(pio_start.pio, pio_start.program, pio_start.offset);
@@ -161,4 +410,4 @@ void hw2w_sniff(struct command_result* res){
     //on exit, restore the I2C PIO
     hw2wire_setup_exc();
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,255 @@
+/**
+ * @file pattern.c
+ * @brief 8 bit parallel pattern generator command for DIO mode.
+ * @details Vectors come from the command line (lib/pattern text syntax) or
+ *          a raw file, one byte per sample. The table is compiled and
+ *          expanded in place in the big buffer and played by wavegen at a
+ *          set sample rate: once, N times, or in a loop until x or the
+ *          button. The run can wait for an edge on an IO pin first.
+ *
+ *          Only IO assigned pins are driven. When the run ends the pins
+ *          hold the last vector, as if it had been written with DIO
+ *          syntax.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "pirate.h"
+#include "system_config.h"
+#include "command_struct.h"
+#include "fatfs/ff.h"
+#include "pirate/file.h"
+#include "pirate/bio.h"
+#include "pirate/button.h"
+#include "pirate/mem.h"
+#include "ui/ui_term.h"
+#include "ui/ui_help.h"
+#include "usb_rx.h"
+#include "lib/bp_args/bp_cmd.h"
+#include "lib/pattern/pattern.h"
+#include "wavegen.h"
+#include "mode/dio.h"
+#include "commands/dio/pattern.h"
+
+static const char* const usage[] = {
+    "pattern <vectors> [-r <Hz>] [-n <repeats>] [-l] [-t <IO> [-e]]",
+    "pattern -f <file> [-r <Hz>] [-n <repeats>] [-l] [-t <IO> [-e]]",
+    "Walk a 1 across IO0-7 at 1MHz:%s pattern 1 2 4 8 16 32 64 128",
+    "8 pulses, then low for 100 samples, 3 times at 10kHz:%s pattern {1 0}:8 0:100 -r 10000 -n 3",
+    "Loop a file until x is pressed:%s pattern -f vectors.bin -l",
+    "Wait for a rising edge on IO7 first:%s pattern 0xff 0 -t 7",
+    "",
+    "Vectors: 0x, 0b or decimal, v:n holds v for n samples, {...}:n repeats a group",
+};
+
+static const bp_val_constraint_t pattern_rate_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 1, .max = 150000000, .def = 1000000 },
+};
+
+static const bp_val_constraint_t pattern_repeat_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 1, .max = BIG_BUFFER_SIZE, .def = 1 },
+};
+
+static const bp_val_constraint_t pattern_trigger_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 0, .max = 7, .def = 0 },
+};
+
+static const bp_command_opt_t pattern_opts[] = {
+    { "file", 'f', BP_ARG_REQUIRED, "file", T_DIO_PATTERN_FILE },
+    { "rate", 'r', BP_ARG_REQUIRED, "Hz", T_DIO_PATTERN_RATE, &pattern_rate_range },
+    { "repeat", 'n', BP_ARG_REQUIRED, "count", T_DIO_PATTERN_REPEAT, &pattern_repeat_range },
+    { "loop", 'l', BP_ARG_NONE, NULL, T_DIO_PATTERN_LOOP },
+    { "trigger", 't', BP_ARG_REQUIRED, "0-7", T_DIO_PATTERN_TRIGGER, &pattern_trigger_range },
+    { "falling", 'e', BP_ARG_NONE, NULL, T_DIO_PATTERN_FALLING },
+    { 0 }
+};
+
+const bp_command_def_t pattern_def = {
+    .name = "pattern",
+    .description = T_DIO_PATTERN_DESCRIPTION,
+    .actions = NULL,
+    .action_count = 0,
+    .opts = pattern_opts,
+    .usage = usage,
+    .usage_count = count_of(usage),
+};
+
+// raw file, one byte per sample
+static bool pattern_load_file(const char* filename, uint8_t* table, uint32_t cap, uint32_t* samples) {
+    FIL fil;
+    if (file_open(&fil, filename, FA_READ)) {
+        return false;
+    }
+    uint32_t size = file_size(&fil);
+    if (size > cap) {
+        printf("Error: %s is %lu bytes, %lu fit\r\n", filename, (unsigned long)size, (unsigned long)cap);
+        file_close(&fil);
+        return false;
+    }
+    if (file_read(&fil, table, size, samples)) {
+        return false; // closed on error
+    }
+    file_close(&fil);
+    if (!*samples) {
+        printf("Error: %s is empty\r\n", filename);
+        return false;
+    }
+    return true;
+}
+
+static bool pattern_load_text(uint8_t* table, uint32_t cap, uint32_t* samples) {
+    const char* text;
+    size_t len;
+    if (!bp_cmd_get_remainder(&pattern_def, &text, &len) || text[0] == '-') {
+        bp_cmd_help_show(&pattern_def);
+        return false;
+    }
+    pattern_result_t r;
+    pattern_compile(text, len, table, cap, &r);
+    if (r.err != PATTERN_OK) {
+        printf("%sError:%s %s at '%.8s'\r\n",
+               ui_term_color_error(),
+               ui_term_color_reset(),
+               pattern_error_text(r.err),
+               &text[r.pos]);
+        return false;
+    }
+    *samples = r.len;
+    return true;
+}
+
+static bool pattern_cancel(void) {
+    char c;
+    return button_get(0) || (rx_fifo_try_get(&c) && c == 'x');
+}
+
+void pattern_handler(struct command_result* res) {
+    if (bp_cmd_help_check(&pattern_def, res->help_flag)) {
+        return;
+    }
+
+    uint32_t rate, repeats, trigger;
+    if (bp_cmd_flag(&pattern_def, 'r', &rate) == BP_CMD_INVALID ||
+        bp_cmd_flag(&pattern_def, 'n', &repeats) == BP_CMD_INVALID) {
+        res->error = true;
+        return;
+    }
+    bp_cmd_status_t t = bp_cmd_flag(&pattern_def, 't', &trigger);
+    if (t == BP_CMD_INVALID) {
+        res->error = true;
+        return;
+    }
+    bool loop = bp_cmd_find_flag(&pattern_def, 'l');
+    wavegen_trigger_t edge = WAVEGEN_TRIGGER_NONE;
+    if (t == BP_CMD_OK) {
+        edge = bp_cmd_find_flag(&pattern_def, 'e') ? WAVEGEN_TRIGGER_FALLING : WAVEGEN_TRIGGER_RISING;
+        if (system_config.pin_func[trigger + 1] != BP_PIN_IO) {
+            printf("Error: IO%lu is in use\r\n", (unsigned long)trigger);
+            res->error = true;
+            return;
+        }
+    }
+
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+    pattern_clock_t clock;
+    if (!pattern_clock(sys_hz, rate, &clock)) {
+        printf("Error: the highest sample rate is %lu Hz\r\n", (unsigned long)sys_hz);
+        res->error = true;
+        return;
+    }
+    uint8_t mask = wavegen_pins(edge == WAVEGEN_TRIGGER_NONE ? -1 : (int8_t)trigger);
+    if (!mask) {
+        printf("Error: no IO pins free to drive\r\n");
+        res->error = true;
+        return;
+    }
+
+    uint8_t* mem = mem_alloc(BIG_BUFFER_SIZE, BP_BIG_BUFFER_PATTERN);
+    if (!mem) {
+        printf("Error: big buffer unavailable (in use by another command)\r\n");
+        res->error = true;
+        return;
+    }
+
+    char filename[13];
+    uint32_t samples = 0;
+    bool ok;
+    if (bp_cmd_find_flag(&pattern_def, 'f')) {
+        ok = bp_file_get_name_flag(&pattern_def, 'f', filename, sizeof(filename)) &&
+             pattern_load_file(filename, mem, BIG_BUFFER_SIZE, &samples);
+    } else {
+        ok = pattern_load_text(mem, BIG_BUFFER_SIZE, &samples);
+    }
+    pattern_layout_t layout;
+    if (ok && !pattern_layout(samples, loop ? 0 : repeats, BIG_BUFFER_SIZE, &layout)) {
+        if (loop) {
+            printf("Error: %lu samples do not fit the loop buffer\r\n", (unsigned long)samples);
+        } else {
+            printf("Error: %lu samples fit %lu times\r\n",
+                   (unsigned long)samples,
+                   (unsigned long)pattern_max_repeats(samples, BIG_BUFFER_SIZE));
+        }
+        ok = false;
+    }
+    if (!ok) {
+        mem_free(mem);
+        res->error = true;
+        return;
+    }
+    pattern_fill(mem, mem, &layout);
+
+    if (!wavegen_init()) {
+        printf("Error: no free DMA channels\r\n");
+        mem_free(mem);
+        res->error = true;
+        return;
+    }
+
+    // one sample per PIO cycle, DMA moves a word of four samples every four
+    printf("%lu samples at %lu Hz%s (%s program), max %lu Hz\r\n",
+           (unsigned long)samples,
+           (unsigned long)(clock.actual_hz + 0.5),
+           clock.jitter ? " average, 1 cycle jitter" : "",
+           clock.slow ? "delay" : "divider",
+           (unsigned long)sys_hz);
+    if (!wavegen_start((const uint32_t*)mem, layout.bytes / 4, loop, &clock, mask, (uint8_t)trigger, edge)) {
+        printf("Error: no room for the PIO program\r\n");
+        wavegen_cleanup();
+        mem_free(mem);
+        res->error = true;
+        return;
+    }
+    if (edge != WAVEGEN_TRIGGER_NONE) {
+        printf("Waiting for a %s edge on IO%lu. ",
+               edge == WAVEGEN_TRIGGER_RISING ? "rising" : "falling",
+               (unsigned long)trigger);
+    }
+    printf("Press x or the Bus Pirate button to stop\r\n");
+
+    bool cancelled = false;
+    while (wavegen_poll()) {
+        if (pattern_cancel()) {
+            cancelled = true;
+            break;
+        }
+    }
+    uint8_t levels = wavegen_stop();
+    uint32_t underruns = wavegen_underruns();
+    wavegen_cleanup();
+    mem_free(mem);
+    dio_label_outputs(mask, levels);
+
+    if (underruns) {
+        printf("%sWarning:%s the output stalled %lu times, lower the rate\r\n",
+               ui_term_color_warning(),
+               ui_term_color_reset(),
+               (unsigned long)underruns);
+    }
+    printf("%s, pins at 0x%02x\r\n", cancelled ? "Stopped" : "Done", levels & mask);
+}
@@ -0,0 +1,13 @@
+/**
+ * @file pattern.h
+ * @brief Parallel pattern generator command.
+ * @details Plays a vector table on IO0-IO7 at a set sample rate with DMA.
+ */
+
+/**
+ * @brief Play a vector table on the IO pins.
+ * @param res  Command result structure
+ */
+void pattern_handler(struct command_result* res);
+
+extern const struct bp_command_def pattern_def;
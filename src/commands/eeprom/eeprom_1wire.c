@@ -92,6 +92,7 @@ static const bp_command_opt_t eeprom_1wire_opts[] = {
     { "device",   'd', BP_ARG_REQUIRED, "device", T_HELP_EEPROM_DEVICE_FLAG },
     { "file",     'f', BP_ARG_REQUIRED, "file",   T_HELP_EEPROM_FILE_FLAG },
     { "verify",   'v', BP_ARG_NONE,     NULL,       T_HELP_EEPROM_VERIFY_FLAG },
+    { "update",   'u', BP_ARG_NONE,     NULL,       T_HELP_EEPROM_UPDATE_FLAG },
     { "start",    's', BP_ARG_REQUIRED, "addr",   UI_HEX_HELP_START },
     { "bytes",    'b', BP_ARG_REQUIRED, "count",  UI_HEX_HELP_BYTES },
     { "quiet",    'q', BP_ARG_NONE,     NULL,       UI_HEX_HELP_QUIET },
@@ -101,12 +102,13 @@ static const bp_command_opt_t eeprom_1wire_opts[] = {
 };
 
 static const char* const usage[] = {
-    "eeprom [dump|erase|write|read|verify|test|list|protect]\r\n\t[-d <device>] [-f <file>] [-v(verify)] [-s <start address>] [-b <bytes>] [-h(elp)]",
+    "eeprom [dump|erase|write|read|verify|test|list|protect]\r\n\t[-d <device>] [-f <file>] [-v(verify)] [-u(update)] [-s <start address>] [-b <bytes>] [-h(elp)]",
     "List available EEPROM devices:%s eeprom list",
     "Display contents (x to exit):%s eeprom dump -d ds2431",
     "Display 16 bytes starting at address 0x10:%s eeprom dump -d ds2431 -s 0x10 -b 16",
     "Erase, verify:%s eeprom erase -d ds2431 -v",
     "Write from file, verify:%s eeprom write -d ds2431 -f example.bin -v",
+    "Write only changed pages:%s eeprom write -d ds2431 -f example.bin -u",
     "Read to file, verify:%s eeprom read -d ds2431 -f example.bin -v",
     "Verify against file:%s eeprom verify -d ds2431 -f example.bin",
     "Test chip (full erase/write/verify):%s eeprom test -d ds2431",
@@ -370,6 +372,8 @@ static bool eeprom_get_args(struct eeprom_info *args) {
 
     // verify_flag
     args->verify_flag = bp_cmd_find_flag(&eeprom_1wire_def, 'v');
+    // update_flag, write only the pages that changed
+    args->update_flag = bp_cmd_find_flag(&eeprom_1wire_def, 'u');
 
     // file to read/write/verify
     if ((args->action == EEPROM_READ || args->action == EEPROM_WRITE || args->action==EEPROM_VERIFY)) {
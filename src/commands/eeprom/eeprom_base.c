@@ -128,7 +128,8 @@ bool eeprom_dump(const bp_command_def_t *def, struct eeprom_info *eeprom, uint8_
     return false;
 }
 
-bool eeprom_write(struct eeprom_info *eeprom, uint8_t *buf, uint32_t buf_size, bool write_from_buf) {
+// compare_buf: when not NULL each block is read back first and identical pages are skipped
+static bool eeprom_write_core(struct eeprom_info *eeprom, uint8_t *buf, uint32_t buf_size, bool write_from_buf, uint8_t *compare_buf, uint32_t *skipped_bytes) {
 
     uint32_t file_size_bytes; 
     if(!write_from_buf){
@@ -176,6 +177,15 @@ bool eeprom_write(struct eeprom_info *eeprom, uint8_t *buf, uint32_t buf_size, b
             printf("Block %d, SB: 0x%02X, address 0x%02X00, %d write pages, %d bytes\r\n", i, i2caddr_7bit, block_ptr[0], write_pages, eeprom->device->page_bytes); //debug
         #endif
 
+        // one bulk read per block, much cheaper than a page write and busy poll
+        if(compare_buf && eeprom->device->hal->read(eeprom, i*256, bytes_read, compare_buf)) {
+            { char _msg[EEPROM_MSG_BUF_SIZE];
+              snprintf(_msg, sizeof(_msg), "Error reading EEPROM at %d\r\n", i*256);
+              eeprom_ui_error(eeprom, _msg); }
+            if(!write_from_buf) file_close(&eeprom->file_handle);
+            return true;
+        }
+
         for(uint32_t j = 0; j < write_pages; j++) {
             bool end_of_file = false;
             // write page to the EEPROM
@@ -192,7 +202,9 @@ bool eeprom_write(struct eeprom_info *eeprom, uint8_t *buf, uint32_t buf_size, b
                     }
                 }
                 
-                if(eeprom->device->hal->write_page(eeprom, (i*256)+(j*eeprom->device->page_bytes), &buf[j*eeprom->device->page_bytes], page_write_size)) {
+                if(compare_buf && !memcmp(&compare_buf[j*eeprom->device->page_bytes], &buf[j*eeprom->device->page_bytes], page_write_size)) {
+                    *skipped_bytes += page_write_size; // page already matches
+                } else if(eeprom->device->hal->write_page(eeprom, (i*256)+(j*eeprom->device->page_bytes), &buf[j*eeprom->device->page_bytes], page_write_size)) {
                     { char _msg[EEPROM_MSG_BUF_SIZE];
                       snprintf(_msg, sizeof(_msg), "Error writing EEPROM at %d\r\n", (i*256) + j);
                       eeprom_ui_error(eeprom, _msg); }
@@ -225,6 +237,10 @@ eeprom_base_write_cleanup:
     return false; // success
 }
 
+bool eeprom_write(struct eeprom_info *eeprom, uint8_t *buf, uint32_t buf_size, bool write_from_buf) {
+    return eeprom_write_core(eeprom, buf, buf_size, write_from_buf, NULL, NULL);
+}
+
 bool eeprom_read(struct eeprom_info *eeprom, char *buf, uint32_t buf_size, char *verify_buf, uint32_t verify_buf_size, enum eeprom_read_action action) {   
     uint32_t file_size_bytes;
     // figure out what we are doing
@@ -385,10 +401,23 @@ bool eeprom_action_write(struct eeprom_info *eeprom, uint8_t *buf, uint32_t buf_
     { char _msg[EEPROM_MSG_BUF_SIZE];
       snprintf(_msg, sizeof(_msg), "Write: Writing EEPROM from file %s...\r\n", eeprom->file_name);
       eeprom_ui_message(eeprom, _msg); }
-    if (eeprom_write(eeprom, buf, buf_size, false)) {
-        return true; // error during write
+    if (eeprom->update_flag) {
+        // differential write, the verify buffer holds the chip contents of each block
+        uint32_t skipped_bytes = 0;
+        uint64_t start_us = time_us_64();
+        if (eeprom_write_core(eeprom, buf, buf_size, false, verify_buf, &skipped_bytes)) {
+            return true; // error during write
+        }
+        char _msg[EEPROM_MSG_BUF_SIZE];
+        snprintf(_msg, sizeof(_msg), "\r\nWrite complete: %lu bytes unchanged, %lu ms\r\n",
+                 (unsigned long)skipped_bytes, (unsigned long)((time_us_64() - start_us) / 1000));
+        eeprom_ui_message(eeprom, _msg);
+    } else {
+        if (eeprom_write(eeprom, buf, buf_size, false)) {
+            return true; // error during write
+        }
+        eeprom_ui_message(eeprom, "\r\nWrite complete\r\n");
     }
-    eeprom_ui_message(eeprom, "\r\nWrite complete\r\n");
     if (verify) {   
         eeprom_ui_message(eeprom, "Write verify...\r\n");
         if(eeprom_read(eeprom, buf, buf_size, verify_buf, verify_buf_size, EEPROM_VERIFY_FILE)){
@@ -48,6 +48,7 @@ struct eeprom_info{
     FIL file_handle;     // file handle
     char file_name[32]; // file to read/write/verify (absolute path)
     bool verify_flag; // verify flag
+    bool update_flag; // write: only write pages that differ from the chip
     bool protect_blocks_flag;
     bool protect_test_flag;
     bool protect_wpen_flag;
@@ -57,6 +57,7 @@ static const bp_command_opt_t eeprom_i2c_opts[] = {
     { "device",   'd', BP_ARG_REQUIRED, "device", T_HELP_EEPROM_DEVICE_FLAG },
     { "file",     'f', BP_ARG_REQUIRED, "file",   T_HELP_EEPROM_FILE_FLAG },
     { "verify",   'v', BP_ARG_NONE,     NULL,        T_HELP_EEPROM_VERIFY_FLAG },
+    { "update",   'u', BP_ARG_NONE,     NULL,        T_HELP_EEPROM_UPDATE_FLAG },
     { "start",    's', BP_ARG_REQUIRED, "addr",   UI_HEX_HELP_START },
     { "bytes",    'b', BP_ARG_REQUIRED, "count",  UI_HEX_HELP_BYTES },
     { "quiet",    'q', BP_ARG_NONE,     NULL,        UI_HEX_HELP_QUIET },
@@ -67,12 +68,13 @@ static const bp_command_opt_t eeprom_i2c_opts[] = {
 };
 
 static const char* const usage[] = {
-    "eeprom [dump|erase|write|read|verify|test|list]\r\n\t[-d <device>] [-f <file>] [-v(verify)] [-s <start address>] [-b <bytes>] [-a <i2c address>] [-h(elp)]",
+    "eeprom [dump|erase|write|read|verify|test|list]\r\n\t[-d <device>] [-f <file>] [-v(verify)] [-u(update)] [-s <start address>] [-b <bytes>] [-a <i2c address>] [-h(elp)]",
     "List available EEPROM devices:%s eeprom list",
     "Display contents (x to exit):%s eeprom dump -d 24x02",
     "Display 16 bytes starting at address 0x60:%s eeprom dump -d 24x02 -s 0x60 -b 16",
     "Erase, verify:%s eeprom erase -d 24x02 -v",
     "Write from file, verify:%s eeprom write -d 24x02 -f example.bin -v",
+    "Write only changed pages:%s eeprom write -d 24x02 -f example.bin -u",
     "Read to file, verify:%s eeprom read -d 24x02 -f example.bin -v",
     "Verify against file:%s eeprom verify -d 24x02 -f example.bin",
     "Test chip (full erase/write/verify):%s eeprom test -d 24x02",
@@ -277,6 +279,8 @@ static bool eeprom_get_args(struct eeprom_info *args) {
 
     // verify_flag
     args->verify_flag = bp_cmd_find_flag(&eeprom_i2c_def, 'v');
+    // update_flag, write only the pages that changed
+    args->update_flag = bp_cmd_find_flag(&eeprom_i2c_def, 'u');
 
     // file to read/write/verify
     if ((args->action == EEPROM_READ || args->action == EEPROM_WRITE || args->action == EEPROM_VERIFY)) {
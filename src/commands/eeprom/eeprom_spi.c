@@ -48,12 +48,13 @@ static const bp_command_action_t spi_eeprom_action_defs[] = {
 
 
 static const char* const usage[] = {
-    "eeprom [dump|erase|write|read|verify|test|list|protect]\r\n\t[-d <device>] [-f <file>] [-v(verify)] [-s <start address>] [-b <bytes>] [-t(test)] [-p <protection blocks>] [-w <WPEN>] [-h(elp)]",
+    "eeprom [dump|erase|write|read|verify|test|list|protect]\r\n\t[-d <device>] [-f <file>] [-v(verify)] [-u(update)] [-s <start address>] [-b <bytes>] [-t(test)] [-p <protection blocks>] [-w <WPEN>] [-h(elp)]",
     "List available EEPROM devices:%s eeprom list",
     "Display contents:%s eeprom dump -d 25x020",
     "Display 16 bytes starting at address 0x60:%s eeprom dump -d 25x020 -s 0x60 -b 16",
     "Erase, verify:%s eeprom erase -d 25x020 -v",
     "Write from file, verify:%s eeprom write -d 25x020 -f example.bin -v",
+    "Write only changed pages:%s eeprom write -d 25x020 -f example.bin -u",
     "Read to file, verify:%s eeprom read -d 25x020 -f example.bin -v",
     "Verify against file:%s eeprom verify -d 25x020 -f example.bin",
     "Test chip (full erase/write/verify):%s eeprom test -d 25x020",
@@ -67,6 +68,7 @@ static const bp_command_opt_t spi_eeprom_opts[] = {
     { "device",   'd', BP_ARG_REQUIRED, "device", T_HELP_EEPROM_DEVICE_FLAG },
     { "file",     'f', BP_ARG_REQUIRED, "file",   T_HELP_EEPROM_FILE_FLAG },
     { "verify",   'v', BP_ARG_NONE,     NULL,        T_HELP_EEPROM_VERIFY_FLAG },
+    { "update",   'u', BP_ARG_NONE,     NULL,        T_HELP_EEPROM_UPDATE_FLAG },
     { "start",    's', BP_ARG_REQUIRED, "addr",   UI_HEX_HELP_START },
     { "bytes",    'b', BP_ARG_REQUIRED, "count",  UI_HEX_HELP_BYTES },
     { "quiet",    'q', BP_ARG_NONE,     NULL,        UI_HEX_HELP_QUIET },
@@ -516,6 +518,8 @@ static bool eeprom_get_args(struct eeprom_info *args) {
 
     // verify_flag
     args->verify_flag = bp_cmd_find_flag(&eeprom_spi_def, 'v');
+    // update_flag, write only the pages that changed
+    args->update_flag = bp_cmd_find_flag(&eeprom_spi_def, 'u');
 
     if(args->device->hal->is_write_protected==NULL) {
         // check if the device is write protected
@@ -60,59 +60,52 @@ typedef struct {
 // ---------------------------------------------------------------------------
 // Drawing
 // ---------------------------------------------------------------------------
-static void draw_field(bricks_state_t* gs, int sr, int sc) {
-    const char* rst = system_config.terminal_ansi_color ? "\x1b[0m" : "";
-    static const char* brick_colors[] = {
-        "", "\x1b[31m", "\x1b[33m", "\x1b[32m", "\x1b[36m"
-    };
-
-    // Top wall
-    ui_term_cursor_position(sr, sc);
-    printf("+");
-    for (int c = 0; c < gs->field_w; c++) printf("--");
-    printf("+");
+// The grid starts at the top-left corner of the wall, status lines below it.
+// Only the cells that changed since the last frame go to the terminal.
+static void draw_field(bricks_state_t* gs) {
+    bool color = system_config.terminal_ansi_color;
+    static const uint8_t brick_colors[] = { CELL_DEFAULT, CELL_RED, CELL_YELLOW, CELL_GREEN, CELL_CYAN };
+    int right = gs->field_w * 2 + 1;
+    char line[64];
+
+    game_fb_clear();
+
+    // Walls
+    for (int c = 0; c <= right; c++) {
+        uint16_t ch = (c == 0 || c == right) ? '+' : '-';
+        game_fb_put(0, c, ch, CELL_DEFAULT, 0);
+        game_fb_put(gs->field_h + 1, c, ch, CELL_DEFAULT, 0);
+    }
 
     for (int r = 0; r < gs->field_h; r++) {
-        ui_term_cursor_position(sr + 1 + r, sc);
-        printf("|");
+        game_fb_put(r + 1, 0, '|', CELL_DEFAULT, 0);
+        game_fb_put(r + 1, right, '|', CELL_DEFAULT, 0);
         for (int c = 0; c < gs->field_w; c++) {
+            int x = 1 + c * 2;
             bool is_ball = (r == gs->ball_r && c == gs->ball_c);
             bool is_paddle = (r == gs->field_h - 1 && c >= gs->paddle_x && c < gs->paddle_x + PADDLE_W);
             bool is_brick = (r < BRICK_ROWS && gs->bricks[r][c]);
 
             if (is_ball) {
-                if (system_config.terminal_ansi_color)
-                    printf("\x1b[1;37mO %s", rst);
-                else
-                    printf("O ");
+                game_fb_put(r + 1, x, 'O', CELL_COLOR(CELL_WHITE, 0), CELL_BOLD);
             } else if (is_brick) {
-                if (system_config.terminal_ansi_color)
-                    printf("%s\xe2\x96\x88\xe2\x96\x88%s", brick_colors[gs->bricks[r][c]], rst);
-                else
-                    printf("##");
+                uint16_t ch = color ? 0x2588 : '#'; // █
+                game_fb_put(r + 1, x, ch, CELL_COLOR(brick_colors[gs->bricks[r][c]], 0), 0);
+                game_fb_put(r + 1, x + 1, ch, CELL_COLOR(brick_colors[gs->bricks[r][c]], 0), 0);
             } else if (is_paddle) {
-                if (system_config.terminal_ansi_color)
-                    printf("\x1b[7m  %s", rst);
-                else
-                    printf("==");
-            } else {
-                printf("  ");
+                uint16_t ch = color ? ' ' : '=';
+                game_fb_put(r + 1, x, ch, CELL_DEFAULT, CELL_REVERSE);
+                game_fb_put(r + 1, x + 1, ch, CELL_DEFAULT, CELL_REVERSE);
             }
         }
-        printf("|");
     }
 
-    // Bottom wall
-    ui_term_cursor_position(sr + 1 + gs->field_h, sc);
-    printf("+");
-    for (int c = 0; c < gs->field_w; c++) printf("--");
-    printf("+");
-
     // Status
-    ui_term_cursor_position(sr + gs->field_h + 3, sc);
-    printf("Score: %d  Lives: %d  Bricks: %d  %dms\x1b[K", gs->brk_score, gs->lives, gs->bricks_left, gs->tick_ms);
-    ui_term_cursor_position(sr + gs->field_h + 4, sc);
-    printf("AD/arrows=move  +/-=speed  q=quit");
+    snprintf(line, sizeof(line), "Score: %d  Lives: %d  Bricks: %d  %dms", gs->brk_score, gs->lives, gs->bricks_left, gs->tick_ms);
+    game_fb_text(gs->field_h + 3, 0, line, CELL_DEFAULT, 0);
+    game_fb_text(gs->field_h + 4, 0, "AD/arrows=move  +/-=speed  q=quit", CELL_DEFAULT, 0);
+
+    game_present();
 }
 
 // ---------------------------------------------------------------------------
@@ -230,14 +223,22 @@ void bricks_handler(struct command_result* res) {
     if (gs.field_h < 10) gs.field_h = 10;
     if (gs.field_w < 12) gs.field_w = 12;
 
-    game_screen_enter(0);
-
     int fw_chars = gs.field_w * 2 + 2;
     int sr = (term_rows - gs.field_h - 5) / 2;
     int sc = (term_cols - fw_chars) / 2;
     if (sr < 1) sr = 1;
     if (sc < 1) sc = 1;
 
+    // field, walls and two status lines
+    int fb_cols = (fw_chars < 44) ? 44 : fw_chars;
+    if (fb_cols > term_cols - sc + 1) fb_cols = term_cols - sc + 1;
+    if (!game_fb_begin(sr, sc, gs.field_h + 5, fb_cols)) {
+        printf("Error: memory in use by another feature\r\n");
+        return;
+    }
+
+    game_screen_enter(0);
+
     bool quit = false;
 
     while (!quit) {
@@ -245,9 +246,10 @@ void bricks_handler(struct command_result* res) {
         bool playing = true;
         gs.tick_ms = 80;
 
-        // Draw initial frame
+        // Draw initial frame, the last game's messages are still on screen
         tx_fifo_wait_drain();
-        draw_field(&gs, sr, sc);
+        game_fb_invalidate();
+        draw_field(&gs);
 
         while (playing && !quit) {
             absolute_time_t deadline = make_timeout_time_ms(gs.tick_ms);
@@ -286,27 +288,10 @@ void bricks_handler(struct command_result* res) {
                     }
                 }
                 if (quit) break;
-                // Immediately redraw paddle row on move
+                // Immediately redraw on move, only the paddle cells change
                 if (paddle_moved) {
                     paddle_moved = 0;
-                        int pr = gs.field_h - 1;
-                        ui_term_cursor_position(sr + 1 + pr, sc + 1);
-                        const char* rst = system_config.terminal_ansi_color ? "\x1b[0m" : "";
-                        for (int cc = 0; cc < gs.field_w; cc++) {
-                            if (pr == gs.ball_r && cc == gs.ball_c) {
-                                if (system_config.terminal_ansi_color)
-                                    printf("\x1b[1;37mO %s", rst);
-                                else
-                                    printf("O ");
-                            } else if (cc >= gs.paddle_x && cc < gs.paddle_x + PADDLE_W) {
-                                if (system_config.terminal_ansi_color)
-                                    printf("\x1b[7m  %s", rst);
-                                else
-                                    printf("==");
-                            } else {
-                                printf("  ");
-                            }
-                    }
+                    draw_field(&gs);
                 }
                 busy_wait_ms(1);
             }
@@ -316,7 +301,7 @@ void bricks_handler(struct command_result* res) {
 
             // Redraw field in-place (no screen clear = no flicker)
             tx_fifo_wait_drain();
-            draw_field(&gs, sr, sc);
+            draw_field(&gs);
 
             if (gs.lives <= 0) {
                 tx_fifo_wait_drain();
@@ -352,4 +337,5 @@ void bricks_handler(struct command_result* res) {
     }
 
     game_screen_exit();
+    game_fb_end();
 }
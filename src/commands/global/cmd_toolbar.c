@@ -6,7 +6,8 @@
  *            toolbar test <height>     — create a coloured test toolbar
  *            toolbar remove            — remove the test toolbar
  *            toolbar stats             — toggle 1-line sys_stats toolbar
- *            toolbar pins              — toggle 2-line pin_watcher toolbar
+ *            toolbar pins              — toggle 4-line pin_watcher toolbar
+ *            toolbar pinreset          — clear the pin_watcher edge statistics
  *            toolbar statusbar         — toggle the 4-line status bar
  *
  * The test toolbar is a simple block of coloured rows showing its name and
@@ -36,6 +37,7 @@ enum toolbar_actions {
     TOOLBAR_REMOVE,
     TOOLBAR_STATS,
     TOOLBAR_PINS,
+    TOOLBAR_PINRESET,
     TOOLBAR_STATUSBAR,
 };
 
@@ -45,6 +47,7 @@ static const bp_command_action_t toolbar_action_defs[] = {
     { TOOLBAR_REMOVE,    "remove",    0x00 },
     { TOOLBAR_STATS,     "stats",     0x00 },
     { TOOLBAR_PINS,      "pins",      0x00 },
+    { TOOLBAR_PINRESET,  "pinreset",  0x00 },
     { TOOLBAR_STATUSBAR, "statusbar", 0x00 },
 };
 
@@ -57,12 +60,13 @@ static const bp_command_opt_t toolbar_opts[] = {
 /* ── usage ───────────────────────────────────────────────────────────────── */
 
 static const char* const usage[] = {
-    "toolbar [list|test|remove|stats|pins|statusbar]",
+    "toolbar [list|test|remove|stats|pins|pinreset|statusbar]",
     "List registered toolbars:%s toolbar list",
     "Create a test toolbar (1-8 lines):%s toolbar test 3",
     "Remove test toolbar:%s toolbar remove",
     "Toggle system stats toolbar:%s toolbar stats",
     "Toggle pin watcher toolbar:%s toolbar pins",
+    "Clear pin watcher edge counts and glitches:%s toolbar pinreset",
     "Toggle status bar:%s toolbar statusbar",
 };
 
@@ -138,7 +142,7 @@ void toolbar_cmd_handler(struct command_result* res) {
 
     uint32_t action = 0;
     if (!bp_cmd_get_action(&toolbar_cmd_def, &action)) {
-        printf("Usage: toolbar [list|test <height>|remove|stats|pins|statusbar]\r\n");
+        printf("Usage: toolbar [list|test <height>|remove|stats|pins|pinreset|statusbar]\r\n");
         return;
     }
 
@@ -216,6 +220,17 @@ void toolbar_cmd_handler(struct command_result* res) {
             break;
         }
 
+        /* ── pinreset ──────────────────────────────────────────────────── */
+        case TOOLBAR_PINRESET: {
+            if (!pin_watcher_is_active()) {
+                printf("Pin watcher not active — use 'toolbar pins' first\r\n");
+                return;
+            }
+            pin_watcher_reset();
+            printf("Pin watcher edge statistics cleared\r\n");
+            break;
+        }
+
         /* ── statusbar ────────────────────────────────────────────────── */
         case TOOLBAR_STATUSBAR: {
             if (system_config.terminal_ansi_statusbar) {
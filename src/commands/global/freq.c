@@ -10,20 +10,23 @@
  *          - F [pin]: Continuous measurement on pin (or menu if no pin)
  *          
  *          Measurement method:
- *          - Uses RP2040 PWM hardware in counter mode
- *          - Can measure period and duty cycle simultaneously
- *          - Supports frequencies from ~1Hz to several MHz
- *          - Only available on pins with PWM channel B
+ *          - PIO reciprocal counter timestamps edges on all 8 IO pins (pirate/freq_pio.c)
+ *          - Records go to a ring buffer by DMA, no CPU time while measuring
+ *          - Frequency is whole periods over the time they span, resolution is
+ *            one sysclk/10 tick over that span. The span is the last second or
+ *            the newest ~1800 edges on all pins, whichever is shorter
+ *          - Period min/max, jitter and duty cycle from the same edges
+ *          - A gated edge count at the system clock checks the range
  *          
  *          Limitations:
- *          - Cannot share PWM slice with active PWM output
- *          - Cannot measure on pins 0-1 if PSU uses PWM (hardware conflict)
+ *          - The sampler aliases above sysclk/20, faster signals are shown
+ *            from the gated count (about 50ppm) without duty cycle
+ *          - Edges closer than 3 system clocks apart are not counted
  */
 
 #include <stdio.h>
 #include <math.h>
 #include "pico/stdlib.h"
-#include "hardware/pwm.h"
 #include "hardware/clocks.h"
 #include "pirate.h"
 #include "system_config.h"
@@ -34,6 +37,8 @@
 #include "ui/ui_term.h"
 #include "ui/ui_info.h"
 #include "lib/bp_args/bp_cmd.h"
+#include "pirate/freq_pio.h"
+#include "toolbars/pin_watcher.h"
 
 #include "commands/global/freq.h"
 
@@ -128,53 +133,92 @@ void freq_cont(struct command_result* res) {
     }
 }
 
+// statistics window, long enough for 1Hz signals. The ring only holds about 1800
+// edges shared by all pins, a signal above ~1kHz is measured over the newest ~900
+// periods instead: one tick over the span those periods cover
+#define FREQ_WINDOW_MS 1000
+// gated count that flags signals too fast for the sampler, readings above
+// tick_hz/FREQ_RANGE_DIV come from the gate (20ms, +-1 edge and +-1us)
+#define FREQ_GATE_US 20000
+#define FREQ_RANGE_DIV 4
+
 bool freq_check_pin_is_available(uint32_t i) {
-    // 1=channel b can measure frequency
     // label should be 0, not in use
-    // PWM on the A channel should not be in use!
+    // the PIO counter only reads the pin, PWM and PSU sharing no longer matter
 
     // bounds check
     if (i >= count_of(bio2bufiopin)) {
         return 0;
     }
 
-    // temp fix for power supply PWM sharing
-    #ifdef BP_HW_PSU_PWM_IO_BUG
-        if (i == 0 || i == 1) {
-            return 0;
-        }
-    #endif
-
-    return (pwm_gpio_to_channel(bio2bufiopin[i]) == PWM_CHAN_B && system_config.pin_labels[i + 1] == 0 &&
-            !(system_config.pwm_active & (0b11 << ((uint8_t)(i % 2 ? i - 1 : i)))));
+    return (system_config.pin_labels[i + 1] == 0);
 }
 
 bool freq_check_pin_is_active(uint32_t i) {
     return (system_config.freq_active & (0x01 << ((uint8_t)i)));
 }
 
-// TODO: use PIO to do measurements/PWM on all A channels, making it fully flexible
+static bool freq_pio_check_start(void) {
+    if (!freq_pio_start()) {
+        printf("Frequency counter unavailable, PIO or DMA in use (logic analyzer?)\r\n");
+        return false;
+    }
+    return true;
+}
+
+// stop the counter when nothing uses it any more, the pin watcher reads it too
+static void freq_pio_check_stop(void) {
+    if (system_config.freq_active == 0 && !pin_watcher_is_active()) {
+        freq_pio_stop();
+    }
+}
+
+// a freshly started counter has no edges yet, give it up to one window to see two periods
+static void freq_wait_for_periods(uint8_t pin) {
+    freq_stats_t stats[FREQ_STATS_PINS];
+    for (uint32_t ms = 0; ms < FREQ_WINDOW_MS; ms += 10) {
+        if (!freq_pio_get_stats(FREQ_WINDOW_MS, stats) || stats[pin].periods >= 2) {
+            return;
+        }
+        busy_wait_ms(10);
+    }
+}
+
 uint32_t freq_print(uint8_t pin, bool refresh) {
-    // now do single or continuous measurement on the pin
-    float measured_period = freq_measure_period(bio2bufiopin[pin]);
-    float measured_duty_cycle = freq_measure_duty_cycle(bio2bufiopin[pin]);
+    freq_stats_t stats[FREQ_STATS_PINS];
+    if (!freq_pio_get_stats(FREQ_WINDOW_MS, stats)) {
+        return 0;
+    }
+    freq_stats_t* s = &stats[pin];
+    double tick_hz = freq_pio_tick_hz();
+    float measured_freq = freq_stats_frequency(s, tick_hz);
+    float measured_duty_cycle = freq_stats_duty(s);
+
+    // above the sampler range the edge records alias to any frequency, the gate does not
+    double gate_hz;
+    bool over_range = freq_pio_gate(pin, FREQ_GATE_US, &gate_hz) && gate_hz > tick_hz / FREQ_RANGE_DIV;
+    if (over_range) {
+        measured_freq = gate_hz;
+    }
 
     float freq_friendly_value;
     uint8_t freq_friendly_units;
-    freq_display_hz(&measured_period, &freq_friendly_value, &freq_friendly_units);
+    freq_display_hz(&measured_freq, &freq_friendly_value, &freq_friendly_units);
 
     float ns_friendly_value, freq_ns_value;
     uint8_t ns_friendly_units;
-    if (measured_period == 0.f) {
+    if (measured_freq == 0.f) {
         freq_ns_value = 0;
+    } else if (over_range) {
+        freq_ns_value = 1000000000.0 / gate_hz;
     } else {
-        freq_ns_value = ((float)1 / (float)(measured_period)) * (float)1000000000;
+        freq_ns_value = freq_stats_period_ticks(s) * 1000000000.0 / tick_hz;
     }
 
     freq_display_ns(&freq_ns_value, &ns_friendly_value, &ns_friendly_units);
 
     ui_term_erase_line();
-    printf("%s%s%s IO%s%d%s: %s%.2f%s%s %s%.2f%s%s (%s%.0f%sHz), %s%s:%s %s%.1f%s%%\r%s",
+    printf("%s%s%s IO%s%d%s: %s%.2f%s%s %s%.2f%s%s (%s%.0f%sHz), ",
            ui_term_color_info(),
            GET_T(T_MODE_FREQ_FREQUENCY),
            ui_term_color_reset(),
@@ -190,15 +234,43 @@ uint32_t freq_print(uint8_t pin, bool refresh) {
            ui_term_color_reset(),
            ui_const_freq_labels[ns_friendly_units],
            ui_term_color_num_float(),
-           measured_period,
-           ui_term_color_reset(),
-           ui_term_color_info(),
-           GET_T(T_MODE_FREQ_DUTY_CYCLE),
-           ui_term_color_reset(),
-           ui_term_color_num_float(),
-           measured_duty_cycle * 100.f,
-           ui_term_color_reset(),
-           (refresh ? "" : "\n"));
+           measured_freq,
+           ui_term_color_reset());
+    if (over_range) {
+        printf("%sgated count, above the %.1fMHz sampler range%s\r%s",
+               ui_term_color_warning(),
+               tick_hz / FREQ_RANGE_DIV / 1000000.0,
+               ui_term_color_reset(),
+               (refresh ? "" : "\n"));
+    } else {
+        printf("%s%s:%s %s%.1f%s%%\r%s",
+               ui_term_color_info(),
+               GET_T(T_MODE_FREQ_DUTY_CYCLE),
+               ui_term_color_reset(),
+               ui_term_color_num_float(),
+               measured_duty_cycle * 100.f,
+               ui_term_color_reset(),
+               (refresh ? "" : "\n"));
+    }
+
+    // single measurement: period spread from the same window, and how long that window is
+    if (!refresh && s->periods && !over_range) {
+        double ns_per_tick = 1000000000.0 / tick_hz;
+        printf(" Period min/max: %s%.0f/%.0f%sns, jitter: %s%.1f%sns, %s%lu%s periods over %s%.3f%sms\r\n",
+               ui_term_color_num_float(),
+               s->min_ticks * ns_per_tick,
+               s->max_ticks * ns_per_tick,
+               ui_term_color_reset(),
+               ui_term_color_num_float(),
+               freq_stats_jitter_ticks(s) * ns_per_tick,
+               ui_term_color_reset(),
+               ui_term_color_num_float(),
+               (unsigned long)s->periods,
+               ui_term_color_reset(),
+               ui_term_color_num_float(),
+               s->span_ticks * ns_per_tick / 1000000.0,
+               ui_term_color_reset());
+    }
 
     return 1;
 }
@@ -234,6 +306,10 @@ uint32_t freq_configure_enable(void) {
         return 0;
     }
 
+    if (!freq_pio_check_start()) {
+        return 0;
+    }
+
     // register the freq active, apply the pin label
     system_bio_update_purpose_and_label(true, (uint8_t)pin, BP_PIN_FREQ, ui_const_pin_states[4]);
     system_set_active(true, (uint8_t)pin, &system_config.freq_active);
@@ -248,6 +324,7 @@ uint32_t freq_configure_enable(void) {
            ui_term_color_reset());
 
     // initial measurement
+    freq_wait_for_periods((uint8_t)pin);
     freq_print((uint8_t)pin, false);
     return 1;
 }
@@ -285,14 +362,10 @@ uint32_t freq_configure_disable(void) {
         }
     }
 
-    // disable
-    pwm_set_enabled(pwm_gpio_to_slice_num(bio2bufiopin[(uint8_t)pin]), false);
-    gpio_set_function(bio2bufiopin[(uint8_t)pin], GPIO_FUNC_SIO);
-    bio_input((uint8_t)pin);
-
     // unregister, remove pin label
     system_bio_update_purpose_and_label(false, (uint8_t)pin, 0, 0);
     system_set_active(false, (uint8_t)pin, &system_config.freq_active);
+    freq_pio_check_stop();
 
     printf("\r\n%s%s:%s %s on IO%s%d%s",
            ui_term_color_notice(),
@@ -314,28 +387,17 @@ uint32_t freq_measure(int32_t pin, int refresh) {
         printf("Pin IO%d is invalid!", pin);
         return 0;
     }
-    // even pin with no freq
-    if (pwm_gpio_to_channel(bio2bufiopin[pin]) != PWM_CHAN_B) {
-        printf("IO%d has no frequency measurement hardware!\r\nFreq. measure is currently only possible on odd pins "
-               "(1,3,5,7).\r\nIn the future we will fix this using the RP2040 PIO.\r\n",
-               pin);
-        return 0;
-    }
-    // this pin or adjacent pin is PWM
-    if (system_config.pwm_active & (0b11 << ((uint8_t)(pin % 2 ? pin - 1 : pin)))) {
-        printf("IO%d is unavailable because IO%d or IO%d is in use as a frequency generator (PWM)!\r\nIn the future we "
-               "will fix this using the RP2040 PIO\r\n",
-               pin,
-               pin - 1,
-               pin);
-        return 0;
-    }
     // pin is in use for purposes other than freq
     if (system_config.pin_labels[pin + 1] != 0 && !(system_config.freq_active & (0x01 << ((uint8_t)pin)))) {
         printf("IO%d is in use by %s!\r\n", pin, system_config.pin_labels[pin + 1]);
         return 0;
     }
 
+    if (!freq_pio_check_start()) {
+        return 0;
+    }
+    freq_wait_for_periods((uint8_t)pin);
+
     // now do single or continuous measurement on the pin
     if (refresh) {
         // press any key to continue
@@ -346,122 +408,28 @@ uint32_t freq_measure(int32_t pin, int refresh) {
     // print once (also handles final \n for continuous mode)
     freq_print(pin, false);
 
+    freq_pio_check_stop();
     return 1;
 }
 
-// we pre-calculate the disable bitmask for the enable function
-// to avoid blowing out active PWM when we're done with a FREQ measure
-static volatile uint32_t freq_irq_disable_bitmask;
-// frequency measurement
-int64_t freq_timer_callback(alarm_id_t id, void* user_data) {
-    // disable all at once (but leave any other PWM slices running)
-    // turn off only the ones we turned on and don't turn on any other that weren't running already
-    pwm_set_mask_enabled(freq_irq_disable_bitmask & pwm_hw->en);
-    freq_irq_disable_bitmask = 0;
-    for (uint8_t i = 0; i < count_of(bio2bufiopin); i++) {
-        if (system_config.freq_active & (0x01 << i)) {
-            uint slice_num = pwm_gpio_to_slice_num(bio2bufiopin[i]);
-            gpio_set_function(bio2bufiopin[i], GPIO_FUNC_SIO);
-            uint16_t counter = (uint16_t)pwm_get_counter(slice_num);
-            float freq = counter * 100.f;
-            system_config.freq_config[i].period = freq;
-        }
-    }
-    return 0;
-}
-
-// trigger all frequency measurements at once using only one delay
+// update the pin display values from the counter, called with the LCD refresh
+// only reads the ring buffer, the measurement itself runs on PIO and DMA
 void freq_measure_period_irq(void) {
-    uint32_t mask = 0;
-
     // dont do anything if user has no active freq measurements
     if (system_config.freq_active == 0) {
         return;
     }
-    //dont do anything if the counters are running
-    if (freq_irq_disable_bitmask)
-        return;
 
+    freq_stats_t stats[FREQ_STATS_PINS];
+    if (!freq_pio_get_stats(FREQ_WINDOW_MS, stats)) {
+        return;
+    }
     for (uint8_t i = 0; i < count_of(bio2bufiopin); i++) {
         if (system_config.freq_active & (0x01 << i)) {
-            uint slice_num = pwm_gpio_to_slice_num(bio2bufiopin[i]);
-
-            pwm_config cfg = pwm_get_default_config();
-            pwm_config_set_clkdiv_mode(&cfg, PWM_DIV_B_RISING);
-            pwm_config_set_clkdiv(&cfg, 1);
-            pwm_init(slice_num, &cfg, false);
-            gpio_set_function(bio2bufiopin[i], GPIO_FUNC_PWM);
-            pwm_set_counter(slice_num, 0);
-
-            // build mask, slices 0-7...
-            mask |= (0x01 << slice_num);
+            system_config.freq_config[i].period = freq_stats_frequency(&stats[i], freq_pio_tick_hz());
+            system_config.freq_config[i].dutycycle = freq_stats_duty(&stats[i]);
         }
     }
-
-    freq_irq_disable_bitmask = ~mask;
-    //set the mask and the ones already running
-    pwm_set_mask_enabled(mask | pwm_hw->en);
-    add_alarm_in_ms(10, freq_timer_callback, NULL, false);
-}
-
-const uint max_gate_time_ms = 100;
-
-float freq_measure_period(uint gpio) {
-    // Only the PWM B pins can be used as inputs.
-    assert(pwm_gpio_to_channel(gpio) == PWM_CHAN_B);
-    uint slice_num = pwm_gpio_to_slice_num(gpio);
-    pwm_set_enabled(slice_num, false);
-    pwm_config cfg = pwm_get_default_config();
-    pwm_config_set_clkdiv_mode(&cfg, PWM_DIV_B_RISING);
-    pwm_config_set_clkdiv(&cfg, 1);
-    pwm_init(slice_num, &cfg, false);
-    gpio_set_function(gpio, GPIO_FUNC_PWM);
-    pwm_set_counter(slice_num, 0);
-
-    pwm_set_enabled(slice_num, true);
-    busy_wait_ms(1);
-    pwm_set_enabled(slice_num, false);
-
-    uint16_t counter = pwm_get_counter(slice_num);
-    float freq = counter * 1000;
-    if (counter < 0x8000) {
-        uint gate_time_ms = MIN((65000 / (counter ? counter : 1)), max_gate_time_ms);
-        pwm_set_counter(slice_num, 0);
-        pwm_set_enabled(slice_num, true);
-        busy_wait_ms(gate_time_ms);
-        pwm_set_enabled(slice_num, false);
-        counter = pwm_get_counter(slice_num);
-        freq = 1000.0f * counter / gate_time_ms;
-    }
-
-    gpio_set_function(gpio, GPIO_FUNC_SIO);
-    return freq;
-}
-
-float freq_measure_duty_cycle(uint gpio) {
-    // Only the PWM B pins can be used as inputs.
-    assert(pwm_gpio_to_channel(gpio) == PWM_CHAN_B);
-    uint slice_num = pwm_gpio_to_slice_num(gpio);
-    pwm_set_enabled(slice_num, false);
-    // Count once for every div cycles the PWM B input is high
-    pwm_config cfg = pwm_get_default_config();
-    pwm_config_set_clkdiv_mode(&cfg, PWM_DIV_B_HIGH);
-    // div set for max counter value at 100% duty cycle
-    uint div = (clock_get_hz(clk_sys) / 10 + 0xFFFE) / 0xFFFF;
-    pwm_config_set_clkdiv(&cfg, div);
-    pwm_init(slice_num, &cfg, false);
-    gpio_set_function(gpio, GPIO_FUNC_PWM);
-
-    pwm_set_counter(slice_num, 0);
-    pwm_set_enabled(slice_num, true);
-    busy_wait_ms(100);
-    pwm_set_enabled(slice_num, false);
-    uint16_t counter = pwm_get_counter(slice_num);
-    float counting_rate = clock_get_hz(clk_sys) / div;
-    float max_possible_count = counting_rate * 0.1;
-    gpio_set_function(gpio, GPIO_FUNC_SIO);
-
-    return counter / max_possible_count;
 }
 
 void freq_display_hz(float* freq_hz_value, float* freq_friendly_value, uint8_t* freq_friendly_units) {
@@ -496,107 +464,3 @@ void freq_display_ns(float* freq_ns_value, float* period_friendly_value, uint8_t
     }
     *period_friendly_value = (*freq_ns_value / (float)period_friendly_divider);
 }
-/*
-from micropython import const
-import rp2
-from rp2 import PIO, asm_pio
-
-@asm_pio(sideset_init=PIO.OUT_HIGH)
-def gate():
-    """PIO to generate gate signal."""
-    mov(x, osr)                                            # load gate time (in clock pulses) from osr
-    wait(0, pin, 0)                                        # wait for input to go low
-    wait(1, pin, 0)                                        # wait for input to go high - effectively giving us rising
-edge detection label("loopstart") jmp(x_dec, "loopstart") .side(0)                       # keep gate low for time
-programmed by setting x reg wait(0, pin, 0)                                        # wait for input to go low wait(1,
-pin, 0) .side(1)                               # set gate to high on rising edge irq(block, 0) # set interrupt 0 flag
-and wait for system handler to service interrupt wait(1, irq, 4)                                        # wait for irq
-from clock counting state machine wait(1, irq, 5)                                        # wait for irq from pulse
-counting state machine
-
-@asm_pio()
-def clock_count():
-    """PIO for counting clock pulses during gate low."""
-    mov(x, osr)                                            # load x scratch with max value (2^32-1)
-    wait(1, pin, 0)                                        # detect falling edge
-    wait(0, pin, 0)                                        # of gate signal
-    label("counter")
-    jmp(pin, "output")                                     # as long as gate is low //
-    jmp(x_dec, "counter")                                  # decrement x reg (counting every other clock cycle - have to
-multiply output value by 2) label("output") mov(isr, x)                                            # move clock count
-value to isr push()                                                 # send data to FIFO irq(block, 4) # set irq and wait
-for gate PIO to acknowledge
-
-@asm_pio(sideset_init=PIO.OUT_HIGH)
-def pulse_count():
-    """PIO for counting incoming pulses during gate low."""
-    mov(x, osr)                                            # load x scratch with max value (2^32-1)
-    wait(1, pin, 0)
-    wait(0, pin, 0) .side(0)                               # detect falling edge of gate
-    label("counter")
-    wait(0, pin, 1)                                        # wait for rising
-    wait(1, pin, 1)                                        # edge of input signal
-    jmp(pin, "output")                                     # as long as gate is low //
-    jmp(x_dec, "counter")                                  # decrement x req counting incoming pulses (probably will
-count one pulse less than it should - to be checked later) label("output") mov(isr, x) .side(1) # move pulse count value
-to isr and set pin to high to tell clock counting sm to stop counting push() # send data to FIFO irq(block, 5) # set irq
-and wait for gate PIO to acknowledge
-
-
-def init_sm(freq, input_pin, gate_pin, pulse_fin_pin):
-    """Starts state machines."""
-    gate_pin.value(1)
-    pulse_fin_pin.value(1)
-    max_count = const((1 << 32) - 1)
-
-    sm0 = rp2.StateMachine(0, gate, freq=freq, in_base=input_pin, sideset_base=gate_pin)
-    sm0.put(freq)
-    sm0.exec("pull()")
-
-    sm1 = rp2.StateMachine(1, clock_count, freq=freq, in_base=gate_pin, jmp_pin=pulse_fin_pin)
-    sm1.put(max_count)
-    sm1.exec("pull()")
-
-    sm2 = rp2.StateMachine(2, pulse_count, freq=freq, in_base=gate_pin, sideset_base = pulse_fin_pin, jmp_pin=gate_pin)
-    sm2.put(max_count-1)
-    sm2.exec("pull()")
-
-    sm1.active(1)
-    sm2.active(1)
-    sm0.active(1)
-
-    return sm0, sm1, sm2
-
-if __name__ == "__main__":
-    from machine import Pin
-    import uarray as array
-
-    update_flag = False
-    data = array.array("I", [0, 0])
-    def counter_handler(sm):
-        print("IRQ")
-        global update_flag
-        if not update_flag:
-            sm0.put(125_000)
-            sm0.exec("pull()")
-            data[0] = sm1.get() # clock count
-            data[1] = sm2.get() # pulse count
-            update_flag = True
-
-    sm0, sm1, sm2 = init_sm(125_000_000, Pin(15, Pin.IN, Pin.PULL_UP), Pin(14, Pin.OUT), Pin(13, Pin.OUT))
-    sm0.irq(counter_handler)
-
-    print("Starting test")
-    i = 0
-    while True:
-        if update_flag:
-            clock_count = 2*(max_count - data[0]+1)
-            pulse_count = max_count - data[1]
-            freq = pulse_count * (125000208.6 / clock_count)
-            print(i)
-            print("Clock count: {}".format(clock_count))
-            print("Input count: {}".format(pulse_count))
-            print("Frequency:   {}".format(freq))
-            i += 1
-            update_flag = False
-*/
\ No newline at end of file
@@ -2,7 +2,7 @@
  * @file freq.h
  * @brief Frequency measurement command interface (f/F commands).
  * @details Provides commands for measuring signal frequency and duty cycle
- *          on I/O pins using PWM hardware in counter mode.
+ *          on I/O pins using the PIO reciprocal counter (pirate/freq_pio.h).
  */
 
 /**
@@ -40,20 +40,6 @@ uint32_t freq_configure_disable(void);
  */
 uint32_t freq_configure_enable(void);
 
-/**
- * @brief Measure signal period on GPIO pin.
- * @param gpio  GPIO pin number
- * @return Period in microseconds
- */
-float freq_measure_period(uint gpio);
-
-/**
- * @brief Measure duty cycle on GPIO pin.
- * @param gpio  GPIO pin number
- * @return Duty cycle as percentage (0.0 to 100.0)
- */
-float freq_measure_duty_cycle(uint gpio);
-
 /**
  * @brief Convert frequency to human-readable format.
  * @param[in] freq_hz_value          Frequency in Hz
@@ -71,6 +57,6 @@ void freq_display_hz(float* freq_hz_value, float* freq_friendly_value, uint8_t*
 void freq_display_ns(float* freq_ns_value, float* period_friendly_value, uint8_t* period_friendly_units);
 
 /**
- * @brief IRQ handler for period measurement.
+ * @brief Update active pin frequency/duty values from the counter (LCD refresh).
  */
 void freq_measure_period_irq(void);
\ No newline at end of file
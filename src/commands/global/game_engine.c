@@ -14,6 +14,7 @@
 #include "ui/ui_toolbar.h"
 #include "usb_rx.h"
 #include "usb_tx.h"
+#include "pirate/mem.h"
 #include "game_engine.h"
 
 // ---------------------------------------------------------------------------
@@ -132,3 +133,51 @@ void game_tick_wait(uint32_t tick_start_us, int tick_ms) {
         busy_wait_ms(tick_ms - (int)elapsed_ms);
     }
 }
+
+// ---------------------------------------------------------------------------
+// Framebuffer
+// ---------------------------------------------------------------------------
+
+// one bulk write per present, flushed early only on full redraws
+#define GAME_FB_OUT_SIZE 2048
+
+cell_fb_t game_fb;
+static uint8_t* game_fb_mem;
+
+static void game_fb_write(void* ctx, const char* buf, size_t len) {
+    (void)ctx;
+    tx_fifo_write(buf, (uint32_t)len);
+}
+
+bool game_fb_begin(int top, int left, int rows, int cols) {
+    size_t cells = 2u * (size_t)rows * (size_t)cols;
+    if (rows <= 0 || cols <= 0 || cells * sizeof(cell_t) + GAME_FB_OUT_SIZE > BIG_BUFFER_SIZE) {
+        return false;
+    }
+    game_fb_mem = mem_alloc(BIG_BUFFER_SIZE, BP_BIG_BUFFER_GAME);
+    if (!game_fb_mem) {
+        return false;
+    }
+    cell_fb_init(&game_fb,
+                 (cell_t*)game_fb_mem,
+                 (uint16_t)rows,
+                 (uint16_t)cols,
+                 (char*)&game_fb_mem[cells * sizeof(cell_t)],
+                 GAME_FB_OUT_SIZE,
+                 game_fb_write,
+                 NULL);
+    cell_fb_origin(&game_fb, (uint16_t)top, (uint16_t)left);
+    game_fb.color = system_config.terminal_ansi_color;
+    return true;
+}
+
+void game_fb_end(void) {
+    if (game_fb_mem) {
+        mem_free(game_fb_mem);
+        game_fb_mem = NULL;
+    }
+}
+
+uint32_t game_present(void) {
+    return (uint32_t)cell_fb_present(&game_fb);
+}
@@ -17,10 +17,11 @@
  *   Inside the loop, use cursor positioning to overwrite content.
  *   Append \x1b[K after variable-length text lines to trim leftovers.
  *
- * - **Real-time games**: build a line buffer (char[] + color[]) per row,
- *   stamp all objects into it, then emit the whole row in one pass.
- *   End each row with \x1b[0m\x1b[K. Never clear rows before drawing.
- *   See crossflash.c emit_row() for the reference pattern.
+ * - **Real-time games**: draw every frame into the framebuffer
+ *   (game_fb_*) and call game_present(), which sends only the cells
+ *   that changed in one bulk write. See bricks.c and invaders.c.
+ *   The older pattern, a line buffer (char[] + color[]) per row emitted
+ *   in one pass and ended with \x1b[0m\x1b[K, is in crossflash.c emit_row().
  *
  * - One-shot clears for level transitions or game-over screens are OK.
  */
@@ -30,6 +31,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "lib/cell_fb/cell_fb.h"
 
 // ---------------------------------------------------------------------------
 // PRNG  (xorshift32 — replaces 14 per-game copies)
@@ -126,4 +128,54 @@ void game_input_drain(void);
  */
 void game_tick_wait(uint32_t tick_start_us, int tick_ms);
 
+// ---------------------------------------------------------------------------
+// Framebuffer  (front/back cell grids in the big buffer)
+// ---------------------------------------------------------------------------
+
+/**
+ * Allocate a rows x cols cell grid drawn at screen row top, column left
+ * (1-based). Colour follows the terminal setting.
+ *
+ * @return false if the big buffer is in use or the grid is too big.
+ */
+bool game_fb_begin(int top, int left, int rows, int cols);
+
+/** Release the grid. Safe to call when game_fb_begin() failed. */
+void game_fb_end(void);
+
+/** The grid, for the cell_fb_* drawing functions. */
+extern cell_fb_t game_fb;
+
+/** Fill the back grid with spaces. */
+static inline void game_fb_clear(void) {
+    cell_fb_clear(&game_fb, CELL_DEFAULT, 0);
+}
+
+/** One cell, 0-based inside the grid. */
+static inline void game_fb_put(int row, int col, uint16_t ch, uint8_t color, uint8_t style) {
+    cell_fb_put(&game_fb, row, col, ch, color, style);
+}
+
+/** UTF-8 text, returns the columns written. */
+static inline int game_fb_text(int row, int col, const char* text, uint8_t color, uint8_t style) {
+    return cell_fb_text(&game_fb, row, col, text, color, style);
+}
+
+/** The screen was cleared (\x1b[2J) or drawn over, redraw it all. */
+static inline void game_fb_invalidate(void) {
+    cell_fb_invalidate(&game_fb);
+}
+
+/** len cells were overwritten with printf. */
+static inline void game_fb_touch(int row, int col, int len) {
+    cell_fb_touch(&game_fb, row, col, len);
+}
+
+/**
+ * Send the cells that changed since the last present.
+ *
+ * @return bytes sent to the terminal
+ */
+uint32_t game_present(void);
+
 #endif // GAME_ENGINE_H
@@ -82,9 +82,6 @@ static const char* const barrier_art[] = {
 static const char* const grn = "\x1b[32m";
 static const char* const red = "\x1b[31m";
 static const char* const ylw = "\x1b[33m";
-static const char* const cyn = "\x1b[36m";
-static const char* const wht = "\x1b[1;37m";
-static const char* const mag = "\x1b[35m";
 static const char* const rst = "\x1b[0m";
 static const char* const dim = "\x1b[2m";
 
@@ -209,141 +206,86 @@ static int fleet_bottom_extent(invaders_state_t* gs) {
 // Drawing
 // ---------------------------------------------------------------------------
 
+// The framebuffer covers screen rows 1..status_row, screen row/col r, c is
+// cell r - 1, c - 1. Only the cells that changed since the last frame are sent.
+#define FB_MAX_W 120
+
 static void draw_status(invaders_state_t* gs, int status_row) {
-    ui_term_cursor_position(status_row, 1);
-    printf(" %sINVADERS%s S:%s%05d%s Hi:%s%05d%s x%s%d%s Lv:%s%d%s </>=move SPC=fire q=quit",
-           wht, rst, ylw, gs->score, rst, red, gs->hi_score, rst,
-           grn, gs->lives, rst, cyn, gs->level, rst);
-    printf("\x1b[K");
+    int r = status_row - 1;
+    int col = 0;
+    char num[8];
+
+    col += game_fb_text(r, col, " ", CELL_DEFAULT, 0);
+    col += game_fb_text(r, col, "INVADERS", CELL_COLOR(CELL_WHITE, 0), CELL_BOLD);
+    col += game_fb_text(r, col, " S:", CELL_DEFAULT, 0);
+    snprintf(num, sizeof(num), "%05d", gs->score);
+    col += game_fb_text(r, col, num, CELL_COLOR(CELL_YELLOW, 0), 0);
+    col += game_fb_text(r, col, " Hi:", CELL_DEFAULT, 0);
+    snprintf(num, sizeof(num), "%05d", gs->hi_score);
+    col += game_fb_text(r, col, num, CELL_COLOR(CELL_RED, 0), 0);
+    col += game_fb_text(r, col, " x", CELL_DEFAULT, 0);
+    snprintf(num, sizeof(num), "%d", gs->lives);
+    col += game_fb_text(r, col, num, CELL_COLOR(CELL_GREEN, 0), 0);
+    col += game_fb_text(r, col, " Lv:", CELL_DEFAULT, 0);
+    snprintf(num, sizeof(num), "%d", gs->level);
+    col += game_fb_text(r, col, num, CELL_COLOR(CELL_CYAN, 0), 0);
+    game_fb_text(r, col, " </>=move SPC=fire q=quit", CELL_DEFAULT, 0);
 }
 
-// Color palette indices for flicker-free line-buffer rendering
-#define CLR_0   0
-#define CLR_GRN 1
-#define CLR_RED 2
-#define CLR_YLW 3
-#define CLR_CYN 4
-#define CLR_WHT 5
-#define CLR_MAG 6
-
-static const char* const clr_lut[] = {
-    "\x1b[0m", "\x1b[32m", "\x1b[31m", "\x1b[33m",
-    "\x1b[36m", "\x1b[1;37m", "\x1b[35m",
-};
-
-#define ROW_BUF_W 120
-
-// Emit one composited row — no flicker (overwrite, never clear first)
-// NOTE: uses printf (custom _putchar) instead of libc putchar, which
-//       does not route to USB output on this bare-metal firmware.
-static void emit_row(int row, const char* rbuf, const uint8_t* rclr, int w) {
-    bool color = system_config.terminal_ansi_color;
-    ui_term_cursor_position(row, 1);
-    if (color) {
-        uint8_t cur = 255;
-        int span_start = 0;
-        for (int i = 0; i < w; i++) {
-            if (rclr[i] != cur) {
-                // Flush previous span
-                if (i > span_start) {
-                    printf("%.*s", i - span_start, &rbuf[span_start]);
-                }
-                cur = rclr[i];
-                printf("%s", clr_lut[cur]);
-                span_start = i;
-            }
-        }
-        // Flush final span
-        if (w > span_start) {
-            printf("%.*s", w - span_start, &rbuf[span_start]);
-        }
-        printf("\x1b[0m");
-    } else {
-        printf("%.*s", w, rbuf);
-    }
-    printf("\x1b[K");
+// Stamp one playfield cell at 1-based screen row, col
+static void stamp(invaders_state_t* gs, int row, int col, char ch, uint8_t color) {
+    if (row < 1 || row > gs->player_row) return;
+    game_fb_put(row - 1, col - 1, (uint8_t)ch, CELL_COLOR(color, 0), 0);
 }
 
 static void draw_frame(invaders_state_t* gs, int status_row) {
-    int w = gs->field_w;
-    if (w > ROW_BUF_W) w = ROW_BUF_W;
-    char rbuf[ROW_BUF_W];
-    uint8_t rclr[ROW_BUF_W];
+    game_fb_clear();
 
-    for (int row = 1; row <= gs->player_row; row++) {
-        memset(rbuf, ' ', w);
-        memset(rclr, CLR_0, w);
-
-        // --- Stamp enemies ---
-        for (int r = 0; r < INV_ROWS; r++) {
-            for (int c = 0; c < INV_COLS; c++) {
-                if (!gs->enemies[r][c].alive) continue;
-                int er, ec;
-                enemy_screen_pos(gs, r, c, &er, &ec);
-                if (er != row) continue;
-                uint8_t clr = (r == 0) ? CLR_RED : (r == 1) ? CLR_MAG : (r == 2) ? CLR_YLW : CLR_CYN;
-                const char* lbl = enemy_labels[gs->enemies[r][c].label_idx];
-                for (int k = 0; k < ENEMY_WIDTH; k++) {
-                    int pos = ec - 1 + k;
-                    if (pos >= 0 && pos < w) {
-                        rbuf[pos] = lbl[k];
-                        rclr[pos] = clr;
-                    }
-                }
-            }
-        }
-
-        // --- Stamp barriers ---
-        for (int i = 0; i < BARRIER_COUNT; i++) {
-            if (gs->barriers[i].hp <= 0 || gs->barriers[i].row != row) continue;
-            int idx = BARRIER_HP - gs->barriers[i].hp;
-            if (idx < 0) idx = 0;
-            if (idx > 3) idx = 3;
-            const char* art = barrier_art[idx];
-            int col0 = gs->barriers[i].col - 2 - 1;
-            for (int k = 0; k < 5; k++) {
-                int pos = col0 + k;
-                if (pos >= 0 && pos < w) {
-                    rbuf[pos] = art[k];
-                    rclr[pos] = CLR_GRN;
-                }
-            }
-        }
-
-        // --- Stamp bullets ---
-        for (int i = 0; i < MAX_BULLETS; i++) {
-            if (!gs->bullets[i].active || gs->bullets[i].row != row) continue;
-            int pos = gs->bullets[i].col - 1;
-            if (pos >= 0 && pos < w) {
-                rbuf[pos] = BULLET_CHAR;
-                rclr[pos] = CLR_YLW;
+    // --- Stamp enemies ---
+    for (int r = 0; r < INV_ROWS; r++) {
+        for (int c = 0; c < INV_COLS; c++) {
+            if (!gs->enemies[r][c].alive) continue;
+            int er, ec;
+            enemy_screen_pos(gs, r, c, &er, &ec);
+            uint8_t clr = (r == 0) ? CELL_RED : (r == 1) ? CELL_MAGENTA : (r == 2) ? CELL_YELLOW : CELL_CYAN;
+            const char* lbl = enemy_labels[gs->enemies[r][c].label_idx];
+            for (int k = 0; k < ENEMY_WIDTH; k++) {
+                stamp(gs, er, ec + k, lbl[k], clr);
             }
         }
+    }
 
-        // --- Stamp bombs ---
-        for (int i = 0; i < MAX_BOMBS; i++) {
-            if (!gs->bombs[i].active || gs->bombs[i].row != row) continue;
-            int pos = gs->bombs[i].col - 1;
-            if (pos >= 0 && pos < w) {
-                rbuf[pos] = BOMB_CHAR;
-                rclr[pos] = CLR_RED;
-            }
+    // --- Stamp barriers ---
+    for (int i = 0; i < BARRIER_COUNT; i++) {
+        if (gs->barriers[i].hp <= 0) continue;
+        int idx = BARRIER_HP - gs->barriers[i].hp;
+        if (idx < 0) idx = 0;
+        if (idx > 3) idx = 3;
+        const char* art = barrier_art[idx];
+        for (int k = 0; k < 5; k++) {
+            stamp(gs, gs->barriers[i].row, gs->barriers[i].col - 2 + k, art[k], CELL_GREEN);
         }
+    }
 
-        // --- Stamp player (last = on top) ---
-        if (row == gs->player_row) {
-            int pos = gs->player_x - 2;
-            if (pos >= 0 && pos < w) { rbuf[pos] = '/'; rclr[pos] = CLR_GRN; }
-            pos++;
-            if (pos >= 0 && pos < w) { rbuf[pos] = PLAYER_CHAR; rclr[pos] = CLR_GRN; }
-            pos++;
-            if (pos >= 0 && pos < w) { rbuf[pos] = '\\'; rclr[pos] = CLR_GRN; }
-        }
+    // --- Stamp bullets ---
+    for (int i = 0; i < MAX_BULLETS; i++) {
+        if (!gs->bullets[i].active) continue;
+        stamp(gs, gs->bullets[i].row, gs->bullets[i].col, BULLET_CHAR, CELL_YELLOW);
+    }
 
-        emit_row(row, rbuf, rclr, w);
+    // --- Stamp bombs ---
+    for (int i = 0; i < MAX_BOMBS; i++) {
+        if (!gs->bombs[i].active) continue;
+        stamp(gs, gs->bombs[i].row, gs->bombs[i].col, BOMB_CHAR, CELL_RED);
     }
 
+    // --- Stamp player (last = on top) ---
+    stamp(gs, gs->player_row, gs->player_x - 1, '/', CELL_GREEN);
+    stamp(gs, gs->player_row, gs->player_x, PLAYER_CHAR, CELL_GREEN);
+    stamp(gs, gs->player_row, gs->player_x + 1, '\\', CELL_GREEN);
+
     draw_status(gs, status_row);
+    game_present();
 }
 
 
@@ -455,6 +397,7 @@ static int check_bullet_hits(invaders_state_t* gs) {
                     // Erase enemy
                     ui_term_cursor_position(er, ec);
                     printf("%s*BAM*%s", ylw, rst);
+                    game_fb_touch(er - 1, ec - 1, 5);
                     break;
                 }
             }
@@ -536,6 +479,11 @@ void invaders_handler(struct command_result* res) {
 
     game_rng_seed();
 
+    if (!game_fb_begin(1, 1, gs.field_h, (gs.field_w < FB_MAX_W) ? gs.field_w : FB_MAX_W)) {
+        printf("Error: memory in use by another feature\r\n");
+        return;
+    }
+
     game_screen_enter(gs.field_h - 1);
 
     bool quit = false;
@@ -555,6 +503,7 @@ void invaders_handler(struct command_result* res) {
         bool game_over = false;
 
         printf("\x1b[2J");  // clear screen
+        game_fb_invalidate();
 
         // --- Game loop ---
         while (!game_over) {
@@ -614,6 +563,7 @@ void invaders_handler(struct command_result* res) {
                 // Flash player hit
                 ui_term_cursor_position(gs.player_row, gs.player_x - 1);
                 printf("%s*X*%s", red, rst);
+                game_fb_touch(gs.player_row - 1, gs.player_x - 2, 3);
                 tx_fifo_wait_drain();
                 busy_wait_ms(300);
             }
@@ -637,6 +587,7 @@ void invaders_handler(struct command_result* res) {
                 tx_fifo_wait_drain();
                 busy_wait_ms(1000);
                 printf("\x1b[2J");
+                game_fb_invalidate();
                 init_enemies(&gs);
                 init_barriers(&gs);
                 init_bullets(&gs);
@@ -690,4 +641,5 @@ void invaders_handler(struct command_result* res) {
     }
 
     game_screen_exit();
+    game_fb_end();
 }
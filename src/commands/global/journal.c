@@ -0,0 +1,199 @@
+/**
+ * @file journal.c
+ * @brief Bus syntax journal: record to a file, export to pcapng.
+ * @details - start opens the journal file, from then on every bytecode the
+ *            syntax runner executes is recorded with its time, in any mode
+ *          - stop writes out the ring and the final header
+ *          - export converts a journal file to pcapng: I2C as
+ *            LINKTYPE_I2C_LINUX messages, SPI and UART as USER0/USER1
+ *            packets with the direction in epb_flags, everything else
+ *            as raw records on a USER2 interface
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pirate.h"
+#include "command_struct.h"
+#include "fatfs/ff.h"
+#include "pirate/file.h"
+#include "lib/bp_args/bp_cmd.h"
+#include "lib/bus_journal/bus_journal.h"
+#include "syntax_journal.h"
+#include "ui/ui_term.h"
+#include "commands/global/journal.h"
+
+// records per file read during export
+#define JOURNAL_EXPORT_RECORDS 32
+
+enum journal_actions {
+    JOURNAL_START = 1,
+    JOURNAL_STOP,
+    JOURNAL_EXPORT,
+    JOURNAL_STATUS,
+};
+
+static const bp_command_action_t journal_action_defs[] = {
+    { JOURNAL_START,  "start",  T_HELP_GCMD_JOURNAL_START },
+    { JOURNAL_STOP,   "stop",   T_HELP_GCMD_JOURNAL_STOP },
+    { JOURNAL_EXPORT, "export", T_HELP_GCMD_JOURNAL_EXPORT },
+    { JOURNAL_STATUS, "status", T_HELP_GCMD_JOURNAL_STATUS },
+};
+
+static const char* const usage[] = {
+    "journal [start|stop|export|status] [-f <file>] [-o <pcapng file>]",
+    "Record all bus syntax to a file:%s journal start -f bus.bin",
+    "Stop recording:%s journal stop",
+    "Convert for Wireshark:%s journal export -f bus.bin -o bus.cap",
+    "Record:%s time us, mode, command, bits, flags, out data, in data",
+    "The file is written between commands, never during one",
+};
+
+static const bp_command_opt_t journal_opts[] = {
+    { "file",   'f', BP_ARG_REQUIRED, "file", T_HELP_GCMD_JOURNAL_FILE },
+    { "output", 'o', BP_ARG_REQUIRED, "file", T_HELP_GCMD_JOURNAL_OUTPUT },
+    { 0 }
+};
+
+const bp_command_def_t journal_def = {
+    .name         = "journal",
+    .description  = T_CMDLN_JOURNAL,
+    .actions      = journal_action_defs,
+    .action_count = count_of(journal_action_defs),
+    .opts         = journal_opts,
+    .usage        = usage,
+    .usage_count  = count_of(usage),
+};
+
+static bus_journal_pcap_t pcap;
+
+static uint32_t journal_pcap_write(void* ctx, const uint8_t* data, uint32_t len) {
+    UINT bw;
+    if (f_write((FIL*)ctx, data, len, &bw) != FR_OK) {
+        return 0;
+    }
+    return bw;
+}
+
+static void journal_status(void) {
+    if (!syntax_journal_enabled) {
+        printf("Journal off\r\n");
+        return;
+    }
+    printf("Journal to %s%s%s: %lu records, %lu lost, %lu queued\r\n",
+           ui_term_color_info(),
+           syntax_journal_filename(),
+           ui_term_color_reset(),
+           (unsigned long)syntax_journal.records,
+           (unsigned long)syntax_journal.lost,
+           (unsigned long)bus_journal_level(&syntax_journal));
+}
+
+static bool journal_export(const char* in_name, const char* out_name) {
+    FIL in, out;
+    if (file_open(&in, in_name, FA_READ)) {
+        return false;
+    }
+    bus_journal_header_t header;
+    uint32_t n;
+    if (file_read(&in, (uint8_t*)&header, sizeof(header), &n)) {
+        return false; // closed on error
+    }
+    if (n != sizeof(header) || !bus_journal_header_check(&header)) {
+        printf("%s is not a journal file\r\n", in_name);
+        file_close(&in);
+        return false;
+    }
+    if (file_open(&out, out_name, FA_CREATE_ALWAYS | FA_WRITE)) {
+        file_close(&in);
+        return false;
+    }
+
+    bus_journal_pcap_begin(&pcap, journal_pcap_write, &out);
+    bus_journal_record_t records[JOURNAL_EXPORT_RECORDS];
+    uint32_t total = 0;
+    while (!pcap.error) {
+        if (file_read(&in, (uint8_t*)records, sizeof(records), &n)) {
+            file_close(&out);
+            return false;
+        }
+        for (uint32_t i = 0; i < n / sizeof(bus_journal_record_t); i++) {
+            bus_journal_pcap_record(&pcap, &records[i]);
+        }
+        total += n / sizeof(bus_journal_record_t);
+        if (n < sizeof(records)) {
+            break;
+        }
+    }
+    bool ok = bus_journal_pcap_end(&pcap);
+    file_close(&in);
+    file_close(&out);
+    if (!ok) {
+        printf("Error: write to %s failed\r\n", out_name);
+        return false;
+    }
+    printf("%lu records, %lu lost while recording, %lu packets written to %s\r\n",
+           (unsigned long)total,
+           (unsigned long)header.lost,
+           (unsigned long)pcap.packets,
+           out_name);
+    return true;
+}
+
+void journal_handler(struct command_result* res) {
+    if (bp_cmd_help_check(&journal_def, res->help_flag)) {
+        return;
+    }
+    uint32_t action;
+    if (!bp_cmd_get_action(&journal_def, &action)) {
+        bp_cmd_help_show(&journal_def);
+        return;
+    }
+
+    char filename[13];
+    char outname[13];
+    switch (action) {
+        case JOURNAL_START:
+            if (syntax_journal_enabled) {
+                printf("Journal already recording to %s\r\n", syntax_journal_filename());
+                res->error = true;
+                return;
+            }
+            if (!bp_file_get_name_flag(&journal_def, 'f', filename, sizeof(filename))) {
+                res->error = true;
+                return;
+            }
+            if (!syntax_journal_start(filename)) {
+                res->error = true;
+                return;
+            }
+            printf("Journal recording to %s\r\n", filename);
+            break;
+        case JOURNAL_STOP:
+            if (!syntax_journal_enabled) {
+                printf("Journal off\r\n");
+                return;
+            }
+            journal_status();
+            syntax_journal_stop();
+            break;
+        case JOURNAL_EXPORT:
+            if (!bp_file_get_name_flag(&journal_def, 'f', filename, sizeof(filename)) ||
+                !bp_file_get_name_flag(&journal_def, 'o', outname, sizeof(outname))) {
+                res->error = true;
+                return;
+            }
+            if (syntax_journal_enabled && !strcmp(filename, syntax_journal_filename())) {
+                printf("Stop the journal first\r\n");
+                res->error = true;
+                return;
+            }
+            if (!journal_export(filename, outname)) {
+                res->error = true;
+            }
+            break;
+        case JOURNAL_STATUS:
+            journal_status();
+            break;
+    }
+}
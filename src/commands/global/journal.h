@@ -0,0 +1,13 @@
+/**
+ * @file journal.h
+ * @brief Bus syntax journal command interface.
+ * @details Starts and stops the syntax journal (syntax_journal.c) and
+ *          exports journal files to pcapng (lib/bus_journal).
+ */
+
+/**
+ * @brief Handler for journal command.
+ * @param res  Command result structure
+ */
+void journal_handler(struct command_result* res);
+extern const struct bp_command_def journal_def;
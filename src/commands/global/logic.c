@@ -36,6 +36,7 @@ static const bp_command_opt_t logic_opts[] = {
     { "lowchar",    '0', BP_ARG_REQUIRED, "char",   T_HELP_LOGIC_LOW_CHAR },
     { "highchar",   '1', BP_ARG_REQUIRED, "char",   T_HELP_LOGIC_HIGH_CHAR },
     { "debug",      'd', BP_ARG_REQUIRED, "level",  T_HELP_LOGIC_DEBUG },
+    { "change",     'c', BP_ARG_REQUIRED, "0|1",    T_HELP_LOGIC_CHANGE },
     { "base",       'b', BP_ARG_REQUIRED, "pin",    T_HELP_LOGIC_INFO },  // undocumented
     { 0 }
 };
@@ -43,13 +44,14 @@ static const bp_command_opt_t logic_opts[] = {
 static const char* const usage[] = {
     "logic analyzer usage",
     "logic\t[start|stop|hide|show|nav]",
-    "\t[-i] [-g] [-o oversample] [-f frequency] [-d debug]",
+    "\t[-i] [-g] [-o oversample] [-f frequency] [-d debug] [-c 0|1]",
     "start logic analyzer:%s logic start",
     "stop logic analyzer:%s logic stop",
     "hide logic analyzer:%s logic hide",
     "show logic analyzer:%s logic show",
     "navigate logic analyzer:%s logic nav",
     "configure logic analyzer:%s logic -i -o 8 -f 1000000 -d 0",
+    "record pin changes only (long idle captures):%s logic -c 1",
     #if (BP_VER == 5 || BP_VER == XL5)
         "set base pin (0=bufdir, 8=bufio):%s -b: logic -b 8",
     #elif (BP_VER == 6 || BP_VER == 7)
@@ -152,6 +154,8 @@ void logic_handler(struct command_result* res) {
     bool has_frequency = bp_cmd_get_uint32(&logic_def, 'f', &frequency); // frequency: set sample rate
     uint32_t debug_level;
     bool has_debug = bp_cmd_get_uint32(&logic_def, 'd', &debug_level); // debug: set debug level
+    uint32_t change_capture;
+    bool has_change = bp_cmd_get_uint32(&logic_def, 'c', &change_capture); // change: record changes only
     char low_char[3];
     bool has_low_char = bp_cmd_get_string(&logic_def, '0', low_char, sizeof(low_char)); // low: set low char
     char high_char[3];
@@ -191,6 +195,18 @@ void logic_handler(struct command_result* res) {
         has_ok = true;
     }
 
+    if (has_change) {
+        if (change_capture > 1) {
+            printf("Error: change capture must be 0 or 1, '%d' is invalid\r\n", change_capture);
+            res->error = true;
+            return;
+        }
+        printf("Change capture: %s\r\n", change_capture ? "on" : "off");
+        // update fala config struct
+        fala_config.change_capture = change_capture;
+        has_ok = true;
+    }
+
     if (has_oversample) {
         if (oversample < 1) {
             printf("Error: oversample rate must be greater than 0, '%d' is invalid\r\n", oversample);
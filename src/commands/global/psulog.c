@@ -0,0 +1,268 @@
+/**
+ * @file psulog.c
+ * @brief PSU voltage and current data logger.
+ * @details Logs the onboard power supply at up to the full ADC rate:
+ *          - The PSU guard samples VOUT and current sense in round robin by
+ *            DMA and hands every pair to the lib/psu_log reducer from its
+ *            timer interrupt (pirate/psu_guard.c), protection keeps running
+ *          - Each block of pairs becomes a min/max/mean/energy record in a
+ *            64K ring in the big buffer
+ *          - The main loop drains the ring to a file in 4096 byte, sector
+ *            aligned writes, or to the binmode USB port with -s
+ *          - Without a file or stream the session min/max/energy is shown
+ *
+ *          Time the ADC is lent to other users (LCD refresh, fuse poll) is
+ *          kept in the time base, records that lost samples are flagged.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pirate.h"
+#include "system_config.h"
+#include "command_struct.h"
+#include "fatfs/ff.h"
+#include "pirate/file.h"
+#include "pirate/mem.h"
+#include "pirate/psu.h"
+#include "pirate/psu_guard.h"
+#include "display/scope.h"
+#include "lib/bp_args/bp_cmd.h"
+#include "lib/psu_log/psu_log.h"
+#include "ui/ui_term.h"
+#include "usb_rx.h"
+#include "usb_tx.h"
+#include "commands/global/psulog.h"
+
+#define PSULOG_RING_SIZE (64 * 1024)
+// whole NAND sectors, FatFs writes them without going through its sector buffer
+#define PSULOG_CHUNK 4096
+// 96 ADC clocks per conversion, two conversions per pair
+#define PSULOG_FULL_RATE_NS 4000
+#define PSULOG_STATUS_US 500000
+// VOUT has a /2 divider, current sense is 500mA full scale
+#define PSULOG_VOUT_SCALE (6.6f / 4096.0f)
+#define PSULOG_CURRENT_SCALE (0.5f / 4095.0f)
+
+static const char* const usage[] = {
+    "psulog [-f <file>] [-s(tream)] [-r <samples/s>] [-t <us>]",
+    "Log at the full ADC rate, 1ms records:%s psulog -f psu.bin",
+    "10k samples/s, 100ms records:%s psulog -f psu.bin -r 10000 -t 100000",
+    "Stream the records to the binmode USB port:%s psulog -s",
+    "Show min/max and energy only:%s psulog",
+    "Record:%s VOUT and current min, mean x16, max (ADC counts), pairs, flags, energy nJ",
+    "Any key stops the log",
+};
+
+static const bp_val_constraint_t rate_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 1000, .max = 250000, .def = 250000 },
+};
+
+static const bp_val_constraint_t interval_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 100, .max = 1000000, .def = 1000 },
+};
+
+static const bp_command_opt_t psulog_opts[] = {
+    { "file",     'f', BP_ARG_REQUIRED, "file",      T_HELP_GCMD_PSULOG_FILE },
+    { "stream",   's', BP_ARG_NONE,     NULL,        T_HELP_GCMD_PSULOG_STREAM },
+    { "rate",     'r', BP_ARG_REQUIRED, "samples/s", T_HELP_GCMD_PSULOG_RATE, &rate_range },
+    { "interval", 't', BP_ARG_REQUIRED, "us",        T_HELP_GCMD_PSULOG_INTERVAL, &interval_range },
+    { 0 }
+};
+
+const bp_command_def_t psulog_def = {
+    .name         = "psulog",
+    .description  = T_CMDLN_PSULOG,
+    .actions      = NULL,
+    .action_count = 0,
+    .opts         = psulog_opts,
+    .usage        = usage,
+    .usage_count  = count_of(usage),
+};
+
+typedef struct {
+    FIL* file;
+    bool stream;
+    bool error;
+} psulog_sink_t;
+
+static uint32_t psulog_write(void* ctx, const uint8_t* data, uint32_t len) {
+    psulog_sink_t* sink = ctx;
+    if (sink->stream) {
+        // a host that is not reading backs up into the ring
+        return bin_tx_fifo_try_write((const char*)data, len);
+    }
+    if (sink->file) {
+        UINT bw;
+        if (f_write(sink->file, data, len, &bw) != FR_OK || bw != len) {
+            sink->error = true;
+            return 0;
+        }
+    }
+    return len;
+}
+
+static void psulog_status(const psu_log_reduce_t* r, const psu_log_ring_t* ring) {
+    if (r->vout_low > r->vout_high) {
+        return; // nothing yet
+    }
+    uint32_t vlow = (r->vout_low * 6600u) / 4096, vhigh = (r->vout_high * 6600u) / 4096;
+    uint32_t ilow = (r->current_low * 500000u) / 4095, ihigh = (r->current_high * 500000u) / 4095;
+    uint32_t energy_uj = (uint32_t)(r->energy_nj / 1000);
+    printf("\r%sVOUT%s %d.%03d-%d.%03dV %sI%s %d.%03d-%d.%03dmA %s%d.%03dmJ%s %d records, %d lost ",
+           ui_term_color_info(),
+           ui_term_color_reset(),
+           vlow / 1000,
+           vlow % 1000,
+           vhigh / 1000,
+           vhigh % 1000,
+           ui_term_color_info(),
+           ui_term_color_reset(),
+           ilow / 1000,
+           ilow % 1000,
+           ihigh / 1000,
+           ihigh % 1000,
+           ui_term_color_num_float(),
+           energy_uj / 1000,
+           energy_uj % 1000,
+           ui_term_color_reset(),
+           r->records,
+           ring->lost);
+}
+
+void psulog_handler(struct command_result* res) {
+    if (bp_cmd_help_check(&psulog_def, res->help_flag)) {
+        return;
+    }
+
+    uint32_t rate, interval_us;
+    if (bp_cmd_flag(&psulog_def, 'r', &rate) == BP_CMD_INVALID ||
+        bp_cmd_flag(&psulog_def, 't', &interval_us) == BP_CMD_INVALID) {
+        res->error = true;
+        return;
+    }
+    psulog_sink_t sink = { NULL, bp_cmd_find_flag(&psulog_def, 's'), false };
+    bool to_file = bp_cmd_find_flag(&psulog_def, 'f');
+    if (sink.stream && to_file) {
+        printf("Log to a file or stream it, not both\r\n");
+        res->error = true;
+        return;
+    }
+    if (!psu_status.enabled) {
+        printf("Power supply is off, enable it with W\r\n");
+        res->error = true;
+        return;
+    }
+    if (scope_running) {
+        printf("The scope is using the ADC\r\n");
+        res->error = true;
+        return;
+    }
+
+    // the ADC clock divider sets the pair period in 125ns steps
+    uint32_t pair_ns = MAX(((1000000000u / rate) / 125) * 125, PSULOG_FULL_RATE_NS);
+    uint32_t block_pairs = (uint32_t)(((uint64_t)interval_us * 1000) / pair_ns);
+    if (block_pairs < 1 || block_pairs > 0xffff) {
+        printf("Record interval must be %d to %d us at this rate\r\n",
+               (pair_ns + 999) / 1000,
+               (uint32_t)(((uint64_t)0xffff * pair_ns) / 1000));
+        res->error = true;
+        return;
+    }
+
+    char filename[13];
+    FIL file;
+    if (to_file) {
+        if (!bp_file_get_name_flag(&psulog_def, 'f', filename, sizeof(filename))) {
+            res->error = true;
+            return;
+        }
+        if (file_open(&file, filename, FA_CREATE_ALWAYS | FA_WRITE)) {
+            res->error = true;
+            return;
+        }
+        sink.file = &file;
+    }
+
+    uint8_t* mem = mem_alloc(PSULOG_RING_SIZE, BP_BIG_BUFFER_PSULOG);
+    if (!mem) {
+        if (to_file) {
+            file_close(&file);
+        }
+        res->error = true;
+        return;
+    }
+
+    psu_log_ring_t ring;
+    psu_log_header_t header;
+    psu_log_reduce_t reduce;
+    psu_log_ring_init(&ring, mem, PSULOG_RING_SIZE);
+    psu_log_header_init(&header, pair_ns, block_pairs, PSULOG_VOUT_SCALE, PSULOG_CURRENT_SCALE);
+    if (to_file || sink.stream) {
+        psu_log_ring_put(&ring, &header, sizeof(header));
+    }
+    uint16_t settle = (uint16_t)((60000 + pair_ns - 1) / pair_ns); // same as the guard
+    psu_log_reduce_init(&reduce, &ring, block_pairs, pair_ns, PSULOG_VOUT_SCALE, PSULOG_CURRENT_SCALE, settle);
+
+    bool binmode_tx = system_config.binmode_usb_tx_queue_enable;
+    if (sink.stream) {
+        system_config.binmode_usb_tx_queue_enable = true;
+    }
+    if (!psu_guard_log_start(pair_ns, &reduce)) {
+        printf("Error: no free DMA channels\r\n");
+        res->error = true;
+        goto psulog_cleanup;
+    }
+
+    printf("%d samples/s, %d us records, any key to stop\r\n", 1000000000u / pair_ns, (block_pairs * pair_ns) / 1000);
+    uint32_t chunk = to_file ? PSULOG_CHUNK : 1;
+    uint32_t status_us = time_us_32();
+    char c;
+    while (true) {
+        if (!psu_guard_logging()) {
+            printf("\r\nPower supply turned off\r\n");
+            break;
+        }
+        psu_log_ring_drain(&ring, chunk, psulog_write, &sink);
+        if (sink.error) {
+            printf("\r\nError: write to %s failed\r\n", filename);
+            break;
+        }
+        if (rx_fifo_try_get(&c)) {
+            break;
+        }
+        if ((time_us_32() - status_us) >= PSULOG_STATUS_US) {
+            status_us = time_us_32();
+            psulog_status(&reduce, &ring);
+        }
+    }
+    psu_guard_log_stop();
+
+    // the reducer is ours again, write out the rest
+    psu_log_reduce_flush(&reduce);
+    status_us = time_us_32();
+    while (!sink.error && psu_log_ring_level(&ring)) {
+        psu_log_ring_drain(&ring, 1, psulog_write, &sink);
+        if ((time_us_32() - status_us) >= PSULOG_STATUS_US) {
+            break; // host stopped reading the stream
+        }
+    }
+    psulog_status(&reduce, &ring);
+    printf("\r\n");
+    if (to_file && !sink.error) {
+        header.records = reduce.records - ring.lost;
+        header.lost = ring.lost;
+        f_lseek(&file, 0);
+        file_write(&file, (uint8_t*)&header, sizeof(header));
+        printf("%d bytes written to %s\r\n", sizeof(header) + header.records * sizeof(psu_log_record_t), filename);
+    }
+
+psulog_cleanup:
+    system_config.binmode_usb_tx_queue_enable = binmode_tx;
+    mem_free(mem);
+    if (to_file) {
+        file_close(&file);
+    }
+}
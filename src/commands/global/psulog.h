@@ -0,0 +1,13 @@
+/**
+ * @file psulog.h
+ * @brief PSU data logger command interface.
+ * @details Logs VOUT and current at up to the full ADC rate as
+ *          min/max/mean/energy records (lib/psu_log).
+ */
+
+/**
+ * @brief Handler for psulog command.
+ * @param res  Command result structure
+ */
+void psulog_handler(struct command_result* res);
+extern const struct bp_command_def psulog_def;
@@ -100,7 +100,6 @@ bool pwm_check_pin_is_available(uint32_t i) {
     #endif
 
     return (system_config.pin_labels[i + 1] == 0 &&
-            !(system_config.freq_active & (0b11 << ((uint8_t)(i % 2 ? i - 1 : i)))) &&
             !(system_config.pwm_active & (0b11 << ((uint8_t)(i % 2 ? i - 1 : i)))));
 }
 
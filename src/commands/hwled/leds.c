@@ -0,0 +1,309 @@
+// LED strip frame engine commands
+//
+// Frames are raw files, one frame after another, `channels` bytes per pixel
+// in wire order (see lib/led_frame). Each frame is packed into PIO words
+// with the gamma/brightness table applied and sent in one DMA transfer, so
+// a long strip costs the same CPU time as a short one.
+//
+// While a frame is on the wire the next one is read and packed into the
+// second buffer. Playback is locked to the frame rate: frame n starts at
+// start + n * period, frames that could not start on time are counted late.
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pirate.h"
+#include "command_struct.h"
+#include "bytecode.h"
+#include "fatfs/ff.h"
+#include "pirate/file.h"
+#include "pirate/mem.h"
+#include "hardware/pio.h"
+#include "pio_config.h"
+#include "mode/hwled.h"
+#include "lib/bp_args/bp_cmd.h"
+#include "lib/led_frame/led_frame.h"
+#include "ui/ui_help.h"
+#include "usb_rx.h"
+#include "leds.h"
+
+#define LEDS_MAX_PIXELS 8192
+
+static const char* const usage[] = {
+    "leds [show|play|bench] [-f <file>] [-n <pixels>] [-w(rgbw)] [-g <gamma>] [-b <brightness>] [-r <fps>] [-l(oop)]",
+    "Show the first frame in a file:%s leds show -f frame.bin",
+    "Show 300 RGBW pixels, gamma 2.2, half brightness:%s leds show -f frame.bin -n 300 -w -g 2.2 -b 128",
+    "Play 1000 pixel frames at 30 fps, loop:%s leds play -f movie.bin -n 1000 -r 30 -l",
+    "Frames/sec for 300, 1000, 4000 pixels:%s leds bench",
+    "File format:%s raw bytes, 3 per pixel (4 with -w), frames back to back",
+    "APA102 with -w:%s first byte of each pixel is the brightness header",
+};
+
+enum leds_actions {
+    LEDS_SHOW = 0,
+    LEDS_PLAY,
+    LEDS_BENCH,
+};
+
+static const bp_command_action_t leds_action_defs[] = {
+    { LEDS_SHOW,  "show",  T_HELP_HWLED_LEDS_SHOW },
+    { LEDS_PLAY,  "play",  T_HELP_HWLED_LEDS_PLAY },
+    { LEDS_BENCH, "bench", T_HELP_HWLED_LEDS_BENCH },
+};
+
+static const bp_val_constraint_t pixels_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 1, .max = LEDS_MAX_PIXELS, .def = 0 },
+};
+
+static const bp_val_constraint_t gamma_range = {
+    .type = BP_VAL_FLOAT,
+    .f = { .min = 0.1f, .max = 5.0f, .def = 1.0f },
+};
+
+static const bp_val_constraint_t brightness_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 0, .max = 255, .def = 255 },
+};
+
+static const bp_val_constraint_t rate_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 1, .max = 1000, .def = 30 },
+};
+
+static const bp_command_opt_t leds_opts[] = {
+    { "file",       'f', BP_ARG_REQUIRED, "file",  T_HELP_HWLED_LEDS_FILE_FLAG },
+    { "pixels",     'n', BP_ARG_REQUIRED, "count", T_HELP_HWLED_LEDS_PIXELS_FLAG, &pixels_range },
+    { "rgbw",       'w', BP_ARG_NONE,     NULL,    T_HELP_HWLED_LEDS_RGBW_FLAG },
+    { "gamma",      'g', BP_ARG_REQUIRED, "gamma", T_HELP_HWLED_LEDS_GAMMA_FLAG, &gamma_range },
+    { "brightness", 'b', BP_ARG_REQUIRED, "0-255", T_HELP_HWLED_LEDS_BRIGHTNESS_FLAG, &brightness_range },
+    { "rate",       'r', BP_ARG_REQUIRED, "fps",   T_HELP_HWLED_LEDS_RATE_FLAG, &rate_range },
+    { "loop",       'l', BP_ARG_NONE,     NULL,    T_HELP_HWLED_LEDS_LOOP_FLAG },
+    { 0 }
+};
+
+const bp_command_def_t leds_def = {
+    .name         = "leds",
+    .description  = T_HWLED_CMD_LEDS,
+    .actions      = leds_action_defs,
+    .action_count = count_of(leds_action_defs),
+    .opts         = leds_opts,
+    .usage        = usage,
+    .usage_count  = count_of(usage),
+};
+
+typedef struct {
+    led_frame_format_t format;
+    uint32_t pixels;
+    uint32_t words;       // pixel words + APA102 end frame
+    uint32_t* frame[2];   // double buffered PIO words
+    uint8_t* raw;         // one frame from the file
+    uint8_t lut[256];
+} leds_engine_t;
+
+// buffers for two frames and one raw frame, from the big buffer
+static bool leds_engine_init(leds_engine_t* e, uint8_t* mem, uint32_t pixels) {
+    e->pixels = pixels;
+    e->words = pixels + led_frame_end_words(&e->format, pixels);
+    uint32_t frame_bytes = e->words * sizeof(uint32_t);
+    if (2 * frame_bytes + pixels * e->format.channels > BIG_BUFFER_SIZE) {
+        return false;
+    }
+    e->frame[0] = (uint32_t*)mem;
+    e->frame[1] = (uint32_t*)(mem + frame_bytes);
+    e->raw = mem + 2 * frame_bytes;
+    // the end frame never changes
+    for (uint32_t i = pixels; i < e->words; i++) {
+        e->frame[0][i] = 0xffffffff;
+        e->frame[1][i] = 0xffffffff;
+    }
+    return true;
+}
+
+// read and pack the next frame, rewinds at the end of the file when looping
+static bool leds_read_frame(leds_engine_t* e, FIL* fil, uint32_t* words, bool loop) {
+    uint32_t frame_bytes = e->pixels * e->format.channels;
+    uint32_t bytes_read;
+    if (file_read(fil, e->raw, frame_bytes, &bytes_read)) {
+        return false;
+    }
+    if (bytes_read < frame_bytes && loop) {
+        f_lseek(fil, 0);
+        if (file_read(fil, e->raw, frame_bytes, &bytes_read)) {
+            return false;
+        }
+    }
+    if (bytes_read < frame_bytes) {
+        return false;
+    }
+    led_frame_pack(&e->format, e->raw, e->pixels, words);
+    return true;
+}
+
+static void leds_print_fps(const char* label, uint32_t pixels, uint32_t frame_us) {
+    uint32_t fps10 = frame_us ? (10000000u + frame_us / 2) / frame_us : 0;
+    printf("%s %4d pixels: %6d us/frame, %4d.%d frames/sec\r\n", label, pixels, frame_us, fps10 / 10, fps10 % 10);
+}
+
+static void leds_bench(leds_engine_t* e, uint8_t* mem) {
+    const uint32_t sizes[] = { 300, 1000, 4000 };
+    uint32_t bitrate = hwled_get_speed();
+    printf("%d bits/sec, black frames are sent to measure\r\n", bitrate);
+    for (uint8_t i = 0; i < count_of(sizes); i++) {
+        leds_engine_init(e, mem, sizes[i]);
+        memset(e->raw, 0, sizes[i] * e->format.channels);
+        led_frame_pack(&e->format, e->raw, e->pixels, e->frame[0]);
+        leds_print_fps("Wire   ", sizes[i], led_frame_time_us(&e->format, sizes[i], bitrate));
+
+        // frame to frame time with the reset, average of a few frames
+        const uint32_t frames = 4;
+        hwled_frame_show(e->frame[0], e->words);
+        uint64_t start_us = time_us_64();
+        for (uint32_t f = 0; f < frames; f++) {
+            hwled_frame_show(e->frame[0], e->words);
+        }
+        hwled_frame_wait();
+        leds_print_fps("Measured", sizes[i], (uint32_t)((time_us_64() - start_us) / frames));
+    }
+}
+
+static void leds_play(leds_engine_t* e, FIL* fil, uint32_t fps, bool loop) {
+    uint32_t period_us = 1000000u / fps;
+    uint32_t frame_us = led_frame_time_us(&e->format, e->pixels, hwled_get_speed());
+    if (frame_us > period_us) {
+        leds_print_fps("Warning: wire limit", e->pixels, frame_us);
+    }
+    printf("Playing at %d frames/sec, any key to stop\r\n", fps);
+
+    uint8_t cur = 0;
+    uint32_t frames = 0, late = 0;
+    uint64_t start_us = time_us_64();
+    uint64_t next_us = start_us;
+    char c;
+    while (true) {
+        busy_wait_until(from_us_since_boot(next_us));
+        hwled_frame_show(e->frame[cur], e->words);
+        frames++;
+        next_us += period_us;
+        // DMA is sending this frame, fill the other buffer
+        cur ^= 1;
+        if (!leds_read_frame(e, fil, e->frame[cur], loop)) {
+            break;
+        }
+        if (time_us_64() > next_us) {
+            late++;
+        }
+        if (rx_fifo_try_get(&c)) {
+            break;
+        }
+    }
+    hwled_frame_wait();
+    uint32_t elapsed_ms = (uint32_t)((time_us_64() - start_us) / 1000);
+    printf("%d frames in %d ms, %d late\r\n", frames, elapsed_ms, late);
+}
+
+void leds_handler(struct command_result* res) {
+    if (bp_cmd_help_check(&leds_def, res->help_flag)) {
+        return;
+    }
+
+    uint32_t action;
+    if (!bp_cmd_get_action(&leds_def, &action)) {
+        bp_cmd_help_show(&leds_def);
+        return;
+    }
+
+    leds_engine_t e;
+    uint32_t pixels, brightness, fps;
+    float gamma;
+    if (bp_cmd_flag(&leds_def, 'n', &pixels) == BP_CMD_INVALID ||
+        bp_cmd_flag(&leds_def, 'g', &gamma) == BP_CMD_INVALID ||
+        bp_cmd_flag(&leds_def, 'b', &brightness) == BP_CMD_INVALID ||
+        bp_cmd_flag(&leds_def, 'r', &fps) == BP_CMD_INVALID) {
+        res->error = true;
+        return;
+    }
+    bool rgbw = bp_cmd_find_flag(&leds_def, 'w');
+    bool loop = bp_cmd_find_flag(&leds_def, 'l');
+
+    e.format.device = (hwled_mode_config.device == M_LED_APA102) ? LED_FRAME_APA102 : LED_FRAME_WS2812;
+    e.format.channels = rgbw ? 4 : 3;
+    e.format.lut = NULL;
+    if (gamma != 1.0f || brightness != 255) {
+        led_frame_lut(e.lut, gamma, (uint8_t)brightness);
+        e.format.lut = e.lut;
+    }
+
+    char file[13];
+    FIL fil;
+    if (action != LEDS_BENCH) {
+        if (!bp_file_get_name_flag(&leds_def, 'f', file, sizeof(file))) {
+            res->error = true;
+            return;
+        }
+        if (file_open(&fil, file, FA_READ)) {
+            res->error = true;
+            return;
+        }
+        if (!pixels) {
+            if (action == LEDS_PLAY) {
+                printf("Specify the pixels per frame with -n\r\n");
+                file_close(&fil);
+                res->error = true;
+                return;
+            }
+            // one frame: the whole file
+            pixels = MIN(file_size(&fil) / e.format.channels, LEDS_MAX_PIXELS);
+            if (!pixels) {
+                printf("File is shorter than one pixel\r\n");
+                file_close(&fil);
+                res->error = true;
+                return;
+            }
+        }
+    }
+
+    uint8_t* mem = mem_alloc(BIG_BUFFER_SIZE, BP_BIG_BUFFER_HWLED);
+    if (!mem) {
+        if (action != LEDS_BENCH) {
+            file_close(&fil);
+        }
+        res->error = true;
+        return;
+    }
+    if (!hwled_frame_begin(rgbw)) {
+        printf("Error: %s not available for this device\r\n", rgbw ? "RGBW" : "DMA");
+        res->error = true;
+        goto leds_cleanup;
+    }
+
+    if (action == LEDS_BENCH) {
+        leds_bench(&e, mem);
+        goto leds_cleanup;
+    }
+
+    if (!leds_engine_init(&e, mem, pixels)) {
+        printf("Error: frame too large\r\n");
+        res->error = true;
+        goto leds_cleanup;
+    }
+    if (!leds_read_frame(&e, &fil, e.frame[0], false)) {
+        printf("Error: file is shorter than one frame (%d bytes)\r\n", pixels * e.format.channels);
+        res->error = true;
+        goto leds_cleanup;
+    }
+
+    if (action == LEDS_SHOW) {
+        hwled_frame_show(e.frame[0], e.words);
+        hwled_frame_wait();
+        printf("%d pixels sent\r\n", pixels);
+    } else {
+        leds_play(&e, &fil, fps, loop);
+    }
+
+leds_cleanup:
+    hwled_frame_end();
+    mem_free(mem);
+    if (action != LEDS_BENCH) {
+        file_close(&fil);
+    }
+}
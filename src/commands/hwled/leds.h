@@ -0,0 +1,13 @@
+/**
+ * @file leds.h
+ * @brief LED strip frame command for the LED mode.
+ * @details Shows and plays frames from files with DMA, and benchmarks frames/sec.
+ */
+
+/**
+ * @brief LED frame command handler.
+ * @param res  Command result structure
+ */
+void leds_handler(struct command_result* res);
+
+extern const struct bp_command_def leds_def;
@@ -31,6 +31,7 @@ Some functions adapted from C++ for the Bus Pirate project by Ian Lesnet Septemb
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include <stdint.h>
+#include <string.h>
 #include "pirate.h"
 #include "pirate/hwi2c_pio.h"
 #include "ui/ui_term.h"
@@ -48,6 +49,7 @@ Some functions adapted from C++ for the Bus Pirate project by Ian Lesnet Septemb
 //#include "pirate/storage.h" // File system related
 #include "lib/jep106/jep106.h"
 #include "ui/ui_hex.h"
+#include "lib/spd_nvm/spd_nvm.h"
 
 // Forward declaration — defined at bottom of file
 extern const bp_command_def_t ddr4_def;
@@ -55,6 +57,10 @@ extern const bp_command_def_t ddr4_def;
 #define DDR4_SPD_SIGNITURE 0x12
 #define DDR4_SPD_I2C_ADDR_7BIT 0x50
 #define DDR4_SPD_SIZE 512 // Size of DDR4 SPD data in bytes
+#define DDR4_SPD_PAGE_SIZE 256 // bytes per page (SPA0/SPA1)
+#define DDR4_SPD_WRITE_US 5000 // EEPROM write cycle, datasheet max, the timer learns the real one
+#define DDR4_SPD_POLL_US 100 // between ACK polls
+#define DDR4_SPD_POLL_MAX 200 // ACK polls before giving up on a write
 #define DDR4_SPD_SPA0 0b01101100
 #define DDR4_SPD_SPA1 0b01101110
 #define DDR4_SPD_RPS0 0b01100011
@@ -434,17 +440,45 @@ bool ddr4_unlock_blocks(void){
     return false;
 }
 
+// select a page and read all of it in one transaction
+bool ddr4_read_page(uint8_t page, uint8_t* data) {
+    if(ddr4_set_page(page)) return true;
+    return i2c_transaction(DDR4_SPD_I2C_ADDR_7BIT<<1, (uint8_t[]){0x00}, 1u, data, DDR4_SPD_PAGE_SIZE);
+}
+
 bool ddr4_read_pages(uint8_t* data) {
-    //set page 0
-    for(uint8_t i=0; i<2; i++){
-        if(ddr4_set_page(i)) return true;
-        //read 256 bytes from page i
-        if(i2c_write(DDR4_SPD_I2C_ADDR_7BIT<<1, (uint8_t[]){0x00}, 1u)) return true;
-        if(i2c_read((DDR4_SPD_I2C_ADDR_7BIT<<1)|1, &data[i*256], 256)) return true;
+    for(uint8_t i=0; i<DDR4_SPD_SIZE/DDR4_SPD_PAGE_SIZE; i++){
+        if(ddr4_read_page(i, &data[i*DDR4_SPD_PAGE_SIZE])) return true;
     }
     return false;
 }
 
+// write 16 bytes to the current page, wait out the write cycle
+// the first ACK poll comes after the write time learned so far
+static bool ddr4_write_chunk(uint8_t offset, const uint8_t *data, spd_nvm_timer_t *timer){
+    uint8_t page_data[SPD_NVM_WRITE_SIZE+1];
+    page_data[0] = offset; // address to write to
+    memcpy(&page_data[1], data, SPD_NVM_WRITE_SIZE);
+    if(i2c_write(DDR4_SPD_I2C_ADDR_7BIT<<1, page_data, sizeof(page_data))) return true;
+
+    busy_wait_us(timer->wait_us);
+    uint32_t busy = 0;
+    while(true){
+        // the EEPROM does not ACK its address until the write is done
+        if(pio_i2c_start_timeout(0xffff)) return true;
+        hwi2c_status_t i2c_result = pio_i2c_write_timeout((DDR4_SPD_I2C_ADDR_7BIT<<1), 0xffffff);
+        if(pio_i2c_stop_timeout(0xffff)) return true;
+        if(i2c_result == HWI2C_OK) break;
+        if(++busy > DDR4_SPD_POLL_MAX) {
+            printf("Error: SPD write did not complete\r\n");
+            return true;
+        }
+        busy_wait_us(timer->poll_us);
+    }
+    spd_nvm_timer_done(timer, busy);
+    return false;
+}
+
 bool ddr4_show_lock_status(void){
     bool lock_status;
     printf("Block | Status\r\n");
@@ -521,27 +555,13 @@ bool ddr4_verify(FIL *file_handle, uint8_t *buffer) {
 }
 
 uint16_t spd_rw_crc16(char* spd, size_t start, int count) {
-    uint16_t crc = 0;
-    size_t ptr = start;
-
-    while (--count >= 0) {
-        if (ptr >= DDR4_SPD_SIZE) {
-            break; // Bounds check
-        }
-        
-        crc = crc ^ spd[ptr] << 8;
-        ptr++;
-        
-        for (int i = 0; i < 8; i++) {
-            if (crc & 0x8000) {
-                crc = crc << 1 ^ 0x1021;
-            } else {
-                crc = crc << 1;
-            }
-        }
+    if (start >= DDR4_SPD_SIZE || count <= 0) {
+        return 0;
     }
-    
-    return (crc & 0xFFFF);
+    if (start + count > DDR4_SPD_SIZE) {
+        count = DDR4_SPD_SIZE - start; // Bounds check
+    }
+    return spd_nvm_crc16_update(0, (const uint8_t*)&spd[start], count); // table driven, one lookup per byte
 }
 
 bool ddr4_jedec_crc(uint8_t *data){
@@ -570,9 +590,7 @@ bool ddr4_crc_file(FIL *file_handle, char *buffer, bool close_file){
 
 //true for error, false for success
 bool ddr4_write_from_file(FIL *file_handle, uint8_t *buffer) {
-    uint32_t bytes_read;
-    
-    if(ddr4_crc_file(file_handle, buffer, false)) return true;
+    if(ddr4_crc_file(file_handle, buffer, true)) return true; // whole file in buffer, file closed
     
     //read current lock bits
     bool lock_status;
@@ -584,46 +602,54 @@ bool ddr4_write_from_file(FIL *file_handle, uint8_t *buffer) {
         }
     }
 
-    //write 16 byte * 8 pages * 2 blocks to the DDR4 SPD
+    //2 pages of 256 bytes, each read in one transaction, only the 16 byte
+    //chunks that differ from the file are written, then the page is read back
+    spd_nvm_timer_t timer;
+    spd_nvm_timer_init(&timer, DDR4_SPD_WRITE_US, DDR4_SPD_POLL_US);
+    uint8_t page[DDR4_SPD_PAGE_SIZE];
+    bool verror = false;
     printf("Writing page:");
-    for(uint8_t i=0; i<2; i++){
-        if(ddr4_set_page(i)) goto ddr4_write_error; // set the page to write to
-        
-        for(uint8_t j=0; j<16; j++){
-            printf(" %d,", (i*16) + j);
-            //get the bytes into an array so we don't have to use granular function
-            uint8_t page_data[17];
-            page_data[0] = (j*16); // address to write to
-            for(uint8_t k=0; k<16; k++) {
-                page_data[k+1] = buffer[(i*256)+(j*16)+k]; // data to write
-            }
-
-            if(i2c_write(DDR4_SPD_I2C_ADDR_7BIT<<1, page_data, 17u)){
-                printf("\r\nError writing page %d, chunk %d\r\n", i, j);   
-                goto ddr4_write_error; // write the access register and address to write to
+    for(uint8_t i=0; i<DDR4_SPD_SIZE/DDR4_SPD_PAGE_SIZE; i++){
+        uint8_t *image = &buffer[i*DDR4_SPD_PAGE_SIZE];
+        if(ddr4_read_page(i, page)) goto ddr4_write_error; // leaves the page selected for the writes
+        uint32_t mask = spd_nvm_plan_page(&spd_nvm_ddr4, page, image);
+        if(!mask){
+            printf(" %d (same),", i);
+            continue;
+        }
+        printf(" %d,", i);
+        for(uint8_t j=0; j<DDR4_SPD_PAGE_SIZE/SPD_NVM_WRITE_SIZE; j++){
+            if(!(mask & (1u<<j))) continue;
+            if(ddr4_write_chunk(j*SPD_NVM_WRITE_SIZE, &image[j*SPD_NVM_WRITE_SIZE], &timer)){
+                printf("\r\nError writing page %d, chunk %d\r\n", i, j);
+                goto ddr4_write_error;
             }
- 
-            // wait for the write to complete
-            if(ddr4_poll_idle()) return true; // wait until the write operation is complete
+        }
+        if(ddr4_read_page(i, page)) goto ddr4_write_error;
+        uint32_t j = spd_nvm_diff_next(page, image, 0, DDR4_SPD_PAGE_SIZE);
+        if(j < DDR4_SPD_PAGE_SIZE){
+            printf("\r\nError: SPD NVM byte %d does not match file! (0x%02X != 0x%02X)\r\n", j+(i*DDR4_SPD_PAGE_SIZE), page[j], image[j]);
+            verror = true;
         }
     }
 
     printf(" Done!\r\n");
-
-    printf("Verify write\r\n");
-    f_rewind(file_handle); // rewind the file to the beginning
-    if(ddr4_verify(file_handle, buffer)){
-        printf("Verify: Failed!\r\n");
-        return true; // on fail file is closed in ddr5_verify
+    if(timer.writes){
+        printf("%lu of %d chunks written, the rest already matched, write cycle ~%lu us\r\n", (unsigned long)timer.writes, DDR4_SPD_SIZE/SPD_NVM_WRITE_SIZE, (unsigned long)timer.wait_us);
     }else{
-        printf("Verify: OK\r\n"); //on success file is closed in ddr5_verify
+        printf("SPD already matches the file, nothing written\r\n");
     }
 
+    //every written page was read back above
+    if(verror){
+        printf("Verify: Failed!\r\n");
+        return true;
+    }
+    printf("Verify: OK\r\n");
     return false;
 
 ddr4_write_error:
     printf("Error writing to DDR4 SPD\r\n");
-    file_close(file_handle); // close the file if there was an error
     system_config.error = true; // set the error flag
     return true;
 }
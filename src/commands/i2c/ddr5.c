@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include <stdint.h>
+#include <string.h>
 #include "pirate.h"
 #include "pirate/hwi2c_pio.h"
 #include "ui/ui_term.h"
@@ -18,6 +19,7 @@
 //#include "pirate/storage.h" // File system related
 #include "lib/jep106/jep106.h"
 #include "ui/ui_hex.h"
+#include "lib/spd_nvm/spd_nvm.h"
 
 // Forward declaration — defined at bottom of file
 extern const bp_command_def_t ddr5_def;
@@ -181,6 +183,10 @@ typedef struct __attribute__((packed)) {
 #define DDR5_SPD_ACCESS_NVM 0x80 // Access NVM space
 
 #define DDR5_SPD_SIZE 1024 // Size of DDR5 SPD data in bytes
+#define DDR5_SPD_PAGE_SIZE 128 // bytes per legacy mode page (MR11)
+#define DDR5_SPD_WRITE_US 5000 // NVM write cycle, datasheet max, the timer learns the real one
+#define DDR5_SPD_POLL_US 100 // between MR48 busy polls
+#define DDR5_SPD_POLL_MAX 200 // busy polls before giving up on a write
 
 bool ddr5_set_legacy_page(uint8_t page){
     //set the page for the legacy mode
@@ -244,19 +250,7 @@ uint16_t ddr5_crc16(const uint8_t *spd, uint32_t cnt) {
         printf("Error: SPD pointer is NULL.\n");
         return 0xFFFF; // Return an error code
     }
-
-    uint16_t crc = 0;
-    for (uint32_t index = 0; index < cnt; ++index) {
-        crc ^= (uint16_t)(spd[index] << 8); // Process each byte
-        for (uint8_t bit = 0; bit < 8; ++bit) {
-            if (crc & 0x8000) {
-                crc = (crc << 1) ^ 0x1021;
-            } else {
-                crc = crc << 1;
-            }
-        }
-    }
-    return crc & 0xFFFF;
+    return spd_nvm_crc16_update(0, spd, cnt); // table driven, one lookup per byte
 }
 
 bool ddr5_wait_idle(void){
@@ -270,7 +264,38 @@ bool ddr5_wait_idle(void){
             return true;
         }
         timeout --;
-    } while((status & DDR5_SPD_MR48_OP_STATUS) || (timeout==0)); // wait until the write operation is complete
+    } while((status & DDR5_SPD_MR48_OP_STATUS) && timeout); // wait until the write operation is complete
+    if(status & DDR5_SPD_MR48_OP_STATUS) {
+        printf("Error: SPD write did not complete\r\n");
+        return true;
+    }
+    return false;
+}
+
+// write 16 bytes to the current legacy page, wait out the NVM cycle
+// the first MR48 poll comes after the write time learned so far
+static bool ddr5_write_chunk(uint8_t offset, const uint8_t *data, spd_nvm_timer_t *timer){
+    uint8_t page_data[SPD_NVM_WRITE_SIZE+1];
+    page_data[0] = DDR5_SPD_ACCESS_NVM | offset; // address to write to
+    memcpy(&page_data[1], data, SPD_NVM_WRITE_SIZE);
+    if(i2c_write(DDR5_SPD_I2C_WRITE_ADDR, page_data, sizeof(page_data))) return true;
+
+    busy_wait_us(timer->wait_us);
+    uint32_t busy = 0;
+    uint8_t status;
+    while(true){
+        if(i2c_transaction(DDR5_SPD_I2C_WRITE_ADDR, (uint8_t[]){DDR5_SPD_MR48}, 1u, &status, 1)) {
+            printf("Error reading SPD Device Status Register\r\n");
+            return true;
+        }
+        if(!(status & DDR5_SPD_MR48_OP_STATUS)) break;
+        if(++busy > DDR5_SPD_POLL_MAX) {
+            printf("Error: SPD write did not complete\r\n");
+            return true;
+        }
+        busy_wait_us(timer->poll_us);
+    }
+    spd_nvm_timer_done(timer, busy);
     return false;
 }
 
@@ -707,19 +732,19 @@ bool ddr5_verify(FIL *file_handle, uint8_t *buffer) {
     // check if the file size is 1024 bytes        
     if(file_size_check(file_handle, DDR5_SPD_SIZE)) return true; 
 
-    uint8_t verify_buffer[128];
+    // whole NVM in one transaction, then the file a page at a time
+    if(ddr5_read_pages_128bytes(true, 0, DDR5_SPD_SIZE/DDR5_SPD_PAGE_SIZE, buffer)){
+        file_close(file_handle); // close the file
+        return true;
+    }
+    uint8_t file_page[DDR5_SPD_PAGE_SIZE];
     bool verror = false; // flag to indicate if there was a verification error
-    for(uint32_t i=0; i<DDR5_SPD_SIZE/128; i++){
-        if(file_read(file_handle, buffer, 128, NULL)) return true; 
-        if(ddr5_read_pages_128bytes(true, i, 1, verify_buffer)){
-            file_close(file_handle); // close the file
-            return true;
-        }
-        for(uint8_t j=0; j<128; j++){
-            if(verify_buffer[j] != buffer[j]) {
-                printf("Error: SPD NVM byte %d does not match file! (0x%02X != 0x%02X)\r\n", j+(i*128), verify_buffer[j], buffer[j]);
-                verror = true; // set the verification error flag
-            }
+    for(uint32_t i=0; i<DDR5_SPD_SIZE/DDR5_SPD_PAGE_SIZE; i++){
+        if(file_read(file_handle, file_page, DDR5_SPD_PAGE_SIZE, NULL)) return true; 
+        uint8_t *nvm = &buffer[i*DDR5_SPD_PAGE_SIZE];
+        for(uint32_t j=spd_nvm_diff_next(nvm, file_page, 0, DDR5_SPD_PAGE_SIZE); j<DDR5_SPD_PAGE_SIZE; j=spd_nvm_diff_next(nvm, file_page, j+1, DDR5_SPD_PAGE_SIZE)){
+            printf("Error: SPD NVM byte %d does not match file! (0x%02X != 0x%02X)\r\n", j+(i*DDR5_SPD_PAGE_SIZE), nvm[j], file_page[j]);
+            verror = true; // set the verification error flag
         }
     }
 
@@ -730,26 +755,33 @@ bool ddr5_verify(FIL *file_handle, uint8_t *buffer) {
 
 //true for error, false for success
 bool ddr5_write_from_file(FIL *file_handle, uint8_t *buffer) {
-    uint32_t bytes_read;
-    
     // is file size 1024 bytes?
     if(file_size_check(file_handle, DDR5_SPD_SIZE)) return true; // if not, we cannot write to the NVM
 
-    //check file CRC
-    if(file_read(file_handle, buffer, 512, NULL)) return true;
-    if(f_rewind(file_handle)) { // rewind the file to the beginning
-        printf("Error rewinding file\r\n");
-        goto ddr5_write_error; 
+    //read the whole file, the CRC is checked as the pages come in
+    spd_nvm_crc_t crc;
+    spd_nvm_crc_init(&crc, &spd_nvm_ddr5);
+    for(uint32_t i=0; i<DDR5_SPD_SIZE/DDR5_SPD_PAGE_SIZE; i++){
+        if(file_read(file_handle, &buffer[i*DDR5_SPD_PAGE_SIZE], DDR5_SPD_PAGE_SIZE, NULL)) return true; // file closed on error
+        spd_nvm_crc_feed(&crc, &buffer[i*DDR5_SPD_PAGE_SIZE], DDR5_SPD_PAGE_SIZE);
     }
-    if(ddr5_nvm_jedec_crc(buffer)) return true; // check CRC of the first 512 bytes
+    file_close(file_handle); // everything is in buffer now
+    printf("CRC verify\r\nStored CRC (bytes 510:511): 0x%02X 0x%02X\r\n", buffer[510], buffer[511]);
+    printf("Calculated CRC: 0x%02X 0x%02X\r\n", crc.crc&0xff, crc.crc >> 8);
+    if(!spd_nvm_crc_ok(&crc)){
+        printf("Error: CRC does not match!!!\r\n");
+        return true;
+    }
+    printf("CRC okay :)\r\n");
 
     //detect if spd present
     if(ddr5_detect_spd_quick()) goto ddr5_write_error; //check if the device is DDR5 SPD
 
     //check if write enabled (HSA pin grounded)
-    if(i2c_transaction(DDR5_SPD_I2C_WRITE_ADDR, (uint8_t[]){DDR5_SPD_MR48}, 1u, buffer, 1)) goto ddr5_write_error; // read the Device Status Register (MR48)
+    uint8_t status;
+    if(i2c_transaction(DDR5_SPD_I2C_WRITE_ADDR, (uint8_t[]){DDR5_SPD_MR48}, 1u, &status, 1)) goto ddr5_write_error; // read the Device Status Register (MR48)
     // is write enabled? check 0x30 bit 2
-    if(buffer[0] & DDR5_SPD_MR48_OVERRIDE_STATUP) {
+    if(status & DDR5_SPD_MR48_OVERRIDE_STATUP) {
         printf("Write Protect Override is enabled: OK\r\n");
     } else {
         printf("Write Protect Override is not enabled, cannot write to SPD NVM. Is HSA pin grounded?\r\n");
@@ -769,35 +801,43 @@ bool ddr5_write_from_file(FIL *file_handle, uint8_t *buffer) {
     }
     printf("NVM block lock bits cleared: OK\r\n");
 
-    //write 16 byte pages to the DDR5 SPD NVM
-    // poll 0x30 bit 3 for 0
-    //8 pages of 128 bytes
-    //page needs to be updated every 128 bytes in MR11
+    //8 pages of 128 bytes, page is selected in MR11 when it is read
+    //each page is read in one transaction, only the 16 byte chunks that
+    //differ from the file are written, then the page is read back
+    spd_nvm_timer_t timer;
+    spd_nvm_timer_init(&timer, DDR5_SPD_WRITE_US, DDR5_SPD_POLL_US);
+    uint8_t page[DDR5_SPD_PAGE_SIZE];
+    bool verror = false;
     printf("Writing page:");
-    for(uint8_t i=0; i<8; i++){
+    for(uint8_t i=0; i<DDR5_SPD_SIZE/DDR5_SPD_PAGE_SIZE; i++){
+        uint8_t *image = &buffer[i*DDR5_SPD_PAGE_SIZE];
+        if(ddr5_read_pages_128bytes(true, i, 1, page)) goto ddr5_write_error; // sets the page for the writes too
+        uint32_t mask = spd_nvm_plan_page(&spd_nvm_ddr5, page, image);
+        if(!mask){
+            printf(" %d (same),", i);
+            continue;
+        }
         printf(" %d,", i);
-        if(file_read(file_handle, buffer, 128, NULL)) return true; // read 128 bytes from the file
-
-        if(ddr5_set_legacy_page(i)) goto ddr5_write_error; // set the page for the legacy mode  
-
-        for(uint8_t j=0; j<128/16; j++){
-            //get the bytes into an array so we don't have to use granular function
-            uint8_t page_data[17];
-            page_data[0] = DDR5_SPD_ACCESS_NVM | (j*16); // address to write to
-            for(uint8_t k=0; k<16; k++) {
-                page_data[k+1] = buffer[(j*16)+k]; // data to write
-            }
-
-            if(i2c_write(DDR5_SPD_I2C_WRITE_ADDR, page_data, 17u)){
-                printf("\r\nError writing page %d, chunk %d\r\n", i, j);   
-                goto ddr5_write_error; // write the access register and address to write to
+        for(uint8_t j=0; j<DDR5_SPD_PAGE_SIZE/SPD_NVM_WRITE_SIZE; j++){
+            if(!(mask & (1u<<j))) continue;
+            if(ddr5_write_chunk(j*SPD_NVM_WRITE_SIZE, &image[j*SPD_NVM_WRITE_SIZE], &timer)){
+                printf("\r\nError writing page %d, chunk %d\r\n", i, j);
+                goto ddr5_write_error;
             }
- 
-            // wait for the write to complete
-            if(ddr5_wait_idle()) return true; // wait until the write operation is complete
+        }
+        if(ddr5_read_pages_128bytes(true, i, 1, page)) goto ddr5_write_error;
+        uint32_t j = spd_nvm_diff_next(page, image, 0, DDR5_SPD_PAGE_SIZE);
+        if(j < DDR5_SPD_PAGE_SIZE){
+            printf("\r\nError: SPD NVM byte %d does not match file! (0x%02X != 0x%02X)\r\n", j+(i*DDR5_SPD_PAGE_SIZE), page[j], image[j]);
+            verror = true;
         }
     }
     printf(" Done!\r\n");
+    if(timer.writes){
+        printf("%lu of %d chunks written, the rest already matched, write cycle ~%lu us\r\n", (unsigned long)timer.writes, DDR5_SPD_SIZE/SPD_NVM_WRITE_SIZE, (unsigned long)timer.wait_us);
+    }else{
+        printf("SPD NVM already matches the file, nothing written\r\n");
+    }
 
     //restore NVM lock bits
     if(ddr5_lock_bits_write_verify(original_lock_bits[0], original_lock_bits[1])) {
@@ -805,21 +845,16 @@ bool ddr5_write_from_file(FIL *file_handle, uint8_t *buffer) {
     }
     printf("NVM block lock bits restored: 0x%02X 0x%02X\r\n", original_lock_bits[0], original_lock_bits[1]);
 
-    printf("Verify write\r\n");
-    f_rewind(file_handle); // rewind the file to the beginning
-    if(ddr5_verify(file_handle, buffer)){
+    //every written page was read back above
+    if(verror){
         printf("Verify: Failed!\r\n");
-        return true; // on fail file is closed in ddr5_verify
-    }else{
-        printf("Verify: OK\r\n"); //on success file is closed in ddr5_verify
+        return true;
     }
-
-    //file_close(file_handle); // close the file
+    printf("Verify: OK\r\n");
     return false;
 
 ddr5_write_error:
     printf("Error writing to DDR5 SPD NVM\r\n");
-    file_close(file_handle); // close the file
     system_config.error = true; // set the error flag
     return true;
 }
@@ -0,0 +1,218 @@
+/**
+ * @file replay.c
+ * @brief Replay an I2C sniffer recording with its timing.
+ * @details The recording (sniff -f) is loaded into the big buffer and
+ *          compiled a block at a time by lib/bus_replay into hwi2c.pio TX
+ *          words, short gaps included as PIO delays. Each block goes out
+ *          by DMA (pio_i2c_dma_block), the CPU only starts the blocks on
+ *          time, which is where the long gaps go. Every RX word is compared
+ *          with the recording: the bytes the device returned and the ACK
+ *          bits.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pirate.h"
+#include "system_config.h"
+#include "command_struct.h"
+#include "fatfs/ff.h"
+#include "pirate/file.h"
+#include "pirate/mem.h"
+#include "pirate/button.h"
+#include "pirate/hwi2c_pio.h"
+#include "hardware/pio.h"
+#include "mode/hwi2c.h"
+#include "ui/ui_term.h"
+#include "ui/ui_help.h"
+#include "usb_rx.h"
+#include "lib/bp_args/bp_cmd.h"
+#include "lib/bus_replay/bus_replay.h"
+#include "commands/i2c/replay.h"
+
+#define REPLAY_TX_WORDS 4096
+#define REPLAY_RX_WORDS 1024
+#define REPLAY_CPU_GAP_US 200
+#define REPLAY_SHOW_MISMATCHES 10
+
+static const char* const usage[] = { "replay <file> [-s <percent>]",
+                                     "Replay a recording:%s replay boot.brc",
+                                     "Replay at half speed:%s replay boot.brc -s 200",
+                                     "Back to back, no gaps:%s replay boot.brc -s 0",
+                                     "",
+                                     "Record with sniff -f <file>" };
+
+static const bp_val_constraint_t replay_scale_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 0, .max = 1000, .def = 100 },
+};
+
+static const bp_command_opt_t replay_opts[] = {
+    { "scale", 's', BP_ARG_REQUIRED, "percent", T_REPLAY_SCALE, &replay_scale_range },
+    { 0 }
+};
+
+static const bp_command_positional_t replay_positionals[] = {
+    { "file", "file", T_REPLAY_FILE, true },
+    { 0 }
+};
+
+const bp_command_def_t replay_i2c_def = {
+    .name             = "replay",
+    .description      = T_I2C_REPLAY_DESCRIPTION,
+    .actions          = NULL,
+    .action_count     = 0,
+    .opts             = replay_opts,
+    .positionals      = replay_positionals,
+    .positional_count = 1,
+    .usage            = usage,
+    .usage_count      = count_of(usage),
+};
+
+// the recording at the start of the big buffer, the block buffers after it
+static uint32_t replay_load(const char* filename, uint8_t* mem) {
+    FIL file;
+    uint32_t len;
+    if (file_open(&file, filename, FA_READ)) {
+        return 0;
+    }
+    if (file_size(&file) > BRP_REC_MAX) {
+        printf("Error: %s is larger than %u bytes\r\n", filename, BRP_REC_MAX);
+        file_close(&file);
+        return 0;
+    }
+    if (file_read(&file, mem, BRP_REC_MAX, &len)) {
+        return 0;
+    }
+    file_close(&file);
+    return len;
+}
+
+static bool replay_stop_pressed(void) {
+    char k;
+    return button_get(0) || (rx_fifo_try_get(&k) && k == 'x');
+}
+
+void replay_i2c_handler(struct command_result* res) {
+    if (bp_cmd_help_check(&replay_i2c_def, res->help_flag)) {
+        return;
+    }
+    if (!ui_help_sanity_check(true, 1 << M_I2C_SDA | 1 << M_I2C_SCL)) {
+        return;
+    }
+
+    char filename[13];
+    if (!bp_file_get_name_positional(&replay_i2c_def, 1, filename, sizeof(filename))) {
+        res->error = true;
+        return;
+    }
+    uint32_t scale;
+    if (bp_cmd_flag(&replay_i2c_def, 's', &scale) == BP_CMD_INVALID) {
+        res->error = true;
+        return;
+    }
+
+    uint8_t* mem = mem_alloc(BIG_BUFFER_SIZE, BP_BIG_BUFFER_BUS_REPLAY);
+    if (!mem) {
+        printf("Error: big buffer unavailable (in use by another command)\r\n");
+        res->error = true;
+        return;
+    }
+    uint16_t* tx = (uint16_t*)&mem[BRP_REC_MAX];
+    uint16_t* rx = &tx[REPLAY_TX_WORDS];
+    brp_expect_t* expect = (brp_expect_t*)&rx[REPLAY_RX_WORDS];
+
+    uint32_t len = replay_load(filename, mem);
+    brp_reader_t rd;
+    if (!len || !brp_reader_init(&rd, mem, len) || rd.hdr.bus != BRP_BUS_I2C) {
+        if (len) {
+            printf("Error: %s is not an I2C recording\r\n", filename);
+        }
+        mem_free(mem);
+        res->error = true;
+        return;
+    }
+
+    uint32_t speed = hwi2c_get_speed();
+    brp_i2c_cfg_t cfg = {
+        .pio_hz = speed * I2C_SCAN_BIT_CYCLES,
+        .scale_pct = scale,
+        .cpu_gap_us = REPLAY_CPU_GAP_US,
+        .inst = set_scl_sda_program_instructions,
+        .delay_inst = pio_encode_nop() | pio_encode_delay(7),
+    };
+    brp_i2c_t c;
+    brp_i2c_init(&c, mem, len, &cfg);
+    printf("%s%s%s: %lu events, %lu%% time, %lu kHz. Press x or the Bus Pirate button to stop\r\n",
+           ui_term_color_notice(),
+           filename,
+           ui_term_color_reset(),
+           (unsigned long)rd.hdr.events,
+           (unsigned long)scale,
+           (unsigned long)(speed / 1000));
+
+    // an RX word is due every few gaps, a stretching device gets 400 SCL periods on top
+    uint32_t stall_us = (400 * 1000) / (speed / 1000) + 4 * REPLAY_CPU_GAP_US + 1000;
+    bool stopped = false;
+    uint32_t mismatches = 0;
+    bool hung = false;
+    brp_block_t b;
+    uint64_t t0 = time_us_64() + 1000;
+    while (brp_i2c_next(&c, tx, REPLAY_TX_WORDS, expect, REPLAY_RX_WORDS, &b)) {
+        // a recorded pause can be minutes long, keep checking for a stop
+        while (time_us_64() < t0 + b.start_us) {
+            if ((stopped = replay_stop_pressed())) {
+                break;
+            }
+        }
+        if (stopped) {
+            break;
+        }
+        uint32_t received;
+        if (!pio_i2c_dma_block(tx, b.tx_len, rx, b.rx_len, stall_us, NULL, NULL, &received)) {
+            printf("Error: no free DMA channels\r\n");
+            res->error = true;
+            break;
+        }
+        for (uint32_t i = 0; i < received; i++) {
+            if (rx[i] == expect[i].expect) {
+                continue;
+            }
+            if (mismatches++ < REPLAY_SHOW_MISMATCHES) {
+                printf("Event %lu: expected 0x%02X%c, got 0x%02X%c\r\n",
+                       (unsigned long)expect[i].event,
+                       expect[i].expect >> 1,
+                       (expect[i].expect & 1) ? '-' : '+',
+                       rx[i] >> 1,
+                       (rx[i] & 1) ? '-' : '+');
+            }
+        }
+        if (received < b.rx_len) {
+            printf("%sError:%s bus hung at event %lu\r\n",
+                   ui_term_color_error(),
+                   ui_term_color_reset(),
+                   (unsigned long)expect[received].event);
+            hung = true;
+            break;
+        }
+        if (replay_stop_pressed()) {
+            break;
+        }
+    }
+    uint64_t us = time_us_64() - t0;
+
+    if (c.rd.bad) {
+        printf("Error: recording is damaged after event %lu\r\n", (unsigned long)c.rd.index);
+    }
+    printf("%lu blocks, %lu split, %lu late (max %lu us), %lu skipped, %lu mismatches, %lu.%03lu s\r\n",
+           (unsigned long)c.blocks,
+           (unsigned long)c.splits,
+           (unsigned long)c.late,
+           (unsigned long)c.late_max_us,
+           (unsigned long)c.skipped,
+           (unsigned long)mismatches,
+           (unsigned long)(us / 1000000),
+           (unsigned long)((us / 1000) % 1000));
+    mem_free(mem);
+    res->error |= mismatches || hung || c.rd.bad;
+}
@@ -0,0 +1,14 @@
+/**
+ * @file replay.h
+ * @brief I2C recording replay command.
+ * @details Replays a sniffer recording on the bus with its timing and
+ *          compares what comes back.
+ */
+
+/**
+ * @brief Replay an I2C recording.
+ * @param res  Command result structure
+ */
+void replay_i2c_handler(struct command_result* res);
+
+extern const struct bp_command_def replay_i2c_def;
@@ -10,6 +10,7 @@
 #include "bytecode.h"
 #include "mode/hwi2c.h"
 #include "lib/i2c_address_list/dev_i2c_addresses.h"
+#include "lib/i2c_scan/i2c_scan.h"
 #include "ui/ui_help.h"
 #include "lib/bp_args/bp_cmd.h"
 #include "binmode/fala.h"
@@ -37,6 +38,90 @@ const bp_command_def_t scan_i2c_def = {
 
 bool i2c_search_check_addr(uint8_t address);
 
+// RX word arrival times, a word much later than the PIO program allows was clock stretched
+typedef struct {
+    i2c_scan_result_t* result;
+    uint32_t first;
+    uint32_t last_us;
+    uint32_t cycle_ns; // PIO cycle
+    bool check_stretch;
+} i2c_scan_timing_t;
+
+static void i2c_scan_arrived(void* ctx, uint32_t index, uint32_t time_us) {
+    i2c_scan_timing_t* t = ctx;
+    if (t->check_stretch) {
+        uint32_t nominal_us = (i2c_scan_rx_cycles(t->first, index) * t->cycle_ns) / 1000;
+        // two SCL periods and some polling slack
+        uint32_t slack_us = (2 * I2C_SCAN_BIT_CYCLES * t->cycle_ns) / 1000 + 10;
+        if ((time_us - t->last_us) > nominal_us + slack_us) {
+            i2c_scan_set(t->result->stretch, i2c_scan_rx_address(t->first, index) >> 1);
+        }
+    }
+    t->last_us = time_us;
+}
+
+// probe [first, first + count) in one DMA block, false if no DMA channels
+static bool i2c_scan_block(i2c_scan_timing_t* t, uint32_t first, uint32_t count, int16_t prefix10) {
+    uint16_t tx[I2C_SCAN_TX_MAX];
+    uint16_t rx[I2C_SCAN_RX_MAX];
+    uint32_t tx_len, rx_len, received;
+    if (prefix10 < 0) {
+        tx_len = i2c_scan_build(tx, set_scl_sda_program_instructions, first, count);
+        rx_len = i2c_scan_rx_words(first, count);
+    } else {
+        tx_len = i2c_scan_build_10bit(tx, set_scl_sda_program_instructions, (uint8_t)prefix10, first, count);
+        rx_len = count * 2;
+    }
+    // an RX word is due every 11 SCL periods or less, a stretching device gets 400
+    uint32_t stall_us = (400 * 1000) / (hwi2c_get_speed() / 1000) + 1000;
+    t->first = first;
+    t->check_stretch &= (prefix10 < 0);
+    t->last_us = time_us_32();
+    if (!pio_i2c_dma_block(tx, tx_len, rx, rx_len, stall_us, i2c_scan_arrived, t, &received)) {
+        return false;
+    }
+    if (prefix10 < 0) {
+        i2c_scan_decode(t->result, rx, received, first);
+    } else {
+        i2c_scan_decode_10bit(t->result, rx, received, (uint8_t)prefix10, first);
+    }
+    if (received < rx_len) {
+        t->result->hung = true;
+        t->result->probed = (prefix10 < 0) ? i2c_scan_rx_address(first, received) : (0x78 + prefix10) << 1;
+    }
+    return true;
+}
+
+// all probes queued by DMA, CPU only watches the RX words arrive
+static bool i2c_scan_dma(i2c_scan_result_t* r) {
+    i2c_scan_timing_t t = {
+        .result = r,
+        .cycle_ns = 1000000u / (hwi2c_get_speed() / 1000 * I2C_SCAN_BIT_CYCLES),
+    };
+    for (uint32_t first = 0; first < 256 && !r->hung; first += I2C_SCAN_BLOCK) {
+        t.check_stretch = i2c_mode_config.clock_stretch;
+        if (!i2c_scan_block(&t, first, I2C_SCAN_BLOCK, -1)) {
+            return false;
+        }
+    }
+    // 10 bit devices ACK their 11110xx prefix, probe the low byte behind each one that did
+    for (uint8_t prefix = 0; prefix < 4 && !r->hung; prefix++) {
+        if (!i2c_scan_bit(r->ack_w, 0x78 + prefix)) {
+            continue;
+        }
+        for (uint32_t low = 0; low < 256 && !r->hung; low += I2C_SCAN_BLOCK) {
+            if (!i2c_scan_block(&t, low, I2C_SCAN_BLOCK, prefix)) {
+                return false;
+            }
+        }
+    }
+    // only a device that answered can stretch, anything else was polling jitter
+    for (uint32_t i = 0; i < 4; i++) {
+        r->stretch[i] &= (r->ack_w[i] | r->ack_r[i]);
+    }
+    return true;
+}
+
 void i2c_search_addr(struct command_result* res) {
     // check help
     if (bp_cmd_help_check(&scan_i2c_def, res->help_flag)) {
@@ -50,51 +135,66 @@ void i2c_search_addr(struct command_result* res) {
 
     bool verbose = bp_cmd_find_flag(&scan_i2c_def, 'v');
     bool color = false;
-    uint16_t device_count = 0;
-    uint16_t device_pairs = 0;
+    i2c_scan_result_t result;
+    i2c_scan_init(&result);
 
     printf("I2C address search:\r\n");
 
     //we manually control any FALA capture
     fala_start_hook();
 
-    for (uint16_t i = 0; i < 256; i = i + 2) {
-        bool i2c_w = i2c_search_check_addr(i);
-        bool i2c_r = i2c_search_check_addr(i + 1);
-
-        if (i2c_w || i2c_r) {
-            device_count += (i2c_w + i2c_r); // add any new devices
-            if (i2c_w && i2c_r) {
-                device_pairs++;
-            }
-
-            color = !color;
-            if (color || verbose) {
-                ui_term_color_text_background(hw_pin_label_ordered_color[7][0], hw_pin_label_ordered_color[7][1]);
-            }
-
-            printf("0x%02X", i >> 1);
-            if (i2c_w) {
-                printf(" (0x%02X W)", i);
-            }
-            if (i2c_r) {
-                printf(" (0x%02X R)", i + 1);
-            }
-            if (color || verbose) {
-                printf("%s", ui_term_color_reset());
-            }
-            printf("\r\n");
-            if (verbose) {
-                printf("%s\r\n", dev_i2c_addresses[i >> 1]);
+    uint32_t start_us = time_us_32();
+    if (!i2c_scan_dma(&result)) {
+        // no free DMA channels, one address at a time
+        i2c_scan_init(&result);
+        for (uint16_t i = 0; i < 256; i++) {
+            if (i2c_search_check_addr(i)) {
+                i2c_scan_set((i & 1) ? result.ack_r : result.ack_w, i >> 1);
             }
         }
+        result.probed = 256;
     }
+    uint32_t scan_us = time_us_32() - start_us;
 
     //we manually control any FALA capture
     fala_stop_hook();
     fala_notify_hook();
 
+    // print only after the scan so USB does not stretch it
+    char line[80];
+    for (uint8_t i = 0; i < 128; i++) {
+        if (!i2c_scan_format(line, sizeof(line), &result, i)) {
+            continue;
+        }
+        color = !color;
+        if (color || verbose) {
+            ui_term_color_text_background(hw_pin_label_ordered_color[7][0], hw_pin_label_ordered_color[7][1]);
+        }
+        printf("%s", line);
+        if (color || verbose) {
+            printf("%s", ui_term_color_reset());
+        }
+        printf("\r\n");
+        if (verbose) {
+            printf("%s\r\n", dev_i2c_addresses[i]);
+        }
+    }
+    for (uint32_t i = 0; i < 1024; i++) {
+        if (i2c_scan_bit(result.ack10, i)) {
+            printf("0x%03X (10 bit)\r\n", i);
+        }
+    }
+    if (result.hung) {
+        printf("%sSCL held low, scan stopped at 0x%02X%s\r\n", ui_term_color_error(), result.probed >> 1, ui_term_color_reset());
+    }
+
+    uint32_t device_count, device_pairs, device_count10;
+    i2c_scan_count(&result, &device_count, &device_pairs, &device_count10);
     printf("%s\r\nFound %d addresses, %d W/R pairs.\r\n", ui_term_color_reset(), device_count, device_pairs);
+    if (result.scan10) {
+        printf("Found %d 10 bit addresses.\r\n", device_count10);
+    }
+    printf("Scan time %d.%03dms at %dkHz\r\n", scan_us / 1000, scan_us % 1000, hwi2c_get_speed() / 1000);
 }
 
 bool i2c_search_check_addr(uint8_t address) {
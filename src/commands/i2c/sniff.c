@@ -13,10 +13,15 @@
 #include "bytecode.h" 
 #include "mode/hwi2c.h"
 #include "pirate/bio.h"
+#include "pirate/mem.h"
+#include "pirate/file.h"
+#include "fatfs/ff.h"
 #include "ui/ui_help.h"    // Functions to display help in a standardized way
+#include "ui/ui_term.h"
 #include "usb_rx.h"
 #include "usb_tx.h"
 #include "lib/bp_args/bp_cmd.h"    // New command definition system
+#include "lib/bus_replay/bus_replay.h"
 
 static const char pin_labels[][5] = {
     "SDA",
@@ -27,11 +32,12 @@ static const char pin_labels[][5] = {
 
 //help variables
 const char* const i2c_sniff_help[] = {
-    "sniff [-q] [-7] [-r]",
+    "sniff [-q] [-7] [-r] [-f <file>]",
     "Start the I2C sniffer:%s sniff",
     "Supress (quiet) ACK in output:%s sniff -q",
     "Print (raw) data, no '[',']','R''W':%s sniff -r",
     "Show 7-bit address:%s sniff -7",
+    "Record for the replay command, x stops:%s sniff -f boot.brc",
     "",
     "pico-i2c-sniff by @jjsch-dev https://github.com/jjsch-dev/pico_i2c_sniffer",
     "Max speed: 500kHz",
@@ -41,6 +47,7 @@ static const bp_command_opt_t sniff_i2c_opts[] = {
     { "quiet",  'q', BP_ARG_NONE, NULL, T_I2C_SNIFF_QUIET },
     { "raw",    'r', BP_ARG_NONE, NULL, T_I2C_SNIFF_RAW },
     { "addr7",  '7', BP_ARG_NONE, NULL, T_I2C_SNIFF_7_BIT_ADDRESSES },
+    { "file",   'f', BP_ARG_REQUIRED, "file", T_I2C_SNIFF_FILE },
     { 0 }
 };
 
@@ -54,6 +61,54 @@ const bp_command_def_t sniff_i2c_def = {
     .usage_count  = count_of(i2c_sniff_help),
 };
 
+// nothing is printed while recording, the events are timestamped into the big buffer
+static uint32_t i2c_sniff_record(PIO pio, uint sm, uint8_t* mem) {
+    brp_rec_t rec;
+    brp_rec_init(&rec, mem, BRP_REC_MAX, BRP_BUS_I2C, 0, time_us_32());
+    printf("Recording, press x to stop\r\n");
+    while (!rec.full) {
+        if (pio_sm_get_rx_fifo_level(pio, sm) > 0) {
+            uint32_t val = pio_sm_get(pio, sm);
+            brp_event_t e = { .t_us = time_us_32() };
+            switch ((val >> 11) & 0x03) {
+                case EV_START:
+                    e.type = BRP_EV_START;
+                    break;
+                case EV_STOP:
+                    e.type = BRP_EV_STOP;
+                    break;
+                case EV_DATA:
+                    e.type = BRP_EV_DATA;
+                    e.data = (val >> 1) & 0xff;
+                    e.nack = val & 1;
+                    break;
+                default:
+                    continue;
+            }
+            brp_rec_event(&rec, &e);
+        }
+        char c;
+        if (rx_fifo_try_get(&c) && c == 'x') {
+            break;
+        }
+    }
+    if (rec.full) {
+        printf("Recording buffer full\r\n");
+    }
+    printf("%lu events\r\n", (unsigned long)rec.events);
+    return brp_rec_finish(&rec);
+}
+
+static void i2c_sniff_save(const char* filename, uint8_t* mem, uint32_t len, struct command_result* res) {
+    FIL file;
+    if (file_open(&file, filename, FA_CREATE_ALWAYS | FA_WRITE) || file_write(&file, mem, len)) {
+        res->error = true;
+        return;
+    }
+    file_close(&file);
+    printf("%s%lu bytes saved to %s%s\r\n", ui_term_color_notice(), (unsigned long)len, filename, ui_term_color_reset());
+}
+
 void i2c_sniff(struct command_result* res){ 
     //if -h show help
     if (bp_cmd_help_check(&sniff_i2c_def, res->help_flag)) {
@@ -69,6 +124,23 @@ void i2c_sniff(struct command_result* res){
     // instead of raw 8-bit address byte.
     bool addr7 = bp_cmd_find_flag(&sniff_i2c_def, '7');
 
+    // -f records the traffic to a file instead
+    char filename[13];
+    uint8_t* mem = NULL;
+    if (bp_cmd_find_flag(&sniff_i2c_def, 'f')) {
+        if (!bp_file_get_name_flag(&sniff_i2c_def, 'f', filename, sizeof(filename))) {
+            res->error = true;
+            return;
+        }
+        mem = mem_alloc(BIG_BUFFER_SIZE, BP_BIG_BUFFER_BUS_REPLAY);
+        if (!mem) {
+            printf("Error: big buffer unavailable (in use by another command)\r\n");
+            res->error = true;
+            return;
+        }
+    }
+    uint32_t rec_len = 0;
+
     // Full speed for the PIO clock divider
     float div = 1;
     struct _pio_config pio_main, pio_data, pio_start, pio_stop;
@@ -131,7 +203,9 @@ void i2c_sniff(struct command_result* res){
         pio_sm_get(pio_main.pio, pio_main.sm);
     }
 
-    if(quiet){  // we duplicate the loop to avoid the quiet test inside the time sensitive parts
+    if (mem) {
+        rec_len = i2c_sniff_record(pio_main.pio, pio_main.sm, mem);
+    } else if(quiet){  // we duplicate the loop to avoid the quiet test inside the time sensitive parts
                 // this is cheating, we really should have a buffer and a separate thread to handle the output
         printf("Quiet mode enabled, ACKs will not be displayed\r\n");
         bool expect_addr = false; //Next DATA after START is address byte
@@ -284,6 +358,11 @@ void i2c_sniff(struct command_result* res){
     //on exit, restore the I2C PIO
     hwi2c_setup_exc();
 
+    if (mem) {
+        i2c_sniff_save(filename, mem, rec_len, res);
+        mem_free(mem);
+    }
+
     #if 0
     multicore_launch_core1(core1_print);
 
@@ -11,31 +11,61 @@
 #include "pirate/hwi2c_pio.h"
 #include "lib/ap33772s/ap33772s.h"
 #include "lib/ap33772s/ap33772s_int.h"
+#include "lib/pd_monitor/pd_monitor.h"
+#include "usb_rx.h"
+
+// monitor: events kept between prints, VBUS/current moves worth an event
+#define USBPD_EVENTS 64
+#define USBPD_VBUS_STEP_MV 250
+#define USBPD_IBUS_STEP_MA 100
+#define USBPD_TIMEOUT_MS 2000
+// sweep: VBUS settle time after an accept, voltage reads averaged
+#define USBPD_SETTLE_MS 300
+#define USBPD_SAMPLES 4
 
 enum usbpd_actions_enum {
     USBPD_STATUS=0,
     USBPD_REQUEST,
     USBPD_RESET,
+    USBPD_MONITOR,
+    USBPD_SWEEP,
 };
 
 static const char* const usage[] = {
-    "usbpd [status|request|reset]\r\n\t[-p <PDO index>] [-v <mV>] [-i <mA>] [-h(elp)]",
+    "usbpd [status|request|reset|monitor|sweep]\r\n\t[-p <PDO index>] [-v <mV>] [-i <mA>] [-t <ms>] [-s <mV>] [-y] [-h(elp)]",
     "show USB PD status:%s usbpd status",
     "request a fixed voltage PDO profile:%s usbpd request -p 1",
     "request a PPS/AVS voltage profile:%s usbpd request -p 2 -v 9000 -i 1500",
-    "send USB PD hard reset:%s usbpd reset"
+    "send USB PD hard reset:%s usbpd reset",
+    "log PD events until a key is pressed:%s usbpd monitor -t 10",
+    "step through every PDO and measure VBUS:%s usbpd sweep -s 2000"
 };
 
 static const bp_command_action_t usbpd_action_defs[] = {
     { USBPD_STATUS,  "status",  T_HELP_I2C_USBPD_STATUS },
     { USBPD_REQUEST, "request", T_HELP_I2C_USBPD_REQUEST },
     { USBPD_RESET,   "reset",   T_HELP_I2C_USBPD_RESET },
+    { USBPD_MONITOR, "monitor", T_HELP_I2C_USBPD_MONITOR },
+    { USBPD_SWEEP,   "sweep",   T_HELP_I2C_USBPD_SWEEP },
+};
+
+static const bp_val_constraint_t interval_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 1, .max = 10000, .def = 20 },
+};
+
+static const bp_val_constraint_t step_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 100, .max = 20000, .def = 1000 },
 };
 
 static const bp_command_opt_t usbpd_opts[] = {
-    { "pdo",     'p', BP_ARG_REQUIRED, "index", T_HELP_I2C_USBPD_PDO_INDEX },
-    { "voltage", 'v', BP_ARG_REQUIRED, "mV",    T_HELP_I2C_USBPD_VOLTAGE },
-    { "current", 'i', BP_ARG_REQUIRED, "mA",    T_HELP_I2C_USBPD_CURRENT },
+    { "pdo",      'p', BP_ARG_REQUIRED, "index", T_HELP_I2C_USBPD_PDO_INDEX },
+    { "voltage",  'v', BP_ARG_REQUIRED, "mV",    T_HELP_I2C_USBPD_VOLTAGE },
+    { "current",  'i', BP_ARG_REQUIRED, "mA",    T_HELP_I2C_USBPD_CURRENT },
+    { "interval", 't', BP_ARG_REQUIRED, "ms",    T_HELP_I2C_USBPD_INTERVAL, &interval_range },
+    { "step",     's', BP_ARG_REQUIRED, "mV",    T_HELP_I2C_USBPD_STEP, &step_range },
+    { "yes",      'y', BP_ARG_NONE,     NULL,    T_HELP_FLASH_YES_OVERRIDE },
     { 0 }
 };
 
@@ -353,6 +383,198 @@ void usbpd_profiles_print(ap33772s_ref dev){
 
 
 
+/* ── Event monitor ──────────────────────────────────────────────── */
+
+static pd_event_t usbpd_events[USBPD_EVENTS];
+static uint32_t usbpd_start_ms;
+
+static uint32_t usbpd_ms(void) {
+    return to_ms_since_boot(get_absolute_time()) - usbpd_start_ms;
+}
+
+static int usbpd_read_u16(ap33772s_ref dev, uint8_t reg, uint16_t* value) {
+    uint8_t buf[2];
+    int ret = ap33772s_read_bytes(dev, reg, buf, sizeof(buf));
+    *value = buf[0] | (buf[1] << 8);
+    return ret;
+}
+
+// STATUS and OPMODE, then only what they call for; SRCPDO is one 26 byte read
+static int usbpd_poll(ap33772s_ref dev, pd_monitor_t* m) {
+    pd_monitor_regs_t r;
+    memset(&r, 0, sizeof(r));
+    if (ap33772s_read_status(dev, &r.status) < 0 || ap33772s_read_opmode(dev, &r.opmode) < 0) {
+        return -1;
+    }
+    r.read = pd_monitor_plan(m, r.status);
+    if (r.read & PD_READ_TELEMETRY) {
+        if (usbpd_read_u16(dev, AP33772S_CMD_VOLTAGE, &r.voltage) < 0 ||
+            ap33772s_read_bytes(dev, AP33772S_CMD_CURRENT, &r.current, 1) < 0 ||
+            ap33772s_read_bytes(dev, AP33772S_CMD_TEMP, &r.temp, 1) < 0) {
+            return -1;
+        }
+    }
+    if (r.read & PD_READ_CONTRACT) {
+        if (usbpd_read_u16(dev, AP33772S_CMD_VREQ, &r.vreq) < 0 || usbpd_read_u16(dev, AP33772S_CMD_IREQ, &r.ireq) < 0) {
+            return -1;
+        }
+    }
+    if ((r.read & PD_READ_PDO) && ap33772s_read_bytes(dev, AP33772S_CMD_SRCPDO, r.pdo, sizeof(r.pdo)) < 0) {
+        return -1;
+    }
+    if ((r.read & PD_READ_RESULT) && ap33772s_read_pd_msg_result(dev, &r.result) < 0) {
+        return -1;
+    }
+    pd_monitor_update(m, &r, usbpd_ms());
+    if (r.read & PD_READ_PDO) {
+        // requests check against the list the source sent last
+        memcpy(dev->src_pdo, m->pdo_raw, sizeof(dev->src_pdo));
+        dev->num_pdo = m->pdos;
+    }
+    return 0;
+}
+
+static void usbpd_events_print(pd_monitor_t* m) {
+    pd_event_t ev;
+    char line[48];
+    while (pd_monitor_pop(m, &ev)) {
+        pd_monitor_event_str(&ev, line, sizeof(line));
+        printf("%s%5d.%03d%s %s\r\n",
+               ui_term_color_num_float(),
+               ev.time_ms / 1000,
+               ev.time_ms % 1000,
+               ui_term_color_reset(),
+               line);
+    }
+}
+
+static void usbpd_lost_print(const pd_monitor_t* m) {
+    if (m->lost) {
+        printf("%lu events lost, poll less often or lower the steps\r\n", (unsigned long)m->lost);
+    }
+}
+
+static void usbpd_monitor(ap33772s_ref dev, pd_monitor_t* m, uint32_t interval_ms) {
+    printf("Polling every %d ms, any key to stop\r\n", interval_ms);
+    char c;
+    while (!rx_fifo_try_get(&c)) {
+        if (usbpd_poll(dev, m) < 0) {
+            printf("I2C error\r\n");
+            break;
+        }
+        usbpd_events_print(m);
+        busy_wait_ms(interval_ms);
+    }
+    usbpd_lost_print(m);
+}
+
+/* ── PDO sweep ──────────────────────────────────────────────────── */
+
+static int usbpd_step_request(ap33772s_ref dev, const pd_sweep_step_t* step) {
+    switch (step->type) {
+        case PD_PDO_FIXED:
+            return ap33772s_request_fixed_pdo(dev, step->index, step->ma);
+        case PD_PDO_PPS:
+            return ap33772s_request_pps(dev, step->index, step->mv, step->ma);
+        case PD_PDO_AVS:
+            return ap33772s_request_avs(dev, step->index, step->mv, step->ma);
+        default:
+            return -1;
+    }
+}
+
+// request, wait for the answer, the events stay in the ring
+static int usbpd_step_run(ap33772s_ref dev, pd_monitor_t* m, const pd_sweep_step_t* step, uint32_t interval_ms) {
+    if (usbpd_step_request(dev, step) < 0) {
+        return -1;
+    }
+    pd_monitor_request(m, step->index, step->mv, step->ma, usbpd_ms());
+    while (m->pending) {
+        busy_wait_ms(interval_ms);
+        if (usbpd_poll(dev, m) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void usbpd_sweep(ap33772s_ref dev, pd_monitor_t* m, uint32_t step_mv, uint32_t interval_ms) {
+    static const char* const type_names[] = { "", "fixed", "PPS", "AVS" };
+    if (usbpd_poll(dev, m) < 0) {
+        printf("I2C error\r\n");
+        return;
+    }
+    pd_sweep_t sweep;
+    pd_sweep_step_t step;
+    pd_sweep_init(&sweep, m->pdo_raw, m->pdos, step_mv);
+    uint16_t top = 0;
+    while (pd_sweep_next(&sweep, &step)) {
+        top = MAX(top, step.mv);
+    }
+    if (!top) {
+        printf("No source PDOs\r\n");
+        return;
+    }
+    char msg[64];
+    snprintf(msg, sizeof(msg), "VBUS will step up to %d mV. Continue?", top);
+    if (!bp_cmd_confirm(&usbpd_def, msg)) {
+        return;
+    }
+
+    printf("PDO  type   request mV    mA  result    VBUS mV  IBUS mA\r\n");
+    pd_sweep_init(&sweep, m->pdo_raw, m->pdos, step_mv);
+    char c;
+    while (pd_sweep_next(&sweep, &step) && !rx_fifo_try_get(&c)) {
+        printf("%3d  %-5s  %10d %5d  ", step.index, type_names[step.type], step.mv, step.ma);
+        if (usbpd_step_run(dev, m, &step, interval_ms) < 0) {
+            printf("not sent\r\n");
+            continue;
+        }
+        if (m->last_result != PD_RESULT_ACCEPTED) {
+            printf("%s\r\n", m->last_result == PD_RESULT_REJECTED ? "rejected" : "failed");
+            continue;
+        }
+        // let VBUS settle, keep the log going
+        uint32_t settle = usbpd_ms();
+        while (usbpd_ms() - settle < USBPD_SETTLE_MS) {
+            busy_wait_ms(interval_ms);
+            usbpd_poll(dev, m);
+        }
+        int vbus = 0, ibus = 0, v;
+        int err = 0;
+        for (uint32_t i = 0; i < USBPD_SAMPLES; i++) {
+            if ((err = ap33772s_read_voltage(dev, &v)) < 0) {
+                break;
+            }
+            vbus += v;
+        }
+        if (err == 0) {
+            err = ap33772s_read_current(dev, &ibus);
+        }
+        if (err < 0) {
+            printf("accepted  %sread error%s\r\n", ui_term_color_error(), ui_term_color_reset());
+            continue;
+        }
+        vbus /= USBPD_SAMPLES;
+        bool ok = pd_sweep_check(&step, vbus);
+        printf("accepted  %s%7d%s  %7d\r\n",
+               ok ? ui_term_color_num_float() : ui_term_color_error(),
+               vbus,
+               ui_term_color_reset(),
+               ibus);
+    }
+
+    // back to 5V
+    pd_sweep_init(&sweep, m->pdo_raw, m->pdos, step_mv);
+    if (pd_sweep_next(&sweep, &step) && step.type == PD_PDO_FIXED) {
+        usbpd_step_run(dev, m, &step, interval_ms);
+        printf("Back to PDO 1, %d mV\r\n", step.mv);
+    }
+    printf("\r\nEvent log:\r\n");
+    usbpd_events_print(m);
+    usbpd_lost_print(m);
+}
+
 void usbpd_handler(struct command_result* res) {
     if(bp_cmd_help_check(&usbpd_def, res->help_flag)) {
         return;
@@ -471,6 +693,24 @@ void usbpd_handler(struct command_result* res) {
         return;
     }
 
+    if (action == USBPD_MONITOR || action == USBPD_SWEEP) {
+        uint32_t interval_ms, step_mv;
+        if (bp_cmd_flag(&usbpd_def, 't', &interval_ms) == BP_CMD_INVALID ||
+            bp_cmd_flag(&usbpd_def, 's', &step_mv) == BP_CMD_INVALID) {
+            res->error = true;
+            return;
+        }
+        pd_monitor_t m;
+        pd_monitor_init(&m, usbpd_events, USBPD_EVENTS, USBPD_VBUS_STEP_MV, USBPD_IBUS_STEP_MA, USBPD_TIMEOUT_MS);
+        usbpd_start_ms = to_ms_since_boot(get_absolute_time());
+        if (action == USBPD_MONITOR) {
+            usbpd_monitor(dev, &m, interval_ms);
+        } else {
+            usbpd_sweep(dev, &m, step_mv, interval_ms);
+        }
+        return;
+    }
+
     //hard reset, check response
     if(action == USBPD_RESET){
         printf("Sending PD hard reset...\r\n");
@@ -1,4 +1,4 @@
-// WAV file header reader and audio player for I2S mode
+// WAV file player and recorder for I2S mode
 #include <stdio.h>
 #include <string.h>
 #include "pico/stdlib.h"
@@ -6,18 +6,25 @@
 #include "command_struct.h"
 #include "fatfs/ff.h"
 #include "pirate/storage.h"
+#include "pirate/mem.h"
 #include "lib/bp_args/bp_cmd.h"
+#include "lib/wav_stream/wav_stream.h"
 #include "ui/ui_help.h"
 #include "system_config.h"
 #include "hardware/pio.h"
+#include "hardware/dma.h"
 #include "pio_config.h"
 #include "mode/i2s.h"
+#include "usb_rx.h"
 
-static const char* const usage[] = { "wav -f <file>",
-                                     "Read WAV file header and play audio:%s wav -f test.wav" };
+static const char* const usage[] = { "wav -f <file> | -r <file> [-s seconds]",
+                                     "Play a WAV file, any key to stop:%s wav -f test.wav",
+                                     "Record 10 seconds from the I2S input:%s wav -r rec.wav -s 10" };
 
 static const bp_command_opt_t wav_opts[] = {
     { "file", 'f', BP_ARG_REQUIRED, NULL, T_HELP_DUMMY_COMMANDS },
+    { "record", 'r', BP_ARG_REQUIRED, NULL, T_HELP_DUMMY_COMMANDS },
+    { "seconds", 's', BP_ARG_REQUIRED, NULL, T_HELP_DUMMY_COMMANDS },
     { 0 }
 };
 
@@ -31,95 +38,321 @@ const bp_command_def_t wav_def = {
     .usage_count  = count_of(usage),
 };
 
-// WAV file header structure
+// big buffer layout: file reads (or recorded PCM), then two DMA word buffers
+// the I2S FIFO covers the few cycles between one DMA transfer ending and the next starting,
+// core0 refills the idle buffer from FatFs while the other one plays
+#define WAV_READ_SIZE (8 * 1024) // f_read size, whole sectors go straight into the buffer
+#define WAV_PCM_MEM (24 * 1024)  // one recorder buffer of 24-bit PCM
+#define WAV_DMA_WORDS 12288      // i2s_out words per playback buffer
+#define WAV_REC_WORDS 8192       // i2s_in words per recorder buffer
+#define WAV_RECORD_SECONDS 5
+
+static_assert(WAV_PCM_MEM + 2 * WAV_DMA_WORDS * sizeof(uint32_t) <= BIG_BUFFER_SIZE, "WAV buffers too big");
+static_assert(WAV_REC_WORDS * 3 <= WAV_PCM_MEM, "WAV recorder PCM buffer too small");
+
 typedef struct {
-    char chunk_id[4];        // "RIFF"
-    uint32_t chunk_size;     // Size of the entire file minus 8 bytes
-    char format[4];          // "WAVE"
-    char subchunk1_id[4];    // "fmt "
-    uint32_t subchunk1_size; // Size of the fmt chunk (16 for PCM)
-    uint16_t audio_format;   // Audio format (1 for PCM)
-    uint16_t num_channels;   // Number of channels (1 = mono, 2 = stereo)
-    uint32_t sample_rate;    // Sampling rate (e.g., 44100 Hz)
-    uint32_t byte_rate;      // Byte rate = SampleRate * NumChannels * BitsPerSample / 8
-    uint16_t block_align;    // Block align = NumChannels * BitsPerSample / 8
-    uint16_t bits_per_sample;// Bits per sample (e.g., 16 bits)
-    char subchunk2_id[4];    // "data"
-    uint32_t subchunk2_size; // Size of the data chunk (number of bytes of audio data)
-} wav_header_t;
+    FIL* fp;
+    wav_stream_t stream;
+    uint8_t* raw;
+    uint32_t pos;     // file position
+    uint32_t left;    // data bytes still to read
+    uint64_t read_us; // time spent in f_read
+    bool error;
+} wav_player_t;
 
-void wav_handler(struct command_result* res) {
-    char file[13];
+static size_t wav_read_at(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+    FIL* fp = ctx;
+    UINT got;
+    if (f_lseek(fp, offset) != FR_OK || f_read(fp, buf, (UINT)len, &got) != FR_OK) {
+        return 0;
+    }
+    return got;
+}
 
-    if (bp_cmd_help_check(&wav_def, res->help_flag)) {
-        return;
+static int wav_dma_claim(const struct _pio_config* cfg, bool tx) {
+    int ch = dma_claim_unused_channel(false);
+    if (ch < 0) {
+        return ch;
+    }
+    dma_channel_config c = dma_channel_get_default_config(ch);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, tx);
+    channel_config_set_write_increment(&c, !tx);
+    channel_config_set_dreq(&c, pio_get_dreq(cfg->pio, cfg->sm, tx));
+    if (tx) {
+        dma_channel_configure(ch, &c, &cfg->pio->txf[cfg->sm], NULL, 0, false);
+    } else {
+        dma_channel_configure(ch, &c, NULL, &cfg->pio->rxf[cfg->sm], 0, false);
     }
+    return ch;
+}
 
+static void wav_dma_release(int ch) {
+    dma_channel_cleanup(ch);
+    dma_channel_unclaim(ch);
+}
+
+// sticky PIO flags: TX FIFO ran dry (underrun) or RX FIFO was full (overrun)
+static bool wav_pio_stalled(const struct _pio_config* cfg, uint32_t lsb) {
+    uint32_t mask = 1u << (lsb + cfg->sm);
+    bool stalled = (cfg->pio->fdebug & mask) != 0;
+    cfg->pio->fdebug = mask;
+    return stalled;
+}
+
+static bool wav_key_pressed(void) {
+    char c;
+    return rx_fifo_try_get(&c);
+}
+
+// convert reads into a word buffer until the next read might not fit
+static uint32_t wav_player_fill(wav_player_t* p, uint32_t* words) {
+    uint32_t n = 0;
+    uint16_t align = p->stream.info->block_align;
+    while (p->left && n + WAV_READ_SIZE / align + 1 <= WAV_DMA_WORDS) {
+        uint32_t len = wav_read_len(p->pos, WAV_READ_SIZE, p->left);
+        UINT got;
+        uint64_t start = time_us_64();
+        FRESULT fresult = f_read(p->fp, p->raw, len, &got);
+        p->read_us += time_us_64() - start;
+        if (fresult != FR_OK || got != len) {
+            p->error = true;
+            p->left = 0;
+            break;
+        }
+        n += wav_stream_feed(&p->stream, p->raw, len, &words[n]);
+        p->pos += len;
+        p->left -= len;
+    }
+    return n;
+}
+
+static void wav_play(const char* file) {
     FIL file_handle;
-    FRESULT fresult;
-    wav_header_t header;
-    bool f_flag = bp_cmd_get_string(&wav_def, 'f', file, sizeof(file));
+    wav_info_t info;
 
-    if (!f_flag) {
-        printf("Set a file name with -f flag to read a WAV file header.\r\n");
-        printf("Example: wav -f test.wav\r\n");
+    if (f_open(&file_handle, file, FA_READ) != FR_OK) {
+        printf("Error opening file %s for reading\r\n", file);
+        system_config.error = true;
         return;
     }
 
-    fresult = f_open(&file_handle, file, FA_READ);
-    if (fresult != FR_OK) {
-        printf("Error opening file %s for reading\r\n", file);
+    wav_status_t status = wav_parse(&info, wav_read_at, &file_handle, (uint32_t)f_size(&file_handle));
+    if (status != WAV_OK) {
+        printf("%s: %s\r\n", file, wav_status_str(status));
         system_config.error = true;
+        f_close(&file_handle);
         return;
     }
-    printf("File %s opened for reading\r\n", file);
+    printf("%s: %d channel, %d bit, %dHz, %d frames (%d.%01d seconds)\r\n",
+           file,
+           info.channels,
+           info.bits,
+           info.rate,
+           info.frames,
+           info.frames / info.rate,
+           (info.frames % info.rate) * 10 / info.rate);
 
-    UINT bytes_read;
-    fresult = f_read(&file_handle, &header, sizeof(header), &bytes_read);
-    if (fresult == FR_OK) {
-        printf("Read %d bytes from file %s\r\n", bytes_read, file);
-    } else {
+    uint8_t* mem = mem_alloc(BIG_BUFFER_SIZE, BP_BIG_BUFFER_WAV);
+    if (!mem) {
+        printf("Error: big buffer unavailable (in use by another command)\r\n");
+        system_config.error = true;
+        f_close(&file_handle);
+        return;
+    }
+    uint32_t* words[2] = { (uint32_t*)(mem + WAV_PCM_MEM), (uint32_t*)(mem + WAV_PCM_MEM) + WAV_DMA_WORDS };
+
+    int dma = wav_dma_claim(&i2s_pio_config_out, true);
+    if (dma < 0) {
+        printf("Error: no free DMA channel\r\n");
+        system_config.error = true;
+        goto wav_play_cleanup;
+    }
+
+    if (info.rate != i2s_mode_config.freq && !i2s_set_sample_rate(info.rate)) {
+        printf("Error: can't play at %dHz\r\n", info.rate);
+        system_config.error = true;
+        goto wav_play_cleanup;
+    }
+
+    wav_player_t player = { .fp = &file_handle, .raw = mem, .pos = info.data_offset, .left = info.data_size };
+    wav_stream_init(&player.stream, &info);
+    f_lseek(&file_handle, info.data_offset);
+
+    printf("Playing, any key to stop\r\n");
+    uint32_t underruns = 0, frames = 0;
+    uint64_t start = time_us_64();
+    uint32_t ping = 0;
+    uint32_t count = wav_player_fill(&player, words[ping]);
+    bool first = true;
+    while (count) {
+        // wait for the playing buffer, then hand the filled one to DMA
+        dma_channel_wait_for_finish_blocking(dma);
+        if (wav_pio_stalled(&i2s_pio_config_out, PIO_FDEBUG_TXSTALL_LSB) && !first) {
+            underruns++;
+        }
+        dma_channel_transfer_from_buffer_now(dma, words[ping], count);
+        frames += count;
+        first = false;
+
+        if (wav_key_pressed()) {
+            break;
+        }
+        ping ^= 1;
+        count = wav_player_fill(&player, words[ping]);
+    }
+    dma_channel_wait_for_finish_blocking(dma);
+    while (!pio_sm_is_tx_fifo_empty(i2s_pio_config_out.pio, i2s_pio_config_out.sm)) {
+        // let the last frames out
+    }
+    uint64_t elapsed = time_us_64() - start;
+
+    if (player.error) {
         printf("Error reading file %s\r\n", file);
+        system_config.error = true;
+    }
+    printf("Played %d frames in %d ms, %d underruns\r\n", frames, (uint32_t)(elapsed / 1000), underruns);
+    if (player.read_us) {
+        uint32_t read_bytes = player.pos - info.data_offset;
+        printf("File read %d KB/s, %d%% of the time\r\n",
+               (uint32_t)((uint64_t)read_bytes * 1000 / player.read_us),
+               (uint32_t)(player.read_us * 100 / (elapsed ? elapsed : 1)));
+    }
+
+wav_play_cleanup:
+    if (info.rate != i2s_mode_config.freq) {
+        i2s_set_sample_rate(i2s_mode_config.freq);
+    }
+    if (dma >= 0) {
+        wav_dma_release(dma);
+    }
+    mem_free(mem);
+    f_close(&file_handle);
+}
+
+static void wav_record(const char* file, uint32_t seconds) {
+    FIL file_handle;
+    UINT written;
+    uint8_t header[WAV_HEADER_LEN];
+    uint16_t bits = (i2s_mode_config.bits > 16) ? 24 : 16;
+    uint32_t rate = i2s_mode_config.freq;
+
+    // seconds * rate wraps a uint32_t long before -s looks unreasonable,
+    // and the RIFF sizes are 32 bit anyway
+    uint64_t bytes = (uint64_t)seconds * rate * (bits / 8);
+    if (bytes > UINT32_MAX - WAV_HEADER_LEN) {
+        printf("Error: at most %lu seconds at %luHz, %d bit\r\n",
+               (unsigned long)((UINT32_MAX - WAV_HEADER_LEN) / ((uint64_t)rate * (bits / 8))),
+               (unsigned long)rate,
+               bits);
+        system_config.error = true;
         return;
     }
 
-    printf("Chunk ID: %.4s\r\n", header.chunk_id);
-    printf("Chunk Size: %u\r\n", header.chunk_size);
-    printf("Format: %.4s\r\n", header.format);
-    printf("Subchunk1 ID: %.4s\r\n", header.subchunk1_id);
-    printf("Subchunk1 Size: %u\r\n", header.subchunk1_size);
-    printf("Audio Format: %u\r\n", header.audio_format);
-    printf("Number of Channels: %u\r\n", header.num_channels);
-    printf("Sample Rate: %u\r\n", header.sample_rate);
-    printf("Byte Rate: %u\r\n", header.byte_rate);
-    printf("Block Align: %u\r\n", header.block_align);
-    printf("Bits Per Sample: %u\r\n", header.bits_per_sample);
-    printf("Subchunk2 ID: %.4s\r\n", header.subchunk2_id);
-    printf("Subchunk2 Size: %u\r\n", header.subchunk2_size);
-
-    int16_t audio_data[1000];
-    fresult = f_read(&file_handle, audio_data, sizeof(audio_data), &bytes_read);
-    if (fresult == FR_OK) {
-        printf("Read %d bytes of audio data from file %s\r\n", bytes_read, file);
-    } else {
-        printf("Error reading audio data from file %s\r\n", file);
+    uint8_t* mem = mem_alloc(BIG_BUFFER_SIZE, BP_BIG_BUFFER_WAV);
+    if (!mem) {
+        printf("Error: big buffer unavailable (in use by another command)\r\n");
+        system_config.error = true;
         return;
     }
+    uint32_t* words[2] = { (uint32_t*)(mem + WAV_PCM_MEM), (uint32_t*)(mem + WAV_PCM_MEM) + WAV_REC_WORDS };
 
-    uint32_t samples = 1000;
+    int dma = wav_dma_claim(&i2s_pio_config_in, false);
+    if (dma < 0) {
+        printf("Error: no free DMA channel\r\n");
+        system_config.error = true;
+        mem_free(mem);
+        return;
+    }
 
-    for (uint32_t cnt = 0; cnt < 5; cnt++) {
-        printf("Pushing %d samples to PIO\r\n", samples);
-        for (uint32_t i = 0; i < samples; i++) {
-            pio_sm_put_blocking(i2s_pio_config_out.pio, i2s_pio_config_out.sm, (audio_data[i]));
+    if (f_open(&file_handle, file, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK) {
+        printf("Error opening file %s for writing\r\n", file);
+        system_config.error = true;
+        wav_dma_release(dma);
+        mem_free(mem);
+        return;
+    }
+    // the sizes are patched in when the recording ends
+    wav_header_build(header, 1, rate, bits, 0);
+    FRESULT fresult = f_write(&file_handle, header, sizeof(header), &written);
+
+    printf("Recording %lu seconds at %luHz, %d bit, any key to stop\r\n", (unsigned long)seconds, (unsigned long)rate, bits);
+    uint32_t total = seconds * rate, frames = 0, overruns = 0, data_size = 0;
+    uint32_t ping = 0;
+
+    // start from an empty FIFO, the first buffer fills while nothing else is waiting
+    pio_sm_set_enabled(i2s_pio_config_in.pio, i2s_pio_config_in.sm, false);
+    pio_sm_clear_fifos(i2s_pio_config_in.pio, i2s_pio_config_in.sm);
+    wav_pio_stalled(&i2s_pio_config_in, PIO_FDEBUG_RXSTALL_LSB);
+    uint32_t count = (total < WAV_REC_WORDS) ? total : WAV_REC_WORDS;
+    dma_channel_transfer_to_buffer_now(dma, words[ping], count);
+    pio_sm_set_enabled(i2s_pio_config_in.pio, i2s_pio_config_in.sm, true);
+
+    while (count && fresult == FR_OK) {
+        dma_channel_wait_for_finish_blocking(dma);
+        if (wav_pio_stalled(&i2s_pio_config_in, PIO_FDEBUG_RXSTALL_LSB)) {
+            overruns++;
+        }
+        frames += count;
+        uint32_t done = count;
+        count = (total - frames < WAV_REC_WORDS) ? total - frames : WAV_REC_WORDS;
+        if (wav_key_pressed()) {
+            count = 0;
         }
+        // keep capturing into the other buffer while this one goes to the file
+        if (count) {
+            dma_channel_transfer_to_buffer_now(dma, words[ping ^ 1], count);
+        }
+        size_t len = wav_from_i2s_in(words[ping], done, bits, mem);
+        fresult = f_write(&file_handle, mem, len, &written);
+        if (written != len) {
+            fresult = FR_DENIED; // disk full
+        }
+        data_size += written;
+        ping ^= 1;
     }
+    dma_channel_abort(dma);
+    pio_sm_set_enabled(i2s_pio_config_in.pio, i2s_pio_config_in.sm, false);
 
-    fresult = f_close(&file_handle);
-    if (fresult != FR_OK) {
-        printf("Error closing file %s\r\n", file);
+    // the final sizes
+    wav_header_build(header, 1, rate, bits, data_size);
+    if (fresult == FR_OK) {
+        fresult = f_lseek(&file_handle, 0);
+    }
+    if (fresult == FR_OK) {
+        fresult = f_write(&file_handle, header, sizeof(header), &written);
+    }
+    if (f_close(&file_handle) != FR_OK || fresult != FR_OK) {
+        printf("Error writing file %s\r\n", file);
         system_config.error = true;
+    }
+    printf("Recorded %d frames (%d bytes) to %s, %d overruns\r\n", frames, data_size, file, overruns);
+
+    wav_dma_release(dma);
+    mem_free(mem);
+}
+
+void wav_handler(struct command_result* res) {
+    char file[13];
+
+    if (bp_cmd_help_check(&wav_def, res->help_flag)) {
+        return;
+    }
+
+    if (bp_cmd_get_string(&wav_def, 'r', file, sizeof(file))) {
+        uint32_t seconds = WAV_RECORD_SECONDS;
+        bp_cmd_get_uint32(&wav_def, 's', &seconds);
+        if (seconds == 0) {
+            seconds = WAV_RECORD_SECONDS;
+        }
+        wav_record(file, seconds);
+        return;
+    }
+
+    if (!bp_cmd_get_string(&wav_def, 'f', file, sizeof(file))) {
+        printf("Set a file name with -f to play a WAV file, or -r to record one.\r\n");
+        printf("Example: wav -f test.wav\r\n");
         return;
     }
-    printf("File %s closed\r\n", file);
+    wav_play(file);
 }
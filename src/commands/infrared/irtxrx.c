@@ -19,13 +19,20 @@
 #include "ui/ui_term.h"
 #include "ui/ui_help.h"
 #include "pirate/irio_pio.h"
+#include "pirate/mem.h"
+#include "lib/ir_frame/ir_frame.h"
+#include "commands/infrared/irtxrx.h"
 #include "usb_rx.h"
 
+#define IRTX_MAX_PAIRS 128 //pairs in one AIR packet
+#define IRTX_CHUNK_PAIRS 64 //pairs per DMA chunk when playing .irf files
+
 static const char* const usage_tx[] = {
     "irtx [aIR packet] [-f <file>]",
 	"aIR format:%s $<modulation freq (kHz)>:<MARK1>,<SPACE1>,...<MARKn>,<SPACEn>,;",
 	"Transmit:%s irtx $38:900,1800,900,65535,;",
 	"Transmit from file:%s irtx -f example.air",
+	"Transmit all frames of a capture:%s irtx -f example.irf",
 };
 
 static const bp_command_opt_t irtx_opts[] = {
@@ -55,6 +62,7 @@ static const char* const usage_rx[] = {
 	"aIR format:%s $<modulation freq (kHz)>:<MARK1>,<SPACE1>,...<MARKn>,<SPACEn>,;",
 	"Receive (interactive):%s irrx",
 	"Receive, save to file (interactive):%s irrx -f example.air",
+	"Receive, save compact file (interactive):%s irrx -f example.irf",
 	"Receive, specify sensor (interactive):%s irrx -s 56D",
 	"Sensors:%s 38kHz barrier (38B), 36-40kHz/56kHz demodulator (38D*/56D)",
 	"*default",
@@ -77,90 +85,111 @@ const bp_command_def_t irrx_def = {
 };
 
 //returns true (success) false (failed)
-//TODO: check for cnt overflow! this is a potential buffer overflow
-bool irtx_transmit(char* buffer){
+static bool irtx_transmit(const char* buffer, bool verbose){
 	//parse the csv formatted values into 16 bit value pairs
-	uint32_t data[128];
-	uint16_t datacnt=0;
-	uint8_t mod_freq=0;
-	uint16_t cnt=0;
-
-	while(buffer[cnt]!='$'){
-		if(buffer[cnt]==0x00){
-			printf("Unable to find start of data ($) in AIR packet\r\n");
-			return false;
+	uint32_t data[IRTX_MAX_PAIRS];
+	uint32_t datacnt;
+	uint8_t mod_freq;
+
+	ir_air_status_t status = ir_air_parse(buffer, strlen(buffer), &mod_freq, data, count_of(data), &datacnt);
+	if(status != IR_AIR_OK){
+		if(verbose) printf("%s\r\n", ir_air_error_str(status));
+		return false;
+	}
+
+	if(verbose){
+		//debug: show loaded data packet
+		//printf("Read: %s", buffer);
+		printf("\r\n%s$%u:", ui_term_color_info(), mod_freq);
+		for(uint32_t i=0; i<datacnt; i++){
+			printf("%u,%u,", data[i]>>16, data[i]&0xffff);
 		}
-		cnt++;
+		printf(";%s\r\n\r\n", ui_term_color_reset());		
+		printf("Parsed AIR packet: modulation frequency %dkHz, %d MARK/SPACE pairs\r\nTransmitting...", mod_freq, datacnt);
+	}
+	irio_pio_tx_frame_write((float)(mod_freq*1000), datacnt, data);
+	if(verbose) printf("done\r\n");
+	return true;
+}
 
+static size_t irtx_file_read(void* ctx, uint8_t* buf, size_t len){
+	UINT bytes_read;
+	if(f_read((FIL*)ctx, buf, len, &bytes_read) != FR_OK){
+		return 0;
 	}
-	cnt++;
+	return bytes_read;
+}
 
-	//parse the ascii into an 8 bit value
-	while(buffer[cnt]!=':'){
-		if(buffer[cnt]==0x00){
-			printf("Unable to find modulation frequency (:) in AIR packet\r\n");
-			return false;
+//stream every frame of an .irf file, DMA plays one chunk while the next is read
+static bool irtx_play_irf(ir_irf_reader_t* reader, bool verbose){
+	uint32_t pairs[2][IRTX_CHUNK_PAIRS];
+	uint32_t count, got, frame=0;
+	uint8_t khz;
+	ir_irf_status_t status;
+
+	while((status = ir_irf_next(reader, &khz, &count)) == IR_IRF_OK){
+		if(verbose){
+			printf("Frame %d: modulation frequency %dkHz, %d MARK/SPACE pairs\r\nTransmitting...", frame, khz, count);
 		}
-		mod_freq*=10;
-		mod_freq+=buffer[cnt]-0x30;
-		cnt++;
-	} 
-	cnt++;
-
-	//parse the ascii values into 16 bit values, shove in a 32bit word
-	//would be much nicer to use pointers here, but it would be a glob of unreadable slop
-	bool mark=true;
-	while(true){
-		uint16_t value=0;
-		while(buffer[cnt]!=','){
-			if(buffer[cnt]==0x00||buffer[cnt]<'0'||buffer[cnt]>'9'){
-				printf("Unable to find end of MARK/SPACE data (,) in AIR packet\r\n");
-				return false;
-			}
-			value*=10;
-			value+=buffer[cnt]-0x30;
-			cnt++;
+		irio_pio_tx_stream_begin((float)(khz*1000));
+		uint8_t b=0;
+		while((status = ir_irf_read(reader, pairs[b], IRTX_CHUNK_PAIRS, &got)) == IR_IRF_OK && got){
+			irio_pio_tx_stream_write(pairs[b], got);
+			b ^= 1;
 		}
-		if(mark){
-			data[datacnt] = (value<<16);//upper 16 bits are the mark
-			mark = false;
-		}else{
-			data[datacnt] |= value;
-			datacnt++;
-			if(datacnt>=count_of(data)){
-				printf("Too many MARK/SPACE pairs in AIR packet, max 127\r\n");
-				return false;
-			}			
-			mark = true;
+		if(!irio_pio_tx_stream_end() && verbose){
+			printf("PIO TX timeout\r\n");
 		}
-		cnt++; //if 0x00 will be tossed in the next loop
-		if(buffer[cnt]==';'){
-			//found end of AIR packet
-            if(!mark){ //end with a SPACE if not included in AIR packet
-                data[datacnt] |= 0xffff;
-                datacnt++;
-                if(datacnt>=count_of(data)){
-                    printf("Too many MARK/SPACE pairs in AIR packet, max 127\r\n");
-					return false;
-                }                
-            }			
+		if(status != IR_IRF_OK){
 			break;
 		}
+		if(verbose){
+			printf("done\r\n");
+		}
+		frame++;
 	}
 
-	//debug: show loaded data packet
-	//printf("Read: %s", buffer);
-	printf("\r\n%s$%u:", ui_term_color_info(), mod_freq);
-	for(uint16_t i=0; i<datacnt; i++){
-		printf("%u,%u,", data[i]>>16, data[i]&0xffff);
+	if(status != IR_IRF_END){
+		if(verbose) printf("\r\nError: damaged IRF file\r\n");
+		return false;
 	}
-	printf(";%s\r\n\r\n", ui_term_color_reset());		
-	printf("Parsed AIR packet: modulation frequency %dkHz, %d MARK/SPACE pairs\r\nTransmitting...", mod_freq, datacnt);
-	irio_pio_tx_frame_write((float)(mod_freq*1000), datacnt, data);
-	printf("done\r\n");
 	return true;
 }
 
+//transmit every frame in a file, IR TX PIO must be running
+//.irf files are recognized by their header, anything else is read as aIR packets, one per line
+bool irtx_play_file(const char* file, bool verbose){
+	FIL file_handle;
+	ir_irf_reader_t reader;
+	bool ok=true;
+
+	if(f_open(&file_handle, file, FA_READ) != FR_OK){
+		if(verbose) printf("Error opening file %s for reading\r\n", file);
+		return false;
+	}
+
+	if(ir_irf_open(&reader, irtx_file_read, &file_handle) == IR_IRF_OK){
+		ok = irtx_play_irf(&reader, verbose);
+	}else{
+		char buffer[512];
+		f_lseek(&file_handle, 0);
+		while(f_gets(buffer, sizeof(buffer), &file_handle)){
+			if(!irtx_transmit(buffer, verbose)){
+				if(verbose) printf("Error parsing AIR packet\r\n");
+				ok = false;
+				break;
+			}
+		}
+	}
+
+	//close the file
+	if(f_close(&file_handle) != FR_OK){
+		if(verbose) printf("Error closing file %s\r\n", file);
+		ok = false;
+	}
+	return ok;
+}
+
 void irtx_handler(struct command_result *res){
     if (bp_cmd_help_check(&irtx_def, res->help_flag)) {
         return;
@@ -173,43 +202,13 @@ void irtx_handler(struct command_result *res){
 	if(bp_cmd_get_string(&irtx_def, 'f', file, sizeof(file))){
 		//get the filename
 		printf("Transmitting from file %s\r\n", file);
-		//open the file
-		FIL file_handle;
-		FRESULT result;
-		result = f_open(&file_handle, file, FA_READ);
-		if (result != FR_OK) {
-			printf("Error opening file %s for reading\r\n", file);
+		infrared_cleanup_temp(); //tear down current IR PIO programs
+		irio_pio_tx_init(bio2bufiopin[BIO4], 38000); //setup IR PIO programs, actual freq will be set per frame
+		if(!irtx_play_file(file, true)){
 			res->error = true;
-			return;
 		}
-		//read the file
-		//UINT bytes_read;
-		//TCHAR* bufptr;
-		//result = f_read(&file_handle, buffer, sizeof(buffer), &bytes_read);
-		infrared_cleanup_temp(); //tear down current IR PIO programs
-		irio_pio_tx_init(bio2bufiopin[BIO4], 38000); //setup IR PIO programs, actual freq will be set in irtx_packet
-		while(f_gets(buffer, sizeof(buffer), &file_handle)){
-			/*if(bufptr ==0) {
-				printf("Error reading file %s\r\n", file);
-				res->error = true;
-				return;
-			}*/
-			if(!irtx_transmit(buffer)){
-				printf("Error parsing AIR packet\r\n");
-				res->error = true;
-				break;
-			}
-		}	
 		irio_pio_tx_deinit(bio2bufiopin[BIO4]); //tear down IR PIO programs
 		infrared_setup_resume(); //reinit IR PIO programs	
-		//close the file
-		result = f_close(&file_handle);
-		if (result != FR_OK) {
-			printf("Error closing file %s\r\n", file);
-			res->error = true;
-			return;
-		}
-
 		return;
 	
 	}else{
@@ -231,7 +230,7 @@ void irtx_handler(struct command_result *res){
 			//printf("%s", buffer);
 			infrared_cleanup_temp(); //tear down current IR PIO programs
 			irio_pio_tx_init(bio2bufiopin[BIO4], 38000); //setup IR PIO programs, actual freq will be set in irtx_packet
-			if(!irtx_transmit(buffer)){
+			if(!irtx_transmit(buffer, true)){
 				printf("Error parsing AIR packet\r\n");
 				res->error = true;
 			}
@@ -246,6 +245,27 @@ void irtx_handler(struct command_result *res){
 	bp_cmd_help_show(&irtx_def);
 }
 
+//.irf files get the compact format, anything else aIR text
+static bool irrx_is_irf(const char* file){
+	const char* dot = strrchr(file, '.');
+	return dot && strcasecmp(dot, ".irf")==0;
+}
+
+//write one frame to an .irf file, a chunk at a time
+static bool irrx_save_irf(FIL* file_handle, uint8_t khz, const uint32_t* pairs, uint32_t count){
+	uint8_t buf[64];
+	UINT bytes_written;
+	size_t n = ir_irf_frame_header(buf, khz, count);
+	for(uint32_t i=0; i<count; i++){
+		if(n > sizeof(buf) - IR_IRF_PAIR_MAX){
+			if(f_write(file_handle, buf, n, &bytes_written) != FR_OK) return false;
+			n = 0;
+		}
+		n += ir_irf_pair(&buf[n], pairs[i]);
+	}
+	return f_write(file_handle, buf, n, &bytes_written) == FR_OK;
+}
+
 void irrx_handler(struct command_result *res){
 	if (bp_cmd_help_check(&irrx_def, res->help_flag)) {
         return;
@@ -256,10 +276,12 @@ void irrx_handler(struct command_result *res){
 	FIL file_handle;
 	FRESULT result;
 	bool save_file=false;
+	bool save_irf=false;
 	char file[13];
 	if(bp_cmd_get_string(&irrx_def, 'f', file, sizeof(file))){
 		printf("Saving to file %s\r\n", file);
 		save_file=true;
+		save_irf=irrx_is_irf(file);
 		//open file
 		result = f_open(&file_handle, file, FA_WRITE | FA_CREATE_ALWAYS);
 		if (result != FR_OK) {
@@ -267,6 +289,17 @@ void irrx_handler(struct command_result *res){
 			res->error = true;
 			return;
 		}
+		if(save_irf){
+			uint8_t header[IR_IRF_HEADER_LEN];
+			UINT bytes_written;
+			result = f_write(&file_handle, header, ir_irf_header(header), &bytes_written);
+			if (result != FR_OK) {
+				printf("Error writing to file %s\r\n", file);
+				f_close(&file_handle);
+				res->error = true;
+				return;
+			}
+		}
 	}else{
 		printf("No file specified, packets cannot be saved\r\n");
 	}
@@ -308,19 +341,30 @@ void irrx_handler(struct command_result *res){
 	irio_pio_rx_init(bio2bufiopin[ir_rx_pins[rx_sensor].bio]);
 	irio_pio_tx_init(bio2bufiopin[BIO4], 36000);
 
+	//the big buffer holds the DMA rings and frames of any length
+	//without it, fall back to polling the FIFOs into a small buffer
+	uint32_t fallback[128];
+	ir_capture_t capture;
+	uint8_t* mem = mem_alloc(BIG_BUFFER_SIZE, BP_BIG_BUFFER_IR);
+	if(mem){
+		ir_capture_init(&capture, (uint32_t*)(mem + IRIO_RX_CAPTURE_MEM), (BIG_BUFFER_SIZE - IRIO_RX_CAPTURE_MEM) / sizeof(uint32_t));
+	}else{
+		ir_capture_init(&capture, fallback, count_of(fallback));
+	}
+	uint32_t* buffer = capture.pairs;
+
 	while(true){
-		uint32_t buffer[128];
-		uint16_t pairs=0;
+		uint32_t pairs=0;
 		float mod_freq;
 		uint16_t us;
 		char air_buffer[512];
 		//wait for complete IR packet from irio_pio
 		printf("\r\nListening for IR packets (x to exit)...\r\n");
 		//drain the FIFO so we can sync and not get garbage
-		irio_pio_rxtx_drain_fifo();
+		irio_pio_rx_capture_start(mem);
 		//display captured packet
 		while(true){
-			if(irio_pio_rx_frame_buf(&mod_freq, &us, &pairs, buffer)) break;
+			if(irio_pio_rx_capture_poll(&capture, &mod_freq, &us)) break;
 			// any key to exit
 			char c;
 		    if (rx_fifo_try_get(&c)) {
@@ -330,18 +374,24 @@ void irrx_handler(struct command_result *res){
 				}
 			}
 		}
+		irio_pio_rx_capture_stop();
+		pairs = capture.count;
 		uint8_t mod_freq_int = (uint8_t)roundf(mod_freq/1000.0f);
-		uint16_t sn_cnt = snprintf(air_buffer, sizeof(air_buffer), "$%u:", mod_freq_int);
-		for(uint16_t i=0; i<pairs-1; i++){
-			sn_cnt+=snprintf(&air_buffer[sn_cnt], sizeof(air_buffer)-sn_cnt, "%u,%u,", (uint16_t)(buffer[i]>>16), (uint16_t)(buffer[i]&0xffff));
+		if(mod_freq_int==0){
+			printf("\r\nModulation frequency not measured, using 38kHz\r\n");
+			mod_freq_int=38;
+			mod_freq=38000.0f;
 		}
-		sn_cnt += snprintf(&air_buffer[sn_cnt], sizeof(air_buffer)-sn_cnt, "%u,;\r\n", buffer[pairs-1]>>16);
-		if(sn_cnt>sizeof(air_buffer)){
-			printf("AIR packet too long, max 512 characters\r\n");
-			res->error = true;
-			//goto exit_irrx_handler;
+		size_t sn_cnt = ir_air_format(air_buffer, sizeof(air_buffer), mod_freq_int, buffer, pairs);
+		if(sn_cnt>=sizeof(air_buffer)){
+			air_buffer[0]=0x00;
+			printf("\r\nAIR packet too long to show, max 512 characters. Save to a .irf file to keep it\r\n");
+		}else{
+			printf("\r\n%s%s%s\r\n", ui_term_color_info(), air_buffer, ui_term_color_reset());
+		}
+		if(capture.truncated){
+			printf("Frame truncated to %d MARK/SPACE pairs\r\n", capture.max);
 		}
-		printf("\r\n%s%s%s\r\n", ui_term_color_info(), air_buffer, ui_term_color_reset());
 
 		//for debugging
 		/*
@@ -379,9 +429,19 @@ menu_irrx_handler:
 				}
 				//write to file
 				printf("Saving to file %s\r\n", file);
-				//write the data to the file
-				UINT bytes_written; // somewhere to store the number of bytes written
-				result = f_write(&file_handle, air_buffer, strlen(air_buffer), &bytes_written); // write the data to the file
+				if(save_irf){
+					result = irrx_save_irf(&file_handle, mod_freq_int, buffer, pairs) ? FR_OK : FR_DISK_ERR;
+				}else if(air_buffer[0]==0x00){
+					printf("AIR packet too long, save to a .irf file\r\n");
+					goto menu_irrx_handler;
+				}else{
+					//write the data to the file
+					UINT bytes_written; // somewhere to store the number of bytes written
+					result = f_write(&file_handle, air_buffer, strlen(air_buffer), &bytes_written); // write the data to the file
+					if (result == FR_OK) {
+						result = f_write(&file_handle, "\r\n", 2, &bytes_written);
+					}
+				}
 				if (result != FR_OK) {
 					printf("Error writing to file %s\r\n", file);
 					res->error = true; // set the error flag
@@ -400,6 +460,10 @@ menu_irrx_handler:
 				break;				
 			case 'x':
 exit_irrx_handler:
+				irio_pio_rx_capture_stop();
+				if(mem){
+					mem_free(mem);
+				}
 				//resume IR PIO programs
 				irio_pio_rx_deinit(bio2bufiopin[ir_rx_pins[rx_sensor].bio]);
 				irio_pio_tx_deinit(bio2bufiopin[BIO4]);
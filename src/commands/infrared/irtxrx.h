@@ -16,5 +16,15 @@ void irrx_handler(struct command_result *res);
  */
 void irtx_handler(struct command_result *res);
 
+/**
+ * @brief Transmit every frame in a file, the IR TX PIO must be running.
+ * @details .irf files are recognized by their header and streamed in
+ *          DMA chunks, anything else is read as aIR packets, one per line.
+ * @param file     File name
+ * @param verbose  Print progress and errors
+ * @return         true if the whole file was sent
+ */
+bool irtx_play_file(const char* file, bool verbose);
+
 extern const struct bp_command_def irtx_def;
 extern const struct bp_command_def irrx_def;
\ No newline at end of file
@@ -0,0 +1,213 @@
+/**
+ * @file svf.c
+ * @brief Play SVF and XSVF files from the storage on the JTAG pins.
+ * @details The file is streamed through lib/svf in 4KB chunks, the scans
+ *          go out through the PIO/DMA shifter (pirate/jtag_pio), and the
+ *          vectors live in the big buffer. The first TDO mismatch stops
+ *          the player and is reported with its line (SVF) or command
+ *          number (XSVF) and bit. Files ending in .xsv (8.3 names) are XSVF.
+ *
+ *          The PIO shifter is loaded for the command only, so blueTag
+ *          still has the pins to itself the rest of the time.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "pico/stdlib.h"
+#include "pirate.h"
+#include "system_config.h"
+#include "command_struct.h"
+#include "fatfs/ff.h"
+#include "pirate/file.h"
+#include "pirate/bio.h"
+#include "pirate/button.h"
+#include "pirate/mem.h"
+#include "pirate/jtag_pio.h"
+#include "ui/ui_term.h"
+#include "ui/ui_help.h"
+#include "usb_rx.h"
+#include "lib/bp_args/bp_cmd.h"
+#include "lib/svf/svf.h"
+#include "commands/jtag/svf.h"
+
+#define SVF_TRST BIO2
+
+static const char* const usage[] = { "svf <file> [-f <kHz>]",
+                                     "Play an SVF file:%s svf program.svf",
+                                     "Play an XSVF file at 4MHz TCK:%s svf program.xsv -f 4000",
+                                     "",
+                                     "Press x or the Bus Pirate button to stop" };
+
+static const bp_val_constraint_t svf_freq_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 1, .max = 20000, .def = 1000 },
+};
+
+static const bp_command_opt_t svf_opts[] = {
+    { "freq", 'f', BP_ARG_REQUIRED, "kHz", T_JTAG_SVF_FREQ, &svf_freq_range },
+    { 0 }
+};
+
+static const bp_command_positional_t svf_positionals[] = {
+    { "file", "file", T_JTAG_SVF_FILE, true },
+    { 0 }
+};
+
+const bp_command_def_t svf_def = {
+    .name             = "svf",
+    .description      = T_JTAG_SVF_DESCRIPTION,
+    .actions          = NULL,
+    .action_count     = 0,
+    .opts             = svf_opts,
+    .positionals      = svf_positionals,
+    .positional_count = 1,
+    .usage            = usage,
+    .usage_count      = count_of(usage),
+};
+
+static FIL svf_file;
+static bool svf_read_error;
+static uint32_t svf_max_hz; // -f, FREQUENCY can only go slower
+
+static uint32_t svf_read(uint8_t* buf, uint32_t cap) {
+    UINT n = 0;
+    if (f_read(&svf_file, buf, cap, &n) != FR_OK) {
+        svf_read_error = true;
+        return 0;
+    }
+    return n;
+}
+
+static void svf_delay_us(uint32_t us) {
+    busy_wait_us(us);
+}
+
+// TRST is active low on IO2
+static void svf_trst(svf_trst_t mode) {
+    switch (mode) {
+        case SVF_TRST_ON:
+        case SVF_TRST_OFF:
+            bio_put(SVF_TRST, mode == SVF_TRST_OFF);
+            bio_output(SVF_TRST);
+            break;
+        case SVF_TRST_Z:
+            bio_input(SVF_TRST);
+            break;
+        default:
+            break;
+    }
+}
+
+static uint32_t svf_frequency(uint32_t hz) {
+    return jtag_pio_set_freq((hz && hz < svf_max_hz) ? hz : svf_max_hz);
+}
+
+static bool svf_abort(void) {
+    char c;
+    return button_get(0) || (rx_fifo_try_get(&c) && c == 'x');
+}
+
+static const svf_ops_t svf_jtag_ops = {
+    .tms = jtag_pio_tms,
+    .shift = jtag_pio_shift,
+    .clocks = jtag_pio_clocks,
+    .delay_us = svf_delay_us,
+    .trst = svf_trst,
+    .frequency = svf_frequency,
+    .abort = svf_abort,
+    .read = svf_read,
+};
+
+static void svf_report(const svf_t* s, uint64_t us, bool xsvf) {
+    const svf_result_t* r = &s->result;
+    if (r->err) {
+        printf("%sError:%s %s, %s %lu",
+               ui_term_color_error(),
+               ui_term_color_reset(),
+               svf_error_text(r->err),
+               xsvf ? "command" : "line",
+               (unsigned long)r->line);
+        if (r->cmd) {
+            printf(" (%s)", r->cmd);
+        }
+        printf("\r\n");
+        if (r->err == SVF_ERR_MISMATCH) {
+            printf("TDO bit %lu: expected %u, got %u\r\n", (unsigned long)r->bit, r->expected, r->actual);
+        }
+    }
+    uint32_t ms = (uint32_t)(us / 1000);
+    uint32_t kbps = us ? (uint32_t)(r->bits * 1000 / us) : 0;
+    printf("%lu statements, %llu bits, %lu TDO compares, %lu retries, %lu.%03lu s, %lu kbit/s\r\n",
+           (unsigned long)r->statements,
+           (unsigned long long)r->bits,
+           (unsigned long)r->compares,
+           (unsigned long)r->retries,
+           (unsigned long)(ms / 1000),
+           (unsigned long)(ms % 1000),
+           (unsigned long)kbps);
+}
+
+void svf_handler(struct command_result* res) {
+    if (bp_cmd_help_check(&svf_def, res->help_flag)) {
+        return;
+    }
+
+    char filename[13];
+    if (!bp_file_get_name_positional(&svf_def, 1, filename, sizeof(filename))) {
+        res->error = true;
+        return;
+    }
+    uint32_t khz;
+    if (bp_cmd_flag(&svf_def, 'f', &khz) == BP_CMD_INVALID) {
+        res->error = true;
+        return;
+    }
+    const char* ext = strrchr(filename, '.');
+    bool xsvf = ext && !strcasecmp(ext, ".xsv");
+
+    uint8_t* mem = mem_alloc(BIG_BUFFER_SIZE, BP_BIG_BUFFER_SVF);
+    if (!mem) {
+        printf("Error: big buffer unavailable (in use by another command)\r\n");
+        res->error = true;
+        return;
+    }
+    if (file_open(&svf_file, filename, FA_READ)) {
+        mem_free(mem);
+        res->error = true;
+        return;
+    }
+    svf_max_hz = khz * 1000;
+    if (!jtag_pio_init(svf_max_hz)) {
+        printf("Error: no free DMA channels\r\n");
+        file_close(&svf_file);
+        mem_free(mem);
+        res->error = true;
+        return;
+    }
+
+    svf_t s;
+    svf_read_error = false;
+    svf_init(&s, &svf_jtag_ops, mem, BIG_BUFFER_SIZE, jtag_pio_set_freq(svf_max_hz));
+    printf("%s%s%s, TCK %lu kHz, longest scan %lu bits. Press x or the Bus Pirate button to stop\r\n",
+           ui_term_color_notice(),
+           filename,
+           ui_term_color_reset(),
+           (unsigned long)(s.tck_hz / 1000),
+           (unsigned long)(s.sdr.cap * 8));
+
+    uint64_t t0 = time_us_64();
+    svf_err_t err = xsvf ? xsvf_play(&s) : svf_play(&s);
+    uint64_t us = time_us_64() - t0;
+
+    jtag_pio_cleanup();
+    bio_input(SVF_TRST);
+    file_close(&svf_file);
+    if (svf_read_error) {
+        printf("Error reading %s\r\n", filename);
+    }
+    svf_report(&s, us, xsvf);
+    mem_free(mem);
+    res->error = err != SVF_OK || svf_read_error;
+}
@@ -0,0 +1,13 @@
+/**
+ * @file svf.h
+ * @brief SVF/XSVF player command.
+ * @details Plays SVF and XSVF files from the storage on the JTAG pins.
+ */
+
+/**
+ * @brief Play an SVF or XSVF file.
+ * @param res  Command result structure
+ */
+void svf_handler(struct command_result* res);
+
+extern const struct bp_command_def svf_def;
@@ -11,6 +11,8 @@
 #include "mode/hwspi.h"
 #include "lib/sfud/inc/sfud.h"
 #include "lib/sfud/inc/sfud_def.h"
+#include "lib/sfud/inc/sfud_port.h"
+#include "pirate/spi_mio_pio.h"
 #include "spiflash.h"
 #include "pirate/file.h"
 #include "ui/ui_help.h"
@@ -21,15 +23,17 @@
 #include "lib/bp_args/bp_cmd.h"
 
 static const char* const usage[] = {
-    "flash [probe|dump|erase|write|read|verify|test]\r\n\t[-f <file>] [-e(rase)] [-v(verify)] [-h(elp)]",
+    "flash [probe|dump|erase|write|read|verify|test]\r\n\t[-f <file>] [-e(rase)] [-u(pdate)] [-v(verify)] [-h(elp)]",
     "Initialize and probe:%s flash probe",
     "Show flash contents (x to exit):%s flash dump",
     "Show 16 bytes starting at address 0x60:%s flash dump -s 0x60 -b 16",
     "Erase and program, with verify:%s flash write -f example.bin -e -v",
+    "Program only what changed, with verify:%s flash write -f example.bin -u -v",
     "Read to file:%s flash read -f example.bin",
     "Verify with file:%s flash verify -f example.bin",
     "Test chip (full erase/write/verify):%s flash test",
-    "Force dump:%s flash read -o -b <bytes> -f <file>"
+    "Force dump:%s flash read -o -b <bytes> -f <file>",
+    "Quad read, flash DQ0-DQ3 on IO0-IO3:%s flash read -f example.bin -m 4"
 };
 
 enum flash_actions {
@@ -52,16 +56,23 @@ static const bp_command_action_t flash_action_defs[] = {
     { FLASH_TEST,   "test",   T_HELP_FLASH_TEST },
 };
 
+static const bp_val_constraint_t flash_lines_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 1, .max = 4, .def = 4 },
+};
+
 static const bp_command_opt_t flash_opts[] = {
     { "file",     'f', BP_ARG_REQUIRED, "file",    T_HELP_FLASH_FILE_FLAG },
     { "erase",    'e', BP_ARG_NONE,     NULL,        T_HELP_FLASH_ERASE_FLAG },
     { "verify",   'v', BP_ARG_NONE,     NULL,        T_HELP_FLASH_VERIFY_FLAG },
+    { "update",   'u', BP_ARG_NONE,     NULL,        T_HELP_FLASH_UPDATE_FLAG },
     { "start",    's', BP_ARG_REQUIRED, "addr",    UI_HEX_HELP_START },
     { "bytes",    'b', BP_ARG_REQUIRED, "count",   UI_HEX_HELP_BYTES },
     { "quiet",    'q', BP_ARG_NONE,     NULL,        UI_HEX_HELP_QUIET },
     { "nopager",  'c', BP_ARG_NONE,     NULL,        T_HELP_DISK_HEX_PAGER_OFF },
     { "override", 'o', BP_ARG_NONE,     NULL,        T_HELP_FLASH_OVERRIDE },
     { "yes",      'y', BP_ARG_NONE,     NULL,        T_HELP_FLASH_YES_OVERRIDE },
+    { "lines",    'm', BP_ARG_REQUIRED, "1|2|4",   T_HELP_FLASH_LINES_FLAG, &flash_lines_range },
     { 0 }
 };
 
@@ -95,6 +106,8 @@ void flash(struct command_result* res) {
     bool erase_flag = bp_cmd_find_flag(&flash_def, 'e');
     // verify_flag
     bool verify_flag = bp_cmd_find_flag(&flash_def, 'v');
+    // update_flag, differential write
+    bool update_flag = bp_cmd_find_flag(&flash_def, 'u');
     // file to read/write/verify
     char file[13];
     if((flash_action == FLASH_WRITE || flash_action == FLASH_READ || flash_action == FLASH_VERIFY)) {
@@ -109,6 +122,12 @@ void flash(struct command_result* res) {
         return;
     }
 
+    // update erases only what it needs, a chip erase first would defeat it
+    if(update_flag && (flash_action != FLASH_WRITE || erase_flag)) {
+        printf("Update flag (-u) can only be used with write, without -e\r\n");
+        return;
+    }
+
     // prompt yes/no for destructive action: erase, write, test (override with -y)
     if((flash_action == FLASH_ERASE || flash_action == FLASH_WRITE || flash_action == FLASH_TEST)) {
         if(!bp_cmd_confirm(&flash_def, "This action may modify the SPI flash contents. Do you want to continue?")) {
@@ -118,6 +137,28 @@ void flash(struct command_result* res) {
 
     bool override_flag = bp_cmd_find_flag(&flash_def, 'o');
 
+    // multi-I/O wiring: flash DQ0-DQ3 on IO0-IO3, SCK and CS as usual
+    uint32_t lines = 0;
+    bp_cmd_status_t lines_flag = bp_cmd_flag(&flash_def, 'm', &lines);
+    if (lines_flag == BP_CMD_INVALID || (lines_flag == BP_CMD_OK && lines == 3)) {
+        printf("Data lines (-m) can be 1, 2 or 4\r\n");
+        return;
+    }
+    if (lines_flag == BP_CMD_MISSING) {
+        lines = 0;
+    } else {
+        if (override_flag) {
+            printf("Force read (-o) uses the SPI pins, it cannot be used with -m\r\n");
+            return;
+        }
+        for (uint8_t i = 0; i < 4; i++) {
+            if (system_config.pin_func[BIO0 + i + 1] != BP_PIN_IO) {
+                printf("Error: IO%d is in use\r\n", i);
+                return;
+            }
+        }
+    }
+
     // start and end rage? bytes to write/dump???
     sfud_flash flash_info = { .name = "SPI_FLASH", .spi.name = "SPI1" };
     uint8_t data[256];
@@ -128,6 +169,17 @@ void flash(struct command_result* res) {
     //we manually control any FALA capture
     fala_start_hook();    
 
+    if (lines) {
+        uint32_t freq = spi_mio_pio_init(spi_get_baudrate(M_SPI_PORT));
+        if (!freq) {
+            printf("Error: no room for the PIO program\r\n");
+            lines = 0;
+            goto flash_cleanup;
+        }
+        sfud_port_set_lines(lines);
+        printf("\r\nPIO engine, %lu data lines, %lukHz\r\n", (unsigned long)lines, (unsigned long)(freq / 1000));
+    }
+
     printf("\r\nInitializing SPI flash...\r\n");
     if (spiflash_init(&flash_info) && !override_flag) {
         end_address = flash_info.chip.capacity;
@@ -144,8 +196,20 @@ void flash(struct command_result* res) {
         goto flash_cleanup;
     }
 
+    if (lines) {
+        spi_mio_plan_t plan;
+        sfud_port_plan_read(&flash_info, &plan);
+        printf("Read: %s, command 0x%02X, %d dummy clocks\r\n",
+               spi_mio_mode_name(plan.mode),
+               plan.opcode,
+               plan.mode_clocks + plan.dummy_clocks);
+    }
+
     if(flash_action == FLASH_PROBE){
-        spiflash_probe(); // always do by default
+        // the ID and SFDP table dumps talk to the SPI pins
+        if (!lines) {
+            spiflash_probe(); // always do by default
+        }
         goto flash_cleanup; // no need to continue
     }
 
@@ -174,6 +238,11 @@ void flash(struct command_result* res) {
         }
     }
 
+    if (flash_action == FLASH_WRITE && update_flag) {
+        spiflash_update(start_address, end_address, sizeof(data), data, data2, &flash_info, file, verify_flag);
+        goto flash_cleanup;
+    }
+
     if (flash_action == FLASH_WRITE) {
         if (!spiflash_load(start_address, end_address, sizeof(data), data, &flash_info, file)) {
             goto flash_cleanup;
@@ -198,6 +267,10 @@ void flash(struct command_result* res) {
     }
 
 flash_cleanup:
+    if (lines) {
+        sfud_port_set_lines(0);
+        spi_mio_pio_cleanup();
+    }
     //we manually control any FALA capture
     fala_stop_hook();
     fala_notify_hook();
@@ -15,6 +15,7 @@
 #include "pirate/storage.h"
 #include "lib/sfud/inc/sfud.h"
 #include "lib/sfud/inc/sfud_def.h"
+#include "lib/flash_diff/flash_diff.h"
 #include "spiflash.h"
 #include "pirate/mem.h"
 #include "pirate/hwspi.h"
@@ -368,6 +369,189 @@ bool spiflash_load(uint32_t start_address,
     return true;
 }
 
+// erase sizes the planner may use, sfud_erase() picks the matching command for each
+static uint32_t spiflash_erase_sizes(sfud_flash* flash_info) {
+    uint32_t sizes = 0;
+#ifdef SFUD_USING_SFDP
+    if (flash_info->sfdp.available) {
+        for (uint8_t i = 0; i < SFUD_SFDP_ERASE_TYPE_MAX_NUM; i++) {
+            switch (flash_info->sfdp.eraser[i].size) {
+                case 4096:
+                    sizes |= FLASH_DIFF_ERASE_4K;
+                    break;
+                case 32768:
+                    sizes |= FLASH_DIFF_ERASE_32K;
+                    break;
+                case 65536:
+                    sizes |= FLASH_DIFF_ERASE_64K;
+                    break;
+            }
+        }
+        return sizes;
+    }
+#endif
+    switch (flash_info->chip.erase_gran) {
+        case 4096:
+            sizes = FLASH_DIFF_ERASE_4K;
+            break;
+        case 32768:
+            sizes = FLASH_DIFF_ERASE_32K;
+            break;
+        case 65536:
+            sizes = FLASH_DIFF_ERASE_64K;
+            break;
+    }
+    return sizes;
+}
+
+// read a page of the file, padded with 0xff past the end of the image
+static bool spiflash_update_read_page(FIL* fil, uint32_t offset, uint32_t image_size, uint8_t* buf, uint32_t* len) {
+    size_t file_read_count = 0;
+    memset(buf, 0xff, FLASH_DIFF_PAGE_SIZE);
+    *len = 0;
+    if (offset >= image_size) {
+        return true;
+    }
+    uint32_t count = MIN(FLASH_DIFF_PAGE_SIZE, image_size - offset);
+    if (f_lseek(fil, offset) != FR_OK || f_read(fil, buf, count, &file_read_count) != FR_OK) {
+        return false;
+    }
+    *len = file_read_count;
+    return true;
+}
+
+bool spiflash_update(uint32_t start_address,
+                     uint32_t end_address,
+                     uint32_t buf_size,
+                     uint8_t* buf,
+                     uint8_t* buf2,
+                     sfud_flash* flash_info,
+                     const char* file_name,
+                     bool verify) {
+    FIL fil;    /* File object needed for each open file */
+    FRESULT fr; /* FatFs return code */
+    flash_diff_block_t block;
+    flash_diff_plan_t plan;
+    uint32_t skipped = 0, programmed = 0, erased = 0, verified = 0;
+
+    if (buf_size < FLASH_DIFF_PAGE_SIZE) {
+        return false;
+    }
+
+    uint32_t erase_sizes = spiflash_erase_sizes(flash_info);
+    if (!erase_sizes) {
+        printf("Error: erase size %d not supported, use -e instead\r\n", flash_info->chip.erase_gran);
+        return false;
+    }
+
+    printf("Updating from %s...\r\n", file_name);
+
+    fr = f_open(&fil, file_name, FA_READ);
+    if (fr != FR_OK) {
+        storage_file_error(fr);
+        return false;
+    }
+
+    uint32_t image_size = MIN(f_size(&fil), end_address - start_address);
+    // a partly used sector is erased and filled with 0xff, like the normal erase/write
+    uint32_t update_end = start_address + image_size;
+    update_end = MIN((update_end + FLASH_DIFF_SECTOR_SIZE - 1) & ~(FLASH_DIFF_SECTOR_SIZE - 1), end_address);
+    printf("File size: %d, chip size: %d, comparing %d bytes\r\n", f_size(&fil), end_address - start_address, update_end - start_address);
+
+    uint64_t start_us = time_us_64();
+    uint32_t bytes_total = update_end - start_address;
+    ui_term_progress_bar_t progress_bar;
+    ui_term_progress_bar_draw(&progress_bar);
+
+    for (uint32_t base = start_address; base < update_end; base += FLASH_DIFF_BLOCK_SIZE) {
+        uint32_t block_end = MIN(base + FLASH_DIFF_BLOCK_SIZE, update_end);
+        ui_term_progress_bar_update(base - start_address, bytes_total, &progress_bar);
+
+        // compare the block against the file
+        flash_diff_block_init(&block, base);
+        for (uint32_t addr = base; addr < block_end; addr += FLASH_DIFF_PAGE_SIZE) {
+            uint32_t len;
+            if (!spiflash_update_read_page(&fil, addr - start_address, image_size, buf, &len)) {
+                ui_term_progress_bar_cleanup(&progress_bar);
+                printf("\r\nError: file read failed\r\n");
+                goto spiflash_update_error;
+            }
+            if (sfud_read(flash_info, addr, FLASH_DIFF_PAGE_SIZE, buf2) != SFUD_SUCCESS) {
+                ui_term_progress_bar_cleanup(&progress_bar);
+                printf("\r\nError: read failed\r\n");
+                goto spiflash_update_error;
+            }
+            flash_diff_page(&block, (addr - base) / FLASH_DIFF_PAGE_SIZE, buf2, buf, len);
+        }
+
+        if (!flash_diff_plan(&block, erase_sizes, &plan)) {
+            ui_term_progress_bar_cleanup(&progress_bar);
+            printf("\r\nError: erase at 0x%06x would reach past the end of the file, use -e instead\r\n", base);
+            goto spiflash_update_error;
+        }
+
+        for (uint8_t i = 0; i < plan.erase_count; i++) {
+            if (sfud_erase(flash_info, plan.erase[i].address, plan.erase[i].length) != SFUD_SUCCESS) {
+                ui_term_progress_bar_cleanup(&progress_bar);
+                printf("\r\nError: erase failed at 0x%06x\r\n", plan.erase[i].address);
+                goto spiflash_update_error;
+            }
+            erased += plan.erase[i].length;
+        }
+
+        for (uint32_t page = 0; page < block.pages; page++) {
+            if (!flash_diff_page_touched(&plan, page)) {
+                continue;
+            }
+            uint32_t addr = base + page * FLASH_DIFF_PAGE_SIZE;
+            uint32_t len;
+            if (!spiflash_update_read_page(&fil, addr - start_address, image_size, buf, &len)) {
+                ui_term_progress_bar_cleanup(&progress_bar);
+                printf("\r\nError: file read failed\r\n");
+                goto spiflash_update_error;
+            }
+            if (flash_diff_bit(plan.program, page)) {
+                if (sfud_write(flash_info, addr, FLASH_DIFF_PAGE_SIZE, buf) != SFUD_SUCCESS) {
+                    ui_term_progress_bar_cleanup(&progress_bar);
+                    printf("\r\nError: write failed\r\n");
+                    goto spiflash_update_error;
+                }
+                programmed += FLASH_DIFF_PAGE_SIZE;
+            }
+            // only pages that were erased or programmed need to be checked
+            if (verify) {
+                if (sfud_read(flash_info, addr, FLASH_DIFF_PAGE_SIZE, buf2) != SFUD_SUCCESS) {
+                    ui_term_progress_bar_cleanup(&progress_bar);
+                    printf("\r\nError: read failed\r\n");
+                    goto spiflash_update_error;
+                }
+                for (uint32_t i = 0; i < FLASH_DIFF_PAGE_SIZE; i++) {
+                    if (buf[i] != buf2[i]) {
+                        ui_term_progress_bar_cleanup(&progress_bar);
+                        printf("\r\nError: verify failed at %06x [%02x != %02x]\r\n", addr + i, buf[i], buf2[i]);
+                        goto spiflash_update_error;
+                    }
+                }
+                verified += FLASH_DIFF_PAGE_SIZE;
+            }
+        }
+        skipped += plan.skipped_pages * FLASH_DIFF_PAGE_SIZE;
+    }
+    f_close(&fil);
+
+    ui_term_progress_bar_cleanup(&progress_bar);
+    printf("Erased %d, programmed %d, skipped %d unchanged bytes", erased, programmed, skipped);
+    if (verify) {
+        printf(", verified %d", verified);
+    }
+    printf("\r\nUpdate OK, %d ms\r\n", (uint32_t)((time_us_64() - start_us) / 1000));
+    return true;
+
+spiflash_update_error:
+    f_close(&fil);
+    return false;
+}
+
 bool spiflash_verify(uint32_t start_address,
                      uint32_t end_address,
                      uint32_t buf_size,
@@ -94,6 +94,30 @@ bool spiflash_load(uint32_t start_address,
                    sfud_flash* flash_info,
                    const char* file_name);
 
+/**
+ * @brief Differential write: program only what differs from the file.
+ * @details Compares the chip with the file 64K at a time, erases only the
+ *          sectors that need a bit set back to 1 (merged into 32K/64K erases
+ *          where possible) and skips unchanged pages.
+ * @param start_address  Start address
+ * @param end_address    End address
+ * @param buf_size       Buffer size, at least one 256 byte page
+ * @param buf            Buffer 1
+ * @param buf2           Buffer 2
+ * @param flash_info     Flash information structure
+ * @param file_name      Input filename
+ * @param verify         Verify the erased and programmed pages
+ * @return true on success
+ */
+bool spiflash_update(uint32_t start_address,
+                     uint32_t end_address,
+                     uint32_t buf_size,
+                     uint8_t* buf,
+                     uint8_t* buf2,
+                     sfud_flash* flash_info,
+                     const char* file_name,
+                     bool verify);
+
 /**
  * @brief Verify SPI flash against file.
  * @param start_address  Start address
@@ -12,6 +12,7 @@
 #include "bytecode.h"
 #include "mode/hwuart.h"
 #include "pirate/button.h"
+#include "pirate/hwuart_rx.h"
 #include "usb_rx.h"
 #include "usb_tx.h"
 #include "lib/bp_args/bp_cmd.h"
@@ -52,22 +53,26 @@ void uart_bridge_handler(struct command_result* res) {
     }
 
     printf("%s%s%s\r\n", ui_term_color_notice(), GET_T(T_HELP_UART_BRIDGE_EXIT), ui_term_color_reset());
-    bio_put(M_UART_RTS, 0);
     while (true) {
         char c;
         if (rx_fifo_try_get(&c)) {
             uart_putc_raw(M_UART_PORT, c);
         }
-        if (uart_is_readable(M_UART_PORT)) {
-            c = uart_getc(M_UART_PORT);
-            tx_fifo_put(&c);
+        // whatever the receive ring holds goes out in one write
+        char buf[64];
+        uint32_t n = 0;
+        uint8_t b;
+        while (n < sizeof(buf) && hwuart_rx_get(&b, NULL)) {
+            buf[n++] = (char)b;
+        }
+        if (n) {
+            tx_fifo_write(buf, n);
         }
         // exit when button pressed.
         if (button_get(0)) {
             break;
         }
     }
-    bio_put(M_UART_RTS, 1);
 
     if (toolbar_paused) {
         toolbar_resume_updates();
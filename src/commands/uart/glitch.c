@@ -45,6 +45,7 @@
 #include "hardware/uart.h"
 #include "pirate.h"
 #include "pirate/bio.h"
+#include "pirate/hwuart_rx.h"
 #include "pirate/storage.h"
 #include "system_config.h"
 #include "command_struct.h"
@@ -353,6 +354,8 @@ static inline uint32_t get_ticks() {
  *******************************************************/
 bool setup_uart_glitch_hardware() {
     PRINT_INFO("glitch::Entering setup_hardware()\r\n");
+    // the glitch loop reads the UART itself
+    hwuart_rx_pause();
     bio_put(M_UART_RTS, 0);
 
     // set up timer
@@ -394,6 +397,7 @@ void teardown_uart_glitch_hardware() {
     ticker_kill();
 
     pio_remove_program(glitch_pio.pio, glitch_pio.program, glitch_pio.offset);
+    hwuart_rx_resume();
 }
 
 /******************************************************
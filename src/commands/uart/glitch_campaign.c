@@ -0,0 +1,513 @@
+/**
+ * @file glitch_campaign.c
+ * @brief UART glitch campaign: parameter sweeps with reply classification.
+ * @details The glitch command tries one delay window until the first
+ *          reply without the fail character. A campaign sweeps a grid of
+ *          delay x width x trigger edge, tries every point a number of
+ *          times and keeps a histogram of what the target did:
+ *          - lib/glitch_campaign schedules the attempts (grid order or
+ *            shuffled per round) and packs them as uart_glitch PIO words
+ *          - A DMA channel feeds a batch of attempts to the PIO TX FIFO,
+ *            the CPU only sends the trigger character
+ *          - The PIO pushes a word when the pulse fired, no word means the
+ *            trigger edge never came and the PIO is resynced
+ *          - Target replies land in a DMA ring, an attempt ends after a
+ *            quiet gap, when the first byte timeout passes, or at a hard
+ *            limit if the target never stops talking
+ *          - Replies are matched against fail, success and reset texts
+ *          - Counts per point and class can be saved as CSV
+ *
+ *          Times are in glitch PIO units, 10ns.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+#include "hardware/dma.h"
+#include "pirate.h"
+#include "pirate/bio.h"
+#include "pirate/hwuart_rx.h"
+#include "pirate/button.h"
+#include "pirate/file.h"
+#include "pirate/mem.h"
+#include "system_config.h"
+#include "command_struct.h"
+#include "bytecode.h"
+#include "mode/hwuart.h"
+#include "ui/ui_term.h"
+#include "ui/ui_help.h"
+#include "lib/bp_args/bp_cmd.h"
+#include "lib/glitch_campaign/glitch_campaign.h"
+#include "usb_rx.h"
+#include "commands/uart/glitch_campaign.h"
+
+#include "hardware/pio.h"
+#include "pio_config.h"
+#include "glitch.pio.h"
+
+// histogram cells in the big buffer, 12 bytes each
+#define CAMPAIGN_MAX_POINTS 8192
+// attempts per PIO DMA transfer
+#define CAMPAIGN_BATCH 256
+// UART RX DMA ring, the DMA wraps the write address so it must be aligned to its size
+#define CAMPAIGN_RX_BITS 8
+#define CAMPAIGN_RX_SIZE (1u << CAMPAIGN_RX_BITS)
+// reply bytes kept for matching
+#define CAMPAIGN_REPLY_MAX 64
+#define CAMPAIGN_READY_TIMEOUT_US 1000000
+// longest a reply is collected after the first byte wait, for targets that never go quiet
+#define CAMPAIGN_REPLY_TIMEOUT_US 1000000
+#define CAMPAIGN_STATUS_US 500000
+
+static const char* const usage[] = {
+    "campaign -d <delay> -g <width> [-e <edges>] [-t <trg>] [-n <rounds>] [-s(huffle)] [-x(stop)]",
+    "         [-f <fail>] [-k <success>] [-z <reset>] [-w <ms>] [-q <us>] [-r <us>] [-y(noready)] [-o <file>]",
+    "Ranges are start[:stop[:step]] in ns*10",
+    "Sweep delay 1-3us, width 50-200ns:%s campaign -d 100:300 -g 5:20 -f Denied",
+    "5 shuffled rounds, success text:%s campaign -d 100:300:2 -g 5:20 -n 5 -s -f Denied -k Welcome",
+    "Also sweep the trigger edge, save CSV:%s campaign -d 0:500:10 -g 10 -e 0:3 -o glitch.csv",
+    "Classes:%s none, fail, success, reset, other (only with -k), notrig (pulse did not fire)",
+    "Exit:%s press Bus Pirate button or any key",
+};
+
+static const bp_val_constraint_t campaign_trg_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 1, .max = 255, .def = 13 },
+};
+
+static const bp_val_constraint_t campaign_rounds_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 1, .max = 10000, .def = 1 },
+};
+
+static const bp_val_constraint_t campaign_wait_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 1, .max = 10000, .def = 100 },
+};
+
+static const bp_val_constraint_t campaign_quiet_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 50, .max = 100000, .def = 2000 },
+};
+
+static const bp_val_constraint_t campaign_recycle_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 0, .max = 1000000, .def = 1000 },
+};
+
+static const bp_command_opt_t campaign_opts[] = {
+    { "delay",    'd', BP_ARG_REQUIRED, "range", T_HELP_UART_CAMPAIGN_DELAY },
+    { "width",    'g', BP_ARG_REQUIRED, "range", T_HELP_UART_CAMPAIGN_WIDTH },
+    { "edges",    'e', BP_ARG_REQUIRED, "range", T_HELP_UART_CAMPAIGN_EDGES },
+    { "trigger",  't', BP_ARG_REQUIRED, "1-255", T_HELP_UART_CAMPAIGN_TRIGGER, &campaign_trg_range },
+    { "rounds",   'n', BP_ARG_REQUIRED, "count", T_HELP_UART_CAMPAIGN_ROUNDS, &campaign_rounds_range },
+    { "shuffle",  's', BP_ARG_NONE,     NULL,    T_HELP_UART_CAMPAIGN_SHUFFLE },
+    { "stop",     'x', BP_ARG_NONE,     NULL,    T_HELP_UART_CAMPAIGN_STOP },
+    { "fail",     'f', BP_ARG_REQUIRED, "text",  T_HELP_UART_CAMPAIGN_FAIL },
+    { "success",  'k', BP_ARG_REQUIRED, "text",  T_HELP_UART_CAMPAIGN_SUCCESS },
+    { "reset",    'z', BP_ARG_REQUIRED, "text",  T_HELP_UART_CAMPAIGN_RESET },
+    { "wait",     'w', BP_ARG_REQUIRED, "ms",    T_HELP_UART_CAMPAIGN_WAIT, &campaign_wait_range },
+    { "quiet",    'q', BP_ARG_REQUIRED, "us",    T_HELP_UART_CAMPAIGN_QUIET, &campaign_quiet_range },
+    { "recycle",  'r', BP_ARG_REQUIRED, "us",    T_HELP_UART_CAMPAIGN_RECYCLE, &campaign_recycle_range },
+    { "noready",  'y', BP_ARG_NONE,     NULL,    T_HELP_UART_CAMPAIGN_NOREADY },
+    { "output",   'o', BP_ARG_REQUIRED, "file",  T_HELP_UART_CAMPAIGN_OUTPUT },
+    { 0 }
+};
+
+const bp_command_def_t uart_glitch_campaign_def = {
+    .name = "campaign",
+    .description = T_HELP_UART_CAMPAIGN,
+    .actions = NULL,
+    .action_count = 0,
+    .opts = campaign_opts,
+    .usage = usage,
+    .usage_count = count_of(usage),
+};
+
+static const char pin_labels[][5] = { "TRG", "RDY" };
+
+static uint8_t campaign_rx_ring[CAMPAIGN_RX_SIZE] __attribute__((aligned(CAMPAIGN_RX_SIZE)));
+static const uint32_t campaign_reload = 0xffffffff;
+static int campaign_rx_channel = -1;
+static int campaign_rx_control_channel = -1;
+static int campaign_pio_channel = -1;
+static uint32_t campaign_rx_read;
+static struct _pio_config campaign_pio;
+
+// rising edges in the trigger character before the stop bit, as the glitch command counts them
+static uint32_t campaign_trigger_edges(uint8_t trg) {
+    uint32_t edges = 0;
+    bool last_was_high = false;
+    for (uint32_t i = 0; i < 8; i++) {
+        bool high = trg & (1u << i);
+        edges += (high && !last_was_high);
+        last_was_high = high;
+    }
+    return edges;
+}
+
+static bool campaign_axis_flag(char flag, glitch_axis_t* axis, bool required) {
+    char text[32];
+    if (!bp_cmd_get_string(&uart_glitch_campaign_def, flag, text, sizeof(text))) {
+        if (required) {
+            printf("Error: -%c is required\r\n", flag);
+        }
+        return !required;
+    }
+    if (!glitch_axis_parse(text, axis)) {
+        printf("Error: -%c %s, use start[:stop[:step]]\r\n", flag, text);
+        return false;
+    }
+    return true;
+}
+
+static void campaign_text_flag(char flag, char* text, const char* def) {
+    if (!bp_cmd_get_string(&uart_glitch_campaign_def, flag, text, GLITCH_MATCH_MAX)) {
+        strcpy(text, def);
+    }
+}
+
+static void campaign_release_dma(void) {
+    int* channels[] = { &campaign_rx_channel, &campaign_rx_control_channel, &campaign_pio_channel };
+    for (uint32_t i = 0; i < count_of(channels); i++) {
+        if (*channels[i] >= 0) {
+            dma_channel_cleanup(*channels[i]);
+            dma_channel_unclaim(*channels[i]);
+            *channels[i] = -1;
+        }
+    }
+}
+
+static bool campaign_setup_dma(void) {
+    campaign_rx_channel = dma_claim_unused_channel(false);
+    campaign_rx_control_channel = dma_claim_unused_channel(false);
+    campaign_pio_channel = dma_claim_unused_channel(false);
+    if (campaign_rx_channel < 0 || campaign_rx_control_channel < 0 || campaign_pio_channel < 0) {
+        campaign_release_dma();
+        return false;
+    }
+
+    // control channel re-arms the RX channel when its (very long) transfer completes
+    dma_channel_config c = dma_channel_get_default_config(campaign_rx_control_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(campaign_rx_control_channel,
+                          &c,
+                          &dma_hw->ch[campaign_rx_channel].al1_transfer_count_trig,
+                          &campaign_reload,
+                          1,
+                          false);
+
+    c = dma_channel_get_default_config(campaign_rx_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, CAMPAIGN_RX_BITS);
+    channel_config_set_dreq(&c, uart_get_dreq(M_UART_PORT, false));
+    channel_config_set_chain_to(&c, campaign_rx_control_channel);
+    dma_channel_configure(campaign_rx_channel,
+                          &c,
+                          campaign_rx_ring,
+                          &uart_get_hw(M_UART_PORT)->dr,
+                          campaign_reload,
+                          true);
+    campaign_rx_read = 0;
+
+    // attempt words into the PIO, paced by its TX FIFO
+    c = dma_channel_get_default_config(campaign_pio_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(campaign_pio.pio, campaign_pio.sm, true));
+    dma_channel_configure(campaign_pio_channel, &c, &campaign_pio.pio->txf[campaign_pio.sm], NULL, 0, false);
+    return true;
+}
+
+// bytes the RX DMA wrote since the last read
+static uint32_t campaign_rx_level(void) {
+    uint32_t write = dma_channel_hw_addr(campaign_rx_channel)->write_addr - (uint32_t)campaign_rx_ring;
+    return (write - campaign_rx_read) & (CAMPAIGN_RX_SIZE - 1);
+}
+
+static uint32_t campaign_rx_take(uint8_t* reply, uint32_t len, uint32_t max) {
+    uint32_t level = campaign_rx_level();
+    while (level--) {
+        uint8_t c = campaign_rx_ring[campaign_rx_read];
+        campaign_rx_read = (campaign_rx_read + 1) & (CAMPAIGN_RX_SIZE - 1);
+        if (len < max) {
+            reply[len++] = c;
+        }
+    }
+    return len;
+}
+
+// stop the PIO wherever it waits, and feed it attempts from `words`
+static void campaign_pio_start(const uint32_t* words, uint32_t attempts) {
+    dma_channel_abort(campaign_pio_channel);
+    pio_sm_set_enabled(campaign_pio.pio, campaign_pio.sm, false);
+    pio_sm_clear_fifos(campaign_pio.pio, campaign_pio.sm);
+    pio_sm_restart(campaign_pio.pio, campaign_pio.sm);
+    pio_sm_exec(campaign_pio.pio, campaign_pio.sm, pio_encode_jmp(campaign_pio.offset));
+    pio_sm_exec(campaign_pio.pio, campaign_pio.sm, pio_encode_set(pio_pins, 0));
+    pio_sm_set_enabled(campaign_pio.pio, campaign_pio.sm, true);
+    if (attempts) {
+        dma_channel_transfer_from_buffer_now(campaign_pio_channel, words, attempts * GLITCH_WORDS_PER_ATTEMPT);
+    }
+}
+
+static bool campaign_cancelled(void) {
+    char c;
+    return button_get(0) || rx_fifo_try_get(&c);
+}
+
+static void campaign_status(uint32_t attempt, uint32_t total, const uint32_t* totals) {
+    printf("\r%d/%d", attempt, total);
+    for (uint8_t i = 0; i < GLITCH_CLASS_COUNT; i++) {
+        printf(" %s%s%s %d", ui_term_color_info(), glitch_class_name(i), ui_term_color_reset(), totals[i]);
+    }
+    printf(" ");
+}
+
+static void campaign_hit(uint32_t attempt, const glitch_point_t* p, const uint8_t* reply, uint32_t len) {
+    printf("\r\n%sSuccess%s attempt %d, delay %d width %d edges %d RX: ",
+           ui_term_color_notice(),
+           ui_term_color_reset(),
+           attempt,
+           p->delay,
+           p->width,
+           p->edges);
+    for (uint32_t i = 0; i < len; i++) {
+        printf("%c", (reply[i] >= 0x20 && reply[i] < 0x7f) ? reply[i] : '.');
+    }
+    printf("\r\n");
+}
+
+static bool campaign_save(const char* filename, const glitch_sched_t* s, const glitch_cell_t* cells) {
+    FIL file;
+    char line[96];
+    if (file_open(&file, filename, FA_CREATE_ALWAYS | FA_WRITE)) {
+        return false;
+    }
+    int len = glitch_csv_header(line, sizeof(line));
+    bool error = file_write(&file, (uint8_t*)line, len);
+    for (uint32_t i = 0; i < s->points && !error; i++) {
+        len = glitch_csv_row(line, sizeof(line), s, i, &cells[i]);
+        error = file_write(&file, (uint8_t*)line, len);
+    }
+    file_close(&file);
+    if (!error) {
+        printf("%d points written to %s\r\n", s->points, filename);
+    }
+    return !error;
+}
+
+void uart_glitch_campaign_handler(struct command_result* res) {
+    if (bp_cmd_help_check(&uart_glitch_campaign_def, res->help_flag)) {
+        return;
+    }
+
+    uint32_t trg, rounds, wait_ms, quiet_us, recycle_us;
+    if (bp_cmd_flag(&uart_glitch_campaign_def, 't', &trg) == BP_CMD_INVALID ||
+        bp_cmd_flag(&uart_glitch_campaign_def, 'n', &rounds) == BP_CMD_INVALID ||
+        bp_cmd_flag(&uart_glitch_campaign_def, 'w', &wait_ms) == BP_CMD_INVALID ||
+        bp_cmd_flag(&uart_glitch_campaign_def, 'q', &quiet_us) == BP_CMD_INVALID ||
+        bp_cmd_flag(&uart_glitch_campaign_def, 'r', &recycle_us) == BP_CMD_INVALID) {
+        res->error = true;
+        return;
+    }
+
+    glitch_axis_t delay, width, edges;
+    uint32_t trigger_edges = campaign_trigger_edges(trg);
+    edges.start = edges.stop = trigger_edges;
+    edges.step = 1;
+    if (!campaign_axis_flag('d', &delay, true) || !campaign_axis_flag('g', &width, true) ||
+        !campaign_axis_flag('e', &edges, false)) {
+        res->error = true;
+        return;
+    }
+    if (edges.stop > trigger_edges) {
+        printf("Error: the trigger character has edges 0 to %d\r\n", trigger_edges);
+        res->error = true;
+        return;
+    }
+
+    glitch_match_t match;
+    campaign_text_flag('f', match.fail, "#");
+    campaign_text_flag('k', match.success, "");
+    campaign_text_flag('z', match.reset, "");
+    bool shuffle = bp_cmd_find_flag(&uart_glitch_campaign_def, 's');
+    bool stop_on_success = bp_cmd_find_flag(&uart_glitch_campaign_def, 'x');
+    bool check_ready = !bp_cmd_find_flag(&uart_glitch_campaign_def, 'y');
+    char filename[13];
+    bool save = bp_cmd_find_flag(&uart_glitch_campaign_def, 'o');
+    if (save && !bp_file_get_name_flag(&uart_glitch_campaign_def, 'o', filename, sizeof(filename))) {
+        res->error = true;
+        return;
+    }
+
+    glitch_sched_t sched;
+    if (!glitch_sched_init(&sched, &delay, &width, &edges, rounds, shuffle, time_us_32(), CAMPAIGN_MAX_POINTS)) {
+        printf("Error: more than %d points in the grid\r\n", CAMPAIGN_MAX_POINTS);
+        res->error = true;
+        return;
+    }
+
+    if (!ui_help_check_vout_vref()) {
+        return;
+    }
+
+    // histogram, then the batch of points and PIO words
+    uint32_t cells_size = CAMPAIGN_MAX_POINTS * sizeof(glitch_cell_t);
+    uint32_t mem_size = cells_size + CAMPAIGN_BATCH * (sizeof(glitch_point_t) + GLITCH_WORDS_PER_ATTEMPT * 4);
+    uint8_t* mem = mem_alloc(mem_size, BP_BIG_BUFFER_GLITCH);
+    if (!mem) {
+        res->error = true;
+        return;
+    }
+    glitch_cell_t* cells = (glitch_cell_t*)mem;
+    glitch_point_t* points = (glitch_point_t*)(mem + cells_size);
+    uint32_t* words = (uint32_t*)(mem + cells_size + CAMPAIGN_BATCH * sizeof(glitch_point_t));
+    memset(cells, 0, sched.points * sizeof(glitch_cell_t));
+
+    // the campaign has its own DMA on the UART
+    hwuart_rx_pause();
+    bio_put(M_UART_RTS, 0);
+    campaign_pio.pio = PIO_MODE_PIO;
+    campaign_pio.sm = 0;
+    campaign_pio.program = &uart_glitch_program;
+    campaign_pio.offset = pio_add_program(campaign_pio.pio, campaign_pio.program);
+    uart_glitch_program_init(campaign_pio.pio,
+                             campaign_pio.sm,
+                             campaign_pio.offset,
+                             bio2bufiopin[M_UART_GLITCH_TRG],
+                             bio2bufiopin[M_UART_TX]);
+    system_bio_update_purpose_and_label(true, M_UART_GLITCH_TRG, BP_PIN_MODE, pin_labels[0]);
+    system_bio_update_purpose_and_label(true, M_UART_GLITCH_RDY, BP_PIN_IO, pin_labels[1]);
+    bio_output(M_UART_GLITCH_TRG);
+    bio_input(M_UART_GLITCH_RDY);
+    bio_put(M_UART_GLITCH_TRG, 0);
+
+    while (uart_is_readable(M_UART_PORT)) {
+        uart_getc(M_UART_PORT);
+    }
+    if (!campaign_setup_dma()) {
+        printf("Error: no free DMA channels\r\n");
+        res->error = true;
+        goto campaign_cleanup;
+    }
+
+    // the pulse fires at most a character, the delay and the width after the trigger is sent
+    uint32_t char_us = (12 * 1000000u) / hwuart_get_speed();
+    uint32_t total = glitch_sched_total(&sched);
+    printf("%d points, %d attempts. Press Bus Pirate button or any key to exit.\r\n", sched.points, total);
+
+    uint32_t totals[GLITCH_CLASS_COUNT] = { 0 };
+    uint32_t attempt = 0, n;
+    uint32_t status_us = time_us_32();
+    bool cancelled = false, tool_timeout = false, glitched = false;
+    uint8_t reply[CAMPAIGN_REPLY_MAX];
+    while (!cancelled && !tool_timeout && !glitched &&
+           (n = glitch_sched_pack(&sched, points, words, CAMPAIGN_BATCH))) {
+        campaign_pio_start(words, n);
+        for (uint32_t i = 0; i < n; i++) {
+            const glitch_point_t* p = &points[i];
+
+            // external glitcher recharged
+            uint32_t start_us = time_us_32();
+            while (check_ready && !bio_get(M_UART_GLITCH_RDY)) {
+                if ((cancelled = campaign_cancelled())) {
+                    break;
+                }
+                if ((time_us_32() - start_us) > CAMPAIGN_READY_TIMEOUT_US) {
+                    tool_timeout = true;
+                    break;
+                }
+            }
+            if (cancelled || tool_timeout) {
+                break;
+            }
+
+            campaign_rx_take(reply, 0, 0); // drop leftovers from the last attempt
+            uart_putc_raw(M_UART_PORT, (char)trg);
+
+            uint32_t fire_us = 2 * char_us + (p->delay + p->width) / 100 + 10;
+            bool triggered = false;
+            start_us = time_us_32();
+            while ((time_us_32() - start_us) < fire_us) {
+                if (!pio_sm_is_rx_fifo_empty(campaign_pio.pio, campaign_pio.sm)) {
+                    pio_sm_get(campaign_pio.pio, campaign_pio.sm);
+                    triggered = true;
+                    break;
+                }
+            }
+
+            // first byte within the wait time, then bytes until the line is quiet
+            uint32_t len = 0, last = 0;
+            start_us = last = time_us_32();
+            uint64_t deadline = time_us_64() + (uint64_t)wait_ms * 1000 + CAMPAIGN_REPLY_TIMEOUT_US;
+            while (true) {
+                uint32_t now = time_us_32();
+                if (campaign_rx_level()) {
+                    len = campaign_rx_take(reply, len, sizeof(reply));
+                    last = now;
+                } else if (len ? (now - last) >= quiet_us : (now - start_us) >= wait_ms * 1000) {
+                    break;
+                }
+                if (time_us_64() >= deadline || (cancelled = campaign_cancelled())) {
+                    break;
+                }
+            }
+            if (cancelled) {
+                break;
+            }
+
+            uint8_t cls = glitch_classify(&match, reply, len, triggered);
+            glitch_hist_add(cells, p->index, cls);
+            totals[cls]++;
+            attempt++;
+            if (cls == GLITCH_CLASS_SUCCESS) {
+                campaign_hit(attempt, p, reply, len);
+                glitched = stop_on_success;
+            }
+            if (!triggered) {
+                // the PIO is still counting edges, start it again at the next attempt
+                campaign_pio_start(&words[(i + 1) * GLITCH_WORDS_PER_ATTEMPT], n - i - 1);
+            }
+
+            if (glitched || (cancelled = campaign_cancelled())) {
+                break;
+            }
+            if ((time_us_32() - status_us) >= CAMPAIGN_STATUS_US) {
+                status_us = time_us_32();
+                campaign_status(attempt, total, totals);
+            }
+            busy_wait_us_32(recycle_us);
+        }
+    }
+    campaign_status(attempt, total, totals);
+    printf("\r\n");
+
+    if (glitched) {
+        printf("%s%s%s\r\n", ui_term_color_notice(), GET_T(T_UART_GLITCH_GLITCHED), ui_term_color_reset());
+    } else if (tool_timeout) {
+        printf("%s%s%s\r\n", ui_term_color_error(), GET_T(T_UART_TOOL_TIMEOUT), ui_term_color_reset());
+    } else if (cancelled) {
+        printf("%s%s%s\r\n", ui_term_color_notice(), GET_T(T_UART_GLITCH_CANCELLED), ui_term_color_reset());
+    }
+    if (save && !campaign_save(filename, &sched, cells)) {
+        res->error = true;
+    }
+
+campaign_cleanup:
+    campaign_release_dma();
+    pio_sm_set_enabled(campaign_pio.pio, campaign_pio.sm, false);
+    pio_remove_program(campaign_pio.pio, campaign_pio.program, campaign_pio.offset);
+    system_bio_update_purpose_and_label(false, M_UART_GLITCH_TRG, BP_PIN_MODE, 0);
+    system_bio_update_purpose_and_label(false, M_UART_GLITCH_RDY, BP_PIN_IO, 0);
+    bio_put(M_UART_RTS, 1);
+    hwuart_rx_resume();
+    mem_free(mem);
+}
@@ -0,0 +1,19 @@
+/**
+ * @file glitch_campaign.h
+ * @brief UART glitch campaign command interface.
+ * @details Sweeps glitch delay, width and trigger edge over a grid and
+ *          classifies every target reply.
+ */
+
+#ifndef UART_GLITCH_CAMPAIGN
+
+/**
+ * @brief Run a glitch parameter sweep.
+ * @param res  Command result structure
+ */
+void uart_glitch_campaign_handler(struct command_result* res);
+
+extern const struct bp_command_def uart_glitch_campaign_def;
+
+#define UART_GLITCH_CAMPAIGN
+#endif // UART_GLITCH_CAMPAIGN
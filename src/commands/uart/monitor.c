@@ -1,9 +1,34 @@
+/**
+ * @file monitor.c
+ * @brief Two channel UART monitor with timestamps.
+ * @details Sniffs both directions of a full duplex link:
+ *          - Channel A is the UART mode receiver (RX pin), channel B is
+ *            uart1 on IO1, same speed and format
+ *          - Each receiver drains into a DMA ring, the CPU only looks at
+ *            the DMA transfer count so nothing is lost while the terminal
+ *            or the file system is slow, a lapped ring is reported as a drop
+ *          - Chunks are stamped from the system timer (start of the first
+ *            byte, estimated from the byte time), RTS (IO2) and CTS (IO3)
+ *            level changes are stamped when seen
+ *          - lib/uart_mon merges both channels and the line events into
+ *            one time ordered stream, shown as a hex/ASCII view or saved
+ *            as binary records to a file
+ *
+ *          On exit the bytes, drops, UART FIFO overruns and the peak ring
+ *          fill per channel are shown. A peak well below 100% means the
+ *          baud rate is sustained with room to spare.
+ *
+ *          The -p flag runs the old Dual RS232 plank test instead.
+ */
+
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include <stdint.h>
 #include "hardware/timer.h"
 #include "hardware/uart.h"
+#include "hardware/dma.h"
 #include "pirate.h"
 #include "system_config.h"
 #include "command_struct.h"
@@ -12,60 +37,338 @@
 #include "bytecode.h"
 #include "mode/hwuart.h"
 #include "pirate/button.h"
-// #include "usb_rx.h"
-// #include "usb_tx.h"
+#include "pirate/file.h"
+#include "pirate/mem.h"
+#include "pirate/hwuart_rx.h"
+#include "usb_rx.h"
+#include "usb_tx.h"
 #include "pirate/bio.h"
 #include "lib/bp_args/bp_cmd.h"
+#include "lib/uart_mon/uart_mon.h"
 #include "ui/ui_toolbar.h"
+#include "commands/uart/monitor.h"
+
+// channel B and the flow control lines, the UART mode uses IO4-IO7
+#define MON_UART_B uart1
+#define MON_RX_B BIO1
+#define MON_RTS BIO2
+#define MON_CTS BIO3
+// RX DMA rings, the DMA wraps the write address so they must be aligned to their size
+#define MON_RING_BITS 13
+#define MON_RING_SIZE (1u << MON_RING_BITS)
+// the top 4 bits of the RP2350 transfer count are the mode, 0xf would be endless and never count down
+#if RPI_PLATFORM == RP2350
+#define MON_COUNT_MASK 0x0fffffffu
+#else
+#define MON_COUNT_MASK 0xffffffffu
+#endif
+// a multiple of the ring size, so the ring slot stays in step with the written count across re-arms
+#define MON_RELOAD (MON_COUNT_MASK & ~(MON_RING_SIZE - 1))
+// log records are written to the file in blocks this big
+#define MON_LOG_SIZE 8192
+#define MON_STATUS_US 500000
 
-static const char pin_labels[][5] = { "TX->", "RX<-", "CTS", "RTS"
+static const char pin_labels[][5] = { "TX->", "RX<-", "CTS", "RTS", "RX B" };
 
+static const char* const usage[] = {
+    "monitor\t[-f <file>] [-g <us>] [-p(lank)] [-t(oolbar)]",
+    "Show both directions:%s monitor",
+    "New line after 10ms quiet:%s monitor -g 10000",
+    "Save to a file:%s monitor -f uart.bum",
+    "Test Dual RS232 plank:%s monitor -p",
+    "Pins:%s A = RX, B = IO1, RTS = IO2, CTS = IO3 (all inputs)",
+    "Exit:%s press Bus Pirate button or any key",
 };
 
-static const char* const usage[] = { "test\t[-h(elp)] [-t(oolbar)]",
-                                     "Test Dual RS232 plank:%s test"};
+static const bp_val_constraint_t monitor_gap_range = {
+    .type = BP_VAL_UINT32,
+    .u = { .min = 0, .max = 10000000, .def = 5000 },
+};
 
 static const bp_command_opt_t monitor_opts[] = {
-    { "toolbar", 't', BP_ARG_NONE, NULL, 0, NULL },
+    { "file",    'f', BP_ARG_REQUIRED, "file", T_HELP_UART_MONITOR_FILE },
+    { "gap",     'g', BP_ARG_REQUIRED, "us",   T_HELP_UART_MONITOR_GAP, &monitor_gap_range },
+    { "plank",   'p', BP_ARG_NONE,     NULL,   T_UART_CMD_TEST },
+    { "toolbar", 't', BP_ARG_NONE,     NULL,   T_HELP_UART_MONITOR_TOOLBAR },
     { 0 }
 };
 
 const bp_command_def_t uart_monitor_def = {
     .name = "monitor",
-    .description = T_UART_CMD_TEST,
+    .description = T_HELP_UART_MONITOR,
     .opts = monitor_opts,
     .usage = usage,
     .usage_count = count_of(usage),
 };
 
-bool uart_timer_callback(struct repeating_timer* t) {
-    static int cnt = 0;
-    if (cnt % 2) {
-        uart_putc_raw(uart0, 'A' + cnt);
-    } else {
-        uart_putc_raw(uart1, 'A' + cnt);
+typedef struct {
+    uart_inst_t* uart;
+    int channel;
+    int control_channel;
+    uint8_t* ring;
+    uint32_t last_count; // DMA transfer count at the last poll
+    uint32_t written;    // bytes written by the DMA, free running
+    uint32_t read;       // bytes taken from the ring, free running
+    uint32_t lost;
+    uint32_t overruns;   // UART FIFO overruns, the DMA was not fast enough
+    uint32_t peak;       // most bytes waiting in the ring
+} mon_rx_t;
+
+static const uint32_t mon_reload = MON_RELOAD;
+
+static void mon_rx_release(mon_rx_t* rx) {
+    int* channels[] = { &rx->channel, &rx->control_channel };
+    for (uint32_t i = 0; i < count_of(channels); i++) {
+        if (*channels[i] >= 0) {
+            dma_channel_cleanup(*channels[i]);
+            dma_channel_unclaim(*channels[i]);
+            *channels[i] = -1;
+        }
     }
-    cnt++;
-    if (cnt > 25) {
-        cnt = 0;
+}
+
+static bool mon_rx_setup(mon_rx_t* rx, uart_inst_t* uart, uint8_t* ring) {
+    memset(rx, 0, sizeof(*rx));
+    rx->uart = uart;
+    rx->ring = ring;
+    rx->channel = dma_claim_unused_channel(false);
+    rx->control_channel = dma_claim_unused_channel(false);
+    if (rx->channel < 0 || rx->control_channel < 0) {
+        mon_rx_release(rx);
+        return false;
     }
+
+    // control channel re-arms the ring channel when its (very long) transfer completes
+    dma_channel_config c = dma_channel_get_default_config(rx->control_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(
+        rx->control_channel, &c, &dma_hw->ch[rx->channel].al1_transfer_count_trig, &mon_reload, 1, false);
+
+    c = dma_channel_get_default_config(rx->channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, MON_RING_BITS);
+    channel_config_set_dreq(&c, uart_get_dreq(uart, false));
+    channel_config_set_chain_to(&c, rx->control_channel);
+    rx->last_count = mon_reload;
+    dma_channel_configure(rx->channel, &c, ring, &uart_get_hw(uart)->dr, mon_reload, true);
     return true;
 }
-void monitor_plank_test(void);
-void uart_monitor_handler(struct command_result* res) {
-    if (bp_cmd_help_check(&uart_monitor_def, res->help_flag)) {
+
+// move what the DMA wrote since the last poll into the merge
+static void mon_rx_poll(mon_rx_t* rx, umon_merge_t* m, uint8_t chan, uint32_t now, uint32_t byte_ns) {
+    // the DMA counts down, the control channel re-arms it at 0
+    uint32_t count = dma_channel_hw_addr(rx->channel)->transfer_count & MON_COUNT_MASK;
+    rx->written += (count <= rx->last_count) ? rx->last_count - count : rx->last_count + mon_reload - count;
+    rx->last_count = count;
+
+    if (uart_get_hw(rx->uart)->rsr & UART_UARTRSR_OE_BITS) {
+        uart_get_hw(rx->uart)->rsr = 0; // any write clears the error flags
+        rx->overruns++;
+    }
+
+    uint32_t avail = rx->written - rx->read;
+    if (avail > rx->peak) {
+        rx->peak = avail;
+    }
+    if (avail > MON_RING_SIZE - 16) {
+        // lapped, keep a margin from the byte the DMA is writing now
+        uint32_t lost = avail - MON_RING_SIZE / 2;
+        umon_push_drop(m, chan, now - (uint32_t)((uint64_t)avail * byte_ns / 1000), lost);
+        rx->read += lost;
+        rx->lost += lost;
+        avail -= lost;
+    }
+
+    // the bytes waiting arrived back to back up to now
+    uint32_t ts = now - (uint32_t)((uint64_t)avail * byte_ns / 1000);
+    uint32_t n = umon_space(m, chan);
+    if (n > avail) {
+        n = avail;
+    }
+    while (n) {
+        uint32_t pos = rx->read & (MON_RING_SIZE - 1);
+        uint32_t part = (n < MON_RING_SIZE - pos) ? n : MON_RING_SIZE - pos;
+        umon_push_data(m, chan, ts, byte_ns, &rx->ring[pos], part);
+        ts += (uint32_t)((uint64_t)part * byte_ns / 1000);
+        rx->read += part;
+        avail -= part;
+        n -= part;
+    }
+    // a byte still on the wire started up to one byte time ago
+    umon_seen(m, chan, now - (uint32_t)((uint64_t)(avail + 1) * byte_ns / 1000));
+}
+
+static void mon_write(void* ctx, const char* buf, size_t len) {
+    (void)ctx;
+    tx_fifo_write(buf, (uint32_t)len);
+}
+
+static uint8_t mon_lines(void) {
+    return (bio_get(MON_RTS) ? UMON_LINE_RTS : 0) | (bio_get(MON_CTS) ? UMON_LINE_CTS : 0);
+}
+
+static void mon_pins_setup(uint32_t baud) {
+    uint32_t data_bits, stop_bits, parity;
+    hwuart_get_format(&data_bits, &stop_bits, &parity);
+    uart_init(MON_UART_B, baud);
+    uart_set_format(MON_UART_B, data_bits, stop_bits, (uart_parity_t)parity);
+    bio_buf_input(MON_RX_B);
+    bio_set_function(MON_RX_B, GPIO_FUNC_UART);
+    bio_input(MON_RTS);
+    bio_input(MON_CTS);
+    system_bio_update_purpose_and_label(true, MON_RX_B, BP_PIN_MODE, pin_labels[4]);
+    system_bio_update_purpose_and_label(true, MON_RTS, BP_PIN_MODE, pin_labels[3]);
+    system_bio_update_purpose_and_label(true, MON_CTS, BP_PIN_MODE, pin_labels[2]);
+    // drop the glitch bytes from setup
+    while (uart_is_readable(M_UART_PORT)) {
+        (void)uart_getc(M_UART_PORT);
+    }
+    while (uart_is_readable(MON_UART_B)) {
+        (void)uart_getc(MON_UART_B);
+    }
+}
+
+static void mon_pins_cleanup(void) {
+    uart_deinit(MON_UART_B);
+    bio_set_function(MON_RX_B, GPIO_FUNC_SIO);
+    bio_input(MON_RX_B);
+    system_bio_update_purpose_and_label(false, MON_RX_B, BP_PIN_MODE, 0);
+    system_bio_update_purpose_and_label(false, MON_RTS, BP_PIN_MODE, 0);
+    system_bio_update_purpose_and_label(false, MON_CTS, BP_PIN_MODE, 0);
+}
+
+static bool mon_cancelled(void) {
+    char c;
+    return button_get(0) || rx_fifo_try_get(&c);
+}
+
+static void mon_stats(const mon_rx_t* rx, char name) {
+    printf("%c: %lu bytes, %lu lost, %lu UART overruns, ring peak %lu%%\r\n",
+           name,
+           (unsigned long)rx->read,
+           (unsigned long)rx->lost,
+           (unsigned long)rx->overruns,
+           (unsigned long)(rx->peak * 100 / MON_RING_SIZE));
+}
+
+static void monitor_run(const char* filename, uint32_t gap_us) {
+    uint32_t baud = hwuart_get_speed();
+    uint32_t data_bits, stop_bits, parity;
+    hwuart_get_format(&data_bits, &stop_bits, &parity);
+    uint32_t byte_ns = (uint32_t)((1 + data_bits + (parity ? 1 : 0) + stop_bits) * 1000000000ull / baud);
+
+    uint8_t* mem = mem_alloc(BIG_BUFFER_SIZE, BP_BIG_BUFFER_UART_MON);
+    if (!mem) {
+        printf("Error: big buffer unavailable (in use by another command)\r\n");
         return;
     }
-    if (!ui_help_check_vout_vref()) {
+    // rings first, aligned, then the merge lanes and the log block
+    uint8_t* rings = (uint8_t*)(((uintptr_t)mem + MON_RING_SIZE - 1) & ~(uintptr_t)(MON_RING_SIZE - 1));
+    umon_merge_t* m = (umon_merge_t*)&rings[2 * MON_RING_SIZE];
+    uint8_t* log_buf = (uint8_t*)&m[1];
+    uint32_t log_len = 0;
+    umon_fmt_t fmt;
+    FIL file;
+    bool logging = filename != NULL;
+    bool error = false;
+
+    mon_rx_t rx[2];
+    if (!mon_rx_setup(&rx[0], M_UART_PORT, rings) || !mon_rx_setup(&rx[1], MON_UART_B, &rings[MON_RING_SIZE])) {
+        printf("Error: no free DMA channels\r\n");
+        mon_rx_release(&rx[0]);
+        mem_free(mem);
+        return;
+    }
+    if (logging && file_open(&file, filename, FA_CREATE_ALWAYS | FA_WRITE)) {
+        mon_rx_release(&rx[0]);
+        mon_rx_release(&rx[1]);
+        mem_free(mem);
         return;
     }
 
-    bool toolbar_paused = false;
-    bool pause_toolbar = bp_cmd_find_flag(&uart_monitor_def, 't');
-    if (pause_toolbar) {
-        toolbar_pause_updates();
-        toolbar_paused = true;
+    uint32_t t0 = time_us_32();
+    umon_merge_init(m);
+    umon_fmt_init(&fmt, mon_write, NULL, t0, byte_ns, gap_us);
+    fmt.chan_color[UMON_CH_A] = ui_term_color_info();
+    fmt.chan_color[UMON_CH_B] = ui_term_color_notice();
+    fmt.reset = ui_term_color_reset();
+    if (logging) {
+        umon_log_header(log_buf, baud, t0);
+        log_len = UMON_LOG_HEADER_LEN;
     }
+
+    printf("%s%lu baud, %s. Press Bus Pirate button or any key to exit%s\r\n",
+           ui_term_color_notice(),
+           (unsigned long)baud,
+           logging ? filename : "A/B hex view",
+           ui_term_color_reset());
+
+    uint8_t lines = mon_lines();
+    umon_push_line(m, t0, lines);
+    uint32_t status_us = t0;
+    bool done = false;
+    while (!done && !error) {
+        done = mon_cancelled();
+        uint32_t now = time_us_32();
+
+        uint8_t l = mon_lines();
+        if (l != lines && umon_push_line(m, now, l)) {
+            lines = l;
+        }
+        umon_seen(m, UMON_LANE_LINES, now);
+        mon_rx_poll(&rx[0], m, UMON_CH_A, now, byte_ns);
+        mon_rx_poll(&rx[1], m, UMON_CH_B, now, byte_ns);
+
+        umon_rec_t r;
+        while (umon_pop(m, &r, done)) {
+            if (!logging) {
+                umon_fmt_rec(&fmt, &r);
+                continue;
+            }
+            log_len += umon_rec_pack(&r, &log_buf[log_len]);
+            if (log_len > MON_LOG_SIZE - UMON_REC_PACKED_MAX) {
+                error = file_write(&file, log_buf, log_len);
+                log_len = 0;
+                if (error) {
+                    break;
+                }
+            }
+        }
+
+        if (logging && now - status_us > MON_STATUS_US) {
+            status_us = now;
+            printf("\rA: %lu B: %lu bytes ", (unsigned long)rx[0].read, (unsigned long)rx[1].read);
+        }
+    }
+
+    if (logging) {
+        if (!error && log_len) {
+            error = file_write(&file, log_buf, log_len);
+        }
+        if (!error) {
+            file_close(&file);
+        }
+        printf("\r\n");
+    } else {
+        umon_fmt_flush(&fmt);
+    }
+
+    mon_rx_release(&rx[0]);
+    mon_rx_release(&rx[1]);
+    mem_free(mem);
+
+    mon_stats(&rx[0], 'A');
+    mon_stats(&rx[1], 'B');
+}
+
+void monitor_plank_test(void);
+
+// uart1 on IO0/IO1 with flow control on IO2/IO3, uart0 flow control on IO6/IO7
+static void monitor_plank_pins(void) {
     uint speed = 115200;
     uint data_bits = 8;
     uint stop_bits = 1;
@@ -102,10 +405,8 @@ void uart_monitor_handler(struct command_result* res) {
     system_bio_update_purpose_and_label(true, BIO3, BP_PIN_MODE, pin_labels[3]);
     system_bio_update_purpose_and_label(true, BIO6, BP_PIN_MODE, pin_labels[2]);
     system_bio_update_purpose_and_label(true, BIO7, BP_PIN_MODE, pin_labels[3]);
+    printf("\r\n");
 
-    printf("%s%s%s\r\n", ui_term_color_notice(), GET_T(T_HELP_UART_BRIDGE_EXIT), ui_term_color_reset());
-
-    // add_repeating_timer_ms(-5000, uart_timer_callback, NULL, &uart_timer);
     busy_wait_ms(10);
     if (uart_is_readable(uart0)) {
         (void)uart_getc(uart0);
@@ -113,18 +414,49 @@ void uart_monitor_handler(struct command_result* res) {
     if (uart_is_readable(uart1)) {
         (void)uart_getc(uart1);
     }
+}
 
-    monitor_plank_test();
-    return;
+void uart_monitor_handler(struct command_result* res) {
+    if (bp_cmd_help_check(&uart_monitor_def, res->help_flag)) {
+        return;
+    }
+    if (!ui_help_check_vout_vref()) {
+        return;
+    }
 
-    while (true) {
-        // exit when button pressed.
-        if (button_get(0)) {
-            break;
-        }
+    if (bp_cmd_find_flag(&uart_monitor_def, 'p')) {
+        hwuart_rx_pause();
+        monitor_plank_pins();
+        monitor_plank_test();
+        hwuart_rx_resume();
+        return;
+    }
+
+    char filename[13];
+    bool save = bp_cmd_find_flag(&uart_monitor_def, 'f');
+    if (save && !bp_file_get_name_flag(&uart_monitor_def, 'f', filename, sizeof(filename))) {
+        res->error = true;
+        return;
+    }
+    uint32_t gap_us;
+    if (bp_cmd_flag(&uart_monitor_def, 'g', &gap_us) == BP_CMD_INVALID) {
+        res->error = true;
+        return;
+    }
+
+    // the view writes a lot, the toolbar would break it up
+    bool toolbar_paused = false;
+    if (!bp_cmd_find_flag(&uart_monitor_def, 't')) {
+        toolbar_pause_updates();
+        toolbar_paused = true;
     }
 
-    // cancel_repeating_timer(&uart_timer);
+    // channel A gets its own DMA ring
+    hwuart_rx_pause();
+    mon_pins_setup(hwuart_get_speed());
+    monitor_run(save ? filename : NULL, gap_us);
+    mon_pins_cleanup();
+    hwuart_rx_resume();
 
     if (toolbar_paused) {
         toolbar_resume_updates();
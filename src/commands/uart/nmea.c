@@ -12,6 +12,7 @@
 #include "lib/bp_args/bp_cmd.h"
 #include "bytecode.h"
 #include "mode/hwuart.h"
+#include "pirate/hwuart_rx.h"
 #include "usb_rx.h"
 #include "usb_tx.h"
 
@@ -51,8 +52,9 @@ void nmea_decode_handler(struct command_result* res) {
                 return;
             }
 
-            if (uart_is_readable(M_UART_PORT)) {
-                uint32_t temp = uart_getc(M_UART_PORT);
+            uint8_t b;
+            if (hwuart_rx_get(&b, NULL)) {
+                uint32_t temp = b;
                 if (nmea_cnt > 0 || temp == '$') {
                     line[nmea_cnt] = temp;
                     nmea_cnt++;
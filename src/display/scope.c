@@ -50,6 +50,7 @@ extern const FONT_INFO hunter_12ptFontInfo;
 #include "ui/ui_cmdln.h"
 #include "usb_rx.h"
 #include "pirate/amux.h"
+#include "pirate/psu_guard.h"
 
 static int convert_trigger_position(int pos);
 
@@ -348,6 +349,8 @@ static void dma_handler(void) {
     }
 }
 
+static bool scope_paused_psu_guard = false;
+
 static void scope_stop(void) {
     if (scope_running) {
         return;
@@ -372,6 +375,10 @@ static void scope_stop(void) {
         }
     }
     amux_sweep();
+    if (scope_paused_psu_guard) {
+        scope_paused_psu_guard = false;
+        psu_guard_resume();
+    }
     system_config.info_bar_changed = 1;
 }
 
@@ -412,6 +419,11 @@ static void scope_start(int pin) {
     // adc_init();
     // adc_gpio_init(CURRENT_SENSE);
     // adc_gpio_init(AMUX_OUT);
+    // the PSU guard free-runs the ADC on VOUT, it stops until the scope is done
+    if (!scope_paused_psu_guard) {
+        scope_paused_psu_guard = true;
+        psu_guard_pause();
+    }
     adc_select_input(AMUX_OUT_ADC);
     amux_select_bio(pin);
     timebase = display_timebase;
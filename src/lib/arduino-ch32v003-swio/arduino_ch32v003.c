@@ -2,9 +2,7 @@
 #include "pico/stdlib.h"
 #include <stdint.h>
 #include "pirate.h"
-#include "swio.h"
 #include "pirate/bio.h"
-#include "swio.h"
 #include "pirate/psu.h"
 #include "system_config.h"
 
@@ -12,6 +10,7 @@
 #include "usb_tx.h"
 #include "tusb.h"
 #include "lib/picorvd/picoswio.h"
+#include "lib/ch32v_dm/ch32v_dm.h"
 
 void target_power(int x){
     if (x)
@@ -27,11 +26,37 @@ void target_power(int x){
 #define PROTOCOL_POWER_OFF 'P'
 #define PROTOCOL_WRITE_REG 'w'
 #define PROTOCOL_READ_REG  'r'
+#define PROTOCOL_FLASH     'f' // Bus Pirate: erase, program and verify a 64 byte page
+#define PROTOCOL_RESUME    'g' // Bus Pirate: lock the flash and run
+#define PROTOCOL_NAK       '-'
+
+// block and flash sequencing on top of the PIO SWIO transport
+static cvdm_t dm;
+static bool swio_ready = false;
+
+static void swio_link_reset(void) {
+    ch32vswio_reset(bio2bufiopin[BIO0], bio2bufdirpin[BIO0]);
+    cvdm_init(&dm, ch32vswio_get, ch32vswio_put);
+    swio_ready = true;
+}
+
+static uint32_t get_u32(void) {
+    char c;
+    uint32_t val = 0;
+    for (uint8_t i = 0; i < 4; i++) { // LSB first
+        bin_rx_fifo_get_blocking(&c);
+        val |= ((uint32_t)(uint8_t)c) << (i * 8);
+    }
+    return val;
+}
 
 const char arduino_ch32v003_name[]="Arduino CH32V003 SWIO";
 
 void arduino_ch32v003_cleanup(void){
-    ch32vswio_cleanup();
+    if (swio_ready) {
+        ch32vswio_cleanup();
+    }
+    swio_ready = false;
 }
 
 void arduino_ch32v003(void) {
@@ -54,7 +79,7 @@ void arduino_ch32v003(void) {
     if(bin_rx_fifo_try_get(&c)) { //co-op multitask
         switch (c) {
             case PROTOCOL_TEST:
-                ch32vswio_reset(bio2bufiopin[BIO0], bio2bufdirpin[BIO0]);
+                swio_link_reset();
                 bin_tx_fifo_put(PROTOCOL_ACK);
                 break;
             case PROTOCOL_POWER_ON:
@@ -63,24 +88,25 @@ void arduino_ch32v003(void) {
                 break;
             case PROTOCOL_POWER_OFF:
                 target_power(0);
+                cvdm_sync(&dm);
                 bin_tx_fifo_put(PROTOCOL_ACK);
                 break;
             case PROTOCOL_WRITE_REG:
                 //fread(&reg, sizeof(uint8_t), 1, uart);
                 bin_rx_fifo_get_blocking(&reg);
                 //fread(&val, sizeof(uint32_t), 1, uart);
-                for(uint8_t i=0;i<4;i++){
-                    val=(val>>8);
-                    bin_rx_fifo_get_blocking(&c);
-                    val|=(c<<24);
-                }
+                val = get_u32();
+                if (!swio_ready) swio_link_reset();
                 //swio_write_reg(reg, val);
                 ch32vswio_put(reg, val);
+                // the host may have changed the progbuf or halt state
+                cvdm_sync(&dm);
                 bin_tx_fifo_put(PROTOCOL_ACK);
                 break;
             case PROTOCOL_READ_REG:
                 //fread(&reg, sizeof(uint8_t), 1, uart);
                 bin_rx_fifo_get_blocking(&reg);
+                if (!swio_ready) swio_link_reset();
                 //val = swio_read_reg(reg);
                 val = ch32vswio_get(reg);
                 //fwrite(&val, sizeof(uint32_t), 1, uart);
@@ -90,6 +116,27 @@ void arduino_ch32v003(void) {
                     val=val>>8;
                 }
                 break;
+            case PROTOCOL_FLASH: {
+                uint32_t words[CVDM_PAGE_WORDS];
+                uint32_t addr = get_u32();
+                for (uint8_t i = 0; i < CVDM_PAGE_WORDS; i++) {
+                    words[i] = get_u32();
+                }
+                if (!swio_ready) swio_link_reset();
+                dm.error = CVDM_OK;
+                if (cvdm_flash_page(&dm, addr, words, true)) {
+                    bin_tx_fifo_put(PROTOCOL_ACK);
+                } else {
+                    bin_tx_fifo_put(PROTOCOL_NAK);
+                    bin_tx_fifo_put((char)dm.error);
+                }
+                break;
+            }
+            case PROTOCOL_RESUME:
+                if (!swio_ready) swio_link_reset();
+                dm.error = CVDM_OK;
+                bin_tx_fifo_put(cvdm_resume(&dm) ? PROTOCOL_ACK : PROTOCOL_NAK);
+                break;
         }
     }
 }
@@ -0,0 +1,426 @@
+/*
+ * bus_journal.c — Binary journal of executed syntax and pcapng export
+ *
+ * See bus_journal.h.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include "bus_journal.h"
+
+#include <string.h>
+
+static_assert(sizeof(bus_journal_record_t) == 16, "journal records are 16 bytes");
+static_assert(sizeof(bus_journal_header_t) == sizeof(bus_journal_record_t), "the header takes one record slot");
+
+// producer and consumer share a core, keep the compiler in order
+#define BUS_JOURNAL_BARRIER() __asm__ volatile("" ::: "memory")
+
+/* ── Record ring ───────────────────────────────────────────────────── */
+
+void bus_journal_init(bus_journal_t* j, bus_journal_record_t* ring, uint32_t records, bool header) {
+    memset(j, 0, sizeof(*j));
+    j->ring = ring;
+    j->mask = records - 1;
+    if (header) {
+        bus_journal_header((const bus_journal_t*)j, (bus_journal_header_t*)&ring[0]);
+        j->head = 1;
+    }
+}
+
+uint32_t bus_journal_level(const bus_journal_t* j) {
+    return j->head - j->tail;
+}
+
+// the slot to fill, NULL and counted lost if the ring is full
+static inline bus_journal_record_t* bus_journal_slot(bus_journal_t* j) {
+    if (j->head - j->tail > j->mask) {
+        j->lost++;
+        j->lost_pending = true;
+        return NULL;
+    }
+    return &j->ring[j->head & j->mask];
+}
+
+static inline void bus_journal_put(bus_journal_t* j, bus_journal_record_t* r) {
+    if (j->lost_pending) {
+        r->flags |= BUS_JOURNAL_LOST;
+        j->lost_pending = false;
+    }
+    BUS_JOURNAL_BARRIER();
+    j->head++;
+    j->records++;
+}
+
+void bus_journal_run(bus_journal_t* j, uint64_t time_us, uint8_t mode, bus_journal_proto_t proto) {
+    j->mode = mode;
+    bus_journal_record_t* r = bus_journal_slot(j);
+    if (!r) {
+        return;
+    }
+    r->time_us = (uint32_t)time_us;
+    r->mode = mode;
+    r->command = BUS_JOURNAL_RUN;
+    r->bits = (uint8_t)proto;
+    r->flags = 0;
+    r->out_data = (uint32_t)(time_us >> 32);
+    r->in_data = 0;
+    bus_journal_put(j, r);
+}
+
+void bus_journal_add(bus_journal_t* j, const struct _bytecode* b, uint32_t time_us) {
+    bus_journal_record_t* r = bus_journal_slot(j);
+    if (!r) {
+        return;
+    }
+    r->time_us = time_us;
+    r->mode = j->mode;
+    r->command = b->command;
+    r->bits = (uint8_t)b->bits;
+    r->flags = (b->error & BUS_JOURNAL_ERROR_MASK) | (b->read_with_write ? BUS_JOURNAL_READ_WITH_WRITE : 0);
+    r->out_data = b->out_data;
+    r->in_data = b->in_data;
+    bus_journal_put(j, r);
+}
+
+bool bus_journal_drain(bus_journal_t* j, uint32_t chunk, bus_journal_write_t write, void* ctx) {
+    uint32_t level = bus_journal_level(j);
+    uint32_t todo = level - (level % chunk);
+    BUS_JOURNAL_BARRIER();
+    while (todo) {
+        uint32_t offset = j->tail & j->mask;
+        uint32_t n = j->mask + 1 - offset;
+        if (n > todo) {
+            n = todo;
+        }
+        uint32_t len = n * sizeof(bus_journal_record_t);
+        uint32_t taken = write(ctx, (const uint8_t*)&j->ring[offset], len);
+        BUS_JOURNAL_BARRIER();
+        j->tail += taken / sizeof(bus_journal_record_t);
+        if (taken < len) {
+            return false;
+        }
+        todo -= n;
+    }
+    return true;
+}
+
+void bus_journal_header(const bus_journal_t* j, bus_journal_header_t* h) {
+    h->magic = BUS_JOURNAL_MAGIC;
+    h->version = BUS_JOURNAL_VERSION;
+    h->record_size = sizeof(bus_journal_record_t);
+    h->records = j->records;
+    h->lost = j->lost;
+}
+
+bool bus_journal_header_check(const bus_journal_header_t* h) {
+    return h->magic == BUS_JOURNAL_MAGIC && h->version == BUS_JOURNAL_VERSION &&
+           h->record_size == sizeof(bus_journal_record_t);
+}
+
+/* ── pcapng blocks ─────────────────────────────────────────────────── */
+
+#define PCAPNG_SHB 0x0a0d0d0au
+#define PCAPNG_IDB 0x00000001u
+#define PCAPNG_EPB 0x00000006u
+#define PCAPNG_BYTE_ORDER 0x1a2b3c4du
+
+#define PCAPNG_OPT_END 0
+#define PCAPNG_OPT_COMMENT 1
+#define PCAPNG_OPT_SHB_USERAPPL 4
+#define PCAPNG_OPT_IF_NAME 2
+#define PCAPNG_OPT_IF_TSRESOL 9
+#define PCAPNG_OPT_EPB_FLAGS 2
+
+#define PCAPNG_INBOUND 1
+#define PCAPNG_OUTBOUND 2
+
+#define PCAPNG_SNAPLEN 0x40000
+
+// struct i2c_linux_pseudo_header: bus, then flags big endian
+#define I2C_LINUX_HEADER 5
+
+static const struct {
+    uint16_t linktype;
+    const char* name;
+} interfaces[BUS_JOURNAL_PROTO_COUNT] = {
+    [BUS_JOURNAL_PROTO_I2C] = { BUS_JOURNAL_LINKTYPE_I2C_LINUX, "I2C" },
+    [BUS_JOURNAL_PROTO_SPI] = { BUS_JOURNAL_LINKTYPE_USER0, "SPI" },
+    [BUS_JOURNAL_PROTO_UART] = { BUS_JOURNAL_LINKTYPE_USER0 + 1, "UART" },
+    [BUS_JOURNAL_PROTO_OTHER] = { BUS_JOURNAL_LINKTYPE_USER0 + 2, "Bus Pirate" },
+};
+
+typedef struct {
+    uint8_t* buf;
+    uint32_t len;
+} block_t;
+
+static void block_u16(block_t* b, uint16_t v) {
+    memcpy(&b->buf[b->len], &v, 2);
+    b->len += 2;
+}
+
+static void block_u32(block_t* b, uint32_t v) {
+    memcpy(&b->buf[b->len], &v, 4);
+    b->len += 4;
+}
+
+static void block_data(block_t* b, const void* data, uint32_t len) {
+    memcpy(&b->buf[b->len], data, len);
+    b->len += len;
+    while (b->len & 3) {
+        b->buf[b->len++] = 0;
+    }
+}
+
+static void block_option(block_t* b, uint16_t code, const void* data, uint16_t len) {
+    block_u16(b, code);
+    block_u16(b, len);
+    block_data(b, data, len);
+}
+
+static void block_begin(block_t* b, uint8_t* buf, uint32_t type) {
+    b->buf = buf;
+    b->len = 0;
+    block_u32(b, type);
+    block_u32(b, 0); // length, filled in at the end
+}
+
+static void block_end(bus_journal_pcap_t* p, block_t* b) {
+    uint32_t total = b->len + 4;
+    memcpy(&b->buf[4], &total, 4);
+    block_u32(b, total);
+    if (p->error) {
+        return;
+    }
+    if (p->write(p->ctx, b->buf, b->len) != b->len) {
+        p->error = true;
+    }
+}
+
+static void pcap_packet(bus_journal_pcap_t* p, bus_journal_proto_t iface, uint64_t time_us, const uint8_t* head,
+                        uint32_t head_len, const uint8_t* data, uint32_t len, uint8_t direction, uint8_t flags) {
+    block_t b;
+    block_begin(&b, p->block, PCAPNG_EPB);
+    block_u32(&b, iface);
+    block_u32(&b, (uint32_t)(time_us >> 32));
+    block_u32(&b, (uint32_t)time_us);
+    block_u32(&b, head_len + len);
+    block_u32(&b, head_len + len);
+    memcpy(&b.buf[b.len], head, head_len);
+    b.len += head_len;
+    block_data(&b, data, len);
+    if (direction) {
+        uint32_t epb_flags = direction;
+        block_option(&b, PCAPNG_OPT_EPB_FLAGS, &epb_flags, 4);
+    }
+    const char* comment = NULL;
+    if (flags & BUS_JOURNAL_LOST) {
+        comment = "records lost before this packet";
+    } else if ((flags & BUS_JOURNAL_ERROR_MASK) >= SERR_ERROR) {
+        comment = "error";
+    } else if ((flags & BUS_JOURNAL_ERROR_MASK) == SERR_WARN) {
+        comment = "warning";
+    }
+    if (comment) {
+        block_option(&b, PCAPNG_OPT_COMMENT, comment, (uint16_t)strlen(comment));
+    }
+    block_u16(&b, PCAPNG_OPT_END);
+    block_u16(&b, 0);
+    block_end(p, &b);
+    p->packets++;
+}
+
+void bus_journal_pcap_begin(bus_journal_pcap_t* p, bus_journal_write_t write, void* ctx) {
+    memset(p, 0, sizeof(*p));
+    p->write = write;
+    p->ctx = ctx;
+    p->proto = BUS_JOURNAL_PROTO_OTHER;
+
+    static const char appl[] = "Bus Pirate";
+    block_t b;
+    block_begin(&b, p->block, PCAPNG_SHB);
+    block_u32(&b, PCAPNG_BYTE_ORDER);
+    block_u16(&b, 1);
+    block_u16(&b, 0);
+    block_u32(&b, 0xffffffffu); // section length unknown
+    block_u32(&b, 0xffffffffu);
+    block_option(&b, PCAPNG_OPT_SHB_USERAPPL, appl, sizeof(appl) - 1);
+    block_u16(&b, PCAPNG_OPT_END);
+    block_u16(&b, 0);
+    block_end(p, &b);
+
+    for (uint32_t i = 0; i < BUS_JOURNAL_PROTO_COUNT; i++) {
+        static const uint8_t tsresol = 6; // microseconds
+        block_begin(&b, p->block, PCAPNG_IDB);
+        block_u16(&b, interfaces[i].linktype);
+        block_u16(&b, 0);
+        block_u32(&b, PCAPNG_SNAPLEN);
+        block_option(&b, PCAPNG_OPT_IF_NAME, interfaces[i].name, (uint16_t)strlen(interfaces[i].name));
+        block_option(&b, PCAPNG_OPT_IF_TSRESOL, &tsresol, 1);
+        block_u16(&b, PCAPNG_OPT_END);
+        block_u16(&b, 0);
+        block_end(p, &b);
+    }
+}
+
+/* ── Framing ───────────────────────────────────────────────────────── */
+
+// the packets being collected, I2C keeps the whole message in out
+static void pcap_flush(bus_journal_pcap_t* p) {
+    if (p->out_len) {
+        if (p->proto == BUS_JOURNAL_PROTO_I2C) {
+            // the address byte says which way the message goes
+            uint8_t head[I2C_LINUX_HEADER] = { 0 };
+            pcap_packet(p, p->proto, p->out_time, head, sizeof(head), p->out, p->out_len,
+                        (p->out[0] & 1) ? PCAPNG_INBOUND : PCAPNG_OUTBOUND, p->out_flags);
+        } else {
+            pcap_packet(p, p->proto, p->out_time, NULL, 0, p->out, p->out_len, PCAPNG_OUTBOUND, p->out_flags);
+        }
+    }
+    if (p->in_len) {
+        pcap_packet(p, p->proto, p->in_time, NULL, 0, p->in, p->in_len, PCAPNG_INBOUND, p->in_flags);
+    }
+    p->out_len = 0;
+    p->in_len = 0;
+    p->out_flags = 0;
+    p->in_flags = 0;
+}
+
+// bits wide values go MSB first in whole bytes, up to 4
+static uint8_t value_bytes(uint8_t bits) {
+    if (!bits) {
+        return 1;
+    }
+    return bits > 32 ? 4 : (bits + 7) / 8;
+}
+
+static void pcap_collect(bus_journal_pcap_t* p, bool in, const bus_journal_record_t* r, uint32_t value) {
+    uint8_t n = value_bytes(r->bits);
+    uint32_t* len = in ? &p->in_len : &p->out_len;
+    if (*len + n > BUS_JOURNAL_PACKET_MAX) {
+        pcap_flush(p);
+    }
+    if (!*len) {
+        *(in ? &p->in_time : &p->out_time) = p->time_us;
+    }
+    uint8_t* buf = in ? p->in : p->out;
+    for (int8_t i = n - 1; i >= 0; i--) {
+        buf[(*len)++] = (uint8_t)(value >> (i * 8));
+    }
+    *(in ? &p->in_flags : &p->out_flags) |= r->flags;
+}
+
+static void pcap_raw(bus_journal_pcap_t* p, const bus_journal_record_t* r) {
+    pcap_packet(p, BUS_JOURNAL_PROTO_OTHER, p->time_us, NULL, 0, (const uint8_t*)r, sizeof(*r), 0, r->flags);
+}
+
+static bool pcap_i2c(bus_journal_pcap_t* p, const bus_journal_record_t* r) {
+    switch (r->command) {
+        case SYN_START:
+            // a restart ends the message before it
+            pcap_flush(p);
+            p->frame = true;
+            return true;
+        case SYN_STOP:
+            pcap_flush(p);
+            p->frame = false;
+            return true;
+        case SYN_WRITE:
+            pcap_collect(p, false, r, r->out_data);
+            return true;
+        case SYN_READ:
+            pcap_collect(p, false, r, r->in_data);
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool pcap_spi(bus_journal_pcap_t* p, const bus_journal_record_t* r) {
+    switch (r->command) {
+        case SYN_START:
+        case SYN_START_ALT:
+        case SYN_STOP:
+        case SYN_STOP_ALT:
+            pcap_flush(p);
+            p->frame = r->command == SYN_START || r->command == SYN_START_ALT;
+            return true;
+        case SYN_WRITE:
+            // full duplex, a write clocks a byte in too
+            pcap_collect(p, false, r, r->out_data);
+            pcap_collect(p, true, r, r->in_data);
+            return true;
+        case SYN_READ:
+            pcap_collect(p, false, r, 0xffffffffu);
+            pcap_collect(p, true, r, r->in_data);
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool pcap_uart(bus_journal_pcap_t* p, const bus_journal_record_t* r) {
+    switch (r->command) {
+        case SYN_WRITE:
+            if (p->in_len) {
+                pcap_flush(p);
+            }
+            pcap_collect(p, false, r, r->out_data);
+            return true;
+        case SYN_READ:
+            if (p->out_len) {
+                pcap_flush(p);
+            }
+            pcap_collect(p, true, r, r->in_data);
+            return true;
+        default:
+            return false;
+    }
+}
+
+void bus_journal_pcap_record(bus_journal_pcap_t* p, const bus_journal_record_t* r) {
+    if (r->command == BUS_JOURNAL_RUN) {
+        pcap_flush(p);
+        p->time_us = ((uint64_t)r->out_data << 32) | r->time_us;
+        p->last_us = r->time_us;
+        p->have_time = true;
+        p->proto = r->bits < BUS_JOURNAL_PROTO_COUNT ? (bus_journal_proto_t)r->bits : BUS_JOURNAL_PROTO_OTHER;
+        p->frame = false;
+        pcap_raw(p, r);
+        return;
+    }
+    if (p->have_time) {
+        p->time_us += (uint32_t)(r->time_us - p->last_us);
+    } else {
+        p->time_us = r->time_us;
+        p->have_time = true;
+    }
+    p->last_us = r->time_us;
+
+    // an error stops the run, its data means nothing
+    bool framed = false;
+    if ((r->flags & BUS_JOURNAL_ERROR_MASK) < SERR_ERROR) {
+        switch (p->proto) {
+            case BUS_JOURNAL_PROTO_I2C:
+                framed = pcap_i2c(p, r);
+                break;
+            case BUS_JOURNAL_PROTO_SPI:
+                framed = pcap_spi(p, r);
+                break;
+            case BUS_JOURNAL_PROTO_UART:
+                framed = pcap_uart(p, r);
+                break;
+            default:
+                break;
+        }
+    }
+    if (!framed) {
+        pcap_raw(p, r);
+    }
+}
+
+bool bus_journal_pcap_end(bus_journal_pcap_t* p) {
+    pcap_flush(p);
+    return !p->error;
+}
@@ -0,0 +1,179 @@
+/*
+ * bus_journal.h — Binary journal of executed syntax and pcapng export
+ *
+ * Every bytecode the syntax runner executes becomes one fixed size
+ * record: the low 32 bits of the system timer, the mode, the command,
+ * bits, error level and the out/in data. Each run starts with a
+ * BUS_JOURNAL_RUN record that carries the whole 64 bit time and the
+ * protocol class of the mode, so record times can be unwrapped and the
+ * exporter knows how to frame the run.
+ *
+ * Records go into a power of 2 ring of records with a single producer
+ * (the syntax runner) and a single consumer (the main loop after the run),
+ * on the same core. Adding one is a few stores; a full ring drops the
+ * record and flags the next one BUS_JOURNAL_LOST. bus_journal_drain()
+ * hands the sink whole chunks; with a chunk that divides the ring every
+ * write is one contiguous block, and since the file header takes the
+ * first record slot the chunks land on sector boundaries in the file.
+ *
+ * File: bus_journal_header_t, then records back to back. The header is
+ * rewritten with the record and lost counts when the journal is closed.
+ *
+ * Export: bus_journal_pcap_*() turns records into a pcapng stream with one
+ * interface per protocol class. I2C uses LINKTYPE_I2C_LINUX, one packet
+ * per START..STOP message (address byte first). SPI and UART have no
+ * standard link type and use LINKTYPE_USER0 and USER1 with the bytes
+ * alone and the direction in epb_flags: one MOSI and one MISO packet per
+ * CS frame, one packet per run of TX or RX bytes. Everything else
+ * (other modes, delays, pin and ADC commands) goes to a USER2 interface,
+ * one raw record per packet.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host
+ * (tests/test_bus_journal.c).
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef BUS_JOURNAL_H
+#define BUS_JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h> // static_assert in bytecode.h
+#include "bytecode.h"
+
+#define BUS_JOURNAL_MAGIC 0x4c4a5042u // "BPJL" little endian
+#define BUS_JOURNAL_VERSION 1
+
+// command of the record that starts each run
+#define BUS_JOURNAL_RUN 0xff
+
+// record flags, bits 2:0 are the error level (SERR_*)
+#define BUS_JOURNAL_ERROR_MASK 0x07
+#define BUS_JOURNAL_READ_WITH_WRITE (1u << 3)
+#define BUS_JOURNAL_LOST (1u << 4) // the ring was full, records before this one are missing
+
+// bytes a packet collects before it is cut
+#define BUS_JOURNAL_PACKET_MAX 256
+
+// pcapng link types
+#define BUS_JOURNAL_LINKTYPE_I2C_LINUX 209
+#define BUS_JOURNAL_LINKTYPE_USER0 147
+
+typedef enum {
+    BUS_JOURNAL_PROTO_I2C = 0,
+    BUS_JOURNAL_PROTO_SPI,
+    BUS_JOURNAL_PROTO_UART,
+    BUS_JOURNAL_PROTO_OTHER,
+    BUS_JOURNAL_PROTO_COUNT,
+} bus_journal_proto_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t time_us;  // system timer bits 31:0
+    uint8_t mode;      // system_config.mode
+    uint8_t command;   // SYN_*, or BUS_JOURNAL_RUN
+    uint8_t bits;      // RUN: protocol class
+    uint8_t flags;     // BUS_JOURNAL_* bits and error level
+    uint32_t out_data; // RUN: system timer bits 63:32
+    uint32_t in_data;
+} bus_journal_record_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t records; // records in the file, written at close
+    uint32_t lost;    // records lost to a full ring, written at close
+} bus_journal_header_t;
+
+typedef struct {
+    bus_journal_record_t* ring;
+    uint32_t mask;          // ring records - 1
+    volatile uint32_t head; // records put, producer only
+    volatile uint32_t tail; // records drained, consumer only
+    uint32_t records;       // records put, RUN and header included
+    uint32_t lost;
+    bool lost_pending;
+    uint8_t mode;           // of the current run
+} bus_journal_t;
+
+/**
+ * Sink for the drain and the exporter, returns the bytes it took. Taking
+ * fewer stops the drain, the rest stays queued.
+ */
+typedef uint32_t (*bus_journal_write_t)(void* ctx, const uint8_t* data, uint32_t len);
+
+/**
+ * @param ring     records, a power of 2
+ * @param header   put the file header in the first slot
+ */
+void bus_journal_init(bus_journal_t* j, bus_journal_record_t* ring, uint32_t records, bool header);
+
+/**
+ * Start a run.
+ * @param time_us  the whole system timer
+ */
+void bus_journal_run(bus_journal_t* j, uint64_t time_us, uint8_t mode, bus_journal_proto_t proto);
+
+/**
+ * Record an executed bytecode.
+ * @param time_us  system timer bits 31:0
+ */
+void bus_journal_add(bus_journal_t* j, const struct _bytecode* b, uint32_t time_us);
+
+uint32_t bus_journal_level(const bus_journal_t* j);
+
+/**
+ * Write out the queued records in whole chunks, 1 for everything.
+ * @return false if the sink took less than it was given
+ */
+bool bus_journal_drain(bus_journal_t* j, uint32_t chunk, bus_journal_write_t write, void* ctx);
+
+/**
+ * Header with the final counts, for rewriting at close.
+ */
+void bus_journal_header(const bus_journal_t* j, bus_journal_header_t* h);
+
+/**
+ * Check a file header.
+ * @return false if it is not a journal this code reads
+ */
+bool bus_journal_header_check(const bus_journal_header_t* h);
+
+/* ── pcapng export ───────────────────────────────────────────────── */
+
+typedef struct {
+    bus_journal_write_t write;
+    void* ctx;
+    bool error;
+    uint32_t packets;
+    // time
+    uint64_t time_us;
+    uint32_t last_us;
+    bool have_time;
+    // current run
+    bus_journal_proto_t proto;
+    bool frame;  // I2C or SPI frame open
+    // pending packet
+    uint64_t out_time, in_time;
+    uint32_t out_len, in_len;
+    uint8_t out_flags, in_flags; // BUS_JOURNAL_* of the bytes in it
+    uint8_t out[BUS_JOURNAL_PACKET_MAX];
+    uint8_t in[BUS_JOURNAL_PACKET_MAX];
+    uint8_t block[BUS_JOURNAL_PACKET_MAX + 96];
+} bus_journal_pcap_t;
+
+/**
+ * Write the section header and the four interfaces.
+ */
+void bus_journal_pcap_begin(bus_journal_pcap_t* p, bus_journal_write_t write, void* ctx);
+
+void bus_journal_pcap_record(bus_journal_pcap_t* p, const bus_journal_record_t* r);
+
+/**
+ * Write out the packets still being collected.
+ * @return false if the sink failed
+ */
+bool bus_journal_pcap_end(bus_journal_pcap_t* p);
+
+#endif // BUS_JOURNAL_H
@@ -0,0 +1,354 @@
+/*
+ * bus_replay.c — Sniffer recordings and timed I2C replay
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <string.h>
+#include "bus_replay.h"
+
+/* ── Recording ─────────────────────────────────────────────────── */
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t payload_bytes(uint8_t type) {
+    switch (type) {
+        case BRP_EV_DATA:
+            return 1;
+        case BRP_EV_XFER:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+void brp_rec_init(brp_rec_t* r, uint8_t* buf, uint32_t cap, brp_bus_t bus, uint32_t bus_hz, uint32_t t0_us) {
+    memset(r, 0, sizeof(*r));
+    r->buf = buf;
+    r->cap = cap;
+    r->last_us = t0_us;
+    if (cap < BRP_HEADER_BYTES) {
+        r->full = true;
+        return;
+    }
+    memcpy(buf, BRP_MAGIC, 4);
+    buf[4] = BRP_VERSION;
+    buf[5] = bus;
+    buf[6] = 0;
+    buf[7] = 0;
+    put_u32(&buf[8], bus_hz);
+    put_u32(&buf[12], 0);
+    r->len = BRP_HEADER_BYTES;
+}
+
+bool brp_rec_event(brp_rec_t* r, const brp_event_t* e) {
+    if (r->full) {
+        return false;
+    }
+    uint8_t rec[BRP_RECORD_MAX];
+    uint8_t* p = rec;
+    *p++ = (e->type & 0x0f) | (e->nack ? 0x10 : 0);
+    uint32_t delta = e->t_us - r->last_us;
+    while (delta >= 0x80) {
+        *p++ = (delta & 0x7f) | 0x80;
+        delta >>= 7;
+    }
+    *p++ = delta;
+    uint32_t payload = payload_bytes(e->type);
+    if (payload > 0) {
+        *p++ = e->data;
+    }
+    if (payload > 1) {
+        *p++ = e->miso;
+    }
+    uint32_t n = p - rec;
+    if (r->len + n > r->cap) {
+        r->full = true;
+        return false;
+    }
+    memcpy(&r->buf[r->len], rec, n);
+    r->last_us = e->t_us;
+    r->len += n;
+    r->events++;
+    return true;
+}
+
+uint32_t brp_rec_finish(brp_rec_t* r) {
+    if (r->len >= BRP_HEADER_BYTES) {
+        put_u32(&r->buf[12], r->events);
+    }
+    return r->len;
+}
+
+bool brp_reader_init(brp_reader_t* rd, const uint8_t* buf, uint32_t len) {
+    memset(rd, 0, sizeof(*rd));
+    rd->buf = buf;
+    rd->len = len;
+    if (len < BRP_HEADER_BYTES || memcmp(buf, BRP_MAGIC, 4) || buf[4] != BRP_VERSION ||
+        (buf[5] != BRP_BUS_I2C && buf[5] != BRP_BUS_SPI)) {
+        rd->bad = true;
+        return false;
+    }
+    rd->hdr.bus = buf[5];
+    rd->hdr.bus_hz = get_u32(&buf[8]);
+    rd->hdr.events = get_u32(&buf[12]);
+    rd->pos = BRP_HEADER_BYTES;
+    return true;
+}
+
+bool brp_read_event(brp_reader_t* rd, brp_event_t* e) {
+    if (rd->bad) {
+        return false;
+    }
+    if (rd->pos >= rd->len) {
+        // fewer events than the header says: the file was cut short
+        rd->bad = rd->index < rd->hdr.events;
+        return false;
+    }
+    uint8_t b = rd->buf[rd->pos++];
+    e->type = b & 0x0f;
+    e->nack = (b >> 4) & 1;
+    if (e->type < BRP_EV_START || e->type > BRP_EV_XFER) {
+        rd->bad = true;
+        return false;
+    }
+    uint32_t delta = 0;
+    for (uint32_t shift = 0;; shift += 7) {
+        if (rd->pos >= rd->len || shift > 28) {
+            rd->bad = true;
+            return false;
+        }
+        uint8_t v = rd->buf[rd->pos++];
+        delta |= (uint32_t)(v & 0x7f) << shift;
+        if (!(v & 0x80)) {
+            break;
+        }
+    }
+    uint32_t payload = payload_bytes(e->type);
+    if (rd->pos + payload > rd->len) {
+        rd->bad = true;
+        return false;
+    }
+    e->data = payload > 0 ? rd->buf[rd->pos] : 0;
+    e->miso = payload > 1 ? rd->buf[rd->pos + 1] : 0;
+    rd->pos += payload;
+    rd->t_us += delta;
+    e->t_us = rd->t_us;
+    rd->index++;
+    return true;
+}
+
+/* ── I2C replay ────────────────────────────────────────────────── */
+
+static uint64_t scaled_us(uint32_t t_us, uint32_t base_us, uint32_t scale_pct) {
+    return (uint64_t)(t_us - base_us) * scale_pct / 100;
+}
+
+static uint64_t us_to_cycles(const brp_i2c_t* c, uint64_t us) {
+    return us * c->cfg.pio_hz / 1000000;
+}
+
+static uint64_t cycles_to_us_up(const brp_i2c_t* c, uint64_t cycles) {
+    return (cycles * 1000000 + c->cfg.pio_hz - 1) / c->cfg.pio_hz;
+}
+
+static uint32_t delay_words(uint64_t wait) {
+    uint32_t words = 0;
+    while (wait >= BRP_I2C_DELAY_MIN) {
+        uint64_t k = (wait - BRP_I2C_ESCAPE_CYCLES) / BRP_I2C_EXEC_CYCLES;
+        if (k > 64) {
+            k = 64;
+        }
+        words += k + 1;
+        wait -= BRP_I2C_ESCAPE_CYCLES + k * BRP_I2C_EXEC_CYCLES;
+    }
+    return words;
+}
+
+static void delay_emit(brp_i2c_t* c, uint16_t* tx, uint32_t* n, uint64_t wait) {
+    while (wait >= BRP_I2C_DELAY_MIN) {
+        uint32_t k = (wait - BRP_I2C_ESCAPE_CYCLES) / BRP_I2C_EXEC_CYCLES;
+        if (k > 64) {
+            k = 64;
+        }
+        tx[(*n)++] = (k - 1) << 10;
+        for (uint32_t i = 0; i < k; i++) {
+            tx[(*n)++] = c->cfg.delay_inst;
+        }
+        uint32_t cycles = BRP_I2C_ESCAPE_CYCLES + k * BRP_I2C_EXEC_CYCLES;
+        wait -= cycles;
+        c->now += cycles;
+        c->delay_words += k + 1;
+    }
+}
+
+void brp_i2c_init(brp_i2c_t* c, const uint8_t* rec, uint32_t len, const brp_i2c_cfg_t* cfg) {
+    memset(c, 0, sizeof(*c));
+    c->cfg = *cfg;
+    brp_reader_init(&c->rd, rec, len);
+}
+
+// the next event worth sending, a STOP is made up if the recording ends inside a transaction
+static bool i2c_peek(brp_i2c_t* c) {
+    while (!c->have_next) {
+        if (!brp_read_event(&c->rd, &c->next)) {
+            if (!c->in_txn) {
+                return false;
+            }
+            c->next.type = BRP_EV_STOP;
+            c->next.t_us = c->rd.t_us;
+            c->next_index = c->rd.index;
+            c->have_next = true;
+            break;
+        }
+        c->next_index = c->rd.index - 1;
+        if (!c->started) {
+            c->started = true;
+            c->base_us = c->next.t_us;
+        }
+        bool ok;
+        switch (c->next.type) {
+            case BRP_EV_START:
+                ok = true;
+                break;
+            case BRP_EV_STOP:
+            case BRP_EV_DATA:
+                ok = c->in_txn;
+                break;
+            default:
+                ok = false;
+                break;
+        }
+        if (ok) {
+            c->have_next = true;
+        } else {
+            c->skipped++;
+        }
+    }
+    return true;
+}
+
+bool brp_i2c_next(brp_i2c_t* c, uint16_t* tx, uint32_t tx_cap, brp_expect_t* rx, uint32_t rx_cap, brp_block_t* b) {
+    const uint16_t* inst = c->cfg.inst;
+    uint64_t gap = us_to_cycles(c, c->cfg.cpu_gap_us);
+    uint32_t n = 0, nrx = 0;
+    bool open = false;
+    b->start_us = 0;
+
+    while (i2c_peek(c)) {
+        const brp_event_t* e = &c->next;
+        uint16_t elem[5];
+        uint32_t words, cycles;
+        bool data = false;
+        switch (e->type) {
+            case BRP_EV_START:
+                if (c->in_txn) {
+                    elem[0] = 3 << 10;
+                    elem[1] = inst[BRP_SC0_SD1];
+                    elem[2] = inst[BRP_SC1_SD1];
+                    elem[3] = inst[BRP_SC1_SD0];
+                    elem[4] = inst[BRP_SC0_SD0];
+                    words = 5;
+                    cycles = BRP_I2C_RESTART_CYCLES;
+                } else {
+                    elem[0] = 1 << 10;
+                    elem[1] = inst[BRP_SC1_SD0];
+                    elem[2] = inst[BRP_SC0_SD0];
+                    words = 3;
+                    cycles = I2C_SCAN_START_CYCLES;
+                }
+                break;
+            case BRP_EV_STOP:
+                elem[0] = 2 << 10;
+                elem[1] = inst[BRP_SC0_SD0];
+                elem[2] = inst[BRP_SC1_SD0];
+                elem[3] = inst[BRP_SC1_SD1];
+                words = 4;
+                cycles = I2C_SCAN_STOP_CYCLES;
+                break;
+            default: // DATA
+                if (c->expect_address || !c->reading) {
+                    elem[0] = (e->data << 1) | 1;
+                } else {
+                    elem[0] = (0xff << 1) | e->nack;
+                }
+                words = 1;
+                cycles = I2C_SCAN_BYTE_CYCLES;
+                data = true;
+                break;
+        }
+
+        uint64_t end = us_to_cycles(c, scaled_us(e->t_us, c->base_us, c->cfg.scale_pct));
+        uint64_t start = end > cycles ? end - cycles : 0;
+        if (!open) {
+            // the CPU starts the block, on a microsecond
+            uint64_t at = start > c->now ? start : c->now;
+            uint64_t us = cycles_to_us_up(c, at);
+            b->start_us = us;
+            c->now = us_to_cycles(c, us);
+            if (c->now < at) {
+                c->now = at;
+            }
+            open = true;
+        }
+        uint64_t wait = start > c->now ? start - c->now : 0;
+        if (n && wait >= gap) {
+            break; // the CPU waits it out
+        }
+        uint32_t need = delay_words(wait) + words;
+        if (n + need > tx_cap || (data && nrx >= rx_cap)) {
+            c->splits++;
+            break;
+        }
+        delay_emit(c, tx, &n, wait);
+        if (c->cfg.scale_pct && c->now > start) {
+            uint32_t late_us = (c->now - start) * 1000000 / c->cfg.pio_hz;
+            if (late_us > BRP_I2C_LATE_US) {
+                c->late++;
+                if (late_us > c->late_max_us) {
+                    c->late_max_us = late_us;
+                }
+            }
+        }
+        memcpy(&tx[n], elem, words * sizeof(elem[0]));
+        n += words;
+        c->now += cycles;
+
+        switch (e->type) {
+            case BRP_EV_START:
+                c->in_txn = true;
+                c->expect_address = true;
+                break;
+            case BRP_EV_STOP:
+                c->in_txn = false;
+                break;
+            default:
+                if (c->expect_address) {
+                    c->reading = e->data & 1;
+                    c->expect_address = false;
+                }
+                rx[nrx].expect = (e->data << 1) | e->nack;
+                rx[nrx].event = c->next_index;
+                nrx++;
+                break;
+        }
+        c->have_next = false;
+    }
+
+    b->tx_len = n;
+    b->rx_len = nrx;
+    if (!n) {
+        return false;
+    }
+    c->blocks++;
+    return true;
+}
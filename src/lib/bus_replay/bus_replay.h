@@ -0,0 +1,201 @@
+/*
+ * bus_replay.h — Sniffer recordings and timed I2C replay
+ *
+ * Recording format: a 16 byte header, then one record per bus event.
+ *
+ *   header   "BPRC", version, bus (1 I2C, 2 SPI), 2 reserved,
+ *            bus clock in Hz (0 unknown), event count; little endian
+ *   record   type | nack << 4, time since the previous event in us as an
+ *            unsigned LEB128 varint, then the payload: one byte for DATA,
+ *            MOSI and MISO for XFER
+ *
+ * Event times are when the sniffer took the event from its FIFO: START
+ * and STOP when seen, a byte after its ACK bit.
+ *
+ * I2C replay compiles the recording into blocks of hwi2c.pio TX FIFO
+ * words for pio_i2c_dma_block(). Every recorded byte becomes a data word:
+ * written bytes (and addresses) are sent with SDA released for the ACK,
+ * read bytes are clocked with the ACK/NACK the recorded host gave. The RX
+ * word that comes back is compared with the recording, (byte << 1) | nack,
+ * so a missing ACK or a different read value shows up.
+ *
+ * Gaps: the compiler keeps the replay time in PIO cycles (32 per SCL
+ * period, the counts below follow hwi2c.pio) and aims to end each element
+ * when the recording (scaled) says it ended. Short waits are escape words
+ * running a "nop [7]" instruction, 10 PIO cycles each, so they are exact
+ * to one word. A wait of at least cpu_gap_us ends the block instead and
+ * the CPU starts the next one on time, so a long pause costs no buffer.
+ * When the replay bus is slower than the recording the element goes out
+ * late, the lateness is tracked.
+ *
+ * SPI records are part of the format, there is no SPI recorder or replay
+ * yet.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef BUS_REPLAY_H
+#define BUS_REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lib/i2c_scan/i2c_scan.h"
+
+#define BRP_MAGIC "BPRC"
+#define BRP_VERSION 1
+#define BRP_HEADER_BYTES 16
+// longest record: type, 5 byte varint, 2 bytes payload
+#define BRP_RECORD_MAX 8
+// recorder limit, the replay keeps its buffers in the rest of the big buffer
+#define BRP_REC_MAX (96 * 1024)
+
+typedef enum {
+    BRP_BUS_I2C = 1,
+    BRP_BUS_SPI = 2,
+} brp_bus_t;
+
+typedef enum {
+    BRP_EV_START = 1, // I2C START, a repeated START inside a transaction
+    BRP_EV_STOP,
+    BRP_EV_DATA,      // I2C byte and ACK bit
+    BRP_EV_SELECT,    // SPI chip select asserted
+    BRP_EV_DESELECT,
+    BRP_EV_XFER,      // SPI MOSI and MISO byte
+} brp_ev_type_t;
+
+typedef struct {
+    uint8_t type;
+    bool nack;
+    uint8_t data; // I2C byte, SPI MOSI
+    uint8_t miso;
+    uint32_t t_us; // since the recording started, wraps after 71 minutes
+} brp_event_t;
+
+typedef struct {
+    uint8_t bus;
+    uint32_t bus_hz;
+    uint32_t events;
+} brp_header_t;
+
+/* ── Recording ─────────────────────────────────────────────────── */
+
+typedef struct {
+    uint8_t* buf;
+    uint32_t cap, len;
+    uint32_t last_us;
+    uint32_t events;
+    bool full; // an event did not fit, recording stopped
+} brp_rec_t;
+
+/**
+ * Start a recording in buf, the header is written now and completed by
+ * brp_rec_finish(). Times are counted from t0_us.
+ */
+void brp_rec_init(brp_rec_t* r, uint8_t* buf, uint32_t cap, brp_bus_t bus, uint32_t bus_hz, uint32_t t0_us);
+
+/**
+ * Append an event.
+ * @return false (and full set) if it did not fit
+ */
+bool brp_rec_event(brp_rec_t* r, const brp_event_t* e);
+
+/**
+ * Fill in the event count.
+ * @return bytes to save
+ */
+uint32_t brp_rec_finish(brp_rec_t* r);
+
+typedef struct {
+    const uint8_t* buf;
+    uint32_t len, pos;
+    uint32_t t_us;
+    uint32_t index; // of the next event
+    bool bad;       // truncated or unknown record
+    brp_header_t hdr;
+} brp_reader_t;
+
+/**
+ * Check the header.
+ * @return false if it is not a recording
+ */
+bool brp_reader_init(brp_reader_t* rd, const uint8_t* buf, uint32_t len);
+
+/**
+ * Next event, false at the end or on a bad record (bad set).
+ */
+bool brp_read_event(brp_reader_t* rd, brp_event_t* e);
+
+/* ── I2C replay ────────────────────────────────────────────────── */
+
+// PIO cycles, START, STOP and data words as in lib/i2c_scan
+#define BRP_I2C_ESCAPE_CYCLES 4 // per escape word
+#define BRP_I2C_EXEC_CYCLES 10  // per instruction run by an escape, [7] delay included
+#define BRP_I2C_RESTART_CYCLES (BRP_I2C_ESCAPE_CYCLES + 4 * BRP_I2C_EXEC_CYCLES)
+// an escape runs 2 to 64 instructions
+#define BRP_I2C_DELAY_MIN (BRP_I2C_ESCAPE_CYCLES + 2 * BRP_I2C_EXEC_CYCLES)
+// an element and one escape of delay always fit
+#define BRP_I2C_TX_MIN 80
+// recorded times are whole microseconds and blocks start on one, lateness
+// up to this is rounding
+#define BRP_I2C_LATE_US 2
+
+// set_scl_sda instruction table order in hwi2c.pio
+enum {
+    BRP_SC0_SD0 = 0,
+    BRP_SC0_SD1,
+    BRP_SC1_SD0,
+    BRP_SC1_SD1
+};
+
+typedef struct {
+    uint32_t pio_hz;      // PIO clock, 32 x SCL
+    uint32_t scale_pct;   // recorded times x scale / 100, 0 = back to back
+    uint32_t cpu_gap_us;  // waits this long or more are left to the CPU
+    const uint16_t* inst; // the four set_scl_sda instructions
+    uint16_t delay_inst;  // nop [7]
+} brp_i2c_cfg_t;
+
+typedef struct {
+    uint16_t expect; // RX word as recorded, (byte << 1) | nack
+    uint32_t event;  // index in the recording
+} brp_expect_t;
+
+typedef struct {
+    uint32_t start_us; // when to start the block, from the start of the replay
+    uint32_t tx_len;
+    uint32_t rx_len;
+} brp_block_t;
+
+typedef struct {
+    brp_reader_t rd;
+    brp_i2c_cfg_t cfg;
+    brp_event_t next;    // read but not compiled yet
+    uint32_t next_index;
+    bool have_next;
+    bool started;
+    uint32_t base_us;    // time of the first event
+    bool in_txn;
+    bool reading;        // the address byte had R/W set
+    bool expect_address;
+    uint64_t now;        // PIO cycles, end of the compiled stream
+    // totals
+    uint32_t blocks;
+    uint32_t splits;     // blocks ended by a full buffer, not a gap
+    uint32_t delay_words;
+    uint32_t skipped;    // bytes or STOPs outside a transaction
+    uint32_t late;       // elements that could not be on time
+    uint32_t late_max_us;
+} brp_i2c_t;
+
+void brp_i2c_init(brp_i2c_t* c, const uint8_t* rec, uint32_t len, const brp_i2c_cfg_t* cfg);
+
+/**
+ * Compile the next block.
+ * @param tx_cap  at least BRP_I2C_TX_MIN
+ * @return false when the recording is done
+ */
+bool brp_i2c_next(brp_i2c_t* c, uint16_t* tx, uint32_t tx_cap, brp_expect_t* rx, uint32_t rx_cap, brp_block_t* b);
+
+#endif // BUS_REPLAY_H
@@ -0,0 +1,328 @@
+/*
+ * cell_fb.c — Double buffered terminal cell grid with minimal VT100 output
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <string.h>
+#include "cell_fb.h"
+
+// front cells that never match a drawn cell, U+FFFF is a noncharacter
+#define CELL_FB_INVALID 0xffff
+// longest run of unchanged cells rewritten instead of moving the cursor
+#define CELL_FB_REWRITE_MAX 8
+
+static const uint8_t cell_fb_style_sgr[4] = { 1, 2, 4, 7 };
+
+/* ── Output ───────────────────────────────────────────────────── */
+
+static void fb_flush(cell_fb_t* fb) {
+    if (fb->out_len) {
+        fb->write(fb->ctx, fb->out, fb->out_len);
+        fb->bytes += fb->out_len;
+        fb->out_len = 0;
+    }
+}
+
+static void fb_emit(cell_fb_t* fb, const char* s, size_t len) {
+    if (fb->out_len + len > fb->out_size) {
+        fb_flush(fb);
+    }
+    memcpy(&fb->out[fb->out_len], s, len);
+    fb->out_len += len;
+}
+
+static size_t fb_uint(char* out, uint32_t v) {
+    char tmp[10];
+    size_t n = 0, len = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n) {
+        out[len++] = tmp[--n];
+    }
+    return len;
+}
+
+static size_t fb_digits(uint32_t v) {
+    size_t n = 1;
+    while (v >= 10) {
+        v /= 10;
+        n++;
+    }
+    return n;
+}
+
+size_t cell_fb_utf8(uint16_t ch, char* out) {
+    if (ch < 0x80) {
+        out[0] = (char)ch;
+        return 1;
+    }
+    if (ch < 0x800) {
+        out[0] = (char)(0xc0 | (ch >> 6));
+        out[1] = (char)(0x80 | (ch & 0x3f));
+        return 2;
+    }
+    out[0] = (char)(0xe0 | (ch >> 12));
+    out[1] = (char)(0x80 | ((ch >> 6) & 0x3f));
+    out[2] = (char)(0x80 | (ch & 0x3f));
+    return 3;
+}
+
+static size_t fb_glyph_len(uint16_t ch) {
+    return (ch < 0x80) ? 1 : (ch < 0x800) ? 2 : 3;
+}
+
+/* ── Grid ─────────────────────────────────────────────────────── */
+
+void cell_fb_init(cell_fb_t* fb,
+                  cell_t* cells,
+                  uint16_t rows,
+                  uint16_t cols,
+                  char* out,
+                  size_t out_size,
+                  cell_fb_write_fn write,
+                  void* ctx) {
+    memset(fb, 0, sizeof(*fb));
+    fb->front = cells;
+    fb->back = &cells[rows * cols];
+    fb->rows = rows;
+    fb->cols = cols;
+    fb->top = 1;
+    fb->left = 1;
+    fb->color = true;
+    fb->out = out;
+    fb->out_size = out_size;
+    fb->write = write;
+    fb->ctx = ctx;
+    cell_fb_clear(fb, CELL_DEFAULT, 0);
+    cell_fb_invalidate(fb);
+}
+
+void cell_fb_origin(cell_fb_t* fb, uint16_t top, uint16_t left) {
+    fb->top = top;
+    fb->left = left;
+    cell_fb_invalidate(fb);
+}
+
+void cell_fb_clear(cell_fb_t* fb, uint8_t color, uint8_t style) {
+    cell_t blank = { ' ', color, style };
+    for (uint32_t i = 0; i < (uint32_t)fb->rows * fb->cols; i++) {
+        fb->back[i] = blank;
+    }
+}
+
+void cell_fb_put(cell_fb_t* fb, int row, int col, uint16_t ch, uint8_t color, uint8_t style) {
+    if (row < 0 || col < 0 || row >= fb->rows || col >= fb->cols) {
+        return;
+    }
+    cell_t* c = cell_fb_at(fb, row, col);
+    c->ch = ch;
+    c->color = color;
+    c->style = style;
+}
+
+int cell_fb_text(cell_fb_t* fb, int row, int col, const char* text, uint8_t color, uint8_t style) {
+    const uint8_t* p = (const uint8_t*)text;
+    int n = 0;
+    while (*p && col + n < fb->cols) {
+        uint16_t ch = '?';
+        if (p[0] < 0x80) {
+            ch = p[0];
+            p++;
+        } else if ((p[0] & 0xe0) == 0xc0 && (p[1] & 0xc0) == 0x80) {
+            ch = (uint16_t)(((p[0] & 0x1f) << 6) | (p[1] & 0x3f));
+            p += 2;
+        } else if ((p[0] & 0xf0) == 0xe0 && (p[1] & 0xc0) == 0x80 && (p[2] & 0xc0) == 0x80) {
+            ch = (uint16_t)(((p[0] & 0x0f) << 12) | ((p[1] & 0x3f) << 6) | (p[2] & 0x3f));
+            p += 3;
+        } else {
+            // 4 byte sequences and broken UTF-8, skip to the next lead byte
+            p++;
+            while ((*p & 0xc0) == 0x80) {
+                p++;
+            }
+        }
+        cell_fb_put(fb, row, col + n, ch, color, style);
+        n++;
+    }
+    return n;
+}
+
+void cell_fb_invalidate(cell_fb_t* fb) {
+    for (uint32_t i = 0; i < (uint32_t)fb->rows * fb->cols; i++) {
+        fb->front[i].ch = CELL_FB_INVALID;
+    }
+}
+
+void cell_fb_touch(cell_fb_t* fb, int row, int col, int len) {
+    if (row < 0 || row >= fb->rows) {
+        return;
+    }
+    for (int c = (col < 0) ? 0 : col; c < col + len && c < fb->cols; c++) {
+        fb->front[row * fb->cols + c].ch = CELL_FB_INVALID;
+    }
+}
+
+/* ── Present ──────────────────────────────────────────────────── */
+
+static bool fb_attr_same(const cell_fb_t* fb, const cell_t* c) {
+    return !fb->color || (fb->cur_attr_known && c->color == fb->cur_color && c->style == fb->cur_style);
+}
+
+static bool fb_changed(const cell_fb_t* fb, const cell_t* front, const cell_t* back) {
+    if (front->ch != back->ch) {
+        return true;
+    }
+    return fb->color && (front->color != back->color || front->style != back->style);
+}
+
+static void fb_sgr(cell_fb_t* fb, uint8_t color, uint8_t style) {
+    char buf[CELL_FB_EMIT_MAX];
+    size_t n = 2;
+    uint8_t base_color = fb->cur_color, base_style = fb->cur_style;
+
+    buf[0] = 0x1b;
+    buf[1] = '[';
+    // switching anything off takes a reset, then only what is on
+    if (!fb->cur_attr_known || (base_style & ~style) || (CELL_FG(color) == 0 && CELL_FG(base_color) != 0) ||
+        (CELL_BG(color) == 0 && CELL_BG(base_color) != 0)) {
+        buf[n++] = '0';
+        base_color = 0;
+        base_style = 0;
+    }
+    for (uint32_t i = 0; i < sizeof(cell_fb_style_sgr); i++) {
+        if ((style & ~base_style) & (1u << i)) {
+            if (n > 2) {
+                buf[n++] = ';';
+            }
+            buf[n++] = (char)('0' + cell_fb_style_sgr[i]);
+        }
+    }
+    if (CELL_FG(color) != CELL_FG(base_color)) {
+        if (n > 2) {
+            buf[n++] = ';';
+        }
+        n += fb_uint(&buf[n], 29u + CELL_FG(color));
+    }
+    if (CELL_BG(color) != CELL_BG(base_color)) {
+        if (n > 2) {
+            buf[n++] = ';';
+        }
+        n += fb_uint(&buf[n], 39u + CELL_BG(color));
+    }
+    buf[n++] = 'm';
+    fb_emit(fb, buf, n);
+
+    fb->cur_color = color;
+    fb->cur_style = style;
+    fb->cur_attr_known = true;
+}
+
+static void fb_cup(cell_fb_t* fb, int row, int col) {
+    char buf[CELL_FB_EMIT_MAX];
+    size_t n = 2;
+    buf[0] = 0x1b;
+    buf[1] = '[';
+    n += fb_uint(&buf[n], (uint32_t)(fb->top + row));
+    buf[n++] = ';';
+    n += fb_uint(&buf[n], (uint32_t)(fb->left + col));
+    buf[n++] = 'H';
+    fb_emit(fb, buf, n);
+}
+
+static void fb_cuf(cell_fb_t* fb, int count) {
+    char buf[CELL_FB_EMIT_MAX];
+    size_t n = 2;
+    buf[0] = 0x1b;
+    buf[1] = '[';
+    if (count > 1) {
+        n += fb_uint(&buf[n], (uint32_t)count);
+    }
+    buf[n++] = 'C';
+    fb_emit(fb, buf, n);
+}
+
+static void fb_glyph(cell_fb_t* fb, const cell_t* c) {
+    char buf[3];
+    fb_emit(fb, buf, cell_fb_utf8(c->ch, buf));
+}
+
+// put the cursor on row, col the cheapest way
+static void fb_move(cell_fb_t* fb, int row, int col) {
+    if (fb->cur_row == row && fb->cur_col == col) {
+        return;
+    }
+    size_t cup = 4 + fb_digits(fb->top + row) + fb_digits(fb->left + col);
+    if (fb->cur_row == row && fb->cur_col >= 0 && fb->cur_col < col) {
+        int gap = col - fb->cur_col;
+        size_t cuf = (gap > 1) ? 3 + fb_digits((uint32_t)gap) : 3;
+
+        // the cells in between already show the right thing, writing them again
+        // is often shorter than an escape sequence
+        size_t rewrite = 0;
+        const cell_t* back = &fb->back[row * fb->cols + fb->cur_col];
+        if (gap <= CELL_FB_REWRITE_MAX) {
+            for (int i = 0; i < gap; i++) {
+                if (!fb_attr_same(fb, &back[i])) {
+                    rewrite = SIZE_MAX;
+                    break;
+                }
+                rewrite += fb_glyph_len(back[i].ch);
+            }
+        } else {
+            rewrite = SIZE_MAX;
+        }
+
+        if (rewrite <= cuf && rewrite <= cup) {
+            for (int i = 0; i < gap; i++) {
+                fb_glyph(fb, &back[i]);
+            }
+        } else if (cuf <= cup) {
+            fb_cuf(fb, gap);
+        } else {
+            fb_cup(fb, row, col);
+        }
+    } else {
+        fb_cup(fb, row, col);
+    }
+    fb->cur_row = row;
+    fb->cur_col = col;
+}
+
+size_t cell_fb_present(cell_fb_t* fb) {
+    fb->bytes = 0;
+    fb->out_len = 0;
+    // anything may have been printed since the last frame, with the colour reset after it
+    fb->cur_row = -1;
+    fb->cur_col = -1;
+    fb->cur_color = CELL_DEFAULT;
+    fb->cur_style = 0;
+    fb->cur_attr_known = true;
+
+    for (int r = 0; r < fb->rows; r++) {
+        cell_t* front = &fb->front[r * fb->cols];
+        cell_t* back = &fb->back[r * fb->cols];
+        for (int c = 0; c < fb->cols; c++) {
+            if (!fb_changed(fb, &front[c], &back[c])) {
+                continue;
+            }
+            fb_move(fb, r, c);
+            if (fb->color && !fb_attr_same(fb, &back[c])) {
+                fb_sgr(fb, back[c].color, back[c].style);
+            }
+            fb_glyph(fb, &back[c]);
+            front[c] = back[c];
+            // past the last column the terminal may be waiting to wrap
+            fb->cur_col = (c + 1 < fb->cols) ? c + 1 : -1;
+        }
+    }
+
+    if (fb->color && fb->cur_attr_known && (fb->cur_color || fb->cur_style)) {
+        fb_emit(fb, "\x1b[0m", 4);
+    }
+    fb_flush(fb);
+    fb->cur_row = -1;
+    return fb->bytes;
+}
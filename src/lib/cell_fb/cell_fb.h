@@ -0,0 +1,150 @@
+/*
+ * cell_fb.h — Double buffered terminal cell grid with minimal VT100 output
+ *
+ * Games draw a whole frame into the back grid, one cell per terminal
+ * column: a glyph (Unicode, BMP) plus colour and style. cell_fb_present()
+ * compares it with the front grid (what the terminal already shows) and
+ * writes only the cells that changed:
+ *
+ *   - the cursor moves by the cheapest of CUP, CUF or simply rewriting a
+ *     short run of unchanged cells that already have the current colour
+ *   - SGR is sent only when the attributes change, and only the changed
+ *     parameters unless something has to be switched off
+ *   - everything goes into one output buffer that is flushed in bulk
+ *
+ * After a present the colour is back to the default and the cursor
+ * position is forgotten, so the caller may printf between frames as long
+ * as it resets the colour after itself. Screen areas overwritten that way
+ * are marked with cell_fb_touch(), a clear screen with cell_fb_invalidate().
+ *
+ * Double width glyphs are not supported, a cell is always one column.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef CELL_FB_H
+#define CELL_FB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// colours, 0 is the terminal default, 1-8 are the ANSI colours 30-37/40-47
+#define CELL_DEFAULT 0
+#define CELL_BLACK 1
+#define CELL_RED 2
+#define CELL_GREEN 3
+#define CELL_YELLOW 4
+#define CELL_BLUE 5
+#define CELL_MAGENTA 6
+#define CELL_CYAN 7
+#define CELL_WHITE 8
+#define CELL_COLOR(fg, bg) ((uint8_t)((fg) | ((bg) << 4)))
+#define CELL_FG(color) ((color) & 0x0f)
+#define CELL_BG(color) ((color) >> 4)
+
+// styles, may be combined
+#define CELL_BOLD (1u << 0)
+#define CELL_DIM (1u << 1)
+#define CELL_UNDERLINE (1u << 2)
+#define CELL_REVERSE (1u << 3)
+
+// longest single emit: CUP with 5 digit row and column, or a full SGR
+#define CELL_FB_EMIT_MAX 32
+
+typedef struct {
+    uint16_t ch;
+    uint8_t color;
+    uint8_t style;
+} cell_t;
+
+// takes len bytes of terminal output
+typedef void (*cell_fb_write_fn)(void* ctx, const char* buf, size_t len);
+
+typedef struct {
+    cell_t* front; // what the terminal shows
+    cell_t* back;  // the frame being drawn
+    uint16_t rows;
+    uint16_t cols;
+    uint16_t top;  // screen row of cell 0,0 (1-based)
+    uint16_t left; // screen column of cell 0,0 (1-based)
+    bool color;    // false: glyphs only, attributes are never sent
+
+    char* out;
+    size_t out_size;
+    size_t out_len;
+    cell_fb_write_fn write;
+    void* ctx;
+
+    // terminal state while presenting
+    int32_t cur_row; // -1 when unknown
+    int32_t cur_col;
+    uint8_t cur_color;
+    uint8_t cur_style;
+    bool cur_attr_known;
+    size_t bytes; // written by this present
+} cell_fb_t;
+
+/**
+ * cells holds the front and back grids, 2 * rows * cols cells.
+ * out is the bulk output buffer, at least CELL_FB_EMIT_MAX bytes.
+ * The first present draws every cell.
+ */
+void cell_fb_init(cell_fb_t* fb,
+                  cell_t* cells,
+                  uint16_t rows,
+                  uint16_t cols,
+                  char* out,
+                  size_t out_size,
+                  cell_fb_write_fn write,
+                  void* ctx);
+
+/**
+ * Move the grid on screen (1-based), the next present redraws it.
+ */
+void cell_fb_origin(cell_fb_t* fb, uint16_t top, uint16_t left);
+
+/**
+ * Fill the back grid with spaces.
+ */
+void cell_fb_clear(cell_fb_t* fb, uint8_t color, uint8_t style);
+
+/**
+ * One cell of the back grid, 0-based, ignored outside the grid.
+ */
+void cell_fb_put(cell_fb_t* fb, int row, int col, uint16_t ch, uint8_t color, uint8_t style);
+
+/**
+ * UTF-8 text from row, col, clipped at the right edge.
+ * @return columns written
+ */
+int cell_fb_text(cell_fb_t* fb, int row, int col, const char* text, uint8_t color, uint8_t style);
+
+static inline cell_t* cell_fb_at(cell_fb_t* fb, int row, int col) {
+    return &fb->back[row * fb->cols + col];
+}
+
+/**
+ * The screen was cleared or overwritten, redraw everything next present.
+ */
+void cell_fb_invalidate(cell_fb_t* fb);
+
+/**
+ * len cells from row, col were overwritten outside the grid's control.
+ */
+void cell_fb_touch(cell_fb_t* fb, int row, int col, int len);
+
+/**
+ * Send the changed cells and flush the output buffer.
+ * @return bytes written
+ */
+size_t cell_fb_present(cell_fb_t* fb);
+
+/**
+ * ch as UTF-8, 1 to 3 bytes.
+ */
+size_t cell_fb_utf8(uint16_t ch, char* out);
+
+#endif // CELL_FB_H
@@ -0,0 +1,295 @@
+/*
+ * ch32v_dm.c — CH32V003 debug module sequencing: memory blocks and flash pages
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <string.h>
+#include "ch32v_dm.h"
+#include "lib/picorvd/debug_defines.h"
+
+// abstract command: access register x<n>, 32 bits
+#define CVDM_REG_S1 9
+#define CVDM_REG_A0 10
+#define CVDM_REG_A1 11
+#define CVDM_REG_A2 12
+#define CVDM_CMD_REG(n) ((2u << 20) | AC_ACCESS_REGISTER_TRANSFER | (0x1000u + (n)))
+#define CVDM_CMD_WRITE(n) (CVDM_CMD_REG(n) | AC_ACCESS_REGISTER_WRITE)
+#define CVDM_CMD_READ(n) CVDM_CMD_REG(n)
+#define CVDM_CMD_EXEC AC_ACCESS_REGISTER_POSTEXEC
+
+/* ── Programs ──────────────────────────────────────────────────── */
+
+enum {
+    CVDM_PROG_NONE = 0,
+    CVDM_PROG_PEEK,     // c.lw s1,0(a0)
+    CVDM_PROG_STORE,    // c.sw s1,0(a0); c.addi a0,4
+    CVDM_PROG_LOAD,     // c.lw s1,0(a0); c.addi a0,4
+    CVDM_PROG_FLASH,    // c.sw s1,0(a0); c.sw a2,0(a1); c.addi a0,4
+    CVDM_PROG_COUNT
+};
+
+// RV32EC, two instructions per word, low half first, each ends with c.ebreak (0x9002)
+static const uint32_t cvdm_progs[CVDM_PROG_COUNT][2] = {
+    [CVDM_PROG_PEEK] = { 0x90024104u, 0x90029002u },
+    [CVDM_PROG_STORE] = { 0x0511C104u, 0x00019002u },
+    [CVDM_PROG_LOAD] = { 0x05114104u, 0x00019002u },
+    [CVDM_PROG_FLASH] = { 0xC190C104u, 0x90020511u },
+};
+
+/* ── Link ──────────────────────────────────────────────────────── */
+
+static uint32_t xget(cvdm_t* d, uint32_t addr) {
+    d->transfers++;
+    return d->get(addr);
+}
+
+static void xput(cvdm_t* d, uint32_t addr, uint32_t data) {
+    d->transfers++;
+    d->put(addr, data);
+}
+
+static bool fail(cvdm_t* d, cvdm_err_t err) {
+    if (d->error == CVDM_OK) {
+        d->error = err;
+    }
+    return false;
+}
+
+static void load_prog(cvdm_t* d, uint32_t prog) {
+    if (d->prog == prog) {
+        return;
+    }
+    xput(d, DM_PROGBUF0, cvdm_progs[prog][0]);
+    xput(d, DM_PROGBUF0 + 1, cvdm_progs[prog][1]);
+    d->prog = prog;
+}
+
+static void set_reg(cvdm_t* d, uint32_t reg, uint32_t value, uint32_t exec) {
+    xput(d, DM_DATA0, value);
+    xput(d, DM_COMMAND, CVDM_CMD_WRITE(reg) | exec);
+}
+
+// end of a sequence: any command error since the last check
+static bool check_cmd(cvdm_t* d) {
+    uint32_t cs = xget(d, DM_ABSTRACTCS);
+    if (cs & (DM_ABSTRACTCS_CMDERR | DM_ABSTRACTCS_BUSY)) {
+        d->cmderr = (cs & DM_ABSTRACTCS_CMDERR) >> 8;
+        xput(d, DM_ABSTRACTCS, DM_ABSTRACTCS_CMDERR); // write 1 to clear
+        return fail(d, CVDM_ERR_CMD);
+    }
+    return true;
+}
+
+void cvdm_init(cvdm_t* d, cvdm_get_t get, cvdm_put_t put) {
+    memset(d, 0, sizeof(*d));
+    d->get = get;
+    d->put = put;
+}
+
+void cvdm_sync(cvdm_t* d) {
+    d->prog = CVDM_PROG_NONE;
+    d->halted = false;
+    d->unlocked = false;
+}
+
+/* ── Core ──────────────────────────────────────────────────────── */
+
+bool cvdm_halt(cvdm_t* d) {
+    xput(d, DM_DMCONTROL, DM_DMCONTROL_HALTREQ | DM_DMCONTROL_DMACTIVE);
+    for (uint32_t i = 0; i < CVDM_HALT_POLLS; i++) {
+        if (xget(d, DM_DMSTATUS) & DM_DMSTATUS_ALLHALTED) {
+            xput(d, DM_DMCONTROL, DM_DMCONTROL_DMACTIVE);
+            d->halted = true;
+            return true;
+        }
+    }
+    return fail(d, CVDM_ERR_HALT);
+}
+
+bool cvdm_resume(cvdm_t* d) {
+    bool ok = true;
+    if (d->unlocked) {
+        ok = cvdm_flash_lock(d);
+    }
+    xput(d, DM_DMCONTROL, DM_DMCONTROL_RESUMEREQ | DM_DMCONTROL_DMACTIVE);
+    d->halted = false;
+    return ok;
+}
+
+/* ── Memory ────────────────────────────────────────────────────── */
+
+bool cvdm_poke(cvdm_t* d, uint32_t addr, uint32_t value) {
+    load_prog(d, CVDM_PROG_STORE);
+    set_reg(d, CVDM_REG_A0, addr, 0);
+    set_reg(d, CVDM_REG_S1, value, CVDM_CMD_EXEC);
+    return d->error == CVDM_OK;
+}
+
+bool cvdm_peek(cvdm_t* d, uint32_t addr, uint32_t* value) {
+    load_prog(d, CVDM_PROG_PEEK);
+    set_reg(d, CVDM_REG_A0, addr, CVDM_CMD_EXEC);
+    xput(d, DM_COMMAND, CVDM_CMD_READ(CVDM_REG_S1));
+    *value = xget(d, DM_DATA0);
+    return check_cmd(d);
+}
+
+bool cvdm_write(cvdm_t* d, uint32_t addr, const uint32_t* words, uint32_t count) {
+    if (!count) {
+        return true;
+    }
+    load_prog(d, CVDM_PROG_STORE);
+    set_reg(d, CVDM_REG_A0, addr, 0);
+    set_reg(d, CVDM_REG_S1, words[0], CVDM_CMD_EXEC);
+    if (count > 1) {
+        // every DATA0 write now stores and steps a0
+        xput(d, DM_ABSTRACTAUTO, 1);
+        for (uint32_t i = 1; i < count; i++) {
+            xput(d, DM_DATA0, words[i]);
+        }
+        xput(d, DM_ABSTRACTAUTO, 0);
+    }
+    return check_cmd(d);
+}
+
+bool cvdm_read(cvdm_t* d, uint32_t addr, uint32_t* words, uint32_t count) {
+    if (count < 2) {
+        return count ? cvdm_peek(d, addr, words) : true;
+    }
+    // s1 runs one word ahead of DATA0, so exactly count words are loaded
+    load_prog(d, CVDM_PROG_LOAD);
+    set_reg(d, CVDM_REG_A0, addr, CVDM_CMD_EXEC);
+    xput(d, DM_COMMAND, CVDM_CMD_READ(CVDM_REG_S1) | CVDM_CMD_EXEC);
+    if (count > 2) {
+        // every DATA0 read now moves s1 to DATA0 and loads the next word
+        xput(d, DM_ABSTRACTAUTO, 1);
+        for (uint32_t i = 0; i < count - 2; i++) {
+            words[i] = xget(d, DM_DATA0);
+        }
+        xput(d, DM_ABSTRACTAUTO, 0);
+    }
+    words[count - 2] = xget(d, DM_DATA0);
+    xput(d, DM_COMMAND, CVDM_CMD_READ(CVDM_REG_S1));
+    words[count - 1] = xget(d, DM_DATA0);
+    return check_cmd(d);
+}
+
+/* ── Flash ─────────────────────────────────────────────────────── */
+
+// poll STATR: the first load runs with the a0 write, then each read re-runs it
+static bool flash_wait(cvdm_t* d) {
+    load_prog(d, CVDM_PROG_PEEK);
+    set_reg(d, CVDM_REG_A0, CVDM_FLASH_STATR, CVDM_CMD_EXEC);
+    for (uint32_t i = 0; i < CVDM_BUSY_POLLS; i++) {
+        xput(d, DM_COMMAND, CVDM_CMD_READ(CVDM_REG_S1) | CVDM_CMD_EXEC);
+        uint32_t statr = xget(d, DM_DATA0);
+        d->polls++;
+        if (statr & CVDM_STATR_BSY) {
+            continue;
+        }
+        if (!check_cmd(d)) {
+            return false;
+        }
+        if (statr & CVDM_STATR_WRPRTERR) {
+            cvdm_poke(d, CVDM_FLASH_STATR, CVDM_STATR_WRPRTERR);
+            return fail(d, CVDM_ERR_WRPRT);
+        }
+        return true;
+    }
+    return fail(d, CVDM_ERR_BUSY);
+}
+
+bool cvdm_flash_unlock(cvdm_t* d) {
+    if (d->unlocked) {
+        return true;
+    }
+    if (!d->halted && !cvdm_halt(d)) {
+        return false;
+    }
+    cvdm_poke(d, CVDM_FLASH_KEYR, CVDM_FLASH_KEY1);
+    cvdm_poke(d, CVDM_FLASH_KEYR, CVDM_FLASH_KEY2);
+    cvdm_poke(d, CVDM_FLASH_MODEKEYR, CVDM_FLASH_KEY1);
+    cvdm_poke(d, CVDM_FLASH_MODEKEYR, CVDM_FLASH_KEY2);
+    uint32_t ctlr;
+    if (!cvdm_peek(d, CVDM_FLASH_CTLR, &ctlr)) {
+        return false;
+    }
+    if (ctlr & (CVDM_CTLR_LOCK | CVDM_CTLR_FLOCK)) {
+        return fail(d, CVDM_ERR_LOCKED);
+    }
+    d->unlocked = true;
+    return true;
+}
+
+bool cvdm_flash_lock(cvdm_t* d) {
+    cvdm_poke(d, CVDM_FLASH_CTLR, CVDM_CTLR_LOCK | CVDM_CTLR_FLOCK);
+    d->unlocked = false;
+    return check_cmd(d);
+}
+
+bool cvdm_flash_page(cvdm_t* d, uint32_t addr, const uint32_t* words, bool verify) {
+    if (addr & (CVDM_FLASH_PAGE - 1)) {
+        return fail(d, CVDM_ERR_ALIGN);
+    }
+    if (!cvdm_flash_unlock(d)) {
+        return false;
+    }
+
+    // fast page erase
+    cvdm_poke(d, CVDM_FLASH_CTLR, CVDM_CTLR_FTER);
+    cvdm_poke(d, CVDM_FLASH_ADDR, addr);
+    cvdm_poke(d, CVDM_FLASH_CTLR, CVDM_CTLR_FTER | CVDM_CTLR_STRT);
+    if (!flash_wait(d)) {
+        return false;
+    }
+
+    // empty the page buffer
+    cvdm_poke(d, CVDM_FLASH_CTLR, CVDM_CTLR_FTPG);
+    cvdm_poke(d, CVDM_FLASH_CTLR, CVDM_CTLR_FTPG | CVDM_CTLR_BUFRST);
+    if (!flash_wait(d)) {
+        return false;
+    }
+
+    // stream the words into the buffer, each store followed by BUFLOAD
+    load_prog(d, CVDM_PROG_FLASH);
+    set_reg(d, CVDM_REG_A1, CVDM_FLASH_CTLR, 0);
+    set_reg(d, CVDM_REG_A2, CVDM_CTLR_FTPG | CVDM_CTLR_BUFLOAD, 0);
+    set_reg(d, CVDM_REG_A0, addr, 0);
+    set_reg(d, CVDM_REG_S1, words[0], CVDM_CMD_EXEC);
+    xput(d, DM_ABSTRACTAUTO, 1);
+    for (uint32_t i = 1; i < CVDM_PAGE_WORDS; i++) {
+        xput(d, DM_DATA0, words[i]);
+    }
+    xput(d, DM_ABSTRACTAUTO, 0);
+
+    // program the page
+    cvdm_poke(d, CVDM_FLASH_ADDR, addr);
+    cvdm_poke(d, CVDM_FLASH_CTLR, CVDM_CTLR_FTPG | CVDM_CTLR_STRT);
+    if (!flash_wait(d)) {
+        return false;
+    }
+
+    if (verify) {
+        uint32_t back[CVDM_PAGE_WORDS];
+        if (!cvdm_read(d, addr, back, CVDM_PAGE_WORDS)) {
+            return false;
+        }
+        if (memcmp(back, words, sizeof(back))) {
+            return fail(d, CVDM_ERR_VERIFY);
+        }
+    }
+    return true;
+}
+
+bool cvdm_flash_write(cvdm_t* d, uint32_t addr, const uint8_t* data, uint32_t len, bool verify) {
+    uint32_t words[CVDM_PAGE_WORDS];
+    for (uint32_t off = 0; off < len; off += CVDM_FLASH_PAGE) {
+        uint32_t n = len - off < CVDM_FLASH_PAGE ? len - off : CVDM_FLASH_PAGE;
+        memset(words, 0xff, sizeof(words));
+        memcpy(words, data + off, n); // little endian, like the target
+        if (!cvdm_flash_page(d, addr + off, words, verify)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,142 @@
+/*
+ * ch32v_dm.h — CH32V003 debug module sequencing: memory blocks and flash pages
+ *
+ * The CH32V003 debug module is reached one 32 bit register at a time over
+ * SWIO. Memory is only reachable through the program buffer: a register
+ * is loaded with an abstract command and a short program stored in the
+ * progbuf moves it to or from memory. Done word by word that is 4 to 6
+ * transfers per word.
+ *
+ * Blocks use autoexec instead. The command "write DATA0 to s1, then run
+ * the progbuf" is issued once and ABSTRACTAUTO re-runs it on every DATA0
+ * access, so each further word is one transfer:
+ *
+ *   progbuf  c.sw  s1, 0(a0)      store the word
+ *            c.sw  a2, 0(a1)      FLASH_CTLR = FTPG | BUFLOAD (flash only)
+ *            c.addi a0, 4
+ *            c.ebreak
+ *
+ * A flash page (64 bytes) is erased with a fast page erase, the 16 words
+ * are streamed into the flash buffer like this and the page is started.
+ * BUFLOAD takes a few us, far less than one SWIO transfer, so the buffer
+ * is not polled between words. FLASH_STATR is polled after erase and
+ * program with the read command re-run by hand, 2 transfers per poll.
+ *
+ * The progbuf contents are cached, a program is only sent when it
+ * changes. ABSTRACTCS is checked once per sequence: a command finishes in
+ * a few target cycles, before the next transfer arrives, and cmderr is
+ * sticky.
+ *
+ * The link is two callbacks so the sequencing can run against the PIO
+ * SWIO transport (lib/picorvd) on the Bus Pirate or a simulated debug
+ * module on the host.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef CH32V_DM_H
+#define CH32V_DM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CVDM_FLASH_BASE 0x08000000u
+#define CVDM_FLASH_PAGE 64u // bytes, fast page erase/program
+#define CVDM_PAGE_WORDS (CVDM_FLASH_PAGE / 4)
+
+// FLASH peripheral
+#define CVDM_FLASH_KEYR 0x40022004u
+#define CVDM_FLASH_STATR 0x4002200Cu
+#define CVDM_FLASH_CTLR 0x40022010u
+#define CVDM_FLASH_ADDR 0x40022014u
+#define CVDM_FLASH_MODEKEYR 0x40022024u
+
+#define CVDM_FLASH_KEY1 0x45670123u
+#define CVDM_FLASH_KEY2 0xCDEF89ABu
+
+#define CVDM_STATR_BSY (1u << 0)
+#define CVDM_STATR_WRPRTERR (1u << 4)
+#define CVDM_STATR_EOP (1u << 5)
+
+#define CVDM_CTLR_STRT (1u << 6)
+#define CVDM_CTLR_LOCK (1u << 7)
+#define CVDM_CTLR_FLOCK (1u << 15)
+#define CVDM_CTLR_FTPG (1u << 16)
+#define CVDM_CTLR_FTER (1u << 17)
+#define CVDM_CTLR_BUFLOAD (1u << 18)
+#define CVDM_CTLR_BUFRST (1u << 19)
+
+// polls before giving up: halt, and flash busy (2 transfers each, ~100us)
+#define CVDM_HALT_POLLS 100
+#define CVDM_BUSY_POLLS 1000
+
+typedef uint32_t (*cvdm_get_t)(uint32_t addr);
+typedef void (*cvdm_put_t)(uint32_t addr, uint32_t data);
+
+typedef enum {
+    CVDM_OK = 0,
+    CVDM_ERR_HALT,   // the core did not halt
+    CVDM_ERR_CMD,    // abstract command error, see cmderr
+    CVDM_ERR_BUSY,   // flash stayed busy
+    CVDM_ERR_LOCKED, // flash did not unlock
+    CVDM_ERR_WRPRT,  // flash write protected
+    CVDM_ERR_VERIFY, // read back differs
+    CVDM_ERR_ALIGN,  // not a page address
+} cvdm_err_t;
+
+typedef struct {
+    cvdm_get_t get;
+    cvdm_put_t put;
+    uint32_t prog;      // program in the progbuf, 0 if unknown
+    bool halted;
+    bool unlocked;      // flash and fast mode keys written
+    cvdm_err_t error;   // first error, the caller clears it
+    uint32_t cmderr;    // ABSTRACTCS.cmderr of the failed command
+    uint32_t transfers; // SWIO register transfers
+    uint32_t polls;     // flash busy polls
+} cvdm_t;
+
+void cvdm_init(cvdm_t* d, cvdm_get_t get, cvdm_put_t put);
+
+/**
+ * Forget the cached target state after something else used the link.
+ */
+void cvdm_sync(cvdm_t* d);
+
+bool cvdm_halt(cvdm_t* d);
+
+/**
+ * Lock the flash if it was unlocked and let the core run.
+ */
+bool cvdm_resume(cvdm_t* d);
+
+bool cvdm_poke(cvdm_t* d, uint32_t addr, uint32_t value);
+bool cvdm_peek(cvdm_t* d, uint32_t addr, uint32_t* value);
+
+/**
+ * Word blocks through autoexec, one transfer per word after the setup.
+ * The core must be halted.
+ */
+bool cvdm_write(cvdm_t* d, uint32_t addr, const uint32_t* words, uint32_t count);
+bool cvdm_read(cvdm_t* d, uint32_t addr, uint32_t* words, uint32_t count);
+
+/**
+ * Halt the core if needed and write the flash and fast mode keys.
+ */
+bool cvdm_flash_unlock(cvdm_t* d);
+bool cvdm_flash_lock(cvdm_t* d);
+
+/**
+ * Erase and program one 64 byte page, unlocking first if needed.
+ * @param verify  read the page back
+ */
+bool cvdm_flash_page(cvdm_t* d, uint32_t addr, const uint32_t* words, bool verify);
+
+/**
+ * Program an image page by page, the last page padded with 0xff.
+ */
+bool cvdm_flash_write(cvdm_t* d, uint32_t addr, const uint8_t* data, uint32_t len, bool verify);
+
+#endif // CH32V_DM_H
@@ -0,0 +1,122 @@
+/*
+ * edge_stats.c — Running per-pin edge statistics from change records
+ *
+ * See edge_stats.h.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include "edge_stats.h"
+#include <stdio.h>
+#include <string.h>
+#include "lib/la_change/la_change.h"
+
+void edge_stats_init(edge_stats_t* s, uint32_t glitch_ticks) {
+    memset(s, 0, sizeof(*s));
+    s->glitch_ticks = glitch_ticks;
+    edge_stats_reset(s);
+}
+
+void edge_stats_reset(edge_stats_t* s) {
+    for (uint8_t pin = 0; pin < EDGE_STATS_PINS; pin++) {
+        edge_stats_pin_t* p = &s->pin[pin];
+        p->rising = 0;
+        p->falling = 0;
+        p->min_high = UINT32_MAX;
+        p->min_low = UINT32_MAX;
+        p->glitches = 0;
+        p->glitch = false;
+    }
+    s->lost = 0;
+}
+
+void edge_stats_lost(edge_stats_t* s) {
+    s->synced = false;
+    s->lost++;
+    for (uint8_t pin = 0; pin < EDGE_STATS_PINS; pin++) {
+        s->pin[pin].timed = false;
+    }
+}
+
+static void edge_stats_edge(edge_stats_t* s, edge_stats_pin_t* p, bool level) {
+    if (level) {
+        p->rising++;
+    } else {
+        p->falling++;
+    }
+    if (p->timed) {
+        uint64_t width = s->now - p->last_edge;
+        uint32_t w = (width >= UINT32_MAX) ? UINT32_MAX - 1 : (uint32_t)width;
+        // a rising edge ends a low pulse
+        uint32_t* min = level ? &p->min_low : &p->min_high;
+        if (w < *min) {
+            *min = w;
+        }
+        if (w < s->glitch_ticks) {
+            p->glitches++;
+            p->glitch = true;
+        }
+    }
+    p->level = level;
+    p->timed = true;
+    p->last_edge = s->now;
+}
+
+void edge_stats_feed(edge_stats_t* s, const uint32_t* ring, uint32_t ring_len, uint32_t first, uint32_t count) {
+    uint32_t mask = ring_len - 1;
+    for (uint32_t n = 0; n < count; n++) {
+        uint32_t rec = ring[(first + n) & mask];
+        uint8_t state = la_change_record_state(rec);
+        if (!s->synced) {
+            // the delta of the sync record is from a record we never saw
+            s->state = state;
+            s->synced = true;
+            for (uint8_t pin = 0; pin < EDGE_STATS_PINS; pin++) {
+                s->pin[pin].level = (state >> pin) & 1;
+            }
+            continue;
+        }
+        s->now += la_change_record_delta(rec);
+        // unchanged state is an overflow marker, it only moves the time on
+        uint8_t changed = state ^ s->state;
+        for (uint8_t pin = 0; changed; pin++, changed >>= 1) {
+            if (changed & 1) {
+                edge_stats_edge(s, &s->pin[pin], (state >> pin) & 1);
+            }
+        }
+        s->state = state;
+    }
+}
+
+/* ── Formatting ───────────────────────────────────────────────────── */
+
+// up to raw_max as is with units[0], then thousands with units[1..]
+static int edge_stats_fmt_scaled(char* buf, size_t len, uint64_t v, uint64_t raw_max, const char* units) {
+    if (v <= raw_max) {
+        return snprintf(buf, len, "%llu%.1s", (unsigned long long)v, units);
+    }
+    uint32_t u = 1;
+    uint64_t div = 1000;
+    while (v / div >= 1000 && units[u + 1]) {
+        u++;
+        div *= 1000;
+    }
+    uint64_t whole = v / div;
+    if (whole < 10) {
+        return snprintf(buf, len, "%u.%u%c", (unsigned)whole, (unsigned)(v * 10 / div % 10), units[u]);
+    }
+    return snprintf(buf, len, "%llu%c", (unsigned long long)whole, units[u]);
+}
+
+int edge_stats_fmt_count(char* buf, size_t len, uint32_t v) {
+    return edge_stats_fmt_scaled(buf, len, v, 9999, "\0kMG");
+}
+
+int edge_stats_fmt_ticks(char* buf, size_t len, uint64_t ticks, uint32_t tick_hz) {
+    if (!tick_hz) {
+        return snprintf(buf, len, "-");
+    }
+    // up to 2^34 ticks (23 minutes at 12.5MHz) before this overflows
+    uint64_t ns = ticks * 1000000000ull / tick_hz;
+    return edge_stats_fmt_scaled(buf, len, ns, 999, "nums");
+}
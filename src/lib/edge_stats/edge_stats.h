@@ -0,0 +1,93 @@
+/*
+ * edge_stats.h — Running per-pin edge statistics from change records
+ *
+ * The freq_pio PIO program already records every change on IO0-IO7
+ * (lib/la_change format) into a DMA ring with no CPU time spent. The pin
+ * watcher toolbar follows that ring: every ~100ms it feeds the records
+ * written since the last tick to this reducer, so pulses and glitches far
+ * shorter than the refresh are still counted.
+ *
+ * Per pin it keeps rising and falling edge counts, the shortest high and
+ * low pulse, the time of the last edge and a latch for pulses shorter than
+ * the glitch limit. Times are sample ticks (sysclk/10) since the first
+ * record, pulses of one tick are the shortest the sampler can see.
+ *
+ * The first record only gives the pin state. If the reader falls behind
+ * and records are overwritten, edge_stats_lost() drops the timing and the
+ * next record syncs the state again, counts from before are kept.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host
+ * (tests/test_edge_stats.c).
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef EDGE_STATS_H
+#define EDGE_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define EDGE_STATS_PINS 8
+
+typedef struct {
+    uint32_t rising;
+    uint32_t falling;
+    uint32_t min_high;   // shortest high pulse in ticks, UINT32_MAX if none yet
+    uint32_t min_low;
+    uint32_t glitches;   // pulses shorter than the glitch limit
+    bool glitch;         // latched until edge_stats_reset()
+    bool level;
+    bool timed;          // last_edge is valid, the next edge closes a pulse
+    uint64_t last_edge;  // tick of the last edge
+} edge_stats_pin_t;
+
+typedef struct {
+    edge_stats_pin_t pin[EDGE_STATS_PINS];
+    uint64_t now;          // tick of the newest record
+    uint32_t glitch_ticks; // pulses shorter than this are glitches
+    uint32_t lost;         // times records were overwritten before they were read
+    uint8_t state;
+    bool synced;
+} edge_stats_t;
+
+void edge_stats_init(edge_stats_t* s, uint32_t glitch_ticks);
+
+/**
+ * Clear the counts, minimums and glitch latches. The pin state and timing
+ * are kept so a pulse that started before the reset is still measured.
+ */
+void edge_stats_reset(edge_stats_t* s);
+
+/**
+ * Reduce records from a ring buffer, oldest first.
+ * @param ring      record ring buffer
+ * @param ring_len  ring length in records (power of two)
+ * @param first     index of the oldest new record
+ * @param count     new records
+ */
+void edge_stats_feed(edge_stats_t* s, const uint32_t* ring, uint32_t ring_len, uint32_t first, uint32_t count);
+
+/**
+ * Records were lost, resync the pin state on the next record.
+ */
+void edge_stats_lost(edge_stats_t* s);
+
+static inline uint32_t edge_stats_edges(const edge_stats_pin_t* p) {
+    return p->rising + p->falling;
+}
+
+/**
+ * Short counts for toolbars: up to 9999 as is, then 12k, 1.2M, 4.2G.
+ * @return characters written (4 at most)
+ */
+int edge_stats_fmt_count(char* buf, size_t len, uint32_t v);
+
+/**
+ * Short times for toolbars: 80n, 1.2u, 120u, 12m, 1.5s.
+ * @return characters written (4 below 1000s)
+ */
+int edge_stats_fmt_ticks(char* buf, size_t len, uint64_t ticks, uint32_t tick_hz);
+
+#endif // EDGE_STATS_H
@@ -0,0 +1,158 @@
+/*
+ * flash_diff.c — Differential programming plan for NOR flash and EEPROM
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <string.h>
+#include "flash_diff.h"
+
+#define PAGES_PER_SECTOR (FLASH_DIFF_SECTOR_SIZE / FLASH_DIFF_PAGE_SIZE)
+
+static inline void flash_diff_set(uint8_t* map, uint32_t i) {
+    map[i / 8] |= (uint8_t)(1u << (i % 8));
+}
+
+void flash_diff_block_init(flash_diff_block_t* b, uint32_t base) {
+    memset(b, 0, sizeof(*b));
+    b->base = base;
+}
+
+void flash_diff_page(flash_diff_block_t* b, uint32_t page, const uint8_t* old, const uint8_t* data, uint32_t len) {
+    if (page >= FLASH_DIFF_PAGES) {
+        return;
+    }
+    if (len > FLASH_DIFF_PAGE_SIZE) {
+        len = FLASH_DIFF_PAGE_SIZE;
+    }
+    bool changed = false, blank = true, erase = false;
+    for (uint32_t i = 0; i < FLASH_DIFF_PAGE_SIZE; i++) {
+        uint8_t n = (i < len) ? data[i] : 0xff;
+        if (n != old[i]) {
+            changed = true;
+            // programming can only clear bits
+            if ((old[i] & n) != n) {
+                erase = true;
+            }
+        }
+        if (n != 0xff) {
+            blank = false;
+        }
+    }
+    if (changed) {
+        flash_diff_set(b->changed, page);
+    }
+    if (blank) {
+        flash_diff_set(b->blank, page);
+    }
+    if (erase) {
+        b->needs_erase |= (uint16_t)(1u << (page / PAGES_PER_SECTOR));
+    }
+    if (page + 1 > b->pages) {
+        b->pages = page + 1;
+    }
+}
+
+static void flash_diff_add_erase(flash_diff_plan_t* plan, uint32_t address, uint32_t length) {
+    // keep the list in address order, it is short
+    uint8_t i = plan->erase_count++;
+    while (i > 0 && plan->erase[i - 1].address > address) {
+        plan->erase[i] = plan->erase[i - 1];
+        i--;
+    }
+    plan->erase[i].address = address;
+    plan->erase[i].length = length;
+}
+
+bool flash_diff_plan(const flash_diff_block_t* b, uint32_t erase_sizes, flash_diff_plan_t* plan) {
+    static const struct {
+        uint32_t flag;
+        uint32_t sectors;
+    } units[] = {
+        { FLASH_DIFF_ERASE_64K, 16 },
+        { FLASH_DIFF_ERASE_32K, 8 },
+        { FLASH_DIFF_ERASE_4K, 1 },
+    };
+    memset(plan, 0, sizeof(*plan));
+
+    uint32_t sectors = (b->pages + PAGES_PER_SECTOR - 1) / PAGES_PER_SECTOR;
+    uint32_t valid = (sectors >= 16) ? 0xffffu : ((1u << sectors) - 1);
+    uint32_t need = b->needs_erase & valid;
+    uint32_t erased = 0;
+    uint32_t smallest = 0;
+
+    // largest units first, only where every sector under them needs erasing
+    for (uint32_t u = 0; u < sizeof(units) / sizeof(units[0]); u++) {
+        if (!(erase_sizes & units[u].flag)) {
+            continue;
+        }
+        smallest = units[u].sectors;
+        uint32_t unit_mask = (units[u].sectors >= 16) ? 0xffffu : ((1u << units[u].sectors) - 1);
+        for (uint32_t s = 0; s < 16; s += units[u].sectors) {
+            uint32_t m = unit_mask << s;
+            if ((need & m) == m && !(erased & m)) {
+                flash_diff_add_erase(plan, b->base + s * FLASH_DIFF_SECTOR_SIZE, units[u].sectors * FLASH_DIFF_SECTOR_SIZE);
+                erased |= m;
+            }
+        }
+    }
+
+    // chips without 4K erase: round what is left up to the smallest unit
+    uint32_t left = need & ~erased;
+    if (left) {
+        if (!smallest) {
+            return false;
+        }
+        uint32_t unit_mask = (smallest >= 16) ? 0xffffu : ((1u << smallest) - 1);
+        for (uint32_t s = 0; s < 16; s += smallest) {
+            uint32_t m = unit_mask << s;
+            if (!(left & m)) {
+                continue;
+            }
+            // never erase data outside the image
+            if (m & ~valid) {
+                return false;
+            }
+            flash_diff_add_erase(plan, b->base + s * FLASH_DIFF_SECTOR_SIZE, smallest * FLASH_DIFF_SECTOR_SIZE);
+            erased |= m;
+        }
+    }
+    plan->erased_sectors = (uint16_t)erased;
+
+    for (uint32_t p = 0; p < b->pages; p++) {
+        bool program;
+        if (erased & (1u << (p / PAGES_PER_SECTOR))) {
+            program = !flash_diff_bit(b->blank, p);
+        } else {
+            program = flash_diff_bit(b->changed, p);
+        }
+        if (program) {
+            flash_diff_set(plan->program, p);
+            plan->program_pages++;
+        } else if (!flash_diff_page_touched(plan, p)) {
+            plan->skipped_pages++;
+        }
+    }
+    return true;
+}
+
+bool flash_diff_page_touched(const flash_diff_plan_t* plan, uint32_t page) {
+    if (page >= FLASH_DIFF_PAGES) {
+        return false;
+    }
+    return flash_diff_bit(plan->program, page) || (plan->erased_sectors & (1u << (page / PAGES_PER_SECTOR)));
+}
+
+void flash_diff_apply(const flash_diff_block_t* b, const flash_diff_plan_t* plan, uint8_t* chip, const uint8_t* image) {
+    for (uint32_t i = 0; i < plan->erase_count; i++) {
+        memset(&chip[plan->erase[i].address - b->base], 0xff, plan->erase[i].length);
+    }
+    for (uint32_t p = 0; p < b->pages; p++) {
+        if (!flash_diff_bit(plan->program, p)) {
+            continue;
+        }
+        for (uint32_t i = p * FLASH_DIFF_PAGE_SIZE; i < (p + 1) * FLASH_DIFF_PAGE_SIZE; i++) {
+            chip[i] &= image[i]; // NOR program
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * flash_diff.h — Differential programming plan for NOR flash and EEPROM
+ *
+ * Re-flashing a chip that differs from the file by a few KB should only
+ * touch those few KB. The image is compared page by page against the
+ * chip contents one 64K block at a time, then a plan is made:
+ *
+ *   - identical pages are skipped
+ *   - a changed page whose new data only clears bits (old & new == new)
+ *     is programmed in place, NOR programming can always do that
+ *   - a page that needs a 0 turned back into a 1 forces an erase of its
+ *     4K sector, and every non-blank page in an erased sector is programmed
+ *   - erased sectors are merged into 32K/64K erases only when the larger
+ *     erase covers nothing but sectors that needed erasing anyway
+ *
+ * Only the block metadata (a few bitmaps) is kept, the data itself is
+ * streamed, so this works with 256 byte buffers.
+ *
+ * This file has no Pico SDK dependencies so the planner can be tested
+ * on the host (tests/test_flash_diff.c).
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef FLASH_DIFF_H
+#define FLASH_DIFF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FLASH_DIFF_PAGE_SIZE 256u
+#define FLASH_DIFF_SECTOR_SIZE 4096u
+#define FLASH_DIFF_BLOCK_SIZE 65536u
+#define FLASH_DIFF_PAGES (FLASH_DIFF_BLOCK_SIZE / FLASH_DIFF_PAGE_SIZE)
+#define FLASH_DIFF_SECTORS (FLASH_DIFF_BLOCK_SIZE / FLASH_DIFF_SECTOR_SIZE)
+
+// supported erase sizes
+#define FLASH_DIFF_ERASE_4K (1u << 0)
+#define FLASH_DIFF_ERASE_32K (1u << 1)
+#define FLASH_DIFF_ERASE_64K (1u << 2)
+
+typedef struct {
+    uint32_t base;                        // block start address, 64K aligned
+    uint32_t pages;                       // pages in use (image may end inside the block)
+    uint8_t changed[FLASH_DIFF_PAGES / 8]; // page differs from the chip
+    uint8_t blank[FLASH_DIFF_PAGES / 8];   // new page is all 0xFF
+    uint16_t needs_erase;                 // 4K sectors with a 0->1 bit change
+} flash_diff_block_t;
+
+typedef struct {
+    uint32_t address;
+    uint32_t length;
+} flash_diff_erase_t;
+
+typedef struct {
+    flash_diff_erase_t erase[FLASH_DIFF_SECTORS];
+    uint8_t erase_count;
+    uint16_t erased_sectors;                 // 4K sectors covered by the erase list
+    uint8_t program[FLASH_DIFF_PAGES / 8];    // pages to program, after the erases
+    uint32_t program_pages;
+    uint32_t skipped_pages;                  // pages left untouched
+} flash_diff_plan_t;
+
+static inline bool flash_diff_bit(const uint8_t* map, uint32_t i) {
+    return (map[i / 8] >> (i % 8)) & 1;
+}
+
+void flash_diff_block_init(flash_diff_block_t* b, uint32_t base);
+
+/**
+ * Compare one page of the image against the chip.
+ * @param page   page index inside the block
+ * @param old    current chip contents
+ * @param data   new contents
+ * @param len    bytes of new data, the rest of the page is treated as 0xFF
+ */
+void flash_diff_page(flash_diff_block_t* b, uint32_t page, const uint8_t* old, const uint8_t* data, uint32_t len);
+
+/**
+ * Plan erases and page programs for a block.
+ * The image must be diffed up to the end of its last 4K sector (pad with len 0).
+ * @param erase_sizes  FLASH_DIFF_ERASE_x mask of erase sizes the chip supports
+ * @return false if an erase would reach past the end of the image
+ */
+bool flash_diff_plan(const flash_diff_block_t* b, uint32_t erase_sizes, flash_diff_plan_t* plan);
+
+// true if the page was erased or programmed and should be verified
+bool flash_diff_page_touched(const flash_diff_plan_t* plan, uint32_t page);
+
+/**
+ * Apply a plan to a RAM model of the chip (used by the tests, documents the semantics).
+ * @param chip   chip contents at block base
+ * @param image  new contents at block base, padded with 0xFF
+ */
+void flash_diff_apply(const flash_diff_block_t* b, const flash_diff_plan_t* plan, uint8_t* chip, const uint8_t* image);
+
+#endif // FLASH_DIFF_H
@@ -0,0 +1,128 @@
+/*
+ * freq_stats.c — Reciprocal frequency/duty statistics from edge records
+ *
+ * See freq_stats.h.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include "freq_stats.h"
+#include <string.h>
+#include <math.h>
+#include "lib/la_change/la_change.h"
+
+typedef struct {
+    bool have_rise;
+    uint64_t first_rise; // age of the newest rising edge
+    uint64_t rise;       // age of the last (oldest so far) rising edge
+    bool have_fall;
+    uint64_t fall;       // age of the falling edge after rise
+} edge_track_t;
+
+void freq_stats_compute(const uint32_t* ring,
+                        uint32_t ring_len,
+                        uint32_t newest,
+                        uint32_t count,
+                        uint64_t max_ticks,
+                        freq_stats_t* stats) {
+    edge_track_t track[FREQ_STATS_PINS];
+    memset(track, 0, sizeof(track));
+    memset(stats, 0, sizeof(freq_stats_t) * FREQ_STATS_PINS);
+
+    if (count == 0) {
+        return;
+    }
+
+    uint32_t mask = ring_len - 1;
+    uint32_t i = newest & mask;
+    uint8_t now = la_change_record_state(ring[i]);
+    for (uint8_t pin = 0; pin < FREQ_STATS_PINS; pin++) {
+        stats[pin].level = (now >> pin) & 1;
+        stats[pin].min_ticks = UINT32_MAX;
+    }
+
+    // walk backwards, age is the time from the newest record to record i
+    uint64_t age = 0;
+    for (uint32_t n = 1; n < count; n++) {
+        if (max_ticks && age > max_ticks) {
+            break;
+        }
+        uint32_t prev = (i - 1) & mask;
+        uint8_t state = la_change_record_state(ring[i]);
+        uint8_t changed = state ^ la_change_record_state(ring[prev]);
+
+        for (uint8_t pin = 0; changed; pin++, changed >>= 1) {
+            if (!(changed & 1)) {
+                continue;
+            }
+            edge_track_t* t = &track[pin];
+            if (!((state >> pin) & 1)) {
+                // falling edge, only counts once a newer rising edge closes its period
+                if (t->have_rise) {
+                    t->fall = age;
+                    t->have_fall = true;
+                }
+                continue;
+            }
+            if (t->have_rise) {
+                freq_stats_t* s = &stats[pin];
+                uint64_t period = age - t->rise;
+                uint32_t p = (period > UINT32_MAX) ? UINT32_MAX : (uint32_t)period;
+                s->periods++;
+                s->high_ticks += t->have_fall ? (age - t->fall) : period;
+                s->sum_sq += (double)p * (double)p;
+                if (p < s->min_ticks) {
+                    s->min_ticks = p;
+                }
+                if (p > s->max_ticks) {
+                    s->max_ticks = p;
+                }
+                s->span_ticks = age - t->first_rise;
+            } else {
+                t->first_rise = age;
+                t->have_rise = true;
+            }
+            t->rise = age;
+            t->have_fall = false;
+        }
+
+        age += la_change_record_delta(ring[i]);
+        i = prev;
+    }
+
+    for (uint8_t pin = 0; pin < FREQ_STATS_PINS; pin++) {
+        if (stats[pin].periods == 0) {
+            stats[pin].min_ticks = 0;
+        }
+    }
+}
+
+double freq_stats_frequency(const freq_stats_t* s, double tick_hz) {
+    if (s->periods == 0 || s->span_ticks == 0) {
+        return 0;
+    }
+    return (double)s->periods * tick_hz / (double)s->span_ticks;
+}
+
+double freq_stats_period_ticks(const freq_stats_t* s) {
+    if (s->periods == 0) {
+        return 0;
+    }
+    return (double)s->span_ticks / (double)s->periods;
+}
+
+double freq_stats_duty(const freq_stats_t* s) {
+    if (s->periods == 0 || s->span_ticks == 0) {
+        return s->level ? 1.0 : 0.0;
+    }
+    return (double)s->high_ticks / (double)s->span_ticks;
+}
+
+double freq_stats_jitter_ticks(const freq_stats_t* s) {
+    if (s->periods < 2) {
+        return 0;
+    }
+    double mean = freq_stats_period_ticks(s);
+    double var = s->sum_sq / s->periods - mean * mean;
+    return (var > 0) ? sqrt(var) : 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * freq_stats.h — Reciprocal frequency/duty statistics from edge records
+ *
+ * The freq_pio PIO program timestamps every change on IO0-IO7 using
+ * the change record format from lib/la_change (pin state + 24 bit sample
+ * counter) and DMA writes the records into a ring buffer. Nothing is
+ * counted by the CPU while measuring: when the f/F commands or the LCD
+ * want a reading, this walks the ring backwards from the newest record
+ * and works out per-pin period, frequency and duty cycle.
+ *
+ * Frequency is reciprocal: whole periods divided by the time between the
+ * first and last rising edge in the window, so the resolution is one
+ * sample tick over the window length, not one count over a fixed gate.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host
+ * (tests/test_freq_stats.c).
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef FREQ_STATS_H
+#define FREQ_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FREQ_STATS_PINS 8
+
+typedef struct {
+    uint32_t periods;        // complete rising-to-rising periods in the window
+    uint64_t span_ticks;     // first to last rising edge
+    uint64_t high_ticks;     // high time inside those periods
+    uint32_t min_ticks;      // shortest period
+    uint32_t max_ticks;      // longest period
+    double sum_sq;           // sum of squared periods, for jitter
+    bool level;              // current pin level
+} freq_stats_t;
+
+/**
+ * Compute per-pin statistics from a ring of change records.
+ * @param ring        record ring buffer
+ * @param ring_len    ring length in records (power of two)
+ * @param newest      index of the newest record in the ring
+ * @param count       number of valid records ending at newest (<= ring_len)
+ * @param max_ticks   stop once the window is this many ticks long, 0 for no limit
+ * @param stats       FREQ_STATS_PINS results
+ */
+void freq_stats_compute(const uint32_t* ring,
+                        uint32_t ring_len,
+                        uint32_t newest,
+                        uint32_t count,
+                        uint64_t max_ticks,
+                        freq_stats_t* stats);
+
+// average frequency in Hz, 0 with less than one full period
+double freq_stats_frequency(const freq_stats_t* s, double tick_hz);
+// average period in ticks
+double freq_stats_period_ticks(const freq_stats_t* s);
+// duty cycle 0.0-1.0, the current level as 0/1 if there are no full periods
+double freq_stats_duty(const freq_stats_t* s);
+// standard deviation of the period in ticks
+double freq_stats_jitter_ticks(const freq_stats_t* s);
+
+#endif // FREQ_STATS_H
@@ -0,0 +1,215 @@
+/*
+ * glitch_campaign.c — Glitch campaign scheduler, response classifier and results
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "glitch_campaign.h"
+
+static const char* const class_names[GLITCH_CLASS_COUNT] = {
+    "none", "fail", "success", "reset", "other", "notrig",
+};
+
+static bool glitch_parse_uint(const char** p, uint32_t* value) {
+    const char* s = *p;
+    if (*s < '0' || *s > '9') {
+        return false;
+    }
+    char* end;
+    unsigned long v = strtoul(s, &end, 0);
+    if (v > 0xffffffffUL) {
+        return false;
+    }
+    *value = (uint32_t)v;
+    *p = end;
+    return true;
+}
+
+bool glitch_axis_parse(const char* text, glitch_axis_t* axis) {
+    const char* p = text;
+    if (!glitch_parse_uint(&p, &axis->start)) {
+        return false;
+    }
+    axis->stop = axis->start;
+    axis->step = 1;
+    if (*p == ':') {
+        p++;
+        if (!glitch_parse_uint(&p, &axis->stop)) {
+            return false;
+        }
+        if (*p == ':') {
+            p++;
+            if (!glitch_parse_uint(&p, &axis->step)) {
+                return false;
+            }
+        }
+    }
+    return (*p == '\0' && axis->stop >= axis->start && axis->step);
+}
+
+uint32_t glitch_axis_count(const glitch_axis_t* axis) {
+    return (axis->stop - axis->start) / axis->step + 1;
+}
+
+static uint32_t glitch_gcd(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static uint32_t glitch_rand(glitch_sched_t* s) {
+    // xorshift32, good enough to spread the rounds
+    uint32_t x = s->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s->seed = x;
+    return x;
+}
+
+bool glitch_sched_init(glitch_sched_t* s,
+                       const glitch_axis_t* delay,
+                       const glitch_axis_t* width,
+                       const glitch_axis_t* edges,
+                       uint32_t repeats,
+                       bool shuffle,
+                       uint32_t seed,
+                       uint32_t max_points) {
+    s->delay = *delay;
+    s->width = *width;
+    s->edges = *edges;
+    s->repeats = repeats ? repeats : 1;
+    s->shuffle = shuffle;
+    s->attempt = 0;
+    s->seed = seed ? seed : 0x2545f491;
+
+    uint64_t points = (uint64_t)glitch_axis_count(delay) * glitch_axis_count(width) * glitch_axis_count(edges);
+    if (!points || points > max_points) {
+        s->points = 0;
+        return false;
+    }
+    s->points = (uint32_t)points;
+
+    // visit order in a round: (offset + i * stride) mod points, a permutation when coprime
+    s->stride = 1;
+    s->offset = 0;
+    if (shuffle && s->points > 2) {
+        uint32_t stride = (uint32_t)(((uint64_t)s->points * 618) / 1000) + (glitch_rand(s) % 7);
+        while (glitch_gcd(stride, s->points) != 1) {
+            stride++;
+        }
+        s->stride = stride % s->points;
+        if (!s->stride) {
+            s->stride = 1;
+        }
+        s->offset = glitch_rand(s) % s->points;
+    }
+    return true;
+}
+
+uint32_t glitch_sched_total(const glitch_sched_t* s) {
+    return s->points * s->repeats;
+}
+
+void glitch_sched_point(const glitch_sched_t* s, uint32_t index, glitch_point_t* p) {
+    uint32_t nd = glitch_axis_count(&s->delay);
+    uint32_t nw = glitch_axis_count(&s->width);
+    p->index = index;
+    p->delay = s->delay.start + (index % nd) * s->delay.step;
+    p->width = s->width.start + ((index / nd) % nw) * s->width.step;
+    p->edges = s->edges.start + (index / (nd * nw)) * s->edges.step;
+}
+
+bool glitch_sched_next(glitch_sched_t* s, glitch_point_t* p) {
+    if (!s->points || s->attempt >= glitch_sched_total(s)) {
+        return false;
+    }
+    uint32_t i = s->attempt % s->points;
+    if (s->shuffle && i == 0 && s->attempt) {
+        s->offset = glitch_rand(s) % s->points; // new round, new start
+    }
+    uint32_t index = (uint32_t)((s->offset + (uint64_t)i * s->stride) % s->points);
+    glitch_sched_point(s, index, p);
+    s->attempt++;
+    return true;
+}
+
+uint32_t glitch_sched_pack(glitch_sched_t* s, glitch_point_t* points, uint32_t* words, uint32_t max) {
+    uint32_t n = 0;
+    while (n < max && glitch_sched_next(s, &points[n])) {
+        // the order uart_glitch pulls them
+        words[n * GLITCH_WORDS_PER_ATTEMPT + 0] = points[n].width;
+        words[n * GLITCH_WORDS_PER_ATTEMPT + 1] = points[n].edges;
+        words[n * GLITCH_WORDS_PER_ATTEMPT + 2] = points[n].delay;
+        n++;
+    }
+    return n;
+}
+
+static bool glitch_contains(const uint8_t* reply, uint32_t len, const char* text) {
+    size_t n = strlen(text);
+    if (!n || n > len) {
+        return false;
+    }
+    for (uint32_t i = 0; i + n <= len; i++) {
+        if (reply[i] == (uint8_t)text[0] && !memcmp(&reply[i], text, n)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t glitch_classify(const glitch_match_t* m, const uint8_t* reply, uint32_t len, bool triggered) {
+    if (!triggered) {
+        return GLITCH_CLASS_NO_TRIGGER;
+    }
+    // line endings alone are no reply
+    bool any = false;
+    for (uint32_t i = 0; i < len && !any; i++) {
+        any = (reply[i] != '\r' && reply[i] != '\n');
+    }
+    if (!any) {
+        return GLITCH_CLASS_NONE;
+    }
+    if (glitch_contains(reply, len, m->reset)) {
+        return GLITCH_CLASS_RESET;
+    }
+    if (glitch_contains(reply, len, m->success)) {
+        return GLITCH_CLASS_SUCCESS;
+    }
+    if (glitch_contains(reply, len, m->fail)) {
+        return GLITCH_CLASS_FAIL;
+    }
+    return m->success[0] ? GLITCH_CLASS_OTHER : GLITCH_CLASS_SUCCESS;
+}
+
+void glitch_hist_add(glitch_cell_t* cells, uint32_t point, uint8_t cls) {
+    if (cls < GLITCH_CLASS_COUNT && cells[point].count[cls] != 0xffff) {
+        cells[point].count[cls]++;
+    }
+}
+
+const char* glitch_class_name(uint8_t cls) {
+    return (cls < GLITCH_CLASS_COUNT) ? class_names[cls] : "?";
+}
+
+int glitch_csv_header(char* buf, size_t size) {
+    return snprintf(buf, size, "delay,width,edges,%s,%s,%s,%s,%s,%s\r\n",
+                    class_names[0], class_names[1], class_names[2],
+                    class_names[3], class_names[4], class_names[5]);
+}
+
+int glitch_csv_row(char* buf, size_t size, const glitch_sched_t* s, uint32_t point, const glitch_cell_t* cell) {
+    glitch_point_t p;
+    glitch_sched_point(s, point, &p);
+    return snprintf(buf, size, "%u,%u,%u,%u,%u,%u,%u,%u,%u\r\n",
+                    (unsigned)p.delay, (unsigned)p.width, (unsigned)p.edges,
+                    cell->count[0], cell->count[1], cell->count[2],
+                    cell->count[3], cell->count[4], cell->count[5]);
+}
@@ -0,0 +1,134 @@
+/*
+ * glitch_campaign.h — Glitch campaign scheduler, response classifier and results
+ *
+ * A campaign sweeps a grid of glitch parameters: delay after the trigger,
+ * pulse width and the trigger edge to count from, each an axis
+ * "start[:stop[:step]]" in the glitch PIO units (10ns). Every grid point is
+ * tried `repeats` times, one round over the whole grid after another, in
+ * grid order or shuffled per round so slow drift in the target does not
+ * line up with one corner of the grid.
+ *
+ * glitch_sched_pack() writes the next attempts as the words the uart_glitch
+ * PIO program pulls (width, edges, delay), ready for one DMA transfer.
+ *
+ * Responses are classified by substring: the reset text (boot banner),
+ * the success text, the fail text (the normal reply). No bytes is NONE.
+ * Without a success text anything that is not the normal reply counts as a
+ * success, like the glitch command. Counts per point and class go into a
+ * histogram, written out as CSV.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef GLITCH_CAMPAIGN_H
+#define GLITCH_CAMPAIGN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+enum glitch_class {
+    GLITCH_CLASS_NONE = 0,   // no reply
+    GLITCH_CLASS_FAIL,       // the normal reply
+    GLITCH_CLASS_SUCCESS,    // glitched
+    GLITCH_CLASS_RESET,      // target rebooted
+    GLITCH_CLASS_OTHER,      // some other reply (only with a success text)
+    GLITCH_CLASS_NO_TRIGGER, // the pulse never fired
+    GLITCH_CLASS_COUNT
+};
+
+#define GLITCH_WORDS_PER_ATTEMPT 3
+#define GLITCH_MATCH_MAX 24
+
+typedef struct {
+    uint32_t start;
+    uint32_t stop;
+    uint32_t step;
+} glitch_axis_t;
+
+typedef struct {
+    uint32_t index; // grid point, delay changes fastest, then width, then edges
+    uint32_t delay;
+    uint32_t width;
+    uint32_t edges;
+} glitch_point_t;
+
+typedef struct {
+    glitch_axis_t delay, width, edges;
+    uint32_t repeats;
+    bool shuffle;
+    // state
+    uint32_t points;  // grid size
+    uint32_t attempt; // next attempt
+    uint32_t stride;  // shuffle: coprime to points
+    uint32_t offset;  // shuffle: start of this round
+    uint32_t seed;
+} glitch_sched_t;
+
+typedef struct {
+    char fail[GLITCH_MATCH_MAX];
+    char success[GLITCH_MATCH_MAX]; // empty: anything but fail
+    char reset[GLITCH_MATCH_MAX];   // empty: not checked
+} glitch_match_t;
+
+typedef struct {
+    uint16_t count[GLITCH_CLASS_COUNT]; // saturates
+} glitch_cell_t;
+
+/**
+ * Parse "start", "start:stop" or "start:stop:step".
+ * @return false on a syntax error, stop < start or a step of 0
+ */
+bool glitch_axis_parse(const char* text, glitch_axis_t* axis);
+
+uint32_t glitch_axis_count(const glitch_axis_t* axis);
+
+/**
+ * @param max_points  largest grid allowed (histogram size)
+ * @return false if the grid is empty or larger than max_points
+ */
+bool glitch_sched_init(glitch_sched_t* s,
+                       const glitch_axis_t* delay,
+                       const glitch_axis_t* width,
+                       const glitch_axis_t* edges,
+                       uint32_t repeats,
+                       bool shuffle,
+                       uint32_t seed,
+                       uint32_t max_points);
+
+uint32_t glitch_sched_total(const glitch_sched_t* s);
+
+void glitch_sched_point(const glitch_sched_t* s, uint32_t index, glitch_point_t* p);
+
+/**
+ * Next attempt in campaign order.
+ * @return false when the campaign is done
+ */
+bool glitch_sched_next(glitch_sched_t* s, glitch_point_t* p);
+
+/**
+ * Up to `max` next attempts: their points and the PIO words
+ * (GLITCH_WORDS_PER_ATTEMPT each) in one buffer for DMA.
+ * @return attempts packed, 0 when the campaign is done
+ */
+uint32_t glitch_sched_pack(glitch_sched_t* s, glitch_point_t* points, uint32_t* words, uint32_t max);
+
+/**
+ * Classify one reply.
+ * @param triggered  the glitch pulse fired for this attempt
+ */
+uint8_t glitch_classify(const glitch_match_t* m, const uint8_t* reply, uint32_t len, bool triggered);
+
+void glitch_hist_add(glitch_cell_t* cells, uint32_t point, uint8_t cls);
+
+const char* glitch_class_name(uint8_t cls);
+
+/**
+ * CSV header and one row per point, return the length written.
+ */
+int glitch_csv_header(char* buf, size_t size);
+int glitch_csv_row(char* buf, size_t size, const glitch_sched_t* s, uint32_t point, const glitch_cell_t* cell);
+
+#endif // GLITCH_CAMPAIGN_H
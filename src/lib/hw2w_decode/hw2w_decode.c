@@ -0,0 +1,195 @@
+/*
+ * hw2w_decode.c — 2-wire sniffer words to timestamped transactions
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "hw2w_decode.h"
+
+/* ── Decoder ───────────────────────────────────────────────────── */
+
+void hw2w_dec_init(hw2w_dec_t* d, hw2w_txn_fn done, void* ctx) {
+    memset(d, 0, sizeof(*d));
+    d->done = done;
+    d->ctx = ctx;
+}
+
+static void dec_open(hw2w_dec_t* d, uint32_t ts_us, hw2w_dec_state_t state, uint8_t flags) {
+    d->txn.ts_us = ts_us;
+    d->txn.end_us = ts_us;
+    d->txn.cmd_len = 0;
+    d->txn.resp_len = 0;
+    d->txn.resp_total = 0;
+    d->txn.flags = flags;
+    d->state = state;
+}
+
+void hw2w_dec_flush(hw2w_dec_t* d) {
+    if (d->state != HW2W_DEC_IDLE) {
+        d->state = HW2W_DEC_IDLE;
+        d->txns++;
+        d->done(d->ctx, &d->txn);
+    }
+}
+
+static void dec_byte(hw2w_dec_t* d, uint8_t b) {
+    uint32_t kept = d->txn.cmd_len + d->txn.resp_len;
+    if (d->state == HW2W_DEC_RESP) {
+        d->txn.resp_total++;
+    }
+    if (kept >= HW2W_TXN_DATA_MAX) {
+        d->txn.flags |= HW2W_TXN_TRUNC;
+        return;
+    }
+    d->txn.data[kept] = b;
+    if (d->state == HW2W_DEC_CMD) {
+        d->txn.cmd_len++;
+    } else {
+        d->txn.resp_len++;
+    }
+}
+
+void hw2w_dec_word(hw2w_dec_t* d, uint32_t word, uint32_t ts_us) {
+    d->words++;
+    switch (HW2W_WORD_EVENT(word)) {
+        case HW2W_EV_START:
+            if (d->state == HW2W_DEC_CMD) {
+                d->txn.flags |= HW2W_TXN_RESTART;
+            }
+            hw2w_dec_flush(d);
+            dec_open(d, ts_us, HW2W_DEC_CMD, 0);
+            return;
+        case HW2W_EV_STOP:
+            if (d->state != HW2W_DEC_CMD) {
+                d->stray_stops++;
+                return;
+            }
+            d->state = HW2W_DEC_RESP;
+            break;
+        case HW2W_EV_DATA:
+            if (d->state == HW2W_DEC_IDLE) {
+                dec_open(d, ts_us, HW2W_DEC_RESP, HW2W_TXN_NO_START);
+            }
+            dec_byte(d, HW2W_WORD_DATA(word));
+            break;
+        default:
+            if (d->state == HW2W_DEC_IDLE) {
+                return;
+            }
+            d->txn.flags |= HW2W_TXN_UNKNOWN;
+            break;
+    }
+    d->txn.end_us = ts_us;
+}
+
+void hw2w_dec_lost(hw2w_dec_t* d, uint32_t words) {
+    if (words && d->state != HW2W_DEC_IDLE) {
+        d->txn.flags |= HW2W_TXN_LOST;
+    }
+}
+
+void hw2w_dec_idle(hw2w_dec_t* d, uint32_t now_us, uint32_t idle_us) {
+    if (d->state == HW2W_DEC_RESP && now_us - d->txn.end_us > idle_us) {
+        hw2w_dec_flush(d);
+    }
+}
+
+/* ── Queue ─────────────────────────────────────────────────────── */
+
+void hw2w_txn_queue_init(hw2w_txn_queue_t* q, hw2w_txn_t* slots, uint32_t count) {
+    q->slots = slots;
+    q->count = count;
+    q->head = 0;
+    q->tail = 0;
+    q->overruns = 0;
+}
+
+bool hw2w_txn_queue_push(hw2w_txn_queue_t* q, const hw2w_txn_t* t) {
+    if (q->tail - q->head >= q->count) {
+        q->overruns++;
+        return false;
+    }
+    hw2w_txn_t* s = &q->slots[q->tail & (q->count - 1)];
+    // only the bytes in use
+    memcpy(s, t, offsetof(hw2w_txn_t, data) + t->cmd_len + t->resp_len);
+    q->tail++;
+    return true;
+}
+
+const hw2w_txn_t* hw2w_txn_queue_peek(const hw2w_txn_queue_t* q) {
+    if (q->head == q->tail) {
+        return NULL;
+    }
+    return &q->slots[q->head & (q->count - 1)];
+}
+
+void hw2w_txn_queue_pop(hw2w_txn_queue_t* q) {
+    if (q->head != q->tail) {
+        q->head++;
+    }
+}
+
+/* ── Text ──────────────────────────────────────────────────────── */
+
+static const struct {
+    uint8_t flag;
+    const char* text;
+} hw2w_flag_text[] = {
+    { HW2W_TXN_NO_START, " !nostart" }, { HW2W_TXN_RESTART, " !restart" }, { HW2W_TXN_TRUNC, " !trunc" },
+    { HW2W_TXN_LOST, " !lost" },        { HW2W_TXN_UNKNOWN, " !unknown" },
+};
+
+// append to out, clipped at size - 1
+static size_t fmt(char* out, size_t size, size_t n, const char* format, ...) {
+    va_list args;
+    if (n + 1 >= size) {
+        return n;
+    }
+    va_start(args, format);
+    int r = vsnprintf(&out[n], size - n, format, args);
+    va_end(args);
+    if (r < 0) {
+        return n;
+    }
+    return ((size_t)r >= size - n) ? size - 1 : n + (size_t)r;
+}
+
+size_t hw2w_txn_format(const hw2w_txn_t* t, uint32_t t0_us, char* out, size_t size) {
+    uint32_t rel = t->ts_us - t0_us;
+    size_t n = 0;
+
+    if (!size) {
+        return 0;
+    }
+    out[0] = 0;
+    n = fmt(out, size, n, "%5lu.%06lu", (unsigned long)(rel / 1000000), (unsigned long)(rel % 1000000));
+    if (!(t->flags & HW2W_TXN_NO_START)) {
+        n = fmt(out, size, n, " [");
+        for (uint32_t i = 0; i < t->cmd_len; i++) {
+            n = fmt(out, size, n, i ? " %02X" : "%02X", t->data[i]);
+        }
+        // a command cut short by a restart has no STOP
+        n = fmt(out, size, n, (t->flags & HW2W_TXN_RESTART) ? "" : "]");
+    }
+    if (t->resp_total) {
+        n = fmt(out, size, n, " %lu byte%s", (unsigned long)t->resp_total, t->resp_total == 1 ? "" : "s");
+    }
+    for (uint32_t i = 0; i < sizeof(hw2w_flag_text) / sizeof(hw2w_flag_text[0]); i++) {
+        if (t->flags & hw2w_flag_text[i].flag) {
+            n = fmt(out, size, n, "%s", hw2w_flag_text[i].text);
+        }
+    }
+    n = fmt(out, size, n, "\r\n");
+
+    const uint8_t* resp = &t->data[t->cmd_len];
+    for (uint32_t i = 0; i < t->resp_len; i++) {
+        n = fmt(out, size, n, (i % 16 == 0) ? "             %02X" : " %02X", resp[i]);
+        if (i % 16 == 15 || i + 1 == t->resp_len) {
+            n = fmt(out, size, n, "\r\n");
+        }
+    }
+    return n;
+}
@@ -0,0 +1,148 @@
+/*
+ * hw2w_decode.h — 2-wire sniffer words to timestamped transactions
+ *
+ * The hw2w_main PIO program pushes one word per bus event:
+ *
+ *   - data:  the 8 bits sampled on SCL rising, MSB first, in bits 7:0,
+ *            event code 0
+ *   - START/STOP: the pins SDA, SCL, EV0, EV1 from bit 8 up (higher pins
+ *            above them), so the event code is bits 11:10, 1 = START,
+ *            3 = STOP
+ *
+ * SLE4442 style cards take a command between START and STOP, then clock
+ * out their answer without either. A transaction is therefore the bytes
+ * between START and STOP (the command) followed by the data bytes up to
+ * the next START, or until the bus has been quiet for a while (the
+ * response). Data without a START opens a transaction of its own.
+ *
+ * Words are fed with the time they were taken from the DMA ring. A
+ * transaction is stamped with its START word and its last word.
+ *
+ * Finished transactions go to a callback; hw2w_txn_queue_t holds them
+ * until the terminal or a file has room, and counts the ones that did
+ * not fit.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef HW2W_DECODE_H
+#define HW2W_DECODE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define HW2W_EV_DATA 0x00
+#define HW2W_EV_START 0x01
+#define HW2W_EV_STOP 0x03
+#define HW2W_WORD_EVENT(word) (((word) >> 10) & 0x03)
+#define HW2W_WORD_DATA(word) ((uint8_t)(word))
+
+// command and response bytes kept per transaction, a full SLE4442 main
+// memory read is 3 + 256
+#define HW2W_TXN_DATA_MAX 320
+
+// transaction flags
+#define HW2W_TXN_NO_START (1u << 0) // data before any START
+#define HW2W_TXN_RESTART (1u << 1)  // a START came before the STOP
+#define HW2W_TXN_TRUNC (1u << 2)    // more than HW2W_TXN_DATA_MAX bytes
+#define HW2W_TXN_LOST (1u << 3)     // words were lost inside it
+#define HW2W_TXN_UNKNOWN (1u << 4)  // event code 2
+
+// longest formatted transaction, 16 bytes per line
+#define HW2W_FMT_MAX (64 + HW2W_TXN_DATA_MAX * 5 + (HW2W_TXN_DATA_MAX / 16 + 2) * 16)
+
+typedef struct {
+    uint32_t ts_us;      // START (or first word)
+    uint32_t end_us;     // last word
+    uint16_t cmd_len;    // bytes between START and STOP
+    uint16_t resp_len;   // bytes after STOP, as many as were kept
+    uint32_t resp_total; // bytes after STOP on the bus, kept or not
+    uint8_t flags;
+    uint8_t data[HW2W_TXN_DATA_MAX]; // command then response
+} hw2w_txn_t;
+
+typedef void (*hw2w_txn_fn)(void* ctx, const hw2w_txn_t* t);
+
+typedef enum {
+    HW2W_DEC_IDLE = 0,
+    HW2W_DEC_CMD,  // after START
+    HW2W_DEC_RESP, // after STOP, or data without START
+} hw2w_dec_state_t;
+
+typedef struct {
+    hw2w_txn_t txn;
+    hw2w_dec_state_t state;
+    hw2w_txn_fn done;
+    void* ctx;
+    uint32_t words;
+    uint32_t txns;
+    uint32_t stray_stops; // STOP outside a command
+} hw2w_dec_t;
+
+typedef struct {
+    hw2w_txn_t* slots;
+    uint32_t count; // power of 2
+    uint32_t head;  // free running, next pop
+    uint32_t tail;  // free running, next push
+    uint32_t overruns;
+} hw2w_txn_queue_t;
+
+/* ── Decoder ───────────────────────────────────────────────────── */
+
+void hw2w_dec_init(hw2w_dec_t* d, hw2w_txn_fn done, void* ctx);
+
+/**
+ * One PIO word, seen at ts_us.
+ */
+void hw2w_dec_word(hw2w_dec_t* d, uint32_t word, uint32_t ts_us);
+
+/**
+ * words were lost before the next one, the open transaction is marked.
+ */
+void hw2w_dec_lost(hw2w_dec_t* d, uint32_t words);
+
+/**
+ * Close a response that has been quiet for idle_us at now_us.
+ */
+void hw2w_dec_idle(hw2w_dec_t* d, uint32_t now_us, uint32_t idle_us);
+
+/**
+ * Close the open transaction, whatever state it is in.
+ */
+void hw2w_dec_flush(hw2w_dec_t* d);
+
+/* ── Queue ─────────────────────────────────────────────────────── */
+
+/**
+ * slots holds count transactions, count a power of 2.
+ */
+void hw2w_txn_queue_init(hw2w_txn_queue_t* q, hw2w_txn_t* slots, uint32_t count);
+
+/**
+ * @return false (and counts an overrun) when full
+ */
+bool hw2w_txn_queue_push(hw2w_txn_queue_t* q, const hw2w_txn_t* t);
+
+/**
+ * The oldest transaction, NULL when empty. Valid until hw2w_txn_queue_pop().
+ */
+const hw2w_txn_t* hw2w_txn_queue_peek(const hw2w_txn_queue_t* q);
+
+void hw2w_txn_queue_pop(hw2w_txn_queue_t* q);
+
+/* ── Text ──────────────────────────────────────────────────────── */
+
+/**
+ * Transaction as text, time from t0_us:
+ *
+ *     0.001234 [30 00 00] 16 bytes !lost
+ *              A2 13 10 91 FF FF 81 15 FF FF FF FF FF FF FF FF
+ *
+ * @return length, at most HW2W_FMT_MAX - 1
+ */
+size_t hw2w_txn_format(const hw2w_txn_t* t, uint32_t t0_us, char* out, size_t size);
+
+#endif // HW2W_DECODE_H
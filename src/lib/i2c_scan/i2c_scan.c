@@ -0,0 +1,208 @@
+/*
+ * i2c_scan.c — Single pass I2C address scan: probe program, decoder, results
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "i2c_scan.h"
+
+#define I2C_SCAN_ESCAPE(n) ((uint16_t)((n) << 10))
+#define I2C_SCAN_DATA(b, nack) ((uint16_t)(((b) << 1) | ((nack) ? 1u : 0u)))
+
+void i2c_scan_init(i2c_scan_result_t* r) {
+    memset(r, 0, sizeof(*r));
+}
+
+static uint32_t i2c_scan_start(uint16_t* tx, const uint16_t* inst) {
+    tx[0] = I2C_SCAN_ESCAPE(1);
+    tx[1] = inst[I2C_SCAN_SC1_SD0]; // idle, pull SDA low
+    tx[2] = inst[I2C_SCAN_SC0_SD0]; // then SCL
+    return 3;
+}
+
+static uint32_t i2c_scan_stop(uint16_t* tx, const uint16_t* inst) {
+    tx[0] = I2C_SCAN_ESCAPE(2);
+    tx[1] = inst[I2C_SCAN_SC0_SD0];
+    tx[2] = inst[I2C_SCAN_SC1_SD0];
+    tx[3] = inst[I2C_SCAN_SC1_SD1];
+    return 4;
+}
+
+uint32_t i2c_scan_build(uint16_t* tx, const uint16_t* inst, uint32_t first, uint32_t count) {
+    uint32_t n = 0;
+    for (uint32_t a = first; a < first + count; a++) {
+        n += i2c_scan_start(&tx[n], inst);
+        tx[n++] = I2C_SCAN_DATA(a, true);
+        if (a & 1) {
+            tx[n++] = I2C_SCAN_DATA(0xff, true); // one byte, NACK
+        }
+        n += i2c_scan_stop(&tx[n], inst);
+    }
+    return n;
+}
+
+uint32_t i2c_scan_rx_words(uint32_t first, uint32_t count) {
+    uint32_t reads = (first + count) / 2 - first / 2; // odd addresses in the range
+    return count + reads;
+}
+
+// an even and an odd address push 3 words: write address, read address, read byte
+static uint32_t i2c_scan_rx_locate(uint32_t first, uint32_t index, bool* read_word) {
+    if (first & 1) {
+        if (index < 2) {
+            *read_word = (index == 1);
+            return first;
+        }
+        index -= 2;
+        first++;
+    }
+    uint32_t rem = index % 3;
+    *read_word = (rem == 2);
+    return first + (index / 3) * 2 + (rem ? 1 : 0);
+}
+
+uint32_t i2c_scan_rx_address(uint32_t first, uint32_t index) {
+    bool read_word;
+    return i2c_scan_rx_locate(first, index, &read_word);
+}
+
+uint32_t i2c_scan_rx_cycles(uint32_t first, uint32_t index) {
+    bool read_word;
+    i2c_scan_rx_locate(first, index, &read_word);
+    if (read_word) {
+        return I2C_SCAN_BYTE_CYCLES;
+    }
+    return I2C_SCAN_START_CYCLES + I2C_SCAN_BYTE_CYCLES + (index ? I2C_SCAN_STOP_CYCLES : 0);
+}
+
+void i2c_scan_decode(i2c_scan_result_t* r, const uint16_t* rx, uint32_t received, uint32_t first) {
+    uint32_t a = first, i = 0;
+    while (i < received) {
+        uint16_t word = rx[i] & 0x1ff;
+        if ((word >> 1) != a) {
+            i2c_scan_set(r->fault, a >> 1);
+        } else if (!(word & 1)) {
+            i2c_scan_set((a & 1) ? r->ack_r : r->ack_w, a >> 1);
+        }
+        i += (a & 1) ? 2 : 1; // skip the read byte, it is the device's data
+        a++;
+    }
+    if (a > r->probed) {
+        r->probed = (uint16_t)a;
+    }
+}
+
+uint32_t i2c_scan_build_10bit(uint16_t* tx, const uint16_t* inst, uint8_t prefix, uint32_t low, uint32_t count) {
+    uint32_t n = 0;
+    for (uint32_t a = low; a < low + count; a++) {
+        n += i2c_scan_start(&tx[n], inst);
+        tx[n++] = I2C_SCAN_DATA(0xf0 | ((prefix & 3) << 1), true);
+        tx[n++] = I2C_SCAN_DATA(a, true);
+        n += i2c_scan_stop(&tx[n], inst);
+    }
+    return n;
+}
+
+void i2c_scan_decode_10bit(i2c_scan_result_t* r, const uint16_t* rx, uint32_t received, uint8_t prefix, uint32_t low) {
+    uint8_t first_byte = 0xf0 | ((prefix & 3) << 1);
+    r->scan10 = true;
+    for (uint32_t i = 0; i + 1 < received; i += 2) {
+        uint32_t a = low + i / 2;
+        uint16_t hi = rx[i] & 0x1ff, lo = rx[i + 1] & 0x1ff;
+        if ((hi >> 1) != first_byte || (lo >> 1) != a) {
+            i2c_scan_set(r->fault, first_byte >> 1);
+        } else if (!(hi & 1) && !(lo & 1)) {
+            i2c_scan_set(r->ack10, ((uint32_t)(prefix & 3) << 8) | a);
+        }
+    }
+}
+
+const char* i2c_scan_reserved(uint8_t address, bool read) {
+    if (address == 0x00) {
+        return read ? "START byte" : "general call";
+    }
+    if (address == 0x01) {
+        return "CBUS";
+    }
+    if (address <= 0x03) {
+        return "reserved";
+    }
+    if (address <= 0x07) {
+        return "Hs-mode master code";
+    }
+    if (address >= 0x78 && address <= 0x7b) {
+        return "10 bit address";
+    }
+    if (address >= 0x7c) {
+        return read ? "device ID" : "reserved";
+    }
+    return NULL;
+}
+
+// append to a line, truncating at the buffer size
+static size_t i2c_scan_append(char* buf, size_t size, size_t n, const char* fmt, ...) {
+    if (n + 1 >= size) {
+        return n;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(&buf[n], size - n, fmt, args);
+    va_end(args);
+    if (len < 0) {
+        return n;
+    }
+    return ((size_t)len < size - n) ? n + len : size - 1;
+}
+
+int i2c_scan_format(char* buf, size_t size, const i2c_scan_result_t* r, uint8_t address) {
+    bool w = i2c_scan_bit(r->ack_w, address);
+    bool rd = i2c_scan_bit(r->ack_r, address);
+    bool stretch = i2c_scan_bit(r->stretch, address);
+    bool fault = i2c_scan_bit(r->fault, address);
+    buf[0] = '\0';
+    if (!w && !rd && !fault && !stretch) {
+        return 0;
+    }
+
+    size_t n = i2c_scan_append(buf, size, 0, "0x%02X", address);
+    if (w) {
+        n = i2c_scan_append(buf, size, n, " (0x%02X W)", address << 1);
+    }
+    if (rd) {
+        n = i2c_scan_append(buf, size, n, " (0x%02X R)", (address << 1) | 1);
+    }
+    const char* reserved = i2c_scan_reserved(address, rd && !w);
+    if (reserved && (w || rd)) {
+        n = i2c_scan_append(buf, size, n, " [%s]", reserved);
+    }
+    if (stretch) {
+        n = i2c_scan_append(buf, size, n, " clock stretch");
+    }
+    if (fault) {
+        n = i2c_scan_append(buf, size, n, " SDA held low");
+    }
+    return (int)n;
+}
+
+static uint32_t i2c_scan_popcount(const uint32_t* map, uint32_t words) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < words; i++) {
+        for (uint32_t v = map[i]; v; v &= v - 1) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void i2c_scan_count(const i2c_scan_result_t* r, uint32_t* addresses, uint32_t* pairs, uint32_t* addresses10) {
+    uint32_t both[4];
+    for (uint32_t i = 0; i < 4; i++) {
+        both[i] = r->ack_w[i] & r->ack_r[i];
+    }
+    *addresses = i2c_scan_popcount(r->ack_w, 4) + i2c_scan_popcount(r->ack_r, 4);
+    *pairs = i2c_scan_popcount(both, 4);
+    *addresses10 = i2c_scan_popcount(r->ack10, 32);
+}
@@ -0,0 +1,139 @@
+/*
+ * i2c_scan.h — Single pass I2C address scan: probe program, decoder, results
+ *
+ * The hwi2c PIO program takes 16 bit TX FIFO words: a data word
+ * (byte << 1 | nack) clocks out 9 bits and pushes the 9 bits it sampled
+ * on SDA, an escape word (n << 10) runs the next n + 1 words as
+ * instructions (START, STOP). i2c_scan_build() writes the probes for a
+ * block of 8 bit addresses as TX words so a DMA channel can feed the
+ * probes back to back while a second one collects the RX words:
+ *
+ *   write address:  START, address, STOP                    1 RX word
+ *   read address:   START, address, read 0xff + NACK, STOP  2 RX words
+ *
+ * The read byte is clocked whether the address was ACKed or not, so the
+ * sequence does not depend on the answer. A device that ACKs a read
+ * drives SDA for the next byte, the NACK lets it go before the STOP.
+ *
+ * i2c_scan_decode() turns the RX words into bitmaps. The sampled address
+ * bits must read back as sent, a difference means something held SDA low
+ * (a stuck bus or a device that did not let go). 10 bit devices ACK the
+ * 11110xx first byte, i2c_scan_build_10bit() probes the low address byte
+ * behind a prefix that ACKed.
+ *
+ * The PIO cycle counts below follow hwi2c.pio, 32 PIO cycles per SCL
+ * period, and give the nominal time between RX words so a longer one
+ * can be reported as clock stretching.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef I2C_SCAN_H
+#define I2C_SCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// set_scl_sda instruction table order in hwi2c.pio
+enum {
+    I2C_SCAN_SC0_SD0 = 0,
+    I2C_SCAN_SC0_SD1,
+    I2C_SCAN_SC1_SD0,
+    I2C_SCAN_SC1_SD1
+};
+
+// TX words per probe
+#define I2C_SCAN_WRITE_WORDS 8
+#define I2C_SCAN_READ_WORDS 9
+#define I2C_SCAN_10BIT_WORDS 9
+// addresses per DMA block, the buffers live on the stack
+#define I2C_SCAN_BLOCK 32
+#define I2C_SCAN_TX_MAX (I2C_SCAN_BLOCK * I2C_SCAN_10BIT_WORDS)
+#define I2C_SCAN_RX_MAX (I2C_SCAN_BLOCK * 2)
+
+// PIO cycles: START, STOP, one data word, one SCL period
+#define I2C_SCAN_START_CYCLES 24
+#define I2C_SCAN_STOP_CYCLES 34
+#define I2C_SCAN_BYTE_CYCLES 284
+#define I2C_SCAN_BIT_CYCLES 32
+
+typedef struct {
+    uint32_t ack_w[4];   // 7 bit addresses that ACKed a write
+    uint32_t ack_r[4];   // 7 bit addresses that ACKed a read
+    uint32_t stretch[4]; // clock stretched on this address
+    uint32_t fault[4];   // address read back wrong, SDA held low
+    uint32_t ack10[32];  // 10 bit addresses that ACKed
+    uint16_t probed;     // 8 bit addresses probed, where the scan stopped if the bus hung
+    bool hung;           // the scan stopped on a stuck bus
+    bool scan10;         // 10 bit addresses were probed
+} i2c_scan_result_t;
+
+static inline bool i2c_scan_bit(const uint32_t* map, uint32_t bit) {
+    return (map[bit >> 5] >> (bit & 31)) & 1u;
+}
+
+static inline void i2c_scan_set(uint32_t* map, uint32_t bit) {
+    map[bit >> 5] |= 1u << (bit & 31);
+}
+
+void i2c_scan_init(i2c_scan_result_t* r);
+
+/**
+ * Probes for the 8 bit addresses [first, first + count).
+ * @param inst  the four set_scl_sda instructions
+ * @return TX words written, at most I2C_SCAN_TX_MAX for I2C_SCAN_BLOCK addresses
+ */
+uint32_t i2c_scan_build(uint16_t* tx, const uint16_t* inst, uint32_t first, uint32_t count);
+
+/**
+ * RX words the probes for [first, first + count) push.
+ */
+uint32_t i2c_scan_rx_words(uint32_t first, uint32_t count);
+
+/**
+ * PIO cycles between RX word `index` and the one before it (or the start
+ * of the block) for a block built from `first`.
+ */
+uint32_t i2c_scan_rx_cycles(uint32_t first, uint32_t index);
+
+/**
+ * The 8 bit address RX word `index` of a block built from `first` belongs to.
+ */
+uint32_t i2c_scan_rx_address(uint32_t first, uint32_t index);
+
+/**
+ * Decode `received` RX words of a block built from `first`. Fewer words
+ * than the block pushes means the scan stopped there.
+ */
+void i2c_scan_decode(i2c_scan_result_t* r, const uint16_t* rx, uint32_t received, uint32_t first);
+
+/**
+ * Probes for 10 bit addresses (prefix << 8) + [low, low + count):
+ * START, 11110xx0, low byte, STOP. Two RX words each.
+ */
+uint32_t i2c_scan_build_10bit(uint16_t* tx, const uint16_t* inst, uint8_t prefix, uint32_t low, uint32_t count);
+
+void i2c_scan_decode_10bit(i2c_scan_result_t* r, const uint16_t* rx, uint32_t received, uint8_t prefix, uint32_t low);
+
+/**
+ * Reserved 7 bit addresses: general call, START byte, CBUS, Hs-mode,
+ * 10 bit prefixes, device ID. NULL for an ordinary address.
+ */
+const char* i2c_scan_reserved(uint8_t address, bool read);
+
+/**
+ * One result line for a 7 bit address, the way the scan command prints it:
+ * "0x50 (0xA0 W) (0xA1 R)" and notes. Empty if nothing answered.
+ * @return length written
+ */
+int i2c_scan_format(char* buf, size_t size, const i2c_scan_result_t* r, uint8_t address);
+
+/**
+ * Found addresses (W and R count apart), W/R pairs and 10 bit addresses.
+ */
+void i2c_scan_count(const i2c_scan_result_t* r, uint32_t* addresses, uint32_t* pairs, uint32_t* addresses10);
+
+#endif // I2C_SCAN_H
@@ -0,0 +1,331 @@
+/*
+ * ir_frame.c — Infrared frames: AIR text, compact IRF files, capture assembly
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ir_frame.h"
+
+static const uint8_t ir_irf_magic[4] = { 'B', 'P', 'I', 'R' };
+
+/* ── AIR text ─────────────────────────────────────────────────── */
+
+ir_air_status_t ir_air_parse(const char* air, size_t len, uint8_t* khz, uint32_t* pairs, uint32_t max_pairs, uint32_t* count) {
+    size_t i = 0;
+    uint32_t freq = 0, n = 0;
+    bool mark = true;
+
+    *count = 0;
+
+    // search start of frame
+    while (i < len && air[i] != '$') {
+        if (air[i] == 0x00) {
+            return IR_AIR_ERROR_START;
+        }
+        i++;
+    }
+    i++; // skip past the $ character
+    if (i >= len) {
+        return IR_AIR_ERROR_START;
+    }
+
+    // modulation frequency in kHz
+    while (air[i] != ':') {
+        if (air[i] < '0' || air[i] > '9') {
+            return IR_AIR_ERROR_MOD_FREQ;
+        }
+        freq = freq * 10 + (air[i] - '0');
+        if (freq > 255) {
+            return IR_AIR_ERROR_MOD_FREQ;
+        }
+        i++;
+        if (i >= len) {
+            return IR_AIR_ERROR_MOD_FREQ;
+        }
+    }
+    if (freq == 0) {
+        return IR_AIR_ERROR_MOD_FREQ;
+    }
+    i++; // skip past the : character
+    if (i >= len || air[i] == 0x00) {
+        return IR_AIR_ERROR_LENGTH;
+    }
+
+    // MARK,SPACE,... each value followed by a comma, ';' after a comma ends it
+    while (true) {
+        uint32_t value = 0;
+        size_t digits = 0;
+        while (i < len && air[i] != ',') {
+            if (air[i] < '0' || air[i] > '9') {
+                return IR_AIR_ERROR_DATA;
+            }
+            value = value * 10 + (air[i] - '0');
+            if (value > 0xffff) {
+                return IR_AIR_ERROR_DATA;
+            }
+            digits++;
+            i++;
+        }
+        if (i >= len || digits == 0) {
+            return IR_AIR_ERROR_DATA;
+        }
+        if (mark) {
+            if (n >= max_pairs) {
+                return IR_AIR_ERROR_OVERFLOW;
+            }
+            pairs[n] = IR_PAIR(value, 0); // upper 16 bits are the mark
+        } else {
+            pairs[n++] |= value;
+        }
+        mark = !mark;
+        i++;
+        if (i >= len) {
+            return IR_AIR_ERROR_DATA;
+        }
+        if (air[i] == ';') {
+            break;
+        }
+    }
+    if (!mark) {
+        pairs[n++] |= IR_FRAME_TIMEOUT; // end with a SPACE if not included in the AIR packet
+    }
+
+    *khz = (uint8_t)freq;
+    *count = n;
+    return IR_AIR_OK;
+}
+
+const char* ir_air_error_str(ir_air_status_t status) {
+    switch (status) {
+        case IR_AIR_OK:
+            return "OK";
+        case IR_AIR_ERROR_START:
+            return "Unable to find start of data ($) in AIR packet";
+        case IR_AIR_ERROR_LENGTH:
+            return "No MARK/SPACE data in AIR packet";
+        case IR_AIR_ERROR_MOD_FREQ:
+            return "Unable to find modulation frequency (:) in AIR packet";
+        case IR_AIR_ERROR_DATA:
+            return "Unable to find end of MARK/SPACE data (,) in AIR packet";
+        case IR_AIR_ERROR_OVERFLOW:
+        default:
+            return "Too many MARK/SPACE pairs in AIR packet";
+    }
+}
+
+size_t ir_air_format(char* buf, size_t size, uint8_t khz, const uint32_t* pairs, uint32_t count) {
+    char scratch[1];
+    size_t n = 0;
+    int len;
+
+    // snprintf into the buffer while it has room, count the rest
+#define IR_AIR_APPEND(...)                                                        \
+    do {                                                                          \
+        if (n < size) {                                                           \
+            len = snprintf(&buf[n], size - n, __VA_ARGS__);                       \
+        } else {                                                                  \
+            len = snprintf(scratch, 0, __VA_ARGS__);                              \
+        }                                                                         \
+        n += (len > 0) ? (size_t)len : 0;                                         \
+    } while (0)
+
+    IR_AIR_APPEND("$%u:", khz);
+    for (uint32_t i = 0; i < count; i++) {
+        IR_AIR_APPEND("%u,", IR_PAIR_MARK(pairs[i]));
+        if (i + 1 < count || IR_PAIR_SPACE(pairs[i]) != IR_FRAME_TIMEOUT) {
+            IR_AIR_APPEND("%u,", IR_PAIR_SPACE(pairs[i]));
+        }
+    }
+    IR_AIR_APPEND(";");
+#undef IR_AIR_APPEND
+    return n;
+}
+
+/* ── IRF files ────────────────────────────────────────────────── */
+
+static size_t ir_irf_varint(uint8_t* out, uint32_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+size_t ir_irf_header(uint8_t* out) {
+    memcpy(out, ir_irf_magic, sizeof(ir_irf_magic));
+    out[4] = IR_IRF_VERSION;
+    return IR_IRF_HEADER_LEN;
+}
+
+size_t ir_irf_frame_header(uint8_t* out, uint8_t khz, uint32_t count) {
+    out[0] = khz;
+    return 1 + ir_irf_varint(&out[1], count);
+}
+
+size_t ir_irf_pair(uint8_t* out, uint32_t pair) {
+    size_t n = ir_irf_varint(out, IR_PAIR_MARK(pair));
+    return n + ir_irf_varint(&out[n], IR_PAIR_SPACE(pair));
+}
+
+size_t ir_irf_encode(uint8_t* out, size_t size, uint8_t khz, const uint32_t* pairs, uint32_t count) {
+    uint8_t tmp[IR_IRF_FRAME_HEADER_MAX];
+    size_t n = ir_irf_frame_header(tmp, khz, count);
+    if (n > size) {
+        return 0;
+    }
+    memcpy(out, tmp, n);
+    for (uint32_t i = 0; i < count; i++) {
+        size_t len = ir_irf_pair(tmp, pairs[i]);
+        if (n + len > size) {
+            return 0;
+        }
+        memcpy(&out[n], tmp, len);
+        n += len;
+    }
+    return n;
+}
+
+// next byte of the file, -1 at the end
+static int ir_irf_byte(ir_irf_reader_t* r) {
+    if (r->pos >= r->len) {
+        r->len = (uint8_t)r->read(r->ctx, r->buf, sizeof(r->buf));
+        r->pos = 0;
+        if (r->len == 0) {
+            return -1;
+        }
+    }
+    return r->buf[r->pos++];
+}
+
+static ir_irf_status_t ir_irf_read_varint(ir_irf_reader_t* r, uint32_t* value, uint32_t max) {
+    uint32_t v = 0;
+    for (uint32_t shift = 0; shift < 28; shift += 7) {
+        int b = ir_irf_byte(r);
+        if (b < 0) {
+            return IR_IRF_TRUNCATED;
+        }
+        v |= (uint32_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            if (v > max) {
+                return IR_IRF_BAD_VALUE;
+            }
+            *value = v;
+            return IR_IRF_OK;
+        }
+    }
+    return IR_IRF_BAD_VALUE;
+}
+
+ir_irf_status_t ir_irf_open(ir_irf_reader_t* r, ir_irf_read_fn read, void* ctx) {
+    memset(r, 0, sizeof(*r));
+    r->read = read;
+    r->ctx = ctx;
+    for (uint32_t i = 0; i < IR_IRF_HEADER_LEN; i++) {
+        int b = ir_irf_byte(r);
+        uint8_t expect = (i < sizeof(ir_irf_magic)) ? ir_irf_magic[i] : IR_IRF_VERSION;
+        if (b != expect) {
+            return IR_IRF_BAD_MAGIC;
+        }
+    }
+    return IR_IRF_OK;
+}
+
+ir_irf_status_t ir_irf_next(ir_irf_reader_t* r, uint8_t* khz, uint32_t* count) {
+    uint32_t skip, got;
+    while (r->remaining) {
+        ir_irf_status_t status = ir_irf_read(r, &skip, 1, &got);
+        if (status != IR_IRF_OK) {
+            return status;
+        }
+    }
+
+    int b = ir_irf_byte(r);
+    if (b < 0) {
+        return IR_IRF_END;
+    }
+    if (b == 0) {
+        return IR_IRF_BAD_VALUE;
+    }
+    ir_irf_status_t status = ir_irf_read_varint(r, count, 0x1fffff);
+    if (status != IR_IRF_OK) {
+        return status;
+    }
+    *khz = (uint8_t)b;
+    r->remaining = *count;
+    return IR_IRF_OK;
+}
+
+ir_irf_status_t ir_irf_read(ir_irf_reader_t* r, uint32_t* pairs, uint32_t max, uint32_t* got) {
+    uint32_t n = 0;
+    while (n < max && r->remaining) {
+        uint32_t mark, space;
+        ir_irf_status_t status = ir_irf_read_varint(r, &mark, 0xffff);
+        if (status == IR_IRF_OK) {
+            status = ir_irf_read_varint(r, &space, 0xffff);
+        }
+        if (status != IR_IRF_OK) {
+            r->remaining = 0;
+            *got = n;
+            return status;
+        }
+        pairs[n++] = IR_PAIR(mark, space);
+        r->remaining--;
+    }
+    *got = n;
+    return IR_IRF_OK;
+}
+
+/* ── Capture ──────────────────────────────────────────────────── */
+
+void ir_capture_init(ir_capture_t* c, uint32_t* pairs, uint32_t max) {
+    c->pairs = pairs;
+    c->max = max;
+    c->count = 0;
+    c->truncated = false;
+}
+
+bool ir_capture_feed(ir_capture_t* c, uint32_t mark_count, uint32_t space_count) {
+    uint16_t space = ir_count_us(space_count);
+    if (c->count < c->max) {
+        c->pairs[c->count++] = IR_PAIR(ir_count_us(mark_count), space);
+    } else {
+        c->truncated = true;
+        if (space == IR_FRAME_TIMEOUT && c->max) {
+            c->pairs[c->max - 1] |= IR_FRAME_TIMEOUT; // a truncated frame still ends on the timeout
+        }
+    }
+    return space == IR_FRAME_TIMEOUT;
+}
+
+bool ir_carrier_measure(const uint32_t* words, uint32_t count, uint32_t* mark_ticks, uint32_t* space_ticks) {
+    enum { CARRIER_MARK, CARRIER_SPACE } state = CARRIER_MARK;
+    uint32_t mark = 0, space = 0;
+
+    // count the 0s and then the first string of 1s, one carrier period
+    for (uint32_t i = 0; i < count; i++) {
+        for (int j = 31; j >= 0; j--) {
+            bool bit = (words[i] >> j) & 1u;
+            if (state == CARRIER_MARK) {
+                if (!bit) {
+                    mark++;
+                } else if (mark == 0) {
+                    return false;
+                } else {
+                    state = CARRIER_SPACE;
+                    space++;
+                }
+            } else if (bit) {
+                space++;
+            } else {
+                *mark_ticks = mark;
+                *space_ticks = space;
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,158 @@
+/*
+ * ir_frame.h — Infrared frames: AIR text, compact IRF files, capture assembly
+ *
+ * A frame is a list of MARK/SPACE pairs in microseconds, packed as
+ * (mark << 16) | space the way the irio PIO programs take and give them.
+ * A SPACE of 0xffff is the receiver timeout that ends a frame.
+ *
+ * AIR text (AnalysIR, IR Toy):  $38:900,1800,900,65535,;
+ *   modulation frequency in kHz, then MARK,SPACE,... each followed by a
+ *   comma. A frame that ends on a MARK gets the timeout SPACE.
+ *
+ * IRF files store the same frames in a fraction of the space, every
+ * number is an unsigned LEB128 varint (7 bits per byte, low first):
+ *
+ *   "BPIR" version(1)
+ *   frame: kHz(1 byte, not 0) pairs(varint) { mark(varint) space(varint) }
+ *
+ * Files are read through ir_irf_reader_t in small chunks so a frame of
+ * any length can be replayed from a few hundred bytes of RAM.
+ *
+ * The capture side turns the raw counter words of the ir_in_low_counter
+ * (MARK) and ir_in_high_counter (SPACE) programs into pairs, and measures
+ * the carrier period from the measure_mod_freq sample words.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef IR_FRAME_H
+#define IR_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define IR_FRAME_TIMEOUT 0xffff
+#define IR_PAIR(mark, space) ((((uint32_t)(mark)) << 16) | ((uint32_t)(space) & 0xffff))
+#define IR_PAIR_MARK(pair) ((uint16_t)((pair) >> 16))
+#define IR_PAIR_SPACE(pair) ((uint16_t)(pair))
+
+#define IR_IRF_VERSION 1
+#define IR_IRF_HEADER_LEN 5
+// largest frame header and pair encodings
+#define IR_IRF_FRAME_HEADER_MAX 6
+#define IR_IRF_PAIR_MAX 6
+
+typedef enum {
+    IR_AIR_OK = 0,
+    IR_AIR_ERROR_START,    // no '$'
+    IR_AIR_ERROR_LENGTH,   // nothing after the modulation frequency
+    IR_AIR_ERROR_MOD_FREQ, // modulation frequency not 1-255kHz or no ':'
+    IR_AIR_ERROR_DATA,     // a MARK/SPACE is not a number up to 65535 followed by ','
+    IR_AIR_ERROR_OVERFLOW, // more pairs than the buffer holds
+} ir_air_status_t;
+
+typedef enum {
+    IR_IRF_OK = 0,
+    IR_IRF_END,       // no more frames
+    IR_IRF_BAD_MAGIC, // not an IRF file or a newer version
+    IR_IRF_TRUNCATED, // the file ends inside a frame
+    IR_IRF_BAD_VALUE, // a field out of range
+} ir_irf_status_t;
+
+/**
+ * Parse one AIR packet from air[0..len), stops at a NUL.
+ * @param khz    modulation frequency
+ * @param pairs  MARK/SPACE pairs
+ * @param count  pairs stored
+ */
+ir_air_status_t ir_air_parse(const char* air, size_t len, uint8_t* khz, uint32_t* pairs, uint32_t max_pairs, uint32_t* count);
+
+const char* ir_air_error_str(ir_air_status_t status);
+
+/**
+ * Format a frame as an AIR packet, a final timeout SPACE is left out
+ * the way irrx prints it. snprintf rules: the return value is the full
+ * length, the text is truncated to size - 1.
+ */
+size_t ir_air_format(char* buf, size_t size, uint8_t khz, const uint32_t* pairs, uint32_t count);
+
+/**
+ * IRF encoders, each returns the bytes written to out.
+ */
+size_t ir_irf_header(uint8_t* out);
+size_t ir_irf_frame_header(uint8_t* out, uint8_t khz, uint32_t count);
+size_t ir_irf_pair(uint8_t* out, uint32_t pair);
+
+/**
+ * A whole frame, header included. 0 if it does not fit in size.
+ */
+size_t ir_irf_encode(uint8_t* out, size_t size, uint8_t khz, const uint32_t* pairs, uint32_t count);
+
+// reads up to len bytes, 0 at the end of the file
+typedef size_t (*ir_irf_read_fn)(void* ctx, uint8_t* buf, size_t len);
+
+typedef struct {
+    ir_irf_read_fn read;
+    void* ctx;
+    uint8_t buf[64];
+    uint8_t pos;
+    uint8_t len;
+    uint32_t remaining; // pairs left in the current frame
+} ir_irf_reader_t;
+
+/**
+ * Check the file header.
+ */
+ir_irf_status_t ir_irf_open(ir_irf_reader_t* r, ir_irf_read_fn read, void* ctx);
+
+/**
+ * Start the next frame, skipping what is left of the current one.
+ * IR_IRF_END at the end of the file.
+ */
+ir_irf_status_t ir_irf_next(ir_irf_reader_t* r, uint8_t* khz, uint32_t* count);
+
+/**
+ * Up to max pairs of the current frame, *got is 0 when it is done.
+ */
+ir_irf_status_t ir_irf_read(ir_irf_reader_t* r, uint32_t* pairs, uint32_t max, uint32_t* got);
+
+/**
+ * Counter word pushed by ir_in_low_counter/ir_in_high_counter to
+ * microseconds. The counter runs down from 0xffff and pushes 0xffff
+ * (all ones) when it times out.
+ */
+static inline uint16_t ir_count_us(uint32_t count) {
+    uint16_t c = (uint16_t)count;
+    return (c == 0xffff) ? IR_FRAME_TIMEOUT : (uint16_t)(0xffff - c);
+}
+
+static inline bool ir_count_timeout(uint32_t count) {
+    return (uint16_t)count == 0xffff;
+}
+
+typedef struct {
+    uint32_t* pairs;
+    uint32_t max;
+    uint32_t count;
+    bool truncated; // pairs past max were dropped
+} ir_capture_t;
+
+void ir_capture_init(ir_capture_t* c, uint32_t* pairs, uint32_t max);
+
+/**
+ * Add a MARK and the SPACE after it, as counter words.
+ * @return true when the SPACE timed out and the frame is complete
+ */
+bool ir_capture_feed(ir_capture_t* c, uint32_t mark_count, uint32_t space_count);
+
+/**
+ * Carrier period from measure_mod_freq samples (MSB first, 0 while the
+ * learner sees carrier): the first run of 0s and the run of 1s after it.
+ * @return false if the samples don't hold a whole period
+ */
+bool ir_carrier_measure(const uint32_t* words, uint32_t count, uint32_t* mark_ticks, uint32_t* space_ticks);
+
+#endif // IR_FRAME_H
@@ -0,0 +1,326 @@
+/*
+ * la_change.c — Change-only (transition timestamp) logic capture format
+ *
+ * Encoder model, run decoder, SUMP RLE and VCD exporters for the records
+ * produced by the logicanalyzer_change PIO program. See la_change.h.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include "la_change.h"
+#include <string.h>
+
+/* ── Encoder model ──────────────────────────────────────────────── */
+
+void la_change_encoder_init(la_change_encoder_t* enc) {
+    memset(enc, 0, sizeof(*enc));
+}
+
+size_t la_change_encode(la_change_encoder_t* enc, const uint8_t* samples, size_t count, uint32_t* records, size_t max_records) {
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint8_t s = samples[i];
+        if (!enc->started) {
+            // program entry: first sample becomes the start record
+            if (n >= max_records) {
+                break;
+            }
+            enc->state = s;
+            enc->counter = LA_CHANGE_COUNTER_MAX;
+            enc->started = true;
+            records[n++] = LA_CHANGE_RECORD(s, LA_CHANGE_COUNTER_MAX);
+        } else if (s != enc->state) {
+            // jmp x!=y changed
+            if (n >= max_records) {
+                break;
+            }
+            records[n++] = LA_CHANGE_RECORD(s, enc->counter);
+            enc->state = s;
+            enc->counter = LA_CHANGE_COUNTER_MAX;
+        } else if (enc->counter == 0) {
+            // jmp x-- fell through: overflow marker
+            if (n >= max_records) {
+                break;
+            }
+            records[n++] = LA_CHANGE_RECORD(enc->state, 0);
+            enc->counter = LA_CHANGE_COUNTER_MAX;
+        } else {
+            enc->counter--;
+        }
+    }
+    return n;
+}
+
+uint32_t la_change_encoder_flush(const la_change_encoder_t* enc) {
+    // firmware execs: mov isr, y / in osr, 24 / push
+    return LA_CHANGE_RECORD(enc->state, enc->counter);
+}
+
+/* ── Run decoder ────────────────────────────────────────────────── */
+
+void la_change_reader_init(la_change_reader_t* r, const uint32_t* records, size_t count) {
+    r->records = records;
+    r->count = count;
+    r->index = 1; // records[0] is the initial state
+    r->position = 0;
+}
+
+bool la_change_next_run(la_change_reader_t* r, la_change_run_t* run) {
+    if (r->count < 2 || r->index >= r->count) {
+        return false;
+    }
+    // record i closes the run that started with record i-1
+    run->state = la_change_record_state(r->records[r->index - 1]);
+    run->start = r->position;
+    run->length = 0;
+    do {
+        run->length += la_change_record_delta(r->records[r->index]);
+        r->index++;
+    } while (r->index < r->count && la_change_record_state(r->records[r->index - 1]) == run->state);
+    r->position += run->length;
+    return true;
+}
+
+uint64_t la_change_total_samples(const uint32_t* records, size_t count) {
+    uint64_t total = 0;
+    for (size_t i = 1; i < count; i++) {
+        total += la_change_record_delta(records[i]);
+    }
+    return total;
+}
+
+size_t la_change_transitions(const uint32_t* records, size_t count) {
+    size_t transitions = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (la_change_record_state(records[i]) != la_change_record_state(records[i - 1])) {
+            transitions++;
+        }
+    }
+    return transitions;
+}
+
+/* ── Reverse sample source ──────────────────────────────────────── */
+
+void la_change_reverse_init(la_change_reverse_t* r, const uint32_t* records, size_t count) {
+    r->records = records;
+    r->index = (count < 2) ? 0 : count - 1;
+    r->state = 0;
+    r->remaining = 0;
+}
+
+bool la_change_reverse_next(la_change_reverse_t* r, uint8_t* state, uint64_t* length) {
+    if (r->index == 0) {
+        return false;
+    }
+    uint8_t s = la_change_record_state(r->records[r->index - 1]);
+    uint64_t len = la_change_record_delta(r->records[r->index]);
+    r->index--;
+    // fold in older segments of the same run (split by overflow markers)
+    while (r->index > 0 && la_change_record_state(r->records[r->index - 1]) == s) {
+        len += la_change_record_delta(r->records[r->index]);
+        r->index--;
+    }
+    *state = s;
+    *length = len;
+    return true;
+}
+
+size_t la_change_reverse_expand(la_change_reverse_t* r, uint8_t* buf, size_t len) {
+    size_t n = 0;
+    while (n < len) {
+        if (r->remaining == 0 && !la_change_reverse_next(r, &r->state, &r->remaining)) {
+            break;
+        }
+        size_t k = len - n;
+        if (k > r->remaining) {
+            k = (size_t)r->remaining;
+        }
+        memset(&buf[n], r->state, k);
+        r->remaining -= k;
+        n += k;
+    }
+    return n;
+}
+
+/* ── SUMP RLE export ────────────────────────────────────────────── */
+
+void la_change_sump_init(la_change_sump_t* s, const uint32_t* records, size_t count, uint8_t width, uint32_t max_entries) {
+    memset(s, 0, sizeof(*s));
+    la_change_reverse_init(&s->src, records, count);
+    s->width = (width == 2) ? 2 : 1;
+    s->entries = max_entries;
+}
+
+static void sump_put_value(la_change_sump_t* s, uint8_t* buf) {
+    if (s->width == 1) {
+        buf[0] = s->state & 0x7f;
+    } else {
+        buf[0] = s->state;
+        buf[1] = 0;
+    }
+}
+
+size_t la_change_sump_fill(la_change_sump_t* s, uint8_t* buf, size_t len) {
+    const uint32_t max_count = (s->width == 1) ? 0x7f : 0x7fff;
+    size_t n = 0;
+
+    while (n + s->width <= len && s->entries) {
+        if (s->value_pending) {
+            sump_put_value(s, &buf[n]);
+            n += s->width;
+            s->entries--;
+            s->value_pending = false;
+            continue;
+        }
+        if (s->run == 0 && !la_change_reverse_next(&s->src, &s->state, &s->run)) {
+            s->entries = 0;
+            break;
+        }
+        uint64_t chunk = s->run;
+        if (chunk > max_count + 1) {
+            chunk = max_count + 1;
+        }
+        if (chunk > 1 && s->entries >= 2) {
+            // repeat count for the value that follows
+            uint32_t c = (uint32_t)(chunk - 1);
+            if (s->width == 1) {
+                buf[n] = 0x80 | c;
+            } else {
+                buf[n] = c & 0xff;
+                buf[n + 1] = 0x80 | (c >> 8);
+            }
+            s->value_pending = true;
+        } else {
+            chunk = 1;
+            sump_put_value(s, &buf[n]);
+        }
+        n += s->width;
+        s->entries--;
+        s->run -= chunk;
+    }
+    return n;
+}
+
+/* ── VCD export ─────────────────────────────────────────────────── */
+
+enum {
+    VCD_STAGE_HEADER = 0,
+    VCD_STAGE_CHANGES,
+    VCD_STAGE_DONE
+};
+
+static size_t vcd_append(char* line, size_t pos, const char* str) {
+    while (*str) {
+        line[pos++] = *str++;
+    }
+    return pos;
+}
+
+static size_t vcd_append_u64(char* line, size_t pos, uint64_t val) {
+    char tmp[21];
+    size_t i = 0;
+    do {
+        tmp[i++] = '0' + (val % 10);
+        val /= 10;
+    } while (val);
+    while (i) {
+        line[pos++] = tmp[--i];
+    }
+    return pos;
+}
+
+static uint64_t vcd_sample_to_ns(uint64_t sample, uint32_t sample_hz) {
+    if (sample_hz == 0) {
+        return sample;
+    }
+    return (sample / sample_hz) * 1000000000ull + ((sample % sample_hz) * 1000000000ull) / sample_hz;
+}
+
+static size_t vcd_append_time(la_change_vcd_t* v, size_t pos, uint64_t sample) {
+    pos = vcd_append(v->line, pos, "#");
+    pos = vcd_append_u64(v->line, pos, vcd_sample_to_ns(sample, v->sample_hz));
+    return vcd_append(v->line, pos, "\n");
+}
+
+static size_t vcd_append_bits(char* line, size_t pos, uint8_t state, uint8_t changed) {
+    for (uint8_t i = 0; i < 8; i++) {
+        if (changed & (1u << i)) {
+            line[pos++] = (state & (1u << i)) ? '1' : '0';
+            line[pos++] = '!' + i;
+            line[pos++] = '\n';
+        }
+    }
+    return pos;
+}
+
+void la_change_vcd_init(la_change_vcd_t* v, const uint32_t* records, size_t count, uint32_t sample_hz) {
+    memset(v, 0, sizeof(*v));
+    la_change_reader_init(&v->reader, records, count);
+    v->sample_hz = sample_hz;
+    v->end = la_change_total_samples(records, count);
+}
+
+// build the next piece of the file in v->line
+static bool vcd_next_line(la_change_vcd_t* v) {
+    size_t pos = 0;
+    la_change_run_t run;
+
+    switch (v->stage) {
+        case VCD_STAGE_HEADER:
+            pos = vcd_append(v->line, pos, "$version Bus Pirate change capture $end\n$timescale 1 ns $end\n");
+            pos = vcd_append(v->line, pos, "$scope module bus_pirate $end\n");
+            for (uint8_t i = 0; i < 8; i++) {
+                char var[] = "$var wire 1 ! IO0 $end\n";
+                var[12] = '!' + i;
+                var[16] = '0' + i;
+                pos = vcd_append(v->line, pos, var);
+            }
+            pos = vcd_append(v->line, pos, "$upscope $end\n$enddefinitions $end\n");
+            v->line_len = pos;
+            v->stage = VCD_STAGE_CHANGES;
+            return true;
+        case VCD_STAGE_CHANGES:
+            if (v->reader.index == 1) {
+                // initial values
+                if (!la_change_next_run(&v->reader, &run)) {
+                    v->stage = VCD_STAGE_DONE;
+                    return false;
+                }
+                pos = vcd_append(v->line, pos, "#0\n$dumpvars\n");
+                pos = vcd_append_bits(v->line, pos, run.state, 0xff);
+                pos = vcd_append(v->line, pos, "$end\n");
+                v->last_state = run.state;
+            } else if (la_change_next_run(&v->reader, &run)) {
+                pos = vcd_append_time(v, pos, run.start);
+                pos = vcd_append_bits(v->line, pos, run.state, run.state ^ v->last_state);
+                v->last_state = run.state;
+            } else {
+                pos = vcd_append_time(v, pos, v->end);
+                v->stage = VCD_STAGE_DONE;
+            }
+            v->line_len = pos;
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t la_change_vcd_fill(la_change_vcd_t* v, char* buf, size_t len) {
+    size_t n = 0;
+    while (n < len) {
+        if (v->line_pos >= v->line_len) {
+            v->line_pos = v->line_len = 0;
+            if (!vcd_next_line(v)) {
+                break;
+            }
+        }
+        size_t k = v->line_len - v->line_pos;
+        if (k > len - n) {
+            k = len - n;
+        }
+        memcpy(&buf[n], &v->line[v->line_pos], k);
+        v->line_pos += k;
+        n += k;
+    }
+    return n;
+}
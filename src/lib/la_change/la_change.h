@@ -0,0 +1,166 @@
+/*
+ * la_change.h — Change-only (transition timestamp) logic capture format
+ *
+ * The logicanalyzer_change PIO program samples IO0-IO7 at a fixed rate but
+ * only pushes a 32 bit record when the pins change, or when its 24 bit
+ * sample counter runs out:
+ *
+ *   bits 31..24  pin state
+ *   bits 23..0   down counter, reloaded to 0xFFFFFF after every record
+ *
+ * The number of samples between a record and the one before it is
+ * (2^24 - counter). A record whose pin state equals the previous state is
+ * not a transition: it is a counter overflow marker, or the end-of-capture
+ * marker pushed when the capture is stopped. The first record holds the
+ * initial pin state.
+ *
+ * Idle buses cost one word per 16.7M samples instead of one byte per sample,
+ * so the 128K big buffer holds up to 32768 transitions at full timing
+ * resolution no matter how long the bus sits idle between them.
+ *
+ * This file has no Pico SDK dependencies so the encoder model, decoder
+ * and exporters can be tested on the host (tests/test_la_change.c).
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef LA_CHANGE_H
+#define LA_CHANGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define LA_CHANGE_COUNTER_BITS 24
+#define LA_CHANGE_COUNTER_MAX 0x00FFFFFFu
+#define LA_CHANGE_RECORD(state, counter) (((uint32_t)(state) << 24) | ((counter) & LA_CHANGE_COUNTER_MAX))
+
+// every path through the PIO sample loop takes this many PIO cycles
+#define LA_CHANGE_CYCLES_PER_SAMPLE 10
+
+static inline uint8_t la_change_record_state(uint32_t record) {
+    return (uint8_t)(record >> 24);
+}
+
+// samples elapsed since the previous record
+static inline uint32_t la_change_record_delta(uint32_t record) {
+    return (LA_CHANGE_COUNTER_MAX - (record & LA_CHANGE_COUNTER_MAX)) + 1;
+}
+
+/* ── Encoder model ───────────────────────────────────────────────────
+ * A sample-by-sample C model of the logicanalyzer_change PIO program.
+ * Used by the host tests to produce the exact record stream the
+ * hardware produces, and documents the format.                      */
+
+typedef struct {
+    uint8_t state;    // last recorded pin state (PIO Y register)
+    uint32_t counter; // samples-since-record counter (PIO OSR)
+    bool started;
+} la_change_encoder_t;
+
+void la_change_encoder_init(la_change_encoder_t* enc);
+
+/**
+ * Feed samples to the encoder model.
+ * @return number of records written to records[], stops early if max_records is reached
+ */
+size_t la_change_encode(la_change_encoder_t* enc, const uint8_t* samples, size_t count, uint32_t* records, size_t max_records);
+
+/**
+ * End-of-capture record, as pushed by the firmware when the capture is stopped.
+ * Counts the current sample, so call it after the last sample has been encoded.
+ */
+uint32_t la_change_encoder_flush(const la_change_encoder_t* enc);
+
+/* ── Run decoder ─────────────────────────────────────────────────────
+ * Walks a record stream as runs of constant pin state. Overflow
+ * markers are folded into the run they interrupt.                   */
+
+typedef struct {
+    uint8_t state;
+    uint64_t start;  // first sample of the run
+    uint64_t length; // samples in the run
+} la_change_run_t;
+
+typedef struct {
+    const uint32_t* records;
+    size_t count;
+    size_t index;
+    uint64_t position;
+} la_change_reader_t;
+
+void la_change_reader_init(la_change_reader_t* r, const uint32_t* records, size_t count);
+bool la_change_next_run(la_change_reader_t* r, la_change_run_t* run);
+
+// total samples covered by a record stream
+uint64_t la_change_total_samples(const uint32_t* records, size_t count);
+// number of pin transitions in a record stream
+size_t la_change_transitions(const uint32_t* records, size_t count);
+
+/* ── Reverse sample source ───────────────────────────────────────────
+ * SUMP and FALA dump samples newest first, this walks the runs
+ * backwards without a forward pass over the records.                */
+
+typedef struct {
+    const uint32_t* records;
+    size_t index;         // record that closes the current run
+    uint8_t state;        // state of the current run
+    uint64_t remaining;   // samples left in the current run
+} la_change_reverse_t;
+
+void la_change_reverse_init(la_change_reverse_t* r, const uint32_t* records, size_t count);
+/**
+ * Get the next (older) run segment.
+ * @return false when the start of the capture is reached
+ */
+bool la_change_reverse_next(la_change_reverse_t* r, uint8_t* state, uint64_t* length);
+/**
+ * Expand up to len raw samples, newest first.
+ * @return samples written to buf
+ */
+size_t la_change_reverse_expand(la_change_reverse_t* r, uint8_t* buf, size_t len);
+
+/* ── SUMP RLE export ─────────────────────────────────────────────────
+ * OLS RLE: the top bit of a sample flags a repeat count for the sample
+ * that follows it in the (newest first) stream. With 1 byte samples
+ * IO7 is lost to the flag and counts are 7 bits; with 2 byte samples all
+ * eight IO are kept and counts are 15 bits.                          */
+
+typedef struct {
+    la_change_reverse_t src;
+    uint8_t width;       // SUMP sample width in bytes, 1 or 2
+    uint8_t state;       // state of the run being emitted
+    uint64_t run;        // samples of the current run not yet emitted
+    uint32_t entries;    // SUMP entries left to send
+    bool value_pending;  // count was sent, value still to send
+} la_change_sump_t;
+
+void la_change_sump_init(la_change_sump_t* s, const uint32_t* records, size_t count, uint8_t width, uint32_t max_entries);
+/**
+ * Fill buf with whole SUMP entries (len should be a multiple of 4).
+ * @return bytes written, 0 when done
+ */
+size_t la_change_sump_fill(la_change_sump_t* s, uint8_t* buf, size_t len);
+
+/* ── VCD export ──────────────────────────────────────────────────────
+ * Value Change Dump text for sigrok/PulseView/GTKWave, timescale 1ns. */
+
+typedef struct {
+    la_change_reader_t reader;
+    uint32_t sample_hz;
+    uint8_t last_state;
+    uint8_t stage; // 0=header, 1=changes, 2=done
+    uint64_t end;
+    char line[384];
+    size_t line_len;
+    size_t line_pos;
+} la_change_vcd_t;
+
+void la_change_vcd_init(la_change_vcd_t* v, const uint32_t* records, size_t count, uint32_t sample_hz);
+/**
+ * Fill buf with the next chunk of VCD text.
+ * @return bytes written, 0 when done
+ */
+size_t la_change_vcd_fill(la_change_vcd_t* v, char* buf, size_t len);
+
+#endif // LA_CHANGE_H
@@ -0,0 +1,75 @@
+/*
+ * led_frame.c — Pack LED frames into PIO words for the WS2812 and APA102 programs
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <math.h>
+#include "led_frame.h"
+
+// matches the reset delay used by the hwled start/stop functions
+#define LED_FRAME_WS2812_RESET_US 65
+
+void led_frame_lut(uint8_t lut[256], float gamma, uint8_t brightness) {
+    for (uint32_t i = 0; i < 256; i++) {
+        float v = powf((float)i / 255.0f, gamma) * (float)brightness;
+        lut[i] = (uint8_t)(v + 0.5f);
+    }
+}
+
+uint32_t led_frame_pack(const led_frame_format_t* f, const uint8_t* src, uint32_t pixels, uint32_t* words) {
+    static uint8_t identity[256];
+    const uint8_t* lut = f->lut;
+    if (!lut) {
+        if (identity[255] != 255) {
+            for (uint32_t i = 0; i < 256; i++) {
+                identity[i] = (uint8_t)i;
+            }
+        }
+        lut = identity;
+    }
+
+    if (f->device == LED_FRAME_APA102) {
+        for (uint32_t i = 0; i < pixels; i++) {
+            uint32_t header = 0xff;
+            if (f->channels == 4) {
+                header = *src++;
+            }
+            words[i] = (header << 24) | ((uint32_t)lut[src[0]] << 16) | ((uint32_t)lut[src[1]] << 8) | lut[src[2]];
+            src += 3;
+        }
+    } else if (f->channels == 4) {
+        for (uint32_t i = 0; i < pixels; i++) {
+            words[i] = ((uint32_t)lut[src[0]] << 24) | ((uint32_t)lut[src[1]] << 16) | ((uint32_t)lut[src[2]] << 8) |
+                       lut[src[3]];
+            src += 4;
+        }
+    } else {
+        // the ws2812 program shifts out the top 24 bits
+        for (uint32_t i = 0; i < pixels; i++) {
+            words[i] = ((uint32_t)lut[src[0]] << 24) | ((uint32_t)lut[src[1]] << 16) | ((uint32_t)lut[src[2]] << 8);
+            src += 3;
+        }
+    }
+    return pixels;
+}
+
+uint32_t led_frame_end_words(const led_frame_format_t* f, uint32_t pixels) {
+    if (f->device != LED_FRAME_APA102) {
+        return 0;
+    }
+    // one clock per two pixels, at least one word like the hwled stop
+    uint32_t words = ((pixels + 1) / 2 + 31) / 32;
+    return words ? words : 1;
+}
+
+uint32_t led_frame_time_us(const led_frame_format_t* f, uint32_t pixels, uint32_t bitrate) {
+    uint64_t bits;
+    if (f->device == LED_FRAME_APA102) {
+        // start frame, pixels, end frame
+        bits = 32ull * (1 + pixels + led_frame_end_words(f, pixels));
+        return (uint32_t)((bits * 1000000ull + bitrate - 1) / bitrate);
+    }
+    bits = (uint64_t)pixels * (f->channels == 4 ? 32 : 24);
+    return (uint32_t)((bits * 1000000ull + bitrate - 1) / bitrate) + LED_FRAME_WS2812_RESET_US;
+}
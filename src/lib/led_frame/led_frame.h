@@ -0,0 +1,64 @@
+/*
+ * led_frame.h — Pack LED frames into PIO words for the WS2812 and APA102 programs
+ *
+ * Source frames are raw bytes, `channels` bytes per pixel in wire order:
+ *   WS2812 3: 24 bit pixels (GRB on most strips)
+ *   WS2812 4: RGBW pixels, the ws2812 program must pull 32 bits
+ *   APA102 3: colour bytes, sent at full brightness (header 0xFF)
+ *   APA102 4: the first byte is the APA102 header (0xE0 | 5 bit brightness)
+ *
+ * The colour bytes go through an optional 256 entry lookup table that
+ * combines gamma correction and a global brightness. The APA102 header
+ * byte is sent as given.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host
+ * (tests/test_led_frame.c).
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef LED_FRAME_H
+#define LED_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum led_frame_device {
+    LED_FRAME_WS2812 = 0,
+    LED_FRAME_APA102,
+};
+
+typedef struct {
+    uint8_t device;     // led_frame_device
+    uint8_t channels;   // bytes per source pixel, 3 or 4
+    const uint8_t* lut; // colour lookup table, NULL to send the bytes as they are
+} led_frame_format_t;
+
+/**
+ * Fill a gamma and brightness lookup table.
+ * @param gamma       1.0 is linear, 2.2-2.8 looks right on most LEDs
+ * @param brightness  0-255 scale applied after gamma
+ */
+void led_frame_lut(uint8_t lut[256], float gamma, uint8_t brightness);
+
+/**
+ * Pack pixels into PIO words, one word per pixel.
+ * @return words written
+ */
+uint32_t led_frame_pack(const led_frame_format_t* f, const uint8_t* src, uint32_t pixels, uint32_t* words);
+
+/**
+ * APA102 needs an end frame of at least pixels/2 extra clocks to push the
+ * data down the strip, WS2812 latches on the reset time instead.
+ * @return end frame words to send after the pixels (0xffffffff each)
+ */
+uint32_t led_frame_end_words(const led_frame_format_t* f, uint32_t pixels);
+
+/**
+ * Time on the wire for one frame, including the start/end frame (APA102)
+ * or the >50us reset (WS2812).
+ * @param bitrate  bits per second on the data line
+ */
+uint32_t led_frame_time_us(const led_frame_format_t* f, uint32_t pixels, uint32_t bitrate);
+
+#endif // LED_FRAME_H
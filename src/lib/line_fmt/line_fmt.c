@@ -0,0 +1,231 @@
+/*
+ * line_fmt.c — Line buffered terminal formatter for hex dumps and syntax results
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <string.h>
+#include "line_fmt.h"
+
+#define HEX_ROW(h)                                                                                              \
+    h "0" h "1" h "2" h "3" h "4" h "5" h "6" h "7" h "8" h "9" h "A" h "B" h "C" h "D" h "E" h "F"
+
+// "00".."FF", two characters per byte
+static const char hex_pairs[] = HEX_ROW("0") HEX_ROW("1") HEX_ROW("2") HEX_ROW("3") HEX_ROW("4") HEX_ROW("5")
+    HEX_ROW("6") HEX_ROW("7") HEX_ROW("8") HEX_ROW("9") HEX_ROW("A") HEX_ROW("B") HEX_ROW("C") HEX_ROW("D")
+        HEX_ROW("E") HEX_ROW("F");
+
+void line_fmt_init(line_fmt_t* l, line_fmt_flush_t flush) {
+    l->len = 0;
+    l->flush = flush;
+}
+
+static void line_fmt_color_set(line_fmt_color_t* c, const char* s) {
+    c->s = s;
+    c->len = (uint8_t)strlen(s);
+}
+
+void line_fmt_colors(line_fmt_colors_t* c, const char* reset, const char* grey, const char* num, const char* info) {
+    line_fmt_color_set(&c->reset, reset);
+    line_fmt_color_set(&c->grey, grey);
+    line_fmt_color_set(&c->num, num);
+    line_fmt_color_set(&c->info, info);
+}
+
+void line_fmt_flush(line_fmt_t* l) {
+    if (l->len) {
+        l->flush(l->buf, l->len);
+        l->len = 0;
+    }
+}
+
+char* line_fmt_reserve(line_fmt_t* l, uint32_t len) {
+    if (l->len + len > LINE_FMT_SIZE) {
+        line_fmt_flush(l);
+    }
+    return &l->buf[l->len];
+}
+
+void line_fmt_put(line_fmt_t* l, const char* s, uint32_t len) {
+    while (len) {
+        if (l->len >= LINE_FMT_SIZE) {
+            line_fmt_flush(l);
+        }
+        uint32_t n = LINE_FMT_SIZE - l->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(&l->buf[l->len], s, n);
+        l->len += n;
+        s += n;
+        len -= n;
+    }
+}
+
+void line_fmt_puts(line_fmt_t* l, const char* s) {
+    line_fmt_put(l, s, (uint32_t)strlen(s));
+}
+
+void line_fmt_dec(line_fmt_t* l, uint32_t value) {
+    char tmp[10];
+    uint32_t n = 0;
+    do {
+        tmp[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    char* p = line_fmt_reserve(l, n);
+    for (uint32_t i = 0; i < n; i++) {
+        p[i] = tmp[n - 1 - i];
+    }
+    l->len += n;
+}
+
+void line_fmt_hex8(line_fmt_t* l, uint32_t value) {
+    char* p = line_fmt_reserve(l, 8);
+    for (int i = 0; i < 4; i++) {
+        memcpy(&p[i * 2], &hex_pairs[((value >> (24 - i * 8)) & 0xff) * 2], 2);
+    }
+    l->len += 8;
+}
+
+// colour state for a run of bytes, an escape is only sent when the colour changes
+enum {
+    RUN_NONE = 0,
+    RUN_GREY,
+    RUN_HIGHLIGHT,
+};
+
+static inline bool line_fmt_out_of_range(uint32_t address, uint32_t start_address, uint32_t requested_bytes) {
+    return (address < start_address) || (address > start_address + requested_bytes - 1);
+}
+
+static inline void line_fmt_run(line_fmt_t* l, const line_fmt_colors_t* c, uint8_t* run, bool grey, bool highlight,
+                                const line_fmt_color_t* on) {
+    if (grey) {
+        if (*run != RUN_GREY) {
+            line_fmt_color(l, &c->grey);
+            *run = RUN_GREY;
+        }
+    } else if (highlight) {
+        if (*run != RUN_HIGHLIGHT) {
+            line_fmt_color(l, on);
+            *run = RUN_HIGHLIGHT;
+        }
+    } else if (*run != RUN_NONE) {
+        line_fmt_color(l, &c->reset);
+        *run = RUN_NONE;
+    }
+}
+
+void line_fmt_hex_row(line_fmt_t* l,
+                      const line_fmt_colors_t* c,
+                      uint32_t address,
+                      const uint8_t* buf,
+                      uint32_t buf_size,
+                      uint32_t start_address,
+                      uint32_t requested_bytes,
+                      bool quiet) {
+    if (!quiet) {
+        line_fmt_hex8(l, address);
+        line_fmt_put(l, ": ", 2);
+    }
+
+    uint8_t run = RUN_NONE;
+    for (uint32_t j = 0; j < 16; j++) {
+        if (j < buf_size) {
+            bool grey = line_fmt_out_of_range(address + j, start_address, requested_bytes);
+            line_fmt_run(l, c, &run, grey, buf[j] != 0x00 && buf[j] != 0xff, &c->num);
+            char* p = line_fmt_reserve(l, 3);
+            p[0] = hex_pairs[buf[j] * 2];
+            p[1] = hex_pairs[buf[j] * 2 + 1];
+            p[2] = ' ';
+            l->len += 3;
+        } else {
+            line_fmt_put(l, "   ", 3);
+        }
+    }
+
+    line_fmt_color(l, &c->reset);
+    if (quiet) {
+        line_fmt_put(l, "\r\n", 2);
+        return;
+    }
+
+    line_fmt_putc(l, '|');
+    run = RUN_NONE;
+    for (uint32_t j = 0; j < 16; j++) {
+        if (j < buf_size) {
+            bool grey = line_fmt_out_of_range(address + j, start_address, requested_bytes);
+            bool printable = (buf[j] >= 32 && buf[j] <= 126);
+            line_fmt_run(l, c, &run, grey, printable, &c->info);
+            line_fmt_putc(l, printable ? (char)buf[j] : '.');
+        } else {
+            line_fmt_putc(l, ' ');
+        }
+    }
+    line_fmt_color(l, &c->reset);
+    line_fmt_put(l, "|\r\n", 3);
+}
+
+static inline uint32_t line_fmt_mask(uint32_t value, uint32_t num_bits) {
+    return (num_bits < 32) ? (value & ((1u << num_bits) - 1)) : value;
+}
+
+void line_fmt_number(line_fmt_t* l, const line_fmt_colors_t* c, uint32_t value, uint32_t num_bits, uint32_t format) {
+    value = line_fmt_mask(value, num_bits);
+
+    if (format == LINE_FMT_DEC) {
+        line_fmt_dec(l, value);
+    } else if (format == LINE_FMT_BIN) {
+        // colour changes at nibble boundaries, counted from the least significant bit
+        uint32_t nibble_pos = num_bits % 4;
+        if (nibble_pos == 0) {
+            nibble_pos = 4;
+        }
+        bool color_state = false;
+        line_fmt_put(l, "0b", 2);
+        line_fmt_color(l, &c->num);
+        for (uint32_t i = 0; i < num_bits; i++) {
+            if (nibble_pos == 0) {
+                line_fmt_color(l, color_state ? &c->num : &c->reset);
+                color_state = !color_state;
+                nibble_pos = 4;
+            }
+            nibble_pos--;
+            line_fmt_putc(l, (char)('0' + ((value >> (num_bits - 1 - i)) & 1)));
+        }
+        line_fmt_color(l, &c->reset);
+    } else if (format == LINE_FMT_HEX || format == LINE_FMT_ASCII) {
+        // whole bytes, colour alternates per byte
+        uint32_t nibbles = ((num_bits + 3) / 4 + 1) & ~1u;
+        bool color_state = true;
+        line_fmt_put(l, "0x", 2);
+        for (uint32_t pos = nibbles * 4; pos > 0; pos -= 8) {
+            line_fmt_color(l, color_state ? &c->num : &c->reset);
+            color_state = !color_state;
+            char* p = line_fmt_reserve(l, 2);
+            memcpy(p, &hex_pairs[((value >> (pos - 8)) & 0xff) * 2], 2);
+            l->len += 2;
+        }
+        line_fmt_color(l, &c->reset);
+    }
+
+    if (num_bits != 8) {
+        line_fmt_putc(l, '.');
+        line_fmt_dec(l, num_bits);
+    }
+}
+
+void line_fmt_ascii(line_fmt_t* l, uint32_t value) {
+    char ch = (char)value;
+    if (ch >= ' ' && ch <= '~') {
+        char* p = line_fmt_reserve(l, 4);
+        p[0] = '\'';
+        p[1] = ch;
+        p[2] = '\'';
+        p[3] = ' ';
+        l->len += 4;
+    } else {
+        line_fmt_put(l, "''  ", 4);
+    }
+}
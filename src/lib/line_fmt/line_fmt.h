@@ -0,0 +1,106 @@
+/*
+ * line_fmt.h — Line buffered terminal formatter for hex dumps and syntax results
+ *
+ * printf() goes through the format engine and then one byte at a time into
+ * the USB tx fifo. A hex dump row took ~35 printf calls. Here a whole row
+ * (address, hex, ASCII and the colour escapes) is rendered into a line
+ * buffer with table lookups and handed to the flush callback in one call.
+ *
+ * Colour escapes are looked up once per line and copied with their
+ * precomputed lengths. The output is byte for byte what the printf based
+ * code produced (tests/test_line_fmt.c has golden tests against it).
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef LINE_FMT_H
+#define LINE_FMT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// a 16 byte row with a 24-bit colour escape before every byte is ~730 bytes
+#define LINE_FMT_SIZE 768
+
+typedef void (*line_fmt_flush_t)(const char* buf, uint32_t len);
+
+typedef struct {
+    char buf[LINE_FMT_SIZE];
+    uint32_t len;
+    line_fmt_flush_t flush;
+} line_fmt_t;
+
+// a colour escape with its length
+typedef struct {
+    const char* s;
+    uint8_t len;
+} line_fmt_color_t;
+
+typedef struct {
+    line_fmt_color_t reset;
+    line_fmt_color_t grey; // bytes outside the requested range
+    line_fmt_color_t num;  // non 0x00/0xFF bytes, number groups
+    line_fmt_color_t info; // printable ASCII
+} line_fmt_colors_t;
+
+// number formats, same values as the display formats in ui/ui_const.h
+enum line_fmt_format {
+    LINE_FMT_AUTO = 0, // prints only the .bits suffix, like ui_format_print_number_3()
+    LINE_FMT_HEX,
+    LINE_FMT_DEC,
+    LINE_FMT_BIN,
+    LINE_FMT_ASCII, // hex, the ASCII prefix is line_fmt_ascii()
+};
+
+void line_fmt_init(line_fmt_t* l, line_fmt_flush_t flush);
+void line_fmt_colors(line_fmt_colors_t* c, const char* reset, const char* grey, const char* num, const char* info);
+
+void line_fmt_flush(line_fmt_t* l);
+void line_fmt_put(line_fmt_t* l, const char* s, uint32_t len);
+void line_fmt_puts(line_fmt_t* l, const char* s);
+
+static inline void line_fmt_putc(line_fmt_t* l, char c) {
+    if (l->len >= LINE_FMT_SIZE) {
+        line_fmt_flush(l);
+    }
+    l->buf[l->len++] = c;
+}
+
+static inline void line_fmt_color(line_fmt_t* l, const line_fmt_color_t* c) {
+    line_fmt_put(l, c->s, c->len);
+}
+
+// room for at least `len` bytes, flushes if needed, returns where to write
+char* line_fmt_reserve(line_fmt_t* l, uint32_t len);
+
+void line_fmt_dec(line_fmt_t* l, uint32_t value);
+void line_fmt_hex8(line_fmt_t* l, uint32_t value); // %08X
+
+/**
+ * One hex dump row: [address: ]16 hex bytes[|ASCII|]\r\n
+ * Bytes outside start_address..start_address+requested_bytes-1 are grey,
+ * bytes other than 0x00/0xFF and printable characters are highlighted.
+ * @param quiet  hex bytes only, no address or ASCII columns
+ */
+void line_fmt_hex_row(line_fmt_t* l,
+                      const line_fmt_colors_t* c,
+                      uint32_t address,
+                      const uint8_t* buf,
+                      uint32_t buf_size,
+                      uint32_t start_address,
+                      uint32_t requested_bytes,
+                      bool quiet);
+
+/**
+ * A number as the syntax shows it: 0x with colour alternating per byte,
+ * decimal, or 0b with colour alternating per nibble, then .bits if not 8.
+ */
+void line_fmt_number(line_fmt_t* l, const line_fmt_colors_t* c, uint32_t value, uint32_t num_bits, uint32_t format);
+
+// 'c' for printable characters, '' otherwise, padded to 4 characters
+void line_fmt_ascii(line_fmt_t* l, uint32_t value);
+
+#endif // LINE_FMT_H
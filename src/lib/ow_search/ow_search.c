@@ -0,0 +1,163 @@
+/*
+ * ow_search.c — 1-Wire ROM search state, table CRC8, temperature scratchpads
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <string.h>
+#include "ow_search.h"
+
+// CRC8 of every byte value, polynomial 0x8c reflected (Maxim AN27)
+static const uint8_t ow_crc8_table[256] = {
+    0x00, 0x5e, 0xbc, 0xe2, 0x61, 0x3f, 0xdd, 0x83, 0xc2, 0x9c, 0x7e, 0x20, 0xa3, 0xfd, 0x1f, 0x41,
+    0x9d, 0xc3, 0x21, 0x7f, 0xfc, 0xa2, 0x40, 0x1e, 0x5f, 0x01, 0xe3, 0xbd, 0x3e, 0x60, 0x82, 0xdc,
+    0x23, 0x7d, 0x9f, 0xc1, 0x42, 0x1c, 0xfe, 0xa0, 0xe1, 0xbf, 0x5d, 0x03, 0x80, 0xde, 0x3c, 0x62,
+    0xbe, 0xe0, 0x02, 0x5c, 0xdf, 0x81, 0x63, 0x3d, 0x7c, 0x22, 0xc0, 0x9e, 0x1d, 0x43, 0xa1, 0xff,
+    0x46, 0x18, 0xfa, 0xa4, 0x27, 0x79, 0x9b, 0xc5, 0x84, 0xda, 0x38, 0x66, 0xe5, 0xbb, 0x59, 0x07,
+    0xdb, 0x85, 0x67, 0x39, 0xba, 0xe4, 0x06, 0x58, 0x19, 0x47, 0xa5, 0xfb, 0x78, 0x26, 0xc4, 0x9a,
+    0x65, 0x3b, 0xd9, 0x87, 0x04, 0x5a, 0xb8, 0xe6, 0xa7, 0xf9, 0x1b, 0x45, 0xc6, 0x98, 0x7a, 0x24,
+    0xf8, 0xa6, 0x44, 0x1a, 0x99, 0xc7, 0x25, 0x7b, 0x3a, 0x64, 0x86, 0xd8, 0x5b, 0x05, 0xe7, 0xb9,
+    0x8c, 0xd2, 0x30, 0x6e, 0xed, 0xb3, 0x51, 0x0f, 0x4e, 0x10, 0xf2, 0xac, 0x2f, 0x71, 0x93, 0xcd,
+    0x11, 0x4f, 0xad, 0xf3, 0x70, 0x2e, 0xcc, 0x92, 0xd3, 0x8d, 0x6f, 0x31, 0xb2, 0xec, 0x0e, 0x50,
+    0xaf, 0xf1, 0x13, 0x4d, 0xce, 0x90, 0x72, 0x2c, 0x6d, 0x33, 0xd1, 0x8f, 0x0c, 0x52, 0xb0, 0xee,
+    0x32, 0x6c, 0x8e, 0xd0, 0x53, 0x0d, 0xef, 0xb1, 0xf0, 0xae, 0x4c, 0x12, 0x91, 0xcf, 0x2d, 0x73,
+    0xca, 0x94, 0x76, 0x28, 0xab, 0xf5, 0x17, 0x49, 0x08, 0x56, 0xb4, 0xea, 0x69, 0x37, 0xd5, 0x8b,
+    0x57, 0x09, 0xeb, 0xb5, 0x36, 0x68, 0x8a, 0xd4, 0x95, 0xcb, 0x29, 0x77, 0xf4, 0xaa, 0x48, 0x16,
+    0xe9, 0xb7, 0x55, 0x0b, 0x88, 0xd6, 0x34, 0x6a, 0x2b, 0x75, 0x97, 0xc9, 0x4a, 0x14, 0xf6, 0xa8,
+    0x74, 0x2a, 0xc8, 0x96, 0x15, 0x4b, 0xa9, 0xf7, 0xb6, 0xe8, 0x0a, 0x54, 0xd7, 0x89, 0x6b, 0x35,
+};
+
+uint8_t ow_crc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        crc = ow_crc8_table[crc ^ *data++];
+    }
+    return crc;
+}
+
+void ow_search_init(ow_search_t* s) {
+    memset(s, 0, sizeof(*s));
+}
+
+static uint8_t ow_search_rom_bit(const uint8_t* rom, uint32_t bit) {
+    return (rom[(bit - 1) >> 3] >> ((bit - 1) & 7)) & 1u;
+}
+
+uint8_t ow_search_preferred(const ow_search_t* s, uint32_t bit) {
+    if (bit < s->last_discrepancy) {
+        return ow_search_rom_bit(s->rom, bit);
+    }
+    return (bit == s->last_discrepancy) ? 1 : 0;
+}
+
+uint8_t ow_search_triplet(uint8_t id_bit, uint8_t cmp_id_bit, uint8_t preferred) {
+    if (id_bit) {
+        return 1; // 1/0, or 1/1 with nobody there
+    }
+    if (cmp_id_bit) {
+        return 0;
+    }
+    return preferred ? 1 : 0;
+}
+
+void ow_search_directions(const ow_search_t* s, uint32_t dir[OW_SEARCH_TX_WORDS]) {
+    dir[0] = dir[1] = 0;
+    for (uint32_t bit = 1; bit <= 64; bit++) {
+        if (ow_search_preferred(s, bit)) {
+            dir[(bit - 1) >> 5] |= 1u << ((bit - 1) & 31);
+        }
+    }
+}
+
+void ow_search_pack(uint32_t rx[OW_SEARCH_RX_WORDS], uint32_t bit, uint8_t id_bit, uint8_t cmp_id_bit) {
+    uint32_t pos = (bit - 1) * 2;
+    uint32_t mask = 3u << (pos & 31);
+    uint32_t pair = (uint32_t)(id_bit & 1) | ((uint32_t)(cmp_id_bit & 1) << 1);
+    rx[pos >> 5] = (rx[pos >> 5] & ~mask) | (pair << (pos & 31));
+}
+
+ow_search_status_t ow_search_decode(ow_search_t* s, const uint32_t rx[OW_SEARCH_RX_WORDS]) {
+    uint8_t rom[8] = { 0 };
+    uint8_t last_zero = 0;
+    uint8_t last_family = s->last_family_discrepancy;
+
+    for (uint32_t bit = 1; bit <= 64; bit++) {
+        uint32_t pos = (bit - 1) * 2;
+        uint8_t id_bit = (rx[pos >> 5] >> (pos & 31)) & 1u;
+        uint8_t cmp_id_bit = (rx[pos >> 5] >> ((pos & 31) + 1)) & 1u;
+        if (id_bit && cmp_id_bit) {
+            ow_search_init(s);
+            return OW_SEARCH_NO_DEVICE;
+        }
+        uint8_t direction = ow_search_triplet(id_bit, cmp_id_bit, ow_search_preferred(s, bit));
+        if (!id_bit && !cmp_id_bit && !direction) {
+            last_zero = (uint8_t)bit;
+            if (last_zero < 9) {
+                last_family = last_zero;
+            }
+        }
+        if (direction) {
+            rom[(bit - 1) >> 3] |= 1u << ((bit - 1) & 7);
+        }
+    }
+
+    // a bus held low reads 0/0 throughout, the all zero ROM passes the CRC
+    if (rom[0] == 0) {
+        ow_search_init(s);
+        return OW_SEARCH_NO_DEVICE;
+    }
+    if (ow_crc8(rom, 8) != 0) {
+        ow_search_init(s);
+        return OW_SEARCH_CRC;
+    }
+
+    memcpy(s->rom, rom, 8);
+    s->last_discrepancy = last_zero;
+    s->last_family_discrepancy = last_family;
+    s->last_device = (last_zero == 0);
+    return OW_SEARCH_FOUND;
+}
+
+bool ow_temp_family(uint8_t family) {
+    switch (family) {
+        case 0x10: // DS18S20
+        case 0x22: // DS1822
+        case 0x28: // DS18B20
+        case 0x3b: // DS1825
+            return true;
+        default:
+            return false;
+    }
+}
+
+ow_temp_status_t ow_temp_decode(uint8_t family, const uint8_t scratchpad[OW_SCRATCHPAD_LEN], int32_t* temp16) {
+    bool blank = true;
+    for (uint32_t i = 0; i < OW_SCRATCHPAD_LEN; i++) {
+        if (scratchpad[i] != 0xff) {
+            blank = false;
+        }
+    }
+    if (blank) {
+        return OW_TEMP_NO_DATA;
+    }
+    if (ow_crc8(scratchpad, OW_SCRATCHPAD_LEN) != 0) {
+        return OW_TEMP_CRC;
+    }
+
+    int16_t raw = (int16_t)(scratchpad[0] | (scratchpad[1] << 8));
+    if (family == 0x10) {
+        // 0.5 degree steps, COUNT_REMAIN and COUNT_PER_C give the fraction
+        uint8_t remain = scratchpad[6], per_c = scratchpad[7];
+        if (per_c == 0 || remain > per_c) {
+            *temp16 = (int32_t)raw * 8;
+        } else {
+            *temp16 = (int32_t)(raw & ~1) * 8 - 4 + ((int32_t)(per_c - remain) * 16) / per_c;
+        }
+        return OW_TEMP_OK;
+    }
+
+    // configuration R1:R0, the bits below the resolution are undefined
+    uint8_t undefined = 3 - ((scratchpad[4] >> 5) & 3);
+    *temp16 = (int32_t)(raw & ~((1 << undefined) - 1));
+    return OW_TEMP_OK;
+}
@@ -0,0 +1,117 @@
+/*
+ * ow_search.h — 1-Wire ROM search state, table CRC8, temperature scratchpads
+ *
+ * The search follows Maxim AN187. Every ROM bit is a triplet: the master
+ * reads the bit and its complement from all devices (wired AND), then
+ * writes the direction it takes, and devices whose bit differs drop out:
+ *
+ *   id_bit | cmp_id_bit | direction
+ *        0 |          1 | 0
+ *        1 |          0 | 1
+ *        0 |          0 | preferred (a discrepancy, both branches exist)
+ *        1 |          1 | 1 (nobody answered)
+ *
+ * The preferred direction of each bit only depends on the previous pass,
+ * so the whole pass can be handed to the onewire_search PIO program up
+ * front: ow_search_directions() packs 64 preferred bits in two TX words,
+ * the program runs the 64 triplets on its own and pushes the id_bit,
+ * cmp_id_bit pairs as four RX words that ow_search_decode() turns into
+ * the ROM and the state for the next pass.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef OW_SEARCH_H
+#define OW_SEARCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define OW_SEARCH_ROM 0xf0
+#define OW_ALARM_SEARCH 0xec
+
+// FIFO words for one pass: 64 preferred directions, 64 id/cmp pairs
+#define OW_SEARCH_TX_WORDS 2
+#define OW_SEARCH_RX_WORDS 4
+
+// time slots one pass takes after the reset: search command and 64 triplets
+#define OW_SEARCH_PASS_SLOTS (8 + 64 * 3)
+
+#define OW_SCRATCHPAD_LEN 9
+
+typedef struct {
+    uint8_t rom[8];                  // ROM found by the last pass, family code first
+    uint8_t last_discrepancy;        // bit (1-64) of the last 0 taken at a discrepancy
+    uint8_t last_family_discrepancy; // the same within the family code
+    bool last_device;                // the last pass found the last device
+} ow_search_t;
+
+typedef enum {
+    OW_SEARCH_FOUND = 0,
+    OW_SEARCH_NO_DEVICE, // a triplet read 1/1, nobody answered
+    OW_SEARCH_CRC,       // the ROM failed its CRC
+} ow_search_status_t;
+
+typedef enum {
+    OW_TEMP_OK = 0,
+    OW_TEMP_CRC,     // scratchpad CRC mismatch
+    OW_TEMP_NO_DATA, // all 0xff, the device did not answer
+} ow_temp_status_t;
+
+/**
+ * Dallas/Maxim CRC8 (x^8 + x^5 + x^4 + 1, reflected), table driven.
+ * A block followed by its own CRC gives 0.
+ */
+uint8_t ow_crc8(const uint8_t* data, size_t len);
+
+/**
+ * Clear the search state, the next pass finds the first device.
+ */
+void ow_search_init(ow_search_t* s);
+
+/**
+ * Preferred direction for ROM bit `bit` (1-64): the previous ROM's bit
+ * before the last discrepancy, 1 at it, 0 after it.
+ */
+uint8_t ow_search_preferred(const ow_search_t* s, uint32_t bit);
+
+/**
+ * Direction written after reading id_bit and cmp_id_bit, the decision
+ * the PIO program makes for each triplet.
+ */
+uint8_t ow_search_triplet(uint8_t id_bit, uint8_t cmp_id_bit, uint8_t preferred);
+
+/**
+ * Pack the preferred direction of all 64 bits for the next pass,
+ * bit 1 in the LSB of dir[0].
+ */
+void ow_search_directions(const ow_search_t* s, uint32_t dir[OW_SEARCH_TX_WORDS]);
+
+/**
+ * Store triplet `bit` (1-64) read back as RX words would hold it: id_bit
+ * then cmp_id_bit, LSB first. Used when the triplets are run from C.
+ */
+void ow_search_pack(uint32_t rx[OW_SEARCH_RX_WORDS], uint32_t bit, uint8_t id_bit, uint8_t cmp_id_bit);
+
+/**
+ * Decode one pass. On OW_SEARCH_FOUND s->rom holds the device and the
+ * state is set up for the next pass, otherwise the state is cleared.
+ */
+ow_search_status_t ow_search_decode(ow_search_t* s, const uint32_t rx[OW_SEARCH_RX_WORDS]);
+
+/**
+ * Family codes with a DS18x20 style temperature scratchpad.
+ */
+bool ow_temp_family(uint8_t family);
+
+/**
+ * Temperature from a Read Scratchpad reply in 1/16 degree C. The DS18S20
+ * (family 0x10) 0.5 degree reading is extended with COUNT_REMAIN, the
+ * others honour the resolution in the configuration register.
+ */
+ow_temp_status_t ow_temp_decode(uint8_t family, const uint8_t scratchpad[OW_SCRATCHPAD_LEN], int32_t* temp16);
+
+#endif // OW_SEARCH_H
@@ -0,0 +1,290 @@
+/*
+ * pattern.c — Vector tables for the 8 bit parallel pattern generator
+ *
+ * See pattern.h.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include "pattern.h"
+#include <string.h>
+
+/* ── Text compiler ────────────────────────────────────────────────── */
+
+typedef struct {
+    const char* text;
+    size_t len;
+    size_t pos;
+    uint8_t* out;
+    uint32_t cap;
+    uint32_t n;
+    pattern_err_t err;
+    size_t err_pos;
+} pattern_parser_t;
+
+static void pattern_fail(pattern_parser_t* p, pattern_err_t err, size_t pos) {
+    if (p->err == PATTERN_OK) {
+        p->err = err;
+        p->err_pos = pos;
+    }
+}
+
+static bool pattern_is_sep(char c) {
+    return c == ' ' || c == '\t' || c == ',';
+}
+
+static void pattern_skip_sep(pattern_parser_t* p) {
+    while (p->pos < p->len && pattern_is_sep(p->text[p->pos])) {
+        p->pos++;
+    }
+}
+
+static int pattern_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// 0x, 0b or decimal, false if there are no digits or it overflows
+static bool pattern_number(pattern_parser_t* p, uint32_t* value) {
+    uint32_t base = 10;
+    if (p->pos + 1 < p->len && p->text[p->pos] == '0') {
+        char c = p->text[p->pos + 1];
+        if (c == 'x' || c == 'X') {
+            base = 16;
+            p->pos += 2;
+        } else if (c == 'b' || c == 'B') {
+            base = 2;
+            p->pos += 2;
+        }
+    }
+    uint64_t v = 0;
+    size_t start = p->pos;
+    while (p->pos < p->len) {
+        int d = pattern_digit(p->text[p->pos]);
+        if (d < 0 || (uint32_t)d >= base) {
+            break;
+        }
+        v = v * base + (uint32_t)d;
+        if (v > UINT32_MAX) {
+            return false;
+        }
+        p->pos++;
+    }
+    *value = (uint32_t)v;
+    return p->pos > start;
+}
+
+// optional :count after a vector or group, 1 if there is none
+static uint32_t pattern_repeat(pattern_parser_t* p) {
+    if (p->pos >= p->len || p->text[p->pos] != ':') {
+        return 1;
+    }
+    size_t at = p->pos++;
+    uint32_t count;
+    if (!pattern_number(p, &count) || count == 0) {
+        pattern_fail(p, PATTERN_ERR_REPEAT, at);
+        return 0;
+    }
+    return count;
+}
+
+// append the last block samples count - 1 more times
+static void pattern_replicate(pattern_parser_t* p, uint32_t block, uint32_t count, size_t at) {
+    if (count <= 1 || block == 0) {
+        return;
+    }
+    uint64_t total = (uint64_t)block * count;
+    if (p->n - block + total > p->cap) {
+        pattern_fail(p, PATTERN_ERR_FULL, at);
+        return;
+    }
+    uint8_t* src = &p->out[p->n - block];
+    for (uint32_t i = 1; i < count; i++) {
+        memcpy(&p->out[p->n], src, block);
+        p->n += block;
+    }
+}
+
+static void pattern_sequence(pattern_parser_t* p, uint32_t depth) {
+    while (p->err == PATTERN_OK) {
+        pattern_skip_sep(p);
+        if (p->pos >= p->len || p->text[p->pos] == '\0' || p->text[p->pos] == '-') {
+            if (depth) {
+                pattern_fail(p, PATTERN_ERR_GROUP, p->pos);
+            }
+            return;
+        }
+        char c = p->text[p->pos];
+        size_t at = p->pos;
+        if (c == '}') {
+            if (!depth) {
+                pattern_fail(p, PATTERN_ERR_GROUP, at);
+            }
+            return;
+        }
+        if (c == '{') {
+            if (depth >= PATTERN_GROUP_DEPTH) {
+                pattern_fail(p, PATTERN_ERR_GROUP, at);
+                return;
+            }
+            p->pos++;
+            uint32_t start = p->n;
+            pattern_sequence(p, depth + 1);
+            if (p->err != PATTERN_OK) {
+                return;
+            }
+            p->pos++; // the closing brace
+            uint32_t count = pattern_repeat(p);
+            pattern_replicate(p, p->n - start, count, at);
+            continue;
+        }
+        uint32_t value;
+        if (!pattern_number(p, &value)) {
+            pattern_fail(p, PATTERN_ERR_SYNTAX, at);
+            return;
+        }
+        if (value > 0xff) {
+            pattern_fail(p, PATTERN_ERR_VALUE, at);
+            return;
+        }
+        if (p->pos < p->len && !pattern_is_sep(p->text[p->pos]) && p->text[p->pos] != ':' &&
+            p->text[p->pos] != '}' && p->text[p->pos] != '\0') {
+            pattern_fail(p, PATTERN_ERR_SYNTAX, at);
+            return;
+        }
+        uint32_t count = pattern_repeat(p);
+        if (p->n >= p->cap) {
+            pattern_fail(p, PATTERN_ERR_FULL, at);
+            return;
+        }
+        p->out[p->n++] = (uint8_t)value;
+        pattern_replicate(p, 1, count, at);
+    }
+}
+
+const char* pattern_compile(const char* text, size_t len, uint8_t* out, uint32_t cap, pattern_result_t* res) {
+    pattern_parser_t p = { .text = text, .len = len, .out = out, .cap = cap };
+    pattern_sequence(&p, 0);
+    if (p.err == PATTERN_OK && p.n == 0) {
+        pattern_fail(&p, PATTERN_ERR_EMPTY, p.pos);
+    }
+    res->err = p.err;
+    res->pos = p.err_pos;
+    res->len = (p.err == PATTERN_OK) ? p.n : 0;
+    return &text[p.pos];
+}
+
+const char* pattern_error_text(pattern_err_t err) {
+    switch (err) {
+        case PATTERN_OK:
+            return "ok";
+        case PATTERN_ERR_SYNTAX:
+            return "not a vector";
+        case PATTERN_ERR_VALUE:
+            return "vector above 0xff";
+        case PATTERN_ERR_REPEAT:
+            return "bad repeat count";
+        case PATTERN_ERR_GROUP:
+            return "unbalanced { }";
+        case PATTERN_ERR_FULL:
+            return "pattern too long";
+        case PATTERN_ERR_EMPTY:
+            return "no vectors";
+    }
+    return "unknown error";
+}
+
+/* ── Output buffer ────────────────────────────────────────────────── */
+
+bool pattern_layout(uint32_t samples, uint32_t repeats, uint32_t cap, pattern_layout_t* l) {
+    memset(l, 0, sizeof(*l));
+    l->samples = samples;
+    l->repeats = repeats;
+    if (!samples) {
+        return false;
+    }
+    uint64_t total;
+    if (repeats == 0) {
+        // whole words per pass, so the loop restarts on a word boundary
+        uint32_t copies = 1;
+        while (((uint64_t)samples * copies) & 3) {
+            copies++;
+        }
+        l->copies = copies;
+        total = (uint64_t)samples * copies;
+    } else {
+        l->copies = repeats;
+        total = (uint64_t)samples * repeats;
+    }
+    uint64_t bytes = (total + 3) & ~3ull;
+    if (bytes > cap) {
+        return false;
+    }
+    l->bytes = (uint32_t)bytes;
+    l->pad = (uint32_t)(bytes - total);
+    return true;
+}
+
+void pattern_fill(uint8_t* out, const uint8_t* table, const pattern_layout_t* l) {
+    if (out != table) {
+        memmove(out, table, l->samples);
+    }
+    // copy what is already there, doubling each time
+    uint64_t have = l->samples;
+    uint64_t want = (uint64_t)l->samples * l->copies;
+    while (have < want) {
+        uint64_t n = (want - have < have) ? want - have : have;
+        memcpy(&out[have], out, (size_t)n);
+        have += n;
+    }
+    memset(&out[want], out[want - 1], l->pad);
+}
+
+uint32_t pattern_max_repeats(uint32_t samples, uint32_t cap) {
+    return samples ? cap / samples : 0;
+}
+
+/* ── Clock ────────────────────────────────────────────────────────── */
+
+bool pattern_clock(uint32_t sys_hz, uint32_t rate_hz, pattern_clock_t* c) {
+    memset(c, 0, sizeof(*c));
+    if (!rate_hz || rate_hz > sys_hz) {
+        return false;
+    }
+    if (sys_hz % rate_hz == 0) {
+        // exact, no jitter
+        uint32_t cycles = sys_hz / rate_hz;
+        if (cycles <= PATTERN_DIV_INT_MAX) {
+            c->div_int = (uint16_t)cycles;
+        } else {
+            c->slow = true;
+            c->div_int = 1;
+            c->delay = cycles - PATTERN_SLOW_OVERHEAD;
+        }
+        c->actual_hz = rate_hz;
+        return true;
+    }
+    uint64_t div256 = ((uint64_t)sys_hz * 256 + rate_hz / 2) / rate_hz;
+    if (div256 < ((uint64_t)PATTERN_DIV_INT_MAX + 1) * 256) {
+        c->div_int = (uint16_t)(div256 >> 8);
+        c->div_frac = (uint8_t)(div256 & 0xff);
+        c->jitter = c->div_frac != 0;
+        c->actual_hz = (double)sys_hz * 256 / (double)div256;
+        return true;
+    }
+    // slower than the divider reaches, whole cycles are within 15ppm here
+    uint32_t cycles = (uint32_t)(((uint64_t)sys_hz + rate_hz / 2) / rate_hz);
+    c->slow = true;
+    c->div_int = 1;
+    c->delay = cycles - PATTERN_SLOW_OVERHEAD;
+    c->actual_hz = (double)sys_hz / cycles;
+    return true;
+}
@@ -0,0 +1,115 @@
+/*
+ * pattern.h — Vector tables for the 8 bit parallel pattern generator
+ *
+ * A pattern is a table of 8 bit vectors, one per sample, that the wavegen
+ * PIO program writes to IO0-IO7 at a fixed sample rate. The PIO shifts
+ * 8 bits out per sample from 32 bit FIFO words, LSB first, so the table
+ * in memory is simply the samples in order and DMA moves four samples per
+ * word.
+ *
+ * Text vectors (the pattern command line):
+ *
+ *   0x01 0b10 4 255     one sample each, hex, binary or decimal
+ *   0x80:100            hold a vector for 100 samples
+ *   {1 0}:8             repeat a group, groups nest 4 deep
+ *
+ * Commas and spaces separate vectors, a token starting with '-' ends the
+ * list (command flags follow it).
+ *
+ * Layout: DMA reads whole words, so a table that is looped forever is
+ * copied until its length is a multiple of 4 samples (at most 4 copies).
+ * A run of N repeats is expanded N times and padded with the last vector,
+ * which the pins hold after the run anyway.
+ *
+ * Clock: the fast program outputs one sample per PIO cycle, so the clock
+ * divider alone sets the rate (fractional divider, one cycle of jitter,
+ * for rates that do not divide the system clock). Rates too slow for the
+ * 16 bit divider use the slow program, which adds a counted delay loop:
+ * y + 3 cycles per sample.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host
+ * (tests/test_pattern.c).
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define PATTERN_GROUP_DEPTH 4
+// cycles per sample of the slow program's delay loop, y + this
+#define PATTERN_SLOW_OVERHEAD 3
+#define PATTERN_DIV_INT_MAX 65535
+
+typedef enum {
+    PATTERN_OK = 0,
+    PATTERN_ERR_SYNTAX,  // not a number or group
+    PATTERN_ERR_VALUE,   // vector above 0xff
+    PATTERN_ERR_REPEAT,  // repeat count 0 or missing
+    PATTERN_ERR_GROUP,   // unbalanced or too deeply nested { }
+    PATTERN_ERR_FULL,    // more samples than the table holds
+    PATTERN_ERR_EMPTY,   // no vectors
+} pattern_err_t;
+
+typedef struct {
+    pattern_err_t err;
+    size_t pos;     // offset of the error in the text
+    uint32_t len;   // samples in the table
+} pattern_result_t;
+
+/**
+ * Compile text vectors into a table of samples.
+ * @param text  vectors, need not be null terminated
+ * @param len   text length
+ * @param out   sample table
+ * @param cap   table size in samples
+ * @param res   sample count or error and its position
+ * @return pointer to the first character not used (a '-' flag, or the end)
+ */
+const char* pattern_compile(const char* text, size_t len, uint8_t* out, uint32_t cap, pattern_result_t* res);
+
+const char* pattern_error_text(pattern_err_t err);
+
+typedef struct {
+    uint32_t samples;  // samples of the vector table
+    uint32_t repeats;  // 0 = loop forever
+    uint32_t copies;   // table copies in the output buffer
+    uint32_t bytes;    // output buffer bytes, a multiple of 4
+    uint32_t pad;      // last-vector samples added at the end
+} pattern_layout_t;
+
+/**
+ * Work out the output buffer for a table played repeats times (0 = loop).
+ * @return false if it does not fit in cap bytes
+ */
+bool pattern_layout(uint32_t samples, uint32_t repeats, uint32_t cap, pattern_layout_t* l);
+
+/**
+ * Write the output buffer. out may start at the table itself (in place)
+ * as long as it does not start after it.
+ */
+void pattern_fill(uint8_t* out, const uint8_t* table, const pattern_layout_t* l);
+
+// most repeats of a table that fit in cap bytes
+uint32_t pattern_max_repeats(uint32_t samples, uint32_t cap);
+
+typedef struct {
+    bool slow;          // use the delay loop program
+    uint16_t div_int;   // PIO clock divider, 16.8 fixed point
+    uint8_t div_frac;
+    uint32_t delay;     // slow program y, cycles per sample - PATTERN_SLOW_OVERHEAD
+    double actual_hz;   // average sample rate
+    bool jitter;        // fractional divider, samples are one PIO cycle apart or more
+} pattern_clock_t;
+
+/**
+ * Choose the program and divider for a sample rate.
+ * @return false if the rate is above the system clock or 0
+ */
+bool pattern_clock(uint32_t sys_hz, uint32_t rate_hz, pattern_clock_t* c);
+
+#endif // PATTERN_H
@@ -0,0 +1,315 @@
+/*
+ * pd_monitor.c — USB PD sink monitor for the AP33772S: register decoder,
+ *                event state machine and PDO sweep planner
+ *
+ * See pd_monitor.h.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include "pd_monitor.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* ── PDO decoder ───────────────────────────────────────────────────── */
+
+#define PDO_PROGRAMMABLE (1u << 14)
+#define PDO_EPR_FIRST 8
+
+void pd_monitor_pdo_decode(uint8_t index, uint16_t raw, pd_pdo_t* pdo) {
+    memset(pdo, 0, sizeof(*pdo));
+    if (!raw) {
+        return;
+    }
+    bool epr = index >= PDO_EPR_FIRST;
+    uint8_t code = (raw >> 10) & 0x0f;
+    uint8_t field = (raw >> 8) & 0x03;
+    pdo->max_mv = (raw & 0xff) * (epr ? 200 : 100);
+    // CURRENT_SEL 0 is anything below 1.25A, then 250mA steps, 15 is 5A
+    pdo->ma = code == 15 ? 5000 : code ? 1250 + (code - 1) * 250 : 1000;
+    if (!(raw & PDO_PROGRAMMABLE)) {
+        pdo->type = PD_PDO_FIXED;
+        pdo->min_mv = pdo->max_mv;
+        return;
+    }
+    pdo->type = epr ? PD_PDO_AVS : PD_PDO_PPS;
+    // code 2 is "above the floor, up to the next step", take the step to be safe
+    if (epr) {
+        pdo->min_mv = field == 2 ? 20000 : 15000;
+    } else {
+        pdo->min_mv = field == 2 ? 5000 : 3300;
+    }
+}
+
+/* ── Event ring ────────────────────────────────────────────────────── */
+
+void pd_monitor_init(pd_monitor_t* m, pd_event_t* ring, uint32_t events, uint16_t vbus_mv, uint16_t ibus_ma,
+                     uint32_t timeout_ms) {
+    memset(m, 0, sizeof(*m));
+    m->ring = ring;
+    m->mask = events - 1;
+    m->vbus_step_mv = vbus_mv;
+    m->ibus_step_ma = ibus_ma;
+    m->timeout_ms = timeout_ms;
+    m->first = true;
+}
+
+static void pd_monitor_event(pd_monitor_t* m, uint32_t time_ms, pd_event_type_t type, uint8_t index, uint16_t raw,
+                             uint16_t mv, uint16_t ma) {
+    if (m->head - m->tail > m->mask) {
+        m->lost++;
+        return;
+    }
+    m->ring[m->head & m->mask] = (pd_event_t){
+        .time_ms = time_ms,
+        .type = type,
+        .index = index,
+        .raw = raw,
+        .mv = mv,
+        .ma = ma,
+    };
+    m->head++;
+}
+
+bool pd_monitor_pop(pd_monitor_t* m, pd_event_t* ev) {
+    if (m->head == m->tail) {
+        return false;
+    }
+    *ev = m->ring[m->tail & m->mask];
+    m->tail++;
+    return true;
+}
+
+/* ── State machine ─────────────────────────────────────────────────── */
+
+uint8_t pd_monitor_plan(const pd_monitor_t* m, uint8_t status) {
+    uint8_t read = PD_READ_TELEMETRY;
+    if (m->first || (status & PD_STATUS_NEWPDO)) {
+        read |= PD_READ_PDO;
+    }
+    if (m->first || (status & (PD_STATUS_READY | PD_STATUS_NEWPDO)) || m->contract_due || m->pending) {
+        read |= PD_READ_CONTRACT;
+    }
+    if (m->pending) {
+        read |= PD_READ_RESULT;
+    }
+    return read;
+}
+
+static uint16_t pd_monitor_diff(uint16_t a, uint16_t b) {
+    return a > b ? a - b : b - a;
+}
+
+static void pd_monitor_pdos(pd_monitor_t* m, const uint8_t* block, uint32_t time_ms) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < PD_MONITOR_PDOS; i++) {
+        m->pdo_raw[i] = block[i * 2] | (block[i * 2 + 1] << 8);
+        if (m->pdo_raw[i]) {
+            count = i + 1;
+        }
+    }
+    m->pdos = count;
+    pd_monitor_event(m, time_ms, PD_EV_CAPS, count, 0, 0, 0);
+    for (uint8_t i = 0; i < count; i++) {
+        if (!m->pdo_raw[i]) {
+            continue;
+        }
+        pd_pdo_t pdo;
+        pd_monitor_pdo_decode(i + 1, m->pdo_raw[i], &pdo);
+        pd_monitor_event(m, time_ms, PD_EV_PDO, i + 1, m->pdo_raw[i], pdo.max_mv, pdo.ma);
+    }
+}
+
+void pd_monitor_update(pd_monitor_t* m, const pd_monitor_regs_t* r, uint32_t time_ms) {
+    if (r->status & PD_STATUS_STARTED) {
+        pd_monitor_event(m, time_ms, PD_EV_STARTED, 0, 0, 0, 0);
+    }
+    uint8_t source = (r->opmode & PD_OPMODE_PDMOD) ? 2 : (r->opmode & PD_OPMODE_LGCYMOD) ? 1 : 0;
+    if (m->first || source != m->source) {
+        pd_monitor_event(m, time_ms, PD_EV_SOURCE, 0, source, 0, 0);
+        if (!source) {
+            // nobody left to answer
+            m->pending = false;
+        }
+        m->source = source;
+    }
+    if (r->status & PD_STATUS_READY) {
+        pd_monitor_event(m, time_ms, PD_EV_READY, 0, 0, 0, 0);
+    }
+    // the faults are latched, each one read is a new trip
+    m->faults = r->status & PD_STATUS_FAULTS;
+    if (m->faults) {
+        pd_monitor_event(m, time_ms, PD_EV_FAULT, 0, m->faults, 0, 0);
+    }
+    if (r->read & PD_READ_PDO) {
+        pd_monitor_pdos(m, r->pdo, time_ms);
+    }
+
+    if (m->pending && (r->read & PD_READ_RESULT) && r->result != PD_RESULT_PENDING) {
+        pd_event_type_t type = r->result == PD_RESULT_ACCEPTED   ? PD_EV_ACCEPT
+                               : r->result == PD_RESULT_REJECTED ? PD_EV_REJECT
+                                                                 : PD_EV_FAIL;
+        pd_monitor_event(m, time_ms, type, 0, r->result, 0, 0);
+        m->pending = false;
+        m->last_result = r->result;
+        m->contract_due = true;
+    } else if (m->pending && time_ms - m->request_ms >= m->timeout_ms) {
+        pd_monitor_event(m, time_ms, PD_EV_TIMEOUT, 0, 0, 0, 0);
+        m->pending = false;
+        m->last_result = PD_RESULT_FAILED;
+    }
+
+    if (r->read & PD_READ_CONTRACT) {
+        uint16_t mv = r->vreq * PD_VREQ_LSB_MV;
+        uint16_t ma = r->ireq * PD_IREQ_LSB_MA;
+        if (m->first || mv != m->vreq_mv || ma != m->ireq_ma) {
+            pd_monitor_event(m, time_ms, PD_EV_CONTRACT, 0, 0, mv, ma);
+            m->vreq_mv = mv;
+            m->ireq_ma = ma;
+        }
+        if (!m->pending) {
+            m->contract_due = false;
+        }
+    }
+
+    if (r->read & PD_READ_TELEMETRY) {
+        uint16_t mv = r->voltage * PD_VOLTAGE_LSB_MV;
+        uint16_t ma = r->current * PD_CURRENT_LSB_MA;
+        if (m->first || pd_monitor_diff(mv, m->vbus_mv) >= m->vbus_step_mv) {
+            pd_monitor_event(m, time_ms, PD_EV_VBUS, 0, 0, mv, 0);
+            m->vbus_mv = mv;
+        }
+        if (m->first || pd_monitor_diff(ma, m->ibus_ma) >= m->ibus_step_ma) {
+            pd_monitor_event(m, time_ms, PD_EV_IBUS, 0, 0, 0, ma);
+            m->ibus_ma = ma;
+        }
+        m->temp = r->temp;
+    }
+    m->first = false;
+}
+
+void pd_monitor_request(pd_monitor_t* m, uint8_t index, uint16_t mv, uint16_t ma, uint32_t time_ms) {
+    pd_monitor_event(m, time_ms, PD_EV_REQUEST, index, 0, mv, ma);
+    m->pending = true;
+    m->request_ms = time_ms;
+    m->last_result = PD_RESULT_PENDING;
+}
+
+/* ── Text ──────────────────────────────────────────────────────────── */
+
+static const char* const pdo_type_names[] = {
+    [PD_PDO_NONE] = "none",
+    [PD_PDO_FIXED] = "fixed",
+    [PD_PDO_PPS] = "PPS",
+    [PD_PDO_AVS] = "AVS",
+};
+
+static const char* const source_names[] = { "detached", "legacy", "PD" };
+
+int pd_monitor_event_str(const pd_event_t* ev, char* buf, size_t len) {
+    switch (ev->type) {
+        case PD_EV_STARTED:
+            return snprintf(buf, len, "started");
+        case PD_EV_READY:
+            return snprintf(buf, len, "ready");
+        case PD_EV_SOURCE:
+            return snprintf(buf, len, "source %s", source_names[ev->raw < 3 ? ev->raw : 0]);
+        case PD_EV_CAPS:
+            return snprintf(buf, len, "source offers %d PDOs", ev->index);
+        case PD_EV_PDO: {
+            pd_pdo_t pdo;
+            pd_monitor_pdo_decode(ev->index, ev->raw, &pdo);
+            if (pdo.type == PD_PDO_FIXED) {
+                return snprintf(buf, len, "PDO %d fixed %d mV %d mA", ev->index, pdo.max_mv, pdo.ma);
+            }
+            return snprintf(buf,
+                            len,
+                            "PDO %d %s %d-%d mV %d mA",
+                            ev->index,
+                            pdo_type_names[pdo.type],
+                            pdo.min_mv,
+                            pdo.max_mv,
+                            pdo.ma);
+        }
+        case PD_EV_REQUEST:
+            return snprintf(buf, len, "request PDO %d %d mV %d mA", ev->index, ev->mv, ev->ma);
+        case PD_EV_ACCEPT:
+            return snprintf(buf, len, "accepted");
+        case PD_EV_REJECT:
+            return snprintf(buf, len, "rejected");
+        case PD_EV_FAIL:
+            return snprintf(buf, len, "failed (PD_MSGRLT 0x%02x)", ev->raw);
+        case PD_EV_TIMEOUT:
+            return snprintf(buf, len, "no answer to the request");
+        case PD_EV_CONTRACT:
+            return snprintf(buf, len, "contract %d mV %d mA", ev->mv, ev->ma);
+        case PD_EV_VBUS:
+            return snprintf(buf, len, "VBUS %d mV", ev->mv);
+        case PD_EV_IBUS:
+            return snprintf(buf, len, "IBUS %d mA", ev->ma);
+        case PD_EV_FAULT:
+            return snprintf(buf,
+                            len,
+                            "fault%s%s%s%s",
+                            (ev->raw & PD_STATUS_UVP) ? " UVP" : "",
+                            (ev->raw & PD_STATUS_OVP) ? " OVP" : "",
+                            (ev->raw & PD_STATUS_OCP) ? " OCP" : "",
+                            (ev->raw & PD_STATUS_OTP) ? " OTP" : "");
+        default:
+            return snprintf(buf, len, "event %d", ev->type);
+    }
+}
+
+/* ── PDO sweep ─────────────────────────────────────────────────────── */
+
+void pd_sweep_init(pd_sweep_t* s, const uint16_t* raw, uint8_t count, uint16_t step_mv) {
+    memset(s, 0, sizeof(*s));
+    s->count = count > PD_MONITOR_PDOS ? PD_MONITOR_PDOS : count;
+    s->step_mv = step_mv ? step_mv : 1000;
+    for (uint8_t i = 0; i < s->count; i++) {
+        pd_monitor_pdo_decode(i + 1, raw[i], &s->pdo[i]);
+    }
+}
+
+bool pd_sweep_next(pd_sweep_t* s, pd_sweep_step_t* step) {
+    while (s->index < s->count && s->pdo[s->index].type == PD_PDO_NONE) {
+        s->index++;
+    }
+    if (s->index >= s->count) {
+        return false;
+    }
+    const pd_pdo_t* pdo = &s->pdo[s->index];
+    step->index = s->index + 1;
+    step->type = pdo->type;
+    step->ma = pdo->ma;
+    if (pdo->type == PD_PDO_FIXED) {
+        step->mv = pdo->max_mv;
+        s->index++;
+        return true;
+    }
+    // PPS asks in 100mV, AVS in 200mV
+    uint16_t unit = pdo->type == PD_PDO_AVS ? 200 : 100;
+    step->mv = s->mv ? s->mv : pdo->min_mv;
+    step->mv -= step->mv % unit;
+    if (step->mv < pdo->min_mv) {
+        step->mv += unit;
+    }
+    if (step->mv >= pdo->max_mv) {
+        step->mv = pdo->max_mv;
+        s->index++;
+        s->mv = 0;
+    } else {
+        s->mv = step->mv + s->step_mv;
+        // the last step is always the top of the range
+        if (s->mv > pdo->max_mv) {
+            s->mv = pdo->max_mv;
+        }
+    }
+    return true;
+}
+
+bool pd_sweep_check(const pd_sweep_step_t* step, uint16_t vbus_mv) {
+    uint16_t tolerance = step->mv * 5 / 100 + PD_VOLTAGE_LSB_MV;
+    return pd_monitor_diff(vbus_mv, step->mv) <= tolerance;
+}
@@ -0,0 +1,222 @@
+/*
+ * pd_monitor.h — USB PD sink monitor for the AP33772S: register decoder,
+ *                event state machine and PDO sweep planner
+ *
+ * The AP33772S latches what happened (STARTED, READY, NEWPDO and the
+ * UVP/OVP/OCP/OTP faults) in STATUS, which clears when read. One poll
+ * reads STATUS and OPMODE, then pd_monitor_plan() says which other
+ * registers are worth a transaction this time:
+ *
+ *   PD_READ_PDO       the 26 byte SRCPDO block, after NEWPDO (one read)
+ *   PD_READ_CONTRACT  VREQ and IREQ, after READY, NEWPDO or a request
+ *   PD_READ_RESULT    PD_MSGRLT, while a request waits for an answer
+ *   PD_READ_TELEMETRY VOLTAGE, CURRENT and TEMP, every poll
+ *
+ * pd_monitor_update() compares the snapshot with what it saw last and
+ * puts timestamped events in a ring: source attach/detach, the PDO list,
+ * request/accept/reject/fail/timeout, the negotiated contract, VBUS and
+ * current moves beyond a step, and faults. A full ring drops the new
+ * event and counts it.
+ *
+ * The sweep planner walks every PDO the source offers: fixed PDOs once,
+ * PPS and AVS from the minimum to the maximum voltage in steps, each at
+ * the PDO's current. pd_sweep_check() says if the measured VBUS is within
+ * the 5% a source is allowed (plus one 80mV ADC step).
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host
+ * (tests/test_pd_monitor.c).
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef PD_MONITOR_H
+#define PD_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define PD_MONITOR_PDOS 13 // 7 SPR, 6 EPR
+
+// STATUS bits
+#define PD_STATUS_STARTED (1u << 0)
+#define PD_STATUS_READY (1u << 1)
+#define PD_STATUS_NEWPDO (1u << 2)
+#define PD_STATUS_UVP (1u << 3)
+#define PD_STATUS_OVP (1u << 4)
+#define PD_STATUS_OCP (1u << 5)
+#define PD_STATUS_OTP (1u << 6)
+#define PD_STATUS_FAULTS (PD_STATUS_UVP | PD_STATUS_OVP | PD_STATUS_OCP | PD_STATUS_OTP)
+
+// OPMODE source bits
+#define PD_OPMODE_LGCYMOD (1u << 0)
+#define PD_OPMODE_PDMOD (1u << 1)
+
+// PD_MSGRLT
+#define PD_RESULT_PENDING 0x00
+#define PD_RESULT_ACCEPTED 0x01
+#define PD_RESULT_REJECTED 0x02
+#define PD_RESULT_FAILED 0x03
+
+// register LSBs
+#define PD_VOLTAGE_LSB_MV 80
+#define PD_CURRENT_LSB_MA 24
+#define PD_VREQ_LSB_MV 50
+#define PD_IREQ_LSB_MA 10
+
+// what a poll read besides STATUS and OPMODE
+#define PD_READ_TELEMETRY (1u << 0)
+#define PD_READ_CONTRACT (1u << 1)
+#define PD_READ_PDO (1u << 2)
+#define PD_READ_RESULT (1u << 3)
+
+typedef enum {
+    PD_PDO_NONE = 0,
+    PD_PDO_FIXED,
+    PD_PDO_PPS,
+    PD_PDO_AVS,
+} pd_pdo_type_t;
+
+typedef struct {
+    pd_pdo_type_t type;
+    uint16_t min_mv; // fixed: the voltage
+    uint16_t max_mv;
+    uint16_t ma;     // start of the current code's range, what a request asks for
+} pd_pdo_t;
+
+typedef enum {
+    PD_EV_STARTED = 0,
+    PD_EV_READY,
+    PD_EV_SOURCE,   // raw: 0 detached, 1 legacy, 2 PD
+    PD_EV_CAPS,     // index: PDO count
+    PD_EV_PDO,      // index, raw, mv (max), ma
+    PD_EV_REQUEST,  // index, mv, ma
+    PD_EV_ACCEPT,
+    PD_EV_REJECT,
+    PD_EV_FAIL,
+    PD_EV_TIMEOUT,
+    PD_EV_CONTRACT, // mv, ma negotiated
+    PD_EV_VBUS,     // mv
+    PD_EV_IBUS,     // ma
+    PD_EV_FAULT,    // raw: STATUS fault bits
+    PD_EV_COUNT,
+} pd_event_type_t;
+
+typedef struct {
+    uint32_t time_ms;
+    uint8_t type;
+    uint8_t index;
+    uint16_t raw;
+    uint16_t mv;
+    uint16_t ma;
+} pd_event_t;
+
+typedef struct {
+    uint8_t read;    // PD_READ_* held below
+    uint8_t status;
+    uint8_t opmode;
+    uint8_t current; // CURRENT, 24mA
+    uint16_t voltage; // VOLTAGE, 80mV
+    uint8_t temp;    // TEMP, C
+    uint8_t result;  // PD_MSGRLT
+    uint16_t vreq;   // VREQ, 50mV
+    uint16_t ireq;   // IREQ, 10mA
+    uint8_t pdo[PD_MONITOR_PDOS * 2]; // SRCPDO, little endian
+} pd_monitor_regs_t;
+
+typedef struct {
+    // event ring
+    pd_event_t* ring;
+    uint32_t mask;
+    uint32_t head, tail;
+    uint32_t lost;
+    // settings
+    uint16_t vbus_step_mv;
+    uint16_t ibus_step_ma;
+    uint32_t timeout_ms;
+    // what was seen
+    bool first;
+    uint8_t source;  // 0 detached, 1 legacy, 2 PD
+    uint16_t vbus_mv, ibus_ma; // last reported
+    uint16_t vreq_mv, ireq_ma;
+    uint8_t temp;
+    uint8_t faults;
+    uint16_t pdo_raw[PD_MONITOR_PDOS];
+    uint8_t pdos;
+    // request in flight
+    bool pending;
+    bool contract_due;
+    uint32_t request_ms;
+    uint8_t last_result;
+} pd_monitor_t;
+
+/**
+ * Decode one PDO register.
+ * @param index  1 based, 8 and up are EPR
+ */
+void pd_monitor_pdo_decode(uint8_t index, uint16_t raw, pd_pdo_t* pdo);
+
+/**
+ * @param ring     events, a power of 2
+ * @param vbus_mv  VBUS move that makes an event
+ * @param ibus_ma  current move that makes an event
+ */
+void pd_monitor_init(pd_monitor_t* m, pd_event_t* ring, uint32_t events, uint16_t vbus_mv, uint16_t ibus_ma,
+                     uint32_t timeout_ms);
+
+/**
+ * Registers worth reading this poll, given the STATUS just read.
+ */
+uint8_t pd_monitor_plan(const pd_monitor_t* m, uint8_t status);
+
+/**
+ * Turn a poll into events.
+ */
+void pd_monitor_update(pd_monitor_t* m, const pd_monitor_regs_t* r, uint32_t time_ms);
+
+/**
+ * Log a request the sink is about to send, the result is watched for.
+ */
+void pd_monitor_request(pd_monitor_t* m, uint8_t index, uint16_t mv, uint16_t ma, uint32_t time_ms);
+
+/**
+ * Next event, false if there are none.
+ */
+bool pd_monitor_pop(pd_monitor_t* m, pd_event_t* ev);
+
+/**
+ * One line description, no time.
+ * @return characters written
+ */
+int pd_monitor_event_str(const pd_event_t* ev, char* buf, size_t len);
+
+/* ── PDO sweep ───────────────────────────────────────────────────── */
+
+typedef struct {
+    uint8_t index; // 1 based
+    pd_pdo_type_t type;
+    uint16_t mv;
+    uint16_t ma;
+} pd_sweep_step_t;
+
+typedef struct {
+    pd_pdo_t pdo[PD_MONITOR_PDOS];
+    uint8_t count;
+    uint16_t step_mv;
+    uint8_t index; // next PDO, 0 based
+    uint16_t mv;   // next voltage inside a programmable PDO, 0 to start it
+} pd_sweep_t;
+
+void pd_sweep_init(pd_sweep_t* s, const uint16_t* raw, uint8_t count, uint16_t step_mv);
+
+/**
+ * @return false when every PDO has been stepped through
+ */
+bool pd_sweep_next(pd_sweep_t* s, pd_sweep_step_t* step);
+
+/**
+ * Is the measured VBUS what the step asked for.
+ */
+bool pd_sweep_check(const pd_sweep_step_t* step, uint16_t vbus_mv);
+
+#endif // PD_MONITOR_H
@@ -16,7 +16,8 @@ Changed by: Ian Lesnet, 2024 Where Labs LLC for Bus Pirate 5
 
 static struct _pio_config pio_config;
 
-#define DUMP_COMMANDS
+// prints every transfer to the terminal, far slower than the transfers themselves
+//#define DUMP_COMMANDS
 
 // WCH-specific debug interface config registers
 static const int WCH_DM_CPBR     = 0x7C;
@@ -0,0 +1,221 @@
+/*
+ * psu_log.c — PSU data logger: block reducer, record ring and file format
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <string.h>
+#include "psu_log.h"
+
+// the producer is an interrupt on the consumer's core, keep the compiler in order
+#define PSU_LOG_BARRIER() __asm__ volatile("" ::: "memory")
+
+void psu_log_ring_init(psu_log_ring_t* r, uint8_t* buf, uint32_t size) {
+    r->buf = buf;
+    r->size = size;
+    r->head = 0;
+    r->tail = 0;
+    r->lost = 0;
+    r->lost_pending = false;
+}
+
+uint32_t psu_log_ring_level(const psu_log_ring_t* r) {
+    return r->head - r->tail;
+}
+
+bool psu_log_ring_put(psu_log_ring_t* r, const void* data, uint32_t len) {
+    uint32_t head = r->head;
+    if (r->size - (head - r->tail) < len) {
+        return false;
+    }
+    uint32_t offset = head & (r->size - 1);
+    uint32_t first = r->size - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&r->buf[offset], data, first);
+    memcpy(r->buf, (const uint8_t*)data + first, len - first);
+    PSU_LOG_BARRIER();
+    r->head = head + len;
+    return true;
+}
+
+bool psu_log_ring_drain(psu_log_ring_t* r, uint32_t chunk, psu_log_write_t write, void* ctx) {
+    uint32_t level = psu_log_ring_level(r);
+    uint32_t todo = level - (level % chunk);
+    PSU_LOG_BARRIER();
+    while (todo) {
+        uint32_t offset = r->tail & (r->size - 1);
+        uint32_t len = r->size - offset;
+        if (len > todo) {
+            len = todo;
+        }
+        uint32_t taken = write(ctx, &r->buf[offset], len);
+        PSU_LOG_BARRIER();
+        r->tail += taken;
+        if (taken < len) {
+            return false;
+        }
+        todo -= len;
+    }
+    return true;
+}
+
+void psu_log_header_init(psu_log_header_t* h, uint32_t pair_ns, uint32_t block_pairs, float vout_scale, float current_scale) {
+    memset(h, 0, sizeof(*h));
+    h->magic = PSU_LOG_MAGIC;
+    h->version = PSU_LOG_VERSION;
+    h->record_size = sizeof(psu_log_record_t);
+    h->pair_ns = pair_ns;
+    h->block_pairs = block_pairs;
+    h->vout_scale = vout_scale;
+    h->current_scale = current_scale;
+}
+
+static void psu_log_block_clear(psu_log_reduce_t* r) {
+    r->position = 0;
+    r->pairs = 0;
+    r->vout_min = 0xffff;
+    r->vout_max = 0;
+    r->current_min = 0xffff;
+    r->current_max = 0;
+    r->vout_sum = 0;
+    r->current_sum = 0;
+    r->power_sum = 0;
+    r->flags = 0;
+}
+
+void psu_log_reduce_init(psu_log_reduce_t* r,
+                         psu_log_ring_t* out,
+                         uint32_t block_pairs,
+                         uint32_t pair_ns,
+                         float vout_scale,
+                         float current_scale,
+                         uint16_t settle) {
+    r->out = out;
+    r->block_pairs = block_pairs ? block_pairs : 1;
+    r->energy_scale = vout_scale * current_scale * (float)pair_ns;
+    r->settle = settle;
+    r->vout_pending = false;
+    r->skip = 0;
+    r->records = 0;
+    r->energy_nj = 0;
+    r->vout_low = 0xffff;
+    r->vout_high = 0;
+    r->current_low = 0xffff;
+    r->current_high = 0;
+    psu_log_block_clear(r);
+}
+
+static uint16_t psu_log_mean(uint32_t sum, uint32_t pairs) {
+    return (uint16_t)((((uint64_t)sum << PSU_LOG_MEAN_SHIFT) + pairs / 2) / pairs);
+}
+
+static void psu_log_emit(psu_log_reduce_t* r) {
+    psu_log_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.pairs = (uint16_t)r->pairs;
+    rec.flags = r->flags;
+    if (r->pairs) {
+        rec.vout_min = r->vout_min;
+        rec.vout_max = r->vout_max;
+        rec.vout_mean = psu_log_mean(r->vout_sum, r->pairs);
+        rec.current_min = r->current_min;
+        rec.current_max = r->current_max;
+        rec.current_mean = psu_log_mean(r->current_sum, r->pairs);
+        // mean power of the sampled pairs over the whole block
+        float energy = (float)r->power_sum * r->energy_scale * ((float)r->position / (float)r->pairs);
+        rec.energy_nj = (energy >= 4294967295.0f) ? 0xffffffff : (uint32_t)(energy + 0.5f);
+        if (r->vout_min < r->vout_low) {
+            r->vout_low = r->vout_min;
+        }
+        if (r->vout_max > r->vout_high) {
+            r->vout_high = r->vout_max;
+        }
+        if (r->current_min < r->current_low) {
+            r->current_low = r->current_min;
+        }
+        if (r->current_max > r->current_high) {
+            r->current_high = r->current_max;
+        }
+    }
+    r->energy_nj += rec.energy_nj;
+    r->records++;
+
+    psu_log_ring_t* out = r->out;
+    if (out->lost_pending) {
+        rec.flags |= PSU_LOG_LOST;
+    }
+    if (psu_log_ring_put(out, &rec, sizeof(rec))) {
+        out->lost_pending = false;
+    } else {
+        out->lost++;
+        out->lost_pending = true;
+    }
+    psu_log_block_clear(r);
+}
+
+void psu_log_reduce_process(psu_log_reduce_t* r, const uint16_t* ring, uint32_t ring_len, uint32_t first, uint32_t count) {
+    uint32_t mask = ring_len - 1;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t slot = (first + i) & mask;
+        uint16_t sample = ring[slot];
+        if (!(slot & 1)) {
+            r->vout = sample;
+            r->vout_pending = true;
+            continue;
+        }
+        if (!r->vout_pending) {
+            continue; // current without its VOUT after a restart
+        }
+        r->vout_pending = false;
+        r->position++;
+        if (r->skip) {
+            r->skip--;
+            r->flags |= PSU_LOG_GAP;
+        } else {
+            uint16_t vout = r->vout;
+            if (vout < r->vout_min) {
+                r->vout_min = vout;
+            }
+            if (vout > r->vout_max) {
+                r->vout_max = vout;
+            }
+            if (sample < r->current_min) {
+                r->current_min = sample;
+            }
+            if (sample > r->current_max) {
+                r->current_max = sample;
+            }
+            r->vout_sum += vout;
+            r->current_sum += sample;
+            r->power_sum += (uint32_t)vout * sample;
+            r->pairs++;
+        }
+        if (r->position >= r->block_pairs) {
+            psu_log_emit(r);
+        }
+    }
+}
+
+void psu_log_reduce_gap(psu_log_reduce_t* r, uint32_t missed_pairs) {
+    r->vout_pending = false;
+    while (missed_pairs) {
+        uint32_t left = r->block_pairs - r->position;
+        uint32_t step = (missed_pairs < left) ? missed_pairs : left;
+        r->position += step;
+        r->flags |= PSU_LOG_GAP;
+        missed_pairs -= step;
+        if (r->position >= r->block_pairs) {
+            psu_log_emit(r);
+        }
+    }
+    // the pairs skipped while settling are part of the gap
+    r->skip = r->settle;
+}
+
+void psu_log_reduce_flush(psu_log_reduce_t* r) {
+    if (r->position) {
+        psu_log_emit(r);
+    }
+}
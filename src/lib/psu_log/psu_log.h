@@ -0,0 +1,159 @@
+/*
+ * psu_log.h — PSU data logger: block reducer, record ring and file format
+ *
+ * The PSU guard free-runs the ADC in round robin on VOUT and the current
+ * sense input, even ring slots are VOUT and odd slots current (see
+ * lib/psu_trip). While logging, every VOUT/current pair also goes through
+ * psu_log_reduce_process(), which folds a block of pairs into one record:
+ * min, max and mean of each channel and the energy delivered in the block.
+ *
+ * Records have a fixed time base: record n covers pairs
+ * [n * block_pairs, (n + 1) * block_pairs). Time the ADC was lent to
+ * someone else is passed to psu_log_reduce_gap(), records that lost pairs
+ * carry PSU_LOG_GAP, fewer `pairs`, and the energy of the sampled pairs
+ * scaled to the whole block.
+ *
+ * Records go into a byte ring (interrupt producer, main loop consumer on
+ * the same core) and psu_log_ring_drain() hands them to the sink in whole
+ * chunks. With a chunk that divides the ring size every write is one
+ * contiguous, chunk aligned block: the file sink writes whole NAND
+ * sectors straight from the ring.
+ *
+ * File: psu_log_header_t, then records back to back. The header is
+ * rewritten with the record and lost counts when the log is closed.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef PSU_LOG_H
+#define PSU_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PSU_LOG_MAGIC 0x4c504250u // "BPPL" little endian
+#define PSU_LOG_VERSION 1
+
+// record flags
+#define PSU_LOG_GAP (1u << 0)  // sampling paused in this block, energy scaled up
+#define PSU_LOG_LOST (1u << 1) // the ring was full, records before this one are missing
+
+// the mean is in 1/16 counts
+#define PSU_LOG_MEAN_SHIFT 4
+
+typedef struct __attribute__((packed)) {
+    uint16_t vout_min;
+    uint16_t vout_mean; // 1/16 counts
+    uint16_t vout_max;
+    uint16_t current_min;
+    uint16_t current_mean; // 1/16 counts
+    uint16_t current_max;
+    uint16_t pairs; // pairs sampled, block_pairs unless PSU_LOG_GAP
+    uint16_t flags; // PSU_LOG_* bits
+    uint32_t energy_nj;
+} psu_log_record_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t pair_ns;     // time between samples of one channel
+    uint32_t block_pairs; // pairs per record
+    float vout_scale;     // volts per VOUT count
+    float current_scale;  // amps per current count
+    uint32_t records;     // records in the file, written at close
+    uint32_t lost;        // records lost to a full ring, written at close
+} psu_log_header_t;
+
+typedef struct {
+    uint8_t* buf;
+    uint32_t size;          // power of 2
+    volatile uint32_t head; // bytes put, producer only
+    volatile uint32_t tail; // bytes drained, consumer only
+    uint32_t lost;          // records dropped because the ring was full
+    bool lost_pending;      // flag the next record
+} psu_log_ring_t;
+
+typedef struct {
+    uint32_t block_pairs;
+    float energy_scale; // nJ per VOUT count * current count pair
+    uint16_t settle;    // pairs skipped after a gap while the AMUX settles
+    psu_log_ring_t* out;
+    // block state
+    uint32_t position; // pairs elapsed in this block, sampled or not
+    uint32_t pairs;
+    uint16_t vout_min, vout_max, current_min, current_max;
+    uint32_t vout_sum, current_sum;
+    uint64_t power_sum; // sum of vout * current counts
+    uint16_t flags;
+    // stream state
+    uint16_t vout;     // VOUT waiting for its current sample
+    bool vout_pending;
+    uint16_t skip;     // settle pairs still to skip
+    // session totals
+    uint32_t records;
+    uint64_t energy_nj;
+    uint16_t vout_low, vout_high, current_low, current_high;
+} psu_log_reduce_t;
+
+/**
+ * Sink for psu_log_ring_drain(), returns the bytes it took. Taking fewer
+ * (a write error, a full USB FIFO) stops the drain, the rest stays queued.
+ */
+typedef uint32_t (*psu_log_write_t)(void* ctx, const uint8_t* data, uint32_t len);
+
+void psu_log_ring_init(psu_log_ring_t* r, uint8_t* buf, uint32_t size);
+
+/**
+ * Put `len` bytes, all or nothing. Used for the header and by the reducer.
+ * @return false if the ring is full
+ */
+bool psu_log_ring_put(psu_log_ring_t* r, const void* data, uint32_t len);
+
+uint32_t psu_log_ring_level(const psu_log_ring_t* r);
+
+/**
+ * Write out the queued bytes in whole `chunk`s, 1 for everything.
+ * @return false if the sink took less than it was given
+ */
+bool psu_log_ring_drain(psu_log_ring_t* r, uint32_t chunk, psu_log_write_t write, void* ctx);
+
+/**
+ * @param pair_ns        time between samples of one channel
+ * @param vout_scale     volts per VOUT count
+ * @param current_scale  amps per current count
+ */
+void psu_log_header_init(psu_log_header_t* h, uint32_t pair_ns, uint32_t block_pairs, float vout_scale, float current_scale);
+
+/**
+ * @param block_pairs  pairs per record, 1 to 65535
+ * @param settle       pairs skipped after a gap
+ */
+void psu_log_reduce_init(psu_log_reduce_t* r,
+                         psu_log_ring_t* out,
+                         uint32_t block_pairs,
+                         uint32_t pair_ns,
+                         float vout_scale,
+                         float current_scale,
+                         uint16_t settle);
+
+/**
+ * Reduce `count` new samples starting at ring slot `first`.
+ * @param ring_len  ring length in samples, a power of 2
+ */
+void psu_log_reduce_process(psu_log_reduce_t* r, const uint16_t* ring, uint32_t ring_len, uint32_t first, uint32_t count);
+
+/**
+ * Sampling stopped for `missed_pairs` pair periods and restarts on VOUT.
+ * Completes the blocks that ended during the gap.
+ */
+void psu_log_reduce_gap(psu_log_reduce_t* r, uint32_t missed_pairs);
+
+/**
+ * Emit the partly filled block at the end of the log.
+ */
+void psu_log_reduce_flush(psu_log_reduce_t* r);
+
+#endif // PSU_LOG_H
@@ -0,0 +1,66 @@
+/*
+ * psu_trip.c — PSU fault comparator for the ADC sample ring
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include "psu_trip.h"
+
+void psu_trip_init(psu_trip_t* t, uint16_t current_limit, uint16_t vout_limit, uint8_t debounce, uint16_t vout_settle) {
+    t->current_limit = current_limit;
+    t->vout_limit = vout_limit;
+    t->debounce = debounce ? debounce : 1;
+    t->vout_settle = vout_settle;
+    t->tripped = 0;
+    t->vout_hold = false;
+    psu_trip_restart(t);
+}
+
+void psu_trip_restart(psu_trip_t* t) {
+    t->current_count = 0;
+    t->vout_count = 0;
+    t->vout_skip = t->vout_settle;
+}
+
+void psu_trip_vout_hold(psu_trip_t* t, bool hold) {
+    t->vout_hold = hold;
+    t->vout_count = 0;
+    t->vout_skip = t->vout_settle;
+}
+
+uint8_t psu_trip_process(psu_trip_t* t, const uint16_t* ring, uint32_t ring_len, uint32_t first, uint32_t count) {
+    uint32_t mask = ring_len - 1;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t slot = (first + i) & mask;
+        uint16_t sample = ring[slot];
+        if (slot & 1) {
+            if (t->current_limit && sample > t->current_limit) {
+                if (++t->current_count >= t->debounce) {
+                    t->tripped |= PSU_TRIP_OVERCURRENT;
+                    t->current_count = t->debounce;
+                }
+            } else {
+                t->current_count = 0;
+            }
+        } else {
+            if (t->vout_hold) {
+                t->vout_count = 0;
+            } else if (t->vout_skip) {
+                t->vout_skip--;
+            } else if (t->vout_limit && sample <= t->vout_limit) {
+                if (++t->vout_count >= t->debounce) {
+                    t->tripped |= PSU_TRIP_UNDERVOLTAGE;
+                    t->vout_count = t->debounce;
+                }
+            } else {
+                t->vout_count = 0;
+            }
+        }
+    }
+    return t->tripped;
+}
+
+uint32_t psu_trip_worst_case_us(uint32_t sample_us, uint32_t check_us, uint8_t debounce) {
+    // the fault starts just after a sample of its channel was taken
+    return (uint32_t)(debounce ? debounce : 1) * 2 * sample_us + PSU_TRIP_CONVERSION_US + check_us;
+}
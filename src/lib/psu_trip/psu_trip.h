@@ -0,0 +1,78 @@
+/*
+ * psu_trip.h — PSU fault comparator for the ADC sample ring
+ *
+ * The ADC free-runs in round robin on the AMUX output (parked on VOUT) and
+ * the current sense input, DMA writes the samples into a ring. Samples
+ * alternate, even ring slots are VOUT and odd slots are current sense.
+ * A timer interrupt hands the new slots to psu_trip_process(), which trips
+ * when `debounce` consecutive samples of a channel are past its limit.
+ *
+ * Worst case trip latency, from the fault to the shutdown:
+ *   debounce samples of the channel (2 ADC conversions apart), the last
+ *   conversion time, and one timer period until the ring is checked.
+ * The AMUX can be borrowed without stopping the sampling: VOUT slots are
+ * ignored while it is away (psu_trip_vout_hold()) and current sense is
+ * still checked, so the bound holds through AMUX sweeps.
+ * psu_trip_worst_case_us() returns the bound, tests/test_psu_trip.c checks
+ * it against a simulation of the ADC, DMA ring and timer.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef PSU_TRIP_H
+#define PSU_TRIP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PSU_TRIP_OVERCURRENT (1u << 0)
+#define PSU_TRIP_UNDERVOLTAGE (1u << 1)
+
+// ADC sample and hold to result in the FIFO (96 ADC clocks at 48MHz)
+#define PSU_TRIP_CONVERSION_US 2
+
+typedef struct {
+    uint16_t current_limit; // trip above this current sense count, 0 disables
+    uint16_t vout_limit;    // trip at or below this VOUT count, 0 disables
+    uint8_t debounce;       // consecutive samples past the limit to trip
+    uint16_t vout_settle;   // VOUT samples ignored after sampling (re)starts
+    // state
+    uint8_t current_count;
+    uint8_t vout_count;
+    uint16_t vout_skip;
+    bool vout_hold; // AMUX is away from VOUT, even slots are not VOUT
+    uint8_t tripped; // PSU_TRIP_* bits, latched
+} psu_trip_t;
+
+void psu_trip_init(psu_trip_t* t, uint16_t current_limit, uint16_t vout_limit, uint8_t debounce, uint16_t vout_settle);
+
+/**
+ * Sampling was stopped and restarted (the AMUX was used by someone else):
+ * clear the debounce counts and let VOUT settle again. A trip stays latched.
+ */
+void psu_trip_restart(psu_trip_t* t);
+
+/**
+ * The AMUX was switched away from VOUT (hold) or parked back on it: ignore
+ * VOUT samples until it is back and has settled again. Current sense is
+ * checked as usual. psu_trip_restart() keeps the hold.
+ */
+void psu_trip_vout_hold(psu_trip_t* t, bool hold);
+
+/**
+ * Check `count` new samples starting at ring slot `first`.
+ * @param ring_len  ring length in samples, a power of 2
+ * @return PSU_TRIP_* bits, 0 while everything is in limits
+ */
+uint8_t psu_trip_process(psu_trip_t* t, const uint16_t* ring, uint32_t ring_len, uint32_t first, uint32_t count);
+
+/**
+ * Worst case fault to trip time.
+ * @param sample_us  time between ADC conversions (both channels)
+ * @param check_us   timer period for psu_trip_process()
+ */
+uint32_t psu_trip_worst_case_us(uint32_t sample_us, uint32_t check_us, uint8_t debounce);
+
+#endif // PSU_TRIP_H
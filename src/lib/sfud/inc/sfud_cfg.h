@@ -46,6 +46,7 @@ enum {
     [SFUD_SST25_DEVICE_INDEX] = {.name = "SST25VF016B", .spi.name = "SPI1"},       \
 }
 
-//#define SFUD_USING_QSPI
+// dual and quad reads through the PIO engine, see sfud_port.h
+#define SFUD_USING_QSPI
 
 #endif /* _SFUD_CFG_H_ */
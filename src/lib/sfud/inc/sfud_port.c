@@ -37,8 +37,15 @@
 #include "sfud.h"
 #include "pirate/bio.h"
 #include "pirate/hwspi.h"
+#include "pirate/spi_mio_pio.h"
+#include "sfud_port.h"
+
+#define SFUD_CMD_READ_SFDP 0x5A
 
 static char log_buf[256];
+/* data lines of the multi-I/O engine, 0 for the SPI peripheral */
+static uint8_t port_lines;
+static spi_mio_plan_t port_plan;
 
 void sfud_log_debug(const char *file, const long line, const char *format, ...);
 
@@ -61,6 +68,11 @@ static sfud_err spi_write_read(const sfud_spi *spi, const uint8_t *write_buf, si
         SFUD_ASSERT(read_buf);
     }
 
+    if (port_lines) {
+        spi_mio_pio_transfer(write_buf, write_size, read_buf, read_size);
+        return result;
+    }
+
     //CS low
     //bio_put(M_SPI_CS, 0);
     hwspi_select();
@@ -95,12 +107,51 @@ static sfud_err qspi_read(const struct __sfud_spi *spi, uint32_t addr, sfud_qspi
         uint8_t *read_buf, size_t read_size) {
     sfud_err result = SFUD_SUCCESS;
 
-    /**
-     * add your qspi read flash data code
-     */
+    /* the instruction, address and dummy clocks come from the plan, they describe the same command */
+    spi_mio_pio_read(&port_plan, addr, read_buf, read_size);
 
     return result;
 }
+
+void sfud_port_set_lines(uint8_t lines) {
+    port_lines = lines;
+}
+
+static sfud_err sfdp_read(sfud_flash *flash, uint32_t addr, uint8_t *buf, size_t size) {
+    uint8_t cmd[] = { SFUD_CMD_READ_SFDP, (addr >> 16) & 0xFF, (addr >> 8) & 0xFF, addr & 0xFF, SFUD_DUMMY_DATA };
+
+    return flash->spi.wr(&flash->spi, cmd, sizeof(cmd), buf, size);
+}
+
+sfud_err sfud_port_plan_read(sfud_flash *flash, spi_mio_plan_t *plan) {
+    uint8_t header[16];
+    uint32_t bfpt[SPI_MIO_BFPT_DWORDS];
+    uint32_t addr, dwords = 0;
+    bool quad_ok = false;
+
+    SFUD_ASSERT(port_lines);
+
+    /* no SFDP leaves the plain 03h read */
+    if (sfdp_read(flash, 0, header, sizeof(header)) == SFUD_SUCCESS && spi_mio_sfdp_locate(header, &addr, &dwords)
+            && sfdp_read(flash, addr, (uint8_t *)bfpt, dwords * 4) == SFUD_SUCCESS) {
+        spi_mio_qer_t qer = spi_mio_qer(bfpt, dwords);
+        uint8_t cmd, bit, status;
+        if (qer == SPI_MIO_QER_NONE) {
+            quad_ok = true;
+        } else if (spi_mio_qe_status(qer, &cmd, &bit) && flash->spi.wr(&flash->spi, &cmd, 1, &status, 1) == SFUD_SUCCESS) {
+            quad_ok = (status >> bit) & 1;
+        }
+    } else {
+        dwords = 0;
+    }
+
+    spi_mio_plan(dwords ? bfpt : NULL, dwords, port_lines, quad_ok, flash->addr_in_4_byte ? 4 : 3, &port_plan);
+    /* sfud_read() hands anything but 03h to qspi_read() */
+    flash->read_cmd_format.instruction = port_plan.opcode;
+    *plan = port_plan;
+
+    return SFUD_SUCCESS;
+}
 #endif /* SFUD_USING_QSPI */
 
 void delay_100us(void)
@@ -128,6 +179,9 @@ sfud_err sfud_spi_port_init(sfud_flash *flash) {
     //switch (flash->index) {
         //case SFUD_SST25_DEVICE_INDEX: {
             flash->spi.wr = spi_write_read;
+#ifdef SFUD_USING_QSPI
+            flash->spi.qspi_read = qspi_read;
+#endif
             //flash->spi.lock = spi_lock;
             //flash->spi.unlock = spi_unlock;
             //flash->spi.user_data = &spi1;
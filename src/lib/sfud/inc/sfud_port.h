@@ -0,0 +1,36 @@
+/*
+ * Bus Pirate additions to the SFUD port (sfud_port.c).
+ *
+ * By default SFUD talks to the flash through the SPI peripheral. With the
+ * multi-I/O engine selected every transfer goes through pirate/spi_mio_pio
+ * on IO0-IO3 instead, and reads use the dual or quad command the flash's
+ * SFDP table offers.
+ */
+
+#ifndef _SFUD_PORT_H_
+#define _SFUD_PORT_H_
+
+#include "sfud_def.h"
+#include "lib/spi_mio/spi_mio.h"
+
+/**
+ * Route SFUD through the multi-I/O engine. Call before sfud_device_init(),
+ * the engine must be running (spi_mio_pio_init()).
+ *
+ * @param lines data lines wired: 1, 2 or 4, or 0 for the SPI peripheral
+ */
+void sfud_port_set_lines(uint8_t lines);
+
+/**
+ * Choose the read command from the SFDP basic flash parameter table and
+ * the quad enable bit. Call after sfud_device_init(). The status registers
+ * are only read, a part with QE clear gets a dual or single line read.
+ *
+ * @param flash flash device
+ * @param plan the read command chosen
+ *
+ * @return result
+ */
+sfud_err sfud_port_plan_read(sfud_flash *flash, spi_mio_plan_t *plan);
+
+#endif /* _SFUD_PORT_H_ */
@@ -0,0 +1,143 @@
+/*
+ * spd_nvm.c — DDR4/DDR5 SPD NVM helpers: table driven CRC16, page write
+ *             planner and write cycle timer
+ *
+ * See spd_nvm.h.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include "spd_nvm.h"
+
+#include <string.h>
+
+const spd_nvm_geometry_t spd_nvm_ddr4 = { .size = 512, .page_size = 256, .crc_len = 126 };
+const spd_nvm_geometry_t spd_nvm_ddr5 = { .size = 1024, .page_size = 128, .crc_len = 510 };
+
+/* ── CRC16 ───────────────────────────────────────────────────────────── */
+
+// CRC-16/XMODEM of each byte value, 512 bytes of flash
+static const uint16_t crc16_table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7, 0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad,
+    0xe1ce, 0xf1ef, 0x1231, 0x0210, 0x3273, 0x2252, 0x52b5, 0x4294, 0x72f7, 0x62d6, 0x9339, 0x8318, 0xb37b, 0xa35a,
+    0xd3bd, 0xc39c, 0xf3ff, 0xe3de, 0x2462, 0x3443, 0x0420, 0x1401, 0x64e6, 0x74c7, 0x44a4, 0x5485, 0xa56a, 0xb54b,
+    0x8528, 0x9509, 0xe5ee, 0xf5cf, 0xc5ac, 0xd58d, 0x3653, 0x2672, 0x1611, 0x0630, 0x76d7, 0x66f6, 0x5695, 0x46b4,
+    0xb75b, 0xa77a, 0x9719, 0x8738, 0xf7df, 0xe7fe, 0xd79d, 0xc7bc, 0x48c4, 0x58e5, 0x6886, 0x78a7, 0x0840, 0x1861,
+    0x2802, 0x3823, 0xc9cc, 0xd9ed, 0xe98e, 0xf9af, 0x8948, 0x9969, 0xa90a, 0xb92b, 0x5af5, 0x4ad4, 0x7ab7, 0x6a96,
+    0x1a71, 0x0a50, 0x3a33, 0x2a12, 0xdbfd, 0xcbdc, 0xfbbf, 0xeb9e, 0x9b79, 0x8b58, 0xbb3b, 0xab1a, 0x6ca6, 0x7c87,
+    0x4ce4, 0x5cc5, 0x2c22, 0x3c03, 0x0c60, 0x1c41, 0xedae, 0xfd8f, 0xcdec, 0xddcd, 0xad2a, 0xbd0b, 0x8d68, 0x9d49,
+    0x7e97, 0x6eb6, 0x5ed5, 0x4ef4, 0x3e13, 0x2e32, 0x1e51, 0x0e70, 0xff9f, 0xefbe, 0xdfdd, 0xcffc, 0xbf1b, 0xaf3a,
+    0x9f59, 0x8f78, 0x9188, 0x81a9, 0xb1ca, 0xa1eb, 0xd10c, 0xc12d, 0xf14e, 0xe16f, 0x1080, 0x00a1, 0x30c2, 0x20e3,
+    0x5004, 0x4025, 0x7046, 0x6067, 0x83b9, 0x9398, 0xa3fb, 0xb3da, 0xc33d, 0xd31c, 0xe37f, 0xf35e, 0x02b1, 0x1290,
+    0x22f3, 0x32d2, 0x4235, 0x5214, 0x6277, 0x7256, 0xb5ea, 0xa5cb, 0x95a8, 0x8589, 0xf56e, 0xe54f, 0xd52c, 0xc50d,
+    0x34e2, 0x24c3, 0x14a0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405, 0xa7db, 0xb7fa, 0x8799, 0x97b8, 0xe75f, 0xf77e,
+    0xc71d, 0xd73c, 0x26d3, 0x36f2, 0x0691, 0x16b0, 0x6657, 0x7676, 0x4615, 0x5634, 0xd94c, 0xc96d, 0xf90e, 0xe92f,
+    0x99c8, 0x89e9, 0xb98a, 0xa9ab, 0x5844, 0x4865, 0x7806, 0x6827, 0x18c0, 0x08e1, 0x3882, 0x28a3, 0xcb7d, 0xdb5c,
+    0xeb3f, 0xfb1e, 0x8bf9, 0x9bd8, 0xabbb, 0xbb9a, 0x4a75, 0x5a54, 0x6a37, 0x7a16, 0x0af1, 0x1ad0, 0x2ab3, 0x3a92,
+    0xfd2e, 0xed0f, 0xdd6c, 0xcd4d, 0xbdaa, 0xad8b, 0x9de8, 0x8dc9, 0x7c26, 0x6c07, 0x5c64, 0x4c45, 0x3ca2, 0x2c83,
+    0x1ce0, 0x0cc1, 0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8, 0x6e17, 0x7e36, 0x4e55, 0x5e74,
+    0x2e93, 0x3eb2, 0x0ed1, 0x1ef0,
+};
+
+uint16_t spd_nvm_crc16_update(uint16_t crc, const uint8_t* data, uint32_t len) {
+    while (len--) {
+        crc = (crc << 8) ^ crc16_table[(crc >> 8) ^ *data++];
+    }
+    return crc;
+}
+
+void spd_nvm_crc_init(spd_nvm_crc_t* c, const spd_nvm_geometry_t* g) {
+    memset(c, 0, sizeof(*c));
+    c->len = g->crc_len;
+}
+
+void spd_nvm_crc_feed(spd_nvm_crc_t* c, const uint8_t* data, uint32_t len) {
+    uint32_t at = c->next;
+    c->next += len;
+    if (at < c->len) {
+        uint32_t n = c->len - at < len ? c->len - at : len;
+        c->crc = spd_nvm_crc16_update(c->crc, data, n);
+        data += n;
+        len -= n;
+        at += n;
+    }
+    // the two stored bytes may straddle pieces
+    while (len && at < c->len + 2u) {
+        c->stored[at - c->len] = *data++;
+        c->have++;
+        len--;
+        at++;
+    }
+}
+
+uint16_t spd_nvm_crc_stored(const spd_nvm_crc_t* c) {
+    return c->have == 2 ? c->stored[0] | (c->stored[1] << 8) : 0;
+}
+
+bool spd_nvm_crc_ok(const spd_nvm_crc_t* c) {
+    return c->have == 2 && c->crc == spd_nvm_crc_stored(c);
+}
+
+/* ── Page planner ────────────────────────────────────────────────────── */
+
+uint32_t spd_nvm_plan_page(const spd_nvm_geometry_t* g, const uint8_t* device, const uint8_t* image) {
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < g->page_size / SPD_NVM_WRITE_SIZE; i++) {
+        uint32_t at = i * SPD_NVM_WRITE_SIZE;
+        if (memcmp(&device[at], &image[at], SPD_NVM_WRITE_SIZE)) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+void spd_nvm_plan(const spd_nvm_geometry_t* g, const uint8_t* device, const uint8_t* image, spd_nvm_plan_t* plan) {
+    memset(plan, 0, sizeof(*plan));
+    uint32_t pages = g->size / g->page_size;
+    uint32_t chunks = g->page_size / SPD_NVM_WRITE_SIZE;
+    for (uint32_t p = 0; p < pages; p++) {
+        uint32_t mask = spd_nvm_plan_page(g, &device[p * g->page_size], &image[p * g->page_size]);
+        plan->mask[p] = mask;
+        uint16_t n = __builtin_popcount(mask);
+        plan->writes += n;
+        plan->skipped += chunks - n;
+        plan->pages += n != 0;
+    }
+}
+
+uint32_t spd_nvm_diff_next(const uint8_t* a, const uint8_t* b, uint32_t offset, uint32_t len) {
+    while (offset < len && a[offset] == b[offset]) {
+        offset++;
+    }
+    return offset;
+}
+
+/* ── Write cycle timer ───────────────────────────────────────────────── */
+
+void spd_nvm_timer_init(spd_nvm_timer_t* t, uint32_t typical_us, uint32_t poll_us) {
+    memset(t, 0, sizeof(*t));
+    // start short of the datasheet figure, parts are usually quicker
+    t->wait_us = typical_us / 2;
+    t->poll_us = poll_us;
+    t->min_us = poll_us;
+}
+
+void spd_nvm_timer_done(spd_nvm_timer_t* t, uint32_t busy_polls) {
+    t->writes++;
+    t->polls += busy_polls;
+    if (busy_polls) {
+        t->early = 0;
+    }
+    if (busy_polls > 1) {
+        // still writing long after the wait, move most of the way there
+        t->wait_us += (busy_polls - 1) * t->poll_us;
+    } else if (!busy_polls) {
+        // done before the first poll: back off half a poll, twice as far
+        // each time it happens again so a much faster part is found quickly
+        uint32_t less = (t->poll_us / 2) << t->early;
+        if (t->early < 8) {
+            t->early++;
+        }
+        t->wait_us = t->wait_us > t->min_us + less ? t->wait_us - less : t->min_us;
+    }
+}
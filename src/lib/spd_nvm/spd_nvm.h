@@ -0,0 +1,127 @@
+/*
+ * spd_nvm.h — DDR4/DDR5 SPD NVM helpers: table driven CRC16, page write
+ *             planner and write cycle timer
+ *
+ * Both SPD EEPROMs are read and written a page at a time (DDR4 256 bytes
+ * selected with SPA0/SPA1, DDR5 128 bytes selected with MR11) and take
+ * 16 byte writes that each start a few millisecond NVM cycle. The write
+ * cycle is the slow part, so the commands:
+ *
+ *   - read a whole page in one transaction
+ *   - plan the page: compare the image with what the device holds and
+ *     only write the 16 byte chunks that differ (spd_nvm_plan_page)
+ *   - wait the learned write time before the first status poll instead
+ *     of polling the bus from the first microsecond (spd_nvm_timer_*)
+ *   - check the JEDEC CRC as the image arrives in pieces, no second pass
+ *     and no file rewind (spd_nvm_crc_*)
+ *
+ * The CRC is CRC-16/XMODEM (polynomial 0x1021, init 0) stored little
+ * endian right after the bytes it covers, one table lookup per byte.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host
+ * (tests/test_spd_nvm.c).
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef SPD_NVM_H
+#define SPD_NVM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SPD_NVM_WRITE_SIZE 16 // bytes per NVM write, both generations
+
+typedef struct {
+    uint16_t size;      // whole NVM
+    uint16_t page_size; // bytes behind one page select
+    uint16_t crc_len;   // JEDEC CRC covers 0 to crc_len-1, stored at crc_len
+} spd_nvm_geometry_t;
+
+extern const spd_nvm_geometry_t spd_nvm_ddr4;
+extern const spd_nvm_geometry_t spd_nvm_ddr5;
+
+/* ── CRC16 ───────────────────────────────────────────────────────────── */
+
+/**
+ * Continue a CRC over more bytes, start with crc = 0.
+ */
+uint16_t spd_nvm_crc16_update(uint16_t crc, const uint8_t* data, uint32_t len);
+
+typedef struct {
+    uint16_t crc;
+    uint16_t len;  // bytes covered
+    uint32_t next; // image offset expected next
+    uint8_t stored[2];
+    uint8_t have;  // stored CRC bytes seen
+} spd_nvm_crc_t;
+
+void spd_nvm_crc_init(spd_nvm_crc_t* c, const spd_nvm_geometry_t* g);
+
+/**
+ * Feed the image in order, in any size pieces; bytes past the CRC are ignored.
+ */
+void spd_nvm_crc_feed(spd_nvm_crc_t* c, const uint8_t* data, uint32_t len);
+
+/**
+ * True once the covered bytes and the stored CRC went by and they agree.
+ */
+bool spd_nvm_crc_ok(const spd_nvm_crc_t* c);
+
+/**
+ * Stored CRC as fed, 0 if it has not arrived yet.
+ */
+uint16_t spd_nvm_crc_stored(const spd_nvm_crc_t* c);
+
+/* ── Page planner ────────────────────────────────────────────────────── */
+
+/**
+ * Chunks of one page that need writing.
+ * @param device  the page as read from the device
+ * @param image   the same page of the image to write
+ * @return bit n set: write bytes n*16 to n*16+15 of the page
+ */
+uint32_t spd_nvm_plan_page(const spd_nvm_geometry_t* g, const uint8_t* device, const uint8_t* image);
+
+typedef struct {
+    uint32_t mask[8]; // per page, as spd_nvm_plan_page
+    uint16_t writes;  // chunks to write
+    uint16_t skipped; // chunks already right
+    uint8_t pages;    // pages with at least one write
+} spd_nvm_plan_t;
+
+/**
+ * Plan a whole image against a whole device read.
+ */
+void spd_nvm_plan(const spd_nvm_geometry_t* g, const uint8_t* device, const uint8_t* image, spd_nvm_plan_t* plan);
+
+/**
+ * Next byte from offset where a and b differ, len if none.
+ */
+uint32_t spd_nvm_diff_next(const uint8_t* a, const uint8_t* b, uint32_t offset, uint32_t len);
+
+/* ── Write cycle timer ───────────────────────────────────────────────── */
+
+typedef struct {
+    uint32_t wait_us; // before the first status poll
+    uint32_t poll_us; // between polls after that
+    uint32_t min_us;
+    uint8_t early;    // writes in a row done before the first poll
+    uint32_t writes;
+    uint32_t polls;   // busy polls over all writes
+} spd_nvm_timer_t;
+
+/**
+ * @param typical_us  datasheet write cycle, the first guess
+ * @param poll_us     time between busy polls
+ */
+void spd_nvm_timer_init(spd_nvm_timer_t* t, uint32_t typical_us, uint32_t poll_us);
+
+/**
+ * Learn from one write: busy_polls is how many polls after the first
+ * wait still found the device busy. Aims for one busy poll per write so
+ * the wait stays just under the real write time.
+ */
+void spd_nvm_timer_done(spd_nvm_timer_t* t, uint32_t busy_polls);
+
+#endif // SPD_NVM_H
@@ -0,0 +1,207 @@
+/*
+ * spi_mio.c — Multi-I/O SPI flash reads: SFDP read plan and PIO framing
+ *
+ * See spi_mio.h.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include "spi_mio.h"
+
+#include <string.h>
+
+/* ── SFDP ──────────────────────────────────────────────────────────── */
+
+#define SFDP_SIGNATURE 0x50444653u // "SFDP", little endian
+#define SFDP_BFPT_MIN_DWORDS 9
+#define SFDP_QER_MIN_DWORDS 15
+
+bool spi_mio_sfdp_locate(const uint8_t* hdr, uint32_t* addr, uint32_t* dwords) {
+    uint32_t sig = hdr[0] | (hdr[1] << 8) | (hdr[2] << 16) | ((uint32_t)hdr[3] << 24);
+    if (sig != SFDP_SIGNATURE) {
+        return false;
+    }
+    // the first parameter header is always the JEDEC basic table, ID 0xFF00
+    if (hdr[8] != 0x00 || hdr[15] != 0xff || hdr[11] < SFDP_BFPT_MIN_DWORDS) {
+        return false;
+    }
+    *addr = hdr[12] | (hdr[13] << 8) | ((uint32_t)hdr[14] << 16);
+    *dwords = hdr[11] < SPI_MIO_BFPT_DWORDS ? hdr[11] : SPI_MIO_BFPT_DWORDS;
+    return true;
+}
+
+spi_mio_qer_t spi_mio_qer(const uint32_t* bfpt, uint32_t dwords) {
+    if (!bfpt || dwords < SFDP_QER_MIN_DWORDS) {
+        return SPI_MIO_QER_UNKNOWN;
+    }
+    return (spi_mio_qer_t)((bfpt[14] >> 20) & 0x07);
+}
+
+bool spi_mio_qe_status(spi_mio_qer_t qer, uint8_t* opcode, uint8_t* bit) {
+    switch (qer) {
+        case SPI_MIO_QER_SR1_BIT6:
+            *opcode = 0x05;
+            *bit = 6;
+            return true;
+        case SPI_MIO_QER_SR2_BIT7:
+            *opcode = 0x3f;
+            *bit = 7;
+            return true;
+        // 001b and 100b don't promise a Read Status Register 2 opcode, and
+        // 35h on a part without it floats DO high and reads as QE set
+        case SPI_MIO_QER_SR2_BIT1_35:
+        case SPI_MIO_QER_SR2_BIT1_31:
+            *opcode = 0x35;
+            *bit = 1;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* ── Read plan ─────────────────────────────────────────────────────── */
+
+static const struct {
+    uint8_t addr_lines;
+    uint8_t data_lines;
+    uint8_t dw1_bit;   // supported flag in DWORD 1
+    uint8_t dword;     // parameters, 0 based
+    uint8_t shift;     // low or high half of it
+    const char* name;
+} modes[] = {
+    [SPI_MIO_111] = { 1, 1, 0, 0, 0, "1-1-1" },
+    [SPI_MIO_112] = { 1, 2, 16, 3, 0, "1-1-2" },
+    [SPI_MIO_122] = { 2, 2, 20, 3, 16, "1-2-2" },
+    [SPI_MIO_114] = { 1, 4, 22, 2, 16, "1-1-4" },
+    [SPI_MIO_144] = { 4, 4, 21, 2, 0, "1-4-4" },
+};
+
+const char* spi_mio_mode_name(spi_mio_mode_t mode) {
+    return modes[mode].name;
+}
+
+uint32_t spi_mio_plan_clocks(const spi_mio_plan_t* plan, uint32_t bytes) {
+    return 8 + plan->addr_bytes * 8 / plan->addr_lines + plan->mode_clocks + plan->dummy_clocks +
+           bytes * 8 / plan->data_lines;
+}
+
+void spi_mio_plan(const uint32_t* bfpt, uint32_t dwords, uint8_t max_lines, bool quad_ok, uint8_t addr_bytes,
+                  spi_mio_plan_t* plan) {
+    *plan = (spi_mio_plan_t){
+        .mode = SPI_MIO_111,
+        .opcode = 0x03,
+        .addr_lines = 1,
+        .addr_bytes = addr_bytes,
+        .data_lines = 1,
+    };
+    if (!bfpt || dwords < SFDP_BFPT_MIN_DWORDS) {
+        return;
+    }
+    uint32_t best = spi_mio_plan_clocks(plan, SPI_MIO_PLAN_BYTES);
+    for (uint32_t m = SPI_MIO_112; m <= SPI_MIO_144; m++) {
+        uint8_t lines = modes[m].addr_lines > modes[m].data_lines ? modes[m].addr_lines : modes[m].data_lines;
+        if (lines > max_lines || (lines == 4 && !quad_ok) || !(bfpt[0] & (1u << modes[m].dw1_bit))) {
+            continue;
+        }
+        uint16_t p = (uint16_t)(bfpt[modes[m].dword] >> modes[m].shift);
+        spi_mio_plan_t c = {
+            .mode = (spi_mio_mode_t)m,
+            .opcode = (uint8_t)(p >> 8),
+            .addr_lines = modes[m].addr_lines,
+            .addr_bytes = addr_bytes,
+            .mode_clocks = (p >> 5) & 0x07,
+            .dummy_clocks = p & 0x1f,
+            .data_lines = modes[m].data_lines,
+        };
+        // a flag without an instruction is a broken table
+        if (!c.opcode) {
+            continue;
+        }
+        uint32_t clocks = spi_mio_plan_clocks(&c, SPI_MIO_PLAN_BYTES);
+        if (clocks < best) {
+            best = clocks;
+            *plan = c;
+        }
+    }
+}
+
+/* ── Framing ───────────────────────────────────────────────────────── */
+
+typedef struct {
+    uint32_t* words;
+    uint32_t clocks;
+} frame_t;
+
+static void frame_nibble(frame_t* f, uint8_t nibble) {
+    uint32_t w = f->clocks / SPI_MIO_NIBBLES_PER_WORD;
+    uint32_t shift = 28 - (f->clocks % SPI_MIO_NIBBLES_PER_WORD) * 4;
+    if (shift == 28) {
+        f->words[w] = 0;
+    }
+    f->words[w] |= (uint32_t)nibble << shift;
+    f->clocks++;
+}
+
+// MSB first, the top bit of each clock on the highest line
+static void frame_bits(frame_t* f, uint32_t value, uint8_t bits, uint8_t lines) {
+    uint8_t mask = (1u << lines) - 1;
+    for (int8_t b = bits - lines; b >= 0; b -= lines) {
+        uint8_t v = (value >> b) & mask;
+        frame_nibble(f, lines == 4 ? v : (SPI_MIO_IDLE_NIBBLE | v));
+    }
+}
+
+uint32_t spi_mio_frame(const spi_mio_plan_t* plan, uint32_t addr, uint32_t* words) {
+    frame_t f = { words, 0 };
+    frame_bits(&f, plan->opcode, 8, 1);
+    frame_bits(&f, addr, plan->addr_bytes * 8, plan->addr_lines);
+    // all ones, never the continuous read pattern
+    for (uint8_t i = 0; i < plan->mode_clocks; i++) {
+        frame_nibble(&f, SPI_MIO_IDLE_NIBBLE | ((1u << plan->addr_lines) - 1));
+    }
+    return f.clocks;
+}
+
+uint32_t spi_mio_byte_word(uint8_t byte) {
+    uint32_t word = 0;
+    frame_t f = { &word, 0 };
+    frame_bits(&f, byte, 8, 1);
+    return word;
+}
+
+uint32_t spi_mio_read_clocks(uint8_t dummy_clocks, uint8_t data_lines, uint32_t bytes) {
+    uint32_t clocks = dummy_clocks + bytes * 8 / data_lines;
+    return (clocks + SPI_MIO_NIBBLES_PER_WORD - 1) / SPI_MIO_NIBBLES_PER_WORD * SPI_MIO_NIBBLES_PER_WORD;
+}
+
+/* ── Input phase ───────────────────────────────────────────────────── */
+
+void spi_mio_rx_init(spi_mio_rx_t* rx, uint8_t data_lines, uint8_t dummy_clocks, uint8_t* out, uint32_t len) {
+    memset(rx, 0, sizeof(*rx));
+    rx->lines = data_lines;
+    rx->skip = dummy_clocks;
+    rx->out = out;
+    rx->len = len;
+}
+
+void spi_mio_rx_word(spi_mio_rx_t* rx, uint32_t word) {
+    for (int8_t shift = 28; shift >= 0; shift -= 4) {
+        if (rx->skip) {
+            rx->skip--;
+            continue;
+        }
+        if (rx->n >= rx->len) {
+            return;
+        }
+        uint8_t nibble = (word >> shift) & 0x0f;
+        // single line data comes back on DO, IO1
+        uint8_t v = rx->lines == 1 ? (nibble >> 1) & 1 : rx->lines == 2 ? nibble & 3 : nibble;
+        rx->acc = (rx->acc << rx->lines) | v;
+        rx->bits += rx->lines;
+        if (rx->bits == 8) {
+            rx->out[rx->n++] = (uint8_t)rx->acc;
+            rx->acc = 0;
+            rx->bits = 0;
+        }
+    }
+}
@@ -0,0 +1,147 @@
+/*
+ * spi_mio.h — Multi-I/O SPI flash reads: SFDP read plan and PIO framing
+ *
+ * The PIO engine (pirate/spi_mio) clocks IO0-IO3 four bits at a time,
+ * one nibble per SPI clock, bit 0 on IO0 (flash DQ0/DI) to bit 3 on IO3
+ * (DQ3/HOLD#). Nibbles are packed 8 per 32 bit FIFO word, first clock in
+ * the top nibble. A transaction is an output phase (instruction, address,
+ * mode bits) and an input phase (dummy clocks, then data) with the pins
+ * turned around in between, so the flash never drives against the Bus
+ * Pirate during the dummy clocks.
+ *
+ * Outside the quad phases IO2 and IO3 are driven high so WP# and HOLD#
+ * stay inactive.
+ *
+ * The read plan comes from the JEDEC basic flash parameter table (BFPT):
+ * DWORD 1 says which of 1-1-2, 1-2-2, 1-1-4 and 1-4-4 exist, DWORDs 3-4
+ * give their instruction, mode clocks and dummy clocks, and DWORD 15
+ * (JESD216A and later) says where the quad enable bit is. Quad reads are
+ * only used when the QE bit can be checked and is already set; the
+ * status registers are never written. Of the modes the wiring allows,
+ * the one with the fewest clocks for a 256 byte read wins.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host
+ * (tests/test_spi_mio.c).
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef SPI_MIO_H
+#define SPI_MIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// WP# and HOLD# high
+#define SPI_MIO_IDLE_NIBBLE 0x0c
+#define SPI_MIO_NIBBLES_PER_WORD 8
+// instruction, 4 address bytes, 8 mode clocks
+#define SPI_MIO_FRAME_MAX_CLOCKS (8 + 32 + 8)
+#define SPI_MIO_FRAME_MAX_WORDS (SPI_MIO_FRAME_MAX_CLOCKS / SPI_MIO_NIBBLES_PER_WORD)
+// BFPT DWORDs read, up to the quad enable requirements
+#define SPI_MIO_BFPT_DWORDS 16
+// read size the plans are compared at
+#define SPI_MIO_PLAN_BYTES 256
+
+typedef enum {
+    SPI_MIO_111 = 0,
+    SPI_MIO_112,
+    SPI_MIO_122,
+    SPI_MIO_114,
+    SPI_MIO_144,
+} spi_mio_mode_t;
+
+typedef struct {
+    spi_mio_mode_t mode;
+    uint8_t opcode;
+    uint8_t addr_lines;   // address and mode bits
+    uint8_t addr_bytes;   // 3 or 4
+    uint8_t mode_clocks;  // mode bits, sent as all ones
+    uint8_t dummy_clocks; // lines released
+    uint8_t data_lines;
+} spi_mio_plan_t;
+
+// quad enable requirement, BFPT DWORD 15 bits 22:20
+typedef enum {
+    SPI_MIO_QER_NONE = 0,     // no QE bit
+    SPI_MIO_QER_SR2_BIT1_NOREAD, // no way to read it back
+    SPI_MIO_QER_SR1_BIT6,
+    SPI_MIO_QER_SR2_BIT7,
+    SPI_MIO_QER_SR2_BIT1,     // no read instruction given, not checked
+    SPI_MIO_QER_SR2_BIT1_35,
+    SPI_MIO_QER_SR2_BIT1_31,
+    SPI_MIO_QER_UNKNOWN,      // reserved, or the table is too short
+} spi_mio_qer_t;
+
+/**
+ * Find the BFPT in the SFDP header.
+ * @param hdr     the first 16 bytes of SFDP space (header and first parameter header)
+ * @param addr    BFPT address in SFDP space
+ * @param dwords  BFPT length, at most SPI_MIO_BFPT_DWORDS
+ * @return false without an SFDP signature or JEDEC parameter table
+ */
+bool spi_mio_sfdp_locate(const uint8_t* hdr, uint32_t* addr, uint32_t* dwords);
+
+/**
+ * Quad enable requirement of a BFPT.
+ */
+spi_mio_qer_t spi_mio_qer(const uint32_t* bfpt, uint32_t dwords);
+
+/**
+ * How to check the QE bit.
+ * @param opcode  read status instruction
+ * @param bit     QE bit in the byte it returns
+ * @return false if there is no bit to check (NONE) or no way to check it
+ */
+bool spi_mio_qe_status(spi_mio_qer_t qer, uint8_t* opcode, uint8_t* bit);
+
+/**
+ * Choose the read command.
+ * @param bfpt        BFPT DWORDs, NULL for a part without SFDP
+ * @param dwords      BFPT length
+ * @param max_lines   data lines wired: 1, 2 or 4
+ * @param quad_ok     the QE bit is set, or there is none
+ * @param addr_bytes  3, or 4 if the flash is in 4 byte address mode
+ */
+void spi_mio_plan(const uint32_t* bfpt, uint32_t dwords, uint8_t max_lines, bool quad_ok, uint8_t addr_bytes,
+                  spi_mio_plan_t* plan);
+
+// "1-4-4" and so on
+const char* spi_mio_mode_name(spi_mio_mode_t mode);
+
+// clocks for a read of this many bytes, instruction to the last data clock
+uint32_t spi_mio_plan_clocks(const spi_mio_plan_t* plan, uint32_t bytes);
+
+/**
+ * Output phase of a read: instruction, address and mode bits.
+ * @param words  SPI_MIO_FRAME_MAX_WORDS
+ * @return clocks
+ */
+uint32_t spi_mio_frame(const spi_mio_plan_t* plan, uint32_t addr, uint32_t* words);
+
+/**
+ * Output phase of a single line transfer, one word per byte.
+ */
+uint32_t spi_mio_byte_word(uint8_t byte);
+
+/**
+ * Input phase clocks, dummy and data rounded up to whole words.
+ */
+uint32_t spi_mio_read_clocks(uint8_t dummy_clocks, uint8_t data_lines, uint32_t bytes);
+
+// input phase unpacker, fed one FIFO word at a time
+typedef struct {
+    uint8_t lines;
+    uint32_t skip;   // dummy clocks still to drop
+    uint8_t* out;
+    uint32_t len;
+    uint32_t n;
+    uint32_t acc;
+    uint8_t bits;
+} spi_mio_rx_t;
+
+void spi_mio_rx_init(spi_mio_rx_t* rx, uint8_t data_lines, uint8_t dummy_clocks, uint8_t* out, uint32_t len);
+void spi_mio_rx_word(spi_mio_rx_t* rx, uint32_t word);
+
+#endif // SPI_MIO_H
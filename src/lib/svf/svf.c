@@ -0,0 +1,967 @@
+/*
+ * svf.c — Streamed SVF and XSVF player
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include "svf.h"
+
+static const char* const svf_state_names[SVF_STATE_COUNT] = {
+    "RESET",   "IDLE",    "DRSELECT", "DRCAPTURE", "DRSHIFT",   "DREXIT1", "DRPAUSE", "DREXIT2",
+    "DRUPDATE", "IRSELECT", "IRCAPTURE", "IRSHIFT", "IREXIT1", "IRPAUSE", "IREXIT2", "IRUPDATE",
+};
+
+// [state][tms]
+static const uint8_t svf_next[SVF_STATE_COUNT][2] = {
+    [SVF_RESET] = { SVF_IDLE, SVF_RESET },
+    [SVF_IDLE] = { SVF_IDLE, SVF_DRSELECT },
+    [SVF_DRSELECT] = { SVF_DRCAPTURE, SVF_IRSELECT },
+    [SVF_DRCAPTURE] = { SVF_DRSHIFT, SVF_DREXIT1 },
+    [SVF_DRSHIFT] = { SVF_DRSHIFT, SVF_DREXIT1 },
+    [SVF_DREXIT1] = { SVF_DRPAUSE, SVF_DRUPDATE },
+    [SVF_DRPAUSE] = { SVF_DRPAUSE, SVF_DREXIT2 },
+    [SVF_DREXIT2] = { SVF_DRSHIFT, SVF_DRUPDATE },
+    [SVF_DRUPDATE] = { SVF_IDLE, SVF_DRSELECT },
+    [SVF_IRSELECT] = { SVF_IRCAPTURE, SVF_RESET },
+    [SVF_IRCAPTURE] = { SVF_IRSHIFT, SVF_IREXIT1 },
+    [SVF_IRSHIFT] = { SVF_IRSHIFT, SVF_IREXIT1 },
+    [SVF_IREXIT1] = { SVF_IRPAUSE, SVF_IRUPDATE },
+    [SVF_IRPAUSE] = { SVF_IRPAUSE, SVF_IREXIT2 },
+    [SVF_IREXIT2] = { SVF_IRSHIFT, SVF_IRUPDATE },
+    [SVF_IRUPDATE] = { SVF_IDLE, SVF_DRSELECT },
+};
+
+static const char* const svf_errors[SVF_ERR_COUNT] = {
+    [SVF_OK] = "ok",
+    [SVF_ERR_SYNTAX] = "syntax error",
+    [SVF_ERR_UNSUPPORTED] = "unsupported statement",
+    [SVF_ERR_TOO_LONG] = "vector too long",
+    [SVF_ERR_MISMATCH] = "TDO mismatch",
+    [SVF_ERR_ABORT] = "aborted",
+};
+
+svf_state_t svf_next_state(svf_state_t s, bool tms) {
+    return (svf_state_t)svf_next[s][tms ? 1 : 0];
+}
+
+const char* svf_state_name(svf_state_t s) {
+    return s < SVF_STATE_COUNT ? svf_state_names[s] : "?";
+}
+
+const char* svf_error_text(svf_err_t err) {
+    return err < SVF_ERR_COUNT ? svf_errors[err] : "?";
+}
+
+uint32_t svf_path(svf_state_t from, svf_state_t to, uint32_t* tms) {
+    // breadth first, TMS 0 tried first
+    uint8_t prev[SVF_STATE_COUNT];
+    uint8_t prev_tms[SVF_STATE_COUNT];
+    uint8_t queue[SVF_STATE_COUNT];
+    uint32_t head = 0, tail = 0;
+    *tms = 0;
+    if (from == to) {
+        return 0;
+    }
+    memset(prev, 0xff, sizeof(prev));
+    prev[from] = from;
+    queue[tail++] = from;
+    while (head < tail && prev[to] == 0xff) {
+        uint8_t st = queue[head++];
+        for (uint8_t b = 0; b < 2; b++) {
+            uint8_t n = svf_next[st][b];
+            if (prev[n] == 0xff) {
+                prev[n] = st;
+                prev_tms[n] = b;
+                queue[tail++] = n;
+            }
+        }
+    }
+    // walk back from the target, the first move ends up in bit 0
+    uint32_t count = 0;
+    uint32_t bits = 0;
+    for (uint8_t st = to; st != from; st = prev[st]) {
+        bits = (bits << 1) | prev_tms[st];
+        count++;
+    }
+    *tms = bits;
+    return count;
+}
+
+/* ── Compare ───────────────────────────────────────────────────── */
+
+int32_t svf_compare(const uint8_t* got, const uint8_t* expected, const uint8_t* mask, uint32_t bits) {
+    uint32_t full = bits / 8;
+    uint32_t i = 0;
+    // a word at a time, byte 0 in bits 7:0 (little endian, like the RP2040)
+    for (; i + 4 <= full; i += 4) {
+        uint32_t g, e, m;
+        memcpy(&g, got + i, 4);
+        memcpy(&e, expected + i, 4);
+        memcpy(&m, mask + i, 4);
+        uint32_t d = (g ^ e) & m;
+        if (d) {
+            return (int32_t)(i * 8 + __builtin_ctz(d));
+        }
+    }
+    for (; i < full; i++) {
+        uint32_t d = (got[i] ^ expected[i]) & mask[i];
+        if (d) {
+            return (int32_t)(i * 8 + __builtin_ctz(d));
+        }
+    }
+    if (bits & 7) {
+        uint32_t d = (got[i] ^ expected[i]) & mask[i] & ((1u << (bits & 7)) - 1);
+        if (d) {
+            return (int32_t)(i * 8 + __builtin_ctz(d));
+        }
+    }
+    return -1;
+}
+
+/* ── Setup ─────────────────────────────────────────────────────── */
+
+static uint8_t* carve(uint8_t** p, uint32_t n) {
+    uint8_t* r = *p;
+    *p += n;
+    return r;
+}
+
+static void scan_setup(svf_scan_t* sc, uint8_t** p, uint32_t cap) {
+    sc->cap = cap;
+    sc->bits = 0;
+    sc->tdo_valid = false;
+    sc->tdi = carve(p, cap);
+    sc->tdo = carve(p, cap);
+    sc->mask = carve(p, cap);
+    sc->smask = carve(p, cap);
+}
+
+bool svf_init(svf_t* s, const svf_ops_t* ops, uint8_t* arena, uint32_t arena_len, uint32_t tck_hz) {
+    // chunk, five small scans, then SDR TDI/TDO/MASK/SMASK and the capture buffer
+    uint32_t fixed = SVF_CHUNK_BYTES + 5 * 4 * SVF_SMALL_BYTES;
+    if (arena_len < fixed + 5 * SVF_SMALL_BYTES) {
+        return false;
+    }
+    memset(s, 0, sizeof(*s));
+    s->ops = ops;
+    s->tck_hz = tck_hz;
+    uint8_t* p = arena;
+    s->chunk = carve(&p, SVF_CHUNK_BYTES);
+    scan_setup(&s->hir, &p, SVF_SMALL_BYTES);
+    scan_setup(&s->hdr, &p, SVF_SMALL_BYTES);
+    scan_setup(&s->tir, &p, SVF_SMALL_BYTES);
+    scan_setup(&s->tdr, &p, SVF_SMALL_BYTES);
+    scan_setup(&s->sir, &p, SVF_SMALL_BYTES);
+    uint32_t big = ((arena_len - fixed) / 5) & ~3u;
+    scan_setup(&s->sdr, &p, big);
+    s->capture = carve(&p, big);
+    return true;
+}
+
+static void svf_start(svf_t* s) {
+    s->chunk_len = 0;
+    s->chunk_pos = 0;
+    s->peek = -1;
+    s->line = 1;
+    s->endir = SVF_IDLE;
+    s->enddr = SVF_IDLE;
+    s->run_state = SVF_IDLE;
+    s->run_end = SVF_IDLE;
+    s->xruntest = 0;
+    s->xrepeat = 32;
+    svf_scan_t* scans[] = { &s->hir, &s->hdr, &s->tir, &s->tdr, &s->sir, &s->sdr };
+    for (uint32_t i = 0; i < 6; i++) {
+        scans[i]->bits = 0;
+        scans[i]->tdo_valid = false;
+    }
+    memset(&s->result, 0, sizeof(s->result));
+}
+
+/* ── TAP ───────────────────────────────────────────────────────── */
+
+static void tap_goto(svf_t* s, svf_state_t to) {
+    if (to == SVF_RESET) {
+        // from anywhere
+        s->ops->tms(0x1f, 5);
+        s->state = SVF_RESET;
+        return;
+    }
+    uint32_t tms;
+    uint32_t n = svf_path(s->state, to, &tms);
+    if (n) {
+        s->ops->tms(tms, n);
+    }
+    s->state = to;
+}
+
+static void tap_wait(svf_t* s, uint32_t clocks, uint32_t us) {
+    if (clocks) {
+        s->ops->clocks(clocks);
+    }
+    uint32_t spent = s->tck_hz ? (uint32_t)((uint64_t)clocks * 1000000u / s->tck_hz) : 0;
+    if (us > spent) {
+        s->ops->delay_us(us - spent);
+    }
+}
+
+static svf_err_t mismatch(svf_t* s, const uint8_t* expected, int32_t bit) {
+    s->result.bit = (uint32_t)bit;
+    s->result.expected = (expected[bit / 8] >> (bit % 8)) & 1;
+    s->result.actual = (s->capture[bit / 8] >> (bit % 8)) & 1;
+    return SVF_ERR_MISMATCH;
+}
+
+/* ── File ──────────────────────────────────────────────────────── */
+
+static bool refill(svf_t* s) {
+    s->chunk_len = s->ops->read(s->chunk, SVF_CHUNK_BYTES);
+    s->chunk_pos = 0;
+    return s->chunk_len != 0;
+}
+
+static int getb(svf_t* s) {
+    if (s->chunk_pos == s->chunk_len && !refill(s)) {
+        return -1;
+    }
+    return s->chunk[s->chunk_pos++];
+}
+
+static int getch(svf_t* s) {
+    if (s->peek >= 0) {
+        int c = s->peek;
+        s->peek = -1;
+        return c;
+    }
+    int c = getb(s);
+    if (c == '\n') {
+        s->line++;
+    }
+    return c;
+}
+
+static void reverse(uint8_t* buf, uint32_t len) {
+    for (uint32_t i = 0, j = len - 1; i < j; i++, j--) {
+        uint8_t t = buf[i];
+        buf[i] = buf[j];
+        buf[j] = t;
+    }
+}
+
+/* ── SVF ───────────────────────────────────────────────────────── */
+
+#define SVF_TOK_WORD 'w'
+#define SVF_TOK_MAX 32
+
+// a word (upper case), or ( ) ; as themselves, -1 at the end of the file
+static int svf_token(svf_t* s, char* tok, uint32_t* line) {
+    int c;
+    for (;;) {
+        c = getch(s);
+        if (c < 0) {
+            tok[0] = 0;
+            return -1;
+        }
+        if (c == '!' || c == '/') {
+            while (c >= 0 && c != '\n') {
+                c = getch(s);
+            }
+            continue;
+        }
+        if (!isspace(c)) {
+            break;
+        }
+    }
+    if (line) {
+        *line = s->line;
+    }
+    if (c == '(' || c == ')' || c == ';') {
+        tok[0] = (char)c;
+        tok[1] = 0;
+        return c;
+    }
+    uint32_t n = 0;
+    while (c >= 0 && !isspace(c) && c != '(' && c != ')' && c != ';') {
+        if (n < SVF_TOK_MAX - 1) {
+            tok[n++] = (char)toupper(c);
+        }
+        c = getch(s);
+    }
+    tok[n] = 0;
+    if (c == '(' || c == ')' || c == ';') {
+        s->peek = c;
+    }
+    return SVF_TOK_WORD;
+}
+
+static bool svf_end(svf_t* s, char* tok) {
+    return svf_token(s, tok, NULL) == ';';
+}
+
+static bool svf_number(const char* tok, double* v) {
+    char* end;
+    *v = strtod(tok, &end);
+    return end != tok && *end == 0 && *v >= 0;
+}
+
+static bool svf_uint(const char* tok, uint32_t* v) {
+    double d;
+    if (!svf_number(tok, &d) || d > 4294967295.0) {
+        return false;
+    }
+    *v = (uint32_t)d;
+    return true;
+}
+
+static int svf_state_word(const char* tok) {
+    for (int i = 0; i < SVF_STATE_COUNT; i++) {
+        if (!strcmp(tok, svf_state_names[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool svf_stable(int st) {
+    return st == SVF_RESET || st == SVF_IDLE || st == SVF_DRPAUSE || st == SVF_IRPAUSE;
+}
+
+static int hexval(int c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// ( already taken; most significant digit first, any length, then LSB first in buf
+static svf_err_t svf_hex(svf_t* s, uint8_t* buf, uint32_t cap, uint32_t bits) {
+    uint32_t n = 0;
+    for (;;) {
+        // straight from the chunk, vectors are most of an SVF file
+        while (s->chunk_pos < s->chunk_len) {
+            int c = s->chunk[s->chunk_pos++];
+            int v = hexval(c);
+            if (v >= 0) {
+                if (n / 2 >= cap) {
+                    return SVF_ERR_TOO_LONG;
+                }
+                if (n & 1) {
+                    buf[n / 2] |= (uint8_t)v;
+                } else {
+                    buf[n / 2] = (uint8_t)(v << 4);
+                }
+                n++;
+            } else if (c == ')') {
+                goto done;
+            } else if (c == '\n') {
+                s->line++;
+            } else if (!isspace(c)) {
+                return SVF_ERR_SYNTAX;
+            }
+        }
+        if (!refill(s)) {
+            return SVF_ERR_SYNTAX;
+        }
+    }
+done:;
+    uint32_t raw = (n + 1) / 2;
+    if (n & 1) {
+        // odd digit count: the first digit is a low nibble
+        for (uint32_t i = raw - 1; i > 0; i--) {
+            buf[i] = (uint8_t)((buf[i] >> 4) | (buf[i - 1] << 4));
+        }
+        buf[0] >>= 4;
+    }
+    uint32_t need = (bits + 7) / 8;
+    if (raw > need) {
+        memmove(buf, buf + raw - need, need);
+    } else if (raw < need) {
+        memmove(buf + need - raw, buf, raw);
+        memset(buf, 0, need - raw);
+    }
+    if (need) {
+        reverse(buf, need);
+        if (bits & 7) {
+            buf[need - 1] &= (uint8_t)((1u << (bits & 7)) - 1);
+        }
+    }
+    return SVF_OK;
+}
+
+// length and fields; TDI, MASK and SMASK stick while the length stays the same
+static svf_err_t svf_parse_scan(svf_t* s, svf_scan_t* sc, char* tok) {
+    uint32_t bits;
+    if (svf_token(s, tok, NULL) != SVF_TOK_WORD || !svf_uint(tok, &bits)) {
+        return SVF_ERR_SYNTAX;
+    }
+    uint32_t nbytes = (bits + 7) / 8;
+    if (nbytes > sc->cap) {
+        return SVF_ERR_TOO_LONG;
+    }
+    if (bits != sc->bits) {
+        memset(sc->tdi, 0, nbytes);
+        memset(sc->mask, 0xff, nbytes);
+        memset(sc->smask, 0xff, nbytes);
+        sc->bits = bits;
+    }
+    sc->tdo_valid = false;
+    for (;;) {
+        int t = svf_token(s, tok, NULL);
+        if (t == ';') {
+            return SVF_OK;
+        }
+        if (t != SVF_TOK_WORD) {
+            return SVF_ERR_SYNTAX;
+        }
+        uint8_t* field;
+        if (!strcmp(tok, "TDI")) {
+            field = sc->tdi;
+        } else if (!strcmp(tok, "TDO")) {
+            field = sc->tdo;
+            sc->tdo_valid = true;
+        } else if (!strcmp(tok, "MASK")) {
+            field = sc->mask;
+        } else if (!strcmp(tok, "SMASK")) {
+            field = sc->smask;
+        } else {
+            return SVF_ERR_SYNTAX;
+        }
+        if (svf_token(s, tok, NULL) != '(') {
+            return SVF_ERR_SYNTAX;
+        }
+        svf_err_t err = svf_hex(s, field, sc->cap, bits);
+        if (err) {
+            return err;
+        }
+    }
+}
+
+// header, body and trailer in one pass through Shift-IR/DR
+static svf_err_t svf_scan(svf_t* s, bool ir) {
+    svf_scan_t* parts[3] = { ir ? &s->hir : &s->hdr, ir ? &s->sir : &s->sdr, ir ? &s->tir : &s->tdr };
+    int last = -1;
+    for (int i = 0; i < 3; i++) {
+        if (parts[i]->bits) {
+            last = i;
+        }
+    }
+    if (last >= 0) {
+        tap_goto(s, ir ? SVF_IRSHIFT : SVF_DRSHIFT);
+        for (int i = 0; i <= last; i++) {
+            svf_scan_t* p = parts[i];
+            if (!p->bits) {
+                continue;
+            }
+            s->ops->shift(p->tdi, p->tdo_valid ? s->capture : NULL, p->bits, i == last);
+            s->result.bits += p->bits;
+            if (p->tdo_valid) {
+                s->result.compares++;
+                int32_t bad = svf_compare(s->capture, p->tdo, p->mask, p->bits);
+                if (bad >= 0) {
+                    s->state = ir ? SVF_IREXIT1 : SVF_DREXIT1;
+                    return mismatch(s, p->tdo, bad);
+                }
+            }
+        }
+        s->state = ir ? SVF_IREXIT1 : SVF_DREXIT1;
+    }
+    tap_goto(s, ir ? s->endir : s->enddr);
+    return SVF_OK;
+}
+
+static svf_err_t svf_runtest(svf_t* s, char* tok) {
+    uint32_t clocks = 0;
+    double min_s = 0;
+    bool have_run = false, have_end = false;
+    int t = svf_token(s, tok, NULL);
+    int st = svf_state_word(tok);
+    if (t == SVF_TOK_WORD && st >= 0) {
+        if (!svf_stable(st)) {
+            return SVF_ERR_SYNTAX;
+        }
+        s->run_state = (svf_state_t)st;
+        have_run = true;
+        t = svf_token(s, tok, NULL);
+    }
+    while (t != ';') {
+        double v;
+        if (t != SVF_TOK_WORD) {
+            return SVF_ERR_SYNTAX;
+        }
+        if (!strcmp(tok, "MAXIMUM")) {
+            // a limit we always meet
+            if (svf_token(s, tok, NULL) != SVF_TOK_WORD || svf_token(s, tok, NULL) != SVF_TOK_WORD) {
+                return SVF_ERR_SYNTAX;
+            }
+        } else if (!strcmp(tok, "ENDSTATE")) {
+            if (svf_token(s, tok, NULL) != SVF_TOK_WORD || !svf_stable(st = svf_state_word(tok))) {
+                return SVF_ERR_SYNTAX;
+            }
+            s->run_end = (svf_state_t)st;
+            have_end = true;
+        } else if (svf_number(tok, &v)) {
+            if (svf_token(s, tok, NULL) != SVF_TOK_WORD) {
+                return SVF_ERR_SYNTAX;
+            }
+            if (!strcmp(tok, "TCK") || !strcmp(tok, "SCK")) {
+                // SCK has no pin here, counted as TCK
+                clocks = (uint32_t)v;
+            } else if (!strcmp(tok, "SEC")) {
+                min_s = v;
+            } else {
+                return SVF_ERR_SYNTAX;
+            }
+        } else {
+            return SVF_ERR_SYNTAX;
+        }
+        t = svf_token(s, tok, NULL);
+    }
+    if (have_run && !have_end) {
+        s->run_end = s->run_state;
+    }
+    tap_goto(s, s->run_state);
+    tap_wait(s, clocks, (uint32_t)(min_s * 1e6 + 0.5));
+    tap_goto(s, s->run_end);
+    return SVF_OK;
+}
+
+// STATE [path] stable: each listed state must follow the one before
+static svf_err_t svf_state_cmd(svf_t* s, char* tok) {
+    int t;
+    int st = -1;
+    while ((t = svf_token(s, tok, NULL)) == SVF_TOK_WORD) {
+        st = svf_state_word(tok);
+        if (st < 0) {
+            return SVF_ERR_SYNTAX;
+        }
+        if (st == SVF_RESET || s->state == (svf_state_t)st) {
+            tap_goto(s, (svf_state_t)st);
+        } else if (svf_next[s->state][0] == st) {
+            s->ops->tms(0, 1);
+            s->state = (svf_state_t)st;
+        } else if (svf_next[s->state][1] == st) {
+            s->ops->tms(1, 1);
+            s->state = (svf_state_t)st;
+        } else if (svf_stable(st)) {
+            // a lone stable state: the default path
+            tap_goto(s, (svf_state_t)st);
+        } else {
+            return SVF_ERR_SYNTAX;
+        }
+    }
+    return (t == ';' && svf_stable(st)) ? SVF_OK : SVF_ERR_SYNTAX;
+}
+
+static svf_err_t svf_end_state(svf_t* s, char* tok, svf_state_t* end) {
+    int st;
+    if (svf_token(s, tok, NULL) != SVF_TOK_WORD || !svf_stable(st = svf_state_word(tok)) || !svf_end(s, tok)) {
+        return SVF_ERR_SYNTAX;
+    }
+    *end = (svf_state_t)st;
+    return SVF_OK;
+}
+
+static svf_err_t svf_trst(svf_t* s, char* tok) {
+    static const char* const modes[] = { "OFF", "ON", "Z", "ABSENT" };
+    if (svf_token(s, tok, NULL) != SVF_TOK_WORD) {
+        return SVF_ERR_SYNTAX;
+    }
+    for (uint32_t i = 0; i < 4; i++) {
+        if (!strcmp(tok, modes[i])) {
+            if (!svf_end(s, tok)) {
+                return SVF_ERR_SYNTAX;
+            }
+            s->ops->trst((svf_trst_t)i);
+            return SVF_OK;
+        }
+    }
+    return SVF_ERR_SYNTAX;
+}
+
+static svf_err_t svf_frequency(svf_t* s, char* tok) {
+    double hz = 0;
+    int t = svf_token(s, tok, NULL);
+    if (t == SVF_TOK_WORD) {
+        if (!svf_number(tok, &hz) || svf_token(s, tok, NULL) != SVF_TOK_WORD || strcmp(tok, "HZ")) {
+            return SVF_ERR_SYNTAX;
+        }
+        t = svf_token(s, tok, NULL);
+    }
+    if (t != ';') {
+        return SVF_ERR_SYNTAX;
+    }
+    if (s->ops->frequency) {
+        s->tck_hz = s->ops->frequency((uint32_t)hz);
+    }
+    return SVF_OK;
+}
+
+enum {
+    SVF_CMD_SIR,
+    SVF_CMD_SDR,
+    SVF_CMD_HIR,
+    SVF_CMD_HDR,
+    SVF_CMD_TIR,
+    SVF_CMD_TDR,
+    SVF_CMD_ENDIR,
+    SVF_CMD_ENDDR,
+    SVF_CMD_STATE,
+    SVF_CMD_RUNTEST,
+    SVF_CMD_TRST,
+    SVF_CMD_FREQUENCY,
+    SVF_CMD_PIO,
+    SVF_CMD_PIOMAP,
+    SVF_CMD_COUNT
+};
+
+static const char* const svf_cmds[SVF_CMD_COUNT] = {
+    "SIR", "SDR", "HIR", "HDR", "TIR", "TDR", "ENDIR", "ENDDR", "STATE", "RUNTEST", "TRST", "FREQUENCY", "PIO", "PIOMAP",
+};
+
+static svf_err_t svf_statement(svf_t* s, uint32_t cmd, char* tok) {
+    svf_err_t err;
+    switch (cmd) {
+        case SVF_CMD_SIR:
+            err = svf_parse_scan(s, &s->sir, tok);
+            return err ? err : svf_scan(s, true);
+        case SVF_CMD_SDR:
+            err = svf_parse_scan(s, &s->sdr, tok);
+            return err ? err : svf_scan(s, false);
+        case SVF_CMD_HIR:
+            return svf_parse_scan(s, &s->hir, tok);
+        case SVF_CMD_HDR:
+            return svf_parse_scan(s, &s->hdr, tok);
+        case SVF_CMD_TIR:
+            return svf_parse_scan(s, &s->tir, tok);
+        case SVF_CMD_TDR:
+            return svf_parse_scan(s, &s->tdr, tok);
+        case SVF_CMD_ENDIR:
+            return svf_end_state(s, tok, &s->endir);
+        case SVF_CMD_ENDDR:
+            return svf_end_state(s, tok, &s->enddr);
+        case SVF_CMD_STATE:
+            return svf_state_cmd(s, tok);
+        case SVF_CMD_RUNTEST:
+            return svf_runtest(s, tok);
+        case SVF_CMD_TRST:
+            return svf_trst(s, tok);
+        case SVF_CMD_FREQUENCY:
+            return svf_frequency(s, tok);
+        default:
+            return SVF_ERR_UNSUPPORTED;
+    }
+}
+
+svf_err_t svf_play(svf_t* s) {
+    char tok[SVF_TOK_MAX];
+    svf_start(s);
+    tap_goto(s, SVF_RESET);
+    for (;;) {
+        if (s->ops->abort && s->ops->abort()) {
+            s->result.err = SVF_ERR_ABORT;
+            s->result.line = s->line;
+            return SVF_ERR_ABORT;
+        }
+        uint32_t line;
+        int t = svf_token(s, tok, &line);
+        if (t < 0) {
+            return SVF_OK;
+        }
+        uint32_t cmd = 0;
+        while (cmd < SVF_CMD_COUNT && (t != SVF_TOK_WORD || strcmp(tok, svf_cmds[cmd]))) {
+            cmd++;
+        }
+        svf_err_t err = cmd < SVF_CMD_COUNT ? svf_statement(s, cmd, tok) : SVF_ERR_SYNTAX;
+        s->result.statements++;
+        if (err) {
+            s->result.err = err;
+            s->result.line = line;
+            s->result.cmd = cmd < SVF_CMD_COUNT ? svf_cmds[cmd] : "?";
+            return err;
+        }
+    }
+}
+
+/* ── XSVF ──────────────────────────────────────────────────────── */
+
+enum {
+    XCOMPLETE = 0,
+    XTDOMASK,
+    XSIR,
+    XSDR,
+    XRUNTEST,
+    XREPEAT = 7,
+    XSDRSIZE,
+    XSDRTDO,
+    XSETSDRMASKS,
+    XSDRINC,
+    XSDRB,
+    XSDRC,
+    XSDRE,
+    XSDRTDOB,
+    XSDRTDOC,
+    XSDRTDOE,
+    XSTATE,
+    XENDIR,
+    XENDDR,
+    XSIR2,
+    XCOMMENT,
+    XWAIT,
+    XSVF_CMD_COUNT
+};
+
+static const char* const xsvf_cmds[XSVF_CMD_COUNT] = {
+    [XCOMPLETE] = "XCOMPLETE", [XTDOMASK] = "XTDOMASK", [XSIR] = "XSIR",         [XSDR] = "XSDR",
+    [XRUNTEST] = "XRUNTEST",   [5] = "?",               [6] = "?",               [XREPEAT] = "XREPEAT",
+    [XSDRSIZE] = "XSDRSIZE",   [XSDRTDO] = "XSDRTDO",   [XSETSDRMASKS] = "XSETSDRMASKS",
+    [XSDRINC] = "XSDRINC",     [XSDRB] = "XSDRB",       [XSDRC] = "XSDRC",       [XSDRE] = "XSDRE",
+    [XSDRTDOB] = "XSDRTDOB",   [XSDRTDOC] = "XSDRTDOC", [XSDRTDOE] = "XSDRTDOE", [XSTATE] = "XSTATE",
+    [XENDIR] = "XENDIR",       [XENDDR] = "XENDDR",     [XSIR2] = "XSIR2",       [XCOMMENT] = "XCOMMENT",
+    [XWAIT] = "XWAIT",
+};
+
+// big endian
+static bool xsvf_uint(svf_t* s, uint32_t bytes, uint32_t* v) {
+    *v = 0;
+    for (uint32_t i = 0; i < bytes; i++) {
+        int c = getb(s);
+        if (c < 0) {
+            return false;
+        }
+        *v = (*v << 8) | (uint32_t)c;
+    }
+    return true;
+}
+
+// most significant byte first in the file, LSB first in buf
+static svf_err_t xsvf_vector(svf_t* s, uint8_t* buf, uint32_t cap, uint32_t bits) {
+    uint32_t need = (bits + 7) / 8;
+    if (need > cap) {
+        return SVF_ERR_TOO_LONG;
+    }
+    for (uint32_t n = 0; n < need;) {
+        if (s->chunk_pos == s->chunk_len && !refill(s)) {
+            return SVF_ERR_SYNTAX;
+        }
+        uint32_t take = s->chunk_len - s->chunk_pos;
+        if (take > need - n) {
+            take = need - n;
+        }
+        memcpy(buf + n, s->chunk + s->chunk_pos, take);
+        s->chunk_pos += take;
+        n += take;
+    }
+    if (need) {
+        reverse(buf, need);
+    }
+    return SVF_OK;
+}
+
+// XRUNTEST is microseconds; clocked when waiting in Run-Test/Idle
+static void xsvf_wait(svf_t* s, uint32_t us) {
+    if (!us) {
+        return;
+    }
+    uint32_t clocks = s->state == SVF_IDLE ? (uint32_t)((uint64_t)us * s->tck_hz / 1000000u) : 0;
+    tap_wait(s, clocks, us);
+}
+
+// XSDR and XSDRTDO, with the XREPEAT retries
+static svf_err_t xsvf_shift_dr(svf_t* s, bool check) {
+    uint32_t run = s->xruntest;
+    if (!s->sdr.bits) {
+        return SVF_OK;
+    }
+    tap_goto(s, SVF_DRSHIFT);
+    for (uint32_t attempt = 0;; attempt++) {
+        s->ops->shift(s->sdr.tdi, check ? s->capture : NULL, s->sdr.bits, true);
+        s->state = SVF_DREXIT1;
+        s->result.bits += s->sdr.bits;
+        if (!check) {
+            break;
+        }
+        s->result.compares++;
+        int32_t bad = svf_compare(s->capture, s->sdr.tdo, s->sdr.mask, s->sdr.bits);
+        if (bad < 0) {
+            break;
+        }
+        if (attempt >= s->xrepeat) {
+            return mismatch(s, s->sdr.tdo, bad);
+        }
+        // Exit1-DR, Pause-DR, Exit2-DR, Shift-DR and again, waiting longer afterwards
+        s->ops->tms(0x2, 3);
+        s->state = SVF_DRSHIFT;
+        run += run / 4;
+        s->result.retries++;
+    }
+    tap_goto(s, s->enddr);
+    xsvf_wait(s, run);
+    return SVF_OK;
+}
+
+// XSDRB/C/E and XSDRTDOB/C/E: one long shift in parts, no retries
+static svf_err_t xsvf_shift_part(svf_t* s, bool check, bool begin, bool end) {
+    if (begin) {
+        tap_goto(s, SVF_DRSHIFT);
+    }
+    s->ops->shift(s->sdr.tdi, check ? s->capture : NULL, s->sdr.bits, end);
+    s->result.bits += s->sdr.bits;
+    if (end) {
+        s->state = SVF_DREXIT1;
+    }
+    if (check) {
+        s->result.compares++;
+        int32_t bad = svf_compare(s->capture, s->sdr.tdo, s->sdr.mask, s->sdr.bits);
+        if (bad >= 0) {
+            return mismatch(s, s->sdr.tdo, bad);
+        }
+    }
+    if (end) {
+        tap_goto(s, s->enddr);
+        xsvf_wait(s, s->xruntest);
+    }
+    return SVF_OK;
+}
+
+static svf_err_t xsvf_command(svf_t* s, int cmd, bool* done) {
+    uint32_t v, bits;
+    svf_err_t err;
+    switch (cmd) {
+        case XCOMPLETE:
+            *done = true;
+            return SVF_OK;
+        case XTDOMASK:
+            return xsvf_vector(s, s->sdr.mask, s->sdr.cap, s->sdr.bits);
+        case XSIR:
+        case XSIR2:
+            if (!xsvf_uint(s, cmd == XSIR ? 1 : 2, &bits)) {
+                return SVF_ERR_SYNTAX;
+            }
+            if ((err = xsvf_vector(s, s->sir.tdi, s->sir.cap, bits))) {
+                return err;
+            }
+            if (bits) {
+                tap_goto(s, SVF_IRSHIFT);
+                s->ops->shift(s->sir.tdi, NULL, bits, true);
+                s->result.bits += bits;
+                s->state = SVF_IREXIT1;
+            }
+            tap_goto(s, s->endir);
+            xsvf_wait(s, s->xruntest);
+            return SVF_OK;
+        case XSDR:
+            if ((err = xsvf_vector(s, s->sdr.tdi, s->sdr.cap, s->sdr.bits))) {
+                return err;
+            }
+            // compared with the TDO of the last XSDRTDO
+            return xsvf_shift_dr(s, s->sdr.tdo_valid);
+        case XSDRTDO:
+            if ((err = xsvf_vector(s, s->sdr.tdi, s->sdr.cap, s->sdr.bits)) ||
+                (err = xsvf_vector(s, s->sdr.tdo, s->sdr.cap, s->sdr.bits))) {
+                return err;
+            }
+            s->sdr.tdo_valid = true;
+            return xsvf_shift_dr(s, true);
+        case XRUNTEST:
+            return xsvf_uint(s, 4, &s->xruntest) ? SVF_OK : SVF_ERR_SYNTAX;
+        case XREPEAT:
+            return xsvf_uint(s, 1, &s->xrepeat) ? SVF_OK : SVF_ERR_SYNTAX;
+        case XSDRSIZE:
+            if (!xsvf_uint(s, 4, &bits)) {
+                return SVF_ERR_SYNTAX;
+            }
+            if ((bits + 7) / 8 > s->sdr.cap) {
+                return SVF_ERR_TOO_LONG;
+            }
+            if (bits != s->sdr.bits) {
+                memset(s->sdr.mask, 0xff, (bits + 7) / 8);
+                s->sdr.bits = bits;
+            }
+            return SVF_OK;
+        case XSDRB:
+        case XSDRC:
+        case XSDRE:
+            if ((err = xsvf_vector(s, s->sdr.tdi, s->sdr.cap, s->sdr.bits))) {
+                return err;
+            }
+            return xsvf_shift_part(s, false, cmd == XSDRB, cmd == XSDRE);
+        case XSDRTDOB:
+        case XSDRTDOC:
+        case XSDRTDOE:
+            if ((err = xsvf_vector(s, s->sdr.tdi, s->sdr.cap, s->sdr.bits)) ||
+                (err = xsvf_vector(s, s->sdr.tdo, s->sdr.cap, s->sdr.bits))) {
+                return err;
+            }
+            return xsvf_shift_part(s, true, cmd == XSDRTDOB, cmd == XSDRTDOE);
+        case XSTATE:
+            if (!xsvf_uint(s, 1, &v) || v >= SVF_STATE_COUNT) {
+                return SVF_ERR_SYNTAX;
+            }
+            tap_goto(s, (svf_state_t)v);
+            return SVF_OK;
+        case XENDIR:
+        case XENDDR:
+            if (!xsvf_uint(s, 1, &v) || v > 1) {
+                return SVF_ERR_SYNTAX;
+            }
+            if (cmd == XENDIR) {
+                s->endir = v ? SVF_IRPAUSE : SVF_IDLE;
+            } else {
+                s->enddr = v ? SVF_DRPAUSE : SVF_IDLE;
+            }
+            return SVF_OK;
+        case XCOMMENT: {
+            int c;
+            while ((c = getb(s)) > 0) {
+            }
+            return c < 0 ? SVF_ERR_SYNTAX : SVF_OK;
+        }
+        case XWAIT: {
+            uint32_t wait_state, end_state, us;
+            if (!xsvf_uint(s, 1, &wait_state) || !xsvf_uint(s, 1, &end_state) || !xsvf_uint(s, 4, &us) ||
+                wait_state >= SVF_STATE_COUNT || end_state >= SVF_STATE_COUNT) {
+                return SVF_ERR_SYNTAX;
+            }
+            tap_goto(s, (svf_state_t)wait_state);
+            xsvf_wait(s, us);
+            tap_goto(s, (svf_state_t)end_state);
+            return SVF_OK;
+        }
+        default:
+            return SVF_ERR_UNSUPPORTED;
+    }
+}
+
+svf_err_t xsvf_play(svf_t* s) {
+    svf_start(s);
+    memset(s->sdr.mask, 0xff, s->sdr.cap);
+    tap_goto(s, SVF_RESET);
+    bool done = false;
+    for (uint32_t n = 1; !done; n++) {
+        if (s->ops->abort && s->ops->abort()) {
+            s->result.err = SVF_ERR_ABORT;
+            s->result.line = n;
+            return SVF_ERR_ABORT;
+        }
+        int cmd = getb(s);
+        if (cmd < 0) {
+            // no XCOMPLETE, the end of the file will do
+            break;
+        }
+        svf_err_t err = xsvf_command(s, cmd, &done);
+        s->result.statements++;
+        if (err) {
+            s->result.err = err;
+            s->result.line = n;
+            s->result.cmd = cmd < XSVF_CMD_COUNT ? xsvf_cmds[cmd] : "?";
+            return err;
+        }
+    }
+    return SVF_OK;
+}
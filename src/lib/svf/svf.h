@@ -0,0 +1,184 @@
+/*
+ * svf.h — Streamed SVF and XSVF player
+ *
+ * Plays Serial Vector Format (text) and Xilinx XSVF (binary) files on a
+ * JTAG scan chain. The file is pulled through a chunk buffer with the
+ * read callback, so it can be any size. Only one statement is held at a
+ * time: TDI/TDO/MASK/SMASK vectors are decoded straight into their
+ * field buffers, the longest SDR is limited by the arena.
+ *
+ * Vectors are kept LSB first (byte 0 bit 0 is shifted first) so the
+ * shifter can stream them with DMA. SVF hex and XSVF byte strings are
+ * most significant first, they are reversed once after decoding.
+ *
+ * The TAP is driven through callbacks: TMS moves, long shifts with TMS
+ * high on the last bit, idle clocks and delays. The player tracks the
+ * TAP state itself and walks the shortest TMS path between states, which
+ * gives the SVF default paths.
+ *
+ * TDO is compared only where the file gives an expected value, a byte
+ * (or 32 bit word) at a time under MASK. The first mismatch stops the
+ * player and is reported with the statement line (SVF) or command
+ * number (XSVF) and the bit index in the scan.
+ *
+ * Supported SVF: SIR SDR HIR HDR TIR TDR ENDIR ENDDR STATE RUNTEST TRST
+ * FREQUENCY. PIO and PIOMAP are refused.
+ *
+ * Supported XSVF: XCOMPLETE XTDOMASK XSIR XSIR2 XSDR XRUNTEST XREPEAT
+ * XSDRSIZE XSDRTDO XSDRB/C/E XSDRTDOB/C/E XSTATE XENDIR XENDDR XCOMMENT
+ * XWAIT. A failed XSDRTDO is retried up to XREPEAT times through
+ * Exit1-DR, Pause-DR, Exit2-DR, Shift-DR with 25% more run time each
+ * time (XAPP503).
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef SVF_H
+#define SVF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// IEEE 1149.1 TAP states, numbered as XSVF XSTATE
+typedef enum {
+    SVF_RESET = 0,
+    SVF_IDLE,
+    SVF_DRSELECT,
+    SVF_DRCAPTURE,
+    SVF_DRSHIFT,
+    SVF_DREXIT1,
+    SVF_DRPAUSE,
+    SVF_DREXIT2,
+    SVF_DRUPDATE,
+    SVF_IRSELECT,
+    SVF_IRCAPTURE,
+    SVF_IRSHIFT,
+    SVF_IREXIT1,
+    SVF_IRPAUSE,
+    SVF_IREXIT2,
+    SVF_IRUPDATE,
+    SVF_STATE_COUNT
+} svf_state_t;
+
+typedef enum {
+    SVF_TRST_OFF = 0, // released
+    SVF_TRST_ON,      // asserted
+    SVF_TRST_Z,
+    SVF_TRST_ABSENT,
+} svf_trst_t;
+
+typedef enum {
+    SVF_OK = 0,
+    SVF_ERR_SYNTAX,
+    SVF_ERR_UNSUPPORTED,
+    SVF_ERR_TOO_LONG, // vector larger than the arena allows
+    SVF_ERR_MISMATCH,
+    SVF_ERR_ABORT,
+    SVF_ERR_COUNT
+} svf_err_t;
+
+// header/trailer and instruction vectors, bytes per field
+#define SVF_SMALL_BYTES 128
+// file chunk taken from the arena
+#define SVF_CHUNK_BYTES 4096
+
+typedef struct {
+    // clock count (<= 32) TMS bits, LSB first
+    void (*tms)(uint32_t tms, uint32_t count);
+    // shift bits from tdi LSB first, capture into tdo unless NULL, TMS high on the last bit if exit
+    void (*shift)(const uint8_t* tdi, uint8_t* tdo, uint32_t bits, bool exit);
+    // TCK with TMS low
+    void (*clocks)(uint32_t count);
+    void (*delay_us)(uint32_t us);
+    void (*trst)(svf_trst_t mode);
+    // request a TCK frequency (0 = fastest), returns the one in use; may be NULL
+    uint32_t (*frequency)(uint32_t hz);
+    // polled between statements, true stops the player; may be NULL
+    bool (*abort)(void);
+    // next part of the file, 0 at the end
+    uint32_t (*read)(uint8_t* buf, uint32_t cap);
+} svf_ops_t;
+
+typedef struct {
+    uint32_t bits;
+    uint32_t cap; // bytes per field
+    uint8_t* tdi;
+    uint8_t* tdo;
+    uint8_t* mask;
+    uint8_t* smask;
+    bool tdo_valid;
+} svf_scan_t;
+
+typedef struct {
+    svf_err_t err;
+    uint32_t line;       // SVF line or XSVF command number of the error
+    const char* cmd;     // statement of the error
+    uint32_t statements;
+    uint64_t bits;       // shifted through the chain
+    uint32_t compares;   // scans checked against TDO
+    uint32_t retries;    // XSVF repeats
+    // first mismatch
+    uint32_t bit;        // index in the compared vector, 0 is shifted first
+    uint8_t expected;
+    uint8_t actual;
+} svf_result_t;
+
+typedef struct {
+    const svf_ops_t* ops;
+    svf_state_t state;
+    svf_state_t endir, enddr;
+    svf_state_t run_state, run_end;
+    uint32_t tck_hz;
+
+    svf_scan_t hir, hdr, tir, tdr, sir, sdr;
+    uint8_t* capture; // sdr.cap bytes
+
+    // file
+    uint8_t* chunk;
+    uint32_t chunk_len, chunk_pos;
+    int peek;         // pushed back character, -1 none
+    uint32_t line;
+
+    // XSVF
+    uint32_t xruntest;
+    uint32_t xrepeat;
+
+    svf_result_t result;
+} svf_t;
+
+/**
+ * Carve the vectors and the file chunk out of arena.
+ * @param tck_hz  TCK in use, for RUNTEST times
+ * @return false if the arena is too small
+ */
+bool svf_init(svf_t* s, const svf_ops_t* ops, uint8_t* arena, uint32_t arena_len, uint32_t tck_hz);
+
+/**
+ * Play a whole file, s->result has the totals and any error.
+ */
+svf_err_t svf_play(svf_t* s);
+svf_err_t xsvf_play(svf_t* s);
+
+/**
+ * First bit where (got ^ expected) & mask is set.
+ * @return bit index, or -1 if they match
+ */
+int32_t svf_compare(const uint8_t* got, const uint8_t* expected, const uint8_t* mask, uint32_t bits);
+
+/**
+ * Next TAP state.
+ */
+svf_state_t svf_next_state(svf_state_t s, bool tms);
+
+/**
+ * Shortest TMS path, LSB first.
+ * @return number of TMS bits
+ */
+uint32_t svf_path(svf_state_t from, svf_state_t to, uint32_t* tms);
+
+const char* svf_state_name(svf_state_t s);
+const char* svf_error_text(svf_err_t err);
+
+#endif // SVF_H
@@ -0,0 +1,311 @@
+/*
+ * uart_mon.c — Two channel UART monitor: time ordered merge, hex view, log records
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "uart_mon.h"
+
+#define UMON_LANE_MASK (UMON_LANE_DEPTH - 1)
+
+/* ── Merge ─────────────────────────────────────────────────────── */
+
+void umon_merge_init(umon_merge_t* m) {
+    memset(m, 0, sizeof(*m));
+}
+
+static uint32_t lane_free(const umon_lane_t* l) {
+    return UMON_LANE_DEPTH - (l->tail - l->head);
+}
+
+// timestamps in a lane never go backwards
+static uint32_t lane_clamp(const umon_lane_t* l, uint32_t ts_us) {
+    return (l->seen && umon_before(ts_us, l->floor_us)) ? l->floor_us : ts_us;
+}
+
+static void lane_floor(umon_lane_t* l, uint32_t ts_us) {
+    if (!l->seen || umon_before(l->floor_us, ts_us)) {
+        l->floor_us = ts_us;
+    }
+    l->seen = true;
+}
+
+static umon_rec_t* lane_push(umon_lane_t* l, uint8_t type, uint8_t chan, uint32_t ts_us) {
+    umon_rec_t* r = &l->rec[l->tail & UMON_LANE_MASK];
+    r->ts_us = ts_us;
+    r->type = type;
+    r->chan = chan;
+    r->lines = 0;
+    r->len = 0;
+    r->lost = 0;
+    l->tail++;
+    return r;
+}
+
+uint32_t umon_space(const umon_merge_t* m, uint8_t chan) {
+    return lane_free(&m->lane[chan]) * UMON_CHUNK_MAX;
+}
+
+uint32_t umon_push_data(umon_merge_t* m, uint8_t chan, uint32_t ts_us, uint32_t byte_ns, const uint8_t* data, uint32_t len) {
+    umon_lane_t* l = &m->lane[chan];
+    uint32_t taken = 0;
+
+    ts_us = lane_clamp(l, ts_us);
+    while (taken < len && lane_free(l)) {
+        uint32_t n = len - taken;
+        if (n > UMON_CHUNK_MAX) {
+            n = UMON_CHUNK_MAX;
+        }
+        umon_rec_t* r = lane_push(l, UMON_REC_DATA, chan, ts_us + (uint32_t)((uint64_t)taken * byte_ns / 1000));
+        r->len = (uint8_t)n;
+        memcpy(r->data, &data[taken], n);
+        taken += n;
+    }
+    if (taken) {
+        // the next byte cannot start before this one ended
+        lane_floor(l, ts_us + (uint32_t)((uint64_t)taken * byte_ns / 1000));
+    }
+    return taken;
+}
+
+bool umon_push_drop(umon_merge_t* m, uint8_t chan, uint32_t ts_us, uint32_t lost) {
+    umon_lane_t* l = &m->lane[chan];
+    if (!lane_free(l)) {
+        return false;
+    }
+    ts_us = lane_clamp(l, ts_us);
+    lane_push(l, UMON_REC_DROP, chan, ts_us)->lost = lost;
+    lane_floor(l, ts_us);
+    return true;
+}
+
+bool umon_push_line(umon_merge_t* m, uint32_t ts_us, uint8_t lines) {
+    umon_lane_t* l = &m->lane[UMON_LANE_LINES];
+    if (!lane_free(l)) {
+        return false;
+    }
+    ts_us = lane_clamp(l, ts_us);
+    lane_push(l, UMON_REC_LINE, 0, ts_us)->lines = lines;
+    lane_floor(l, ts_us);
+    return true;
+}
+
+void umon_seen(umon_merge_t* m, uint8_t lane, uint32_t ts_us) {
+    lane_floor(&m->lane[lane], ts_us);
+}
+
+bool umon_pop(umon_merge_t* m, umon_rec_t* out, bool flush) {
+    umon_lane_t* oldest = NULL;
+    uint32_t ts = 0;
+
+    // earliest head, ties go to the lower lane
+    for (uint32_t i = 0; i < UMON_LANES; i++) {
+        umon_lane_t* l = &m->lane[i];
+        if (l->head == l->tail) {
+            continue;
+        }
+        uint32_t t = l->rec[l->head & UMON_LANE_MASK].ts_us;
+        if (!oldest || umon_before(t, ts)) {
+            oldest = l;
+            ts = t;
+        }
+    }
+    if (!oldest) {
+        return false;
+    }
+
+    // an empty lane may still push something earlier unless it was seen past ts
+    if (!flush) {
+        for (uint32_t i = 0; i < UMON_LANES; i++) {
+            umon_lane_t* l = &m->lane[i];
+            if (l->head == l->tail && (!l->seen || umon_before(l->floor_us, ts))) {
+                return false;
+            }
+        }
+    }
+
+    *out = oldest->rec[oldest->head & UMON_LANE_MASK];
+    oldest->head++;
+    return true;
+}
+
+/* ── View ──────────────────────────────────────────────────────── */
+
+void umon_fmt_init(umon_fmt_t* f,
+                   umon_write_fn write,
+                   void* ctx,
+                   uint32_t t0_us,
+                   uint32_t byte_ns,
+                   uint32_t gap_us) {
+    memset(f, 0, sizeof(*f));
+    f->write = write;
+    f->ctx = ctx;
+    f->t0_us = t0_us;
+    f->byte_ns = byte_ns;
+    f->gap_us = gap_us;
+}
+
+static int fmt_time(const umon_fmt_t* f, char* out, size_t size, uint32_t ts_us) {
+    uint32_t rel = ts_us - f->t0_us;
+    return snprintf(out, size, "%5lu.%06lu", (unsigned long)(rel / 1000000), (unsigned long)(rel % 1000000));
+}
+
+static const char* fmt_color(const umon_fmt_t* f, uint8_t chan) {
+    return f->chan_color[chan & 1] ? f->chan_color[chan & 1] : "";
+}
+
+static const char* fmt_reset(const umon_fmt_t* f) {
+    return f->reset ? f->reset : "";
+}
+
+void umon_fmt_flush(umon_fmt_t* f) {
+    char line[UMON_FMT_LINE_MAX];
+    int n;
+
+    if (!f->count) {
+        return;
+    }
+    n = snprintf(line, sizeof(line), "%s", fmt_color(f, f->chan));
+    n += fmt_time(f, &line[n], sizeof(line) - n, f->ts_us);
+    n += snprintf(&line[n], sizeof(line) - n, " %c", 'A' + f->chan);
+    for (uint32_t i = 0; i < UMON_LINE_BYTES; i++) {
+        if (i < f->count) {
+            n += snprintf(&line[n], sizeof(line) - n, " %02X", f->bytes[i]);
+        } else {
+            n += snprintf(&line[n], sizeof(line) - n, "   ");
+        }
+    }
+    line[n++] = ' ';
+    line[n++] = ' ';
+    for (uint32_t i = 0; i < f->count; i++) {
+        uint8_t c = f->bytes[i];
+        line[n++] = (c >= 0x20 && c < 0x7f) ? (char)c : '.';
+    }
+    n += snprintf(&line[n], sizeof(line) - n, "%s\r\n", fmt_reset(f));
+    f->write(f->ctx, line, (size_t)n);
+    f->count = 0;
+}
+
+static void fmt_data(umon_fmt_t* f, const umon_rec_t* r) {
+    for (uint32_t i = 0; i < r->len; i++) {
+        uint32_t ts = r->ts_us + (uint32_t)((uint64_t)i * f->byte_ns / 1000);
+        if (f->count &&
+            (f->chan != r->chan || f->count == UMON_LINE_BYTES || umon_before(f->next_us + f->gap_us, ts))) {
+            umon_fmt_flush(f);
+        }
+        if (!f->count) {
+            f->chan = r->chan;
+            f->ts_us = ts;
+        }
+        f->bytes[f->count++] = r->data[i];
+        f->next_us = ts + f->byte_ns / 1000;
+    }
+}
+
+void umon_fmt_rec(umon_fmt_t* f, const umon_rec_t* r) {
+    char line[UMON_FMT_LINE_MAX];
+    int n;
+
+    if (r->type == UMON_REC_DATA) {
+        fmt_data(f, r);
+        return;
+    }
+
+    umon_fmt_flush(f);
+    if (r->type == UMON_REC_DROP) {
+        n = snprintf(line, sizeof(line), "%s", fmt_color(f, r->chan));
+        n += fmt_time(f, &line[n], sizeof(line) - n, r->ts_us);
+        n += snprintf(&line[n],
+                      sizeof(line) - n,
+                      " %c lost %lu bytes%s\r\n",
+                      'A' + r->chan,
+                      (unsigned long)r->lost,
+                      fmt_reset(f));
+    } else {
+        n = fmt_time(f, line, sizeof(line), r->ts_us);
+        n += snprintf(&line[n],
+                      sizeof(line) - n,
+                      " - RTS %u CTS %u\r\n",
+                      (r->lines & UMON_LINE_RTS) ? 1u : 0u,
+                      (r->lines & UMON_LINE_CTS) ? 1u : 0u);
+    }
+    f->write(f->ctx, line, (size_t)n);
+}
+
+/* ── Log ───────────────────────────────────────────────────────── */
+
+static void put_le32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void umon_log_header(uint8_t out[UMON_LOG_HEADER_LEN], uint32_t baud, uint32_t t0_us) {
+    memcpy(out, "BPUM", 4);
+    out[4] = UMON_LOG_VERSION;
+    out[5] = 0;
+    out[6] = 0;
+    out[7] = 0;
+    put_le32(&out[8], baud);
+    put_le32(&out[12], t0_us);
+}
+
+bool umon_log_header_parse(const uint8_t in[UMON_LOG_HEADER_LEN], uint32_t* baud, uint32_t* t0_us) {
+    if (memcmp(in, "BPUM", 4) != 0 || in[4] != UMON_LOG_VERSION) {
+        return false;
+    }
+    *baud = get_le32(&in[8]);
+    *t0_us = get_le32(&in[12]);
+    return true;
+}
+
+size_t umon_rec_pack(const umon_rec_t* r, uint8_t* out) {
+    size_t n = UMON_REC_HEADER_LEN;
+    put_le32(out, r->ts_us);
+    out[4] = r->type;
+    out[5] = r->chan;
+    out[6] = r->lines;
+    out[7] = r->len;
+    if (r->type == UMON_REC_DROP) {
+        put_le32(&out[n], r->lost);
+        n += 4;
+    }
+    memcpy(&out[n], r->data, r->len);
+    return n + r->len;
+}
+
+size_t umon_rec_unpack(umon_rec_t* r, const uint8_t* in, size_t len) {
+    size_t n = UMON_REC_HEADER_LEN;
+    if (len < n) {
+        return 0;
+    }
+    r->ts_us = get_le32(in);
+    r->type = in[4];
+    r->chan = in[5];
+    r->lines = in[6];
+    r->len = in[7];
+    r->lost = 0;
+    if (r->type > UMON_REC_LINE || r->chan > UMON_CH_B || r->len > UMON_CHUNK_MAX ||
+        (r->type != UMON_REC_DATA && r->len)) {
+        return 0;
+    }
+    if (r->type == UMON_REC_DROP) {
+        if (len < n + 4) {
+            return 0;
+        }
+        r->lost = get_le32(&in[n]);
+        n += 4;
+    }
+    if (len < n + r->len) {
+        return 0;
+    }
+    memcpy(r->data, &in[n], r->len);
+    return n + r->len;
+}
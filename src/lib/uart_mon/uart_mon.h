@@ -0,0 +1,203 @@
+/*
+ * uart_mon.h — Two channel UART monitor: time ordered merge, hex view, log records
+ *
+ * The monitor samples two UART receivers (A and B, one per direction of
+ * a full duplex link) and the RTS/CTS lines. Each source pushes records
+ * into its own lane:
+ *
+ *   - data: up to UMON_CHUNK_MAX bytes, stamped with the estimated start
+ *     of the first byte, longer chunks are split with the byte time
+ *   - drop: bytes lost on a channel (the DMA ring was overwritten)
+ *   - line: new RTS/CTS levels, stamped when the change was seen
+ *
+ * Timestamps in a lane never go backwards, the push functions clamp them.
+ * umon_seen() tells the merge that a source was looked at up to a time,
+ * nothing earlier will come from it. umon_pop() releases the oldest
+ * record once every other lane either has a later record waiting or was
+ * seen past it, so A and B come out in time order however they were
+ * polled. Times are 32 bit microseconds and may wrap.
+ *
+ * The formatter turns records into an interleaved hex/ASCII view:
+ *
+ *       0.001234 A 48 65 6C 6C 6F 0D 0A                             Hello..
+ *       0.001500 B 4F 4B 0D 0A                                      OK..
+ *       0.002000 - RTS 0 CTS 1
+ *       0.002100 A lost 12 bytes
+ *
+ * Bytes of one channel stay on one line until it is full, the other
+ * channel or a line event comes in between, or the channel was quiet
+ * for more than gap_us.
+ *
+ * Log files hold the packed records after a header:
+ *
+ *   "BPUM" version(1) reserved(3) baud(4) t0_us(4)
+ *   record: ts_us(4) type(1) chan(1) lines(1) len(1) lost(4, drop only) data(len)
+ *
+ * Numbers are little endian.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef UART_MON_H
+#define UART_MON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// data bytes per record, and per view line
+#define UMON_CHUNK_MAX 32
+#define UMON_LINE_BYTES 16
+// records waiting per lane, power of 2
+#define UMON_LANE_DEPTH 32
+
+#define UMON_CH_A 0
+#define UMON_CH_B 1
+#define UMON_LANE_LINES 2
+#define UMON_LANES 3
+
+// line record bits
+#define UMON_LINE_RTS (1u << 0)
+#define UMON_LINE_CTS (1u << 1)
+
+#define UMON_LOG_VERSION 1
+#define UMON_LOG_HEADER_LEN 16
+#define UMON_REC_HEADER_LEN 8
+// largest packed record
+#define UMON_REC_PACKED_MAX (UMON_REC_HEADER_LEN + 4 + UMON_CHUNK_MAX)
+// longest formatted view line
+#define UMON_FMT_LINE_MAX 160
+
+typedef enum {
+    UMON_REC_DATA = 0,
+    UMON_REC_DROP,
+    UMON_REC_LINE,
+} umon_rec_type_t;
+
+typedef struct {
+    uint32_t ts_us;
+    uint8_t type;  // umon_rec_type_t
+    uint8_t chan;  // UMON_CH_A/B, 0 for line records
+    uint8_t lines; // line records: UMON_LINE_* levels
+    uint8_t len;   // data records: bytes in data
+    uint32_t lost; // drop records: bytes lost
+    uint8_t data[UMON_CHUNK_MAX];
+} umon_rec_t;
+
+typedef struct {
+    umon_rec_t rec[UMON_LANE_DEPTH];
+    uint32_t head; // free running, next pop
+    uint32_t tail; // free running, next push
+    uint32_t floor_us; // earliest time the next record may have
+    bool seen;         // floor_us is valid
+} umon_lane_t;
+
+typedef struct {
+    umon_lane_t lane[UMON_LANES];
+} umon_merge_t;
+
+// takes len bytes of formatted text
+typedef void (*umon_write_fn)(void* ctx, const char* buf, size_t len);
+
+typedef struct {
+    umon_write_fn write;
+    void* ctx;
+    uint32_t t0_us;   // shown as 0.000000
+    uint32_t byte_ns; // one character on the wire
+    uint32_t gap_us;  // quiet time that starts a new line
+    // optional escape sequences, NULL for none
+    const char* chan_color[2];
+    const char* reset;
+
+    // line being filled
+    uint8_t chan;
+    uint8_t count;
+    uint32_t ts_us;
+    uint32_t next_us; // expected time of the next byte
+    uint8_t bytes[UMON_LINE_BYTES];
+} umon_fmt_t;
+
+/** a is earlier than b, wrap safe */
+static inline bool umon_before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+/* ── Merge ─────────────────────────────────────────────────────── */
+
+void umon_merge_init(umon_merge_t* m);
+
+/**
+ * Data bytes lane chan can take right now.
+ */
+uint32_t umon_space(const umon_merge_t* m, uint8_t chan);
+
+/**
+ * Push bytes received on chan, the first byte started at ts_us, the next
+ * ones follow every byte_ns nanoseconds.
+ * @return bytes taken, less than len when the lane is full
+ */
+uint32_t umon_push_data(umon_merge_t* m, uint8_t chan, uint32_t ts_us, uint32_t byte_ns, const uint8_t* data, uint32_t len);
+
+/**
+ * Note lost bytes on chan.
+ * @return false when the lane is full
+ */
+bool umon_push_drop(umon_merge_t* m, uint8_t chan, uint32_t ts_us, uint32_t lost);
+
+/**
+ * Note new RTS/CTS levels.
+ * @return false when the lane is full
+ */
+bool umon_push_line(umon_merge_t* m, uint32_t ts_us, uint8_t lines);
+
+/**
+ * Lane (UMON_CH_A, UMON_CH_B or UMON_LANE_LINES) will push nothing
+ * earlier than ts_us.
+ */
+void umon_seen(umon_merge_t* m, uint8_t lane, uint32_t ts_us);
+
+/**
+ * Take the oldest record if no lane can still push an earlier one.
+ * With flush set, take the oldest record waiting regardless.
+ * @return false when nothing can be taken
+ */
+bool umon_pop(umon_merge_t* m, umon_rec_t* out, bool flush);
+
+/* ── View ──────────────────────────────────────────────────────── */
+
+void umon_fmt_init(umon_fmt_t* f,
+                   umon_write_fn write,
+                   void* ctx,
+                   uint32_t t0_us,
+                   uint32_t byte_ns,
+                   uint32_t gap_us);
+
+void umon_fmt_rec(umon_fmt_t* f, const umon_rec_t* r);
+
+/**
+ * Write the line being filled.
+ */
+void umon_fmt_flush(umon_fmt_t* f);
+
+/* ── Log ───────────────────────────────────────────────────────── */
+
+void umon_log_header(uint8_t out[UMON_LOG_HEADER_LEN], uint32_t baud, uint32_t t0_us);
+
+/**
+ * @return false when not a log header or a newer version
+ */
+bool umon_log_header_parse(const uint8_t in[UMON_LOG_HEADER_LEN], uint32_t* baud, uint32_t* t0_us);
+
+/**
+ * @return bytes written to out, at most UMON_REC_PACKED_MAX
+ */
+size_t umon_rec_pack(const umon_rec_t* r, uint8_t* out);
+
+/**
+ * @return bytes used from in, 0 when len is too short or the record is bad
+ */
+size_t umon_rec_unpack(umon_rec_t* r, const uint8_t* in, size_t len);
+
+#endif // UART_MON_H
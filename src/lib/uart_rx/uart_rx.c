@@ -0,0 +1,142 @@
+/*
+ * uart_rx.c — UART receive ring with per byte error flags and a line view
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "uart_rx.h"
+
+/* ── Ring ──────────────────────────────────────────────────────── */
+
+void urx_init(urx_ring_t* r, const volatile uint16_t* ring, uint32_t len) {
+    memset(r, 0, sizeof(*r));
+    r->ring = ring;
+    r->len = len;
+}
+
+uint32_t urx_advance(urx_ring_t* r, uint32_t written) {
+    uint32_t lost = 0;
+    r->written = written;
+    uint32_t avail = urx_avail(r);
+    if (avail > r->peak) {
+        r->peak = avail;
+    }
+    if (avail > r->len - URX_MARGIN) {
+        // lapped, keep a margin from the entry the DMA is writing now
+        lost = avail - r->len / 2;
+        r->read += lost;
+        r->lost += lost;
+    }
+    return lost;
+}
+
+bool urx_get(urx_ring_t* r, uint16_t* entry) {
+    if (r->read == r->written) {
+        return false;
+    }
+    uint16_t e = r->ring[r->read & (r->len - 1)];
+    r->read++;
+    uint32_t err = URX_ENTRY_ERR(e);
+    for (uint32_t i = 0; err; i++, err >>= 1) {
+        if (err & 1) {
+            r->errors[i]++;
+        }
+    }
+    *entry = e;
+    return true;
+}
+
+void urx_flush(urx_ring_t* r) {
+    r->read = r->written;
+}
+
+/* ── View ──────────────────────────────────────────────────────── */
+
+static const char* const urx_err_text[URX_ERR_COUNT] = { "!FE", "!PE", "!BE", "!OE" };
+
+void urx_fmt_init(urx_fmt_t* f,
+                  line_fmt_t* line,
+                  const line_fmt_colors_t* colors,
+                  uint32_t format,
+                  uint32_t num_bits,
+                  uint32_t t0_us,
+                  uint32_t gap_us,
+                  bool timestamps) {
+    memset(f, 0, sizeof(*f));
+    f->line = line;
+    f->colors = colors;
+    f->format = format;
+    f->num_bits = num_bits;
+    f->t0_us = t0_us;
+    f->gap_us = gap_us;
+    f->timestamps = timestamps;
+}
+
+static void fmt_time(urx_fmt_t* f, uint32_t ts_us) {
+    uint32_t rel = ts_us - f->t0_us;
+    char* p = line_fmt_reserve(f->line, 24);
+    f->line->len += (uint32_t)snprintf(
+        p, 24, "%5lu.%06lu ", (unsigned long)(rel / 1000000), (unsigned long)(rel % 1000000));
+}
+
+void urx_fmt_end(urx_fmt_t* f) {
+    if (f->count) {
+        line_fmt_put(f->line, "\r\n", 2);
+        line_fmt_flush(f->line);
+        f->count = 0;
+    }
+}
+
+void urx_fmt_entry(urx_fmt_t* f, uint16_t entry, uint32_t ts_us) {
+    if (f->count && (f->count == URX_LINE_VALUES || ts_us - f->last_us > f->gap_us)) {
+        urx_fmt_end(f);
+    }
+    if (f->count) {
+        line_fmt_putc(f->line, ' ');
+    } else if (f->timestamps) {
+        fmt_time(f, ts_us);
+    }
+    if (f->format == LINE_FMT_ASCII) {
+        line_fmt_ascii(f->line, URX_ENTRY_DATA(entry));
+    }
+    line_fmt_number(f->line, f->colors, URX_ENTRY_DATA(entry), f->num_bits, f->format);
+    uint32_t err = URX_ENTRY_ERR(entry);
+    for (uint32_t i = 0; err; i++, err >>= 1) {
+        if (err & 1) {
+            line_fmt_puts(f->line, urx_err_text[i]);
+        }
+    }
+    f->count++;
+    f->last_us = ts_us;
+}
+
+void urx_fmt_lost(urx_fmt_t* f, uint32_t lost, uint32_t ts_us) {
+    urx_fmt_end(f);
+    if (f->timestamps) {
+        fmt_time(f, ts_us);
+    }
+    line_fmt_puts(f->line, "lost ");
+    line_fmt_dec(f->line, lost);
+    line_fmt_puts(f->line, " bytes\r\n");
+    line_fmt_flush(f->line);
+}
+
+void urx_fmt_idle(urx_fmt_t* f, uint32_t now_us) {
+    if (f->count && now_us - f->last_us > f->gap_us) {
+        urx_fmt_end(f);
+    }
+}
+
+uint32_t urx_fmt_drain(urx_fmt_t* f, urx_ring_t* r, uint32_t now_us, uint32_t byte_ns) {
+    uint32_t avail = urx_avail(r);
+    uint32_t start_us = now_us - (uint32_t)((uint64_t)avail * byte_ns / 1000);
+    uint16_t e;
+    // stamped with their end, the last byte ends at now_us
+    for (uint32_t i = 0; i < avail && urx_get(r, &e); i++) {
+        urx_fmt_entry(f, e, start_us + (uint32_t)((uint64_t)(i + 1) * byte_ns / 1000));
+    }
+    urx_fmt_idle(f, now_us);
+    return avail;
+}
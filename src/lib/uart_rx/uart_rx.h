@@ -0,0 +1,138 @@
+/*
+ * uart_rx.h — UART receive ring with per byte error flags and a line view
+ *
+ * The UART mode keeps a DMA channel copying the UART data register into
+ * a ring of 16 bit entries while the mode is active. The data register
+ * carries the receive errors next to the byte, so every entry keeps its
+ * own flags:
+ *
+ *   bits 7:0  data
+ *   bit  8    FE framing error
+ *   bit  9    PE parity error
+ *   bit  10   BE break
+ *   bit  11   OE the UART FIFO overflowed before this byte
+ *
+ * urx_advance() takes the DMA's free running write count. When the reader
+ * has been lapped the oldest entries are dropped, half a ring's worth so
+ * the DMA has room again, and returned so they can be reported.
+ *
+ * The view renders waiting bytes a line at a time through lib/line_fmt,
+ * in the syntax number format:
+ *
+ *       0.001234 0x48 0x65 0x6C 0x6C 0x6F!FE 0x0D 0x0A
+ *       0.002100 lost 12 bytes
+ *
+ * A line ends when it holds URX_LINE_VALUES bytes or the UART was quiet
+ * for more than gap_us. The time column is optional.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef UART_RX_H
+#define UART_RX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "lib/line_fmt/line_fmt.h"
+
+#define URX_ERR_FE (1u << 0)
+#define URX_ERR_PE (1u << 1)
+#define URX_ERR_BE (1u << 2)
+#define URX_ERR_OE (1u << 3)
+#define URX_ERR_COUNT 4
+
+#define URX_ENTRY_DATA(entry) ((uint8_t)(entry))
+#define URX_ENTRY_ERR(entry) (((entry) >> 8) & 0x0f)
+
+// a lapped reader stays this many entries behind the DMA
+#define URX_MARGIN 16
+// bytes per view line
+#define URX_LINE_VALUES 16
+
+typedef struct {
+    const volatile uint16_t* ring;
+    uint32_t len;     // entries, power of 2
+    uint32_t written; // entries written by the DMA, free running
+    uint32_t read;    // entries taken, free running
+    uint32_t lost;
+    uint32_t peak;    // most entries waiting
+    uint32_t errors[URX_ERR_COUNT]; // FE, PE, BE, OE seen by urx_get()
+} urx_ring_t;
+
+typedef struct {
+    line_fmt_t* line;
+    const line_fmt_colors_t* colors;
+    uint32_t format;   // LINE_FMT_*, not LINE_FMT_AUTO
+    uint32_t num_bits;
+    bool timestamps;
+    uint32_t t0_us;    // shown as 0.000000
+    uint32_t gap_us;   // quiet time that ends a line
+
+    uint32_t count;    // bytes on the current line
+    uint32_t last_us;  // time of the last byte
+} urx_fmt_t;
+
+/* ── Ring ──────────────────────────────────────────────────────── */
+
+void urx_init(urx_ring_t* r, const volatile uint16_t* ring, uint32_t len);
+
+/**
+ * The DMA has written `written` entries since urx_init(), free running.
+ * @return entries dropped because the reader was lapped
+ */
+uint32_t urx_advance(urx_ring_t* r, uint32_t written);
+
+static inline uint32_t urx_avail(const urx_ring_t* r) {
+    return r->written - r->read;
+}
+
+/**
+ * Take the oldest entry, counting its error flags.
+ * @return false when the ring is empty
+ */
+bool urx_get(urx_ring_t* r, uint16_t* entry);
+
+/**
+ * Drop everything waiting.
+ */
+void urx_flush(urx_ring_t* r);
+
+/* ── View ──────────────────────────────────────────────────────── */
+
+void urx_fmt_init(urx_fmt_t* f,
+                  line_fmt_t* line,
+                  const line_fmt_colors_t* colors,
+                  uint32_t format,
+                  uint32_t num_bits,
+                  uint32_t t0_us,
+                  uint32_t gap_us,
+                  bool timestamps);
+
+void urx_fmt_entry(urx_fmt_t* f, uint16_t entry, uint32_t ts_us);
+
+/**
+ * Note lost bytes on a line of its own.
+ */
+void urx_fmt_lost(urx_fmt_t* f, uint32_t lost, uint32_t ts_us);
+
+/**
+ * End the current line if nothing came for gap_us at now_us.
+ */
+void urx_fmt_idle(urx_fmt_t* f, uint32_t now_us);
+
+/**
+ * End the current line now.
+ */
+void urx_fmt_end(urx_fmt_t* f);
+
+/**
+ * Render everything waiting in the ring. The bytes are taken to have
+ * arrived back to back up to now_us, one every byte_ns.
+ * @return bytes rendered
+ */
+uint32_t urx_fmt_drain(urx_fmt_t* f, urx_ring_t* r, uint32_t now_us, uint32_t byte_ns);
+
+#endif // UART_RX_H
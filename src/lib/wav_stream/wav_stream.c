@@ -0,0 +1,251 @@
+/*
+ * wav_stream.c — WAV (RIFF) parsing and PCM conversion for I2S streaming
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#include <string.h>
+#include "wav_stream.h"
+
+#define WAV_FORMAT_PCM 0x0001
+#define WAV_FORMAT_EXTENSIBLE 0xfffe
+
+// KSDATAFORMAT_SUBTYPE_PCM after the format tag: 00000001-0000-0010-8000-00aa00389b71
+static const uint8_t wav_pcm_guid_tail[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80,
+                                               0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 };
+
+static uint16_t wav_le16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t wav_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void wav_put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void wav_put32(uint8_t* p, uint32_t v) {
+    wav_put16(p, (uint16_t)v);
+    wav_put16(&p[2], (uint16_t)(v >> 16));
+}
+
+/* ── Parser ───────────────────────────────────────────────────── */
+
+static wav_status_t wav_parse_fmt(wav_info_t* info, const uint8_t* fmt, uint32_t size) {
+    if (size < 16) {
+        return WAV_UNSUPPORTED;
+    }
+    uint16_t tag = wav_le16(&fmt[0]);
+    if (tag == WAV_FORMAT_EXTENSIBLE) {
+        // cbSize(2) validBits(2) channelMask(4) subFormat GUID(16)
+        if (size < 40 || wav_le16(&fmt[16]) < 22 || wav_le16(&fmt[24]) != WAV_FORMAT_PCM ||
+            memcmp(&fmt[26], wav_pcm_guid_tail, sizeof(wav_pcm_guid_tail)) != 0) {
+            return WAV_UNSUPPORTED;
+        }
+    } else if (tag != WAV_FORMAT_PCM) {
+        return WAV_UNSUPPORTED;
+    }
+
+    info->channels = wav_le16(&fmt[2]);
+    info->rate = wav_le32(&fmt[4]);
+    info->block_align = wav_le16(&fmt[12]);
+    info->bits = wav_le16(&fmt[14]);
+
+    if (info->channels == 0 || info->channels > WAV_MAX_CHANNELS || info->rate == 0) {
+        return WAV_UNSUPPORTED;
+    }
+    if (info->bits != 8 && info->bits != 16 && info->bits != 24) {
+        return WAV_UNSUPPORTED;
+    }
+    if (info->block_align != info->channels * (info->bits / 8)) {
+        return WAV_UNSUPPORTED;
+    }
+    return WAV_OK;
+}
+
+wav_status_t wav_parse(wav_info_t* info, wav_read_at_fn read_at, void* ctx, uint32_t file_size) {
+    uint8_t buf[40];
+    bool have_fmt = false;
+
+    memset(info, 0, sizeof(*info));
+
+    if (file_size < 12 || read_at(ctx, 0, buf, 12) != 12 || memcmp(buf, "RIFF", 4) != 0) {
+        return WAV_NOT_RIFF;
+    }
+    if (memcmp(&buf[8], "WAVE", 4) != 0) {
+        return WAV_NOT_WAVE;
+    }
+
+    // walk the chunks, each is id(4) size(4) and the data padded to an even length
+    uint32_t offset = 12;
+    while (true) {
+        if (offset >= file_size) {
+            return have_fmt ? WAV_NO_DATA : WAV_NO_FMT;
+        }
+        if (file_size - offset < 8 || read_at(ctx, offset, buf, 8) != 8) {
+            return WAV_TRUNCATED;
+        }
+        uint32_t size = wav_le32(&buf[4]);
+        uint32_t body = offset + 8;
+
+        if (memcmp(buf, "fmt ", 4) == 0) {
+            uint32_t len = (size < sizeof(buf)) ? size : sizeof(buf);
+            if (file_size - body < len || read_at(ctx, body, buf, len) != len) {
+                return WAV_TRUNCATED;
+            }
+            wav_status_t status = wav_parse_fmt(info, buf, size);
+            if (status != WAV_OK) {
+                return status;
+            }
+            have_fmt = true;
+        } else if (memcmp(buf, "data", 4) == 0) {
+            if (!have_fmt) {
+                return WAV_NO_FMT;
+            }
+            // streaming writers leave 0 or 0xffffffff here, take what the file holds
+            if (size == 0 || size > file_size - body) {
+                size = file_size - body;
+            }
+            info->data_offset = body;
+            info->frames = size / info->block_align;
+            info->data_size = info->frames * info->block_align;
+            return WAV_OK;
+        }
+
+        uint32_t next = body + size + (size & 1);
+        if (next < body) {
+            return WAV_TRUNCATED; // size wrapped
+        }
+        offset = next;
+    }
+}
+
+const char* wav_status_str(wav_status_t status) {
+    switch (status) {
+        case WAV_OK:
+            return "OK";
+        case WAV_NOT_RIFF:
+            return "Not a RIFF file";
+        case WAV_NOT_WAVE:
+            return "Not a WAVE file";
+        case WAV_NO_FMT:
+            return "No fmt chunk before the data";
+        case WAV_NO_DATA:
+            return "No data chunk";
+        case WAV_UNSUPPORTED:
+            return "Only 8, 16 and 24-bit PCM is supported";
+        case WAV_TRUNCATED:
+        default:
+            return "File is truncated";
+    }
+}
+
+/* ── Playback conversion ──────────────────────────────────────── */
+
+// one sample as signed 16-bit, 8-bit PCM is unsigned and 24-bit keeps the top 16 bits
+static uint16_t wav_sample16(const uint8_t* p, uint16_t bits) {
+    switch (bits) {
+        case 8:
+            return (uint16_t)((p[0] ^ 0x80) << 8);
+        case 16:
+            return wav_le16(p);
+        default:
+            return wav_le16(&p[1]);
+    }
+}
+
+uint32_t wav_convert(const wav_info_t* info, const uint8_t* in, uint32_t frames, uint32_t* out) {
+    // the common layouts get their own loops
+    if (info->bits == 16 && info->channels == 2) {
+        for (uint32_t i = 0; i < frames; i++, in += 4) {
+            out[i] = ((uint32_t)wav_le16(in) << 16) | wav_le16(&in[2]);
+        }
+        return frames;
+    }
+    if (info->bits == 16 && info->channels == 1) {
+        for (uint32_t i = 0; i < frames; i++, in += 2) {
+            uint32_t s = wav_le16(in);
+            out[i] = (s << 16) | s;
+        }
+        return frames;
+    }
+
+    uint16_t width = info->bits / 8;
+    const uint8_t* right = (info->channels == 1) ? in : &in[width];
+    for (uint32_t i = 0; i < frames; i++) {
+        out[i] = ((uint32_t)wav_sample16(in, info->bits) << 16) | wav_sample16(right, info->bits);
+        in += info->block_align;
+        right += info->block_align;
+    }
+    return frames;
+}
+
+void wav_stream_init(wav_stream_t* s, const wav_info_t* info) {
+    s->info = info;
+    s->carry_len = 0;
+}
+
+uint32_t wav_stream_feed(wav_stream_t* s, const uint8_t* in, size_t len, uint32_t* out) {
+    uint16_t align = s->info->block_align;
+    uint32_t n = 0;
+
+    // finish the frame split over the last read
+    if (s->carry_len) {
+        size_t take = align - s->carry_len;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(&s->carry[s->carry_len], in, take);
+        s->carry_len += (uint8_t)take;
+        in += take;
+        len -= take;
+        if (s->carry_len < align) {
+            return 0;
+        }
+        n = wav_convert(s->info, s->carry, 1, out);
+        s->carry_len = 0;
+    }
+
+    uint32_t frames = (uint32_t)(len / align);
+    n += wav_convert(s->info, in, frames, &out[n]);
+
+    size_t rest = len - (size_t)frames * align;
+    memcpy(s->carry, &in[(size_t)frames * align], rest);
+    s->carry_len = (uint8_t)rest;
+    return n;
+}
+
+/* ── Recording ────────────────────────────────────────────────── */
+
+size_t wav_header_build(uint8_t* out, uint16_t channels, uint32_t rate, uint16_t bits, uint32_t data_size) {
+    uint16_t align = channels * (bits / 8);
+    memcpy(&out[0], "RIFF", 4);
+    wav_put32(&out[4], 36 + data_size);
+    memcpy(&out[8], "WAVEfmt ", 8);
+    wav_put32(&out[16], 16);
+    wav_put16(&out[20], WAV_FORMAT_PCM);
+    wav_put16(&out[22], channels);
+    wav_put32(&out[24], rate);
+    wav_put32(&out[28], rate * align);
+    wav_put16(&out[32], align);
+    wav_put16(&out[34], bits);
+    memcpy(&out[36], "data", 4);
+    wav_put32(&out[40], data_size);
+    return WAV_HEADER_LEN;
+}
+
+size_t wav_from_i2s_in(const uint32_t* words, uint32_t count, uint16_t bits, uint8_t* out) {
+    uint8_t* p = out;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t s = words[i] << 1; // drop the bit before the MSB
+        if (bits == 24) {
+            *p++ = (uint8_t)(s >> 8);
+        }
+        *p++ = (uint8_t)(s >> 16);
+        *p++ = (uint8_t)(s >> 24);
+    }
+    return (size_t)(p - out);
+}
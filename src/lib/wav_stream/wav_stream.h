@@ -0,0 +1,108 @@
+/*
+ * wav_stream.h — WAV (RIFF) parsing and PCM conversion for I2S streaming
+ *
+ * The parser walks the RIFF chunk list instead of assuming the 44 byte
+ * canonical header, so files with LIST/INFO, fact or odd sized chunks
+ * and WAVE_FORMAT_EXTENSIBLE headers play. The data chunk is clamped to
+ * the file size for recordings that were never finalized.
+ *
+ * The converter turns 8, 16 or 24-bit PCM with any channel count into
+ * i2s_out FIFO words, (left << 16) | right. Mono is sent to both sides,
+ * past two channels only the first two are used. The stream version
+ * keeps a partial frame between calls so a file can be fed in reads of
+ * any size.
+ *
+ * The recorder side builds the canonical header and turns i2s_in words
+ * (one left slot per frame, MSB at bit 30 after the I2S delay bit) into
+ * little endian PCM.
+ *
+ * This file has no Pico SDK dependencies so it can be tested on the host.
+ *
+ * Copyright (c) 2026 Bus Pirate project. MIT License.
+ */
+
+#ifndef WAV_STREAM_H
+#define WAV_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define WAV_HEADER_LEN 44
+// largest frame we convert: 8 channels of 24-bit
+#define WAV_MAX_CHANNELS 8
+#define WAV_FRAME_MAX (WAV_MAX_CHANNELS * 3)
+
+typedef enum {
+    WAV_OK = 0,
+    WAV_NOT_RIFF,    // no RIFF header
+    WAV_NOT_WAVE,    // RIFF, but not WAVE
+    WAV_NO_FMT,      // no fmt chunk before the data chunk
+    WAV_NO_DATA,     // no data chunk
+    WAV_UNSUPPORTED, // not 8/16/24-bit integer PCM, or a bad block align
+    WAV_TRUNCATED,   // a chunk header runs past the end of the file
+} wav_status_t;
+
+typedef struct {
+    uint16_t channels;
+    uint16_t bits; // container bits per sample: 8, 16 or 24
+    uint16_t block_align;
+    uint32_t rate;
+    uint32_t data_offset; // first byte of the samples
+    uint32_t data_size;   // bytes of samples, clamped to the file
+    uint32_t frames;
+} wav_info_t;
+
+// reads up to len bytes at offset, returns the bytes read
+typedef size_t (*wav_read_at_fn)(void* ctx, uint32_t offset, uint8_t* buf, size_t len);
+
+/**
+ * Find the fmt and data chunks of a file_size byte file.
+ */
+wav_status_t wav_parse(wav_info_t* info, wav_read_at_fn read_at, void* ctx, uint32_t file_size);
+
+const char* wav_status_str(wav_status_t status);
+
+/**
+ * Convert whole frames to i2s_out words.
+ * @return words written, one per frame
+ */
+uint32_t wav_convert(const wav_info_t* info, const uint8_t* in, uint32_t frames, uint32_t* out);
+
+typedef struct {
+    const wav_info_t* info;
+    uint8_t carry[WAV_FRAME_MAX]; // partial frame from the last feed
+    uint8_t carry_len;
+} wav_stream_t;
+
+void wav_stream_init(wav_stream_t* s, const wav_info_t* info);
+
+/**
+ * Convert len bytes of the data chunk, any split is fine.
+ * out must hold len / block_align + 1 words.
+ * @return words written
+ */
+uint32_t wav_stream_feed(wav_stream_t* s, const uint8_t* in, size_t len, uint32_t* out);
+
+/**
+ * Bytes to read at file position pos so every read after the first one
+ * starts on a chunk boundary (chunk a multiple of the sector size) and
+ * FatFs can copy whole sectors straight into the buffer.
+ */
+static inline uint32_t wav_read_len(uint32_t pos, uint32_t chunk, uint32_t remaining) {
+    uint32_t len = chunk - (pos % chunk);
+    return (len < remaining) ? len : remaining;
+}
+
+/**
+ * Canonical 44 byte PCM header, data_size may be patched in later.
+ */
+size_t wav_header_build(uint8_t* out, uint16_t channels, uint32_t rate, uint16_t bits, uint32_t data_size);
+
+/**
+ * i2s_in words to 16 or 24-bit mono little endian PCM.
+ * @return bytes written, count * bits / 8
+ */
+size_t wav_from_i2s_in(const uint32_t* words, uint32_t count, uint16_t bits, uint8_t* out);
+
+#endif // WAV_STREAM_H
@@ -20,11 +20,18 @@
 #include "pirate/bio.h" // Buffered pin IO functions
 #include "ui/ui_help.h"
 #include "dummy1.h"
+#include "lib/bp_args/bp_cmd.h"
+#include "commands/dio/pattern.h"
 
 static const char labels[][5] = { "AUXL", "AUXH" };
 
 // command configuration
-const struct _mode_command_struct dio_commands[] = { 0 };
+const struct _mode_command_struct dio_commands[] = {
+    {   .func=&pattern_handler,
+        .def=&pattern_def,
+        .supress_fala_capture=false
+    },
+};
 const uint32_t dio_commands_count = count_of(dio_commands);
 
 // Pre-setup step. Show user menus for any configuration options.
@@ -62,25 +69,30 @@ void dio_cleanup(void) {
 
 // Handler for any numbers the user enters (1, 0x01, 0b1) or string data "string"
 // This function generally writes data out to the IO pins or a peripheral
-void dio_write(struct _bytecode* result, struct _bytecode* next) {
-    uint8_t mask = 0;
+// Label the pins in mask as driven outputs at levels, returns the IO assigned pins of mask
+uint8_t dio_label_outputs(uint8_t mask, uint8_t levels) {
     for (uint8_t i = 0; i < 8; i++) {
         // respect any existing pin functions
         if(system_config.pin_func[i+1] != BP_PIN_IO){
+            mask &= ~(0x01 << i);
+        }
+        if(!(mask & (0x01 << i))){
             continue;
         }
 
-        //update this pin in the mask
-        mask |= (0x01 << i);
-
         //update pin labels and purposes
-        if (result->out_data & (0b1 << i)) {
+        if (levels & (0b1 << i)) {
             system_bio_update_purpose_and_label(true, i, BP_PIN_IO, labels[1]);
         } else {
             system_bio_update_purpose_and_label(true, i, BP_PIN_IO, labels[0]);
         }
         system_set_active(true, i, &system_config.aux_active);
     }
+    return mask;
+}
+
+void dio_write(struct _bytecode* result, struct _bytecode* next) {
+    uint8_t mask = dio_label_outputs(0xff, result->out_data);
     gpio_put_masked(((uint32_t)mask), 0xff); // make buffers outputs
     gpio_put_masked(((uint32_t)mask<<8), ((uint32_t)result->out_data << 8u));
     gpio_set_dir_masked(((uint32_t)mask<<8), 0xff<<8); // make pins outputs
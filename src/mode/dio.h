@@ -5,6 +5,7 @@
  */
 
 void dio_write(struct _bytecode* result, struct _bytecode* next);
+uint8_t dio_label_outputs(uint8_t mask, uint8_t levels);
 void dio_read(struct _bytecode* result, struct _bytecode* next);
 void dio_start(struct _bytecode* result, struct _bytecode* next);
 void dio_stop(struct _bytecode* result, struct _bytecode* next);
@@ -21,6 +21,8 @@
 #include "pirate/bio.h"
 #include "commands/global/w_psu.h"
 #include "commands/global/p_pullups.h"
+#include "pirate/freq_pio.h"
+#include "toolbars/pin_watcher.h"
 #include "ui/ui_help.h"
 
 const char* hiz_pins(void) {
@@ -44,6 +46,10 @@ uint32_t hiz_setup_exec(void) {
     psucmd_disable();  // turn off power supply
     pullups_disable(); // deactivate
     system_config.freq_active = 0;
+    // the pin watcher toolbar keeps counting edges across mode changes
+    if (!pin_watcher_is_active()) {
+        freq_pio_stop();
+    }
     system_config.pwm_active = 0;
     system_config.aux_active = 0;
     for (int i = 0; i < count_of(bio2bufiopin); i++) {
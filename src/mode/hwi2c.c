@@ -32,6 +32,7 @@
 #include "commands/i2c/scan.h"
 #include "commands/i2c/demos.h"
 #include "commands/i2c/sniff.h"
+#include "commands/i2c/replay.h"
 #include "ui/ui_term.h"
 #include "ui/ui_help.h"
 #include "commands/i2c/ddr5.h"
@@ -61,6 +62,11 @@ const struct _mode_command_struct hwi2c_commands[] = {
         .def=&sniff_i2c_def,
         .supress_fala_capture=true
     },
+    {
+        .func=&replay_i2c_handler,
+        .def=&replay_i2c_def,
+        .supress_fala_capture=true
+    },
     {
         .func=&i2c_eeprom_handler,
         .def=&eeprom_i2c_def,
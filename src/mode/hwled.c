@@ -10,6 +10,7 @@
 #include "mode/hwled.h"
 #include "pirate/bio.h"
 #include "hardware/pio.h"
+#include "hardware/dma.h"
 #include "ws2812.pio.h"
 #include "apa102.pio.h"
 #include "pirate/rgb.h"
@@ -19,11 +20,17 @@
 #include "pio_config.h"
 #include "binmode/logicanalyzer.h"
 #include "lib/bp_args/bp_cmd.h"
+#include "commands/hwled/leds.h"
 
 struct _pio_config pio_config;
 
 // command configuration
-const struct _mode_command_struct hwled_commands[] = { 0 };
+const struct _mode_command_struct hwled_commands[] = {
+    {   .func=&leds_handler,
+        .def=&leds_def,
+        .supress_fala_capture=true
+    },
+};
 const uint32_t hwled_commands_count = count_of(hwled_commands);
 
 static const char pin_labels[][5] = {
@@ -320,6 +327,7 @@ void hwled_macro(uint32_t macro) {
 }
 
 void hwled_cleanup(void) {
+    hwled_frame_end();
     led_devices[device_cleanup].cleanup();
     system_config.subprotocol_name = 0x00;
     system_config.num_bits = 8;
@@ -348,6 +356,92 @@ void hwled_wait_idle(void) {
     }        
 }
 
+//-----------------------------------------
+// Frame engine: DMA whole frames to the PIO instead of one word per bytecode
+
+static int hwled_dma_channel = -1;
+static bool hwled_frame_rgbw = false;
+
+static void hwled_ws2812_init(bool rgbw) {
+    hwled_frame_rgbw = rgbw;
+    pio_sm_set_enabled(pio_config.pio, pio_config.sm, false);
+    ws2812_program_init(pio_config.pio,
+                        pio_config.sm,
+                        pio_config.offset,
+                        bio2bufiopin[M_LED_SDO],
+                        (float)hwled_mode_config.baudrate,
+                        rgbw);
+}
+
+bool hwled_frame_begin(bool rgbw) {
+    // APA102 words are always 32 bits, the onboard LEDs are RGB only
+    if (rgbw && hwled_mode_config.device == M_LED_WS2812_ONBOARD) {
+        return false;
+    }
+    if (hwled_mode_config.device == M_LED_WS2812 && rgbw != hwled_frame_rgbw) {
+        // RGBW pixels are 32 bits, the state machine must pull a whole word
+        hwled_wait_idle();
+        hwled_ws2812_init(rgbw);
+    }
+    // the onboard LEDs share a state machine with the status LED code, no DMA
+    if (hwled_mode_config.device == M_LED_WS2812_ONBOARD) {
+        return true;
+    }
+    if (hwled_dma_channel < 0) {
+        hwled_dma_channel = dma_claim_unused_channel(false);
+        if (hwled_dma_channel < 0) {
+            return false;
+        }
+    }
+    dma_channel_config c = dma_channel_get_default_config(hwled_dma_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio_config.pio, pio_config.sm, true));
+    dma_channel_configure(hwled_dma_channel, &c, &pio_config.pio->txf[pio_config.sm], NULL, 0, false);
+    return true;
+}
+
+void hwled_frame_write(const uint32_t* words, uint32_t count) {
+    if (hwled_dma_channel < 0) {
+        // onboard LEDs (or no DMA): ws2812 words carry the pixel in the top 24 bits
+        uint32_t shift = (hwled_mode_config.device == M_LED_APA102) ? 0 : 8;
+        for (uint32_t i = 0; i < count; i++) {
+            led_devices[hwled_mode_config.device].write(words[i] >> shift);
+        }
+        return;
+    }
+    dma_channel_wait_for_finish_blocking(hwled_dma_channel);
+    dma_channel_transfer_from_buffer_now(hwled_dma_channel, words, count);
+}
+
+void hwled_frame_wait(void) {
+    if (hwled_dma_channel >= 0) {
+        dma_channel_wait_for_finish_blocking(hwled_dma_channel);
+    }
+    hwled_wait_idle();
+}
+
+void hwled_frame_show(const uint32_t* words, uint32_t count) {
+    hwled_frame_wait();                           // last frame is off the wire
+    led_devices[hwled_mode_config.device].start(); // WS2812 reset or APA102 start frame
+    hwled_frame_write(words, count);
+}
+
+void hwled_frame_end(void) {
+    if (hwled_dma_channel >= 0) {
+        hwled_frame_wait();
+        dma_channel_cleanup(hwled_dma_channel);
+        dma_channel_unclaim(hwled_dma_channel);
+        hwled_dma_channel = -1;
+    }
+    // back to 24 bit pixels for the syntax
+    if (hwled_frame_rgbw) {
+        hwled_wait_idle();
+        hwled_ws2812_init(false);
+    }
+}
+
 //-----------------------------------------
 //
 
@@ -20,6 +20,29 @@ void hwled_wait_idle(void);
 bool hwled_preflight_sanity_check(void);
 bool hwled_bpio_configure(bpio_mode_configuration_t *bpio_mode_config);
 
+/**
+ * @brief Prepare the frame engine, claims a DMA channel.
+ * @param rgbw  WS2812: 32 bit RGBW pixels, no effect on APA102
+ * @return false if the device can't do it or no DMA channel is free
+ */
+bool hwled_frame_begin(bool rgbw);
+/**
+ * @brief Queue PIO words, waits for the previous transfer then returns while DMA runs.
+ */
+void hwled_frame_write(const uint32_t* words, uint32_t count);
+/**
+ * @brief Wait until all queued words are on the wire.
+ */
+void hwled_frame_wait(void);
+/**
+ * @brief Send a complete frame: start sequence, then DMA the words.
+ */
+void hwled_frame_show(const uint32_t* words, uint32_t count);
+/**
+ * @brief Release the DMA channel and restore 24 bit syntax writes.
+ */
+void hwled_frame_end(void);
+
 enum M_LED_DEVICE_TYPE {
     M_LED_WS2812,
     M_LED_APA102,
@@ -9,7 +9,7 @@
  *          - Stop bits: 1 or 2
  *          - Hardware flow control (RTS/CTS)
  *          - Signal inversion support
- *          - Async data printing
+ *          - Async data printing from a DMA receive ring, a line at a time
  *          - GPS NMEA decoder
  *          - UART bridge mode
  *          - Monitor mode for testing
@@ -32,8 +32,9 @@
 #include "bytecode.h"
 #include "mode/hwuart.h"
 #include "pirate/bio.h"
+#include "pirate/hwuart_rx.h"
+#include "ui/ui_const.h"
 #include "ui/ui_term.h"
-#include "ui/ui_format.h"
 #include "pirate/storage.h"
 #include "usb_rx.h"
 #include "usb_tx.h"
@@ -42,10 +43,18 @@
 #include "commands/uart/bridge.h"
 #include "commands/uart/monitor.h"
 #include "commands/uart/glitch.h"
+#include "commands/uart/glitch_campaign.h"
 #include "lib/bp_args/bp_cmd.h"
 
+// a syntax read waits this long for a byte
+#define HWUART_READ_TIMEOUT_US 1000
+// async lines end after this much quiet (or 4 characters, if longer)
+#define HWUART_ASYNC_GAP_US 2000
+
 static struct _uart_mode_config mode_config;
-static struct command_attributes periodic_attributes;
+static line_fmt_t async_line;
+static line_fmt_colors_t async_colors;
+static urx_fmt_t async_fmt;
 
 bool bpio_hwuart_configure(bpio_mode_configuration_t *bpio_mode_config){
     if(bpio_mode_config->debug) printf("[UART] Configuring - Speed %d baud, %d%c%d\r\n", 
@@ -61,6 +70,7 @@ bool bpio_hwuart_configure(bpio_mode_configuration_t *bpio_mode_config){
     mode_config.flow_control = bpio_mode_config->flow_control ? 1 : 0;
     mode_config.invert = bpio_mode_config->signal_inversion ? 1 : 0;
     mode_config.async_print = false; // Disabled by default, async data handled via BPIO packets
+    mode_config.timestamps = 0;
     mode_config.blocking = 0; // Non-blocking
     
     return true;  
@@ -76,13 +86,18 @@ const struct _mode_command_struct hwuart_commands[] = {
         .def=&uart_bridge_def,
         .supress_fala_capture=true
     },
-    /*{   .func=&uart_monitor_handler, 
-        .supress_fala_capture=false
-    },*/
+    {   .func=&uart_monitor_handler,
+        .def=&uart_monitor_def,
+        .supress_fala_capture=true
+    },
     {   .func=&uart_glitch_handler,
         .def=&uart_glitch_def,
         .supress_fala_capture=false
     },
+    {   .func=&uart_glitch_campaign_handler,
+        .def=&uart_glitch_campaign_def,
+        .supress_fala_capture=false
+    },
 };
 const uint32_t hwuart_commands_count = count_of(hwuart_commands);
 
@@ -162,6 +177,17 @@ static const bp_val_constraint_t uart_invert_choice = {
     .prompt = T_UART_INVERT_MENU,
 };
 
+// Async timestamps — flag -t / --timestamp, command line only
+static const bp_val_choice_t timestamp_choices[] = {
+    { "off", NULL, T_OFF, 0 },
+    { "on",  NULL, T_ON,  1 },
+};
+static const bp_val_constraint_t uart_timestamp_choice = {
+    .type = BP_VAL_CHOICE,
+    .choice = { .choices = timestamp_choices, .count = 2, .def = 0 },
+    .prompt = T_UART_TIMESTAMP_MENU,
+};
+
 static const bp_command_opt_t uart_setup_opts[] = {
     { "baud",     'b', BP_ARG_REQUIRED, "1-7372800",     0, &uart_baud_range },
     { "databits", 'd', BP_ARG_REQUIRED, "5-8",           0, &uart_databits_range },
@@ -169,6 +195,7 @@ static const bp_command_opt_t uart_setup_opts[] = {
     { "stopbits", 's', BP_ARG_REQUIRED, "1|2",           0, &uart_stopbits_choice },
     { "flow",     'f', BP_ARG_REQUIRED, "off|rts",       0, &uart_flow_choice },
     { "invert",   'i', BP_ARG_REQUIRED, "normal|invert", 0, &uart_invert_choice },
+    { "timestamp",'t', BP_ARG_REQUIRED, "off|on",        0, &uart_timestamp_choice },
     { 0 },
 };
 
@@ -180,15 +207,6 @@ const bp_command_def_t uart_setup_def = {
 
 uint32_t hwuart_setup(void) {
     uint32_t temp;
-    periodic_attributes.has_value = true;
-    periodic_attributes.has_dot = false;
-    periodic_attributes.has_colon = false;
-    periodic_attributes.has_string = false;
-    periodic_attributes.command = 0;       // the actual command called
-    periodic_attributes.number_format = 4; // DEC/HEX/BIN
-    periodic_attributes.value = 0;         // integer value parsed from command line
-    periodic_attributes.dot = 0;           // value after .
-    periodic_attributes.colon = 0;         // value after :
 
     const char config_file[] = "bpuart.bp";
     const mode_config_t config_t[] = {
@@ -199,6 +217,7 @@ uint32_t hwuart_setup(void) {
         { "$.parity", &mode_config.parity, MODE_CONFIG_FORMAT_DECIMAL },
         { "$.flow_ctrl", &mode_config.flow_control, MODE_CONFIG_FORMAT_DECIMAL },
         { "$.invert", &mode_config.invert, MODE_CONFIG_FORMAT_DECIMAL },
+        { "$.timestamps", &mode_config.timestamps, MODE_CONFIG_FORMAT_DECIMAL },
         // clang-format off
     };
 
@@ -261,6 +280,10 @@ uint32_t hwuart_setup(void) {
         mode_config.invert = temp;
     }
 
+    // not part of the wizard, off unless given
+    if (bp_cmd_flag(&uart_setup_def, 't', &temp) == BP_CMD_INVALID) return 0;
+    mode_config.timestamps = temp;
+
     storage_save_mode(config_file, config_t, count_of(config_t));
 
     mode_config.async_print = false;
@@ -279,6 +302,12 @@ uint32_t hwuart_setup(void) {
     return 1;
 }
 
+// one character on the wire
+static uint32_t hwuart_byte_ns(void) {
+    uint32_t bits = 1 + mode_config.data_bits + (mode_config.parity ? 1 : 0) + mode_config.stop_bits;
+    return (uint32_t)((uint64_t)bits * 1000000000u / mode_config.baudrate_actual);
+}
+
 uint32_t hwuart_setup_exc(void) {
     mode_config.baudrate_actual = uart_init(M_UART_PORT, mode_config.baudrate);
     // setup peripheral
@@ -317,10 +346,13 @@ uint32_t hwuart_setup_exc(void) {
         uart_set_hw_flow(M_UART_PORT, mode_config.flow_control, false);             
     }
 
-    // drain the buffer of any glitch bytes from setup
+    // drain the buffer of any glitch bytes from setup, then receive into the ring from here on
     while (uart_is_readable(M_UART_PORT)) {
         uart_getc(M_UART_PORT);
     }
+    if (!hwuart_rx_start(hwuart_byte_ns(), mode_config.flow_control)) {
+        printf("Error: no free DMA channels, UART receive disabled\r\n");
+    }
 
     return 1;
 }
@@ -330,33 +362,53 @@ bool hwuart_preflight_sanity_check(void){
 }
 
 void hwuart_periodic(void) {
-    if (mode_config.async_print && uart_is_readable(M_UART_PORT)) {
-        // printf("ASYNC: %d\r\n", uart_getc(M_UART_PORT));
-        if(mode_config.flow_control) bio_put(M_UART_RTS, 0);
-        uint32_t temp = uart_getc(M_UART_PORT);
-        if(mode_config.flow_control) bio_put(M_UART_RTS, 1);
-        ui_format_print_number_2(&periodic_attributes, &temp);
+    if (mode_config.async_print) {
+        hwuart_rx_display(&async_fmt);
+    } else {
+        hwuart_rx_poll();
     }
 }
 
-void hwuart_open(struct _bytecode* result, struct _bytecode* next) {    
-    // clear FIFO and enable UART
-    if(mode_config.flow_control) bio_put(M_UART_RTS, 0);
-    while (uart_is_readable(M_UART_PORT)) {
-        uart_getc(M_UART_PORT);
+// async bytes in the display format, the ASCII prefix when it is auto like ui_format_print_number_2()
+static void hwuart_async_begin(void) {
+    uint32_t format = (system_config.display_format == df_auto) ? df_ascii : system_config.display_format;
+    uint32_t gap_us = 4 * hwuart_byte_ns() / 1000;
+    if (gap_us < HWUART_ASYNC_GAP_US) {
+        gap_us = HWUART_ASYNC_GAP_US;
     }
-    if(mode_config.flow_control) bio_put(M_UART_RTS, 1);
+    line_fmt_colors(
+        &async_colors, ui_term_color_reset(), ui_term_color_grey(), ui_term_color_num_float(), ui_term_color_info());
+    line_fmt_init(&async_line, tx_fifo_write);
+    urx_fmt_init(&async_fmt,
+                 &async_line,
+                 &async_colors,
+                 format,
+                 system_config.num_bits,
+                 time_us_32(),
+                 gap_us,
+                 mode_config.timestamps);
+}
+
+void hwuart_open(struct _bytecode* result, struct _bytecode* next) {    
+    // drop what was received before
+    hwuart_rx_flush();
 
     mode_config.async_print = false;
     result->data_message = GET_T(T_UART_OPEN);
 }
 
 void hwuart_open_read(struct _bytecode* result, struct _bytecode* next) { // start with read
+    if (!mode_config.async_print) {
+        hwuart_async_begin();
+    }
     mode_config.async_print = true;
     result->data_message = GET_T(T_UART_OPEN_WITH_READ);
 }
 
 void hwuart_close(struct _bytecode* result, struct _bytecode* next) {
+    if (mode_config.async_print) {
+        urx_fmt_end(&async_fmt);
+    }
     mode_config.async_print = false;
     result->data_message = GET_T(T_UART_CLOSE);
 }
@@ -370,25 +422,14 @@ void hwuart_write(struct _bytecode* result, struct _bytecode* next) {
 }
 
 void hwuart_read(struct _bytecode* result, struct _bytecode* next) {
-    uint32_t timeout = 0xfff;
-
-    while (!uart_is_readable(M_UART_PORT)) {
-        timeout--;
-        if (!timeout) {
-            result->error = SERR_ERROR;
-            result->error_message = GET_T(T_UART_NO_DATA_READ);
-            return;
-        }
-    }
-
-    if(mode_config.flow_control) bio_put(M_UART_RTS, 0);
-    if (uart_is_readable(M_UART_PORT)) {
-        result->in_data = uart_getc(M_UART_PORT);
-    } else {
+    uint8_t c;
+    // the receive ring drives RTS
+    if (!hwuart_rx_wait(HWUART_READ_TIMEOUT_US) || !hwuart_rx_get(&c, NULL)) {
         result->error = SERR_ERROR;
         result->error_message = GET_T(T_UART_NO_DATA_READ);
+        return;
     }
-    if(mode_config.flow_control) bio_put(M_UART_RTS, 1);
+    result->in_data = c;
 }
 
 void hwuart_macro(uint32_t macro) {
@@ -407,6 +448,8 @@ void hwuart_macro(uint32_t macro) {
 }
 
 void hwuart_cleanup(void) {
+    mode_config.async_print = false;
+    hwuart_rx_stop();
     // disable peripheral
     uart_deinit(M_UART_PORT);
     system_bio_update_purpose_and_label(false, M_UART_TX, BP_PIN_MODE, 0);
@@ -431,6 +474,7 @@ void hwuart_settings(void) {
             !mode_config.flow_control ? GET_T(T_UART_FLOW_CONTROL_MENU_1) : GET_T(T_UART_FLOW_CONTROL_MENU_2), 0x00);
     ui_help_setting_string(GET_T(T_UART_INVERT_MENU),
             !mode_config.invert ? GET_T(T_UART_INVERT_MENU_1) : GET_T(T_UART_INVERT_MENU_2), 0x00);
+    ui_help_setting_string(GET_T(T_UART_TIMESTAMP_MENU), GET_T(mode_config.timestamps ? T_ON : T_OFF), 0x00);
 }
 
 void hwuart_printerror(void) {
@@ -472,3 +516,9 @@ void hwuart_wait_done(void) {
 uint32_t hwuart_get_speed(void) {
     return mode_config.baudrate_actual;
 }
+
+void hwuart_get_format(uint32_t* data_bits, uint32_t* stop_bits, uint32_t* parity) {
+    *data_bits = mode_config.data_bits;
+    *stop_bits = mode_config.stop_bits;
+    *parity = mode_config.parity;
+}
@@ -21,6 +21,7 @@ typedef struct _uart_mode_config {
     uint32_t flow_control;     ///< Hardware flow control (0=disabled, 1=RTS/CTS)
     uint32_t invert;           ///< Signal inversion (0=normal, 1=inverted)
     uint32_t listen;           ///< Listen mode (0=master/drive line, 1=listen/passive)
+    uint32_t timestamps;       ///< Time column on async data lines (0=off, 1=on)
 } _uart_mode_config;
 
 /**
@@ -117,6 +118,14 @@ void hwuart_wait_done(void);
  */
 uint32_t hwuart_get_speed(void);
 
+/**
+ * @brief Get current UART frame format.
+ * @param data_bits  Data bits (5-8)
+ * @param stop_bits  Stop bits (1 or 2)
+ * @param parity     UART_PARITY_NONE, EVEN or ODD
+ */
+void hwuart_get_format(uint32_t* data_bits, uint32_t* stop_bits, uint32_t* parity);
+
 /**
  * @brief Perform UART mode sanity checks.
  * @return true if all checks pass, false otherwise
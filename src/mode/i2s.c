@@ -96,6 +96,12 @@ static bool update_pio_frequency(uint32_t sample_freq, bool enable) {
     return true; // return true if the frequency was set successfully
 }
 
+// Change the output sample rate without touching the mode settings,
+// the wav command plays files at their own rate and restores the default after
+bool i2s_set_sample_rate(uint32_t sample_freq) {
+    return update_pio_frequency(sample_freq, true);
+}
+
 // Pre-setup step. Show user menus for any configuration options.
 // The Bus Pirate hardware is not "clean" and reset at this point.
 // Any previous mode may still be running. This is only a configuration step,
@@ -27,6 +27,7 @@ void i2s_clk(struct _bytecode* result, struct _bytecode* next);
 void i2s_bitr(struct _bytecode* result, struct _bytecode* next);
 
 void i2s_help(void);
+bool i2s_set_sample_rate(uint32_t sample_freq);
 
 extern const struct _mode_command_struct i2s_commands[];
 extern const uint32_t i2s_commands_count;
@@ -15,6 +15,7 @@
 #include "pirate/hwspi.h"
 #include "usb_rx.h"
 #include "commands/jtag/bluetag.h"
+#include "commands/jtag/svf.h"
 
 // command configuration
 const struct _mode_command_struct jtag_commands[] = {
@@ -22,6 +23,10 @@ const struct _mode_command_struct jtag_commands[] = {
         .def=&bluetag_def,
         .supress_fala_capture=true
     },
+    {   .func=&svf_handler,
+        .def=&svf_def,
+        .supress_fala_capture=true
+    },
  
 };
 const uint32_t jtag_commands_count = count_of(jtag_commands);
@@ -70,7 +75,7 @@ void jtag_settings(void) {
 
 
 void jtag_help(void) {
-    printf("JTAG mode for utilities such as blueTag\r\n");
+    printf("JTAG mode for utilities such as blueTag and SVF/XSVF playback\r\n");
     ui_help_mode_commands(jtag_commands, jtag_commands_count);
 }
 
@@ -143,6 +143,18 @@ void spi_busy_wait_internal(bool enable, const char *file, int line);
 #define PIO_LOGIC_ANALYZER_PIO pio0
 #define PIO_LOGIC_ANALYZER_SM 0
 
+// background frequency counter (f/F), RP2040 shares PIO0 with the logic analyzer
+// the gated edge counter that checks its range runs next to it for the length of a gate
+#if RPI_PLATFORM == RP2350
+#define PIO_FREQ_COUNTER_PIO pio2
+#define PIO_FREQ_COUNTER_SM 1
+#define PIO_FREQ_GATE_SM 2
+#else
+#define PIO_FREQ_COUNTER_PIO pio0
+#define PIO_FREQ_COUNTER_SM 3
+#define PIO_FREQ_GATE_SM 2
+#endif
+
 #define PIO_MODE_PIO pio1
 // all SM reserved for mode
 
@@ -27,6 +27,7 @@
 #include "pirate.h"
 #include "pirate/shift.h"
 #include "pirate/amux.h"
+#include "pirate/psu_guard.h"
 #include "command_struct.h"
 #include "display/scope.h"
 #include "hardware/sync.h"
@@ -46,27 +47,56 @@ bool reset_adc_average = false; /**< Flag to reset ADC averaging */
  * @param enable true to acquire lock, false to release
  * 
  * @note Must call with enable=false when done to release lock
+ * @note Pauses the PSU guard while the lock is held
  * @warning Blocking call when enable=true
  */
-void adc_busy_wait(bool enable) {
-    static bool busy = false;
+static bool adc_busy = false;
 
-    if (!enable) {
-        busy = false;
-        return;
-    }
+// take the ADC from the other core, the PSU guard is left alone
+static void adc_lock_take(void) {
     do {
         spin_lock_unsafe_blocking(adc_spin_lock);
-        if (busy) {
+        if (adc_busy) {
             spin_unlock_unsafe(adc_spin_lock);
         } else {
-            busy = true;
+            adc_busy = true;
             spin_unlock_unsafe(adc_spin_lock);
             return;
         }
     } while (true);
 }
 
+void adc_busy_wait(bool enable) {
+    if (!enable) {
+        psu_guard_resume(); // PSU guard samples again until the next user
+        adc_busy = false;
+        return;
+    }
+    adc_lock_take();
+    psu_guard_pause(); // stop the PSU guard free-running the ADC
+}
+
+// AMUX reads don't pause the PSU guard: they share its sampling so the
+// current is still checked (the core1 sweep runs several times a second)
+// returns true if the samples come from the guard
+static bool amux_adc_take(void) {
+    adc_lock_take();
+    if (psu_guard_amux_begin()) {
+        return true;
+    }
+    psu_guard_pause();
+    return false;
+}
+
+static void amux_adc_give(bool shared) {
+    if (shared) {
+        psu_guard_amux_end();
+    } else {
+        psu_guard_resume();
+    }
+    adc_busy = false;
+}
+
 /**
  * @brief Initialize analog multiplexer and ADC subsystem
  * 
@@ -159,13 +189,15 @@ uint32_t amux_read(uint8_t channel) {
     if (scope_running) { // scope is using the analog subsystem
         return 0;
     }
-    adc_busy_wait(true);
-    adc_select_input(AMUX_OUT_ADC);
+    bool shared = amux_adc_take();
+    if (!shared) {
+        adc_select_input(AMUX_OUT_ADC);
+    }
     amux_select_input(HW_ADC_MUX_GND); // to clear any charge from a floating pin
     amux_select_input((uint16_t)channel);
     busy_wait_us(60);
-    uint32_t ret = adc_read();
-    adc_busy_wait(false);
+    uint32_t ret = shared ? psu_guard_amux_sample() : adc_read();
+    amux_adc_give(shared);
     return ret;
 }
 
@@ -173,9 +205,9 @@ uint32_t amux_read_present_channel(void) {
     if (scope_running) { // scope is using the analog subsystem
         return 0;
     }
-    adc_busy_wait(true);
-    uint32_t ret = adc_read();
-    adc_busy_wait(false);
+    bool shared = amux_adc_take();
+    uint32_t ret = shared ? psu_guard_amux_sample() : adc_read();
+    amux_adc_give(shared);
     return ret;
 }
 
@@ -194,10 +226,15 @@ uint32_t amux_read_current(void) {
     if (scope_running) {
         return 0; // scope is using the analog subsystem
     }
-    adc_busy_wait(true);
-    adc_select_input(CURRENT_SENSE_ADC);
-    uint32_t ret = adc_read();
-    adc_busy_wait(false);
+    bool shared = amux_adc_take();
+    uint32_t ret;
+    if (shared) {
+        ret = psu_guard_current_sample();
+    } else {
+        adc_select_input(CURRENT_SENSE_ADC);
+        ret = adc_read();
+    }
+    amux_adc_give(shared);
     return ret;
 }
 
@@ -207,21 +244,29 @@ void amux_sweep(void) {
     if (scope_running) { // scope is using the analog subsystem
         return;
     }
-    adc_busy_wait(true);
-    adc_select_input(AMUX_OUT_ADC);
+    bool shared = amux_adc_take();
+    if (!shared) {
+        adc_select_input(AMUX_OUT_ADC);
+    }
     for (int i = 0; i < HW_ADC_MUX_COUNT; i++) {
         amux_select_input(HW_ADC_MUX_GND); // to clear any charge from a floating pin
         busy_wait_us(10);
         amux_select_input(i);
         busy_wait_us(60);
-        hw_adc_raw[i] = adc_read();
+        hw_adc_raw[i] = shared ? psu_guard_amux_sample() : adc_read();
         // hw_adc_voltage[i]=hw_adc_to_volts_x2(i); //these are X2 because a resistor divider /2
     }
     amux_select_input(HW_ADC_MUX_GND); // to clear any charge from a floating pin
-    adc_select_input(CURRENT_SENSE_ADC);
-    busy_wait_us(60);
-    hw_adc_raw[HW_ADC_CURRENT_SENSE] = (adc_read() + hw_adc_raw[HW_ADC_CURRENT_SENSE]) / 2;
-    adc_busy_wait(false);
+    uint32_t current;
+    if (shared) {
+        current = psu_guard_current_sample();
+    } else {
+        adc_select_input(CURRENT_SENSE_ADC);
+        busy_wait_us(60);
+        current = adc_read();
+    }
+    hw_adc_raw[HW_ADC_CURRENT_SENSE] = (current + hw_adc_raw[HW_ADC_CURRENT_SENSE]) / 2;
+    amux_adc_give(shared);
     // do these outside the ADC spin lock
     for (int i = 0; i < HW_ADC_MUX_COUNT; i++) {
         hw_adc_voltage[i] = hw_adc_to_volts_x2(i); // these are X2 because a resistor divider /2
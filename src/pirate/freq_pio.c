@@ -0,0 +1,214 @@
+/**
+ * @file freq_pio.c
+ * @brief Background reciprocal frequency counter for IO0-IO7.
+ * @details The freq_pio PIO program pushes a record for every change on the
+ *          IO pins (lib/la_change format). A data DMA channel writes the records
+ *          into a ring buffer and chains to a control channel that re-arms the
+ *          transfer count, so the capture runs forever without the CPU.
+ *          freq_pio_get_stats() walks the ring back from the newest record,
+ *          freq_pio_follow() hands out the records written since the last
+ *          call to readers that keep running statistics (the pin watcher).
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include "pirate.h"
+#include "pio_config.h"
+#include "freq_pio.pio.h"
+#include "pirate/freq_pio.h"
+
+// 8K ring, the DMA wraps the write address so it must be aligned to its size
+#define FREQ_PIO_RING_BITS 13
+#define FREQ_PIO_RING_LEN ((1u << FREQ_PIO_RING_BITS) / sizeof(uint32_t))
+// newest records only, the oldest ones may be overwritten while we read
+#define FREQ_PIO_GUARD 256
+// the top 4 bits of the RP2350 transfer count are the mode, 0xf would be endless
+#if RPI_PLATFORM == RP2350
+#define FREQ_PIO_COUNT_MASK 0x0fffffffu
+#else
+#define FREQ_PIO_COUNT_MASK 0xffffffffu
+#endif
+// a multiple of the ring length, so a re-armed transfer starts again at ring slot 0
+#define FREQ_PIO_RELOAD (FREQ_PIO_COUNT_MASK & ~(FREQ_PIO_RING_LEN - 1))
+
+static uint32_t freq_pio_ring[FREQ_PIO_RING_LEN] __attribute__((aligned(1u << FREQ_PIO_RING_BITS)));
+static const uint32_t freq_pio_reload = FREQ_PIO_RELOAD;
+static struct _pio_config pio_config;
+static int freq_dma_data_channel = -1;
+static int freq_dma_control_channel = -1;
+static uint32_t freq_tick_hz = 0;
+
+static void freq_pio_release_dma(void) {
+    if (freq_dma_data_channel >= 0) {
+        dma_channel_cleanup(freq_dma_data_channel);
+        dma_channel_unclaim(freq_dma_data_channel);
+        freq_dma_data_channel = -1;
+    }
+    if (freq_dma_control_channel >= 0) {
+        dma_channel_cleanup(freq_dma_control_channel);
+        dma_channel_unclaim(freq_dma_control_channel);
+        freq_dma_control_channel = -1;
+    }
+}
+
+bool freq_pio_start(void) {
+    if (pio_config.program) {
+        return true;
+    }
+    // on RP2040 the counter shares PIO0 with the logic analyzer
+    if (!pio_can_add_program(PIO_FREQ_COUNTER_PIO, &freq_pio_program)) {
+        return false;
+    }
+    freq_dma_data_channel = dma_claim_unused_channel(false);
+    freq_dma_control_channel = dma_claim_unused_channel(false);
+    if (freq_dma_data_channel < 0 || freq_dma_control_channel < 0) {
+        freq_pio_release_dma();
+        return false;
+    }
+
+    pio_config.pio = PIO_FREQ_COUNTER_PIO;
+    pio_config.sm = PIO_FREQ_COUNTER_SM;
+    pio_config.program = &freq_pio_program;
+    pio_config.offset = pio_add_program(pio_config.pio, pio_config.program);
+#ifdef BP_PIO_SHOW_ASSIGNMENT
+    printf("pio %d, sm %d, offset %d\n", PIO_NUM(pio_config.pio), pio_config.sm, pio_config.offset);
+#endif
+
+    // control channel re-arms the data channel when its (very long) transfer completes
+    dma_channel_config c = dma_channel_get_default_config(freq_dma_control_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(freq_dma_control_channel,
+                          &c,
+                          &dma_hw->ch[freq_dma_data_channel].al1_transfer_count_trig,
+                          &freq_pio_reload,
+                          1,
+                          false);
+
+    c = dma_channel_get_default_config(freq_dma_data_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, FREQ_PIO_RING_BITS);
+    channel_config_set_dreq(&c, pio_get_dreq(pio_config.pio, pio_config.sm, false));
+    channel_config_set_chain_to(&c, freq_dma_control_channel);
+    dma_channel_configure(freq_dma_data_channel,
+                          &c,
+                          freq_pio_ring,
+                          &pio_config.pio->rxf[pio_config.sm],
+                          freq_pio_reload,
+                          true);
+
+    freq_tick_hz =
+        freq_pio_program_init(pio_config.pio, pio_config.sm, pio_config.offset, bio2bufiopin[BIO0]);
+    pio_sm_set_enabled(pio_config.pio, pio_config.sm, true);
+    return true;
+}
+
+void freq_pio_stop(void) {
+    if (!pio_config.program) {
+        return;
+    }
+    pio_sm_set_enabled(pio_config.pio, pio_config.sm, false);
+    freq_pio_release_dma();
+    pio_remove_program(pio_config.pio, pio_config.program, pio_config.offset);
+    pio_config.program = 0;
+}
+
+bool freq_pio_is_running(void) {
+    return pio_config.program != 0;
+}
+
+uint32_t freq_pio_tick_hz(void) {
+    return freq_tick_hz;
+}
+
+bool freq_pio_get_stats(uint32_t window_ms, freq_stats_t* stats) {
+    if (!pio_config.program) {
+        return false;
+    }
+    // read the count before the address so we never count a slot that is not written yet
+    uint32_t remaining = dma_channel_hw_addr(freq_dma_data_channel)->transfer_count & FREQ_PIO_COUNT_MASK;
+    uint32_t write_addr = dma_channel_hw_addr(freq_dma_data_channel)->write_addr;
+    // the control channel count drops to 0 once it has re-armed the data channel
+    bool reloaded = (dma_channel_hw_addr(freq_dma_control_channel)->transfer_count == 0);
+    uint32_t written = reloaded ? UINT32_MAX : (freq_pio_reload - remaining);
+
+    uint32_t index = (write_addr - (uint32_t)freq_pio_ring) / sizeof(uint32_t);
+    uint32_t newest = (index - 1) & (FREQ_PIO_RING_LEN - 1);
+    uint32_t count = MIN(written, FREQ_PIO_RING_LEN - FREQ_PIO_GUARD);
+
+    uint64_t window_ticks = (uint64_t)freq_tick_hz * window_ms / 1000;
+    freq_stats_compute(freq_pio_ring, FREQ_PIO_RING_LEN, newest, count, window_ticks, stats);
+    return true;
+}
+
+// records written since the transfer was (re-)armed, the count reads 0 for a moment before a re-arm
+static uint32_t freq_pio_written(void) {
+    uint32_t remaining = dma_channel_hw_addr(freq_dma_data_channel)->transfer_count & FREQ_PIO_COUNT_MASK;
+    uint32_t written = freq_pio_reload - remaining;
+    return (written == freq_pio_reload) ? 0 : written;
+}
+
+bool freq_pio_gate(uint8_t pin, uint32_t gate_us, double* hz) {
+    PIO pio = PIO_FREQ_COUNTER_PIO;
+    if (pio_sm_is_claimed(pio, PIO_FREQ_GATE_SM) || !pio_can_add_program(pio, &freq_edge_program)) {
+        return false;
+    }
+    pio_sm_claim(pio, PIO_FREQ_GATE_SM);
+    uint offset = pio_add_program(pio, &freq_edge_program);
+    freq_edge_program_init(pio, PIO_FREQ_GATE_SM, offset, bio2bufiopin[pin]);
+
+    // the gate is timed from the enable to the disable, keep interrupts out of both
+    uint32_t irq = save_and_disable_interrupts();
+    uint64_t start = time_us_64();
+    pio_sm_set_enabled(pio, PIO_FREQ_GATE_SM, true);
+    restore_interrupts(irq);
+    busy_wait_us(gate_us);
+    irq = save_and_disable_interrupts();
+    pio_sm_set_enabled(pio, PIO_FREQ_GATE_SM, false);
+    uint64_t gate = time_us_64() - start;
+    restore_interrupts(irq);
+
+    pio_sm_exec(pio, PIO_FREQ_GATE_SM, pio_encode_mov_not(pio_isr, pio_x));
+    pio_sm_exec(pio, PIO_FREQ_GATE_SM, pio_encode_push(false, false));
+    uint32_t edges = pio_sm_get(pio, PIO_FREQ_GATE_SM);
+
+    pio_remove_program(pio, &freq_edge_program, offset);
+    pio_sm_unclaim(pio, PIO_FREQ_GATE_SM);
+    *hz = gate ? (double)edges * 1000000.0 / (double)gate : 0;
+    return true;
+}
+
+uint32_t freq_pio_position(void) {
+    if (!pio_config.program) {
+        return 0;
+    }
+    return freq_pio_written();
+}
+
+uint32_t freq_pio_follow(uint32_t* pos, const uint32_t** ring, uint32_t* ring_len, uint32_t* first, bool* lost) {
+    *ring = freq_pio_ring;
+    *ring_len = FREQ_PIO_RING_LEN;
+    *lost = false;
+    if (!pio_config.program) {
+        *first = 0;
+        return 0;
+    }
+    // position and ring slot stay in step, reload is a multiple of the ring length
+    uint32_t now = freq_pio_written();
+    uint32_t count = (now >= *pos) ? now - *pos : now + freq_pio_reload - *pos;
+    if (count > FREQ_PIO_RING_LEN - FREQ_PIO_GUARD) {
+        // fell behind, the oldest unread records are gone or about to be
+        *lost = true;
+        count = FREQ_PIO_RING_LEN - FREQ_PIO_GUARD;
+    }
+    *first = (now - count) & (FREQ_PIO_RING_LEN - 1);
+    *pos = now;
+    return count;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file freq_pio.h
+ * @brief Background reciprocal frequency counter for IO0-IO7.
+ * @details A PIO state machine timestamps every edge on the 8 IO pins and DMA
+ *          writes the records into a ring buffer with no CPU time spent while
+ *          measuring. Statistics are worked out from the ring when requested.
+ */
+
+#include "lib/freq_stats/freq_stats.h"
+
+/**
+ * @brief Start the counter, does nothing if it is already running.
+ * @return false if the PIO or DMA channels are not available
+ */
+bool freq_pio_start(void);
+
+/**
+ * @brief Stop the counter and release the PIO program and DMA channels.
+ */
+void freq_pio_stop(void);
+
+/**
+ * @brief Check if the counter is running.
+ * @return true if running
+ */
+bool freq_pio_is_running(void);
+
+/**
+ * @brief Timestamp resolution.
+ * @return Sample ticks per second (sysclk/10)
+ */
+uint32_t freq_pio_tick_hz(void);
+
+/**
+ * @brief Get statistics for all 8 IO pins.
+ * @param window_ms  Only use edges from the last window_ms milliseconds
+ * @param stats      FREQ_STATS_PINS results
+ * @return false if the counter is not running
+ */
+bool freq_pio_get_stats(uint32_t window_ms, freq_stats_t* stats);
+
+/**
+ * @brief Count rising edges on one pin at the system clock for a fixed gate.
+ * @details The reciprocal counter samples at freq_pio_tick_hz() and aliases
+ *          signals faster than half of that, this tells when a reading is out
+ *          of its range. Blocks for the gate time.
+ * @param pin      IO pin 0-7
+ * @param gate_us  Gate time
+ * @param hz       Rising edges per second over the gate
+ * @return false if the state machine or the program space is in use
+ */
+bool freq_pio_gate(uint8_t pin, uint32_t gate_us, double* hz);
+
+/**
+ * @brief Reader position for freq_pio_follow(), the newest record now.
+ * @return Records written so far (wraps), 0 if the counter is not running
+ */
+uint32_t freq_pio_position(void);
+
+/**
+ * @brief Get the records written since the last call, oldest first.
+ * @details For readers that keep running statistics. If more than the ring
+ *          can safely hold arrived since the last call, only the newest are
+ *          returned and lost is set.
+ * @param pos       reader position from freq_pio_position(), updated
+ * @param ring      the record ring
+ * @param ring_len  ring length in records (power of two)
+ * @param first     ring index of the oldest new record
+ * @param lost      set if unread records were overwritten
+ * @return Number of new records
+ */
+uint32_t freq_pio_follow(uint32_t* pos, const uint32_t** ring, uint32_t* ring_len, uint32_t* first, bool* lost);
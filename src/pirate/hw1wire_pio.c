@@ -22,6 +22,7 @@
 #include "hardware/clocks.h"
 #include "hw1wire.pio.h"
 #include "pirate/hw1wire_pio.h"
+#include "lib/ow_search/ow_search.h"
 
 struct owobj owobj;
 
@@ -42,12 +43,25 @@ void onewire_init(uint pin, uint dir) {
     onewire_program_init(owobj.pio, owobj.sm, owobj.offset, owobj.pin, owobj.dir);
     onewire_set_fifo_thresh(8);
     pio_sm_set_enabled(owobj.pio, owobj.sm, true);
+
+    // ROM search pass on a second state machine, triplets run from C if it doesn't fit
+    owobj.search_sm = 1;
+    owobj.search_loaded = pio_can_add_program(owobj.pio, &onewire_search_program);
+    if (owobj.search_loaded) {
+        owobj.search_offset = pio_add_program(owobj.pio, &onewire_search_program);
+        onewire_search_program_init(owobj.pio, owobj.search_sm, owobj.search_offset, owobj.pin, owobj.dir);
+    }
 }
 
 void onewire_cleanup(void) {
     // pio_remove_program_and_unclaim_sm(&onewire_program, owobj.pio, owobj.sm, owobj.offset);
     pio_sm_set_enabled(owobj.pio, owobj.sm, false);
     pio_remove_program(owobj.pio, &onewire_program, owobj.offset);
+    if (owobj.search_loaded) {
+        pio_sm_set_enabled(owobj.pio, owobj.search_sm, false);
+        pio_remove_program(owobj.pio, &onewire_search_program, owobj.search_offset);
+        owobj.search_loaded = false;
+    }
 }
 
 void onewire_set_fifo_thresh(uint thresh) {
@@ -202,6 +216,44 @@ uint onewire_rx_byte(void) {
     return (pio_sm_get(pio, sm) >> 24) & 0xff;
 }
 
+/* Transmit a block of bytes. Up to four bytes are queued so the
+   state machine goes from one byte to the next without waiting
+   for the ARM */
+void onewire_tx_block(const uint8_t* data, uint len) {
+    PIO pio = owobj.pio;
+    uint sm = owobj.sm;
+    uint sent = 0, done = 0;
+
+    onewire_set_fifo_thresh(8);
+    while (done < len) {
+        if (sent < len && (sent - done) < 4 && !pio_sm_is_tx_fifo_full(pio, sm)) {
+            pio->txf[sm] = data[sent++];
+        }
+        if (!pio_sm_is_rx_fifo_empty(pio, sm)) {
+            pio_sm_get(pio, sm); /* read to drain RX fifo */
+            done++;
+        }
+    }
+}
+
+/* Receive a block of bytes, read slots queued like onewire_tx_block() */
+void onewire_rx_block(uint8_t* data, uint len) {
+    PIO pio = owobj.pio;
+    uint sm = owobj.sm;
+    uint sent = 0, done = 0;
+
+    onewire_set_fifo_thresh(8);
+    while (done < len) {
+        if (sent < len && (sent - done) < 4 && !pio_sm_is_tx_fifo_full(pio, sm)) {
+            pio->txf[sm] = 0xff;
+            sent++;
+        }
+        if (!pio_sm_is_rx_fifo_empty(pio, sm)) {
+            data[done++] = (pio_sm_get(pio, sm) >> 24) & 0xff;
+        }
+    }
+}
+
 /* Do a ROM search triplet.
    Receive two bits and store the read values to
    id_bit and cmp_id_bit respectively.
@@ -247,39 +299,81 @@ void onewire_triplet(int* id_bit, int* cmp_id_bit, unsigned char* search_directi
 }
 
 unsigned char calc_crc8_buf(unsigned char* data, int len) {
-    int i, j;
-    unsigned char crc8;
-
     // See Application Note 27
-    crc8 = 0;
-    for (j = 0; j < len; j++) {
-        crc8 = crc8 ^ data[j];
-        for (i = 0; i < 8; ++i) {
-            if (crc8 & 1) {
-                crc8 = (crc8 >> 1) ^ 0x8c;
-            } else {
-                crc8 = (crc8 >> 1);
-            }
-        }
-    }
-
-    return crc8;
+    return ow_crc8(data, len);
 }
 
 /* Select a device by ROM ID */
 int onewire_select(unsigned char* romid) {
-    int i;
+    uint8_t match[9];
 
     if (!onewire_reset()) {
         return 0;
     }
-    onewire_tx_byte(0x55); // Match ROM command
-    for (i = 0; i < 8; i++) {
-        onewire_tx_byte(romid[i]);
-    }
+    match[0] = 0x55; // Match ROM command
+    memcpy(&match[1], romid, 8);
+    onewire_tx_block(match, sizeof(match));
     return 1;
 }
 
+/* Run the 64 triplets of a search pass on the onewire_search state
+   machine. The search command has been sent, the preferred directions
+   go in, the id_bit/cmp_id_bit pairs come back. About 13ms on the bus
+   and no FIFO round trip per bit. */
+static bool onewire_search_pass_pio(const uint32_t* dir, uint32_t* rx) {
+    PIO pio = owobj.pio;
+    uint sm = owobj.search_sm;
+    uint8_t start_addr = owobj.search_offset + onewire_search_offset_start;
+    uint32_t start;
+    int i;
+
+    /* the search command must be off the bus before the first triplet */
+    onewire_wait_for_idle();
+
+    pio_sm_clear_fifos(pio, sm);
+    pio_sm_restart(pio, sm);
+    pio_sm_exec(pio, sm, pio_encode_jmp(start_addr));
+    pio->txf[sm] = dir[0];
+    pio->txf[sm] = dir[1];
+    pio_sm_set_enabled(pio, sm, true);
+
+    start = time_us_32();
+    for (i = 0; i < OW_SEARCH_RX_WORDS; i++) {
+        while (pio_sm_is_rx_fifo_empty(pio, sm)) {
+            if (time_us_32() - start > 50000) {
+                pio_sm_set_enabled(pio, sm, false);
+                return false;
+            }
+        }
+        rx[i] = pio_sm_get(pio, sm);
+    }
+
+    /* the last write slot is still on the bus, the program
+       stalls at start when it is done */
+    while (pio_sm_get_pc(pio, sm) != start_addr) {
+        if (time_us_32() - start > 50000) {
+            break;
+        }
+    }
+    pio_sm_set_enabled(pio, sm, false);
+    return true;
+}
+
+/* The same pass, one onewire_triplet() round trip per bit */
+static void onewire_search_pass_cpu(const ow_search_t* s, uint32_t* rx) {
+    int id_bit, cmp_id_bit;
+    unsigned char search_direction;
+
+    for (uint32_t bit = 1; bit <= 64; bit++) {
+        search_direction = ow_search_preferred(s, bit);
+        onewire_triplet(&id_bit, &cmp_id_bit, &search_direction);
+        ow_search_pack(rx, bit, id_bit, cmp_id_bit);
+        if (id_bit && cmp_id_bit) {
+            break; // no devices, the pass decodes as such
+        }
+    }
+}
+
 /* This is code stolen from MAXIM AN3684, slightly modified
    to interface to the PIO onewire and to eliminate global
    variables. */
@@ -315,6 +409,11 @@ unsigned char calc_crc8(unsigned char data) {
 // continues from the previous search state. The search state
 // can be reset by using the 'OWFirst' function.
 //
+// The direction to take at every bit depends only on the previous
+// pass, so the whole pass is decided up front (ow_search_directions)
+// and the triplets run without the CPU on the onewire_search program.
+// The ROM and the state for the next pass come out of ow_search_decode.
+//
 // Returns:   TRUE (1) : when a 1-Wire device was found and its
 //                       Serial Number placed in the global ROM
 //            FALSE (0): when no new device was found.  Either the
@@ -322,117 +421,51 @@ unsigned char calc_crc8(unsigned char data) {
 //                       are no devices on the 1-Wire Net.
 //
 int OWSearch(struct owobj* search_owobj) {
-    int id_bit_number;
-    int last_zero;
-    int rom_byte_number;
-    int search_result;
-    int id_bit;
-    int cmp_id_bit;
-    unsigned char rom_byte_mask;
-    unsigned char search_direction;
-
-    // initialize for search
-    id_bit_number = 1;
-    last_zero = 0;
-    rom_byte_number = 0;
-    rom_byte_mask = 1;
-    search_result = FALSE;
-    search_owobj->crc8 = 0;
-
-    // if the last call was not the last one
-    if (!search_owobj->LastDeviceFlag) {
-        // 1-Wire reset
-        if (!onewire_reset()) {
-            // reset the search
-            search_owobj->LastDiscrepancy = 0;
-            search_owobj->LastDeviceFlag = FALSE;
-            search_owobj->LastFamilyDiscrepancy = 0;
-            return FALSE;
-        }
-
-        // issue the search command
-        onewire_tx_byte(0xf0);
-
-        // loop to do the search
-        do {
-            // if this discrepancy if before the Last Discrepancy
-            // on a previous next then pick the same as last time
-            if (id_bit_number < search_owobj->LastDiscrepancy) {
-                if ((search_owobj->ROM_NO[rom_byte_number] & rom_byte_mask) > 0) {
-                    search_direction = 1;
-                } else {
-                    search_direction = 0;
-                }
-            } else {
-                // if equal to last pick 1, if not then pick 0
-                if (id_bit_number == search_owobj->LastDiscrepancy) {
-                    search_direction = 1;
-                } else {
-                    search_direction = 0;
-                }
-            }
-
-            // Perform a triple operation on the DS2482 which will perform 2 read bits and 1 write bit
-            onewire_triplet(&id_bit, &cmp_id_bit, &search_direction);
-
-            // check for no devices on 1-Wire
-            if ((id_bit) && (cmp_id_bit)) {
-                break;
-            } else {
-                if ((!id_bit) && (!cmp_id_bit) && (search_direction == 0)) {
-                    last_zero = id_bit_number;
-
-                    // check for Last discrepancy in family
-                    if (last_zero < 9) {
-                        search_owobj->LastFamilyDiscrepancy = last_zero;
-                    }
-                }
-
-                // set or clear the bit in the ROM byte rom_byte_number
-                // with mask rom_byte_mask
-                if (search_direction == 1) {
-                    search_owobj->ROM_NO[rom_byte_number] |= rom_byte_mask;
-                } else {
-                    search_owobj->ROM_NO[rom_byte_number] &= (byte)~rom_byte_mask;
-                }
-
-                // increment the byte counter id_bit_number
-                // and shift the mask rom_byte_mask
-                id_bit_number++;
-                rom_byte_mask <<= 1;
+    ow_search_t s;
+    uint32_t dir[OW_SEARCH_TX_WORDS];
+    uint32_t rx[OW_SEARCH_RX_WORDS] = { 0 };
+
+    // if the last call was the last one the next search is like a first
+    if (search_owobj->LastDeviceFlag) {
+        OWSearchReset(search_owobj);
+        return FALSE;
+    }
 
-                // if the mask is 0 then go to new SerialNum byte rom_byte_number and reset mask
-                if (rom_byte_mask == 0) {
-                    calc_crc8(search_owobj->ROM_NO[rom_byte_number]); // accumulate the CRC
-                    rom_byte_number++;
-                    rom_byte_mask = 1;
-                }
-            }
-        } while (rom_byte_number < 8); // loop until through all ROM bytes 0-7
+    memcpy(s.rom, search_owobj->ROM_NO, sizeof(s.rom));
+    s.last_discrepancy = search_owobj->LastDiscrepancy;
+    s.last_family_discrepancy = search_owobj->LastFamilyDiscrepancy;
+    s.last_device = false;
 
-        // if the search was successful then
-        if (!((id_bit_number < 65) || (search_owobj->crc8 != 0))) {
-            // search successful so set LastDiscrepancy,LastDeviceFlag,search_result
-            search_owobj->LastDiscrepancy = last_zero;
+    // 1-Wire reset
+    if (!onewire_reset()) {
+        OWSearchReset(search_owobj);
+        return FALSE;
+    }
 
-            // check for last device
-            if (search_owobj->LastDiscrepancy == 0) {
-                search_owobj->LastDeviceFlag = TRUE;
-            }
+    // issue the search command
+    onewire_tx_byte(OW_SEARCH_ROM);
 
-            search_result = TRUE;
+    if (owobj.search_loaded) {
+        ow_search_directions(&s, dir);
+        if (!onewire_search_pass_pio(dir, rx)) {
+            OWSearchReset(search_owobj);
+            return FALSE;
         }
+    } else {
+        onewire_search_pass_cpu(&s, rx);
     }
 
-    // if no device found then reset counters so next 'search' will be like a first
-    if (!search_result || (search_owobj->ROM_NO[0] == 0)) {
-        search_owobj->LastDiscrepancy = 0;
-        search_owobj->LastDeviceFlag = FALSE;
-        search_owobj->LastFamilyDiscrepancy = 0;
-        search_result = FALSE;
+    // no device, a ROM that fails its CRC: reset so the next search is like a first
+    if (ow_search_decode(&s, rx) != OW_SEARCH_FOUND) {
+        OWSearchReset(search_owobj);
+        return FALSE;
     }
 
-    return search_result;
+    memcpy(search_owobj->ROM_NO, s.rom, sizeof(s.rom));
+    search_owobj->LastDiscrepancy = s.last_discrepancy;
+    search_owobj->LastFamilyDiscrepancy = s.last_family_discrepancy;
+    search_owobj->LastDeviceFlag = s.last_device;
+    return TRUE;
 }
 
 int OWSearchReset(struct owobj* search_owobj) {
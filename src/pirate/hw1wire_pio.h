@@ -27,6 +27,9 @@ struct owobj {
     uint offset;                   ///< PIO program offset in instruction memory
     uint pin;                      ///< GPIO pin for 1-Wire data signal
     uint dir;                      ///< GPIO pin for buffer direction control
+    uint search_sm;                ///< State machine running the ROM search pass
+    uint search_offset;            ///< ROM search program offset in instruction memory
+    bool search_loaded;            ///< ROM search program loaded, else triplets run from C
 
     unsigned char ROM_NO[8];       ///< Last device ROM code found during search
     int LastDiscrepancy;           ///< Last discrepancy bit position in search
@@ -95,6 +98,20 @@ void onewire_end_spu(void);
  */
 uint onewire_rx_byte(void);
 
+/**
+ * @brief Transmit bytes back to back, keeping the TX FIFO fed.
+ * @param data  Bytes to transmit
+ * @param len   Number of bytes
+ */
+void onewire_tx_block(const uint8_t* data, uint len);
+
+/**
+ * @brief Receive bytes back to back, keeping the TX FIFO fed with read slots.
+ * @param[out] data  Received bytes
+ * @param len        Number of bytes
+ */
+void onewire_rx_block(uint8_t* data, uint len);
+
 /**
  * @brief Perform search triplet operation.
  * @param[out] id_bit          First bit read from bus
@@ -104,7 +121,7 @@ uint onewire_rx_byte(void);
 void onewire_triplet(int* id_bit, int* cmp_id_bit, unsigned char* search_direction);
 
 /**
- * @brief Calculate Dallas/Maxim 1-Wire CRC8 for buffer.
+ * @brief Calculate Dallas/Maxim 1-Wire CRC8 for buffer (table driven).
  * @param data  Pointer to data buffer
  * @param len   Length of data
  * @return CRC8 value
@@ -129,6 +146,8 @@ unsigned char calc_crc8(unsigned char data);
  * @brief Search for next 1-Wire device on bus.
  * @param search_owobj  Pointer to owobj with search state
  * @return 1 if device found, 0 if search complete
+ * @note The 64 triplets of a pass run on the onewire_search PIO program
+ *       when it is loaded, from C otherwise.
  */
 int OWSearch(struct owobj* search_owobj);
 
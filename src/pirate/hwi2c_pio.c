@@ -10,6 +10,7 @@
 #include "pico/stdlib.h"
 #include "pirate.h"
 #include "hardware/pio.h"
+#include "hardware/dma.h"
 #include "pio_config.h"
 #include "hwi2c_pio.h"
 
@@ -210,6 +211,70 @@ hwi2c_status_t pio_i2c_read_timeout(uint8_t* in_data, bool ack, uint32_t timeout
     return i2c_result;
 }
 
+/*
+* DMA block: prepared TX FIFO words in, 9 bit RX words out
+*
+*/
+bool pio_i2c_dma_block(const uint16_t* tx, uint32_t tx_len, uint16_t* rx, uint32_t rx_len, uint32_t stall_us,
+                       void (*arrived)(void* ctx, uint32_t index, uint32_t time_us), void* ctx, uint32_t* received) {
+    *received = 0;
+    int tx_channel = dma_claim_unused_channel(false);
+    int rx_channel = dma_claim_unused_channel(false);
+    if (tx_channel < 0 || rx_channel < 0) {
+        if (tx_channel >= 0) dma_channel_unclaim(tx_channel);
+        if (rx_channel >= 0) dma_channel_unclaim(rx_channel);
+        return false;
+    }
+
+    if(!pio_sm_wait_idle(pio_config.pio, pio_config.sm, 0xfffff)) {
+        pio_i2c_resume_after_error();
+    }
+    while (!pio_sm_is_rx_fifo_empty(pio_config.pio, pio_config.sm)) {
+        (void)pio_i2c_get();
+    }
+
+    // 9 bits pushed right aligned, the low halfword has them all
+    dma_channel_config c = dma_channel_get_default_config(rx_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, pio_get_dreq(pio_config.pio, pio_config.sm, false));
+    dma_channel_configure(rx_channel, &c, rx, &pio_config.pio->rxf[pio_config.sm], rx_len, true);
+
+    // halfword writes, same as pio_i2c_put_timeout()
+    c = dma_channel_get_default_config(tx_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio_config.pio, pio_config.sm, true));
+    dma_channel_configure(tx_channel, &c, &pio_config.pio->txf[pio_config.sm], tx, tx_len, true);
+
+    uint32_t got = 0;
+    uint32_t last_us = time_us_32();
+    while (got < rx_len) {
+        uint32_t now_us = time_us_32();
+        uint32_t count = rx_len - dma_channel_hw_addr(rx_channel)->transfer_count;
+        while (got < count) {
+            if (arrived) arrived(ctx, got, now_us);
+            got++;
+            last_us = now_us;
+        }
+        if (got < rx_len && (now_us - last_us) > stall_us) {
+            break; // SCL held low
+        }
+    }
+    *received = got;
+
+    if (got < rx_len || !pio_sm_wait_idle(pio_config.pio, pio_config.sm, 0xfffff)) {
+        dma_channel_abort(tx_channel);
+        dma_channel_abort(rx_channel);
+        pio_i2c_resume_after_error();
+    }
+    dma_channel_unclaim(tx_channel);
+    dma_channel_unclaim(rx_channel);
+    return true;
+}
+
 /*
 * functions for bulk I2C transactions
 * TODO: handle ACK NACK in a new way!
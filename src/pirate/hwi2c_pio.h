@@ -180,6 +180,22 @@ hwi2c_status_t pio_i2c_transaction_array_timeout(
     uint8_t addr, uint8_t* txbuf, uint txlen, uint8_t* rxbuf, uint rxlen, uint32_t timeout);
 hwi2c_status_t pio_i2c_transaction_array_repeat_start(uint8_t addr, uint8_t* txbuf, uint txlen, uint8_t* rxbuf, uint rxlen, uint32_t timeout);
 hwi2c_status_t pio_i2c_wait_idle_extern(uint32_t timeout) ;
+
+/**
+ * @brief Run a block of prepared TX FIFO words by DMA and collect the RX words.
+ * @details Used by the scan command to queue many probes at once, see lib/i2c_scan.
+ * @param tx        TX FIFO words (see hwi2c.pio)
+ * @param tx_len    Number of TX words
+ * @param rx        Buffer for the 9 bit RX words
+ * @param rx_len    RX words the block pushes
+ * @param stall_us  Give up when no RX word arrives for this long
+ * @param arrived   Called with the index and arrival time of each RX word, may be NULL
+ * @param ctx       Passed to arrived
+ * @param[out] received  RX words received, less than rx_len if the bus hung
+ * @return false if no DMA channels were free
+ */
+bool pio_i2c_dma_block(const uint16_t* tx, uint32_t tx_len, uint16_t* rx, uint32_t rx_len, uint32_t stall_us,
+                       void (*arrived)(void* ctx, uint32_t index, uint32_t time_us), void* ctx, uint32_t* received);
 //hwi2c_status_t pio_i2c_transaction_bpio(uint8_t* txbuf, uint txlen, uint8_t* rxbuf, uint rxlen, uint32_t timeout);
 // ----------------------------------------------------------------------------
 // Low-level functions
@@ -0,0 +1,217 @@
+/**
+ * @file hwuart_rx.c
+ * @brief UART mode receive ring, always armed while the mode is active.
+ * @details A data DMA channel moves the UART data register into a ring of
+ *          16 bit entries and chains to a control channel that re-arms it,
+ *          like the PSU guard. The data register holds the framing, parity,
+ *          break and FIFO overrun flags above the byte, so every entry
+ *          keeps its own errors. The CPU only reads the transfer count.
+ *          With flow control RTS asks the sender to wait while the ring is
+ *          3/4 full, instead of only while a byte is being read.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+#include "hardware/dma.h"
+#include "pirate.h"
+#include "pirate/bio.h"
+#include "pirate/hwuart_rx.h"
+
+// 2048 entries, 2.2ms at 921600 baud 8N1, the DMA wraps the write address so it must be aligned to its size
+#define HWUART_RX_RING_BITS 12
+#define HWUART_RX_RING_LEN ((1u << HWUART_RX_RING_BITS) / sizeof(uint16_t))
+#define HWUART_RX_RTS_STOP (HWUART_RX_RING_LEN * 3 / 4)
+// the top 4 bits of the RP2350 transfer count are the mode, 0xf would be endless and never count down
+#if RPI_PLATFORM == RP2350
+#define HWUART_RX_COUNT_MASK 0x0fffffffu
+#else
+#define HWUART_RX_COUNT_MASK 0xffffffffu
+#endif
+// a multiple of the ring length, so the ring slot stays in step with rx_written across re-arms
+#define HWUART_RX_RELOAD (HWUART_RX_COUNT_MASK & ~(HWUART_RX_RING_LEN - 1))
+
+static uint16_t rx_ring[HWUART_RX_RING_LEN] __attribute__((aligned(1u << HWUART_RX_RING_BITS)));
+static const uint32_t rx_reload = HWUART_RX_RELOAD;
+static int rx_dma_data_channel = -1;
+static int rx_dma_control_channel = -1;
+static urx_ring_t rx;
+static uint32_t rx_last_count;  // DMA transfer count at the last poll
+static uint32_t rx_written;     // entries written by the DMA, free running
+static uint32_t rx_unreported;  // lost bytes not shown by hwuart_rx_display() yet
+static uint32_t rx_byte_ns;
+static uint8_t rx_pause_depth;  // nested hwuart_rx_pause() calls
+static bool rx_armed;
+static bool rx_flow_control;
+
+static void hwuart_rx_release_dma(void) {
+    if (rx_dma_data_channel >= 0) {
+        dma_channel_cleanup(rx_dma_data_channel);
+        dma_channel_unclaim(rx_dma_data_channel);
+        rx_dma_data_channel = -1;
+    }
+    if (rx_dma_control_channel >= 0) {
+        dma_channel_cleanup(rx_dma_control_channel);
+        dma_channel_unclaim(rx_dma_control_channel);
+        rx_dma_control_channel = -1;
+    }
+}
+
+static void hwuart_rx_rts(void) {
+    if (rx_flow_control) {
+        // 0: ready to receive
+        bio_put(M_UART_RTS, urx_avail(&rx) >= HWUART_RX_RTS_STOP);
+    }
+}
+
+// entries written since the count was last read at `last`, the control channel re-arms it at 0
+static uint32_t hwuart_rx_count(uint32_t* last) {
+    uint32_t count = dma_channel_hw_addr(rx_dma_data_channel)->transfer_count & HWUART_RX_COUNT_MASK;
+    uint32_t n = (count <= *last) ? *last - count : *last + rx_reload - count;
+    *last = count;
+    return n;
+}
+
+// continue from the current write address, the ring position stays in step with rx_written
+static void hwuart_rx_dma_run(void) {
+    while (uart_is_readable(M_UART_PORT)) {
+        (void)uart_getc(M_UART_PORT);
+    }
+    uart_get_hw(M_UART_PORT)->rsr = 0; // any write clears the error flags
+    rx_last_count = rx_reload;
+    dma_channel_set_trans_count(rx_dma_data_channel, rx_reload, true);
+    hwuart_rx_rts();
+}
+
+void hwuart_rx_poll(void) {
+    if (!rx_armed || rx_pause_depth) {
+        return;
+    }
+    rx_written += hwuart_rx_count(&rx_last_count);
+    rx_unreported += urx_advance(&rx, rx_written);
+    hwuart_rx_rts();
+}
+
+bool hwuart_rx_start(uint32_t byte_ns, bool flow_control) {
+    hwuart_rx_stop();
+    rx_dma_data_channel = dma_claim_unused_channel(false);
+    rx_dma_control_channel = dma_claim_unused_channel(false);
+    if (rx_dma_data_channel < 0 || rx_dma_control_channel < 0) {
+        hwuart_rx_release_dma();
+        return false;
+    }
+
+    // control channel re-arms the data channel when its (very long) transfer completes
+    dma_channel_config c = dma_channel_get_default_config(rx_dma_control_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(rx_dma_control_channel,
+                          &c,
+                          &dma_hw->ch[rx_dma_data_channel].al1_transfer_count_trig,
+                          &rx_reload,
+                          1,
+                          false);
+
+    // 16 bits of the data register: the byte and the FE/PE/BE/OE flags
+    c = dma_channel_get_default_config(rx_dma_data_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, HWUART_RX_RING_BITS);
+    channel_config_set_dreq(&c, uart_get_dreq(M_UART_PORT, false));
+    channel_config_set_chain_to(&c, rx_dma_control_channel);
+    dma_channel_configure(rx_dma_data_channel, &c, rx_ring, &uart_get_hw(M_UART_PORT)->dr, rx_reload, false);
+
+    urx_init(&rx, rx_ring, HWUART_RX_RING_LEN);
+    rx_written = 0;
+    rx_unreported = 0;
+    rx_byte_ns = byte_ns;
+    rx_flow_control = flow_control;
+    rx_pause_depth = 0;
+    rx_armed = true;
+    hwuart_rx_dma_run();
+    return true;
+}
+
+void hwuart_rx_stop(void) {
+    if (!rx_armed) {
+        return;
+    }
+    rx_armed = false;
+    dma_channel_abort(rx_dma_data_channel);
+    dma_channel_abort(rx_dma_control_channel);
+    hwuart_rx_release_dma();
+}
+
+void hwuart_rx_pause(void) {
+    if (!rx_armed) {
+        return;
+    }
+    if (rx_pause_depth == 0) {
+        hwuart_rx_poll();
+        dma_channel_abort(rx_dma_data_channel);
+        dma_channel_abort(rx_dma_control_channel);
+        // count what landed before the abort, it stays in the ring
+        rx_written += hwuart_rx_count(&rx_last_count);
+        rx_unreported += urx_advance(&rx, rx_written);
+    }
+    rx_pause_depth++;
+}
+
+void hwuart_rx_resume(void) {
+    if (!rx_armed || !rx_pause_depth) {
+        return;
+    }
+    if (--rx_pause_depth == 0) {
+        hwuart_rx_dma_run();
+    }
+}
+
+bool hwuart_rx_get(uint8_t* c, uint8_t* errors) {
+    uint16_t e;
+    hwuart_rx_poll();
+    if (!urx_get(&rx, &e)) {
+        return false;
+    }
+    *c = URX_ENTRY_DATA(e);
+    if (errors) {
+        *errors = URX_ENTRY_ERR(e);
+    }
+    hwuart_rx_rts();
+    return true;
+}
+
+bool hwuart_rx_wait(uint32_t timeout_us) {
+    uint32_t start = time_us_32();
+    do {
+        hwuart_rx_poll();
+        if (urx_avail(&rx)) {
+            return true;
+        }
+    } while (time_us_32() - start < timeout_us);
+    return false;
+}
+
+void hwuart_rx_flush(void) {
+    hwuart_rx_poll();
+    urx_flush(&rx);
+    rx_unreported = 0;
+    hwuart_rx_rts();
+}
+
+uint32_t hwuart_rx_display(urx_fmt_t* f) {
+    hwuart_rx_poll();
+    uint32_t now = time_us_32();
+    if (rx_unreported) {
+        urx_fmt_lost(f, rx_unreported, now - (uint32_t)((uint64_t)urx_avail(&rx) * rx_byte_ns / 1000));
+        rx_unreported = 0;
+    }
+    uint32_t n = urx_fmt_drain(f, &rx, now, rx_byte_ns);
+    hwuart_rx_rts();
+    return n;
+}
+
+const urx_ring_t* hwuart_rx_stats(void) {
+    return &rx;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file hwuart_rx.h
+ * @brief UART mode receive ring, always armed while the mode is active.
+ * @details A DMA channel copies the UART data register (byte and error
+ *          flags) into a ring as bytes arrive, so nothing is lost while
+ *          core0 prints. Async display, syntax reads and the bridge/NMEA
+ *          commands all take bytes from the ring (lib/uart_rx).
+ *          Commands that read the UART themselves pause the ring.
+ */
+
+#include "lib/uart_rx/uart_rx.h"
+
+/**
+ * @brief Arm the ring on M_UART_PORT.
+ * @param byte_ns       One character on the wire, for timestamps
+ * @param flow_control  Drive RTS (M_UART_RTS) from the ring fill
+ * @return false if the DMA channels are not available
+ */
+bool hwuart_rx_start(uint32_t byte_ns, bool flow_control);
+
+/**
+ * @brief Stop the ring and release the DMA channels.
+ */
+void hwuart_rx_stop(void);
+
+/**
+ * @brief Stop filling the ring so a command can read the UART, calls nest.
+ */
+void hwuart_rx_pause(void);
+
+/**
+ * @brief Fill the ring again after the last resume, bytes read while
+ *        paused are dropped from the UART FIFO.
+ */
+void hwuart_rx_resume(void);
+
+/**
+ * @brief Update the ring from the DMA and RTS from the ring fill.
+ */
+void hwuart_rx_poll(void);
+
+/**
+ * @brief Take one byte from the ring.
+ * @param c       Byte
+ * @param errors  URX_ERR_* flags of the byte, may be NULL
+ * @return false if nothing is waiting
+ */
+bool hwuart_rx_get(uint8_t* c, uint8_t* errors);
+
+/**
+ * @brief Wait for a byte in the ring.
+ * @param timeout_us  Give up after this long
+ * @return true if a byte is waiting
+ */
+bool hwuart_rx_wait(uint32_t timeout_us);
+
+/**
+ * @brief Drop everything waiting in the ring.
+ */
+void hwuart_rx_flush(void);
+
+/**
+ * @brief Render everything waiting in the ring, lost bytes first.
+ * @param f  Line view, the time column uses time_us_32()
+ * @return bytes rendered
+ */
+uint32_t hwuart_rx_display(urx_fmt_t* f);
+
+/**
+ * @brief Ring counters: lost bytes, error flags and peak fill.
+ */
+const urx_ring_t* hwuart_rx_stats(void);
@@ -11,6 +11,7 @@
 #include "lib/picofreq/picofreq.h"
 #include "pirate/irio_pio.h"
 #include "pirate/bio.h"
+#include "lib/ir_frame/ir_frame.h"
 
 static struct _pio_config pio_config_rx_mark;
 static struct _pio_config pio_config_rx_space;
@@ -18,6 +19,29 @@ static struct _pio_config pio_config_rx_mod_freq;
 static struct _pio_config pio_config_tx;
 static struct _pio_config pio_config_tx_carrier;
 
+// TX stream: one DMA channel feeds MARK/SPACE pairs to ir_out, -1 when the CPU does it
+static int irio_tx_dma_channel = -1;
+
+// RX capture: each counter state machine drains into its own DMA ring,
+// a control channel re-arms the ring channel when its transfer count runs out
+typedef struct {
+    int channel;
+    int control_channel;
+    uint32_t* ring;
+    uint32_t read;
+} irio_rx_ring_t;
+
+static irio_rx_ring_t irio_rx_ring_mark = { -1, -1, NULL, 0 };
+static irio_rx_ring_t irio_rx_ring_space = { -1, -1, NULL, 0 };
+static bool irio_rx_capture_dma = false;
+static enum {
+    CAPTURE_IDLE,
+    CAPTURE_SPACE,
+    CAPTURE_MARK
+} irio_rx_capture_state;
+static uint32_t irio_rx_capture_mark;
+static const uint32_t irio_rx_reload = 0xffffffff;
+
 void _irio_pio_tx_init(uint pin_tx, float desired_period_us, float mod_freq){
     #define INSTRUCTIONS_PER_CYCLE 2
     // Get the system clock frequency in Hz
@@ -119,10 +143,17 @@ bool irio_pio_tx_wait_idle(void){
     return false;
 }
 
-//drain both RX FIFOs for sync
+//drain both RX FIFOs for sync, and the capture rings when they are in use
 void irio_pio_rxtx_drain_fifo(void){
     pio_sm_clear_fifos(pio_config_rx_mark.pio, pio_config_rx_mark.sm);
     pio_sm_clear_fifos(pio_config_rx_space.pio, pio_config_rx_space.sm);
+    if(irio_rx_capture_dma){
+        irio_rx_ring_t* rings[] = { &irio_rx_ring_mark, &irio_rx_ring_space };
+        for(uint32_t i=0; i<count_of(rings); i++){
+            rings[i]->read = (dma_channel_hw_addr(rings[i]->channel)->write_addr - (uint32_t)rings[i]->ring) / sizeof(uint32_t);
+        }
+    }
+    irio_rx_capture_state = CAPTURE_IDLE;
     return;
 }
 
@@ -142,18 +173,60 @@ void irio_pio_tx_set_mod_freq(float mod_freq){
     busy_wait_us(1);//takes effect in 3 cycles...
 }
 
-//sends raw array of 32bit values. 
-//upper 16 bits are the mark, lower 16 bits are the space
-void irio_pio_tx_frame_write(float mod_freq, uint16_t pairs, uint32_t *buffer){
+//set the carrier and claim a DMA channel to feed the ir_out FIFO
+//returns false if no channel is free, the pairs are then pushed by the CPU
+bool irio_pio_tx_stream_begin(float mod_freq){
     //configure the PWM for the desired frequency
     irio_pio_tx_set_mod_freq(mod_freq);
 
-    //push the data to the FIFO, in pairs to prevent the transmitter from sticking 'on'
-    for(uint8_t i=0; i<pairs; i++){
-        pio_sm_put_blocking(pio_config_tx.pio, pio_config_tx.sm, buffer[i]);
-    }    
+    irio_tx_dma_channel = dma_claim_unused_channel(false);
+    if(irio_tx_dma_channel < 0){
+        return false;
+    }
+    dma_channel_config c = dma_channel_get_default_config(irio_tx_dma_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio_config_tx.pio, pio_config_tx.sm, true));
+    dma_channel_configure(irio_tx_dma_channel, &c, &pio_config_tx.pio->txf[pio_config_tx.sm], NULL, 0, false);
+    return true;
+}
+
+//queue pairs behind the ones already going out
+//with DMA this returns once the previous chunk is in the FIFO, so the caller can
+//fill a second buffer while this one plays. pairs must not change until the next
+//irio_pio_tx_stream_write() or irio_pio_tx_stream_end()
+void irio_pio_tx_stream_write(const uint32_t *pairs, uint32_t count){
+    if(irio_tx_dma_channel < 0){
+        //push the data to the FIFO, in pairs to prevent the transmitter from sticking 'on'
+        for(uint32_t i=0; i<count; i++){
+            pio_sm_put_blocking(pio_config_tx.pio, pio_config_tx.sm, pairs[i]);
+        }
+        return;
+    }
+    dma_channel_wait_for_finish_blocking(irio_tx_dma_channel);
+    dma_channel_transfer_from_buffer_now(irio_tx_dma_channel, pairs, count);
+}
+
+//wait for the last pair to go out and release the DMA channel
+//returns false on a PIO timeout
+bool irio_pio_tx_stream_end(void){
+    if(irio_tx_dma_channel >= 0){
+        dma_channel_wait_for_finish_blocking(irio_tx_dma_channel);
+        dma_channel_cleanup(irio_tx_dma_channel);
+        dma_channel_unclaim(irio_tx_dma_channel);
+        irio_tx_dma_channel = -1;
+    }
     //wait for end of transmission
-    if(!pio_sm_wait_idle(pio_config_tx.pio, pio_config_tx.sm, 0xfffff)){
+    return pio_sm_wait_idle(pio_config_tx.pio, pio_config_tx.sm, 0xfffff);
+}
+
+//sends raw array of 32bit values. 
+//upper 16 bits are the mark, lower 16 bits are the space
+void irio_pio_tx_frame_write(float mod_freq, uint32_t pairs, const uint32_t *buffer){
+    irio_pio_tx_stream_begin(mod_freq);
+    irio_pio_tx_stream_write(buffer, pairs);
+    if(!irio_pio_tx_stream_end()){
         printf("PIO TX timeout\r\n");
     }
     return;
@@ -168,56 +241,24 @@ void irio_pio_rx_reset_mod_freq(void){
 bool irio_pio_get_freq_mod(float *mod_freq, uint16_t *us){
     if(!pio_interrupt_get(pio_config_rx_mod_freq.pio, 0)) return false;
 
-    typedef enum _transition_state{
-        MARK,
-        SPACE,
-        DONE,
-        ERROR
-    }transition_state;
-
-    transition_state state=MARK;
-    uint32_t mark=0, space=0;
+    uint32_t samples[MEASURE_MOD_FREQ_FIFO_DEPTH];
+    uint32_t count=0, mark, space;
     //instead of getting 8 words directly, we drain the FIFO so it works
     //without change if the PIO is set for 4 or 8 deep FIFO
     while(!pio_sm_is_rx_fifo_empty(pio_config_rx_mod_freq.pio, pio_config_rx_mod_freq.sm)){
         uint32_t temp = pio_sm_get(pio_config_rx_mod_freq.pio, pio_config_rx_mod_freq.sm);
-
-        //we want to count the 0s and then the first string of 1s
-        //this will give us the modulation duration, which we can use to calculate the frequency
-        //00000000000000000000000000000000 00011111111111111111111111111111 
-        //11111111111111111111111111111111 11111111111111111111111111111111 
-        //11111111110000000000000000000000 00000000000011111111111111111111 
-        //11111111111111111111111111111111 11111111111111111111111111111111
-        for (int j = 31; j >= 0; j--) {
-            uint32_t mask = 1 << j;
-            switch(state){
-                case MARK:
-                    if (temp & mask) {
-                        if(mark==0){ 
-                            state=ERROR;
-                        }else{
-                            state=SPACE;
-                            space++;
-                        }
-                        break;
-                    }
-                    mark++;
-                    break;
-                case SPACE:
-                    if (temp & mask) {
-                        space++;
-                    } else {
-                        state=DONE;
-                    }
-                    break;
-                default:
-                    break;
-            }
-
+        if(count<count_of(samples)){
+            samples[count++]=temp;
         }
     }
 
-    if(state!=DONE){ //there was an error
+    //we want to count the 0s and then the first string of 1s
+    //this will give us the modulation duration, which we can use to calculate the frequency
+    //00000000000000000000000000000000 00011111111111111111111111111111 
+    //11111111111111111111111111111111 11111111111111111111111111111111 
+    //11111111110000000000000000000000 00000000000011111111111111111111 
+    //11111111111111111111111111111111 11111111111111111111111111111111
+    if(!ir_carrier_measure(samples, count, &mark, &space)){ //there was an error
         *mod_freq=0.0f;
     }else{
         *us = (mark+space);
@@ -364,6 +405,136 @@ ir_rx_status_t irio_pio_rx_frame_printf(uint32_t *rx_frame) {
     return IR_RX_FRAME_OK;
 }
 
+static void irio_rx_ring_release(irio_rx_ring_t *r){
+    int* channels[] = { &r->channel, &r->control_channel };
+    for(uint32_t i=0; i<count_of(channels); i++){
+        if(*channels[i] >= 0){
+            dma_channel_cleanup(*channels[i]);
+            dma_channel_unclaim(*channels[i]);
+            *channels[i] = -1;
+        }
+    }
+}
+
+static bool irio_rx_ring_setup(irio_rx_ring_t *r, struct _pio_config *cfg, uint32_t *ring){
+    r->channel = dma_claim_unused_channel(false);
+    r->control_channel = dma_claim_unused_channel(false);
+    if(r->channel < 0 || r->control_channel < 0){
+        irio_rx_ring_release(r);
+        return false;
+    }
+    r->ring = ring;
+    r->read = 0;
+
+    // control channel re-arms the ring channel when its (very long) transfer completes
+    dma_channel_config c = dma_channel_get_default_config(r->control_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(r->control_channel, &c, &dma_hw->ch[r->channel].al1_transfer_count_trig, &irio_rx_reload, 1, false);
+
+    c = dma_channel_get_default_config(r->channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, IRIO_RX_RING_BITS);
+    channel_config_set_dreq(&c, pio_get_dreq(cfg->pio, cfg->sm, false));
+    channel_config_set_chain_to(&c, r->control_channel);
+    dma_channel_configure(r->channel, &c, r->ring, &cfg->pio->rxf[cfg->sm], irio_rx_reload, true);
+    return true;
+}
+
+//next counter word from a ring, or straight from the FIFO without DMA
+static bool irio_rx_get(irio_rx_ring_t *r, struct _pio_config *cfg, uint32_t *word){
+    if(!irio_rx_capture_dma){
+        if(pio_sm_is_rx_fifo_empty(cfg->pio, cfg->sm)) return false;
+        *word = pio_sm_get(cfg->pio, cfg->sm);
+        return true;
+    }
+    uint32_t write = (dma_channel_hw_addr(r->channel)->write_addr - (uint32_t)r->ring) / sizeof(uint32_t);
+    if(write == r->read) return false;
+    *word = r->ring[r->read];
+    r->read = (r->read + 1) & (IRIO_RX_RING_WORDS - 1);
+    return true;
+}
+
+static void irio_rx_flush(irio_rx_ring_t *r, struct _pio_config *cfg){
+    uint32_t word;
+    while(irio_rx_get(r, cfg, &word));
+}
+
+void irio_pio_rx_capture_stop(void){
+    irio_rx_ring_release(&irio_rx_ring_mark);
+    irio_rx_ring_release(&irio_rx_ring_space);
+    irio_rx_capture_dma = false;
+    irio_pio_rxtx_drain_fifo();
+}
+
+//start capturing frames, mem holds IRIO_RX_CAPTURE_MEM bytes for the DMA rings
+//with mem NULL or no free DMA channels the FIFOs are polled instead
+//returns true when the rings are in use
+bool irio_pio_rx_capture_start(uint8_t *mem){
+    irio_pio_rx_capture_stop();
+    if(!mem) return false;
+
+    //the DMA wraps the write address, each ring must be aligned to its size
+    const uint32_t ring_bytes = 1u << IRIO_RX_RING_BITS;
+    uint32_t *rings = (uint32_t *)(((uintptr_t)mem + ring_bytes - 1) & ~(uintptr_t)(ring_bytes - 1));
+    if(!irio_rx_ring_setup(&irio_rx_ring_mark, &pio_config_rx_mark, rings)){
+        return false;
+    }
+    if(!irio_rx_ring_setup(&irio_rx_ring_space, &pio_config_rx_space, rings + IRIO_RX_RING_WORDS)){
+        irio_rx_ring_release(&irio_rx_ring_mark);
+        return false;
+    }
+    irio_rx_capture_dma = true;
+    return true;
+}
+
+//pair the MARK and SPACE counter words into c, the rings keep them while the
+//CPU is busy so frames of any length come in whole
+//returns true when a frame is complete, the carrier is measured afterwards into mod_freq/us
+bool irio_pio_rx_capture_poll(ir_capture_t *c, float *mod_freq, uint16_t *us){
+    uint32_t word;
+    while(true){
+        switch(irio_rx_capture_state){
+            case CAPTURE_IDLE:
+                //when IDLE, drop the repeating SPACE timeouts
+                irio_rx_flush(&irio_rx_ring_space, &pio_config_rx_space);
+                if(!irio_rx_get(&irio_rx_ring_mark, &pio_config_rx_mark, &word)) return false;
+                if(ir_count_timeout(word)) break; //MARK too long, the SPACE counter was never started
+                ir_capture_init(c, c->pairs, c->max);
+                irio_rx_capture_mark = word;
+                irio_rx_capture_state = CAPTURE_SPACE;
+                break;
+            case CAPTURE_SPACE:
+                if(!irio_rx_get(&irio_rx_ring_space, &pio_config_rx_space, &word)) return false;
+                if(ir_capture_feed(c, irio_rx_capture_mark, word)){
+                    goto capture_done; //timeout, note final space and go to idle
+                }
+                irio_rx_capture_state = CAPTURE_MARK;
+                break;
+            case CAPTURE_MARK:
+                //last was space, if another space, end of sequence
+                if(irio_rx_get(&irio_rx_ring_space, &pio_config_rx_space, &word)){
+                    goto capture_done;
+                }
+                if(!irio_rx_get(&irio_rx_ring_mark, &pio_config_rx_mark, &word)) return false;
+                irio_rx_capture_mark = word;
+                irio_rx_capture_state = CAPTURE_SPACE;
+                break;
+        }
+    }
+
+capture_done:
+    if(!irio_pio_get_freq_mod(mod_freq, us)){
+        *mod_freq = 0.0f;
+    }
+    irio_pio_rx_reset_mod_freq();
+    irio_rx_capture_state = CAPTURE_IDLE;
+    return true;
+}
+
 #if 0
 //debug function for developing the RX modulation frequency measurement
 void irio_pio_rx_mod_freq_get_debug(float *mod_freq){
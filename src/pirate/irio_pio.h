@@ -4,6 +4,14 @@
  * @details Provides configurable IR transmit/receive using PIO state machines.
  */
 
+#include "lib/ir_frame/ir_frame.h"
+
+// RX capture DMA rings: 2^IRIO_RX_RING_BITS bytes each, MARK and SPACE counters
+#define IRIO_RX_RING_BITS 10
+#define IRIO_RX_RING_WORDS ((1u << IRIO_RX_RING_BITS) / sizeof(uint32_t))
+// memory irio_pio_rx_capture_start() needs: both rings and room to align them
+#define IRIO_RX_CAPTURE_MEM (3u << IRIO_RX_RING_BITS)
+
 /**
  * @brief Initialize IR receiver PIO.
  * @param pin_demod  Demodulator input pin
@@ -67,7 +75,29 @@ void irio_pio_tx_write(uint32_t *data);
  * @param pairs     Number of mark/space pairs
  * @param buffer    Frame data buffer
  */
-void irio_pio_tx_frame_write(float mod_freq, uint16_t pairs, uint32_t *buffer);
+void irio_pio_tx_frame_write(float mod_freq, uint32_t pairs, const uint32_t *buffer);
+
+/**
+ * @brief Start streaming a frame, DMA feeds the transmitter FIFO.
+ * @param mod_freq  Modulation frequency in Hz
+ * @return          false if no DMA channel is free (pairs are pushed by the CPU)
+ */
+bool irio_pio_tx_stream_begin(float mod_freq);
+
+/**
+ * @brief Queue mark/space pairs behind the ones going out.
+ * @details Returns once the previous chunk is in the FIFO. Alternate two
+ *          buffers: one plays while the next is filled.
+ * @param pairs  Mark/space pairs, untouched until the next write or end
+ * @param count  Number of pairs
+ */
+void irio_pio_tx_stream_write(const uint32_t *pairs, uint32_t count);
+
+/**
+ * @brief Wait for the stream to go out and release the DMA channel.
+ * @return  false on PIO timeout
+ */
+bool irio_pio_tx_stream_end(void);
 
 /**
  * @brief Receive IR frame into buffer.
@@ -83,3 +113,24 @@ bool irio_pio_rx_frame_buf(float *mod_freq, uint16_t *us, uint16_t *pairs, uint3
  * @brief Reset receiver modulation frequency detection.
  */
 void irio_pio_rx_reset_mod_freq(void);
+
+/**
+ * @brief Start capturing frames into DMA rings.
+ * @param mem  IRIO_RX_CAPTURE_MEM bytes for the rings, NULL to poll the FIFOs
+ * @return     true if the DMA rings are in use
+ */
+bool irio_pio_rx_capture_start(uint8_t *mem);
+
+/**
+ * @brief Stop capturing and release the DMA channels.
+ */
+void irio_pio_rx_capture_stop(void);
+
+/**
+ * @brief Assemble captured mark/space durations into a frame.
+ * @param c         Capture buffer, set up with ir_capture_init()
+ * @param mod_freq  Output modulation frequency in Hz, 0 if not measured
+ * @param us        Output carrier period in 0.2us ticks
+ * @return          true when a frame is complete
+ */
+bool irio_pio_rx_capture_poll(ir_capture_t *c, float *mod_freq, uint16_t *us);
@@ -0,0 +1,155 @@
+/**
+ * @file jtag_pio.c
+ * @brief JTAG shifter on PIO with DMA.
+ * @details Every run starts with the bit count. The TX channel feeds the
+ *          TDI words, the RX channel takes the full TDO words and the CPU
+ *          reads the last, partial word the program pushes at the end.
+ *          That word also tells the CPU the run is over and TCK is low,
+ *          so TMS can change. The last bit of a scan is its own one bit
+ *          run with TMS high.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "pirate.h"
+#include "pio_config.h"
+#include "pirate/bio.h"
+#include "pirate/jtag_pio.h"
+#include "jtag.pio.h"
+
+static struct _pio_config pio_config;
+static int tx_channel = -1;
+static int rx_channel = -1;
+static const uint32_t zero = 0;
+static uint32_t sink;
+
+static void jtag_pio_release(void) {
+    int* channels[] = { &tx_channel, &rx_channel };
+    for (uint32_t i = 0; i < count_of(channels); i++) {
+        if (*channels[i] >= 0) {
+            dma_channel_cleanup(*channels[i]);
+            dma_channel_unclaim(*channels[i]);
+            *channels[i] = -1;
+        }
+    }
+}
+
+bool jtag_pio_init(uint32_t freq) {
+    tx_channel = dma_claim_unused_channel(false);
+    rx_channel = dma_claim_unused_channel(false);
+    if (tx_channel < 0 || rx_channel < 0) {
+        jtag_pio_release();
+        return false;
+    }
+
+    bio_buf_output(M_SPI_CLK);
+    bio_buf_output(M_SPI_CDO);
+    bio_buf_input(M_SPI_CDI);
+    bio_set_function(M_SPI_CS, GPIO_FUNC_SIO);
+    bio_put(M_SPI_CS, 0);
+    bio_output(M_SPI_CS);
+
+    pio_config.pio = PIO_MODE_PIO;
+    pio_config.sm = 0;
+    pio_config.program = &jtag_program;
+    pio_config.offset = pio_add_program(pio_config.pio, pio_config.program);
+#ifdef BP_PIO_SHOW_ASSIGNMENT
+    printf("PIO: pio=%d, sm=%d, offset=%d\r\n", PIO_NUM(pio_config.pio), pio_config.sm, pio_config.offset);
+#endif
+    jtag_program_init(pio_config.pio,
+                      pio_config.sm,
+                      pio_config.offset,
+                      bio2bufiopin[M_SPI_CDO],
+                      bio2bufiopin[M_SPI_CLK],
+                      bio2bufiopin[M_SPI_CDI],
+                      freq);
+    return true;
+}
+
+void jtag_pio_cleanup(void) {
+    jtag_pio_release();
+    pio_sm_set_enabled(pio_config.pio, pio_config.sm, false);
+    pio_remove_program(pio_config.pio, pio_config.program, pio_config.offset);
+    bio_input(M_SPI_CS);
+    bio_buf_input(M_SPI_CLK);
+    bio_buf_input(M_SPI_CDO);
+}
+
+uint32_t jtag_pio_set_freq(uint32_t freq) {
+    float div = clock_get_hz(clk_sys) / (5 * (float)freq);
+    pio_sm_set_clkdiv(pio_config.pio, pio_config.sm, div < 1.0f ? 1.0f : div);
+    return jtag_program_freq(freq);
+}
+
+// one run of bits (> 0), returns the last, partial TDO word right aligned
+static uint32_t jtag_pio_run(const uint32_t* tdi, bool tdi_inc, uint32_t* tdo, uint32_t bits) {
+    PIO pio = pio_config.pio;
+    uint sm = pio_config.sm;
+    uint32_t full = bits / 32;
+
+    pio_sm_put_blocking(pio, sm, bits - 1);
+    if (full) {
+        dma_channel_config c = dma_channel_get_default_config(rx_channel);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, tdo != NULL);
+        channel_config_set_dreq(&c, pio_get_dreq(pio, sm, false));
+        dma_channel_configure(rx_channel, &c, tdo ? tdo : &sink, &pio->rxf[sm], full, true);
+    }
+    dma_channel_config c = dma_channel_get_default_config(tx_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, tdi_inc);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
+    dma_channel_configure(tx_channel, &c, &pio->txf[sm], tdi, (bits + 31) / 32, true);
+
+    // the full words first, the DMA must not lose the race for them
+    if (full) {
+        dma_channel_wait_for_finish_blocking(rx_channel);
+    }
+    uint32_t last = pio_sm_get_blocking(pio, sm);
+    return (bits & 31) ? last >> (32 - (bits & 31)) : 0;
+}
+
+void jtag_pio_tms(uint32_t tms, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        bio_put(M_SPI_CS, (tms >> i) & 1);
+        jtag_pio_run(&zero, false, NULL, 1);
+    }
+    bio_put(M_SPI_CS, 0);
+}
+
+void jtag_pio_shift(const uint8_t* tdi, uint8_t* tdo, uint32_t bits, bool exit) {
+    if (!bits) {
+        return;
+    }
+    uint32_t body = exit ? bits - 1 : bits;
+    if (body) {
+        uint32_t last = jtag_pio_run((const uint32_t*)tdi, true, (uint32_t*)tdo, body);
+        if (tdo && (body & 31)) {
+            // whole bytes only, the buffer may end there
+            memcpy(&tdo[(body / 32) * 4], &last, ((body & 31) + 7) / 8);
+        }
+    }
+    if (exit) {
+        uint32_t b = bits - 1;
+        uint32_t in = (tdi[b / 8] >> (b % 8)) & 1;
+        bio_put(M_SPI_CS, 1);
+        uint32_t out = jtag_pio_run(&in, false, NULL, 1);
+        bio_put(M_SPI_CS, 0);
+        if (tdo) {
+            uint8_t m = 1u << (b % 8);
+            uint8_t keep = (b % 8) ? tdo[b / 8] & (m - 1) : 0;
+            tdo[b / 8] = keep | (out ? m : 0);
+        }
+    }
+}
+
+void jtag_pio_clocks(uint32_t count) {
+    if (count) {
+        jtag_pio_run(&zero, false, NULL, count);
+    }
+}
@@ -0,0 +1,45 @@
+/**
+ * @file jtag_pio.h
+ * @brief JTAG shifter on PIO with DMA.
+ * @details TCK, TDI and TDO are run by a PIO state machine (jtag.pio), TMS
+ *          is a GPIO set between runs. Long scans go through two DMA
+ *          channels, one word of TDI and TDO per 32 TCK, so a scan of any
+ *          length costs the CPU a few register writes. Vectors are LSB
+ *          first, byte 0 bit 0 is shifted first, and must be word aligned.
+ *
+ *          Pins: TCK=M_SPI_CLK, TDI=M_SPI_CDO, TDO=M_SPI_CDI, TMS=M_SPI_CS.
+ */
+
+/**
+ * @brief Load the program and claim two DMA channels.
+ * @param freq  TCK in Hz
+ * @return false if no DMA channels are free
+ */
+bool jtag_pio_init(uint32_t freq);
+
+/**
+ * @brief Release the DMA channels, remove the program, pins to inputs.
+ */
+void jtag_pio_cleanup(void);
+
+/**
+ * @brief Change TCK.
+ * @return the frequency the divider gives
+ */
+uint32_t jtag_pio_set_freq(uint32_t freq);
+
+/**
+ * @brief Clock TMS bits, LSB first, TDI low.
+ */
+void jtag_pio_tms(uint32_t tms, uint32_t count);
+
+/**
+ * @brief Shift a scan, TMS high on the last bit if exit.
+ * @param tdo  NULL to drop TDO
+ */
+void jtag_pio_shift(const uint8_t* tdi, uint8_t* tdo, uint32_t bits, bool exit);
+
+/**
+ * @brief TCK with TMS and TDI low.
+ */
+void jtag_pio_clocks(uint32_t count);
@@ -27,6 +27,17 @@ enum big_buffer_owners {
     BP_BIG_BUFFER_DISKFORMAT,
     BP_BIG_BUFFER_EDITOR,
     BP_BIG_BUFFER_TXTEST,
+    BP_BIG_BUFFER_HWLED,
+    BP_BIG_BUFFER_PSULOG,
+    BP_BIG_BUFFER_GLITCH,
+    BP_BIG_BUFFER_IR,
+    BP_BIG_BUFFER_WAV,
+    BP_BIG_BUFFER_GAME,
+    BP_BIG_BUFFER_UART_MON,
+    BP_BIG_BUFFER_SNIFF_2WIRE,
+    BP_BIG_BUFFER_SVF,
+    BP_BIG_BUFFER_BUS_REPLAY,
+    BP_BIG_BUFFER_PATTERN,
 };
 
 /// @brief Attempts to allocate a nand page buffer.
@@ -19,6 +19,8 @@
 #include "pirate/shift.h"
 #include "pirate/psu.h"
 #include "pirate/amux.h"
+#include "pirate/psu_guard.h"
+#include "lib/psu_trip/psu_trip.h"
 #if BP_HW_PSU_DAC
     #include "hardware/i2c.h"
 #endif
@@ -39,6 +41,14 @@
 #define PSU_I_HIGH 500 // mA
 #define PSU_I_RANGE ((PSU_I_HIGH * 10000) - (PSU_I_LOW * 10000))
 
+// the guard trips 10mA over the current limit, the current limit circuit holds the output at the limit
+#define PSU_GUARD_CURRENT_MARGIN ((10 * 4095) / PSU_I_HIGH)
+// while the guard watches VOUT the fuse latch is read less often: each read moves the AMUX
+// off VOUT, and the guard skips its VOUT check until the AMUX is back and settled
+#define PSU_FUSE_POLL_US 10000
+// psulog records every pause as a gap, poll less often while it logs
+#define PSU_FUSE_POLL_LOG_US 100000
+
 struct psu_status_t psu_status;
 
 /// @brief Reset the PSU current fuse/trigger
@@ -76,6 +86,23 @@ void psu_vreg_enable(bool enable) {
     #endif
 }
 
+/// @brief Cut the output from interrupt context, psu_disable() does the rest
+/// @details The 74HC595 (CURRENT_EN) and I2C DACs can't be used from an interrupt.
+///          With PWM control the VREG is set to the lowest voltage and the current
+///          limit to 0, the current limit circuit then opens the output.
+/// @param  None
+/// @return None
+void psu_fast_shutdown(void) {
+    #if BP_HW_IOEXP_NONE
+        gpio_put(CURRENT_EN, 1); // high is off
+    #endif
+    #if BP_HW_PSU_PWM
+        uint slice_num = pwm_gpio_to_slice_num(PSU_PWM_VREG_ADJ);
+        pwm_set_chan_level(slice_num, pwm_gpio_to_channel(PSU_PWM_VREG_ADJ), PWM_TOP);
+        pwm_set_chan_level(slice_num, pwm_gpio_to_channel(PSU_PWM_CURRENT_ADJ), 0);
+    #endif
+}
+
 /// @brief Override or restore the current limiting circuitry
 /// @param  enable  true to disable current limiting (override), false to enable limiting
 /// @return None
@@ -208,25 +235,41 @@ bool psu_vout_ok(void) {
     return (amux_read(HW_ADC_MUX_VREF_VOUT) > psu_status.undervoltage_limit_adc);
 }
 
-/// @brief 
-/// @param  
-/// @return 
 /// @brief Poll PSU sensors for fuse or Vout errors and handle them
+/// @details Faults found by the PSU guard have already cut the output, this
+///          finishes the shutdown and reports them.
 /// @param  None
 /// @return true if an error was detected and handled, false otherwise
 bool psu_poll_fuse_vout_error(void) {
+    static uint32_t fuse_poll_us = 0;
+
     if(!psu_status.enabled) {
         return false;
     }
     bool error = false;
-    if (!psu_fuse_ok()) {
+    uint8_t trip = psu_guard_tripped();
+    if (trip & PSU_TRIP_OVERCURRENT) {
         psu_status.error_overcurrent = true;
         error = true;
     }
-    if (!psu_vout_ok()) {
+    if (trip & PSU_TRIP_UNDERVOLTAGE) {
         psu_status.error_undervoltage = true;
         error = true;
     }
+    // the guard watches VOUT, reading the fuse latch through the AMUX holds off that check
+    bool guard = psu_guard_running();
+    uint32_t poll_us = psu_guard_logging() ? PSU_FUSE_POLL_LOG_US : PSU_FUSE_POLL_US;
+    if (!guard || (time_us_32() - fuse_poll_us) >= poll_us) {
+        fuse_poll_us = time_us_32();
+        if (!psu_fuse_ok()) {
+            psu_status.error_overcurrent = true;
+            error = true;
+        }
+        if (!guard && !psu_vout_ok()) {
+            psu_status.error_undervoltage = true;
+            error = true;
+        }
+    }
     // Re-check enabled flag to avoid race condition with psu_disable() on other core
     // If PSU was intentionally disabled between our initial check and now, don't flag as error
     if(error && psu_status.enabled) {
@@ -294,6 +337,7 @@ void psu_measure(uint32_t* vout, uint32_t* isense, uint32_t* vreg, bool* fuse) {
 /// @param  None
 /// @return None
 void psu_disable(void) {
+    psu_guard_stop();
     psu_status.enabled = false;
     psu_vreg_enable(false);
     psu_dac_set(PWM_TOP, 0);
@@ -356,6 +400,14 @@ uint32_t psu_enable(float volts, float current, bool current_limit_override, uin
 
     psu_status.enabled = true;
 
+    // watch the output from a timer interrupt instead of the main loop
+    uint16_t current_limit = 0;
+    if (!current_limit_override) {
+        current_limit = (uint16_t)MIN(4095, (psu_status.current_requested_float * 4095.f / PSU_I_HIGH) + PSU_GUARD_CURRENT_MARGIN);
+    }
+    uint16_t vout_limit = psu_status.undervoltage_limit_override ? 0 : psu_status.undervoltage_limit_adc;
+    psu_guard_start(current_limit, vout_limit);
+
     return PSU_OK;
 }
 
@@ -122,6 +122,12 @@ bool psu_vout_ok(void);
  */
 void psu_vreg_enable(bool enable);
 
+/**
+ * @brief Cut the output from interrupt context.
+ * @note Used by the PSU guard, call psu_disable() afterwards to finish the shutdown.
+ */
+void psu_fast_shutdown(void);
+
 /**
  * @brief Override current limiting circuitry.
  * @param enable  true to disable current limiting, false to enable
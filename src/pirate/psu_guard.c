@@ -0,0 +1,349 @@
+/**
+ * @file psu_guard.c
+ * @brief PSU fault watchdog, independent of the core1 main loop.
+ * @details A data DMA channel moves ADC FIFO samples into a ring and chains to
+ *          a control channel that re-arms it, like the frequency counter.
+ *          A repeating timer runs psu_trip_process() on the new slots and calls
+ *          psu_fast_shutdown() on a fault. Sampling stops while something else
+ *          owns the ADC (adc_busy_wait(), scope) and the AMUX is parked back on
+ *          VOUT afterwards. AMUX reads don't stop it, they take their sample
+ *          from the even slots while VOUT checks are held off.
+ *          While psulog runs the ADC goes to its full rate and the same
+ *          timer also feeds the new slots to the psu_log reducer. Time the
+ *          ADC was lent to someone else is reported to it as a gap.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/sync.h"
+#include "pirate.h"
+#include "pirate/amux.h"
+#include "display/scope.h"
+#include "pirate/psu.h"
+#include "pirate/psu_guard.h"
+#include "lib/psu_trip/psu_trip.h"
+#include "lib/psu_log/psu_log.h"
+
+// 40k conversions/s shared by the two channels, each channel every 50us
+#define PSU_GUARD_SAMPLE_US 25
+#define PSU_GUARD_PAIR_NS (2 * 1000 * PSU_GUARD_SAMPLE_US)
+#define PSU_GUARD_CHECK_US 50
+#define PSU_GUARD_DEBOUNCE 2 // worst case 152us, see psu_trip_worst_case_us()
+// the AMUX needs 60us on a new channel (see amux_read()), in VOUT samples
+#define PSU_GUARD_VOUT_SETTLE ((60 + (2 * PSU_GUARD_SAMPLE_US) - 1) / (2 * PSU_GUARD_SAMPLE_US))
+
+// 1024 samples per channel, the DMA wraps the write address so it must be aligned to its size
+// a timer interrupt held off for longer than the ring (4ms at the full ADC rate) misses samples
+#define PSU_GUARD_RING_BITS 12
+#define PSU_GUARD_RING_LEN ((1u << PSU_GUARD_RING_BITS) / sizeof(uint16_t))
+
+static uint16_t guard_ring[PSU_GUARD_RING_LEN] __attribute__((aligned(1u << PSU_GUARD_RING_BITS)));
+static const uint32_t guard_reload = 0xffffffff;
+static int guard_dma_data_channel = -1;
+static int guard_dma_control_channel = -1;
+static repeating_timer_t guard_timer;
+static spin_lock_t* guard_lock;
+static psu_trip_t guard_trip;
+static uint32_t guard_read;          // next ring slot for the comparator
+static uint8_t guard_pause_depth;    // nested psu_guard_pause() calls
+static volatile bool guard_armed;    // between psu_guard_start() and psu_guard_stop()
+static volatile bool guard_sampling; // ADC and DMA running
+static volatile uint8_t guard_tripped;
+static uint32_t guard_pair_ns = PSU_GUARD_PAIR_NS;
+static psu_log_reduce_t* guard_log; // psulog reducer, NULL when not logging
+static bool guard_log_armed;        // armed for psulog only, no limits
+static bool guard_log_gap;          // sampling stopped while logging
+static uint32_t guard_stopped_us;
+
+static void psu_guard_release_dma(void) {
+    if (guard_dma_data_channel >= 0) {
+        dma_channel_cleanup(guard_dma_data_channel);
+        dma_channel_unclaim(guard_dma_data_channel);
+        guard_dma_data_channel = -1;
+    }
+    if (guard_dma_control_channel >= 0) {
+        dma_channel_cleanup(guard_dma_control_channel);
+        dma_channel_unclaim(guard_dma_control_channel);
+        guard_dma_control_channel = -1;
+    }
+}
+
+static uint32_t psu_guard_write_slot(void) {
+    uint32_t write_addr = dma_channel_hw_addr(guard_dma_data_channel)->write_addr;
+    return ((write_addr - (uint32_t)guard_ring) / sizeof(uint16_t)) & (PSU_GUARD_RING_LEN - 1);
+}
+
+// debounce and VOUT settling are counted in samples, keep them the same in time at any rate
+static void psu_guard_timing(uint32_t pair_ns) {
+    uint32_t debounce = (PSU_GUARD_DEBOUNCE * PSU_GUARD_PAIR_NS) / pair_ns;
+    guard_trip.debounce = (uint8_t)MIN(MAX(debounce, 1), 255);
+    guard_trip.vout_settle = (uint16_t)((60000 + pair_ns - 1) / pair_ns);
+    guard_pair_ns = pair_ns;
+}
+
+// call with guard_lock held, hand the new slots to the comparator and the logger
+static void psu_guard_service(void) {
+    uint32_t write = psu_guard_write_slot();
+    uint32_t count = (write - guard_read) & (PSU_GUARD_RING_LEN - 1);
+    uint8_t trip = psu_trip_process(&guard_trip, guard_ring, PSU_GUARD_RING_LEN, guard_read, count);
+    if (guard_log) {
+        psu_log_reduce_process(guard_log, guard_ring, PSU_GUARD_RING_LEN, guard_read, count);
+    }
+    guard_read = write;
+    if (trip) {
+        psu_fast_shutdown();
+        guard_tripped = trip;
+    }
+}
+
+// call with guard_lock held
+static void psu_guard_sampling_start(void) {
+    adc_run(false);
+    adc_fifo_setup(true,  // samples into the FIFO
+                   true,  // DREQ for the DMA
+                   1,     // DREQ on every sample
+                   false, // no error bit, keep 12 bits
+                   false);
+    adc_fifo_drain();
+    adc_set_clkdiv(((guard_pair_ns * 48) / 2000) - 1); // 48MHz ADC clock, two conversions per pair
+    // VOUT first so even ring slots are VOUT, odd slots current sense
+    adc_select_input(AMUX_OUT_ADC);
+    adc_set_round_robin((1u << AMUX_OUT_ADC) | (1u << CURRENT_SENSE_ADC));
+
+    dma_channel_set_write_addr(guard_dma_data_channel, guard_ring, false);
+    dma_channel_set_trans_count(guard_dma_data_channel, guard_reload, true);
+    guard_read = 0;
+    psu_trip_restart(&guard_trip);
+    if (guard_log && guard_log_gap) {
+        uint64_t missed_ns = (uint64_t)(time_us_32() - guard_stopped_us) * 1000;
+        psu_log_reduce_gap(guard_log, (uint32_t)(missed_ns / guard_pair_ns));
+    }
+    guard_log_gap = false;
+    guard_sampling = true;
+    adc_run(true);
+}
+
+// call with guard_lock held, leaves the ADC as amux_read() expects it
+static void psu_guard_sampling_stop(void) {
+    guard_sampling = false;
+    adc_run(false);
+    adc_fifo_drain(); // waits for a conversion in progress
+    dma_channel_abort(guard_dma_data_channel);
+    dma_channel_abort(guard_dma_control_channel);
+    if (!guard_tripped) {
+        psu_guard_service(); // the last samples before the gap
+    }
+    guard_stopped_us = time_us_32();
+    guard_log_gap = (guard_log != NULL);
+    adc_set_round_robin(0);
+    adc_fifo_setup(false, false, 0, false, false);
+    adc_fifo_drain();
+    adc_set_clkdiv(0);
+}
+
+static bool psu_guard_check(repeating_timer_t* rt) {
+    uint32_t irq = spin_lock_blocking(guard_lock);
+    if (guard_sampling && !guard_tripped) {
+        psu_guard_service();
+    }
+    spin_unlock(guard_lock, irq);
+    return true;
+}
+
+static bool psu_guard_arm(uint16_t current_limit, uint16_t vout_limit) {
+    if (!guard_lock) {
+        guard_lock = spin_lock_instance(spin_lock_claim_unused(true));
+    }
+    guard_dma_data_channel = dma_claim_unused_channel(false);
+    guard_dma_control_channel = dma_claim_unused_channel(false);
+    if (guard_dma_data_channel < 0 || guard_dma_control_channel < 0) {
+        psu_guard_release_dma();
+        return false;
+    }
+
+    // control channel re-arms the data channel when its (very long) transfer completes
+    dma_channel_config c = dma_channel_get_default_config(guard_dma_control_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(guard_dma_control_channel,
+                          &c,
+                          &dma_hw->ch[guard_dma_data_channel].al1_transfer_count_trig,
+                          &guard_reload,
+                          1,
+                          false);
+
+    c = dma_channel_get_default_config(guard_dma_data_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, PSU_GUARD_RING_BITS);
+    channel_config_set_dreq(&c, DREQ_ADC);
+    channel_config_set_chain_to(&c, guard_dma_control_channel);
+    dma_channel_configure(guard_dma_data_channel, &c, guard_ring, &adc_hw->fifo, guard_reload, false);
+
+    psu_trip_init(&guard_trip, current_limit, vout_limit, PSU_GUARD_DEBOUNCE, PSU_GUARD_VOUT_SETTLE);
+    psu_guard_timing(PSU_GUARD_PAIR_NS);
+    guard_tripped = 0;
+    guard_log = NULL;
+    guard_log_gap = false;
+
+    // take the ADC from anyone using it on the other core
+    adc_busy_wait(true);
+    amux_select_input(HW_ADC_MUX_VREF_VOUT);
+    uint32_t irq = spin_lock_blocking(guard_lock);
+    guard_armed = true;
+    // the scope owns the ADC until it stops and resumes us
+    guard_pause_depth = scope_running ? 1 : 0;
+    if (!guard_pause_depth) {
+        psu_guard_sampling_start();
+    }
+    spin_unlock(guard_lock, irq);
+    adc_busy_wait(false);
+
+    add_repeating_timer_us(-PSU_GUARD_CHECK_US, psu_guard_check, NULL, &guard_timer);
+    return true;
+}
+
+bool psu_guard_start(uint16_t current_limit, uint16_t vout_limit) {
+    psu_guard_stop();
+    if (!current_limit && !vout_limit) {
+        return true; // nothing to watch
+    }
+    return psu_guard_arm(current_limit, vout_limit);
+}
+
+void psu_guard_stop(void) {
+    if (!guard_armed) {
+        return;
+    }
+    cancel_repeating_timer(&guard_timer);
+    adc_busy_wait(true);
+    uint32_t irq = spin_lock_blocking(guard_lock);
+    guard_armed = false;
+    if (guard_sampling) {
+        psu_guard_sampling_stop();
+    }
+    guard_tripped = 0;
+    guard_log = NULL;
+    guard_log_armed = false;
+    spin_unlock(guard_lock, irq);
+    adc_busy_wait(false);
+    psu_guard_release_dma();
+}
+
+bool psu_guard_running(void) {
+    return guard_armed;
+}
+
+uint8_t psu_guard_tripped(void) {
+    return guard_tripped;
+}
+
+void psu_guard_pause(void) {
+    if (!guard_armed) {
+        return;
+    }
+    uint32_t irq = spin_lock_blocking(guard_lock);
+    if (guard_pause_depth++ == 0 && guard_sampling) {
+        psu_guard_sampling_stop();
+    }
+    spin_unlock(guard_lock, irq);
+}
+
+void psu_guard_resume(void) {
+    if (!guard_armed || !guard_pause_depth) {
+        return;
+    }
+    if (guard_pause_depth == 1) {
+        // shift register or GPIOs, not inside the spin lock
+        amux_select_input(HW_ADC_MUX_VREF_VOUT);
+    }
+    uint32_t irq = spin_lock_blocking(guard_lock);
+    if (--guard_pause_depth == 0 && guard_armed) {
+        psu_guard_sampling_start();
+    }
+    spin_unlock(guard_lock, irq);
+}
+
+bool psu_guard_amux_begin(void) {
+    if (!guard_armed) {
+        return false;
+    }
+    uint32_t irq = spin_lock_blocking(guard_lock);
+    bool shared = guard_sampling && !guard_log;
+    if (shared) {
+        psu_trip_vout_hold(&guard_trip, true);
+    }
+    spin_unlock(guard_lock, irq);
+    return shared;
+}
+
+uint16_t psu_guard_amux_sample(void) {
+    const volatile uint16_t* ring = guard_ring;
+    uint32_t start = psu_guard_write_slot();
+    uint32_t write = start;
+    uint32_t t0 = time_us_32();
+    // the slot being converted now may have started before the AMUX settled,
+    // after three more slots the newest even one was converted after this call
+    // (give up if the scope stopped the sampling meanwhile)
+    while (((write - start) & (PSU_GUARD_RING_LEN - 1)) < 3 && time_us_32() - t0 < 8 * PSU_GUARD_SAMPLE_US) {
+        write = psu_guard_write_slot();
+    }
+    uint32_t slot = (write - 1) & (PSU_GUARD_RING_LEN - 1);
+    return ring[slot & 1 ? (slot - 1) & (PSU_GUARD_RING_LEN - 1) : slot];
+}
+
+uint16_t psu_guard_current_sample(void) {
+    const volatile uint16_t* ring = guard_ring;
+    uint32_t slot = (psu_guard_write_slot() - 1) & (PSU_GUARD_RING_LEN - 1);
+    return ring[slot & 1 ? slot : (slot - 1) & (PSU_GUARD_RING_LEN - 1)];
+}
+
+void psu_guard_amux_end(void) {
+    amux_select_input(HW_ADC_MUX_VREF_VOUT);
+    uint32_t irq = spin_lock_blocking(guard_lock);
+    psu_trip_vout_hold(&guard_trip, false);
+    spin_unlock(guard_lock, irq);
+}
+
+bool psu_guard_log_start(uint32_t pair_ns, psu_log_reduce_t* reduce) {
+    if (!guard_armed) {
+        // limits overridden, sample anyway
+        if (!psu_guard_arm(0, 0)) {
+            return false;
+        }
+        guard_log_armed = true;
+    }
+    // restart sampling at the new rate, no gap before the first record
+    adc_busy_wait(true);
+    uint32_t irq = spin_lock_blocking(guard_lock);
+    psu_guard_timing(pair_ns);
+    guard_log = reduce;
+    guard_log_gap = false;
+    spin_unlock(guard_lock, irq);
+    adc_busy_wait(false);
+    return true;
+}
+
+void psu_guard_log_stop(void) {
+    if (!guard_armed || !guard_log) {
+        return;
+    }
+    if (guard_log_armed) {
+        psu_guard_stop();
+        return;
+    }
+    adc_busy_wait(true); // hands the last samples to the reducer
+    uint32_t irq = spin_lock_blocking(guard_lock);
+    guard_log = NULL;
+    psu_guard_timing(PSU_GUARD_PAIR_NS);
+    spin_unlock(guard_lock, irq);
+    adc_busy_wait(false);
+}
+
+bool psu_guard_logging(void) {
+    return guard_armed && guard_log;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file psu_guard.h
+ * @brief PSU fault watchdog, independent of the core1 main loop.
+ * @details While the PSU is on, the ADC free-runs in round robin on the AMUX
+ *          output (parked on VOUT) and the current sense input, DMA writes the
+ *          samples into a ring. A timer interrupt checks the new samples and
+ *          cuts the output within a bounded time (lib/psu_trip). The main loop
+ *          only reports the fault and finishes the shutdown.
+ *          AMUX reads share the sampling (psu_guard_amux_begin()) so the
+ *          current is still watched, other ADC users pause the guard
+ *          through adc_busy_wait().
+ *          psulog borrows the same sampling at the full ADC rate.
+ */
+
+#include "lib/psu_log/psu_log.h"
+
+/**
+ * @brief Start watching the PSU output.
+ * @param current_limit  Trip above this current sense ADC count, 0 to disable
+ * @param vout_limit     Trip at or below this VOUT ADC count, 0 to disable
+ * @return false if the DMA channels are not available
+ */
+bool psu_guard_start(uint16_t current_limit, uint16_t vout_limit);
+
+/**
+ * @brief Stop watching and release the ADC, DMA channels and timer.
+ */
+void psu_guard_stop(void);
+
+/**
+ * @brief Check if the guard is watching the output.
+ * @return true if started
+ */
+bool psu_guard_running(void);
+
+/**
+ * @brief Faults found by the guard since it was started.
+ * @return PSU_TRIP_* bits, 0 if none
+ */
+uint8_t psu_guard_tripped(void);
+
+/**
+ * @brief Stop sampling so the ADC and AMUX can be used, calls nest.
+ */
+void psu_guard_pause(void);
+
+/**
+ * @brief Park the AMUX on VOUT and sample again after the last resume.
+ */
+void psu_guard_resume(void);
+
+/**
+ * @brief Borrow the AMUX while the guard keeps sampling.
+ * @details Current sense is still checked, VOUT checks wait until
+ *          psu_guard_amux_end(). Call with the ADC lock held. Not while
+ *          psulog runs, the AMUX samples would end up in the log.
+ * @return false if the guard is not sampling, pause it and use the ADC instead
+ */
+bool psu_guard_amux_begin(void);
+
+/**
+ * @brief AMUX output converted after this call, waits up to three samples.
+ */
+uint16_t psu_guard_amux_sample(void);
+
+/**
+ * @brief Newest current sense sample.
+ */
+uint16_t psu_guard_current_sample(void);
+
+/**
+ * @brief Park the AMUX on VOUT and check VOUT again once it settles.
+ */
+void psu_guard_amux_end(void);
+
+/**
+ * @brief Sample at a higher rate and feed every VOUT/current pair to a reducer.
+ * @details Arms the guard without limits if they are overridden. The reducer
+ *          runs in the timer interrupt, pauses are passed to it as gaps.
+ * @param pair_ns  Time between samples of one channel, a multiple of 125ns,
+ *                 4000 for the full ADC rate
+ * @param reduce   psulog reducer, must stay valid until psu_guard_log_stop()
+ * @return false if the DMA channels are not available
+ */
+bool psu_guard_log_start(uint32_t pair_ns, psu_log_reduce_t* reduce);
+
+/**
+ * @brief Hand the last samples to the reducer and go back to the guard rate.
+ */
+void psu_guard_log_stop(void);
+
+/**
+ * @brief Check if samples still go to the reducer.
+ * @return false after psu_guard_log_stop() or when the PSU was turned off
+ */
+bool psu_guard_logging(void);
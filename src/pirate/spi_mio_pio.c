@@ -0,0 +1,157 @@
+/**
+ * @file spi_mio_pio.c
+ * @brief Multi-I/O SPI flash engine on PIO.
+ * @details The state machine is stopped between phases with SCK low. For
+ *          each phase the CPU turns the lines, loads the clock count into
+ *          x, jumps to the entry point and feeds or drains the FIFOs; a
+ *          slow CPU only stretches SCK. A line goes to input at the RP2040
+ *          before its buffer turns round, and to output the other way
+ *          round, so the two never drive each other.
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "pirate.h"
+#include "pio_config.h"
+#include "pirate/bio.h"
+#include "pirate/hwspi.h"
+#include "pirate/spi_mio_pio.h"
+#include "spi_mio.pio.h"
+
+#define SPI_MIO_LINES 0x0f
+
+static struct _pio_config pio_config;
+static uint8_t released; // IO0-IO3 now inputs
+
+// lines released while the flash drives this many, DO (IO1) always is
+static uint8_t spi_mio_pio_inputs(uint8_t lines) {
+    return lines == 1 ? 0x02 : lines == 2 ? 0x03 : SPI_MIO_LINES;
+}
+
+static void spi_mio_pio_lines(uint8_t inputs) {
+    PIO pio = pio_config.pio;
+    uint sm = pio_config.sm;
+    uint base = bio2bufiopin[BIO0];
+    uint8_t to_in = inputs & ~released;
+    uint8_t to_out = released & ~inputs;
+    if (to_in) {
+        pio_sm_set_pindirs_with_mask(pio, sm, 0, (uint32_t)to_in << base);
+        for (uint8_t i = 0; i < 4; i++) {
+            if (to_in & (1u << i)) {
+                bio_buf_input(BIO0 + i);
+            }
+        }
+    }
+    if (to_out) {
+        for (uint8_t i = 0; i < 4; i++) {
+            if (to_out & (1u << i)) {
+                bio_buf_output(BIO0 + i);
+            }
+        }
+        pio_sm_set_pindirs_with_mask(pio, sm, (uint32_t)to_out << base, (uint32_t)to_out << base);
+    }
+    released = inputs;
+}
+
+static void spi_mio_pio_start(uint entry, uint32_t clocks) {
+    PIO pio = pio_config.pio;
+    uint sm = pio_config.sm;
+    pio_sm_put(pio, sm, clocks - 1);
+    pio_sm_exec(pio, sm, pio_encode_pull(false, true));
+    pio_sm_exec(pio, sm, pio_encode_out(pio_x, 32));
+    pio_sm_exec(pio, sm, pio_encode_jmp(pio_config.offset + entry));
+    pio_sm_set_enabled(pio, sm, true);
+}
+
+// back at idle with SCK low
+static void spi_mio_pio_finish(void) {
+    PIO pio = pio_config.pio;
+    uint sm = pio_config.sm;
+    while (!pio_sm_is_tx_fifo_empty(pio, sm) || pio_sm_get_pc(pio, sm) != pio_config.offset + spi_mio_offset_idle) {
+        tight_loop_contents();
+    }
+    pio_sm_set_enabled(pio, sm, false);
+}
+
+static void spi_mio_pio_write(const uint32_t* words, uint32_t clocks) {
+    spi_mio_pio_start(spi_mio_offset_write, clocks);
+    for (uint32_t i = 0; i < (clocks + SPI_MIO_NIBBLES_PER_WORD - 1) / SPI_MIO_NIBBLES_PER_WORD; i++) {
+        pio_sm_put_blocking(pio_config.pio, pio_config.sm, words[i]);
+    }
+    spi_mio_pio_finish();
+}
+
+static void spi_mio_pio_read_phase(uint8_t lines, uint8_t dummy_clocks, uint8_t* buf, size_t len) {
+    uint32_t clocks = spi_mio_read_clocks(dummy_clocks, lines, len);
+    spi_mio_rx_t rx;
+    spi_mio_rx_init(&rx, lines, dummy_clocks, buf, len);
+    spi_mio_pio_start(spi_mio_offset_read, clocks);
+    for (uint32_t i = 0; i < clocks / SPI_MIO_NIBBLES_PER_WORD; i++) {
+        spi_mio_rx_word(&rx, pio_sm_get_blocking(pio_config.pio, pio_config.sm));
+    }
+    spi_mio_pio_finish();
+}
+
+uint32_t spi_mio_pio_init(uint32_t freq) {
+    pio_config.pio = PIO_MODE_PIO;
+    pio_config.sm = 0;
+    pio_config.program = &spi_mio_program;
+    if (!pio_can_add_program(pio_config.pio, pio_config.program)) {
+        return 0;
+    }
+    pio_config.offset = pio_add_program(pio_config.pio, pio_config.program);
+#ifdef BP_PIO_SHOW_ASSIGNMENT
+    printf("PIO: pio=%d, sm=%d, offset=%d\r\n", PIO_NUM(pio_config.pio), pio_config.sm, pio_config.offset);
+#endif
+    // IO0-IO3 start as inputs, the first transfer turns them
+    released = SPI_MIO_LINES;
+    for (uint8_t i = 0; i < 4; i++) {
+        bio_input(BIO0 + i);
+    }
+    spi_mio_program_init(
+        pio_config.pio, pio_config.sm, pio_config.offset, bio2bufiopin[BIO0], bio2bufiopin[M_SPI_CLK], freq);
+    return spi_mio_program_freq(freq);
+}
+
+void spi_mio_pio_cleanup(void) {
+    PIO pio = pio_config.pio;
+    uint base = bio2bufiopin[BIO0];
+    pio_sm_set_enabled(pio, pio_config.sm, false);
+    spi_mio_pio_lines(SPI_MIO_LINES);
+    pio->input_sync_bypass &= ~((uint32_t)SPI_MIO_LINES << base);
+    for (uint8_t i = 0; i < 4; i++) {
+        bio_set_function(BIO0 + i, GPIO_FUNC_SIO);
+    }
+    bio_set_function(M_SPI_CLK, GPIO_FUNC_SPI);
+    pio_remove_program(pio, pio_config.program, pio_config.offset);
+}
+
+void spi_mio_pio_transfer(const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len) {
+    spi_mio_pio_lines(spi_mio_pio_inputs(1));
+    hwspi_select();
+    if (tx_len) {
+        spi_mio_pio_start(spi_mio_offset_write, tx_len * SPI_MIO_NIBBLES_PER_WORD);
+        for (size_t i = 0; i < tx_len; i++) {
+            pio_sm_put_blocking(pio_config.pio, pio_config.sm, spi_mio_byte_word(tx[i]));
+        }
+        spi_mio_pio_finish();
+    }
+    if (rx_len) {
+        spi_mio_pio_read_phase(1, 0, rx, rx_len);
+    }
+    hwspi_deselect();
+}
+
+void spi_mio_pio_read(const spi_mio_plan_t* plan, uint32_t addr, uint8_t* buf, size_t len) {
+    uint32_t frame[SPI_MIO_FRAME_MAX_WORDS];
+    uint32_t clocks = spi_mio_frame(plan, addr, frame);
+    // the address lines drive, DO too once there are two of them
+    spi_mio_pio_lines(plan->addr_lines == 1 ? spi_mio_pio_inputs(1) : 0);
+    hwspi_select();
+    spi_mio_pio_write(frame, clocks);
+    // turn round before the dummy clocks, SCK is stopped low
+    spi_mio_pio_lines(spi_mio_pio_inputs(plan->data_lines));
+    spi_mio_pio_read_phase(plan->data_lines, plan->dummy_clocks, buf, len);
+    hwspi_deselect();
+}
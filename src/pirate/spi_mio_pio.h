@@ -0,0 +1,35 @@
+/**
+ * @file spi_mio_pio.h
+ * @brief Multi-I/O SPI flash engine on PIO.
+ * @details A state machine (spi_mio.pio) clocks IO0-IO3 a nibble at a
+ *          time, framed by lib/spi_mio. Plain transfers use IO0 as DI and
+ *          IO1 as DO; dual and quad reads turn the lines around between
+ *          the address and the dummy clocks. CS stays the SPI mode's CS.
+ *
+ *          Pins: IO0=DQ0/DI, IO1=DQ1/DO, IO2=DQ2/WP#, IO3=DQ3/HOLD#,
+ *          SCK=M_SPI_CLK (taken from the SPI peripheral), CS=M_SPI_CS.
+ */
+
+#include "lib/spi_mio/spi_mio.h"
+
+/**
+ * @brief Load the program and take over IO0-IO3 and SCK.
+ * @param freq  SCK in Hz
+ * @return the SCK the divider gives, 0 if there is no room for the program
+ */
+uint32_t spi_mio_pio_init(uint32_t freq);
+
+/**
+ * @brief Remove the program, IO0-IO3 to inputs, SCK back to the SPI peripheral.
+ */
+void spi_mio_pio_cleanup(void);
+
+/**
+ * @brief Single line transfer: write, then read, under one CS.
+ */
+void spi_mio_pio_transfer(const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len);
+
+/**
+ * @brief Flash read with a plan from spi_mio_plan().
+ */
+void spi_mio_pio_read(const spi_mio_plan_t* plan, uint32_t addr, uint8_t* buf, size_t len);
@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <assert.h>
+#include <string.h>
 #include "pico/stdlib.h"      // For tight_loop_contents()
 #include "hardware/sync.h"    // For __dmb()
 
@@ -129,6 +130,65 @@ static inline void spsc_queue_add_blocking(spsc_queue_t* q, uint8_t data) {
     }
 }
 
+/**
+ * @brief Add as many bytes as fit to the queue (non-blocking)
+ *
+ * @param q     Pointer to queue
+ * @param data  Bytes to add
+ * @param len   Number of bytes
+ * @return Number of bytes added, 0 if queue is full
+ *
+ * @pre Must be called from producer core only
+ * @note Copies up to two segments around the wrap and publishes the new
+ *       head once, instead of one barrier and head update per byte
+ */
+static inline uint32_t spsc_queue_try_write(spsc_queue_t* q, const uint8_t* data, uint32_t len) {
+    uint32_t head = q->head;
+
+    // Stale tail is safe: may report less free space, caller retries
+    uint32_t space = (q->tail - head - 1) & q->mask;
+    if (len > space) {
+        len = space;
+    }
+
+    // First segment up to the end of the buffer, then wrap
+    uint32_t first = q->capacity - head;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&q->buffer[head], data, first);
+    memcpy(q->buffer, &data[first], len - first);
+
+    // Release barrier: ensure data writes are visible before head update
+    __dmb();
+
+    q->head = (head + len) & q->mask;
+
+    return len;
+}
+
+/**
+ * @brief Add bytes to the queue (blocking)
+ *
+ * @param q     Pointer to queue
+ * @param data  Bytes to add
+ * @param len   Number of bytes
+ *
+ * @pre Must be called from producer core only
+ * @warning This will spin-wait while queue is full
+ */
+static inline void spsc_queue_write_blocking(spsc_queue_t* q, const uint8_t* data, uint32_t len) {
+    while (len) {
+        uint32_t n = spsc_queue_try_write(q, data, len);
+        if (!n) {
+            tight_loop_contents();
+            continue;
+        }
+        data += n;
+        len -= n;
+    }
+}
+
 /**
  * @brief Try to remove a byte from the queue (non-blocking)
  * 
@@ -0,0 +1,126 @@
+/**
+ * @file syntax_journal.c
+ * @brief Binary journal of executed syntax.
+ * @details The ring is static: the journal stays on across commands, so it
+ *          cannot hold the big buffer the way psulog does. A run adds
+ *          its RUN marker to up to SYNTAX_JOURNAL_CHUNK-1 records the last
+ *          flush left behind, reads and writes add a record per repeat, so
+ *          a long run can still fill it. Records that don't fit are dropped,
+ *          flagged on the next record and reported after the run.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pirate.h"
+#include "system_config.h"
+#include "modes.h"
+#include "fatfs/ff.h"
+#include "pirate/file.h"
+#include "syntax_journal.h"
+
+#define SYNTAX_JOURNAL_RECORDS 1024
+// 4096 bytes, whole NAND sectors straight from the ring
+#define SYNTAX_JOURNAL_CHUNK 256
+
+bool syntax_journal_enabled = false;
+bus_journal_t syntax_journal;
+
+static bus_journal_record_t ring[SYNTAX_JOURNAL_RECORDS];
+static FIL file;
+static char filename[13];
+static bool write_error;
+static uint32_t reported_lost;
+
+static uint32_t syntax_journal_write(void* ctx, const uint8_t* data, uint32_t len) {
+    UINT bw;
+    if (f_write((FIL*)ctx, data, len, &bw) != FR_OK || bw != len) {
+        write_error = true;
+        return 0;
+    }
+    return len;
+}
+
+static bus_journal_proto_t syntax_journal_proto(void) {
+    switch (system_config.mode) {
+#ifdef BP_USE_HWI2C
+        case HWI2C:
+            return BUS_JOURNAL_PROTO_I2C;
+#endif
+#ifdef BP_USE_HWSPI
+        case HWSPI:
+            return BUS_JOURNAL_PROTO_SPI;
+#endif
+#ifdef BP_USE_HWUART
+        case HWUART:
+            return BUS_JOURNAL_PROTO_UART;
+#endif
+#ifdef BP_USE_HWHDUART
+        case HWHDUART:
+            return BUS_JOURNAL_PROTO_UART;
+#endif
+        default:
+            return BUS_JOURNAL_PROTO_OTHER;
+    }
+}
+
+void syntax_journal_run(void) {
+    if (syntax_journal_enabled) {
+        bus_journal_run(&syntax_journal, time_us_64(), system_config.mode, syntax_journal_proto());
+    }
+}
+
+void syntax_journal_flush(void) {
+    if (!syntax_journal_enabled) {
+        return;
+    }
+    if (syntax_journal.lost != reported_lost) {
+        printf("Warning: journal full, %lu records lost\r\n", (unsigned long)(syntax_journal.lost - reported_lost));
+        reported_lost = syntax_journal.lost;
+    }
+    if (bus_journal_level(&syntax_journal) < SYNTAX_JOURNAL_CHUNK) {
+        return;
+    }
+    bus_journal_drain(&syntax_journal, SYNTAX_JOURNAL_CHUNK, syntax_journal_write, &file);
+    if (write_error) {
+        printf("Error: journal write to %s failed, journal stopped\r\n", filename);
+        syntax_journal_enabled = false;
+        file_close(&file);
+        return;
+    }
+    f_sync(&file);
+}
+
+bool syntax_journal_start(const char* name) {
+    if (file_open(&file, name, FA_CREATE_ALWAYS | FA_WRITE)) {
+        return false;
+    }
+    strncpy(filename, name, sizeof(filename) - 1);
+    filename[sizeof(filename) - 1] = 0;
+    write_error = false;
+    reported_lost = 0;
+    bus_journal_init(&syntax_journal, ring, SYNTAX_JOURNAL_RECORDS, true);
+    syntax_journal_enabled = true;
+    return true;
+}
+
+void syntax_journal_stop(void) {
+    if (!syntax_journal_enabled) {
+        return;
+    }
+    syntax_journal_enabled = false;
+    bus_journal_drain(&syntax_journal, 1, syntax_journal_write, &file);
+    if (!write_error) {
+        bus_journal_header_t header;
+        bus_journal_header(&syntax_journal, &header);
+        f_lseek(&file, 0);
+        if (file_write(&file, (uint8_t*)&header, sizeof(header))) {
+            return; // closed on error
+        }
+    }
+    file_close(&file);
+}
+
+const char* syntax_journal_filename(void) {
+    return filename;
+}
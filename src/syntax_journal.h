@@ -0,0 +1,54 @@
+/**
+ * @file syntax_journal.h
+ * @brief Binary journal of executed syntax.
+ * @details While the journal is on every bytecode syntax_run() executes is
+ *          appended to a RAM ring as a 16 byte record (lib/bus_journal).
+ *          The ring goes to the journal file in 4096 byte writes between
+ *          runs, never during one, so the bus timing is left alone.
+ */
+
+#ifndef SYNTAX_JOURNAL_H
+#define SYNTAX_JOURNAL_H
+
+#include "pico/stdlib.h"
+#include "lib/bus_journal/bus_journal.h"
+
+extern bool syntax_journal_enabled;
+extern bus_journal_t syntax_journal;
+
+/**
+ * @brief Record an executed bytecode, called by syntax_run().
+ */
+static inline void syntax_journal_add(const struct _bytecode* b) {
+    if (syntax_journal_enabled) {
+        bus_journal_add(&syntax_journal, b, time_us_32());
+    }
+}
+
+/**
+ * @brief Mark the start of a run with the time and the mode.
+ */
+void syntax_journal_run(void);
+
+/**
+ * @brief Write whole chunks of the ring to the file, after a run.
+ */
+void syntax_journal_flush(void);
+
+/**
+ * @brief Open the journal file and start recording.
+ * @return true on success
+ */
+bool syntax_journal_start(const char* filename);
+
+/**
+ * @brief Write out the rest, fix up the header and close the file.
+ */
+void syntax_journal_stop(void);
+
+/**
+ * @brief Name of the open journal file.
+ */
+const char* syntax_journal_filename(void);
+
+#endif // SYNTAX_JOURNAL_H
@@ -6,6 +6,7 @@
  */
 
 #include <stdio.h>
+#include <stdarg.h>
 #include "pico/stdlib.h"
 #include <stdint.h>
 #include "pirate.h"
@@ -14,24 +15,35 @@
 #include "ui/ui_const.h"
 #include "ui/ui_term.h"
 #include "ui/ui_format.h"
+#include "usb_tx.h"
+#include "lib/line_fmt/line_fmt.h"
 #include "syntax.h"
 #include "syntax_internal.h"
 
 /*
  * =============================================================================
- * Number formatting helpers (refactored to use ui_format)
+ * Output buffer
  * =============================================================================
  */
 
+// results are rendered into this buffer and sent to the tx fifo in bulk
+static line_fmt_t post_line;
+static line_fmt_colors_t post_colors;
+
+// longest single post_printf() result, longer output is truncated
+#define POST_PRINTF_MAX 128
+
 /**
- * @brief Print ASCII representation if printable.
- * @param value  Character value to check
+ * @brief printf into the output buffer.
  */
-static inline void print_ascii_if_printable(uint32_t value) {
-    if ((char)value >= ' ' && (char)value <= '~') {
-        printf("'%c' ", (char)value);
-    } else {
-        printf("''  ");
+static void post_printf(const char *fmt, ...) {
+    char *p = line_fmt_reserve(&post_line, POST_PRINTF_MAX);
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(p, POST_PRINTF_MAX, fmt, args);
+    va_end(args);
+    if (len > 0) {
+        post_line.len += (len < POST_PRINTF_MAX) ? len : POST_PRINTF_MAX - 1;
     }
 }
 
@@ -41,8 +53,8 @@ static inline void print_ascii_if_printable(uint32_t value) {
  * @param value  Value to print
  * @param read   true if this is a read operation
  * 
- * @details Uses ui_format_print_number_3() for consistent formatting.
- *          Handles display format selection based on context.
+ * @details Same formatting as ui_format_print_number_3(), rendered into
+ *          the output buffer. Handles display format selection based on context.
  */
 static void postprocess_format_print_number(struct _bytecode *in, uint32_t *value, bool read) {
     uint32_t d = *value;
@@ -64,11 +76,11 @@ static void postprocess_format_print_number(struct _bytecode *in, uint32_t *valu
 
     // Print ASCII prefix if in ASCII mode
     if (display_format == df_ascii) {
-        print_ascii_if_printable(d);
+        line_fmt_ascii(&post_line, d);
     }
 
     // Use unified number formatter (handles hex/dec/bin with color)
-    ui_format_print_number_3(d, num_bits, 
+    line_fmt_number(&post_line, &post_colors, d, num_bits,
         (display_format == df_ascii || display_format == df_auto) ? df_hex : display_format);
 }
 
@@ -102,7 +114,7 @@ void postprocess_mode_write(struct _bytecode *in, struct _output_info *info) {
         value = in->out_data;
         repeat = 1;
         if (new_line) {
-            printf("\r\n%sTX:%s ", ui_term_color_info(), ui_term_color_reset());
+            post_printf("\r\n%sTX:%s ", ui_term_color_info(), ui_term_color_reset());
         }
     }
 
@@ -110,7 +122,7 @@ void postprocess_mode_write(struct _bytecode *in, struct _output_info *info) {
         repeat = 1;
         value = in->in_data;
         if (new_line) {
-            printf("\r\n%sRX:%s ", ui_term_color_info(), ui_term_color_reset());
+            post_printf("\r\n%sRX:%s ", ui_term_color_info(), ui_term_color_reset());
         }
     }
 
@@ -118,20 +130,22 @@ void postprocess_mode_write(struct _bytecode *in, struct _output_info *info) {
         postprocess_format_print_number(in, &value, (in->command == SYN_READ));
         
         if (in->read_with_write) {
-            printf("(");
+            line_fmt_putc(&post_line, '(');
             postprocess_format_print_number(in, &in->in_data, false);
-            printf(")");
+            line_fmt_putc(&post_line, ')');
         }
 
         info->row_counter--;
         if (in->data_message) {
-            printf(" %s ", in->data_message);
+            line_fmt_putc(&post_line, ' ');
+            line_fmt_puts(&post_line, in->data_message);
+            line_fmt_putc(&post_line, ' ');
         } else {
-            printf(" ");
+            line_fmt_putc(&post_line, ' ');
         }
 
         if (!info->row_counter) {
-            printf("\r\n    ");
+            line_fmt_put(&post_line, "\r\n    ", 6);
             info->row_counter = row_length;
         }
     }
@@ -152,7 +166,7 @@ static void syntax_post_read(struct _bytecode *in, struct _output_info *info) {
 }
 
 static void syntax_post_delay_us_ms(struct _bytecode *in, struct _output_info *info) {
-    printf("\r\n%s%s:%s %s%d%s%s",
+    post_printf("\r\n%s%s:%s %s%d%s%s",
            ui_term_color_notice(),
            GET_T(T_MODE_DELAY),
            ui_term_color_reset(),
@@ -164,12 +178,13 @@ static void syntax_post_delay_us_ms(struct _bytecode *in, struct _output_info *i
 
 static void syntax_post_start_stop(struct _bytecode *in, struct _output_info *info) {
     if (in->data_message) {
-        printf("\r\n%s", in->data_message);
+        line_fmt_put(&post_line, "\r\n", 2);
+        line_fmt_puts(&post_line, in->data_message);
     }
 }
 
 static inline void _syntax_post_aux_output(uint8_t bio, bool direction) {
-    printf("\r\nIO%s%d%s set to%s OUTPUT: %s%d%s",
+    post_printf("\r\nIO%s%d%s set to%s OUTPUT: %s%d%s",
            ui_term_color_num_float(),
            bio,
            ui_term_color_notice(),
@@ -188,7 +203,7 @@ static void syntax_post_aux_output_low(struct _bytecode *in, struct _output_info
 }
 
 static void syntax_post_aux_input(struct _bytecode *in, struct _output_info *info) {
-    printf("\r\nIO%s%d%s set to%s INPUT: %s%d%s",
+    post_printf("\r\nIO%s%d%s set to%s INPUT: %s%d%s",
            ui_term_color_num_float(),
            in->bits,
            ui_term_color_notice(),
@@ -200,7 +215,7 @@ static void syntax_post_aux_input(struct _bytecode *in, struct _output_info *inf
 
 static void syntax_post_adc(struct _bytecode *in, struct _output_info *info) {
     uint32_t mv = (6600 * in->in_data) / 4096;
-    printf("\r\n%s%s IO%d:%s %s%d.%d%sV",
+    post_printf("\r\n%s%s IO%d:%s %s%d.%d%sV",
            ui_term_color_info(),
            GET_T(T_MODE_ADC_VOLTAGE),
            in->bits,
@@ -212,7 +227,7 @@ static void syntax_post_adc(struct _bytecode *in, struct _output_info *info) {
 }
 
 static void syntax_post_tick_clock(struct _bytecode *in, struct _output_info *info) {
-    printf("\r\n%s%s:%s %s%d%s",
+    post_printf("\r\n%s%s:%s %s%d%s",
            ui_term_color_notice(),
            GET_T(T_MODE_TICK_CLOCK),
            ui_term_color_reset(),
@@ -222,7 +237,7 @@ static void syntax_post_tick_clock(struct _bytecode *in, struct _output_info *in
 }
 
 static void syntax_post_set_clk_high_low(struct _bytecode *in, struct _output_info *info) {
-    printf("\r\n%s%s:%s %s%d%s",
+    post_printf("\r\n%s%s:%s %s%d%s",
            ui_term_color_notice(),
            GET_T(T_MODE_SET_CLK),
            ui_term_color_reset(),
@@ -232,7 +247,7 @@ static void syntax_post_set_clk_high_low(struct _bytecode *in, struct _output_in
 }
 
 static void syntax_post_set_dat_high_low(struct _bytecode *in, struct _output_info *info) {
-    printf("\r\n%s%s:%s %s%d%s",
+    post_printf("\r\n%s%s:%s %s%d%s",
            ui_term_color_notice(),
            GET_T(T_MODE_SET_DAT),
            ui_term_color_reset(),
@@ -242,7 +257,7 @@ static void syntax_post_set_dat_high_low(struct _bytecode *in, struct _output_in
 }
 
 static void syntax_post_read_dat(struct _bytecode *in, struct _output_info *info) {
-    printf("\r\n%s%s:%s %s%d%s",
+    post_printf("\r\n%s%s:%s %s%d%s",
            ui_term_color_notice(),
            GET_T(T_MODE_READ_DAT),
            ui_term_color_reset(),
@@ -293,10 +308,12 @@ SYNTAX_STATUS syntax_post(void) {
 
     // Reset state for new output
     info.previous_command = 0xFF;
+    line_fmt_colors(&post_colors, ui_term_color_reset(), ui_term_color_grey(), ui_term_color_num_float(), ui_term_color_info());
+    line_fmt_init(&post_line, tx_fifo_write);
 
     for (uint32_t pos = 0; pos < syntax_io.in_cnt; pos++) {
         if (syntax_io.in[pos].command >= count_of(syntax_post_func)) {
-            printf("Unknown internal code %d\r\n", syntax_io.in[pos].command);
+            post_printf("Unknown internal code %d\r\n", syntax_io.in[pos].command);
             continue;
         }
 
@@ -304,11 +321,14 @@ SYNTAX_STATUS syntax_post(void) {
         info.previous_command = syntax_io.in[pos].command;
 
         if (syntax_io.in[pos].error) {
-            printf("(%s) ", syntax_io.in[pos].error_message);
+            line_fmt_putc(&post_line, '(');
+            line_fmt_puts(&post_line, syntax_io.in[pos].error_message);
+            line_fmt_put(&post_line, ") ", 2);
         }
     }
 
-    printf("\r\n");
+    line_fmt_put(&post_line, "\r\n", 2);
+    line_fmt_flush(&post_line);
     syntax_io.in_cnt = 0;
     return SSTATUS_OK;
 }
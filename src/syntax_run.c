@@ -16,6 +16,7 @@
 #include "ui/ui_const.h"
 #include "syntax.h"
 #include "syntax_internal.h"
+#include "syntax_journal.h"
 #include "pirate/bio.h"
 #include "pirate/amux.h"
 
@@ -47,6 +48,7 @@ static void syntax_run_write(struct _syntax_io *io, uint32_t pos) {
             io->in[io->in_cnt] = io->out[pos];
         }
         modes[system_config.mode].protocol_write(&io->in[io->in_cnt], NULL);
+        syntax_journal_add(&io->in[io->in_cnt]);
     }
 }
 
@@ -70,6 +72,7 @@ static void syntax_run_read(struct _syntax_io *io, uint32_t pos) {
             ((pos + 1 < io->out_cnt) && (j + 1 == io->out[pos].repeat))
                 ? &io->out[pos + 1]
                 : NULL);
+        syntax_journal_add(&io->in[io->in_cnt]);
     }
 }
 
@@ -190,6 +193,7 @@ SYNTAX_STATUS syntax_run(void) {
     }
 
     syntax_io.in_cnt = 0;
+    syntax_journal_run();
 
     for (uint32_t pos = 0; pos < syntax_io.out_cnt; pos++) {
         syntax_io.in[syntax_io.in_cnt] = syntax_io.out[pos];
@@ -201,6 +205,11 @@ SYNTAX_STATUS syntax_run(void) {
 
         syntax_run_func[syntax_io.out[pos].command](&syntax_io, pos);
 
+        // read and write journal each repeat as they go
+        if (syntax_io.out[pos].command != SYN_WRITE && syntax_io.out[pos].command != SYN_READ) {
+            syntax_journal_add(&syntax_io.in[syntax_io.in_cnt]);
+        }
+
         if (syntax_io.in_cnt + 1 >= SYN_MAX_LENGTH) {
             syntax_io.in[syntax_io.in_cnt].error_message = GET_T(T_SYNTAX_EXCEEDS_MAX_SLOTS);
             syntax_io.in[syntax_io.in_cnt].error = SERR_ERROR;
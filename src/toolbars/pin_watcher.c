@@ -1,6 +1,6 @@
 /**
  * @file pin_watcher.c
- * @brief 2-line GPIO pin state watcher toolbar — REFERENCE IMPLEMENTATION.
+ * @brief 4-line GPIO pin state and edge watcher toolbar — REFERENCE IMPLEMENTATION.
  *
  * ═══════════════════════════════════════════════════════════════════════════
  *  THIS FILE IS THE REFERENCE IMPLEMENTATION FOR NEW TOOLBARS.
@@ -9,9 +9,15 @@
  * ═══════════════════════════════════════════════════════════════════════════
  *
  * @details
- *  This toolbar displays two rows at the bottom of the VT100 terminal:
+ *  This toolbar displays four rows at the bottom of the VT100 terminal,
+ *  a 10 column cell per pin:
  *    Row 1: Colored pin labels  (IO0 .. IO7)
- *    Row 2: Live HIGH/LOW state with matching colors
+ *    Row 2: Live HIGH/LOW state with matching colors, edges per second
+ *    Row 3: Rising and falling edge counts since the last reset
+ *    Row 4: Shortest high and low pulse, red while a glitch is latched
+ *
+ *  Rows 2-4 come from the background edge capture (see Step 7), so pulses
+ *  far shorter than the ~100ms refresh are still counted.
  *
  *  ## Architecture Overview
  *
@@ -60,6 +66,8 @@
 #include "pirate.h"                // Global defines, BIO_MAX_PINS, hw_pin_label_ordered, colors
 #include "system_config.h"         // system_config struct (terminal size, etc.)
 #include "pirate/bio.h"            // bio_get() — read GPIO pin state
+#include "pirate/freq_pio.h"   // background PIO edge capture into a DMA ring
+#include "lib/edge_stats/edge_stats.h" // running per-pin edge statistics
 #include "ui/ui_term.h"            // VT100 helpers: cursor_position_buf, color_buf, color_reset
 #include "ui/ui_toolbar.h"         // Toolbar API: toolbar_t, toolbar_activate, toolbar_teardown, etc.
 #include "ui/ui_flags.h"           // UI_UPDATE_* flags for selective rendering
@@ -74,7 +82,7 @@
  * The height is set once in the toolbar_t struct and must not change while
  * the toolbar is registered.
  */
-#define PIN_WATCHER_HEIGHT 2
+#define PIN_WATCHER_HEIGHT 4
 
 /* ── Forward Declarations ────────────────────────────────────────────────────
  *
@@ -90,6 +98,7 @@
 static uint32_t pin_watcher_update_core1_cb(toolbar_t* tb, char* buf, size_t buf_len,
                                             uint16_t start_row, uint16_t width,
                                             uint32_t update_flags);
+static void pin_watcher_edges_init(void);
 
 /* ── Step 3: The .draw Callback ──────────────────────────────────────────────
  *
@@ -135,7 +144,7 @@ static uint32_t pin_watcher_update_core1_cb(toolbar_t* tb, char* buf, size_t buf
  *   .draw          — Core0 full-paint callback (see Step 3 above).
  *                    For Core1-rendered toolbars: NULL (auto-delegated).
  *                    For Core0-only toolbars: a function that paints using printf.
- *   .update_core1  — Core1 periodic rendering callback (see Step 7 below).
+ *   .update_core1  — Core1 periodic rendering callback (see Step 8 below).
  *                    Must use only _buf() variants and snprintf — no printf.
  *                    NULL for Core0-only toolbars.
  *   .destroy       — Called on unregister.  Free resources, stop timers, etc.
@@ -193,6 +202,8 @@ bool pin_watcher_start(void) {
     if (pin_watcher_toolbar.enabled) {
         return true; /* already active */
     }
+    /* Set up the edge capture before Core1 can render the first frame */
+    pin_watcher_edges_init();
     return toolbar_activate(&pin_watcher_toolbar);
 }
 
@@ -201,6 +212,10 @@ void pin_watcher_stop(void) {
         return;
     }
     toolbar_teardown(&pin_watcher_toolbar);
+    /* The f/F commands may still be using the counter */
+    if (system_config.freq_active == 0) {
+        freq_pio_stop();
+    }
 }
 
 bool pin_watcher_is_active(void) {
@@ -227,7 +242,113 @@ void pin_watcher_update(void) {
     toolbar_update_blocking();
 }
 
-/* ── Step 7: Core1 Rendering Callback ────────────────────────────────────────
+/* ── Step 7: Background Edge Capture ─────────────────────────────────────────
+ *
+ * Sampling bio_get() every ~100ms misses anything shorter than the refresh.
+ * Instead the toolbar follows the freq_pio capture: a PIO state machine
+ * records every change on IO0-IO7 (sysclk/10 sample ticks) and DMA writes
+ * the records into a ring with no CPU time spent.  Each Core1 tick hands
+ * the records written since the last tick to lib/edge_stats, which keeps
+ * the per-pin counts, shortest pulses and glitch latches.
+ *
+ * The statistics belong to Core1.  Core0 only asks for a reset, Core1
+ * clears them on its next tick.  The ring holds ~1800 unread records, more
+ * changes than that per tick (a single 10kHz clock is enough) lose records:
+ * the counts row then says in plain text that they are not exact until the
+ * next reset, and rates from that second show "?".
+ */
+
+/* One sample long pulses are at the limit of what the sampler can see */
+#define PIN_WATCHER_GLITCH_TICKS 2
+#define PIN_WATCHER_RATE_US 1000000
+/* Columns per pin: " HIGH 3.4k" */
+#define PIN_WATCHER_CELL 10
+/* Worst case bytes for a 24-bit color sequence, and for the cursor move and
+ * reset around a row, leaving room for the caller's cursor restore */
+#define PIN_WATCHER_COLOR_BYTES 36
+#define PIN_WATCHER_ROW_BYTES 24
+
+static edge_stats_t pin_edges;                   // Core1 owned once started
+static uint32_t pin_edges_pos;                   // freq_pio_follow() reader position
+static bool pin_edges_running;                   // counter was available at start
+static volatile bool pin_edges_reset_request;    // set by Core0, cleared by Core1
+static uint32_t pin_rate[BIO_MAX_PINS];          // edges per second
+static uint32_t pin_rate_edges[BIO_MAX_PINS];    // edge counts at the last rate update
+static uint64_t pin_rate_us;
+static bool pin_rate_lost;                       // records lost since the last rate update
+static bool pin_rate_valid;                      // pin_rate[] came from a second without loss
+static bool pin_stats_pending;                   // rows 3 and 4 need a repaint
+
+static void pin_watcher_edges_init(void) {
+    /* A counter started here pushes the initial pin state as its first record */
+    bool shared = freq_pio_is_running();
+    pin_edges_running = freq_pio_start();
+    if (!pin_edges_running) {
+        printf("Edge counters unavailable, PIO or DMA in use (logic analyzer?)\r\n");
+    }
+    edge_stats_init(&pin_edges, PIN_WATCHER_GLITCH_TICKS);
+    pin_edges_pos = shared ? freq_pio_position() : 0;
+    pin_edges_reset_request = false;
+    for (uint8_t i = 0; i < BIO_MAX_PINS; i++) {
+        pin_rate[i] = 0;
+        pin_rate_edges[i] = 0;
+    }
+    pin_rate_us = time_us_64();
+    pin_rate_lost = false;
+    pin_rate_valid = true;
+}
+
+void pin_watcher_reset(void) {
+    pin_edges_reset_request = true;
+}
+
+/* Core1: reduce the new records, true if the stats rows need a repaint */
+static bool pin_watcher_edges_update(void) {
+    if (!pin_edges_running) {
+        return false;
+    }
+    bool changed = false;
+    if (pin_edges_reset_request) {
+        edge_stats_reset(&pin_edges);
+        for (uint8_t i = 0; i < BIO_MAX_PINS; i++) {
+            pin_rate[i] = 0;
+            pin_rate_edges[i] = 0;
+        }
+        pin_rate_us = time_us_64();
+        pin_rate_lost = false;
+        pin_rate_valid = true;
+        pin_edges_reset_request = false;
+        changed = true;
+    }
+
+    const uint32_t* ring;
+    uint32_t ring_len, first;
+    bool lost;
+    uint32_t count = freq_pio_follow(&pin_edges_pos, &ring, &ring_len, &first, &lost);
+    if (lost) {
+        edge_stats_lost(&pin_edges);
+        pin_rate_lost = true;
+    }
+    edge_stats_feed(&pin_edges, ring, ring_len, first, count);
+    changed |= (count != 0);
+
+    uint64_t now = time_us_64();
+    uint64_t elapsed = now - pin_rate_us;
+    if (elapsed >= PIN_WATCHER_RATE_US) {
+        for (uint8_t i = 0; i < BIO_MAX_PINS; i++) {
+            uint32_t edges = edge_stats_edges(&pin_edges.pin[i]);
+            pin_rate[i] = (uint32_t)((uint64_t)(edges - pin_rate_edges[i]) * 1000000 / elapsed);
+            pin_rate_edges[i] = edges;
+        }
+        pin_rate_valid = !pin_rate_lost;
+        pin_rate_lost = false;
+        pin_rate_us = now;
+        changed = true;
+    }
+    return changed;
+}
+
+/* ── Step 8: Core1 Rendering Callback ────────────────────────────────────────
  *
  * This is the heart of a periodic toolbar.  It is called from the Core1
  * state machine (toolbar_core1_service) with a pre-allocated buffer and
@@ -287,17 +408,33 @@ static uint32_t pin_watcher_update_core1_cb(toolbar_t* tb, char* buf, size_t buf
      * - UI_UPDATE_LABELS   — pin names/configuration changed (need full repaint)
      * - UI_UPDATE_FORCE    — explicit full repaint request (e.g. toolbar_update_blocking)
      *
-     * If none of these flags are set, return 0 to skip this cycle entirely.
+     * If none of these flags are set and there are no new edge statistics
+     * (below), return 0 to skip this cycle entirely.
      * The state machine will move on to the next toolbar without sending
      * anything over USB — zero overhead for unchanged toolbars.
      */
     const uint32_t care_mask = UI_UPDATE_VOLTAGES | UI_UPDATE_LABELS | UI_UPDATE_FORCE;
-    if (!(update_flags & care_mask)) {
+
+    /*
+     * Drain the edge capture on every tick, even when nothing is rendered,
+     * so the ring never fills up between repaints.  New edges or a new
+     * rate also trigger a repaint.
+     */
+    if (pin_watcher_edges_update()) {
+        pin_stats_pending = true;
+    }
+    if (!(update_flags & care_mask) && !pin_stats_pending) {
         return 0;
     }
 
     /* Determine if this is a full paint (labels + states) or just states */
     bool full_paint = (update_flags & (UI_UPDATE_LABELS | UI_UPDATE_FORCE)) != 0;
+    if (full_paint) {
+        pin_stats_pending = true;
+    }
+
+    /* Only whole cells, a narrow terminal would wrap the row */
+    uint8_t pins = MIN(BIO_MAX_PINS, width / PIN_WATCHER_CELL);
 
     /*
      * Row 1: pin labels (only on full paint — labels are static)
@@ -309,11 +446,11 @@ static uint32_t pin_watcher_update_core1_cb(toolbar_t* tb, char* buf, size_t buf
     if (full_paint) {
         len += ui_term_cursor_position_buf(&buf[len], buf_len - len, start_row, 0);
         uint32_t cols = 0;
-        for (uint8_t i = 0; i < BIO_MAX_PINS; i++) {
+        for (uint8_t i = 0; i < pins; i++) {
             len += ui_term_color_text_background_buf(&buf[len], buf_len - len,
                         hw_pin_label_ordered_color[i + 1][0],
                         hw_pin_label_ordered_color[i + 1][1]);
-            int n = snprintf(&buf[len], buf_len - len, " %-4s",
+            int n = snprintf(&buf[len], buf_len - len, " %-9s",
                              hw_pin_label_ordered[i + 1]);
             len += n; cols += n;
         }
@@ -325,9 +462,9 @@ static uint32_t pin_watcher_update_core1_cb(toolbar_t* tb, char* buf, size_t buf
     }
 
     /*
-     * Row 2: live pin states
+     * Row 2: live pin states and edge rates
      *
-     * Always rendered when we pass the care_mask gate above.
+     * Always rendered when we pass the gate above.
      * Each pin gets a HIGH (red background) or LOW (black background) indicator.
      * Column padding at the end overwrites any stale content — this is the
      * key technique that avoids erase_line flicker.
@@ -335,12 +472,19 @@ static uint32_t pin_watcher_update_core1_cb(toolbar_t* tb, char* buf, size_t buf
     len += ui_term_cursor_position_buf(&buf[len], buf_len - len, start_row + 1, 0);
 
     uint32_t cols = 0;
-    for (uint8_t i = 0; i < BIO_MAX_PINS; i++) {
+    char a[8], b[8];
+    for (uint8_t i = 0; i < pins; i++) {
         bool high = bio_get(i);
         uint32_t fg = BP_COLOR_WHITE;
         uint32_t bg = high ? BP_COLOR_RED : BP_COLOR_FULLBLACK;
         len += ui_term_color_text_background_buf(&buf[len], buf_len - len, fg, bg);
-        int n = snprintf(&buf[len], buf_len - len, " %-4s", high ? "HIGH" : "LOW");
+        a[0] = '\0';
+        if (pin_edges_running && pin_rate_valid) {
+            edge_stats_fmt_count(a, sizeof(a), pin_rate[i]);
+        } else if (pin_edges_running) {
+            snprintf(a, sizeof(a), "?");
+        }
+        int n = snprintf(&buf[len], buf_len - len, " %-4s %4s", high ? "HIGH" : "LOW", a);
         len += n; cols += n;
     }
 
@@ -351,6 +495,76 @@ static uint32_t pin_watcher_update_core1_cb(toolbar_t* tb, char* buf, size_t buf
         if (len < buf_len - 1) buf[len++] = ' ';
     }
 
+    /*
+     * Rows 3 and 4: edge counts and shortest pulses
+     *
+     * The buffer is shared by all four rows and a full paint with per-cell
+     * colors does not leave room for these two.  A row is only rendered
+     * when its worst case fits, otherwise it stays pending for the next
+     * tick (~100ms later).
+     */
+    uint32_t pad = width - pins * PIN_WATCHER_CELL;
+    uint32_t need = 2 * PIN_WATCHER_ROW_BYTES + (pins + 2) * PIN_WATCHER_COLOR_BYTES + 2 * (pins * PIN_WATCHER_CELL + pad);
+    if (pin_stats_pending && len + need < buf_len) {
+        len += ui_term_cursor_position_buf(&buf[len], buf_len - len, start_row + 2, 0);
+        len += ui_term_color_text_background_buf(&buf[len], buf_len - len,
+                    pin_edges.lost ? BP_COLOR_YELLOW : BP_COLOR_WHITE, BP_COLOR_FULLBLACK);
+        cols = 0;
+        if (pin_edges.lost) {
+            /* Records were lost since the last reset, the counts are only a lower bound */
+            int n = snprintf(&buf[len], buf_len - len, " %.*s", (int)(width - 1),
+                             "Edge counts not exact: too many edges between refreshes (toolbar pinreset)");
+            len += n; cols += n;
+        }
+        for (uint8_t i = 0; i < pins && !pin_edges.lost; i++) {
+            a[0] = b[0] = '\0';
+            if (pin_edges_running) {
+                edge_stats_fmt_count(a, sizeof(a), pin_edges.pin[i].rising);
+                edge_stats_fmt_count(b, sizeof(b), pin_edges.pin[i].falling);
+            }
+            int n = snprintf(&buf[len], buf_len - len, " %4s %4s", a, b);
+            len += n; cols += n;
+        }
+        for (uint16_t c = cols; c < width; c++) {
+            if (len < buf_len - 1) buf[len++] = ' ';
+        }
+
+        /* Red background: a glitch was seen on the pin since the last reset */
+        len += ui_term_cursor_position_buf(&buf[len], buf_len - len, start_row + 3, 0);
+        cols = 0;
+        int8_t color = -1;
+        for (uint8_t i = 0; i < pins; i++) {
+            const edge_stats_pin_t* p = &pin_edges.pin[i];
+            if (color != p->glitch) {
+                color = p->glitch;
+                len += ui_term_color_text_background_buf(&buf[len], buf_len - len,
+                            BP_COLOR_WHITE, p->glitch ? BP_COLOR_RED : BP_COLOR_FULLBLACK);
+            }
+            a[0] = b[0] = '\0';
+            if (pin_edges_running) {
+                uint32_t hz = freq_pio_tick_hz();
+                if (p->min_high == UINT32_MAX) {
+                    snprintf(a, sizeof(a), "-");
+                } else {
+                    edge_stats_fmt_ticks(a, sizeof(a), p->min_high, hz);
+                }
+                if (p->min_low == UINT32_MAX) {
+                    snprintf(b, sizeof(b), "-");
+                } else {
+                    edge_stats_fmt_ticks(b, sizeof(b), p->min_low, hz);
+                }
+            }
+            int n = snprintf(&buf[len], buf_len - len, " %4s %4s", a, b);
+            len += n; cols += n;
+        }
+        len += ui_term_color_text_background_buf(&buf[len], buf_len - len,
+                                                 BP_COLOR_WHITE, BP_COLOR_FULLBLACK);
+        for (uint16_t c = cols; c < width; c++) {
+            if (len < buf_len - 1) buf[len++] = ' ';
+        }
+        pin_stats_pending = false;
+    }
+
     /* Always reset colors at the end so the terminal returns to normal */
     len += snprintf(&buf[len], buf_len - len, "%s", ui_term_color_reset());
 
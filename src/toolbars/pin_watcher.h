@@ -1,7 +1,9 @@
 /**
  * @file pin_watcher.h
- * @brief 2-line GPIO pin state watcher toolbar.
- * @details Shows pin names and live HIGH/LOW states with per-pin colors.
+ * @brief 4-line GPIO pin state and edge watcher toolbar.
+ * @details Shows pin names and live HIGH/LOW states with per-pin colors, and
+ *          edge rates, edge counts and shortest pulses from the background
+ *          edge capture.
  */
 #pragma once
 
@@ -29,3 +31,7 @@ bool pin_watcher_is_active(void);
  */
 void pin_watcher_update(void);
 
+/**
+ * @brief Clear the edge counts, shortest pulses and glitch latches.
+ */
+void pin_watcher_reset(void);
@@ -132,6 +132,7 @@ enum T_translations{
     T_UART_INVERT_MENU,
     T_UART_INVERT_MENU_1,
     T_UART_INVERT_MENU_2,
+    T_UART_TIMESTAMP_MENU,
     T_UART_INVERT_PROMPT,
     T_UART_GLITCH_TRG_MENU,
     T_UART_GLITCH_TRG_MENU_1,
@@ -198,6 +199,8 @@ enum T_translations{
     T_HW2WIRE_RST_LOW,
     T_HW2WIRE_RST_HIGH,
     T_HW2WIRE_SNIFF,
+    T_HW2WIRE_SNIFF_FILE,
+    T_HW2WIRE_SNIFF_IDLE,
     T_HW3WIRE_SPEED_MENU_1,
     T_HWLED_DEVICE_MENU,
     T_HWLED_DEVICE_MENU_1,
@@ -210,6 +213,17 @@ enum T_translations{
     T_HWLED_RESET,
     T_HWLED_FRAME_START,
     T_HWLED_FRAME_STOP,
+    T_HWLED_CMD_LEDS,
+    T_HELP_HWLED_LEDS_SHOW,
+    T_HELP_HWLED_LEDS_PLAY,
+    T_HELP_HWLED_LEDS_BENCH,
+    T_HELP_HWLED_LEDS_FILE_FLAG,
+    T_HELP_HWLED_LEDS_PIXELS_FLAG,
+    T_HELP_HWLED_LEDS_RGBW_FLAG,
+    T_HELP_HWLED_LEDS_GAMMA_FLAG,
+    T_HELP_HWLED_LEDS_BRIGHTNESS_FLAG,
+    T_HELP_HWLED_LEDS_RATE_FLAG,
+    T_HELP_HWLED_LEDS_LOOP_FLAG,
     T_HW1WIRE_RESET,
     T_HW1WIRE_PRESENCE_DETECT,
     T_HW1WIRE_NO_DEVICE,
@@ -240,6 +254,16 @@ enum T_translations{
     T_JTAG_BLUETAG_VERSION,
     T_JTAG_BLUETAG_DISABLE,
     T_JTAG_BLUETAG_DESCRIPTION,
+    T_JTAG_SVF_DESCRIPTION,
+    T_JTAG_SVF_FILE,
+    T_JTAG_SVF_FREQ,
+    T_DIO_PATTERN_DESCRIPTION,
+    T_DIO_PATTERN_FILE,
+    T_DIO_PATTERN_RATE,
+    T_DIO_PATTERN_REPEAT,
+    T_DIO_PATTERN_LOOP,
+    T_DIO_PATTERN_TRIGGER,
+    T_DIO_PATTERN_FALLING,
     T_I2S_SPEED_MENU,
     T_I2S_SPEED_MENU_1,
     T_I2S_SPEED_PROMPT,
@@ -274,6 +298,8 @@ enum T_translations{
     T_CMDLN_PULLUPS_EN,
     T_CMDLN_PULLUPS_DIS,
     T_CMDLN_PSU_DIS,
+    T_CMDLN_PSULOG,
+    T_CMDLN_JOURNAL,
     T_CMDLN_ADC_CONT,
     T_CMDLN_ADC_ONE,
     T_CMDLN_SELFTEST,
@@ -367,8 +393,10 @@ enum T_translations{
     T_HELP_FLASH_FILE_FLAG,
     T_HELP_FLASH_ERASE_FLAG,
     T_HELP_FLASH_VERIFY_FLAG,
+    T_HELP_FLASH_UPDATE_FLAG,
     T_HELP_FLASH_OVERRIDE,
     T_HELP_FLASH_YES_OVERRIDE,
+    T_HELP_FLASH_LINES_FLAG,
     T_HELP_I2C_EEPROM,
     T_HELP_SPI_EEPROM,
     T_HELP_1WIRE_EEPROM,
@@ -382,6 +410,7 @@ enum T_translations{
     T_HELP_EEPROM_DEVICE_FLAG,
     T_HELP_EEPROM_FILE_FLAG,
     T_HELP_EEPROM_VERIFY_FLAG,
+    T_HELP_EEPROM_UPDATE_FLAG,
     T_HELP_EEPROM_START_FLAG,
     T_HELP_EEPROM_BYTES_FLAG,
     T_HELP_EEPROM_ADDRESS_FLAG,
@@ -480,6 +509,16 @@ enum T_translations{
     T_HELP_GCMD_W_VOLTS,
     T_HELP_GCMD_W_CURRENT_LIMIT,
     T_HELP_GCMD_W_UNDERVOLTAGE,
+    T_HELP_GCMD_PSULOG_FILE,
+    T_HELP_GCMD_PSULOG_STREAM,
+    T_HELP_GCMD_PSULOG_RATE,
+    T_HELP_GCMD_PSULOG_INTERVAL,
+    T_HELP_GCMD_JOURNAL_START,
+    T_HELP_GCMD_JOURNAL_STOP,
+    T_HELP_GCMD_JOURNAL_EXPORT,
+    T_HELP_GCMD_JOURNAL_STATUS,
+    T_HELP_GCMD_JOURNAL_FILE,
+    T_HELP_GCMD_JOURNAL_OUTPUT,
     T_HELP_GCMD_P,
     T_HELP_GCMD_DUMP_BYTES,
     T_HELP_GCMD_DUMP_FILE,
@@ -558,6 +597,7 @@ enum T_translations{
     T_HELP_I2C_TCS34725_INTEGRATION,
     T_HELP_1WIRE_SCAN,
     T_HELP_1WIRE_DS18B20,
+    T_HELP_1WIRE_DS18B20_ALL,
     T_HELP_UART_BRIDGE,
     T_HELP_UART_BRIDGE_EXIT,
     T_HELP_UART_BRIDGE_TOOLBAR,
@@ -594,6 +634,7 @@ enum T_translations{
     T_HELP_LOGIC_FREQUENCY,
     T_HELP_LOGIC_OVERSAMPLE,
     T_HELP_LOGIC_DEBUG,
+    T_HELP_LOGIC_CHANGE,
     T_HELP_LOGIC_SAMPLES,
     T_HELP_LOGIC_TRIGGER_PIN,
     T_HELP_LOGIC_TRIGGER_LEVEL,
@@ -609,10 +650,34 @@ enum T_translations{
     T_SPI_CMD_SNIFF,
     T_HELP_UART_GLITCH,
     T_HELP_UART_GLITCH_CONFIG,
+    T_HELP_UART_CAMPAIGN,
+    T_HELP_UART_CAMPAIGN_DELAY,
+    T_HELP_UART_CAMPAIGN_WIDTH,
+    T_HELP_UART_CAMPAIGN_EDGES,
+    T_HELP_UART_CAMPAIGN_TRIGGER,
+    T_HELP_UART_CAMPAIGN_ROUNDS,
+    T_HELP_UART_CAMPAIGN_SHUFFLE,
+    T_HELP_UART_CAMPAIGN_STOP,
+    T_HELP_UART_CAMPAIGN_FAIL,
+    T_HELP_UART_CAMPAIGN_SUCCESS,
+    T_HELP_UART_CAMPAIGN_RESET,
+    T_HELP_UART_CAMPAIGN_WAIT,
+    T_HELP_UART_CAMPAIGN_QUIET,
+    T_HELP_UART_CAMPAIGN_RECYCLE,
+    T_HELP_UART_CAMPAIGN_NOREADY,
+    T_HELP_UART_CAMPAIGN_OUTPUT,
+    T_HELP_UART_MONITOR,
+    T_HELP_UART_MONITOR_FILE,
+    T_HELP_UART_MONITOR_GAP,
+    T_HELP_UART_MONITOR_TOOLBAR,
     T_I2C_SNIFF,
     T_I2C_SNIFF_QUIET,
     T_I2C_SNIFF_RAW,
     T_I2C_SNIFF_7_BIT_ADDRESSES,
+    T_I2C_SNIFF_FILE,
+    T_I2C_REPLAY_DESCRIPTION,
+    T_REPLAY_FILE,
+    T_REPLAY_SCALE,
     T_HELP_DDR5,
     T_HELP_DDR5_PROBE,
     T_HELP_DDR5_DUMP,
@@ -648,6 +713,10 @@ enum T_translations{
     T_HELP_I2C_USBPD_PDO_INDEX,
     T_HELP_I2C_USBPD_VOLTAGE,
     T_HELP_I2C_USBPD_CURRENT,
+    T_HELP_I2C_USBPD_MONITOR,
+    T_HELP_I2C_USBPD_SWEEP,
+    T_HELP_I2C_USBPD_INTERVAL,
+    T_HELP_I2C_USBPD_STEP,
     T_HELP_I2C_MPU6050,
     T_HELP_GLOBAL_JEP106_LOOKUP,
     T_HELP_CMD_EDIT,
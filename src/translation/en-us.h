@@ -114,6 +114,7 @@ static char const * const en_us[]={
 	[T_UART_INVERT_MENU]="Signal inversion",
 	[T_UART_INVERT_MENU_1]="Non-inverted (Standard)",
 	[T_UART_INVERT_MENU_2]="Inverted",
+	[T_UART_TIMESTAMP_MENU]="Timestamp async data",
 	[T_UART_INVERT_PROMPT]="Invert signals",
 	[T_UART_GLITCH_TRG_MENU]="Glitch trigger character",
     [T_UART_GLITCH_TRG_MENU_1]="1 - 255",
@@ -182,6 +183,8 @@ static char const * const en_us[]={
 	[T_HW2WIRE_RST_LOW]="RST LOW",
 	[T_HW2WIRE_RST_HIGH]="RST HIGH",
 	[T_HW2WIRE_SNIFF]="Sniff 8 bit data with start and stop bits (SLE4442, TM1640)",
+	[T_HW2WIRE_SNIFF_FILE]="Save the transactions to a file instead of showing them",
+	[T_HW2WIRE_SNIFF_IDLE]="End a response after this quiet time (us)",
 	//3WIRE
 	[T_HW3WIRE_SPEED_MENU_1]="1 to 3900kHz",
     //LEDs
@@ -196,6 +199,17 @@ static char const * const en_us[]={
 	[T_HWLED_RESET]="RESET",
 	[T_HWLED_FRAME_START]="START FRAME (0x00000000)",
 	[T_HWLED_FRAME_STOP]="STOP FRAME (0xFFFFFFFF)",
+	[T_HWLED_CMD_LEDS]="Show and play LED frames from files with DMA",
+	[T_HELP_HWLED_LEDS_SHOW]="Show the first frame in a file",
+	[T_HELP_HWLED_LEDS_PLAY]="Play all frames in a file at a fixed frame rate",
+	[T_HELP_HWLED_LEDS_BENCH]="Frames/sec for 300, 1000 and 4000 pixels",
+	[T_HELP_HWLED_LEDS_FILE_FLAG]="Frame file, raw bytes in wire order",
+	[T_HELP_HWLED_LEDS_PIXELS_FLAG]="Pixels per frame (show: default whole file)",
+	[T_HELP_HWLED_LEDS_RGBW_FLAG]="4 bytes per pixel: RGBW (WS2812) or header+RGB (APA102)",
+	[T_HELP_HWLED_LEDS_GAMMA_FLAG]="Gamma correction (1.0 default, 2.2 typical)",
+	[T_HELP_HWLED_LEDS_BRIGHTNESS_FLAG]="Brightness 0-255 (255 default)",
+	[T_HELP_HWLED_LEDS_RATE_FLAG]="Play: frames/sec (30 default)",
+	[T_HELP_HWLED_LEDS_LOOP_FLAG]="Play: loop until a key is pressed",
 	// 1-WIRE
 	[T_HW1WIRE_RESET]="1-Wire RESET",
 	[T_HW1WIRE_PRESENCE_DETECT]="Presence detected",
@@ -229,6 +243,16 @@ static char const * const en_us[]={
 	[T_JTAG_BLUETAG_VERSION]="Show version",
 	[T_JTAG_BLUETAG_DISABLE]="Disable pin pulsing (JTAG mode)",
 	[T_JTAG_BLUETAG_DESCRIPTION]="Find JTAG and SWD pinouts",
+	[T_JTAG_SVF_DESCRIPTION]="Play an SVF or XSVF file",
+	[T_JTAG_SVF_FILE]="SVF file, .xsv for XSVF",
+	[T_JTAG_SVF_FREQ]="Highest TCK frequency in kHz (default 1000)",
+	[T_DIO_PATTERN_DESCRIPTION]="Play a vector table on IO0-7 at a set sample rate",
+	[T_DIO_PATTERN_FILE]="Raw vector file, one byte per sample",
+	[T_DIO_PATTERN_RATE]="Sample rate in Hz (default 1000000)",
+	[T_DIO_PATTERN_REPEAT]="Play the table this many times (default 1)",
+	[T_DIO_PATTERN_LOOP]="Loop until x or the button is pressed",
+	[T_DIO_PATTERN_TRIGGER]="Wait for a rising edge on this IO pin first",
+	[T_DIO_PATTERN_FALLING]="Trigger on the falling edge",
 	//I2S
 	[T_I2S_SPEED_MENU]="Sample frequency",
 	[T_I2S_SPEED_MENU_1]="4000, 8000, 16000, 44100, 48000, 96000 etc",
@@ -266,6 +290,8 @@ static char const * const en_us[]={
 	[T_CMDLN_PULLUPS_EN]="P - enable onboard pull-up resistors.",
 	[T_CMDLN_PULLUPS_DIS]="p - disable onboard pull-up resistors.",
 	[T_CMDLN_PSU_DIS]="w - disable onboard power supply.",
+	[T_CMDLN_PSULOG]="psulog - log power supply voltage and current at up to the full ADC rate, min/max/mean/energy records to a file or the binmode port.",
+	[T_CMDLN_JOURNAL]="journal - record every executed bus syntax byte to a binary file, export it to pcapng for Wireshark.",
 	[T_CMDLN_ADC_CONT]="V <IOx> - continuous voltage measurement on pin <IOx>. Omit the pin number to measure voltage on all pins.",
 	[T_CMDLN_ADC_ONE]="v <IOx> - single voltage measurement on pin <IOx>. Omit the pin number to measure voltage on all pins once.",
 	[T_CMDLN_SELFTEST]="~ - perform a factory self-test. Disconnect any attached devices and change to HiZ mode before starting the test.",
@@ -362,8 +388,10 @@ static char const * const en_us[]={
 	[T_HELP_FLASH_FILE_FLAG]="File flag. File to write, read or verify",
 	[T_HELP_FLASH_ERASE_FLAG]="Erase flag. Add erase before write",
 	[T_HELP_FLASH_VERIFY_FLAG]="Verify flag. Add verify after write or erase",
+	[T_HELP_FLASH_UPDATE_FLAG]="Update flag. Write: erase and program only what differs from the file",
 	[T_HELP_FLASH_OVERRIDE]="Read without detect (0x03 command), -b to specify bytes to read",
 	[T_HELP_FLASH_YES_OVERRIDE]="Override yes/no prompt for destructive actions (erase, write, test)",
+	[T_HELP_FLASH_LINES_FLAG]="Dual/quad reads with flash DQ0-DQ3 on IO0-IO3, data lines wired (1, 2 or 4)",
 	//EEPROM command help
 	[T_HELP_I2C_EEPROM]="read, write and erase 24XX series I2C EEPROM chips",
 	[T_HELP_SPI_EEPROM]="read, write and erase 25XX series SPI EEPROM chips",
@@ -378,6 +406,7 @@ static char const * const en_us[]={
 	[T_HELP_EEPROM_DEVICE_FLAG]="Specify the EEPROM device",
 	[T_HELP_EEPROM_FILE_FLAG]="File to write, read or verify",
 	[T_HELP_EEPROM_VERIFY_FLAG]="Verify after write, read or erase",
+	[T_HELP_EEPROM_UPDATE_FLAG]="Write: only write pages that differ from the file",
 	[T_HELP_EEPROM_START_FLAG]="Dump: start address",
 	[T_HELP_EEPROM_BYTES_FLAG]="Dump: number of bytes",
 	[T_HELP_EEPROM_ADDRESS_FLAG]="I2C address (0x50 default)",
@@ -480,6 +509,16 @@ static char const * const en_us[]={
 	[T_HELP_GCMD_W_VOLTS]="Voltage, 0.8-5.0volts",
 	[T_HELP_GCMD_W_CURRENT_LIMIT]="Current limit, 0-500mA",
 	[T_HELP_GCMD_W_UNDERVOLTAGE]="Undervoltage limit <percent>",
+	[T_HELP_GCMD_PSULOG_FILE]="Log file, header then 20 byte records",
+	[T_HELP_GCMD_PSULOG_STREAM]="Stream the log to the binmode USB port",
+	[T_HELP_GCMD_PSULOG_RATE]="Samples per second on each channel, 1000-250000",
+	[T_HELP_GCMD_PSULOG_INTERVAL]="Time per record in microseconds, 100-1000000",
+	[T_HELP_GCMD_JOURNAL_START]="Start recording bus syntax to a journal file",
+	[T_HELP_GCMD_JOURNAL_STOP]="Stop recording and close the journal file",
+	[T_HELP_GCMD_JOURNAL_EXPORT]="Convert a journal file to pcapng",
+	[T_HELP_GCMD_JOURNAL_STATUS]="Show the journal file, records and lost records",
+	[T_HELP_GCMD_JOURNAL_FILE]="Journal file, header then 16 byte records",
+	[T_HELP_GCMD_JOURNAL_OUTPUT]="pcapng file to write",
 	[T_HELP_GCMD_P]="onboard pull-up resistors",
 	[T_HELP_GCMD_DUMP_BYTES]="Number of bytes to read",
 	[T_HELP_GCMD_DUMP_FILE]="Output file path",
@@ -558,6 +597,7 @@ static char const * const en_us[]={
 	[T_HELP_I2C_TCS34725_INTEGRATION]="Set TCS34725 integration time (2.4ms to 700ms)",
 	[T_HELP_1WIRE_SCAN]="scan for 1-Wire devices",
 	[T_HELP_1WIRE_DS18B20]="Query DS18B20 temperature sensor",
+	[T_HELP_1WIRE_DS18B20_ALL]="All sensors: convert together, then read each",
 	[T_HELP_UART_BRIDGE]="open UART with raw data IO, usb to serial bridge mode",
 	[T_HELP_UART_BRIDGE_EXIT]="UART bridge. Press Bus Pirate button to exit.",
 	[T_HELP_UART_BRIDGE_TOOLBAR]="ENABLE toolbar while bridge is active (default: disabled)",
@@ -595,6 +635,7 @@ static char const * const en_us[]={
 	[T_HELP_LOGIC_FREQUENCY]="set sample frequency in Hz",
 	[T_HELP_LOGIC_OVERSAMPLE]="set oversample rate, multiplies the sample frequency",
 	[T_HELP_LOGIC_DEBUG]="set debug level: 0-2",
+	[T_HELP_LOGIC_CHANGE]="record pin changes only: 0-1, needs sample frequency <= sysclk/10",
 	[T_HELP_LOGIC_SAMPLES]="set number of samples",
 	[T_HELP_LOGIC_TRIGGER_PIN]="set trigger pin, 0-7",
 	[T_HELP_LOGIC_TRIGGER_LEVEL]="set trigger level, 0-1",
@@ -610,10 +651,34 @@ static char const * const en_us[]={
 	[T_SPI_CMD_SNIFF]="SPI sniffer",
     [T_HELP_UART_GLITCH]="UART glitcher",
     [T_HELP_UART_GLITCH_CONFIG]="Configure UART glitch parameters",
+	[T_HELP_UART_CAMPAIGN]="Glitch parameter sweep with reply classification",
+	[T_HELP_UART_CAMPAIGN_DELAY]="Delay after the trigger edge, start[:stop[:step]] ns*10",
+	[T_HELP_UART_CAMPAIGN_WIDTH]="Glitch pulse width, start[:stop[:step]] ns*10",
+	[T_HELP_UART_CAMPAIGN_EDGES]="Trigger character edge to count from, start[:stop[:step]]",
+	[T_HELP_UART_CAMPAIGN_TRIGGER]="Trigger character (ASCII)",
+	[T_HELP_UART_CAMPAIGN_ROUNDS]="Rounds over the whole grid",
+	[T_HELP_UART_CAMPAIGN_SHUFFLE]="Shuffle the order of each round",
+	[T_HELP_UART_CAMPAIGN_STOP]="Stop at the first success",
+	[T_HELP_UART_CAMPAIGN_FAIL]="Text in the normal (failed) reply",
+	[T_HELP_UART_CAMPAIGN_SUCCESS]="Text in a successful reply",
+	[T_HELP_UART_CAMPAIGN_RESET]="Text in the target boot message",
+	[T_HELP_UART_CAMPAIGN_WAIT]="Wait for the first reply byte (ms)",
+	[T_HELP_UART_CAMPAIGN_QUIET]="Reply ends after this quiet time (us)",
+	[T_HELP_UART_CAMPAIGN_RECYCLE]="Pause between attempts (us)",
+	[T_HELP_UART_CAMPAIGN_NOREADY]="Do not check the RDY input",
+	[T_HELP_UART_CAMPAIGN_OUTPUT]="Save the results as CSV",
+	[T_HELP_UART_MONITOR]="Two channel UART monitor with timestamps",
+	[T_HELP_UART_MONITOR_FILE]="Save the records to a file instead of showing them",
+	[T_HELP_UART_MONITOR_GAP]="Start a new line after this quiet time (us)",
+	[T_HELP_UART_MONITOR_TOOLBAR]="ENABLE toolbar while the monitor is active (default: disabled)",
 	[T_I2C_SNIFF]="I2C sniffer",
 	[T_I2C_SNIFF_QUIET]="Quiet mode, don't show ACKs",
     [T_I2C_SNIFF_RAW]="Raw, only show data",
     [T_I2C_SNIFF_7_BIT_ADDRESSES]="Use 7bit i2c addresses",
+	[T_I2C_SNIFF_FILE]="Record to a file for the replay command",
+	[T_I2C_REPLAY_DESCRIPTION]="Replay an I2C recording with its timing",
+	[T_REPLAY_FILE]="Recording to replay",
+	[T_REPLAY_SCALE]="Time scale in percent, 0 for back to back",
 	//DDR5 command in I2C
 	[T_HELP_DDR5]="read, write and probe DDR5 SPD chips",
 	[T_HELP_DDR5_PROBE]="Show DDR5 SPD chip and NVM/EEPROM status",
@@ -650,6 +715,10 @@ static char const * const en_us[]={
 	[T_HELP_I2C_USBPD_PDO_INDEX]="Power Delivery profile index (1 - n)",
 	[T_HELP_I2C_USBPD_VOLTAGE]="Voltage in mV for adjustable (PPS) PDO request",
 	[T_HELP_I2C_USBPD_CURRENT]="Current in mA for PDO request (optional, default max)",
+	[T_HELP_I2C_USBPD_MONITOR]="Log PD events (attach, PDOs, requests, contract, VBUS, faults) until a key is pressed",
+	[T_HELP_I2C_USBPD_SWEEP]="Request every PDO in turn and check the measured VBUS",
+	[T_HELP_I2C_USBPD_INTERVAL]="Poll interval in ms (default 20)",
+	[T_HELP_I2C_USBPD_STEP]="Sweep step in mV for PPS/AVS PDOs (default 1000)",
 	[T_HELP_I2C_MPU6050]="interface with MPU-6050 6-axis IMU sensor",
 	[T_HELP_GLOBAL_JEP106_LOOKUP]="lookup vendor name from 2 byte JEDEC JEP106 ID code",
 	[T_HELP_CMD_EDIT]="edit or create files on the storage",
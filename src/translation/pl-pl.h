@@ -116,6 +116,7 @@ static char const * const pl_pl[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_UART_INVERT_MENU               ] = "Inwersja sygnału",
     [ T_UART_INVERT_MENU_1             ] = "Bez inwersji (standard)",
     [ T_UART_INVERT_MENU_2             ] = "Odwrócony",
+    [ T_UART_TIMESTAMP_MENU            ] = NULL,
     [ T_UART_INVERT_PROMPT             ] = "Odwróć sygnały",
     [ T_UART_GLITCH_TRG_MENU           ] = "Znak wyzwalający glitch",
     [ T_UART_GLITCH_TRG_MENU_1         ] = NULL,
@@ -182,6 +183,8 @@ static char const * const pl_pl[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HW2WIRE_RST_LOW                ] = "RST NISKI",
     [ T_HW2WIRE_RST_HIGH               ] = "RST WYSOKI",
     [ T_HW2WIRE_SNIFF                  ] = "Podsłuch 8-bitowych danych z bitami START/STOP (SLE4442, TM1640)",
+    [ T_HW2WIRE_SNIFF_FILE             ] = NULL,
+    [ T_HW2WIRE_SNIFF_IDLE             ] = NULL,
     [ T_HW3WIRE_SPEED_MENU_1           ] = "1 do 3900kHz",
     [ T_HWLED_DEVICE_MENU              ] = "Rodzaj LED",
     [ T_HWLED_DEVICE_MENU_1            ] = "WS2812/SK6812/„NeoPixel” (interfejs jednoprzewodowy)",
@@ -194,6 +197,17 @@ static char const * const pl_pl[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HWLED_RESET                    ] = NULL,
     [ T_HWLED_FRAME_START              ] = "RAMKA STARTu (0x00000000)",
     [ T_HWLED_FRAME_STOP               ] = "RAMKA STOPu (0xFFFFFFFF)",
+    [ T_HWLED_CMD_LEDS                 ] = NULL,
+    [ T_HELP_HWLED_LEDS_SHOW           ] = NULL,
+    [ T_HELP_HWLED_LEDS_PLAY           ] = NULL,
+    [ T_HELP_HWLED_LEDS_BENCH          ] = NULL,
+    [ T_HELP_HWLED_LEDS_FILE_FLAG      ] = NULL,
+    [ T_HELP_HWLED_LEDS_PIXELS_FLAG    ] = NULL,
+    [ T_HELP_HWLED_LEDS_RGBW_FLAG      ] = NULL,
+    [ T_HELP_HWLED_LEDS_GAMMA_FLAG     ] = NULL,
+    [ T_HELP_HWLED_LEDS_BRIGHTNESS_FLAG ] = NULL,
+    [ T_HELP_HWLED_LEDS_RATE_FLAG      ] = NULL,
+    [ T_HELP_HWLED_LEDS_LOOP_FLAG      ] = NULL,
     [ T_HW1WIRE_RESET                  ] = NULL,
     [ T_HW1WIRE_PRESENCE_DETECT        ] = "Wykryto urządzenie",
     [ T_HW1WIRE_NO_DEVICE              ] = "Nie wykryto urządzenia",
@@ -224,6 +238,16 @@ static char const * const pl_pl[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_JTAG_BLUETAG_VERSION           ] = "Pokaż wersję",
     [ T_JTAG_BLUETAG_DISABLE           ] = "Wyłącz impulsowanie pinów (tryb JTAG)",
     [ T_JTAG_BLUETAG_DESCRIPTION       ] = "Wykryj wyprowadzenia JTAG i SWD",
+    [ T_JTAG_SVF_DESCRIPTION           ] = NULL,
+    [ T_JTAG_SVF_FILE                  ] = NULL,
+    [ T_JTAG_SVF_FREQ                  ] = NULL,
+    [ T_DIO_PATTERN_DESCRIPTION        ] = NULL,
+    [ T_DIO_PATTERN_FILE               ] = NULL,
+    [ T_DIO_PATTERN_RATE               ] = NULL,
+    [ T_DIO_PATTERN_REPEAT             ] = NULL,
+    [ T_DIO_PATTERN_LOOP               ] = NULL,
+    [ T_DIO_PATTERN_TRIGGER            ] = NULL,
+    [ T_DIO_PATTERN_FALLING            ] = NULL,
     [ T_I2S_SPEED_MENU                 ] = "Częstotliwość próbkowania",
     [ T_I2S_SPEED_MENU_1               ] = "4000, 8000, 16000, 44100, 48000, 96000 itd",
     [ T_I2S_SPEED_PROMPT               ] = NULL,
@@ -258,6 +282,8 @@ static char const * const pl_pl[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_CMDLN_PULLUPS_EN               ] = "P - włącza rezystory pull-up na płytce.",
     [ T_CMDLN_PULLUPS_DIS              ] = "p - wyłącza rezystory pull-up na płytce.",
     [ T_CMDLN_PSU_DIS                  ] = "w - wyłącza zasilanie na płytce.",
+    [ T_CMDLN_PSULOG                   ] = NULL,
+    [ T_CMDLN_JOURNAL                  ] = NULL,
     [ T_CMDLN_ADC_CONT                 ] = "V {IOx} - ciągle mierzy napięcie na pinie {IOx}. Pomiń numer pinu, aby zmierzyć jednorazowo na wszystkich pinach.",
     [ T_CMDLN_ADC_ONE                  ] = "v {IOx} - jednorazowo mierzy na pięciena pinie {IOx}. Pomiń numer pinu aby zmierzyć jednorazowo na wszystkich pinach.",
     [ T_CMDLN_SELFTEST                 ] = "~ - przeprowadza self-test fabryczny. Odłącz wszystkie urządzenia i zmień na tryb HiZ przed rozpoczęciem testu.",
@@ -351,8 +377,10 @@ static char const * const pl_pl[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HELP_FLASH_FILE_FLAG           ] = "Flaga pliku: plik do zapisu/odczytu/weryfikacji",
     [ T_HELP_FLASH_ERASE_FLAG          ] = "Flaga kasowania: dodaj kasowanie przed zapisem",
     [ T_HELP_FLASH_VERIFY_FLAG         ] = "Flaga weryfikacji: dodaj weryfikację po zapisie lub kasowaniu",
+    [ T_HELP_FLASH_UPDATE_FLAG         ] = NULL,
     [ T_HELP_FLASH_OVERRIDE            ] = NULL,
     [ T_HELP_FLASH_YES_OVERRIDE        ] = NULL,
+    [ T_HELP_FLASH_LINES_FLAG          ] = NULL,
     [ T_HELP_I2C_EEPROM                ] = "odczyt, zapis i kasowanie pamięci I2C EEPROM serii 24XX",
     [ T_HELP_SPI_EEPROM                ] = "odczyt, zapis i kasowanie pamięci SPI EEPROM serii 25XX",
     [ T_HELP_1WIRE_EEPROM              ] = "odczyt, zapis i kasowanie pamięci 1-Wire EEPROM serii 243X",
@@ -366,6 +394,7 @@ static char const * const pl_pl[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HELP_EEPROM_DEVICE_FLAG        ] = "Wybierz chip EEPROM",
     [ T_HELP_EEPROM_FILE_FLAG          ] = "Plik do zapisu/odczytu/weryfikacji",
     [ T_HELP_EEPROM_VERIFY_FLAG        ] = "Weryfikuj po zapisie/odczycie/kasowaniu",
+    [ T_HELP_EEPROM_UPDATE_FLAG        ] = NULL,
     [ T_HELP_EEPROM_START_FLAG         ] = "Zrzut: adres startowy",
     [ T_HELP_EEPROM_BYTES_FLAG         ] = "Zrzut: liczba bajtów",
     [ T_HELP_EEPROM_ADDRESS_FLAG       ] = "Adres I2C (domyślnie 0x50)",
@@ -464,6 +493,16 @@ static char const * const pl_pl[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HELP_GCMD_W_VOLTS              ] = "Napięcie, 0,8-5,0 V",
     [ T_HELP_GCMD_W_CURRENT_LIMIT      ] = "Limit prądowy, 0-500 mA",
     [ T_HELP_GCMD_W_UNDERVOLTAGE       ] = NULL,
+    [ T_HELP_GCMD_PSULOG_FILE          ] = NULL,
+    [ T_HELP_GCMD_PSULOG_STREAM        ] = NULL,
+    [ T_HELP_GCMD_PSULOG_RATE          ] = NULL,
+    [ T_HELP_GCMD_PSULOG_INTERVAL      ] = NULL,
+    [ T_HELP_GCMD_JOURNAL_START        ] = NULL,
+    [ T_HELP_GCMD_JOURNAL_STOP         ] = NULL,
+    [ T_HELP_GCMD_JOURNAL_EXPORT       ] = NULL,
+    [ T_HELP_GCMD_JOURNAL_STATUS       ] = NULL,
+    [ T_HELP_GCMD_JOURNAL_FILE         ] = NULL,
+    [ T_HELP_GCMD_JOURNAL_OUTPUT       ] = NULL,
     [ T_HELP_GCMD_P                    ] = "Wbudowane rezystory podciągające (pull-up)",
     [ T_HELP_GCMD_DUMP_BYTES           ] = NULL,
     [ T_HELP_GCMD_DUMP_FILE            ] = NULL,
@@ -542,6 +581,7 @@ static char const * const pl_pl[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HELP_I2C_TCS34725_INTEGRATION  ] = NULL,
     [ T_HELP_1WIRE_SCAN                ] = "Skanuj urządzenia 1-Wire",
     [ T_HELP_1WIRE_DS18B20             ] = "Odczytaj temperaturę z czujnika DS18B20",
+    [ T_HELP_1WIRE_DS18B20_ALL         ] = NULL,
     [ T_HELP_UART_BRIDGE               ] = "T_HELP_UART_BRIDGE",
     [ T_HELP_UART_BRIDGE_EXIT          ] = "Mostek UART. Naciśnij przycisk na Bus Pirat'cie, aby wyjść",
     [ T_HELP_UART_BRIDGE_TOOLBAR       ] = "Włącz pasek narzędzi podczas pracy mostka (domyślnie: wyłączony)",
@@ -578,6 +618,7 @@ static char const * const pl_pl[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HELP_LOGIC_FREQUENCY           ] = "ustaw częstotliwość próbkowania w Hz",
     [ T_HELP_LOGIC_OVERSAMPLE          ] = "ustaw współczynnik nadpróbkowania (mnoży częstotliwość próbkowania)",
     [ T_HELP_LOGIC_DEBUG               ] = "ustaw poziom debugowania: 0-2",
+    [ T_HELP_LOGIC_CHANGE              ] = NULL,
     [ T_HELP_LOGIC_SAMPLES             ] = "ustaw liczbę próbek",
     [ T_HELP_LOGIC_TRIGGER_PIN         ] = "ustaw pin wyzwalania, 0-7",
     [ T_HELP_LOGIC_TRIGGER_LEVEL       ] = "ustaw poziom wyzwalania, 0-1",
@@ -593,10 +634,34 @@ static char const * const pl_pl[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_SPI_CMD_SNIFF                  ] = "Sniffer SPI",
     [ T_HELP_UART_GLITCH               ] = "Glitch'er UART",
     [ T_HELP_UART_GLITCH_CONFIG        ] = "Konfiguruj parametry glitch'era UART",
+    [ T_HELP_UART_CAMPAIGN             ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_DELAY       ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_WIDTH       ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_EDGES       ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_TRIGGER     ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_ROUNDS      ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_SHUFFLE     ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_STOP        ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_FAIL        ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_SUCCESS     ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_RESET       ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_WAIT        ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_QUIET       ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_RECYCLE     ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_NOREADY     ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_OUTPUT      ] = NULL,
+    [ T_HELP_UART_MONITOR              ] = NULL,
+    [ T_HELP_UART_MONITOR_FILE         ] = NULL,
+    [ T_HELP_UART_MONITOR_GAP          ] = NULL,
+    [ T_HELP_UART_MONITOR_TOOLBAR      ] = NULL,
     [ T_I2C_SNIFF                      ] = "Sniffer I2C",
     [ T_I2C_SNIFF_QUIET                ] = "Tryb cichy, nie pokazuj ACK",
     [ T_I2C_SNIFF_RAW                  ] = NULL,
     [ T_I2C_SNIFF_7_BIT_ADDRESSES      ] = NULL,
+    [ T_I2C_SNIFF_FILE                 ] = NULL,
+    [ T_I2C_REPLAY_DESCRIPTION         ] = NULL,
+    [ T_REPLAY_FILE                    ] = NULL,
+    [ T_REPLAY_SCALE                   ] = NULL,
     [ T_HELP_DDR5                      ] = "Odczyt, zapis i wykrywanie układów DDR5 SPD",
     [ T_HELP_DDR5_PROBE                ] = "Pokaż status układu DDR5 SPD oraz NVM/EEPROM",
     [ T_HELP_DDR5_DUMP                 ] = "Wyświetl zawartość NVM DDR5 SPD",
@@ -632,6 +697,10 @@ static char const * const pl_pl[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HELP_I2C_USBPD_PDO_INDEX       ] = NULL,
     [ T_HELP_I2C_USBPD_VOLTAGE         ] = NULL,
     [ T_HELP_I2C_USBPD_CURRENT         ] = NULL,
+    [ T_HELP_I2C_USBPD_MONITOR         ] = NULL,
+    [ T_HELP_I2C_USBPD_SWEEP           ] = NULL,
+    [ T_HELP_I2C_USBPD_INTERVAL        ] = NULL,
+    [ T_HELP_I2C_USBPD_STEP            ] = NULL,
     [ T_HELP_I2C_MPU6050               ] = NULL,
     [ T_HELP_GLOBAL_JEP106_LOOKUP      ] = NULL,
     [ T_HELP_CMD_EDIT                  ] = NULL,
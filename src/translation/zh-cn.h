@@ -116,6 +116,7 @@ static char const * const zh_cn[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_UART_INVERT_MENU               ] = NULL,
     [ T_UART_INVERT_MENU_1             ] = NULL,
     [ T_UART_INVERT_MENU_2             ] = NULL,
+    [ T_UART_TIMESTAMP_MENU            ] = NULL,
     [ T_UART_INVERT_PROMPT             ] = NULL,
     [ T_UART_GLITCH_TRG_MENU           ] = NULL,
     [ T_UART_GLITCH_TRG_MENU_1         ] = NULL,
@@ -182,6 +183,8 @@ static char const * const zh_cn[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HW2WIRE_RST_LOW                ] = NULL,
     [ T_HW2WIRE_RST_HIGH               ] = NULL,
     [ T_HW2WIRE_SNIFF                  ] = NULL,
+    [ T_HW2WIRE_SNIFF_FILE             ] = NULL,
+    [ T_HW2WIRE_SNIFF_IDLE             ] = NULL,
     [ T_HW3WIRE_SPEED_MENU_1           ] = NULL,
     [ T_HWLED_DEVICE_MENU              ] = NULL,
     [ T_HWLED_DEVICE_MENU_1            ] = NULL,
@@ -194,6 +197,17 @@ static char const * const zh_cn[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HWLED_RESET                    ] = NULL,
     [ T_HWLED_FRAME_START              ] = NULL,
     [ T_HWLED_FRAME_STOP               ] = NULL,
+    [ T_HWLED_CMD_LEDS                 ] = NULL,
+    [ T_HELP_HWLED_LEDS_SHOW           ] = NULL,
+    [ T_HELP_HWLED_LEDS_PLAY           ] = NULL,
+    [ T_HELP_HWLED_LEDS_BENCH          ] = NULL,
+    [ T_HELP_HWLED_LEDS_FILE_FLAG      ] = NULL,
+    [ T_HELP_HWLED_LEDS_PIXELS_FLAG    ] = NULL,
+    [ T_HELP_HWLED_LEDS_RGBW_FLAG      ] = NULL,
+    [ T_HELP_HWLED_LEDS_GAMMA_FLAG     ] = NULL,
+    [ T_HELP_HWLED_LEDS_BRIGHTNESS_FLAG ] = NULL,
+    [ T_HELP_HWLED_LEDS_RATE_FLAG      ] = NULL,
+    [ T_HELP_HWLED_LEDS_LOOP_FLAG      ] = NULL,
     [ T_HW1WIRE_RESET                  ] = NULL,
     [ T_HW1WIRE_PRESENCE_DETECT        ] = NULL,
     [ T_HW1WIRE_NO_DEVICE              ] = NULL,
@@ -224,6 +238,16 @@ static char const * const zh_cn[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_JTAG_BLUETAG_VERSION           ] = NULL,
     [ T_JTAG_BLUETAG_DISABLE           ] = NULL,
     [ T_JTAG_BLUETAG_DESCRIPTION       ] = NULL,
+    [ T_JTAG_SVF_DESCRIPTION           ] = NULL,
+    [ T_JTAG_SVF_FILE                  ] = NULL,
+    [ T_JTAG_SVF_FREQ                  ] = NULL,
+    [ T_DIO_PATTERN_DESCRIPTION        ] = NULL,
+    [ T_DIO_PATTERN_FILE               ] = NULL,
+    [ T_DIO_PATTERN_RATE               ] = NULL,
+    [ T_DIO_PATTERN_REPEAT             ] = NULL,
+    [ T_DIO_PATTERN_LOOP               ] = NULL,
+    [ T_DIO_PATTERN_TRIGGER            ] = NULL,
+    [ T_DIO_PATTERN_FALLING            ] = NULL,
     [ T_I2S_SPEED_MENU                 ] = NULL,
     [ T_I2S_SPEED_MENU_1               ] = NULL,
     [ T_I2S_SPEED_PROMPT               ] = NULL,
@@ -258,6 +282,8 @@ static char const * const zh_cn[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_CMDLN_PULLUPS_EN               ] = NULL,
     [ T_CMDLN_PULLUPS_DIS              ] = NULL,
     [ T_CMDLN_PSU_DIS                  ] = NULL,
+    [ T_CMDLN_PSULOG                   ] = NULL,
+    [ T_CMDLN_JOURNAL                  ] = NULL,
     [ T_CMDLN_ADC_CONT                 ] = NULL,
     [ T_CMDLN_ADC_ONE                  ] = NULL,
     [ T_CMDLN_SELFTEST                 ] = NULL,
@@ -351,8 +377,10 @@ static char const * const zh_cn[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HELP_FLASH_FILE_FLAG           ] = NULL,
     [ T_HELP_FLASH_ERASE_FLAG          ] = NULL,
     [ T_HELP_FLASH_VERIFY_FLAG         ] = NULL,
+    [ T_HELP_FLASH_UPDATE_FLAG         ] = NULL,
     [ T_HELP_FLASH_OVERRIDE            ] = NULL,
     [ T_HELP_FLASH_YES_OVERRIDE        ] = NULL,
+    [ T_HELP_FLASH_LINES_FLAG          ] = NULL,
     [ T_HELP_I2C_EEPROM                ] = NULL,
     [ T_HELP_SPI_EEPROM                ] = NULL,
     [ T_HELP_1WIRE_EEPROM              ] = NULL,
@@ -366,6 +394,7 @@ static char const * const zh_cn[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HELP_EEPROM_DEVICE_FLAG        ] = NULL,
     [ T_HELP_EEPROM_FILE_FLAG          ] = NULL,
     [ T_HELP_EEPROM_VERIFY_FLAG        ] = NULL,
+    [ T_HELP_EEPROM_UPDATE_FLAG        ] = NULL,
     [ T_HELP_EEPROM_START_FLAG         ] = NULL,
     [ T_HELP_EEPROM_BYTES_FLAG         ] = NULL,
     [ T_HELP_EEPROM_ADDRESS_FLAG       ] = NULL,
@@ -464,6 +493,16 @@ static char const * const zh_cn[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HELP_GCMD_W_VOLTS              ] = NULL,
     [ T_HELP_GCMD_W_CURRENT_LIMIT      ] = NULL,
     [ T_HELP_GCMD_W_UNDERVOLTAGE       ] = NULL,
+    [ T_HELP_GCMD_PSULOG_FILE          ] = NULL,
+    [ T_HELP_GCMD_PSULOG_STREAM        ] = NULL,
+    [ T_HELP_GCMD_PSULOG_RATE          ] = NULL,
+    [ T_HELP_GCMD_PSULOG_INTERVAL      ] = NULL,
+    [ T_HELP_GCMD_JOURNAL_START        ] = NULL,
+    [ T_HELP_GCMD_JOURNAL_STOP         ] = NULL,
+    [ T_HELP_GCMD_JOURNAL_EXPORT       ] = NULL,
+    [ T_HELP_GCMD_JOURNAL_STATUS       ] = NULL,
+    [ T_HELP_GCMD_JOURNAL_FILE         ] = NULL,
+    [ T_HELP_GCMD_JOURNAL_OUTPUT       ] = NULL,
     [ T_HELP_GCMD_P                    ] = NULL,
     [ T_HELP_GCMD_DUMP_BYTES           ] = NULL,
     [ T_HELP_GCMD_DUMP_FILE            ] = NULL,
@@ -542,6 +581,7 @@ static char const * const zh_cn[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HELP_I2C_TCS34725_INTEGRATION  ] = NULL,
     [ T_HELP_1WIRE_SCAN                ] = NULL,
     [ T_HELP_1WIRE_DS18B20             ] = NULL,
+    [ T_HELP_1WIRE_DS18B20_ALL         ] = NULL,
     [ T_HELP_UART_BRIDGE               ] = NULL,
     [ T_HELP_UART_BRIDGE_EXIT          ] = NULL,
     [ T_HELP_UART_BRIDGE_TOOLBAR       ] = NULL,
@@ -578,6 +618,7 @@ static char const * const zh_cn[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HELP_LOGIC_FREQUENCY           ] = NULL,
     [ T_HELP_LOGIC_OVERSAMPLE          ] = NULL,
     [ T_HELP_LOGIC_DEBUG               ] = NULL,
+    [ T_HELP_LOGIC_CHANGE              ] = NULL,
     [ T_HELP_LOGIC_SAMPLES             ] = NULL,
     [ T_HELP_LOGIC_TRIGGER_PIN         ] = NULL,
     [ T_HELP_LOGIC_TRIGGER_LEVEL       ] = NULL,
@@ -593,10 +634,34 @@ static char const * const zh_cn[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_SPI_CMD_SNIFF                  ] = NULL,
     [ T_HELP_UART_GLITCH               ] = NULL,
     [ T_HELP_UART_GLITCH_CONFIG        ] = NULL,
+    [ T_HELP_UART_CAMPAIGN             ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_DELAY       ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_WIDTH       ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_EDGES       ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_TRIGGER     ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_ROUNDS      ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_SHUFFLE     ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_STOP        ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_FAIL        ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_SUCCESS     ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_RESET       ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_WAIT        ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_QUIET       ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_RECYCLE     ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_NOREADY     ] = NULL,
+    [ T_HELP_UART_CAMPAIGN_OUTPUT      ] = NULL,
+    [ T_HELP_UART_MONITOR              ] = NULL,
+    [ T_HELP_UART_MONITOR_FILE         ] = NULL,
+    [ T_HELP_UART_MONITOR_GAP          ] = NULL,
+    [ T_HELP_UART_MONITOR_TOOLBAR      ] = NULL,
     [ T_I2C_SNIFF                      ] = NULL,
     [ T_I2C_SNIFF_QUIET                ] = NULL,
     [ T_I2C_SNIFF_RAW                  ] = NULL,
     [ T_I2C_SNIFF_7_BIT_ADDRESSES      ] = NULL,
+    [ T_I2C_SNIFF_FILE                 ] = NULL,
+    [ T_I2C_REPLAY_DESCRIPTION         ] = NULL,
+    [ T_REPLAY_FILE                    ] = NULL,
+    [ T_REPLAY_SCALE                   ] = NULL,
     [ T_HELP_DDR5                      ] = NULL,
     [ T_HELP_DDR5_PROBE                ] = NULL,
     [ T_HELP_DDR5_DUMP                 ] = NULL,
@@ -632,6 +697,10 @@ static char const * const zh_cn[T_LAST_ITEM_ALWAYS_AT_THE_END]={
     [ T_HELP_I2C_USBPD_PDO_INDEX       ] = NULL,
     [ T_HELP_I2C_USBPD_VOLTAGE         ] = NULL,
     [ T_HELP_I2C_USBPD_CURRENT         ] = NULL,
+    [ T_HELP_I2C_USBPD_MONITOR         ] = NULL,
+    [ T_HELP_I2C_USBPD_SWEEP           ] = NULL,
+    [ T_HELP_I2C_USBPD_INTERVAL        ] = NULL,
+    [ T_HELP_I2C_USBPD_STEP            ] = NULL,
     [ T_HELP_I2C_MPU6050               ] = NULL,
     [ T_HELP_GLOBAL_JEP106_LOOKUP      ] = NULL,
     [ T_HELP_CMD_EDIT                  ] = NULL,
@@ -7,6 +7,8 @@
 #include "ui/ui_hex.h"
 #include "ui/ui_toolbar.h"
 #include "system_config.h"
+#include "usb_tx.h"
+#include "lib/line_fmt/line_fmt.h"
 
 //a function to initialize the hex config structure
 // this is primarily useful for initializing config 
@@ -92,94 +94,22 @@ void ui_hex_header_config(struct hex_config_t *config){
     printf("\r\n");
 }
 
-void ui_hex_row_color(bool *is_grey, bool *is_nonzero, uint32_t address, uint8_t byte, struct hex_config_t *config, char *color_func) {
-    if((address) < config->start_address || (address) > config->start_address + config->requested_bytes -1) { //leading bytes before start address, make grey
-        if(!(*is_grey)) {
-            (*is_grey) = true; // start printing grey color for addresses before start address
-            printf("%s", ui_term_color_grey()); // print grey color
-        }
-    }else{
-        if((byte == 0x00 || byte == 0xFF)) {
-            if((*is_grey) || (*is_nonzero)) {
-                (*is_nonzero) = false; // stop highlighting the address if we have a zero byte
-                printf("%s", ui_term_color_reset()); // reset color
-            }                              
-        }else{
-            if((*is_grey) || !(*is_nonzero)) {
-                (*is_nonzero) = true; // highlight the address if we have a non-zero byte
-                printf("%s", color_func); // start highlighting
-            }
-        }
-        (*is_grey)=false;
-    }
-}
-
-void ui_hex_ascii_color(bool *is_grey, bool *is_nonzero, uint32_t address, uint8_t byte, struct hex_config_t *config, char *color_func) {
-    if((address) < config->start_address || (address) > config->start_address + config->requested_bytes -1) { //leading bytes before start address, make grey
-        if(!(*is_grey)) {
-            (*is_grey) = true; // start printing grey color for addresses before start address
-            printf("%s", ui_term_color_grey()); // print grey color
-        }
-    }else{
-        if(byte >= 32 && byte <= 126) { // printable ASCII range
-            if((*is_grey) || !(*is_nonzero)) {
-                (*is_nonzero) = true; // highlight the character if it is printable
-                printf("%s", color_func); // start highlighting
-            }
-        } else {
-            if((*is_grey) || (*is_nonzero)) {
-                (*is_nonzero) = false; // stop highlighting the address if we have a non-printable character
-                printf("%s", ui_term_color_reset()); // reset color
-            }
-        }
-        (*is_grey)=false;
-    }
-}
+// one row is rendered into this buffer and sent to the tx fifo in a single write
+static line_fmt_t hex_line;
 
 bool ui_hex_row_config(struct hex_config_t *config, uint32_t address, uint8_t *buf, uint32_t buf_size){
         if(buf_size > 16) {
         printf("Error: Buffer size must be <16 bytes\r\n");
         return true; // error
     }
-    // print the address
-    if(!config->quiet){
-        printf("%08X: ", address);
-    }
-    
-    bool is_nonzero = false; // flag to highlight the address
-    bool is_grey = false; // flag to print grey color for addresses before start address
-    // print the data in hex
-    for(uint32_t j = 0; j < 16; j++) {
-        if(j < buf_size) {
-            ui_hex_row_color(&is_grey, &is_nonzero, address+j, buf[j], config, ui_term_color_num_float());
-            printf("%02X ", (uint8_t)buf[j]);  
-            
-        } else {
-            printf("   "); // print spaces for empty bytes
-        }
-    }
-    
-    if(!config->quiet){
-        // print the ASCII representation of the data
-        printf("%s|", ui_term_color_reset());
-        is_nonzero = false; // reset highlight flag for ASCII representation 
-        is_grey = false; // reset grey flag for ASCII representation
-        for(uint32_t j = 0; j < 16; j++) {
-            if(j < buf_size) {
-                ui_hex_ascii_color(&is_grey, &is_nonzero, address+j, buf[j], config, ui_term_color_info());
-                if(buf[j] >= 32 && buf[j] <= 126) { // printable ASCII range
-                    printf("%c", buf[j]); // print the character in color
-                } else {
-                    printf("."); // non-printable characters as dot
-                }
-            } else {
-                printf(" "); // print space for empty bytes
-            }
-        }
-        printf("%s|\r\n", ui_term_color_reset()); // reset color after ASCII representation
-    }else{
-        printf("%s\r\n", ui_term_color_reset()); // reset color after hex data
-    }
+
+    // colour escapes are looked up once per row instead of once per byte
+    line_fmt_colors_t colors;
+    line_fmt_colors(&colors, ui_term_color_reset(), ui_term_color_grey(), ui_term_color_num_float(), ui_term_color_info());
+
+    line_fmt_init(&hex_line, tx_fifo_write);
+    line_fmt_hex_row(&hex_line, &colors, address, buf, buf_size, config->start_address, config->requested_bytes, config->quiet);
+    line_fmt_flush(&hex_line);
 
     if(!config->pager_off){
         config->rows_printed++; // increment the row counter
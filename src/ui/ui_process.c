@@ -21,6 +21,7 @@
 #include "pirate/intercore_helpers.h"
 #include "binmode/binmodes.h"
 #include "binmode/fala.h"
+#include "syntax_journal.h"
 
 // const structs are init'd with 0s, we'll make them here and copy in the main loop
 static const struct command_result result_blank;
@@ -64,6 +65,9 @@ SYNTAX_STATUS ui_process_syntax(void) {
     // follow along logic analyzer hook
     fala_notify_hook();
 
+    // journal to the file now the bus is idle
+    syntax_journal_flush();
+
     return result;
 }
 
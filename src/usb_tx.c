@@ -236,9 +236,12 @@ void tx_fifo_try_put(char* c) {
 
 void tx_fifo_write(const char* buf, uint32_t len) {
     BP_ASSERT_CORE0();
-    for (uint32_t i = 0; i < len; i++) {
-        spsc_queue_add_blocking(&tx_fifo, (uint8_t)buf[i]);
-    }
+    spsc_queue_write_blocking(&tx_fifo, (const uint8_t*)buf, len);
+}
+
+uint32_t tx_fifo_try_write(const char* buf, uint32_t len) {
+    BP_ASSERT_CORE0();
+    return spsc_queue_try_write(&tx_fifo, (const uint8_t*)buf, len);
 }
 
 void tx_fifo_wait_drain(void) {
@@ -253,6 +256,11 @@ void bin_tx_fifo_put(const char c) {
     spsc_queue_add_blocking(&bin_tx_fifo, (uint8_t)c);
 }
 
+uint32_t bin_tx_fifo_try_write(const char* buf, uint32_t len) {
+    BP_ASSERT_CORE0();
+    return spsc_queue_try_write(&bin_tx_fifo, (const uint8_t*)buf, len);
+}
+
 bool bin_tx_fifo_try_get(char* c) {
     BP_ASSERT_CORE1(); // tx fifo is drained from core1 only
     return spsc_queue_try_remove(&bin_tx_fifo, (uint8_t*)c);
@@ -34,6 +34,15 @@ void tx_fifo_try_put(char* c);
  */
 void tx_fifo_write(const char* buf, uint32_t len);
 
+/**
+ * @brief Write as much of a buffer as fits in the transmit FIFO.
+ * @param buf  Buffer to send
+ * @param len  Number of bytes to send
+ * @return     Bytes queued, 0 if the FIFO is full
+ * @pre Must be called from Core0.
+ */
+uint32_t tx_fifo_try_write(const char* buf, uint32_t len);
+
 /**
  * @brief Wait until transmit FIFO is fully drained.
  * @pre Must be called from Core0.
@@ -52,6 +61,15 @@ void tx_tb_start(uint32_t len);
  */
 void bin_tx_fifo_put(const char c);
 
+/**
+ * @brief Write as much of a buffer as fits in the binary transmit FIFO.
+ * @param buf  Buffer to send
+ * @param len  Number of bytes to send
+ * @return     Bytes queued, 0 if the FIFO is full
+ * @pre Must be called from Core0.
+ */
+uint32_t bin_tx_fifo_try_write(const char* buf, uint32_t len);
+
 /**
  * @brief Service binary transmit FIFO.
  */
@@ -1,82 +1,230 @@
+/**
+ * @file wavegen.c
+ * @brief 8 bit parallel pattern generator on PIO with DMA.
+ * @details The data channel feeds the TX FIFO (joined, 8 words deep) from
+ *          the output buffer. In a loop it chains to the control channel,
+ *          which writes the buffer address back to the data channel's
+ *          trigger register, and the FIFO covers the couple of cycles that
+ *          takes. The DMA is started before the state machine so the FIFO
+ *          is full when the first sample goes out.
+ *
+ *          An underrun is the state machine stalling on an empty FIFO while
+ *          the data channel still has words to move. The stall flag is read
+ *          before the channel's busy bit, so a stall at the natural end of
+ *          a run is never counted.
+ */
+
 #include <stdio.h>
-#include <math.h>
 #include "pico/stdlib.h"
-#include "hardware/pwm.h"
-#include "hardware/clocks.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
 #include "pirate.h"
 #include "system_config.h"
+#include "pio_config.h"
 #include "pirate/bio.h"
-#include "command_struct.h"
-#include "ui/ui_prompt.h"
-#include "ui/ui_const.h"
-#include "ui/ui_term.h"
-#include "ui/ui_info.h"
-
 #include "wavegen.h"
+#include "wavegen.pio.h"
 
-#include "hardware/pio.h"
-#include "build/wavegen.pio.h"
-
-/* ripped from http://aquaticus.info/pwm-sine-wave */
-// VIA: https://gist.github.com/funkfinger/965900
-uint8_t sine_wave[256] = {
-    // clang-format off
-    0x80, 0x83, 0x86, 0x89, 0x8C, 0x90, 0x93, 0x96,
-    0x99, 0x9C, 0x9F, 0xA2, 0xA5, 0xA8, 0xAB, 0xAE,
-    0xB1, 0xB3, 0xB6, 0xB9, 0xBC, 0xBF, 0xC1, 0xC4,
-    0xC7, 0xC9, 0xCC, 0xCE, 0xD1, 0xD3, 0xD5, 0xD8,
-    0xDA, 0xDC, 0xDE, 0xE0, 0xE2, 0xE4, 0xE6, 0xE8,
-    0xEA, 0xEB, 0xED, 0xEF, 0xF0, 0xF1, 0xF3, 0xF4,
-    0xF5, 0xF6, 0xF8, 0xF9, 0xFA, 0xFA, 0xFB, 0xFC,
-    0xFD, 0xFD, 0xFE, 0xFE, 0xFE, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xFE, 0xFE, 0xFD,
-    0xFD, 0xFC, 0xFB, 0xFA, 0xFA, 0xF9, 0xF8, 0xF6,
-    0xF5, 0xF4, 0xF3, 0xF1, 0xF0, 0xEF, 0xED, 0xEB,
-    0xEA, 0xE8, 0xE6, 0xE4, 0xE2, 0xE0, 0xDE, 0xDC,
-    0xDA, 0xD8, 0xD5, 0xD3, 0xD1, 0xCE, 0xCC, 0xC9,
-    0xC7, 0xC4, 0xC1, 0xBF, 0xBC, 0xB9, 0xB6, 0xB3,
-    0xB1, 0xAE, 0xAB, 0xA8, 0xA5, 0xA2, 0x9F, 0x9C,
-    0x99, 0x96, 0x93, 0x90, 0x8C, 0x89, 0x86, 0x83,
-    0x80, 0x7D, 0x7A, 0x77, 0x74, 0x70, 0x6D, 0x6A,
-    0x67, 0x64, 0x61, 0x5E, 0x5B, 0x58, 0x55, 0x52,
-    0x4F, 0x4D, 0x4A, 0x47, 0x44, 0x41, 0x3F, 0x3C,
-    0x39, 0x37, 0x34, 0x32, 0x2F, 0x2D, 0x2B, 0x28,
-    0x26, 0x24, 0x22, 0x20, 0x1E, 0x1C, 0x1A, 0x18,
-    0x16, 0x15, 0x13, 0x11, 0x10, 0x0F, 0x0D, 0x0C,
-    0x0B, 0x0A, 0x08, 0x07, 0x06, 0x06, 0x05, 0x04,
-    0x03, 0x03, 0x02, 0x02, 0x02, 0x01, 0x01, 0x01,
-    0x01, 0x01, 0x01, 0x01, 0x02, 0x02, 0x02, 0x03,
-    0x03, 0x04, 0x05, 0x06, 0x06, 0x07, 0x08, 0x0A,
-    0x0B, 0x0C, 0x0D, 0x0F, 0x10, 0x11, 0x13, 0x15,
-    0x16, 0x18, 0x1A, 0x1C, 0x1E, 0x20, 0x22, 0x24,
-    0x26, 0x28, 0x2B, 0x2D, 0x2F, 0x32, 0x34, 0x37,
-    0x39, 0x3C, 0x3F, 0x41, 0x44, 0x47, 0x4A, 0x4D,
-    0x4F, 0x52, 0x55, 0x58, 0x5B, 0x5E, 0x61, 0x64,
-    0x67, 0x6A, 0x6D, 0x70, 0x74, 0x77, 0x7A, 0x7D
-    // clang-format on
-};
-
-void wavegen_args(struct command_result* res) {
-    // all pins to output
+static struct _pio_config pio_config;
+static int data_channel = -1;
+static int ctrl_channel = -1;
+static const uint32_t* loop_addr;
+static bool running;
+static bool looping;
+static uint8_t driven;
+static uint32_t underruns;
+
+static void wavegen_release(void) {
+    int* channels[] = { &data_channel, &ctrl_channel };
+    for (uint32_t i = 0; i < count_of(channels); i++) {
+        if (*channels[i] >= 0) {
+            dma_channel_cleanup(*channels[i]);
+            dma_channel_unclaim(*channels[i]);
+            *channels[i] = -1;
+        }
+    }
+}
+
+bool wavegen_init(void) {
+    data_channel = dma_claim_unused_channel(false);
+    ctrl_channel = dma_claim_unused_channel(false);
+    if (data_channel < 0 || ctrl_channel < 0) {
+        wavegen_release();
+        return false;
+    }
+    pio_config.pio = PIO_MODE_PIO;
+    pio_config.sm = 0;
+    running = false;
+    return true;
+}
+
+void wavegen_cleanup(void) {
+    wavegen_stop();
+    wavegen_release();
+}
+
+uint8_t wavegen_pins(int8_t trigger) {
+    uint8_t mask = 0;
     for (uint8_t i = 0; i < 8; i++) {
-        bio_output(BIO0 + i);
-        // bio_put(BIO0+i, 1);
+        // respect any existing pin functions
+        if (system_config.pin_func[i + 1] == BP_PIN_IO && i != trigger) {
+            mask |= 1u << i;
+        }
     }
+    return mask;
+}
 
-    uint pio_loaded_offset = pio_add_program(pio0, &wavegen_program);
-    wavegen_program_init(pio0, 0, pio_loaded_offset, 8);
+static uint32_t wavegen_entry(const pattern_clock_t* clock, wavegen_trigger_t edge) {
+    if (clock->slow) {
+        return edge == WAVEGEN_TRIGGER_RISING    ? wavegen_slow_offset_rising
+               : edge == WAVEGEN_TRIGGER_FALLING ? wavegen_slow_offset_falling
+                                                 : wavegen_slow_offset_start;
+    }
+    return edge == WAVEGEN_TRIGGER_RISING    ? wavegen_offset_rising
+           : edge == WAVEGEN_TRIGGER_FALLING ? wavegen_offset_falling
+                                             : wavegen_offset_start;
+}
+
+bool wavegen_start(const uint32_t* words,
+                   uint32_t count,
+                   bool loop,
+                   const pattern_clock_t* clock,
+                   uint8_t mask,
+                   uint8_t trigger,
+                   wavegen_trigger_t edge) {
+    PIO pio = pio_config.pio;
+    uint sm = pio_config.sm;
+    uint base = bio2bufiopin[BIO0];
 
-    // set auto pull and 8 bits in and out...
+    pio_config.program = clock->slow ? &wavegen_slow_program : &wavegen_program;
+    if (!pio_can_add_program(pio, pio_config.program)) {
+        return false;
+    }
+    pio_config.offset = pio_add_program(pio, pio_config.program);
+#ifdef BP_PIO_SHOW_ASSIGNMENT
+    printf("PIO: pio=%d, sm=%d, offset=%d\r\n", PIO_NUM(pio), sm, pio_config.offset);
+#endif
+    wavegen_program_init(pio,
+                         sm,
+                         pio_config.offset,
+                         wavegen_entry(clock, edge),
+                         clock->slow,
+                         base,
+                         bio2bufiopin[edge == WAVEGEN_TRIGGER_NONE ? BIO0 : trigger],
+                         clock->div_int,
+                         clock->div_frac);
 
-    // write sin to output
+    // y is the delay loop count, then empty the OSR so the first out autopulls
+    pio_sm_put(pio, sm, clock->delay);
+    pio_sm_exec(pio, sm, pio_encode_pull(false, true));
+    pio_sm_exec(pio, sm, pio_encode_mov(pio_y, pio_osr));
+    pio_sm_exec(pio, sm, pio_encode_out(pio_null, 32));
+
+    if (edge != WAVEGEN_TRIGGER_NONE) {
+        bio_buf_input(trigger);
+        bio_input(trigger);
+    }
 
-    while (true) {
-        for (uint16_t i = 0; i < 256; i++) {
-            // pio_sm_put_blocking(pio0,0,sine_wave[i]);
-            pio_sm_put_blocking(pio0, 0, 0);
-            pio_sm_put_blocking(pio0, 0, 0x000000ff);
+    // the PIO takes over at the level the pins are at now, no glitch
+    uint32_t pins = (uint32_t)mask << base;
+    pio_sm_set_pins_with_mask(pio, sm, gpio_get_all(), pins);
+    pio_sm_set_pindirs_with_mask(pio, sm, pins, pins);
+    for (uint8_t i = 0; i < 8; i++) {
+        if (mask & (1u << i)) {
+            pio_gpio_init(pio, base + i);
+            bio_buf_output(i);
         }
     }
+    driven = mask;
+
+    dma_channel_config c = dma_channel_get_default_config(data_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
+    channel_config_set_chain_to(&c, loop ? ctrl_channel : data_channel);
+    dma_channel_configure(data_channel, &c, &pio->txf[sm], words, count, false);
+
+    if (loop) {
+        loop_addr = words;
+        dma_channel_config k = dma_channel_get_default_config(ctrl_channel);
+        channel_config_set_transfer_data_size(&k, DMA_SIZE_32);
+        channel_config_set_read_increment(&k, false);
+        channel_config_set_write_increment(&k, false);
+        dma_channel_configure(
+            ctrl_channel, &k, &dma_hw->ch[data_channel].al3_read_addr_trig, &loop_addr, 1, false);
+    }
 
-    // TODO: make this DMA to PIO/GPIO
+    looping = loop;
+    underruns = 0;
+    running = true;
+    dma_channel_start(data_channel);
+    // the FIFO fills before the first sample
+    while (!pio_sm_is_tx_fifo_full(pio, sm) && dma_channel_is_busy(data_channel)) {
+        tight_loop_contents();
+    }
+    pio->fdebug = 1u << (PIO_FDEBUG_TXSTALL_LSB + sm);
+    pio_sm_set_enabled(pio, sm, true);
+    return true;
+}
+
+bool wavegen_poll(void) {
+    if (!running) {
+        return false;
+    }
+    PIO pio = pio_config.pio;
+    uint sm = pio_config.sm;
+    uint32_t stall_mask = 1u << (PIO_FDEBUG_TXSTALL_LSB + sm);
+    // stall first, then busy: a stall seen with words still to move is an underrun
+    bool stalled = pio->fdebug & stall_mask;
+    bool busy = dma_channel_is_busy(data_channel);
+    if (stalled && (busy || looping)) {
+        underruns++;
+        pio->fdebug = stall_mask;
+        return true;
+    }
+    if (busy || looping) {
+        return true;
+    }
+    return !(stalled && pio_sm_is_tx_fifo_empty(pio, sm));
+}
+
+uint32_t wavegen_underruns(void) {
+    return underruns;
+}
+
+uint8_t wavegen_stop(void) {
+    uint base = bio2bufiopin[BIO0];
+    uint8_t levels = (uint8_t)(gpio_get_all() >> base);
+    if (!running) {
+        return levels;
+    }
+    PIO pio = pio_config.pio;
+    uint sm = pio_config.sm;
+    pio_sm_set_enabled(pio, sm, false);
+    levels = (uint8_t)(gpio_get_all() >> base);
+
+    // unchain first, an aborted channel can still trigger its chain
+    uint32_t channels = (1u << data_channel) | (1u << ctrl_channel);
+    dma_channel_config c = dma_get_channel_config(data_channel);
+    channel_config_set_chain_to(&c, data_channel);
+    dma_channel_set_config(data_channel, &c, false);
+    dma_hw->abort = channels;
+    while (dma_hw->abort & channels) {
+        tight_loop_contents();
+    }
+    pio_sm_clear_fifos(pio, sm);
+
+    // back to the CPU at the same level
+    for (uint8_t i = 0; i < 8; i++) {
+        if (driven & (1u << i)) {
+            bio_put(i, (levels >> i) & 1);
+            bio_output(i);
+            bio_set_function(i, GPIO_FUNC_SIO);
+        }
+    }
+    pio_sm_set_pindirs_with_mask(pio, sm, 0, (uint32_t)driven << base);
+    pio_remove_program(pio, pio_config.program, pio_config.offset);
+    running = false;
+    return levels;
 }
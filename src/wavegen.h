@@ -1,11 +1,71 @@
 /**
  * @file wavegen.h
- * @brief Waveform generator command interface.
- * @details Provides waveform generation command handler.
+ * @brief 8 bit parallel pattern generator on PIO with DMA.
+ * @details The wavegen PIO program writes one vector per sample to IO0-IO7,
+ *          four samples per 32 bit word. A single DMA run plays a buffer
+ *          once, or a second channel re-arms the first so the buffer loops
+ *          with no CPU involvement. Only pins assigned to IO (pin_func) are
+ *          driven, the rest keep their function. The output buffer comes
+ *          from lib/pattern, which also picks the program and divider.
  */
 
+#include "lib/pattern/pattern.h"
+
+typedef enum {
+    WAVEGEN_TRIGGER_NONE = 0,
+    WAVEGEN_TRIGGER_RISING,
+    WAVEGEN_TRIGGER_FALLING,
+} wavegen_trigger_t;
+
+/**
+ * @brief Claim two DMA channels.
+ * @return false if no DMA channels are free
+ */
+bool wavegen_init(void);
+
+/**
+ * @brief Stop and release the DMA channels.
+ */
+void wavegen_cleanup(void);
+
+/**
+ * @brief Pins the generator may drive: IO assigned, minus the trigger.
+ * @param trigger  BIO pin of the trigger input, or -1
+ */
+uint8_t wavegen_pins(int8_t trigger);
+
+/**
+ * @brief Load the program for the clock and start playing a buffer.
+ * @param words    output buffer, 4 samples per word
+ * @param count    words in the buffer
+ * @param loop     play it again forever
+ * @param clock    program and divider from pattern_clock()
+ * @param mask     pins to drive, from wavegen_pins()
+ * @param trigger  BIO pin to wait on, ignored with WAVEGEN_TRIGGER_NONE
+ * @param edge     edge to start on
+ * @return false if there is no room for the program
+ */
+bool wavegen_start(const uint32_t* words,
+                   uint32_t count,
+                   bool loop,
+                   const pattern_clock_t* clock,
+                   uint8_t mask,
+                   uint8_t trigger,
+                   wavegen_trigger_t edge);
+
+/**
+ * @brief Check on a run, call it in the wait loop.
+ * @return false once a single run has played out
+ */
+bool wavegen_poll(void);
+
+/**
+ * @brief Times the FIFO ran dry before the end of the buffer.
+ */
+uint32_t wavegen_underruns(void);
+
 /**
- * @brief Waveform generator argument handler.
- * @param res  Command result structure
+ * @brief Stop and hand the pins back to the CPU, holding their level.
+ * @return the vector on the pins
  */
-void wavegen_args(struct command_result* res);
\ No newline at end of file
+uint8_t wavegen_stop(void);
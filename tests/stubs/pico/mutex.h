@@ -0,0 +1,8 @@
+/* Stub: pico/mutex.h for host-side testing, FatFs sync objects */
+#ifndef _PICO_MUTEX_H
+#define _PICO_MUTEX_H
+typedef struct {
+    int locked;
+} mutex_t;
+/* ff_cre_syncobj() and friends provided by test harness */
+#endif
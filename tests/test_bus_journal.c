@@ -0,0 +1,522 @@
+/*
+ * test_bus_journal.c — Host-side tests for the syntax journal
+ *
+ * Checks the record encoder (RUN records, flags, the header slot), lost
+ * record accounting when the ring fills and that chunked drains write
+ * whole contiguous chunks. Parses the pcapng export block by block
+ * (lengths at both ends, 32 bit padding, interfaces and link types) and
+ * checks I2C messages, SPI frames and UART direction runs, timestamps
+ * across a timer wrap and records that go to the raw interface.
+ * Benchmarks a simulated syntax dispatch loop with the journal off and on.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_bus_journal test_bus_journal.c ../src/lib/bus_journal/bus_journal.c && ./test_bus_journal
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lib/bus_journal/bus_journal.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+#define RING_LEN 512
+#define CHUNK 256 // 4096 bytes
+#define OUT_SIZE 65536
+
+static bus_journal_record_t ring[RING_LEN];
+static bus_journal_t j;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t rng_state = 0x2545f491;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static struct _bytecode bc(uint8_t command, uint32_t out, uint32_t in) {
+    struct _bytecode b;
+    memset(&b, 0, sizeof(b));
+    b.command = command;
+    b.bits = 8;
+    b.out_data = out;
+    b.in_data = in;
+    return b;
+}
+
+typedef struct {
+    uint8_t buf[OUT_SIZE];
+    uint32_t len;
+    uint32_t writes;
+} sink_t;
+
+static sink_t sink;
+
+static uint32_t sink_write(void* ctx, const uint8_t* data, uint32_t len) {
+    sink_t* s = ctx;
+    if (s->len + len > OUT_SIZE) {
+        return 0;
+    }
+    memcpy(&s->buf[s->len], data, len);
+    s->len += len;
+    s->writes++;
+    return len;
+}
+
+// a USB FIFO with room for 100 bytes per call
+static uint32_t sink_partial(void* ctx, const uint8_t* data, uint32_t len) {
+    uint32_t* taken = ctx;
+    (void)data;
+    len = len < 100 ? len : 100;
+    *taken += len;
+    return len;
+}
+
+static void sink_reset(void) {
+    sink.len = 0;
+    sink.writes = 0;
+}
+
+/* ── pcapng reader ──────────────────────────────────────────────── */
+
+typedef struct {
+    uint32_t iface;
+    uint64_t time_us;
+    uint32_t len;
+    const uint8_t* data;
+    uint32_t flags; // epb_flags, 0 if absent
+    char comment[48];
+} packet_t;
+
+#define PACKETS_MAX 64
+
+typedef struct {
+    bool ok;
+    uint32_t idbs;
+    uint16_t linktype[8];
+    char if_name[8][16];
+    uint32_t n;
+    packet_t p[PACKETS_MAX];
+} capture_t;
+
+static capture_t cap;
+
+static uint32_t rd32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static uint16_t rd16(const uint8_t* p) {
+    uint16_t v;
+    memcpy(&v, p, 2);
+    return v;
+}
+
+// walk options from o to end, false if they overrun or are not padded
+static bool parse_options(const uint8_t* o, const uint8_t* end, uint32_t type, void* out) {
+    while (o + 4 <= end) {
+        uint16_t code = rd16(o);
+        uint16_t len = rd16(o + 2);
+        o += 4;
+        if (code == 0) {
+            return len == 0 && o == end;
+        }
+        if (o + ((len + 3u) & ~3u) > end) {
+            return false;
+        }
+        if (type == 1 && code == 2) {
+            char* name = out;
+            memcpy(name, o, len < 15 ? len : 15);
+            name[len < 15 ? len : 15] = 0;
+        }
+        if (type == 6 && code == 2) {
+            ((packet_t*)out)->flags = rd32(o);
+        }
+        if (type == 6 && code == 1) {
+            char* c = ((packet_t*)out)->comment;
+            memcpy(c, o, len < 47 ? len : 47);
+            c[len < 47 ? len : 47] = 0;
+        }
+        o += (len + 3u) & ~3u;
+    }
+    return o == end;
+}
+
+static void parse(const uint8_t* buf, uint32_t len) {
+    memset(&cap, 0, sizeof(cap));
+    cap.ok = true;
+    uint32_t pos = 0;
+    bool first = true;
+    while (pos < len) {
+        if (pos + 12 > len) {
+            cap.ok = false;
+            return;
+        }
+        uint32_t type = rd32(&buf[pos]);
+        uint32_t total = rd32(&buf[pos + 4]);
+        if ((total & 3) || total < 12 || pos + total > len || rd32(&buf[pos + total - 4]) != total) {
+            cap.ok = false;
+            return;
+        }
+        const uint8_t* b = &buf[pos + 8];
+        const uint8_t* end = &buf[pos + total - 4];
+        if (first) {
+            cap.ok &= type == 0x0a0d0d0a && rd32(b) == 0x1a2b3c4d && rd16(b + 4) == 1;
+            cap.ok &= parse_options(b + 16, end, type, NULL);
+            first = false;
+        } else if (type == 1) {
+            if (cap.idbs < 8) {
+                cap.linktype[cap.idbs] = rd16(b);
+                cap.ok &= parse_options(b + 8, end, type, cap.if_name[cap.idbs]);
+            }
+            cap.idbs++;
+        } else if (type == 6 && cap.n < PACKETS_MAX) {
+            packet_t* p = &cap.p[cap.n++];
+            p->iface = rd32(b);
+            p->time_us = ((uint64_t)rd32(b + 4) << 32) | rd32(b + 8);
+            p->len = rd32(b + 12);
+            cap.ok &= p->len == rd32(b + 16) && p->iface < cap.idbs;
+            p->data = b + 20;
+            cap.ok &= parse_options(b + 20 + ((p->len + 3) & ~3u), end, type, p);
+        } else {
+            cap.ok = false;
+        }
+        pos += total;
+    }
+}
+
+// the packets on one interface, in file order
+static packet_t* nth(uint32_t iface, uint32_t n) {
+    for (uint32_t i = 0; i < cap.n; i++) {
+        if (cap.p[i].iface == iface && n-- == 0) {
+            return &cap.p[i];
+        }
+    }
+    return NULL;
+}
+
+static uint32_t count(uint32_t iface) {
+    uint32_t c = 0;
+    for (uint32_t i = 0; i < cap.n; i++) {
+        c += cap.p[i].iface == iface;
+    }
+    return c;
+}
+
+static bool is(const packet_t* p, const uint8_t* data, uint32_t len) {
+    return p && p->len == len && !memcmp(p->data, data, len);
+}
+
+// journal a run and export it
+static void run(uint64_t time_us, bus_journal_proto_t proto, const struct _bytecode* b, uint32_t n) {
+    bus_journal_init(&j, ring, RING_LEN, false);
+    bus_journal_run(&j, time_us, 5, proto);
+    for (uint32_t i = 0; i < n; i++) {
+        bus_journal_add(&j, &b[i], (uint32_t)time_us + 10 * (i + 1));
+    }
+    static bus_journal_pcap_t p;
+    sink_reset();
+    bus_journal_pcap_begin(&p, sink_write, &sink);
+    for (uint32_t i = 0; i < bus_journal_level(&j); i++) {
+        bus_journal_pcap_record(&p, &ring[i]);
+    }
+    bus_journal_pcap_end(&p);
+    parse(sink.buf, sink.len);
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_records(void) {
+    bus_journal_init(&j, ring, RING_LEN, true);
+    const bus_journal_header_t* h = (const bus_journal_header_t*)&ring[0];
+    CHECK(bus_journal_level(&j) == 1 && bus_journal_header_check(h) && h->records == 0, "header in the first slot");
+
+    bus_journal_run(&j, 0x123456789aull, 7, BUS_JOURNAL_PROTO_SPI);
+    const bus_journal_record_t* r = &ring[1];
+    CHECK(r->command == BUS_JOURNAL_RUN && r->time_us == 0x3456789a && r->out_data == 0x12 &&
+              r->bits == BUS_JOURNAL_PROTO_SPI && r->mode == 7,
+          "run record carries the whole time and the protocol");
+
+    struct _bytecode b = bc(SYN_WRITE, 0xa5, 0x3c);
+    b.read_with_write = 1;
+    b.error = SERR_WARN;
+    b.bits = 12;
+    b.repeat = 3;
+    bus_journal_add(&j, &b, 1000);
+    r = &ring[2];
+    CHECK(r->time_us == 1000 && r->mode == 7 && r->command == SYN_WRITE && r->bits == 12 && r->out_data == 0xa5 &&
+              r->in_data == 0x3c,
+          "bytecode fields");
+    CHECK((r->flags & BUS_JOURNAL_ERROR_MASK) == SERR_WARN && (r->flags & BUS_JOURNAL_READ_WITH_WRITE) &&
+              !(r->flags & BUS_JOURNAL_LOST),
+          "error level and read with write in the flags");
+
+    bus_journal_header_t fin;
+    bus_journal_header(&j, &fin);
+    CHECK(fin.records == 2 && fin.lost == 0, "final header counts the records");
+    fin.version = 99;
+    CHECK(!bus_journal_header_check(&fin), "unknown version rejected");
+}
+
+static void test_lost(void) {
+    bus_journal_init(&j, ring, RING_LEN, false);
+    struct _bytecode b = bc(SYN_READ, 0, 0);
+    for (uint32_t i = 0; i < RING_LEN + 10; i++) {
+        b.in_data = i;
+        bus_journal_add(&j, &b, i);
+    }
+    CHECK(bus_journal_level(&j) == RING_LEN && j.lost == 10 && j.records == RING_LEN, "full ring drops and counts");
+    CHECK(ring[RING_LEN - 1].in_data == RING_LEN - 1, "the ring keeps the oldest records");
+
+    sink_reset();
+    bus_journal_drain(&j, CHUNK, sink_write, &sink);
+    b.in_data = 0xaa;
+    bus_journal_add(&j, &b, 0);
+    bus_journal_add(&j, &b, 0);
+    CHECK((ring[0].flags & BUS_JOURNAL_LOST) && !(ring[1].flags & BUS_JOURNAL_LOST),
+          "only the record after the gap is flagged");
+}
+
+static void test_drain(void) {
+    bus_journal_init(&j, ring, RING_LEN, true);
+    sink_reset();
+    struct _bytecode b = bc(SYN_WRITE, 0, 0);
+    uint32_t added = 0;
+    bool whole = true;
+    for (uint32_t round = 0; round < 40; round++) {
+        uint32_t n = 1 + rng() % 200;
+        for (uint32_t i = 0; i < n; i++) {
+            b.out_data = added++;
+            bus_journal_add(&j, &b, added);
+        }
+        uint32_t before = sink.len;
+        uint32_t writes = sink.writes;
+        bus_journal_drain(&j, CHUNK, sink_write, &sink);
+        // a chunk divides the ring, so a drain is whole chunks, one write each
+        whole &= (sink.len - before) % (CHUNK * 16) == 0 && sink.writes - writes == (sink.len - before) / (CHUNK * 16);
+    }
+    CHECK(j.lost == 0, "drained in time, nothing lost");
+    CHECK(whole && sink.len && sink.len % 4096 == 0, "drains are whole 4096 byte chunks");
+    CHECK(bus_journal_level(&j) < CHUNK, "drain leaves less than a chunk");
+    CHECK(bus_journal_header_check((const bus_journal_header_t*)sink.buf), "the file starts with the header");
+    CHECK(bus_journal_drain(&j, 1, sink_write, &sink) && bus_journal_level(&j) == 0 &&
+              sink.len == (added + 1) * sizeof(bus_journal_record_t),
+          "final drain writes the rest");
+    bool order = true;
+    for (uint32_t i = 0; i < added; i++) {
+        order &= ((const bus_journal_record_t*)sink.buf)[i + 1].out_data == i;
+    }
+    CHECK(order, "records come out in order");
+
+    for (uint32_t i = 0; i < 20; i++) {
+        bus_journal_add(&j, &b, 0);
+    }
+    uint32_t taken = 0;
+    CHECK(!bus_journal_drain(&j, 1, sink_partial, &taken) && bus_journal_level(&j) == 20 - 100 / 16,
+          "partial write keeps the rest");
+}
+
+static void test_pcap_layout(void) {
+    struct _bytecode b[] = { bc(SYN_DELAY_US, 0, 0) };
+    run(0, BUS_JOURNAL_PROTO_OTHER, b, 1);
+    CHECK(cap.ok, "blocks well formed");
+    CHECK(cap.idbs == BUS_JOURNAL_PROTO_COUNT && cap.linktype[BUS_JOURNAL_PROTO_I2C] == 209 &&
+              cap.linktype[BUS_JOURNAL_PROTO_SPI] == 147 && cap.linktype[BUS_JOURNAL_PROTO_UART] == 148 &&
+              cap.linktype[BUS_JOURNAL_PROTO_OTHER] == 149,
+          "an interface per protocol with its link type");
+    CHECK(!strcmp(cap.if_name[BUS_JOURNAL_PROTO_SPI], "SPI"), "interface names");
+    CHECK(count(BUS_JOURNAL_PROTO_OTHER) == 2 && nth(BUS_JOURNAL_PROTO_OTHER, 1)->len == sizeof(bus_journal_record_t),
+          "run and delay as raw records");
+}
+
+static void test_i2c(void) {
+    struct _bytecode b[] = {
+        bc(SYN_START, 0, 0), bc(SYN_WRITE, 0xa0, 0), bc(SYN_WRITE, 0x00, 0),  bc(SYN_START, 0, 0),
+        bc(SYN_WRITE, 0xa1, 0), bc(SYN_READ, 0, 0x55),  bc(SYN_READ, 0, 0x66), bc(SYN_STOP, 0, 0),
+    };
+    run(1000, BUS_JOURNAL_PROTO_I2C, b, 8);
+    CHECK(cap.ok && count(BUS_JOURNAL_PROTO_I2C) == 2, "restart splits the messages");
+    static const uint8_t w[] = { 0, 0, 0, 0, 0, 0xa0, 0x00 };
+    static const uint8_t r[] = { 0, 0, 0, 0, 0, 0xa1, 0x55, 0x66 };
+    packet_t* p0 = nth(BUS_JOURNAL_PROTO_I2C, 0);
+    packet_t* p1 = nth(BUS_JOURNAL_PROTO_I2C, 1);
+    CHECK(is(p0, w, sizeof(w)) && p0->flags == 2, "write message, pseudo header then address, outbound");
+    CHECK(is(p1, r, sizeof(r)) && p1->flags == 1, "read message is inbound");
+    CHECK(p0->time_us == 1020 && p1->time_us == 1050, "message time is its first byte");
+    CHECK(count(BUS_JOURNAL_PROTO_OTHER) == 1, "only the run record is raw");
+}
+
+static void test_spi(void) {
+    struct _bytecode b[] = {
+        bc(SYN_START, 0, 0), bc(SYN_WRITE, 0x9f, 0xff), bc(SYN_READ, 0, 0xef), bc(SYN_DELAY_US, 0, 0),
+        bc(SYN_READ, 0, 0x40), bc(SYN_STOP, 0, 0),      bc(SYN_WRITE, 0x06, 0x00),
+    };
+    b[1].read_with_write = 1;
+    run(0, BUS_JOURNAL_PROTO_SPI, b, 7);
+    static const uint8_t mosi[] = { 0x9f, 0xff, 0xff };
+    static const uint8_t miso[] = { 0xff, 0xef, 0x40 };
+    static const uint8_t mosi2[] = { 0x06 };
+    CHECK(cap.ok && count(BUS_JOURNAL_PROTO_SPI) == 4, "a MOSI and a MISO packet per frame");
+    CHECK(is(nth(BUS_JOURNAL_PROTO_SPI, 0), mosi, 3) && nth(BUS_JOURNAL_PROTO_SPI, 0)->flags == 2, "MOSI outbound");
+    CHECK(is(nth(BUS_JOURNAL_PROTO_SPI, 1), miso, 3) && nth(BUS_JOURNAL_PROTO_SPI, 1)->flags == 1, "MISO inbound");
+    CHECK(is(nth(BUS_JOURNAL_PROTO_SPI, 2), mosi2, 1), "bytes outside CS flushed at the end");
+    CHECK(count(BUS_JOURNAL_PROTO_OTHER) == 2, "delay inside the frame is raw");
+
+    // 16 bit values, MSB first
+    struct _bytecode w = bc(SYN_WRITE, 0x1234, 0xabcd);
+    w.bits = 16;
+    run(0, BUS_JOURNAL_PROTO_SPI, &w, 1);
+    static const uint8_t wide[] = { 0x12, 0x34 };
+    CHECK(is(nth(BUS_JOURNAL_PROTO_SPI, 0), wide, 2), "wide values MSB first");
+
+    // long frames are cut at the packet size
+    static struct _bytecode many[300];
+    for (uint32_t i = 0; i < 300; i++) {
+        many[i] = bc(SYN_WRITE, i & 0xff, 0);
+    }
+    run(0, BUS_JOURNAL_PROTO_SPI, many, 300);
+    CHECK(cap.ok && count(BUS_JOURNAL_PROTO_SPI) == 4 && nth(BUS_JOURNAL_PROTO_SPI, 0)->len == BUS_JOURNAL_PACKET_MAX &&
+              nth(BUS_JOURNAL_PROTO_SPI, 2)->len == 300 - BUS_JOURNAL_PACKET_MAX,
+          "long frame cut into packets");
+}
+
+static void test_uart(void) {
+    struct _bytecode b[] = {
+        bc(SYN_WRITE, 'A', 0), bc(SYN_WRITE, 'T', 0), bc(SYN_READ, 0, 'O'),
+        bc(SYN_READ, 0, 'K'),  bc(SYN_WRITE, '\r', 0), bc(SYN_READ, 0, 0),
+    };
+    b[5].error = SERR_ERROR; // nothing in the FIFO
+    run(0, BUS_JOURNAL_PROTO_UART, b, 6);
+    CHECK(cap.ok && count(BUS_JOURNAL_PROTO_UART) == 3, "a packet per direction run");
+    CHECK(is(nth(BUS_JOURNAL_PROTO_UART, 0), (const uint8_t*)"AT", 2) && nth(BUS_JOURNAL_PROTO_UART, 0)->flags == 2,
+          "TX");
+    CHECK(is(nth(BUS_JOURNAL_PROTO_UART, 1), (const uint8_t*)"OK", 2) && nth(BUS_JOURNAL_PROTO_UART, 1)->flags == 1,
+          "RX");
+    packet_t* e = nth(BUS_JOURNAL_PROTO_OTHER, 1);
+    CHECK(e && !strcmp(e->comment, "error"), "failed read goes raw with a comment");
+}
+
+static void test_time(void) {
+    // the run starts just before the 32 bit timer wraps
+    uint64_t start = 0x1fffffff0ull;
+    struct _bytecode b[] = { bc(SYN_WRITE, 1, 0), bc(SYN_READ, 0, 2) };
+    run(start, BUS_JOURNAL_PROTO_UART, b, 2);
+    CHECK(nth(BUS_JOURNAL_PROTO_OTHER, 0)->time_us == start, "run time");
+    CHECK(nth(BUS_JOURNAL_PROTO_UART, 0)->time_us == start + 10 && nth(BUS_JOURNAL_PROTO_UART, 1)->time_us == start + 20,
+          "record times unwrapped across the timer wrap");
+
+    // lost records are marked on the packet after the gap
+    bus_journal_init(&j, ring, 4, false);
+    bus_journal_run(&j, 0, 0, BUS_JOURNAL_PROTO_UART);
+    for (uint32_t i = 0; i < 5; i++) {
+        bus_journal_add(&j, &b[0], i);
+    }
+    j.tail = j.head; // drained
+    bus_journal_add(&j, &b[1], 9);
+    static bus_journal_pcap_t p;
+    sink_reset();
+    bus_journal_pcap_begin(&p, sink_write, &sink);
+    bus_journal_pcap_record(&p, &ring[(j.head - 1) & 3]);
+    CHECK(bus_journal_pcap_end(&p), "export ends clean");
+    parse(sink.buf, sink.len);
+    CHECK(cap.ok && cap.n == 1 && !strcmp(cap.p[0].comment, "records lost before this packet"), "lost comment");
+}
+
+/* ── Benchmark ──────────────────────────────────────────────────── */
+
+// a protocol handler that does a little work, like a PIO FIFO write
+static volatile uint32_t bus_reg;
+
+static void __attribute__((noinline)) protocol_write(struct _bytecode* b) {
+    bus_reg = b->out_data;
+    b->in_data = bus_reg ^ 0x5a;
+}
+
+static bool journal_on;
+
+static uint32_t file_write(void* ctx, const uint8_t* data, uint32_t len) {
+    fwrite(data, 1, len, (FILE*)ctx);
+    return len;
+}
+
+static void bench(void) {
+    enum { PROGRAM = 256, RUNS = 20000 };
+    static struct _bytecode program[PROGRAM];
+    for (uint32_t i = 0; i < PROGRAM; i++) {
+        program[i] = bc(SYN_WRITE, rng() & 0xff, 0);
+    }
+    FILE* f = tmpfile();
+    if (!f) {
+        return;
+    }
+    double t_off = 0;
+    for (int on = 0; on < 2; on++) {
+        journal_on = on;
+        bus_journal_init(&j, ring, RING_LEN, true);
+        uint32_t time_us = 0;
+        double t0 = now_s();
+        for (uint32_t run = 0; run < RUNS; run++) {
+            if (journal_on) {
+                bus_journal_run(&j, time_us, 5, BUS_JOURNAL_PROTO_SPI);
+            }
+            for (uint32_t i = 0; i < PROGRAM; i++) {
+                protocol_write(&program[i]);
+                if (journal_on) {
+                    bus_journal_add(&j, &program[i], time_us++);
+                }
+            }
+            // after the run, like the main loop
+            if (journal_on) {
+                bus_journal_drain(&j, CHUNK, file_write, f);
+            }
+        }
+        double t = (now_s() - t0) / ((double)RUNS * PROGRAM);
+        if (!on) {
+            t_off = t;
+        }
+        printf("dispatch, journal %-3s: %6.1f ns per bytecode\n", on ? "on" : "off", t * 1e9);
+        if (on) {
+            printf("journal overhead:      %6.1f ns per bytecode, %u lost\n", (t - t_off) * 1e9, j.lost);
+        }
+    }
+    fclose(f);
+}
+
+int main(void) {
+    printf("=== bus_journal tests ===\n\n");
+    test_records();
+    test_lost();
+    test_drain();
+    test_pcap_layout();
+    test_i2c();
+    test_spi();
+    test_uart();
+    test_time();
+    printf("\n");
+    bench();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
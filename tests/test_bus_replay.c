@@ -0,0 +1,700 @@
+/*
+ * test_bus_replay.c — Host-side tests for sniffer recordings and replay
+ *
+ * Recordings are generated from a script of I2C operations against a
+ * simulated EEPROM-like device, with event times worked out from the
+ * hwi2c.pio cycle counts plus the gaps the script asks for. The replay
+ * blocks are then run through a simulated hwi2c PIO: it executes the
+ * escape words (tracking SCL/SDA to find START, repeated START and STOP),
+ * clocks data words against a second copy of the device, and keeps time
+ * in PIO cycles, starting each block when the block says or when the one
+ * before ends. That gives the bus sequence, the RX words and the time
+ * every element ended, which are checked against the recording.
+ *
+ * Checks the file format (round trip, varint edges, truncation, bad
+ * headers, a full buffer), the I2C sequence and RX compare, gap accuracy,
+ * long gaps left to the CPU, time scaling and lateness, blocks split by
+ * small buffers and recordings cut mid transaction.
+ *
+ * The benchmark compiles a long recording and reports events/s.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_bus_replay test_bus_replay.c ../src/lib/bus_replay/bus_replay.c && ./test_bus_replay
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lib/bus_replay/bus_replay.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+// stand-ins for the assembled set_scl_sda instructions and nop [7]
+static const uint16_t inst[4] = { 0xe700, 0xe701, 0xf700, 0xf701 };
+#define DELAY_INST 0xa742
+
+#define PIO_HZ (32 * 400000)
+
+static uint32_t rng = 0x13579bdf;
+
+static uint32_t xorshift(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/* ── Simulated device ───────────────────────────────────────────── */
+
+#define DEV_ADDR 0x50
+
+typedef struct {
+    uint8_t addr;
+    uint8_t mem[256];
+    uint8_t ptr;
+    bool addr_phase, selected, reading, have_ptr;
+} sim_dev_t;
+
+static void dev_init(sim_dev_t* d) {
+    memset(d, 0, sizeof(*d));
+    d->addr = DEV_ADDR;
+    for (int i = 0; i < 256; i++) {
+        d->mem[i] = i * 7 + 3;
+    }
+}
+
+static void dev_start(sim_dev_t* d) {
+    d->addr_phase = true;
+    d->selected = false;
+}
+
+// one byte on the bus: what the master drove (0xff to read) and its ACK bit,
+// returns the RX word, (byte on the bus << 1) | ACK bit on the bus
+static uint16_t dev_byte(sim_dev_t* d, uint8_t master, bool master_nack) {
+    if (d->addr_phase) {
+        d->addr_phase = false;
+        d->selected = (master >> 1) == d->addr;
+        d->reading = master & 1;
+        d->have_ptr = false;
+        return (master << 1) | !d->selected;
+    }
+    if (!d->selected) {
+        return (master << 1) | 1;
+    }
+    if (d->reading) {
+        uint8_t v = master & d->mem[d->ptr++];
+        return (v << 1) | master_nack;
+    }
+    if (!d->have_ptr) {
+        d->ptr = master;
+        d->have_ptr = true;
+    } else {
+        d->mem[d->ptr++] = master;
+    }
+    return master << 1;
+}
+
+/* ── Recording generator ────────────────────────────────────────── */
+
+#define GEN_MAX_EVENTS 40000
+
+static uint8_t rec_buf[512 * 1024];
+static uint32_t rec_len;
+static brp_rec_t rec;
+static sim_dev_t gen_dev;
+static double gen_t;  // us, PIO cycles at PIO_HZ converted
+static bool gen_open; // inside a transaction
+
+static struct {
+    uint8_t type;
+    uint32_t t_us;
+} gen_ev[GEN_MAX_EVENTS];
+static uint32_t gen_n;
+
+static void gen_init(void) {
+    dev_init(&gen_dev);
+    brp_rec_init(&rec, rec_buf, sizeof(rec_buf), BRP_BUS_I2C, 400000, 1000);
+    gen_t = 1000;
+    gen_open = false;
+    gen_n = 0;
+}
+
+static void gen_event(uint8_t type, uint32_t cycles, uint8_t data, bool nack) {
+    gen_t += cycles * 1e6 / PIO_HZ;
+    brp_event_t e = { .type = type, .nack = nack, .data = data, .t_us = (uint32_t)(gen_t + 0.5) };
+    brp_rec_event(&rec, &e);
+    if (gen_n < GEN_MAX_EVENTS) {
+        gen_ev[gen_n].type = type;
+        gen_ev[gen_n].t_us = e.t_us;
+        gen_n++;
+    }
+}
+
+static void gen_gap(double us) {
+    gen_t += us;
+}
+
+static void gen_start(void) {
+    gen_event(BRP_EV_START, gen_open ? BRP_I2C_RESTART_CYCLES : I2C_SCAN_START_CYCLES, 0, false);
+    gen_open = true;
+    dev_start(&gen_dev);
+}
+
+static void gen_stop(void) {
+    gen_event(BRP_EV_STOP, I2C_SCAN_STOP_CYCLES, 0, false);
+    gen_open = false;
+}
+
+static void gen_write_byte(uint8_t b) {
+    uint16_t rx = dev_byte(&gen_dev, b, true);
+    gen_event(BRP_EV_DATA, I2C_SCAN_BYTE_CYCLES, rx >> 1, rx & 1);
+}
+
+static void gen_read_byte(bool last) {
+    uint16_t rx = dev_byte(&gen_dev, 0xff, last);
+    gen_event(BRP_EV_DATA, I2C_SCAN_BYTE_CYCLES, rx >> 1, rx & 1);
+}
+
+// register write: S addr reg data... P, with gap_us between the elements
+static void gen_write(uint8_t reg, uint32_t n, double gap_us) {
+    gen_start();
+    gen_gap(gap_us);
+    gen_write_byte(DEV_ADDR << 1);
+    gen_gap(gap_us);
+    gen_write_byte(reg);
+    for (uint32_t i = 0; i < n; i++) {
+        gen_gap(gap_us);
+        gen_write_byte(xorshift());
+    }
+    gen_gap(gap_us);
+    gen_stop();
+}
+
+// register read: S addr reg Sr addr|1 data... P
+static void gen_read(uint8_t reg, uint32_t n, double gap_us) {
+    gen_start();
+    gen_gap(gap_us);
+    gen_write_byte(DEV_ADDR << 1);
+    gen_gap(gap_us);
+    gen_write_byte(reg);
+    gen_gap(gap_us);
+    gen_start();
+    gen_gap(gap_us);
+    gen_write_byte((DEV_ADDR << 1) | 1);
+    for (uint32_t i = 0; i < n; i++) {
+        gen_gap(gap_us);
+        gen_read_byte(i == n - 1);
+    }
+    gen_gap(gap_us);
+    gen_stop();
+}
+
+static void gen_finish(void) {
+    rec_len = brp_rec_finish(&rec);
+}
+
+/* ── Simulated hwi2c PIO ────────────────────────────────────────── */
+
+#define SIM_MAX_EVENTS (GEN_MAX_EVENTS + 16)
+
+static struct {
+    sim_dev_t dev;
+    bool scl, sda;
+    uint64_t now; // cycles
+    // what came out
+    struct {
+        uint8_t type;
+        uint8_t data; // master's byte
+        uint16_t rx;
+        uint64_t end; // cycles
+    } ev[SIM_MAX_EVENTS];
+    uint32_t n;
+    uint32_t blocks, delay_words;
+} sim;
+
+static void sim_init(void) {
+    memset(&sim, 0, sizeof(sim));
+    dev_init(&sim.dev);
+    sim.scl = sim.sda = true;
+}
+
+static void sim_push(uint8_t type, uint8_t data, uint16_t rx) {
+    if (sim.n < SIM_MAX_EVENTS) {
+        sim.ev[sim.n].type = type;
+        sim.ev[sim.n].data = data;
+        sim.ev[sim.n].rx = rx;
+        sim.ev[sim.n].end = sim.now;
+        sim.n++;
+    }
+}
+
+static void sim_exec(uint16_t w) {
+    sim.now += BRP_I2C_EXEC_CYCLES;
+    if (w == DELAY_INST) {
+        sim.delay_words++;
+        return;
+    }
+    for (int i = 0; i < 4; i++) {
+        if (w == inst[i]) {
+            bool scl = i >= BRP_SC1_SD0, sda = i & 1;
+            if (sim.scl && scl && sim.sda && !sda) {
+                sim_push(BRP_EV_START, 0, 0);
+                dev_start(&sim.dev);
+            } else if (sim.scl && scl && !sim.sda && sda) {
+                sim_push(BRP_EV_STOP, 0, 0);
+            }
+            sim.scl = scl;
+            sim.sda = sda;
+            return;
+        }
+    }
+}
+
+// runs a block, fills rx, returns false on a malformed stream
+static bool sim_block(const uint16_t* tx, uint32_t tx_len, uint16_t* rx, uint32_t rx_len, uint32_t start_us) {
+    uint64_t start = (uint64_t)start_us * PIO_HZ / 1000000;
+    if (start > sim.now) {
+        sim.now = start;
+    }
+    uint32_t nrx = 0;
+    for (uint32_t i = 0; i < tx_len; i++) {
+        uint16_t w = tx[i];
+        uint32_t instr = w >> 10;
+        if (instr) {
+            if (i + instr + 1 >= tx_len) {
+                return false;
+            }
+            sim.now += BRP_I2C_ESCAPE_CYCLES;
+            uint32_t first = sim.n;
+            for (uint32_t k = 0; k <= instr; k++) {
+                sim_exec(tx[++i]);
+            }
+            // START/STOP are timed at the end of their sequence
+            for (uint32_t k = first; k < sim.n; k++) {
+                sim.ev[k].end = sim.now;
+            }
+        } else {
+            sim.now += I2C_SCAN_BYTE_CYCLES;
+            uint16_t r = dev_byte(&sim.dev, (w >> 1) & 0xff, w & 1);
+            sim.scl = false;
+            sim.sda = r & 1;
+            if (nrx < rx_len) {
+                rx[nrx] = r;
+            }
+            nrx++;
+            sim_push(BRP_EV_DATA, (w >> 1) & 0xff, r);
+        }
+    }
+    sim.blocks++;
+    return nrx == rx_len;
+}
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+#define TX_CAP 4096
+#define RX_CAP 1024
+
+static uint16_t tx[TX_CAP];
+static uint16_t rxw[RX_CAP];
+static brp_expect_t expect[RX_CAP];
+static brp_i2c_t comp;
+
+typedef struct {
+    uint32_t scale, gap_us, tx_cap, rx_cap;
+} replay_opts_t;
+
+static replay_opts_t opts(uint32_t scale) {
+    replay_opts_t o = { scale, 200, TX_CAP, RX_CAP };
+    return o;
+}
+
+// compile and run the whole recording, returns RX mismatches or -1 on a bad stream
+static int replay(const uint8_t* buf, uint32_t len, replay_opts_t o) {
+    brp_i2c_cfg_t cfg = {
+        .pio_hz = PIO_HZ,
+        .scale_pct = o.scale,
+        .cpu_gap_us = o.gap_us,
+        .inst = inst,
+        .delay_inst = DELAY_INST,
+    };
+    brp_i2c_init(&comp, buf, len, &cfg);
+    sim_init();
+    brp_block_t b;
+    int mismatches = 0;
+    while (brp_i2c_next(&comp, tx, o.tx_cap, expect, o.rx_cap, &b)) {
+        if (b.tx_len > o.tx_cap || b.rx_len > o.rx_cap || !sim_block(tx, b.tx_len, rxw, b.rx_len, b.start_us)) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < b.rx_len; i++) {
+            if (rxw[i] != expect[i].expect) {
+                mismatches++;
+            }
+        }
+    }
+    return mismatches;
+}
+
+// the bus sequence matches the recording, element for element
+static bool same_sequence(void) {
+    if (sim.n != gen_n) {
+        return false;
+    }
+    for (uint32_t i = 0; i < gen_n; i++) {
+        if (sim.ev[i].type != gen_ev[i].type) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// largest |replay end - recorded end| in us, recorded times scaled
+static double worst_error_us(uint32_t scale) {
+    double worst = 0;
+    for (uint32_t i = 0; i < gen_n && i < sim.n; i++) {
+        double want = (double)(gen_ev[i].t_us - gen_ev[0].t_us) * scale / 100;
+        double got = (double)sim.ev[i].end * 1e6 / PIO_HZ;
+        double err = got > want ? got - want : want - got;
+        if (err > worst) {
+            worst = err;
+        }
+    }
+    return worst;
+}
+
+// delay granularity plus rounding to the microsecond on both sides
+#define TOLERANCE_US (BRP_I2C_DELAY_MIN * 1e6 / PIO_HZ + 2.0)
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_format(void) {
+    static uint8_t buf[256];
+    brp_rec_t r;
+    brp_rec_init(&r, buf, sizeof(buf), BRP_BUS_SPI, 1000000, 0xfffffff0);
+    // varint edges, the clock wrapping between events
+    const uint32_t deltas[] = { 0, 127, 128, 16383, 16384, 2097151, 2097152, 0xffffffff, 5 };
+    uint32_t t = 0xfffffff0;
+    for (uint32_t i = 0; i < sizeof(deltas) / sizeof(deltas[0]); i++) {
+        t += deltas[i];
+        brp_event_t e = { .type = (i % 3) ? BRP_EV_XFER : BRP_EV_SELECT, .data = i, .miso = 0xa0 + i, .t_us = t };
+        CHECK(brp_rec_event(&r, &e), "event fits");
+    }
+    brp_event_t e = { .type = BRP_EV_DATA, .nack = true, .data = 0x5a, .t_us = t + 1 };
+    brp_rec_event(&r, &e);
+    uint32_t len = brp_rec_finish(&r);
+    CHECK(!memcmp(buf, "BPRC", 4) && buf[4] == BRP_VERSION && buf[5] == BRP_BUS_SPI, "header");
+    CHECK(len == r.len && r.events == 10, "length and count");
+
+    brp_reader_t rd;
+    CHECK(brp_reader_init(&rd, buf, len), "reader accepts it");
+    CHECK(rd.hdr.bus == BRP_BUS_SPI && rd.hdr.bus_hz == 1000000 && rd.hdr.events == 10, "header fields");
+    uint32_t want = 0;
+    bool ok = true;
+    for (uint32_t i = 0; i < 9; i++) {
+        brp_event_t g;
+        want += deltas[i];
+        ok &= brp_read_event(&rd, &g);
+        ok &= g.t_us == want;
+        ok &= g.type == ((i % 3) ? BRP_EV_XFER : BRP_EV_SELECT);
+        if (g.type == BRP_EV_XFER) {
+            ok &= g.data == i && g.miso == 0xa0 + i;
+        }
+    }
+    CHECK(ok, "events and times come back");
+    brp_event_t g;
+    CHECK(brp_read_event(&rd, &g) && g.type == BRP_EV_DATA && g.nack && g.data == 0x5a, "nack flag and data");
+    CHECK(!brp_read_event(&rd, &g) && !rd.bad, "clean end");
+
+    // cut anywhere inside the records: never a crash, always flagged
+    bool flagged = true;
+    for (uint32_t cut = BRP_HEADER_BYTES; cut < len; cut++) {
+        brp_reader_init(&rd, buf, cut);
+        while (brp_read_event(&rd, &g)) {
+        }
+        flagged &= rd.bad;
+    }
+    CHECK(flagged, "truncation flagged at every length");
+
+    uint8_t bad[BRP_HEADER_BYTES];
+    memcpy(bad, buf, sizeof(bad));
+    bad[0] = 'X';
+    CHECK(!brp_reader_init(&rd, bad, sizeof(bad)), "bad magic");
+    memcpy(bad, buf, sizeof(bad));
+    bad[4] = 2;
+    CHECK(!brp_reader_init(&rd, bad, sizeof(bad)), "unknown version");
+    memcpy(bad, buf, sizeof(bad));
+    bad[5] = 9;
+    CHECK(!brp_reader_init(&rd, bad, sizeof(bad)), "unknown bus");
+    CHECK(!brp_reader_init(&rd, buf, 10), "short header");
+
+    memcpy(bad, buf, sizeof(bad));
+    uint8_t junk[BRP_HEADER_BYTES + 2];
+    memcpy(junk, bad, BRP_HEADER_BYTES);
+    junk[BRP_HEADER_BYTES] = 0x0f;
+    junk[BRP_HEADER_BYTES + 1] = 0;
+    brp_reader_init(&rd, junk, sizeof(junk));
+    CHECK(!brp_read_event(&rd, &g) && rd.bad, "unknown record type");
+
+    // a full buffer stops the recording, what is there stays readable
+    // 3 byte records, first delta 0, then 5 with 1 s deltas
+    uint8_t small[BRP_HEADER_BYTES + 3 + 5 + 5 + 4];
+    brp_rec_init(&r, small, sizeof(small), BRP_BUS_I2C, 0, 0);
+    uint32_t stored = 0;
+    for (uint32_t i = 0; i < 10; i++) {
+        brp_event_t d = { .type = BRP_EV_DATA, .data = i, .t_us = i * 1000000 };
+        stored += brp_rec_event(&r, &d);
+    }
+    len = brp_rec_finish(&r);
+    CHECK(r.full && stored == 3, "full buffer");
+    brp_reader_init(&rd, small, len);
+    uint32_t n = 0;
+    while (brp_read_event(&rd, &g)) {
+        n++;
+    }
+    CHECK(n == 3 && !rd.bad, "full recording reads back");
+}
+
+static void test_i2c_sequence(void) {
+    gen_init();
+    gen_write(0x10, 4, 50);
+    gen_gap(100);
+    gen_read(0x10, 4, 20);
+    gen_gap(30);
+    gen_read(0x80, 1, 0);
+    // nobody at 0x51
+    gen_gap(40);
+    gen_start();
+    gen_write_byte(0x51 << 1);
+    gen_stop();
+    gen_finish();
+
+    int mm = replay(rec_buf, rec_len, opts(100));
+    CHECK(mm == 0, "replay matches the recording");
+    CHECK(same_sequence(), "same START/Sr/data/STOP sequence");
+    CHECK(comp.skipped == 0 && comp.late == 0, "nothing skipped or late");
+
+    // read bytes are clocked with 0xff, written ones as recorded
+    uint32_t read_bytes = 0;
+    for (uint32_t i = 0; i < sim.n; i++) {
+        read_bytes += sim.ev[i].type == BRP_EV_DATA && sim.ev[i].data == 0xff;
+    }
+    CHECK(read_bytes == 5, "read bytes sent as 0xff");
+
+    // the device holds different data now: the read shows it
+    gen_init();
+    gen_read(0x20, 2, 10);
+    gen_finish();
+    brp_i2c_cfg_t cfg = { PIO_HZ, 100, 200, inst, DELAY_INST };
+    brp_i2c_init(&comp, rec_buf, rec_len, &cfg);
+    sim_init();
+    sim.dev.mem[0x21] ^= 0x40;
+    brp_block_t b;
+    int mismatches = 0;
+    uint32_t first_event = 0;
+    while (brp_i2c_next(&comp, tx, TX_CAP, expect, RX_CAP, &b)) {
+        sim_block(tx, b.tx_len, rxw, b.rx_len, b.start_us);
+        for (uint32_t i = 0; i < b.rx_len; i++) {
+            if (rxw[i] != expect[i].expect && !mismatches++) {
+                first_event = expect[i].event;
+            }
+        }
+    }
+    // S addr reg Sr addr data data P
+    CHECK(mismatches == 1 && first_event == 6, "changed byte reported against its event");
+
+    // a device that is not there: the missing ACK is a mismatch on the address
+    gen_init();
+    gen_write(0x00, 1, 10);
+    gen_finish();
+    brp_i2c_init(&comp, rec_buf, rec_len, &cfg);
+    sim_init();
+    sim.dev.addr = 0x51;
+    mismatches = 0;
+    while (brp_i2c_next(&comp, tx, TX_CAP, expect, RX_CAP, &b)) {
+        sim_block(tx, b.tx_len, rxw, b.rx_len, b.start_us);
+        for (uint32_t i = 0; i < b.rx_len; i++) {
+            if (rxw[i] != expect[i].expect && !mismatches++) {
+                first_event = expect[i].event;
+            }
+        }
+    }
+    CHECK(mismatches == 3 && first_event == 1, "NACK reported against the address event");
+}
+
+static void test_i2c_timing(void) {
+    gen_init();
+    for (int i = 0; i < 200; i++) {
+        uint32_t r = xorshift() % 10;
+        double gap = r < 6 ? xorshift() % 50 : r < 9 ? xorshift() % 150 : 300 + xorshift() % 5000;
+        gen_gap(gap);
+        if (xorshift() & 1) {
+            gen_write(xorshift(), 1 + xorshift() % 6, xorshift() % 40);
+        } else {
+            gen_read(xorshift(), 1 + xorshift() % 6, xorshift() % 40);
+        }
+    }
+    gen_finish();
+
+    CHECK(replay(rec_buf, rec_len, opts(100)) == 0, "random traffic matches");
+    CHECK(same_sequence(), "random traffic sequence");
+    double err = worst_error_us(100);
+    CHECK(err <= TOLERANCE_US, "every element within the delay granularity");
+    printf("  200 transactions, %u blocks, worst error %.2f us (%.2f us allowed)\n", comp.blocks, err, TOLERANCE_US);
+    CHECK(comp.late == 0, "nothing late at the recorded speed");
+    CHECK(comp.blocks > comp.splits + 1, "long gaps end blocks");
+    CHECK(sim.delay_words > 0 && comp.delay_words > sim.delay_words, "delay words counted");
+
+    // no gap left to the CPU: blocks only end when the buffer is full
+    replay_opts_t o = opts(100);
+    o.gap_us = 1000000;
+    CHECK(replay(rec_buf, rec_len, o) == 0 && comp.blocks == comp.splits + 1, "no CPU gaps, buffer sized blocks");
+    CHECK(worst_error_us(100) <= TOLERANCE_US, "one block timing");
+}
+
+static void test_i2c_scaling(void) {
+    gen_init();
+    for (int i = 0; i < 50; i++) {
+        gen_gap(100 + xorshift() % 400);
+        gen_read(xorshift(), 2, 20);
+    }
+    gen_finish();
+
+    CHECK(replay(rec_buf, rec_len, opts(200)) == 0, "2x slower matches");
+    CHECK(worst_error_us(200) <= TOLERANCE_US && comp.late == 0, "2x slower timing");
+
+    // twice as fast: the gaps halve, the elements can't
+    CHECK(replay(rec_buf, rec_len, opts(50)) == 0, "2x faster matches");
+    CHECK(comp.late > 0 && comp.late_max_us > 0, "elements that can't keep up are late");
+    bool ordered = true;
+    for (uint32_t i = 1; i < sim.n; i++) {
+        ordered &= sim.ev[i].end > sim.ev[i - 1].end;
+    }
+    CHECK(ordered && same_sequence(), "late elements stay in order");
+    // transaction starts after a long gap are back on time
+    uint32_t on_time = 0, starts = 0;
+    for (uint32_t i = 1; i < gen_n; i++) {
+        if (gen_ev[i].type == BRP_EV_START && gen_ev[i - 1].type == BRP_EV_STOP) {
+            double want = (double)(gen_ev[i].t_us - gen_ev[0].t_us) / 2;
+            double got = (double)sim.ev[i].end * 1e6 / PIO_HZ;
+            starts++;
+            on_time += got - want <= TOLERANCE_US && want - got <= TOLERANCE_US;
+        }
+    }
+    CHECK(starts == 49 && on_time == starts, "STARTs after a gap on time at 50%");
+
+    // back to back: no delays at all
+    CHECK(replay(rec_buf, rec_len, opts(0)) == 0, "back to back matches");
+    CHECK(comp.blocks == 1 && comp.delay_words == 0 && sim.delay_words == 0 && comp.late == 0, "back to back is one block");
+}
+
+static void test_i2c_split(void) {
+    gen_init();
+    for (int i = 0; i < 30; i++) {
+        gen_gap(xorshift() % 150);
+        gen_write(xorshift(), 3 + xorshift() % 20, xorshift() % 60);
+    }
+    gen_finish();
+
+    replay_opts_t o = opts(100);
+    o.tx_cap = BRP_I2C_TX_MIN;
+    CHECK(replay(rec_buf, rec_len, o) == 0, "small TX buffer matches");
+    CHECK(comp.splits > 0 && same_sequence(), "split blocks");
+    CHECK(worst_error_us(100) <= TOLERANCE_US, "split blocks start on time");
+
+    o = opts(100);
+    o.rx_cap = 3;
+    CHECK(replay(rec_buf, rec_len, o) == 0 && comp.splits > 0 && same_sequence(), "small RX buffer");
+}
+
+static void test_i2c_edges(void) {
+    // recording starts mid transaction and ends without a STOP
+    gen_init();
+    gen_write_byte(0x12);
+    gen_write_byte(0x34);
+    gen_stop();
+    gen_gap(100);
+    gen_start();
+    gen_write_byte(DEV_ADDR << 1);
+    gen_write_byte(0x00);
+    gen_finish();
+
+    CHECK(replay(rec_buf, rec_len, opts(100)) == 0, "cut recording replays");
+    CHECK(comp.skipped == 3, "bytes and STOP before the first START skipped");
+    CHECK(sim.n == 4 && sim.ev[0].type == BRP_EV_START && sim.ev[3].type == BRP_EV_STOP, "STOP added at the end");
+    CHECK(sim.scl && sim.sda, "bus released");
+
+    // SPI events in an I2C recording are ignored
+    brp_rec_init(&rec, rec_buf, sizeof(rec_buf), BRP_BUS_I2C, 0, 0);
+    brp_event_t e = { .type = BRP_EV_XFER, .t_us = 10 };
+    brp_rec_event(&rec, &e);
+    rec_len = brp_rec_finish(&rec);
+    CHECK(replay(rec_buf, rec_len, opts(100)) == 0 && sim.n == 0 && comp.skipped == 1, "foreign events skipped");
+
+    // empty and broken recordings compile to nothing
+    brp_rec_init(&rec, rec_buf, sizeof(rec_buf), BRP_BUS_I2C, 0, 0);
+    rec_len = brp_rec_finish(&rec);
+    CHECK(replay(rec_buf, rec_len, opts(100)) == 0 && comp.blocks == 0, "empty recording");
+    CHECK(replay(rec_buf, 5, opts(100)) == 0 && comp.blocks == 0 && comp.rd.bad, "not a recording");
+}
+
+/* ── Benchmark ──────────────────────────────────────────────────── */
+
+static void bench(void) {
+    gen_init();
+    while (rec.len < sizeof(rec_buf) - 64) {
+        gen_gap(xorshift() % 400);
+        gen_read(xorshift(), 1 + xorshift() % 8, xorshift() % 20);
+    }
+    gen_finish();
+
+    brp_i2c_cfg_t cfg = { PIO_HZ, 100, 200, inst, DELAY_INST };
+    brp_block_t b;
+    uint32_t words = 0, runs = 20;
+    double t0 = now_s();
+    for (uint32_t i = 0; i < runs; i++) {
+        brp_i2c_init(&comp, rec_buf, rec_len, &cfg);
+        while (brp_i2c_next(&comp, tx, TX_CAP, expect, RX_CAP, &b)) {
+            words += b.tx_len;
+        }
+    }
+    double t = now_s() - t0;
+    CHECK(comp.rd.index == rec.events, "bench compiled everything");
+    printf("compile: %u KB recording, %u events, %u blocks, %.2f ms, %.1f Mevents/s, %.1f M TX words/s\n",
+           rec_len / 1024,
+           rec.events,
+           comp.blocks,
+           t / runs * 1e3,
+           (double)rec.events * runs / t / 1e6,
+           words / t / 1e6);
+}
+
+int main(void) {
+    printf("=== bus_replay tests ===\n\n");
+    test_format();
+    test_i2c_sequence();
+    test_i2c_timing();
+    test_i2c_scaling();
+    test_i2c_split();
+    test_i2c_edges();
+    printf("\n");
+    bench();
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return tests_pass == tests_run ? 0 : 1;
+}
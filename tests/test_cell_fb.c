@@ -0,0 +1,449 @@
+/*
+ * test_cell_fb.c — Host-side tests for the double buffered game renderer
+ *
+ * Every present is fed to a small VT100 model (CUP, CUF, SGR, UTF-8) and
+ * the model's screen must match the back grid cell for cell, colours
+ * and styles included. Checks that an unchanged frame sends nothing,
+ * that the cursor and attribute shortcuts are taken, touch/invalidate,
+ * clipping, monochrome output and a tiny output buffer.
+ *
+ * Counts the bytes per frame of a bricks-like game against the old
+ * full redraw (cursor per row, colour and reset per cell).
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_cell_fb test_cell_fb.c ../src/lib/cell_fb/cell_fb.c && ./test_cell_fb
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "lib/cell_fb/cell_fb.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+// terminal model, 1-based screen
+#define TERM_ROWS 50
+#define TERM_COLS 100
+
+typedef struct {
+    cell_t screen[TERM_ROWS + 1][TERM_COLS + 2];
+    int row, col;
+    uint8_t color, style;
+    int writes;
+    size_t bytes;
+    bool bad; // an escape we don't expect from the renderer
+    // parser state
+    int state;
+    int params[16];
+    int nparams;
+    uint32_t utf8;
+    int utf8_left;
+} term_t;
+
+static term_t term;
+
+static void term_reset(void) {
+    memset(&term, 0, sizeof(term));
+    for (int r = 0; r <= TERM_ROWS; r++) {
+        for (int c = 0; c < TERM_COLS + 2; c++) {
+            term.screen[r][c].ch = ' ';
+        }
+    }
+    term.row = term.col = 1;
+}
+
+static void term_glyph(uint16_t ch) {
+    if (term.row < 1 || term.row > TERM_ROWS || term.col < 1 || term.col > TERM_COLS) {
+        term.bad = true;
+        return;
+    }
+    cell_t* c = &term.screen[term.row][term.col];
+    c->ch = ch;
+    c->color = term.color;
+    c->style = term.style;
+    term.col++;
+}
+
+static void term_sgr(void) {
+    if (term.nparams == 0) {
+        term.params[term.nparams++] = 0;
+    }
+    for (int i = 0; i < term.nparams; i++) {
+        int p = term.params[i];
+        if (p == 0) {
+            term.color = 0;
+            term.style = 0;
+        } else if (p == 1) {
+            term.style |= CELL_BOLD;
+        } else if (p == 2) {
+            term.style |= CELL_DIM;
+        } else if (p == 4) {
+            term.style |= CELL_UNDERLINE;
+        } else if (p == 7) {
+            term.style |= CELL_REVERSE;
+        } else if (p >= 30 && p <= 37) {
+            term.color = CELL_COLOR(p - 29, CELL_BG(term.color));
+        } else if (p >= 40 && p <= 47) {
+            term.color = CELL_COLOR(CELL_FG(term.color), p - 39);
+        } else {
+            term.bad = true;
+        }
+    }
+}
+
+static void term_byte(uint8_t b) {
+    term.bytes++;
+    switch (term.state) {
+        case 0:
+            if (b == 0x1b) {
+                term.state = 1;
+            } else if (term.utf8_left) {
+                term.utf8 = (term.utf8 << 6) | (b & 0x3f);
+                if (--term.utf8_left == 0) {
+                    term_glyph((uint16_t)term.utf8);
+                }
+            } else if (b >= 0xe0) {
+                term.utf8 = b & 0x0f;
+                term.utf8_left = 2;
+            } else if (b >= 0xc0) {
+                term.utf8 = b & 0x1f;
+                term.utf8_left = 1;
+            } else if (b >= 0x20) {
+                term_glyph(b);
+            } else {
+                term.bad = true;
+            }
+            break;
+        case 1:
+            if (b != '[') {
+                term.bad = true;
+            }
+            term.state = 2;
+            term.nparams = 0;
+            memset(term.params, 0, sizeof(term.params));
+            break;
+        default:
+            if (b >= '0' && b <= '9') {
+                if (term.nparams == 0) {
+                    term.nparams = 1;
+                }
+                term.params[term.nparams - 1] = term.params[term.nparams - 1] * 10 + (b - '0');
+            } else if (b == ';') {
+                if (term.nparams == 0) {
+                    term.nparams = 1;
+                }
+                term.nparams++;
+            } else {
+                if (b == 'H') {
+                    term.row = term.nparams > 0 ? term.params[0] : 1;
+                    term.col = term.nparams > 1 ? term.params[1] : 1;
+                } else if (b == 'C') {
+                    term.col += (term.nparams && term.params[0]) ? term.params[0] : 1;
+                } else if (b == 'm') {
+                    term_sgr();
+                } else {
+                    term.bad = true;
+                }
+                term.state = 0;
+            }
+            break;
+    }
+}
+
+static void term_write(void* ctx, const char* buf, size_t len) {
+    (void)ctx;
+    term.writes++;
+    for (size_t i = 0; i < len; i++) {
+        term_byte((uint8_t)buf[i]);
+    }
+}
+
+// the model shows the back grid
+static bool term_matches(cell_fb_t* fb) {
+    for (int r = 0; r < fb->rows; r++) {
+        for (int c = 0; c < fb->cols; c++) {
+            const cell_t* want = cell_fb_at(fb, r, c);
+            const cell_t* got = &term.screen[fb->top + r][fb->left + c];
+            if (got->ch != want->ch) {
+                return false;
+            }
+            if (fb->color && (got->color != want->color || got->style != want->style)) {
+                return false;
+            }
+        }
+    }
+    return !term.bad;
+}
+
+static cell_t cells[2 * TERM_ROWS * TERM_COLS];
+static char out[2048];
+
+static uint32_t rng_state = 99;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* ── Bricks-like scene ──────────────────────────────────────────── */
+
+#define BRK_W 38
+#define BRK_H 18
+#define BRK_ROWS 4
+#define PADDLE_W 5
+
+typedef struct {
+    uint8_t bricks[BRK_ROWS][BRK_W];
+    int paddle, ball_r, ball_c, dr, dc;
+} scene_t;
+
+static const uint8_t brick_fg[5] = { 0, CELL_RED, CELL_YELLOW, CELL_GREEN, CELL_CYAN };
+
+static void scene_init(scene_t* s) {
+    for (int r = 0; r < BRK_ROWS; r++) {
+        for (int c = 0; c < BRK_W; c++) {
+            s->bricks[r][c] = (c > 0 && c < BRK_W - 1) ? (uint8_t)(r + 1) : 0;
+        }
+    }
+    s->paddle = (BRK_W - PADDLE_W) / 2;
+    s->ball_r = BRK_H - 3;
+    s->ball_c = BRK_W / 2;
+    s->dr = -1;
+    s->dc = 1;
+}
+
+static void scene_tick(scene_t* s) {
+    int nr = s->ball_r + s->dr, nc = s->ball_c + s->dc;
+    if (nr < 0 || nr >= BRK_H - 1) {
+        s->dr = -s->dr;
+        nr = s->ball_r + s->dr;
+    }
+    if (nc < 0 || nc >= BRK_W) {
+        s->dc = -s->dc;
+        nc = s->ball_c + s->dc;
+    }
+    if (nr < BRK_ROWS && s->bricks[nr][nc]) {
+        s->bricks[nr][nc] = 0;
+        s->dr = -s->dr;
+        nr = s->ball_r;
+    }
+    s->ball_r = nr;
+    s->ball_c = nc;
+    s->paddle += (rng() % 3) - 1;
+    if (s->paddle < 0) {
+        s->paddle = 0;
+    }
+    if (s->paddle > BRK_W - PADDLE_W) {
+        s->paddle = BRK_W - PADDLE_W;
+    }
+}
+
+// the grid is the field inside the walls, two columns per cell like bricks.c
+static void scene_draw(cell_fb_t* fb, const scene_t* s, int score) {
+    char status[64];
+    cell_fb_clear(fb, CELL_DEFAULT, 0);
+    for (int c = 0; c < BRK_W * 2 + 2; c++) {
+        cell_fb_put(fb, 0, c, (c == 0 || c == BRK_W * 2 + 1) ? '+' : '-', 0, 0);
+        cell_fb_put(fb, BRK_H + 1, c, (c == 0 || c == BRK_W * 2 + 1) ? '+' : '-', 0, 0);
+    }
+    for (int r = 0; r < BRK_H; r++) {
+        cell_fb_put(fb, r + 1, 0, '|', 0, 0);
+        cell_fb_put(fb, r + 1, BRK_W * 2 + 1, '|', 0, 0);
+        for (int c = 0; c < BRK_W; c++) {
+            int x = 1 + c * 2;
+            if (r == s->ball_r && c == s->ball_c) {
+                cell_fb_put(fb, r + 1, x, 'O', CELL_COLOR(CELL_WHITE, 0), CELL_BOLD);
+            } else if (r < BRK_ROWS && s->bricks[r][c]) {
+                cell_fb_put(fb, r + 1, x, 0x2588, CELL_COLOR(brick_fg[s->bricks[r][c]], 0), 0);
+                cell_fb_put(fb, r + 1, x + 1, 0x2588, CELL_COLOR(brick_fg[s->bricks[r][c]], 0), 0);
+            } else if (r == BRK_H - 1 && c >= s->paddle && c < s->paddle + PADDLE_W) {
+                cell_fb_put(fb, r + 1, x, ' ', 0, CELL_REVERSE);
+                cell_fb_put(fb, r + 1, x + 1, ' ', 0, CELL_REVERSE);
+            }
+        }
+    }
+    snprintf(status, sizeof(status), "Score: %d  Lives: 3  80ms", score);
+    cell_fb_text(fb, BRK_H + 3, 0, status, 0, 0);
+}
+
+// bytes of the old bricks.c draw_field(): cursor per row, colour + reset around every coloured cell
+static size_t naive_frame_bytes(const scene_t* s, int score) {
+    char buf[64];
+    size_t n = 0;
+    n += (size_t)snprintf(buf, sizeof(buf), "\x1b[%d;%dH", 3, 2) + 1 + BRK_W * 2 + 1;
+    for (int r = 0; r < BRK_H; r++) {
+        n += (size_t)snprintf(buf, sizeof(buf), "\x1b[%d;%dH", 4 + r, 2) + 2;
+        for (int c = 0; c < BRK_W; c++) {
+            if (r == s->ball_r && c == s->ball_c) {
+                n += strlen("\x1b[1;37mO \x1b[0m");
+            } else if (r < BRK_ROWS && s->bricks[r][c]) {
+                n += strlen("\x1b[31m\xe2\x96\x88\xe2\x96\x88\x1b[0m");
+            } else if (r == BRK_H - 1 && c >= s->paddle && c < s->paddle + PADDLE_W) {
+                n += strlen("\x1b[7m  \x1b[0m");
+            } else {
+                n += 2;
+            }
+        }
+    }
+    n += (size_t)snprintf(buf, sizeof(buf), "\x1b[%d;%dH", 4 + BRK_H, 2) + 1 + BRK_W * 2 + 1;
+    n += (size_t)snprintf(buf, sizeof(buf), "\x1b[%d;%dHScore: %d  Lives: 3  80ms\x1b[K", 6 + BRK_H, 2, score);
+    n += (size_t)snprintf(buf, sizeof(buf), "\x1b[%d;%dHAD/arrows=move  +/-=speed  q=quit", 7 + BRK_H, 2);
+    return n;
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_basic(void) {
+    cell_fb_t fb;
+    term_reset();
+    cell_fb_init(&fb, cells, 10, 30, out, sizeof(out), term_write, NULL);
+    cell_fb_origin(&fb, 3, 5);
+
+    cell_fb_text(&fb, 0, 0, "Hello", CELL_COLOR(CELL_GREEN, 0), CELL_BOLD);
+    cell_fb_text(&fb, 2, 3, "\xe2\x94\x80\xc2\xb0x", CELL_COLOR(CELL_RED, CELL_BLUE), 0);
+    cell_fb_put(&fb, 9, 29, '#', 0, CELL_REVERSE);
+    size_t first = cell_fb_present(&fb);
+    CHECK(first > 10 * 30 && term_matches(&fb), "first present draws every cell");
+    CHECK(term.writes == 1, "one bulk write");
+
+    CHECK(cell_fb_present(&fb) == 0, "unchanged frame sends nothing");
+
+    size_t before = term.bytes;
+    cell_fb_put(&fb, 4, 7, 'x', 0, 0);
+    size_t n = cell_fb_present(&fb);
+    CHECK(n == strlen("\x1b[7;12Hx") && term.bytes - before == n && term_matches(&fb), "one cell is a CUP and a glyph");
+
+    cell_fb_put(&fb, 5, 1, 'a', 0, 0);
+    cell_fb_put(&fb, 5, 3, 'b', 0, 0);
+    n = cell_fb_present(&fb);
+    CHECK(n == strlen("\x1b[8;6Ha b") && term_matches(&fb), "a short gap is rewritten");
+
+    cell_fb_put(&fb, 6, 1, 'a', 0, 0);
+    cell_fb_put(&fb, 6, 20, 'b', 0, 0);
+    n = cell_fb_present(&fb);
+    CHECK(n == strlen("\x1b[9;6Ha\x1b[18Cb") && term_matches(&fb), "a long gap is a CUF");
+
+    cell_fb_put(&fb, 7, 0, 'r', CELL_COLOR(CELL_RED, 0), 0);
+    cell_fb_put(&fb, 7, 1, 'r', CELL_COLOR(CELL_RED, 0), CELL_BOLD);
+    cell_fb_put(&fb, 7, 2, 'g', CELL_COLOR(CELL_GREEN, 0), CELL_BOLD);
+    cell_fb_put(&fb, 7, 3, 'd', 0, 0);
+    n = cell_fb_present(&fb);
+    CHECK(n == strlen("\x1b[10;5H\x1b[31mr\x1b[1mr\x1b[32mg\x1b[0md") && term_matches(&fb),
+          "SGR sends only what changed, resets to switch off");
+
+    cell_fb_put(&fb, 8, 0, 'z', CELL_COLOR(CELL_CYAN, 0), 0);
+    n = cell_fb_present(&fb);
+    CHECK(n == strlen("\x1b[11;5H\x1b[36mz\x1b[0m") && term.color == 0 && term.style == 0,
+          "colour is back to the default after a present");
+
+    // printf over some cells, then clear the screen
+    term.screen[3 + 2][5 + 3].ch = '!';
+    cell_fb_touch(&fb, 2, 3, 1);
+    n = cell_fb_present(&fb);
+    CHECK(n > 0 && n < 30 && term_matches(&fb), "touched cells are redrawn");
+
+    term_reset();
+    cell_fb_invalidate(&fb);
+    CHECK(cell_fb_present(&fb) > 10 * 30 && term_matches(&fb), "invalidate redraws everything");
+
+    cell_fb_put(&fb, -1, 0, 'x', 0, 0);
+    cell_fb_put(&fb, 0, 30, 'x', 0, 0);
+    CHECK(cell_fb_text(&fb, 3, 27, "abcdef", 0, 0) == 3, "text is clipped at the right edge");
+    cell_fb_present(&fb);
+    CHECK(term_matches(&fb), "clipped writes stay inside the grid");
+}
+
+static void test_random(void) {
+    cell_fb_t fb;
+    static char small[CELL_FB_EMIT_MAX];
+    term_reset();
+    cell_fb_init(&fb, cells, 20, 60, small, sizeof(small), term_write, NULL);
+    cell_fb_origin(&fb, 2, 1);
+
+    bool ok = true;
+    for (int frame = 0; frame < 300 && ok; frame++) {
+        int changes = (int)(rng() % 80);
+        for (int i = 0; i < changes; i++) {
+            static const uint16_t glyphs[] = { ' ', 'a', 'Z', 0x2588, 0x25cf, 0x00b0, 0x2500 };
+            cell_fb_put(&fb,
+                        (int)(rng() % 20),
+                        (int)(rng() % 60),
+                        glyphs[rng() % 7],
+                        CELL_COLOR(rng() % 9, (rng() % 4) ? 0 : rng() % 9),
+                        (uint8_t)(rng() % 16));
+        }
+        cell_fb_present(&fb);
+        ok = term_matches(&fb);
+    }
+    CHECK(ok, "300 random frames through a tiny output buffer");
+    CHECK(term.writes > 300, "a small buffer flushes many times");
+
+    // monochrome: attributes are never sent
+    term_reset();
+    cell_fb_init(&fb, cells, 5, 20, out, sizeof(out), term_write, NULL);
+    fb.color = false;
+    cell_fb_text(&fb, 1, 1, "mono", CELL_COLOR(CELL_RED, 0), CELL_BOLD);
+    cell_fb_present(&fb);
+    CHECK(term_matches(&fb) && term.screen[2][2].color == 0 && term.screen[2][2].style == 0, "monochrome sends no SGR");
+    cell_fb_text(&fb, 1, 1, "mono", CELL_COLOR(CELL_GREEN, 0), 0);
+    CHECK(cell_fb_present(&fb) == 0, "monochrome ignores attribute changes");
+}
+
+static void test_bricks(void) {
+    cell_fb_t fb;
+    scene_t s;
+    term_reset();
+    cell_fb_init(&fb, cells, BRK_H + 5, BRK_W * 2 + 2, out, sizeof(out), term_write, NULL);
+    cell_fb_origin(&fb, 3, 2);
+    scene_init(&s);
+
+    size_t naive = 0, diff = 0, first = 0, worst = 0;
+    const int frames = 500;
+    bool ok = true;
+    for (int f = 0; f < frames; f++) {
+        scene_draw(&fb, &s, f);
+        size_t n = cell_fb_present(&fb);
+        ok = ok && term_matches(&fb);
+        if (f == 0) {
+            first = n;
+        } else {
+            diff += n;
+            worst = (n > worst) ? n : worst;
+        }
+        naive += naive_frame_bytes(&s, f);
+        scene_tick(&s);
+    }
+    CHECK(ok, "bricks frames render correctly");
+    CHECK(first < naive_frame_bytes(&s, 0), "even the first frame beats the naive redraw");
+    CHECK(diff * 20 < naive, "changed cells only, 20x fewer bytes");
+    printf("bricks 78x23: naive %zu bytes/frame, first frame %zu, then %.1f bytes/frame (worst %zu)\n",
+           naive / frames,
+           first,
+           (double)diff / (frames - 1),
+           worst);
+}
+
+int main(void) {
+    printf("=== cell_fb tests ===\n\n");
+
+    test_basic();
+    test_random();
+    test_bricks();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
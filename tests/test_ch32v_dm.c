@@ -0,0 +1,566 @@
+/*
+ * test_ch32v_dm.c — Host-side tests for the CH32V003 debug module sequencing
+ *
+ * Runs the sequencing against a simulated debug module: DATA0, COMMAND,
+ * ABSTRACTAUTO, ABSTRACTCS, DMCONTROL/DMSTATUS and an 8 word progbuf
+ * executed by a small RV32C interpreter (c.lw, c.sw, c.addi, c.ebreak).
+ * Behind it sit 16 KB of flash, 2 KB of SRAM and the FLASH peripheral
+ * with the keys, fast page erase, the 64 byte page buffer and a busy
+ * flag. Programming ANDs the buffer into the page like real flash, so a
+ * missing erase shows up. Loads past the end of SRAM fault, so block
+ * reads must load exactly the words asked for.
+ *
+ * Checks poke/peek, the progbuf cache, autoexec block writes and reads,
+ * page erase/program/verify, unlock and lock, and the errors: not halted,
+ * halt refused, keys refused, write protect, stuck busy, verify mismatch
+ * and alignment.
+ *
+ * The benchmark flashes a 16 KB image and reports the SWIO transfers and
+ * the flash time. Transfer times come from the ch32vswio.pio cycle counts
+ * at 10 MHz. Page erase and program times are assumed, 3 ms each.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_ch32v_dm test_ch32v_dm.c ../src/lib/ch32v_dm/ch32v_dm.c && ./test_ch32v_dm
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lib/ch32v_dm/ch32v_dm.h"
+#include "lib/picorvd/debug_defines.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Simulated target ───────────────────────────────────────────── */
+
+#define SIM_FLASH_SIZE 16384u
+#define SIM_SRAM_BASE 0x20000000u
+#define SIM_SRAM_SIZE 2048u
+#define SIM_CYCLE_NS 100u         // PIO clock, 10 MHz
+#define SIM_CPU_NS 500u           // assumed FIFO and call overhead per transfer
+#define SIM_ERASE_NS 3000000u     // assumed fast page erase
+#define SIM_PROG_NS 3000000u      // assumed fast page program
+
+static struct {
+    // debug module
+    uint32_t data0, command, autoexec, cmderr;
+    uint32_t progbuf[8];
+    bool halted;
+    uint32_t x[16];
+    // memory
+    uint8_t flash[SIM_FLASH_SIZE];
+    uint8_t sram[SIM_SRAM_SIZE];
+    // FLASH peripheral
+    bool lock, flock;
+    uint32_t key_step, modekey_step;
+    uint32_t ctlr, addr, statr;
+    uint64_t busy_until;
+    uint32_t buf[CVDM_PAGE_WORDS];
+    uint32_t latch_addr, latch_value;
+    // faults to inject
+    bool refuse_halt, refuse_keys, write_protect, stuck_busy;
+    uint32_t stuck_bit_addr; // a flash word with bit 0 stuck at 0, 0 = none
+    // counters
+    uint64_t now_ns;
+    uint32_t progbuf_writes, execs, erases, programs, busy_violations;
+} sim;
+
+static void sim_reset(void) {
+    memset(&sim, 0, sizeof(sim));
+    memset(sim.flash, 0xff, sizeof(sim.flash));
+    sim.lock = true;
+    sim.flock = true;
+}
+
+static bool sim_busy(void) {
+    return sim.stuck_busy || sim.now_ns < sim.busy_until;
+}
+
+static void sim_flash_ctlr(uint32_t v) {
+    if (sim_busy()) {
+        sim.busy_violations++;
+    }
+    if (sim.lock) {
+        return;
+    }
+    if (v & CVDM_CTLR_LOCK) {
+        sim.lock = true;
+    }
+    if (v & CVDM_CTLR_FLOCK) {
+        sim.flock = true;
+    }
+    if ((v & (CVDM_CTLR_FTER | CVDM_CTLR_FTPG)) && sim.flock) {
+        sim.statr |= CVDM_STATR_WRPRTERR;
+        return;
+    }
+    if (v & CVDM_CTLR_BUFRST) {
+        memset(sim.buf, 0xff, sizeof(sim.buf));
+    }
+    if (v & CVDM_CTLR_BUFLOAD) {
+        sim.buf[(sim.latch_addr & (CVDM_FLASH_PAGE - 1)) / 4] = sim.latch_value;
+    }
+    if (v & CVDM_CTLR_STRT) {
+        uint32_t off = (sim.addr - CVDM_FLASH_BASE) & ~(CVDM_FLASH_PAGE - 1);
+        if (sim.write_protect || off >= SIM_FLASH_SIZE) {
+            sim.statr |= CVDM_STATR_WRPRTERR;
+        } else if (v & CVDM_CTLR_FTER) {
+            memset(&sim.flash[off], 0xff, CVDM_FLASH_PAGE);
+            sim.busy_until = sim.now_ns + SIM_ERASE_NS;
+            sim.erases++;
+        } else if (v & CVDM_CTLR_FTPG) {
+            for (uint32_t i = 0; i < CVDM_FLASH_PAGE; i++) {
+                sim.flash[off + i] &= ((uint8_t*)sim.buf)[i];
+            }
+            if (sim.stuck_bit_addr >= CVDM_FLASH_BASE + off && sim.stuck_bit_addr < CVDM_FLASH_BASE + off + CVDM_FLASH_PAGE) {
+                sim.flash[sim.stuck_bit_addr - CVDM_FLASH_BASE] &= ~1;
+            }
+            sim.busy_until = sim.now_ns + SIM_PROG_NS;
+            sim.programs++;
+        }
+    }
+    sim.ctlr = v & ~(CVDM_CTLR_STRT | CVDM_CTLR_BUFLOAD | CVDM_CTLR_BUFRST | CVDM_CTLR_LOCK | CVDM_CTLR_FLOCK);
+}
+
+static bool sim_load(uint32_t addr, uint32_t* v) {
+    if (addr & 3) {
+        return false;
+    }
+    if (addr >= CVDM_FLASH_BASE && addr < CVDM_FLASH_BASE + SIM_FLASH_SIZE) {
+        memcpy(v, &sim.flash[addr - CVDM_FLASH_BASE], 4);
+    } else if (addr >= SIM_SRAM_BASE && addr < SIM_SRAM_BASE + SIM_SRAM_SIZE) {
+        memcpy(v, &sim.sram[addr - SIM_SRAM_BASE], 4);
+    } else if (addr == CVDM_FLASH_STATR) {
+        *v = sim.statr | (sim_busy() ? CVDM_STATR_BSY : 0);
+    } else if (addr == CVDM_FLASH_CTLR) {
+        *v = sim.ctlr | (sim.lock ? CVDM_CTLR_LOCK : 0) | (sim.flock ? CVDM_CTLR_FLOCK : 0);
+    } else if (addr == CVDM_FLASH_ADDR) {
+        *v = sim.addr;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool sim_store(uint32_t addr, uint32_t v) {
+    if (addr & 3) {
+        return false;
+    }
+    if (addr >= CVDM_FLASH_BASE && addr < CVDM_FLASH_BASE + SIM_FLASH_SIZE) {
+        // only the page buffer takes flash writes
+        if (!(sim.ctlr & CVDM_CTLR_FTPG)) {
+            return false;
+        }
+        if (sim_busy()) {
+            sim.busy_violations++;
+        }
+        sim.latch_addr = addr;
+        sim.latch_value = v;
+    } else if (addr >= SIM_SRAM_BASE && addr < SIM_SRAM_BASE + SIM_SRAM_SIZE) {
+        memcpy(&sim.sram[addr - SIM_SRAM_BASE], &v, 4);
+    } else if (addr == CVDM_FLASH_KEYR || addr == CVDM_FLASH_MODEKEYR) {
+        uint32_t* step = addr == CVDM_FLASH_KEYR ? &sim.key_step : &sim.modekey_step;
+        if (!sim.refuse_keys && ((*step == 0 && v == CVDM_FLASH_KEY1) || (*step == 1 && v == CVDM_FLASH_KEY2))) {
+            (*step)++;
+        } else {
+            *step = 0;
+        }
+        if (*step == 2) {
+            *step = 0;
+            if (addr == CVDM_FLASH_KEYR) {
+                sim.lock = false;
+            } else if (!sim.lock) {
+                sim.flock = false;
+            }
+        }
+    } else if (addr == CVDM_FLASH_STATR) {
+        sim.statr &= ~(v & (CVDM_STATR_WRPRTERR | CVDM_STATR_EOP));
+    } else if (addr == CVDM_FLASH_CTLR) {
+        sim_flash_ctlr(v);
+    } else if (addr == CVDM_FLASH_ADDR) {
+        sim.addr = v;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// the compressed instructions the sequencing uses
+static bool sim_exec(void) {
+    sim.execs++;
+    for (uint32_t pc = 0; pc < 16; pc++) {
+        uint16_t op = (uint16_t)(sim.progbuf[pc / 2] >> ((pc & 1) * 16));
+        uint32_t rs1 = 8 + ((op >> 7) & 7);
+        uint32_t rs2 = 8 + ((op >> 2) & 7);
+        uint32_t imm = ((op >> 6) & 1) << 2 | ((op >> 10) & 7) << 3 | ((op >> 5) & 1) << 6;
+        if (op == 0x9002) { // c.ebreak
+            return true;
+        } else if ((op & 0xE003) == 0x4000) { // c.lw
+            if (!sim_load(sim.x[rs1] + imm, &sim.x[rs2])) {
+                return false;
+            }
+        } else if ((op & 0xE003) == 0xC000) { // c.sw
+            if (!sim_store(sim.x[rs1] + imm, sim.x[rs2])) {
+                return false;
+            }
+        } else if ((op & 0xE003) == 0x0001) { // c.addi, c.nop
+            int32_t simm = (int32_t)(((op >> 12) & 1) << 5 | ((op >> 2) & 31));
+            if (simm & 0x20) {
+                simm -= 64;
+            }
+            uint32_t rd = (op >> 7) & 31;
+            if (rd) {
+                sim.x[rd & 15] += (uint32_t)simm;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void sim_command(void) {
+    if (sim.cmderr) {
+        return;
+    }
+    if (!sim.halted) {
+        sim.cmderr = 4;
+        return;
+    }
+    uint32_t c = sim.command;
+    if ((c >> 24) != 0 || ((c & AC_ACCESS_REGISTER_TRANSFER) && ((c >> 20) & 7) != 2)) {
+        sim.cmderr = 2;
+        return;
+    }
+    if (c & AC_ACCESS_REGISTER_TRANSFER) {
+        uint32_t regno = c & 0xffff;
+        if (regno < 0x1000 || regno > 0x100f) {
+            sim.cmderr = 3;
+            return;
+        }
+        if (c & AC_ACCESS_REGISTER_WRITE) {
+            sim.x[regno & 15] = sim.data0;
+        } else {
+            sim.data0 = sim.x[regno & 15];
+        }
+    }
+    if ((c & AC_ACCESS_REGISTER_POSTEXEC) && !sim_exec()) {
+        sim.cmderr = 3;
+    }
+}
+
+// ch32vswio.pio: start 8 cycles, address bits 5 (one) or 11 (zero), stop 18
+static uint32_t sim_addr_cycles(uint32_t addr) {
+    uint32_t n = 8;
+    for (uint32_t i = 0; i < 7; i++) {
+        n += (addr >> i) & 1 ? 5 : 11;
+    }
+    return n;
+}
+
+static void sim_tick_put(uint32_t addr, uint32_t data) {
+    uint32_t n = sim_addr_cycles(addr) + 5 + 1 + 2 + 18;
+    for (uint32_t i = 0; i < 32; i++) {
+        n += (data >> i) & 1 ? 5 : 11;
+    }
+    sim.now_ns += n * SIM_CYCLE_NS + SIM_CPU_NS;
+}
+
+static void sim_tick_get(uint32_t addr) {
+    uint32_t n = sim_addr_cycles(addr) + 11 + 2 + 1 + 32 * 11 + 18;
+    sim.now_ns += n * SIM_CYCLE_NS + SIM_CPU_NS;
+}
+
+static void sim_put(uint32_t addr, uint32_t data) {
+    sim_tick_put(addr, data);
+    if (addr == DM_DATA0) {
+        sim.data0 = data;
+        if (sim.autoexec & 1) {
+            sim_command();
+        }
+    } else if (addr == DM_COMMAND) {
+        sim.command = data;
+        sim_command();
+    } else if (addr == DM_ABSTRACTAUTO) {
+        sim.autoexec = data;
+    } else if (addr == DM_ABSTRACTCS) {
+        sim.cmderr &= ~((data & DM_ABSTRACTCS_CMDERR) >> 8);
+    } else if (addr == DM_DMCONTROL) {
+        if ((data & DM_DMCONTROL_HALTREQ) && !sim.refuse_halt) {
+            sim.halted = true;
+        }
+        if (data & DM_DMCONTROL_RESUMEREQ) {
+            sim.halted = false;
+        }
+    } else if (addr >= DM_PROGBUF0 && addr < DM_PROGBUF0 + 8) {
+        sim.progbuf[addr - DM_PROGBUF0] = data;
+        sim.progbuf_writes++;
+    }
+}
+
+static uint32_t sim_get(uint32_t addr) {
+    sim_tick_get(addr);
+    if (addr == DM_DATA0) {
+        uint32_t v = sim.data0;
+        if (sim.autoexec & 1) {
+            sim_command();
+        }
+        return v;
+    } else if (addr == DM_DMSTATUS) {
+        return sim.halted ? DM_DMSTATUS_ALLHALTED : 0;
+    } else if (addr == DM_ABSTRACTCS) {
+        return sim.cmderr << 8;
+    }
+    return 0;
+}
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+static uint32_t rng = 0x1234567;
+
+static uint32_t xorshift(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static void dm_new(cvdm_t* d) {
+    sim_reset();
+    cvdm_init(d, sim_get, sim_put);
+}
+
+static uint32_t flash_word(uint32_t addr) {
+    uint32_t v;
+    memcpy(&v, &sim.flash[addr - CVDM_FLASH_BASE], 4);
+    return v;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_poke_peek(void) {
+    cvdm_t d;
+    dm_new(&d);
+    CHECK(cvdm_halt(&d), "halts");
+    CHECK(d.halted, "halted flag");
+
+    uint32_t t = d.transfers;
+    CHECK(cvdm_poke(&d, SIM_SRAM_BASE + 8, 0xDEADBEEF), "poke");
+    CHECK(d.transfers - t == 6, "first poke loads the program");
+    t = d.transfers;
+    cvdm_poke(&d, SIM_SRAM_BASE + 12, 0x01020304);
+    CHECK(d.transfers - t == 4, "second poke reuses the program");
+
+    uint32_t v = 0;
+    CHECK(cvdm_peek(&d, SIM_SRAM_BASE + 8, &v), "peek");
+    CHECK(v == 0xDEADBEEF, "peek reads the poke");
+    cvdm_peek(&d, SIM_SRAM_BASE + 12, &v);
+    CHECK(v == 0x01020304, "second peek");
+    CHECK(sim.progbuf_writes == 4, "two programs sent once each");
+    CHECK(d.error == CVDM_OK && sim.cmderr == 0, "no errors");
+}
+
+static void test_not_halted(void) {
+    cvdm_t d;
+    dm_new(&d);
+    uint32_t v;
+    CHECK(!cvdm_peek(&d, SIM_SRAM_BASE, &v), "peek fails while running");
+    CHECK(d.error == CVDM_ERR_CMD && d.cmderr == 4, "halt/resume cmderr");
+    CHECK(sim.cmderr == 0, "cmderr cleared on the target");
+
+    d.error = CVDM_OK;
+    cvdm_halt(&d);
+    CHECK(cvdm_poke(&d, SIM_SRAM_BASE, 7) && cvdm_peek(&d, SIM_SRAM_BASE, &v) && v == 7, "works once halted");
+
+    dm_new(&d);
+    sim.refuse_halt = true;
+    CHECK(!cvdm_halt(&d) && d.error == CVDM_ERR_HALT, "halt refused");
+    CHECK(!cvdm_flash_page(&d, CVDM_FLASH_BASE, (uint32_t[CVDM_PAGE_WORDS]){ 0 }, false), "no flash without halt");
+}
+
+static void test_block_write(void) {
+    cvdm_t d;
+    dm_new(&d);
+    cvdm_halt(&d);
+    uint32_t words[100];
+    for (uint32_t i = 0; i < 100; i++) {
+        words[i] = xorshift();
+    }
+    uint32_t t = d.transfers;
+    CHECK(cvdm_write(&d, SIM_SRAM_BASE + 64, words, 100), "block write");
+    CHECK(d.transfers - t == 100 + 8, "one transfer per word plus setup");
+    CHECK(memcmp(&sim.sram[64], words, sizeof(words)) == 0, "block lands in SRAM");
+    CHECK(sim.autoexec == 0, "autoexec off afterwards");
+
+    // single word and the very end of SRAM
+    CHECK(cvdm_write(&d, SIM_SRAM_BASE + SIM_SRAM_SIZE - 4, words, 1), "single word at the end");
+    CHECK(memcmp(&sim.sram[SIM_SRAM_SIZE - 4], words, 4) == 0, "single word stored");
+    CHECK(cvdm_write(&d, SIM_SRAM_BASE, words, 0), "empty write");
+
+    // past the end faults
+    CHECK(!cvdm_write(&d, SIM_SRAM_BASE + SIM_SRAM_SIZE - 8, words, 3), "write past SRAM fails");
+    CHECK(d.error == CVDM_ERR_CMD && d.cmderr == 3, "exception cmderr");
+}
+
+static void test_block_read(void) {
+    cvdm_t d;
+    dm_new(&d);
+    cvdm_halt(&d);
+    for (uint32_t i = 0; i < SIM_SRAM_SIZE; i++) {
+        sim.sram[i] = (uint8_t)xorshift();
+    }
+    uint32_t words[64];
+    for (uint32_t n = 1; n <= 6; n++) {
+        // the last words of SRAM, any look-ahead would fault
+        uint32_t addr = SIM_SRAM_BASE + SIM_SRAM_SIZE - n * 4;
+        memset(words, 0, sizeof(words));
+        CHECK(cvdm_read(&d, addr, words, n), "read at the end of SRAM");
+        CHECK(memcmp(words, &sim.sram[SIM_SRAM_SIZE - n * 4], n * 4) == 0, "read matches");
+    }
+    CHECK(d.error == CVDM_OK, "no look-ahead faults");
+
+    uint32_t t = d.transfers;
+    CHECK(cvdm_read(&d, SIM_SRAM_BASE, words, 64), "64 word read");
+    CHECK(d.transfers - t == 64 + 7, "one transfer per word plus setup, program cached");
+    CHECK(memcmp(words, sim.sram, sizeof(words)) == 0, "64 words match");
+    CHECK(sim.autoexec == 0, "autoexec off afterwards");
+}
+
+static void test_flash_page(void) {
+    cvdm_t d;
+    dm_new(&d);
+    // old contents, programming only clears bits so the page must be erased
+    memset(sim.flash, 0x00, sizeof(sim.flash));
+    uint32_t words[CVDM_PAGE_WORDS];
+    for (uint32_t i = 0; i < CVDM_PAGE_WORDS; i++) {
+        words[i] = xorshift();
+    }
+    uint32_t page = CVDM_FLASH_BASE + 5 * CVDM_FLASH_PAGE;
+    CHECK(cvdm_flash_page(&d, page, words, true), "page programmed");
+    CHECK(d.halted && d.unlocked, "halted and unlocked on the way");
+    CHECK(memcmp(&sim.flash[5 * CVDM_FLASH_PAGE], words, sizeof(words)) == 0, "page contents");
+    CHECK(flash_word(page - 4) == 0 && flash_word(page + CVDM_FLASH_PAGE) == 0, "neighbours untouched");
+    CHECK(sim.erases == 1 && sim.programs == 1, "one erase, one program");
+    CHECK(sim.busy_violations == 0, "nothing written while busy");
+    CHECK(d.polls > 2, "busy was polled");
+
+    // the second page reuses the unlock
+    uint32_t t = d.transfers;
+    uint32_t polls = d.polls;
+    CHECK(cvdm_flash_page(&d, page + CVDM_FLASH_PAGE, words, false), "second page");
+    uint32_t per_page = d.transfers - t - (d.polls - polls) * 2;
+    CHECK(per_page < 80, "page sequence overhead");
+    CHECK(flash_word(page + CVDM_FLASH_PAGE + 4) == words[1], "second page contents");
+
+    CHECK(cvdm_resume(&d), "resume");
+    CHECK(sim.lock && sim.flock && !sim.halted, "locked and running");
+    CHECK(!d.unlocked && !d.halted, "state follows");
+}
+
+static void test_flash_errors(void) {
+    cvdm_t d;
+    uint32_t words[CVDM_PAGE_WORDS];
+    memset(words, 0x5a, sizeof(words));
+
+    dm_new(&d);
+    CHECK(!cvdm_flash_page(&d, CVDM_FLASH_BASE + 4, words, false), "unaligned page");
+    CHECK(d.error == CVDM_ERR_ALIGN, "align error");
+
+    dm_new(&d);
+    sim.refuse_keys = true;
+    CHECK(!cvdm_flash_page(&d, CVDM_FLASH_BASE, words, false), "keys refused");
+    CHECK(d.error == CVDM_ERR_LOCKED, "locked error");
+
+    dm_new(&d);
+    sim.write_protect = true;
+    CHECK(!cvdm_flash_page(&d, CVDM_FLASH_BASE, words, false), "write protected");
+    CHECK(d.error == CVDM_ERR_WRPRT, "wrprt error");
+    CHECK((sim.statr & CVDM_STATR_WRPRTERR) == 0, "wrprt flag cleared");
+
+    dm_new(&d);
+    sim.stuck_busy = true;
+    CHECK(!cvdm_flash_page(&d, CVDM_FLASH_BASE, words, false), "stuck busy");
+    CHECK(d.error == CVDM_ERR_BUSY && d.polls == CVDM_BUSY_POLLS, "busy error after the poll limit");
+
+    dm_new(&d);
+    sim.stuck_bit_addr = CVDM_FLASH_BASE + 64 + 8;
+    words[2] |= 1;
+    CHECK(cvdm_flash_page(&d, CVDM_FLASH_BASE, words, true), "other page verifies");
+    CHECK(!cvdm_flash_page(&d, CVDM_FLASH_BASE + 64, words, true), "stuck bit");
+    CHECK(d.error == CVDM_ERR_VERIFY, "verify error");
+}
+
+static void test_flash_image(void) {
+    cvdm_t d;
+    dm_new(&d);
+    uint8_t image[200];
+    for (uint32_t i = 0; i < sizeof(image); i++) {
+        image[i] = (uint8_t)xorshift();
+    }
+    CHECK(cvdm_flash_write(&d, CVDM_FLASH_BASE, image, sizeof(image), true), "image written");
+    CHECK(memcmp(sim.flash, image, sizeof(image)) == 0, "image contents");
+    CHECK(sim.flash[sizeof(image)] == 0xff && sim.flash[255] == 0xff, "last page padded");
+    CHECK(sim.programs == 4, "four pages");
+}
+
+/* ── Benchmark ──────────────────────────────────────────────────── */
+
+static void bench(void) {
+    static uint8_t image[SIM_FLASH_SIZE];
+    for (uint32_t i = 0; i < sizeof(image); i++) {
+        image[i] = (uint8_t)xorshift();
+    }
+    for (int verify = 0; verify < 2; verify++) {
+        cvdm_t d;
+        dm_new(&d);
+        double t0 = now_s();
+        bool ok = cvdm_flash_write(&d, CVDM_FLASH_BASE, image, sizeof(image), verify);
+        double t = now_s() - t0;
+        CHECK(ok && memcmp(sim.flash, image, sizeof(image)) == 0, "16 KB image");
+        uint32_t pages = SIM_FLASH_SIZE / CVDM_FLASH_PAGE;
+        printf("16 KB%s: %u pages, %u transfers (%.1f per page, %u busy polls), flash time %.2f s "
+               "(busy %.2f s), sequencing %.1f ms host CPU\n",
+               verify ? " + verify" : "",
+               pages,
+               d.transfers,
+               (double)d.transfers / pages,
+               d.polls,
+               sim.now_ns / 1e9,
+               pages * (double)(SIM_ERASE_NS + SIM_PROG_NS) / 1e9,
+               t * 1e3);
+    }
+    // word by word: two pokes per word (store, BUFLOAD) instead of one DATA0 write
+    printf("word by word pokes would add %u transfers per page\n", CVDM_PAGE_WORDS * 8 - (CVDM_PAGE_WORDS - 1));
+}
+
+int main(void) {
+    printf("=== ch32v_dm tests ===\n\n");
+    test_poke_peek();
+    test_not_halted();
+    test_block_write();
+    test_block_read();
+    test_flash_page();
+    test_flash_errors();
+    test_flash_image();
+    printf("\n");
+    bench();
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return tests_pass == tests_run ? 0 : 1;
+}
@@ -0,0 +1,334 @@
+/*
+ * test_edge_stats.c — Host-side tests for the pin watcher edge statistics
+ *
+ * Builds synthetic edge streams (square waves, bursts, single sample
+ * glitches), encodes them with the la_change PIO model, drops the records
+ * into a wrapped ring the way the freq_pio DMA does and feeds them to
+ * the reducer in toolbar sized slices. Counts, minimum pulse widths, last
+ * edge times and glitch latches are checked against the samples.
+ *
+ * Build and run:
+ *   gcc -O2 -Wall -Wextra -I../src -o test_edge_stats test_edge_stats.c ../src/lib/edge_stats/edge_stats.c ../src/lib/la_change/la_change.c && ./test_edge_stats
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lib/la_change/la_change.h"
+#include "lib/edge_stats/edge_stats.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+#define RING_LEN 2048u
+static uint32_t ring[RING_LEN];
+static uint32_t records[1u << 20];
+
+static uint32_t rng_state = 0x12345678;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// reference statistics straight from the samples
+typedef struct {
+    uint32_t rising, falling;
+    uint32_t min_high, min_low;
+    uint32_t glitches;
+    uint64_t last_edge;
+} ref_pin_t;
+
+static void reference(const uint8_t* samples, size_t count, uint32_t glitch_ticks, ref_pin_t* ref) {
+    memset(ref, 0, sizeof(ref_pin_t) * EDGE_STATS_PINS);
+    for (uint8_t pin = 0; pin < EDGE_STATS_PINS; pin++) {
+        ref_pin_t* r = &ref[pin];
+        r->min_high = UINT32_MAX;
+        r->min_low = UINT32_MAX;
+        size_t last = 0;
+        for (size_t i = 1; i < count; i++) {
+            unsigned a = (samples[i - 1] >> pin) & 1u;
+            unsigned b = (samples[i] >> pin) & 1u;
+            if (a == b) {
+                continue;
+            }
+            uint32_t w = (uint32_t)(i - last);
+            if (b) {
+                r->rising++;
+                if (last && w < r->min_low) {
+                    r->min_low = w;
+                }
+            } else {
+                r->falling++;
+                if (last && w < r->min_high) {
+                    r->min_high = w;
+                }
+            }
+            if (last && w < glitch_ticks) {
+                r->glitches++;
+            }
+            last = i;
+        }
+        r->last_edge = last;
+    }
+}
+
+// feed the records through a ring in slices of up to slice records, as the toolbar does
+static void feed_sliced(edge_stats_t* s, const uint32_t* recs, size_t n, uint32_t offset, uint32_t slice) {
+    size_t done = 0;
+    while (done < n) {
+        uint32_t k = (uint32_t)((n - done < slice) ? n - done : slice);
+        uint32_t first = (offset + (uint32_t)done) & (RING_LEN - 1);
+        for (uint32_t i = 0; i < k; i++) {
+            ring[(first + i) & (RING_LEN - 1)] = recs[done + i];
+        }
+        edge_stats_feed(s, ring, RING_LEN, first, k);
+        done += k;
+    }
+}
+
+static size_t encode(const uint8_t* samples, size_t count) {
+    la_change_encoder_t enc;
+    la_change_encoder_init(&enc);
+    return la_change_encode(&enc, samples, count, records, sizeof(records) / sizeof(records[0]));
+}
+
+static bool matches(const edge_stats_t* s, const ref_pin_t* ref, uint8_t pin) {
+    const edge_stats_pin_t* p = &s->pin[pin];
+    const ref_pin_t* r = &ref[pin];
+    // the first record is sample 0
+    return p->rising == r->rising && p->falling == r->falling && p->min_high == r->min_high &&
+           p->min_low == r->min_low && p->glitches == r->glitches && p->glitch == (r->glitches != 0) &&
+           (!(r->rising + r->falling) || p->last_edge == r->last_edge);
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_square(void) {
+    const size_t count = 100000;
+    uint8_t* samples = calloc(count, 1);
+    // IO0: 10 high / 30 low, IO3: 7 / 7, IO7 idle high
+    for (size_t i = 0; i < count; i++) {
+        samples[i] |= ((i % 40) < 10) ? 0x01 : 0;
+        samples[i] |= ((i / 7) & 1) ? 0x08 : 0;
+        samples[i] |= 0x80;
+    }
+    size_t n = encode(samples, count);
+    edge_stats_t s;
+    edge_stats_init(&s, 2);
+    feed_sliced(&s, records, n, 100, 300);
+    ref_pin_t ref[EDGE_STATS_PINS];
+    reference(samples, count, 2, ref);
+
+    CHECK(matches(&s, ref, 0), "IO0 square wave");
+    CHECK(s.pin[0].min_high == 10 && s.pin[0].min_low == 30, "IO0 pulse widths");
+    CHECK(s.pin[0].rising == 2499 && s.pin[0].falling == 2500, "IO0 edge counts, starting high");
+    CHECK(matches(&s, ref, 3), "IO3 square wave");
+    CHECK(s.pin[3].min_high == 7 && s.pin[3].min_low == 7, "IO3 pulse widths");
+    CHECK(edge_stats_edges(&s.pin[7]) == 0 && s.pin[7].level && s.pin[7].min_high == UINT32_MAX, "IO7 idle high");
+    CHECK(!s.pin[0].glitch && !s.pin[3].glitch, "no glitches");
+    CHECK(s.now == la_change_total_samples(records, n), "time tracks the records");
+    free(samples);
+}
+
+static void test_glitch(void) {
+    const size_t count = 50000;
+    uint8_t* samples = calloc(count, 1);
+    // IO2 held high with one single sample dropout, IO5 low with a one sample spike
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = 0x04;
+    }
+    samples[20000] &= ~0x04;
+    samples[30000] |= 0x20;
+    samples[30001] |= 0x20;
+    samples[40000] |= 0x20;
+    size_t n = encode(samples, count);
+    edge_stats_t s;
+    edge_stats_init(&s, 2);
+    feed_sliced(&s, records, n, RING_LEN - 3, 2);
+    ref_pin_t ref[EDGE_STATS_PINS];
+    reference(samples, count, 2, ref);
+
+    CHECK(matches(&s, ref, 2), "IO2 dropout");
+    CHECK(s.pin[2].glitch && s.pin[2].min_low == 1, "one sample low pulse latched");
+    CHECK(s.pin[2].min_high == UINT32_MAX, "no complete high pulse on IO2");
+    CHECK(matches(&s, ref, 5), "IO5 spikes");
+    CHECK(s.pin[5].glitches == 1 && s.pin[5].min_high == 1, "two sample spike is not a glitch at limit 2");
+    CHECK(s.pin[5].min_low == 9998, "low time between spikes");
+    CHECK(!s.pin[0].glitch && edge_stats_edges(&s.pin[0]) == 0, "quiet pin untouched");
+
+    edge_stats_reset(&s);
+    CHECK(!s.pin[2].glitch && s.pin[2].glitches == 0 && edge_stats_edges(&s.pin[5]) == 0, "reset clears latches and counts");
+    CHECK(s.pin[2].level && s.synced, "reset keeps the pin state");
+    free(samples);
+}
+
+static void test_reset_keeps_timing(void) {
+    uint8_t samples[300];
+    memset(samples, 0, sizeof(samples));
+    memset(&samples[100], 0x02, 150);
+    size_t n = encode(samples, sizeof(samples));
+    edge_stats_t s;
+    edge_stats_init(&s, 2);
+    // reset between the rising and the falling edge, the high pulse is still measured
+    size_t split = 2;
+    CHECK(n == 3, "three records");
+    edge_stats_feed(&s, records, RING_LEN, 0, (uint32_t)split);
+    edge_stats_reset(&s);
+    edge_stats_feed(&s, records, RING_LEN, (uint32_t)split, (uint32_t)(n - split));
+    CHECK(s.pin[1].falling == 1 && s.pin[1].rising == 0, "only the edge after the reset is counted");
+    CHECK(s.pin[1].min_high == 150, "pulse across the reset measured");
+}
+
+static void test_overflow_markers(void) {
+    // pulses far apart, the counter overflows several times between edges
+    const size_t count = (5u << 24);
+    uint8_t* samples = calloc(count, 1);
+    for (size_t i = 30000000; i < 30000100; i++) {
+        samples[i] = 0x40;
+    }
+    for (size_t i = 70000000; i < 70000005; i++) {
+        samples[i] = 0x40;
+    }
+    size_t n = encode(samples, count);
+    edge_stats_t s;
+    edge_stats_init(&s, 2);
+    feed_sliced(&s, records, n, 7, 1);
+    ref_pin_t ref[EDGE_STATS_PINS];
+    reference(samples, count, 2, ref);
+    CHECK(matches(&s, ref, 6), "pulses across overflow markers");
+    CHECK(s.pin[6].min_low == 40000000 - 100, "long low time");
+    CHECK(s.pin[6].min_high == 5, "short high pulse");
+    CHECK(s.now == la_change_total_samples(records, n) && s.now > 70000000, "overflow markers advance time");
+    free(samples);
+}
+
+static void test_lost(void) {
+    const size_t count = 20000;
+    uint8_t* samples = calloc(count, 1);
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = ((i % 20) < 10) ? 0x01 : 0;
+    }
+    size_t n = encode(samples, count);
+    edge_stats_t s;
+    edge_stats_init(&s, 2);
+    edge_stats_feed(&s, records, RING_LEN, 0, 100);
+    uint32_t before = edge_stats_edges(&s.pin[0]);
+    // skip 51 records, resync: the first record after the gap only gives the state
+    edge_stats_lost(&s);
+    edge_stats_feed(&s, records, RING_LEN, 151, 200);
+    CHECK(s.lost == 1, "loss counted");
+    CHECK(edge_stats_edges(&s.pin[0]) == before + 199, "resync record is not an edge");
+    CHECK(s.pin[0].min_high == 10 && s.pin[0].min_low == 10, "no pulse measured across the gap");
+    (void)n;
+    free(samples);
+}
+
+static void test_random(void) {
+    const size_t count = 1u << 20;
+    uint8_t* samples = malloc(count);
+    uint8_t state = 0;
+    for (size_t i = 0; i < count; i++) {
+        // each pin toggles with its own probability, 1/2 down to 1/256
+        uint32_t r = rng();
+        for (uint8_t pin = 0; pin < 8; pin++) {
+            if (((r >> (pin * 4)) & ((2u << pin) - 1)) == 0) {
+                state ^= 1u << pin;
+            }
+        }
+        samples[i] = state;
+    }
+    size_t n = encode(samples, count);
+    edge_stats_t s;
+    edge_stats_init(&s, 3);
+    feed_sliced(&s, records, n, 1234, 1800);
+    ref_pin_t ref[EDGE_STATS_PINS];
+    reference(samples, count, 3, ref);
+    bool ok = true;
+    for (uint8_t pin = 0; pin < EDGE_STATS_PINS; pin++) {
+        ok &= matches(&s, ref, pin);
+    }
+    CHECK(ok, "random streams on all pins match the reference");
+    free(samples);
+}
+
+static void test_format(void) {
+    char b[16];
+    struct {
+        uint32_t v;
+        const char* s;
+    } counts[] = { { 0, "0" },         { 9999, "9999" },      { 10000, "10k" },    { 999999, "999k" },
+                   { 1000000, "1.0M" }, { 1250000, "1.2M" }, { 42000000, "42M" }, { 4294967295u, "4.2G" } };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        int n = edge_stats_fmt_count(b, sizeof(b), counts[i].v);
+        ok &= !strcmp(b, counts[i].s) && n <= 4;
+    }
+    CHECK(ok, "count formatting");
+
+    // 12.5MHz ticks, 80ns each
+    struct {
+        uint64_t t;
+        const char* s;
+    } times[] = { { 1, "80n" },        { 12, "960n" },      { 13, "1.0u" },      { 125, "10u" },
+                  { 12500, "1.0m" },   { 1250000, "100m" }, { 18750000, "1.5s" }, { 125000000, "10s" } };
+    ok = true;
+    for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+        int n = edge_stats_fmt_ticks(b, sizeof(b), times[i].t, 12500000);
+        ok &= !strcmp(b, times[i].s) && n <= 4;
+    }
+    CHECK(ok, "time formatting");
+}
+
+/* ── Benchmark ──────────────────────────────────────────────────── */
+
+static void bench(void) {
+    for (uint32_t i = 0; i < RING_LEN; i++) {
+        ring[i] = LA_CHANGE_RECORD(rng(), LA_CHANGE_COUNTER_MAX - (rng() & 0xff));
+    }
+    edge_stats_t s;
+    edge_stats_init(&s, 2);
+    const uint32_t rounds = 20000;
+    double t0 = now_s();
+    for (uint32_t r = 0; r < rounds; r++) {
+        edge_stats_feed(&s, ring, RING_LEN, r * 7, RING_LEN - 256);
+    }
+    double dt = now_s() - t0;
+    printf("reduce: %.1f M records/s (%u edges on IO0)\n", rounds * (RING_LEN - 256.0) / dt / 1e6, s.pin[0].rising);
+}
+
+int main(void) {
+    printf("=== edge_stats tests ===\n\n");
+    test_square();
+    test_glitch();
+    test_reset_keeps_timing();
+    test_overflow_markers();
+    test_lost();
+    test_random();
+    test_format();
+    printf("\n");
+    bench();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,238 @@
+/*
+ * test_flash_diff.c — Host-side tests for the differential flash programming planner
+ *
+ * Makes random chip contents and random edits of them, runs the diff and
+ * plan over a RAM model of a NOR flash and checks the chip ends up equal
+ * to the image while touching as little as possible.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_flash_diff test_flash_diff.c ../src/lib/flash_diff/flash_diff.c && ./test_flash_diff
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "lib/flash_diff/flash_diff.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+static uint8_t chip[FLASH_DIFF_BLOCK_SIZE];
+static uint8_t image[FLASH_DIFF_BLOCK_SIZE];
+
+static void diff_block(flash_diff_block_t* b, uint32_t image_len) {
+    flash_diff_block_init(b, 0x10000);
+    // pad to the end of the last sector like the firmware does
+    uint32_t end = (image_len + FLASH_DIFF_SECTOR_SIZE - 1) & ~(FLASH_DIFF_SECTOR_SIZE - 1);
+    for (uint32_t a = 0; a < end; a += FLASH_DIFF_PAGE_SIZE) {
+        uint32_t len = (a >= image_len) ? 0 : (image_len - a);
+        flash_diff_page(b, a / FLASH_DIFF_PAGE_SIZE, &chip[a], &image[a], len);
+    }
+    // the model image is padded too
+    memset(&image[image_len], 0xff, FLASH_DIFF_BLOCK_SIZE - image_len);
+}
+
+static void random_fill(uint8_t* buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)rand();
+    }
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_identical(void) {
+    random_fill(chip, sizeof(chip));
+    memcpy(image, chip, sizeof(image));
+    flash_diff_block_t b;
+    flash_diff_plan_t plan;
+    diff_block(&b, FLASH_DIFF_BLOCK_SIZE);
+    CHECK(flash_diff_plan(&b, FLASH_DIFF_ERASE_4K, &plan), "plan ok");
+    CHECK(plan.erase_count == 0 && plan.program_pages == 0, "identical image touches nothing");
+    CHECK(plan.skipped_pages == FLASH_DIFF_PAGES, "all pages skipped");
+}
+
+static void test_clear_bits_only(void) {
+    random_fill(chip, sizeof(chip));
+    memcpy(image, chip, sizeof(image));
+    chip[300] = 0xa5;
+    image[300] = 0x05; // only clears bits, programmed in place
+    flash_diff_block_t b;
+    flash_diff_plan_t plan;
+    diff_block(&b, FLASH_DIFF_BLOCK_SIZE);
+    flash_diff_plan(&b, FLASH_DIFF_ERASE_4K, &plan);
+    CHECK(plan.erase_count == 0, "1->0 change needs no erase");
+    CHECK(plan.program_pages == 1 && plan.skipped_pages == FLASH_DIFF_PAGES - 1, "one page programmed");
+    flash_diff_apply(&b, &plan, chip, image);
+    CHECK(memcmp(chip, image, sizeof(chip)) == 0, "chip matches image");
+}
+
+static void test_set_bit_erases_sector(void) {
+    memset(chip, 0, sizeof(chip));
+    memset(image, 0, sizeof(image));
+    image[5 * FLASH_DIFF_SECTOR_SIZE + 10] = 0x80;
+    flash_diff_block_t b;
+    flash_diff_plan_t plan;
+    diff_block(&b, FLASH_DIFF_BLOCK_SIZE);
+    flash_diff_plan(&b, FLASH_DIFF_ERASE_4K | FLASH_DIFF_ERASE_32K | FLASH_DIFF_ERASE_64K, &plan);
+    CHECK(plan.erase_count == 1, "one erase");
+    CHECK(plan.erase[0].address == 0x10000 + 5 * FLASH_DIFF_SECTOR_SIZE && plan.erase[0].length == 4096,
+          "4K erase of sector 5");
+    CHECK(plan.program_pages == 16, "whole erased sector reprogrammed");
+    CHECK(plan.skipped_pages == FLASH_DIFF_PAGES - 16, "rest skipped");
+    flash_diff_apply(&b, &plan, chip, image);
+    CHECK(memcmp(chip, image, sizeof(chip)) == 0, "chip matches image");
+}
+
+static void test_coalesce(void) {
+    memset(chip, 0, sizeof(chip));
+    memset(image, 0xff, sizeof(image));
+    image[FLASH_DIFF_BLOCK_SIZE - 1] = 0; // last sector: erase, one page to program
+    flash_diff_block_t b;
+    flash_diff_plan_t plan;
+    diff_block(&b, FLASH_DIFF_BLOCK_SIZE);
+    flash_diff_plan(&b, FLASH_DIFF_ERASE_4K | FLASH_DIFF_ERASE_32K | FLASH_DIFF_ERASE_64K, &plan);
+    CHECK(plan.erase_count == 1 && plan.erase[0].length == FLASH_DIFF_BLOCK_SIZE, "whole block uses 64K erase");
+    CHECK(plan.program_pages == 1, "blank pages are not programmed");
+
+    // half the block: 32K + 4K erases, no 64K
+    memset(chip, 0, sizeof(chip));
+    memset(image, 0, sizeof(image));
+    memset(image, 0x55, 9 * FLASH_DIFF_SECTOR_SIZE);
+    for (uint32_t i = 0; i < 9 * FLASH_DIFF_SECTOR_SIZE; i += 2) {
+        image[i] = 0xaa;
+    }
+    diff_block(&b, FLASH_DIFF_BLOCK_SIZE);
+    flash_diff_plan(&b, FLASH_DIFF_ERASE_4K | FLASH_DIFF_ERASE_32K | FLASH_DIFF_ERASE_64K, &plan);
+    CHECK(plan.erase_count == 2, "32K + 4K erases");
+    CHECK(plan.erase[0].address == 0x10000 && plan.erase[0].length == 32768, "32K first, in address order");
+    CHECK(plan.erase[1].address == 0x18000 && plan.erase[1].length == 4096, "then 4K");
+    flash_diff_apply(&b, &plan, chip, image);
+    CHECK(memcmp(chip, image, sizeof(chip)) == 0, "chip matches image");
+}
+
+static void test_partial_block(void) {
+    random_fill(chip, sizeof(chip));
+    memcpy(image, chip, sizeof(image));
+    uint8_t tail[FLASH_DIFF_BLOCK_SIZE];
+    memcpy(tail, chip, sizeof(tail));
+
+    // image ends halfway into sector 2
+    uint32_t len = 2 * FLASH_DIFF_SECTOR_SIZE + 1000;
+    image[100] = ~chip[100];
+    flash_diff_block_t b;
+    flash_diff_plan_t plan;
+    diff_block(&b, len);
+    CHECK(b.pages == 3 * 16, "diffed to the sector boundary");
+    CHECK(flash_diff_plan(&b, FLASH_DIFF_ERASE_4K, &plan), "4K plan ok");
+    flash_diff_apply(&b, &plan, chip, image);
+    CHECK(memcmp(chip, image, 3 * FLASH_DIFF_SECTOR_SIZE) == 0, "image written");
+    CHECK(memcmp(&chip[3 * FLASH_DIFF_SECTOR_SIZE], &tail[3 * FLASH_DIFF_SECTOR_SIZE],
+                 FLASH_DIFF_BLOCK_SIZE - 3 * FLASH_DIFF_SECTOR_SIZE) == 0,
+          "nothing past the image touched");
+
+    // a 64K-only chip can't erase part of a block
+    CHECK(!flash_diff_plan(&b, FLASH_DIFF_ERASE_64K, &plan), "64K erase past the image refused");
+    CHECK(!flash_diff_plan(&b, 0, &plan), "no erase support refused");
+}
+
+static void test_large_erase_only(void) {
+    random_fill(chip, sizeof(chip));
+    memcpy(image, chip, sizeof(image));
+    chip[40000] = 0x00;
+    image[40000] = 0xff;
+    flash_diff_block_t b;
+    flash_diff_plan_t plan;
+    diff_block(&b, FLASH_DIFF_BLOCK_SIZE);
+    CHECK(flash_diff_plan(&b, FLASH_DIFF_ERASE_64K, &plan), "64K-only plan ok");
+    CHECK(plan.erase_count == 1 && plan.erase[0].length == FLASH_DIFF_BLOCK_SIZE, "rounded up to 64K");
+    flash_diff_apply(&b, &plan, chip, image);
+    CHECK(memcmp(chip, image, sizeof(chip)) == 0, "chip matches image");
+}
+
+static void test_random(void) {
+    int ok = 0, minimal = 0;
+    const int rounds = 500;
+    for (int r = 0; r < rounds; r++) {
+        random_fill(chip, sizeof(chip));
+        memcpy(image, chip, sizeof(image));
+        // a few random edits: byte flips, bit clears, blanked and zeroed runs
+        int edits = rand() % 8;
+        for (int e = 0; e < edits; e++) {
+            uint32_t a = (uint32_t)rand() % FLASH_DIFF_BLOCK_SIZE;
+            uint32_t n = 1 + (uint32_t)rand() % 2000;
+            if (a + n > FLASH_DIFF_BLOCK_SIZE) {
+                n = FLASH_DIFF_BLOCK_SIZE - a;
+            }
+            switch (rand() % 4) {
+                case 0:
+                    random_fill(&image[a], n);
+                    break;
+                case 1:
+                    for (uint32_t i = a; i < a + n; i++) {
+                        image[i] &= (uint8_t)rand();
+                    }
+                    break;
+                case 2:
+                    memset(&image[a], 0xff, n);
+                    break;
+                default:
+                    memset(&image[a], 0x00, n);
+                    break;
+            }
+        }
+        uint32_t len = (rand() & 1) ? FLASH_DIFF_BLOCK_SIZE : 1 + (uint32_t)rand() % FLASH_DIFF_BLOCK_SIZE;
+        uint8_t before[FLASH_DIFF_BLOCK_SIZE];
+        memcpy(before, chip, sizeof(before));
+
+        flash_diff_block_t b;
+        flash_diff_plan_t plan;
+        diff_block(&b, len);
+        flash_diff_plan(&b, FLASH_DIFF_ERASE_4K | FLASH_DIFF_ERASE_32K | FLASH_DIFF_ERASE_64K, &plan);
+        flash_diff_apply(&b, &plan, chip, image);
+        uint32_t end = b.pages * FLASH_DIFF_PAGE_SIZE;
+        if (memcmp(chip, image, end) == 0 && memcmp(&chip[end], &before[end], sizeof(chip) - end) == 0) {
+            ok++;
+        }
+        // every untouched page must already match, every programmed page must have changed or been erased
+        bool min = true;
+        for (uint32_t p = 0; p < b.pages; p++) {
+            bool differs = memcmp(&before[p * 256], &image[p * 256], 256) != 0;
+            if (!flash_diff_page_touched(&plan, p) && differs) {
+                min = false;
+            }
+            if (flash_diff_bit(plan.program, p) && !differs &&
+                !(plan.erased_sectors & (1u << (p / 16)))) {
+                min = false;
+            }
+        }
+        minimal += min;
+    }
+    CHECK(ok == rounds, "random images programmed correctly");
+    CHECK(minimal == rounds, "random plans only touch changed pages");
+}
+
+int main(void) {
+    srand(1234);
+    test_identical();
+    test_clear_bits_only();
+    test_set_bit_erases_sector();
+    test_coalesce();
+    test_partial_block();
+    test_large_erase_only();
+    test_random();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
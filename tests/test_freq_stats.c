@@ -0,0 +1,159 @@
+/*
+ * test_freq_stats.c — Host-side tests for the reciprocal frequency counter statistics
+ *
+ * Builds square waves on several pins at once, encodes them with the
+ * la_change PIO model, drops the records into a wrapped ring buffer the
+ * way the DMA does and checks frequency, duty, min/max and jitter.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_freq_stats test_freq_stats.c ../src/lib/freq_stats/freq_stats.c ../src/lib/la_change/la_change.c -lm && ./test_freq_stats
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "lib/la_change/la_change.h"
+#include "lib/freq_stats/freq_stats.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+#define RING_LEN 4096u
+static uint32_t ring[RING_LEN];
+static uint32_t records[1u << 20];
+
+// square wave with a fractional period, edges land on the nearest sample
+static void add_square(uint8_t* samples, size_t count, uint8_t pin, double period, double duty) {
+    for (size_t i = 0; i < count; i++) {
+        double phase = fmod((double)i, period) / period;
+        if (phase < duty) {
+            samples[i] |= 1u << pin;
+        }
+    }
+}
+
+// encode samples and copy the newest records into the ring, wrapping at offset
+static uint32_t fill_ring(const uint8_t* samples, size_t count, uint32_t offset, uint32_t* newest) {
+    la_change_encoder_t enc;
+    la_change_encoder_init(&enc);
+    size_t n = la_change_encode(&enc, samples, count, records, sizeof(records) / sizeof(records[0]));
+    uint32_t keep = (n > RING_LEN) ? RING_LEN : (uint32_t)n;
+    for (uint32_t i = 0; i < keep; i++) {
+        ring[(offset + i) & (RING_LEN - 1)] = records[n - keep + i];
+    }
+    *newest = (offset + keep - 1) & (RING_LEN - 1);
+    return keep;
+}
+
+static bool near(double a, double b, double tol) {
+    return fabs(a - b) <= tol;
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_multi_pin(void) {
+    const size_t count = 200000;
+    uint8_t* samples = calloc(count, 1);
+    add_square(samples, count, 0, 1000, 0.25);
+    add_square(samples, count, 3, 370, 0.5);
+    add_square(samples, count, 6, 5000, 0.9);
+    for (size_t i = 0; i < count; i++) {
+        samples[i] |= 0x80; // IO7 held high
+    }
+
+    uint32_t newest;
+    uint32_t n = fill_ring(samples, count, RING_LEN - 100, &newest);
+    freq_stats_t stats[FREQ_STATS_PINS];
+    freq_stats_compute(ring, RING_LEN, newest, n, 0, stats);
+
+    CHECK(near(freq_stats_frequency(&stats[0], 1e6), 1000.0, 1e-6), "IO0 1kHz at 1MHz ticks");
+    CHECK(near(freq_stats_duty(&stats[0]), 0.25, 1e-9), "IO0 25% duty");
+    CHECK(stats[0].min_ticks == 1000 && stats[0].max_ticks == 1000, "IO0 min/max");
+    CHECK(freq_stats_jitter_ticks(&stats[0]) < 0.01, "IO0 no jitter");
+    CHECK(near(freq_stats_period_ticks(&stats[3]), 370, 1e-9), "IO3 period");
+    CHECK(near(freq_stats_duty(&stats[3]), 0.5, 1e-9), "IO3 50% duty");
+    CHECK(near(freq_stats_duty(&stats[6]), 0.9, 1e-9), "IO6 90% duty");
+    CHECK(stats[1].periods == 0 && freq_stats_frequency(&stats[1], 1e6) == 0, "idle IO1 reads 0Hz");
+    CHECK(freq_stats_duty(&stats[7]) == 1.0 && stats[7].level, "IO7 stuck high is 100%");
+    free(samples);
+}
+
+static void test_reciprocal_resolution(void) {
+    // fractional period, a fixed 1 sample gate counter could not resolve this
+    const size_t count = 2000000;
+    const double period = 1000.37;
+    uint8_t* samples = calloc(count, 1);
+    add_square(samples, count, 2, period, 0.5);
+
+    uint32_t newest;
+    uint32_t n = fill_ring(samples, count, 17, &newest);
+    freq_stats_t stats[FREQ_STATS_PINS];
+    freq_stats_compute(ring, RING_LEN, newest, n, 0, stats);
+
+    double f = freq_stats_frequency(&stats[2], 1.0);
+    double ppm = fabs(f * period - 1.0) * 1e6;
+    CHECK(stats[2].span_ticks > 1000000, "window spans the ring");
+    CHECK(ppm < 1.0, "sub-ppm reciprocal frequency");
+    CHECK(stats[2].min_ticks == 1000 && stats[2].max_ticks == 1001, "quantised periods min/max");
+    double jitter = freq_stats_jitter_ticks(&stats[2]);
+    CHECK(jitter > 0.4 && jitter < 0.5, "quantisation shows as jitter");
+    free(samples);
+}
+
+static void test_window_limit(void) {
+    const size_t count = 200000;
+    uint8_t* samples = calloc(count, 1);
+    add_square(samples, count, 5, 100, 0.5);
+    uint32_t newest;
+    uint32_t n = fill_ring(samples, count, 0, &newest);
+    freq_stats_t stats[FREQ_STATS_PINS];
+    freq_stats_compute(ring, RING_LEN, newest, n, 10000, stats);
+    CHECK(stats[5].span_ticks <= 10100 && stats[5].span_ticks >= 9900, "window limited to max ticks");
+    CHECK(near(freq_stats_period_ticks(&stats[5]), 100, 1e-9), "period inside window");
+    free(samples);
+}
+
+static void test_long_idle(void) {
+    // slow signal with the pins idle across counter overflows
+    const size_t count = (3u << 24);
+    uint8_t* samples = calloc(count, 1);
+    add_square(samples, count, 4, 20000000, 0.5);
+    uint32_t newest;
+    uint32_t n = fill_ring(samples, count, 0, &newest);
+    freq_stats_t stats[FREQ_STATS_PINS];
+    freq_stats_compute(ring, RING_LEN, newest, n, 0, stats);
+    CHECK(stats[4].periods == 1, "one period across overflow markers");
+    CHECK(stats[4].min_ticks == 20000000, "long period measured");
+    CHECK(near(freq_stats_duty(&stats[4]), 0.5, 1e-9), "long period duty");
+    free(samples);
+}
+
+static void test_empty(void) {
+    freq_stats_t stats[FREQ_STATS_PINS];
+    freq_stats_compute(ring, RING_LEN, 0, 0, 0, stats);
+    CHECK(stats[0].periods == 0 && freq_stats_jitter_ticks(&stats[0]) == 0, "empty ring");
+}
+
+int main(void) {
+    test_multi_pin();
+    test_reciprocal_resolution();
+    test_window_limit();
+    test_long_idle();
+    test_empty();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+/*
+ * test_glitch_campaign.c — Host-side tests for the glitch campaign engine
+ *
+ * Checks axis parsing, that every round of a campaign visits every grid
+ * point exactly once in grid and shuffled order, the PIO word packing, the
+ * response classifier, histogram saturation and the CSV output. Runs a
+ * whole campaign against a simulated target: a success window in delay and
+ * width, resets when the pulse is too wide, the normal reply otherwise and
+ * a trigger that sometimes does not fire.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_glitch_campaign test_glitch_campaign.c ../src/lib/glitch_campaign/glitch_campaign.c && ./test_glitch_campaign
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "lib/glitch_campaign/glitch_campaign.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+#define MAX_POINTS 8192
+
+static glitch_cell_t cells[MAX_POINTS];
+static uint32_t visits[MAX_POINTS];
+
+static void axis(glitch_axis_t* a, uint32_t start, uint32_t stop, uint32_t step) {
+    a->start = start;
+    a->stop = stop;
+    a->step = step;
+}
+
+static void match_init(glitch_match_t* m, const char* fail, const char* success, const char* reset) {
+    memset(m, 0, sizeof(*m));
+    strcpy(m->fail, fail);
+    strcpy(m->success, success);
+    strcpy(m->reset, reset);
+}
+
+// every round of the campaign must visit each point exactly once
+static bool rounds_cover(glitch_sched_t* s) {
+    glitch_point_t p;
+    for (uint32_t round = 0; round < s->repeats; round++) {
+        memset(visits, 0, sizeof(visits));
+        for (uint32_t i = 0; i < s->points; i++) {
+            if (!glitch_sched_next(s, &p) || p.index >= s->points) {
+                return false;
+            }
+            visits[p.index]++;
+        }
+        for (uint32_t i = 0; i < s->points; i++) {
+            if (visits[i] != 1) {
+                return false;
+            }
+        }
+    }
+    return !glitch_sched_next(s, &p);
+}
+
+/*
+ * Simulated target: a password check that replies "Denied\r\n". A pulse of
+ * width 30-40 placed at delay 200-220 after the second edge skips the check,
+ * wider than 80 browns out the core and it reboots. Every 50th attempt the
+ * trigger is missed.
+ */
+static uint32_t target_reply(const glitch_point_t* p, uint32_t attempt, char* reply, bool* triggered) {
+    *triggered = (attempt % 50) != 49;
+    if (!*triggered) {
+        strcpy(reply, "Denied\r\n");
+    } else if (p->width > 80) {
+        strcpy(reply, "\r\nBoot v1.2\r\n");
+    } else if (p->edges == 2 && p->delay >= 200 && p->delay <= 220 && p->width >= 30 && p->width <= 40) {
+        strcpy(reply, "Welcome\r\n");
+    } else if (p->width > 70) {
+        reply[0] = '\0'; // hangs, no reply
+    } else {
+        strcpy(reply, "Denied\r\n");
+    }
+    return (uint32_t)strlen(reply);
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_axis_parse(void) {
+    glitch_axis_t a;
+    CHECK(glitch_axis_parse("100", &a) && a.start == 100 && a.stop == 100 && a.step == 1, "single value");
+    CHECK(glitch_axis_parse("10:20", &a) && a.start == 10 && a.stop == 20 && a.step == 1, "start:stop");
+    CHECK(glitch_axis_parse("0:100:5", &a) && a.stop == 100 && a.step == 5, "start:stop:step");
+    CHECK(glitch_axis_parse("0x10:0x20:4", &a) && a.start == 16 && a.stop == 32, "hex values");
+    CHECK(glitch_axis_count(&a) == 5, "count rounds down to the last step");
+    CHECK(!glitch_axis_parse("20:10", &a), "stop before start rejected");
+    CHECK(!glitch_axis_parse("1:10:0", &a), "step of 0 rejected");
+    CHECK(!glitch_axis_parse("1:", &a), "missing stop rejected");
+    CHECK(!glitch_axis_parse("1:10x", &a), "trailing junk rejected");
+    CHECK(!glitch_axis_parse("", &a), "empty rejected");
+}
+
+static void test_grid_order(void) {
+    glitch_axis_t d, w, e;
+    glitch_sched_t s;
+    glitch_point_t p;
+    axis(&d, 100, 104, 2); // 3 points
+    axis(&w, 10, 11, 1);   // 2 points
+    axis(&e, 1, 2, 1);     // 2 points
+    CHECK(glitch_sched_init(&s, &d, &w, &e, 2, false, 0, MAX_POINTS), "init");
+    CHECK(s.points == 12 && glitch_sched_total(&s) == 24, "grid size and total");
+
+    glitch_sched_next(&s, &p);
+    CHECK(p.index == 0 && p.delay == 100 && p.width == 10 && p.edges == 1, "first point");
+    glitch_sched_next(&s, &p);
+    CHECK(p.delay == 102 && p.width == 10, "delay changes fastest");
+    glitch_sched_next(&s, &p);
+    glitch_sched_next(&s, &p);
+    CHECK(p.delay == 100 && p.width == 11 && p.edges == 1, "then width");
+    for (int i = 0; i < 3; i++) {
+        glitch_sched_next(&s, &p);
+    }
+    CHECK(p.delay == 100 && p.width == 10 && p.edges == 2, "then edges");
+
+    glitch_sched_init(&s, &d, &w, &e, 2, false, 0, MAX_POINTS);
+    CHECK(rounds_cover(&s), "grid order covers every point per round");
+
+    CHECK(!glitch_sched_init(&s, &d, &w, &e, 1, false, 0, 11), "grid larger than the histogram rejected");
+    CHECK(!glitch_sched_next(&s, &p), "rejected campaign has no attempts");
+}
+
+static void test_shuffle(void) {
+    glitch_axis_t d, w, e;
+    glitch_sched_t s;
+    glitch_point_t p;
+    bool ok = true;
+    // sizes with lots of factors, primes and tiny grids
+    const uint32_t sizes[] = { 1, 2, 3, 7, 60, 64, 97, 360, 1000, 8192 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        axis(&d, 0, sizes[i] - 1, 1);
+        axis(&w, 5, 5, 1);
+        axis(&e, 1, 1, 1);
+        for (uint32_t seed = 1; seed < 4; seed++) {
+            glitch_sched_init(&s, &d, &w, &e, 3, true, seed, MAX_POINTS);
+            ok &= rounds_cover(&s);
+        }
+    }
+    CHECK(ok, "shuffled rounds cover every point once");
+
+    // shuffled order does not walk the grid in order
+    axis(&d, 0, 99, 1);
+    glitch_sched_init(&s, &d, &w, &e, 1, true, 1234, MAX_POINTS);
+    uint32_t last = 0, steps = 0;
+    for (uint32_t i = 0; i < 100; i++) {
+        glitch_sched_next(&s, &p);
+        steps += (i && p.index == last + 1);
+        last = p.index;
+    }
+    CHECK(steps < 10, "shuffled order is not the grid order");
+
+    // rounds start in different places
+    glitch_sched_init(&s, &d, &w, &e, 4, true, 99, MAX_POINTS);
+    uint32_t first[4];
+    for (uint32_t r = 0; r < 4; r++) {
+        for (uint32_t i = 0; i < 100; i++) {
+            glitch_sched_next(&s, &p);
+            if (!i) {
+                first[r] = p.index;
+            }
+        }
+    }
+    CHECK(first[0] != first[1] || first[1] != first[2] || first[2] != first[3], "rounds start at different points");
+}
+
+static void test_pack(void) {
+    glitch_axis_t d, w, e;
+    glitch_sched_t s;
+    glitch_point_t pts[8];
+    uint32_t words[8 * GLITCH_WORDS_PER_ATTEMPT];
+    axis(&d, 500, 509, 1);
+    axis(&w, 20, 20, 1);
+    axis(&e, 3, 3, 1);
+    glitch_sched_init(&s, &d, &w, &e, 2, false, 0, MAX_POINTS);
+
+    uint32_t n = glitch_sched_pack(&s, pts, words, 8);
+    CHECK(n == 8, "full batch");
+    CHECK(words[0] == 20 && words[1] == 3 && words[2] == 500, "width, edges, delay order");
+    CHECK(words[7 * 3 + 2] == 507, "last attempt of the batch");
+    n = glitch_sched_pack(&s, pts, words, 8);
+    CHECK(n == 8 && pts[0].delay == 508 && pts[2].delay == 500, "next batch continues into round two");
+    n = glitch_sched_pack(&s, pts, words, 8);
+    CHECK(n == 4, "short final batch");
+    CHECK(glitch_sched_pack(&s, pts, words, 8) == 0, "done");
+}
+
+static void test_classify(void) {
+    glitch_match_t m;
+    const uint8_t* r;
+    match_init(&m, "Denied", "Welcome", "Boot");
+
+    r = (const uint8_t*)"Denied\r\n";
+    CHECK(glitch_classify(&m, r, 8, true) == GLITCH_CLASS_FAIL, "normal reply");
+    CHECK(glitch_classify(&m, r, 8, false) == GLITCH_CLASS_NO_TRIGGER, "no trigger wins");
+    r = (const uint8_t*)"\r\nWelcome\r\n";
+    CHECK(glitch_classify(&m, r, 11, true) == GLITCH_CLASS_SUCCESS, "success text");
+    r = (const uint8_t*)"Boot v1\r\nDenied";
+    CHECK(glitch_classify(&m, r, 15, true) == GLITCH_CLASS_RESET, "reset before fail");
+    r = (const uint8_t*)"Boot Welcome";
+    CHECK(glitch_classify(&m, r, 12, true) == GLITCH_CLASS_RESET, "reset before success");
+    r = (const uint8_t*)"\xff\x00garbage";
+    CHECK(glitch_classify(&m, r, 9, true) == GLITCH_CLASS_OTHER, "garbage with a success text");
+    r = (const uint8_t*)"\r\n\r\n";
+    CHECK(glitch_classify(&m, r, 4, true) == GLITCH_CLASS_NONE, "line endings only");
+    CHECK(glitch_classify(&m, r, 0, true) == GLITCH_CLASS_NONE, "nothing");
+    r = (const uint8_t*)"Deni";
+    CHECK(glitch_classify(&m, r, 4, true) == GLITCH_CLASS_OTHER, "cut off reply is not a match");
+
+    match_init(&m, "#", "", "");
+    r = (const uint8_t*)"#";
+    CHECK(glitch_classify(&m, r, 1, true) == GLITCH_CLASS_FAIL, "glitch command style fail");
+    r = (const uint8_t*)"$ ";
+    CHECK(glitch_classify(&m, r, 2, true) == GLITCH_CLASS_SUCCESS, "anything else is a success");
+    r = (const uint8_t*)"Boot";
+    CHECK(glitch_classify(&m, r, 4, true) == GLITCH_CLASS_SUCCESS, "no reset text, not checked");
+}
+
+static void test_hist_csv(void) {
+    glitch_axis_t d, w, e;
+    glitch_sched_t s;
+    char line[128];
+    axis(&d, 100, 200, 50);
+    axis(&w, 7, 8, 1);
+    axis(&e, 1, 1, 1);
+    glitch_sched_init(&s, &d, &w, &e, 1, false, 0, MAX_POINTS);
+
+    memset(cells, 0, sizeof(cells));
+    for (int i = 0; i < 70000; i++) {
+        glitch_hist_add(cells, 4, GLITCH_CLASS_FAIL);
+    }
+    glitch_hist_add(cells, 4, GLITCH_CLASS_SUCCESS);
+    glitch_hist_add(cells, 4, GLITCH_CLASS_COUNT); // ignored
+    CHECK(cells[4].count[GLITCH_CLASS_FAIL] == 0xffff, "counts saturate");
+    CHECK(cells[4].count[GLITCH_CLASS_SUCCESS] == 1, "other classes unaffected");
+
+    glitch_csv_header(line, sizeof(line));
+    CHECK(!strcmp(line, "delay,width,edges,none,fail,success,reset,other,notrig\r\n"), "CSV header");
+    int n = glitch_csv_row(line, sizeof(line), &s, 4, &cells[4]);
+    CHECK(!strcmp(line, "150,8,1,0,65535,1,0,0,0\r\n") && n == (int)strlen(line), "CSV row");
+    CHECK(!strcmp(glitch_class_name(GLITCH_CLASS_NO_TRIGGER), "notrig") && !strcmp(glitch_class_name(200), "?"),
+          "class names");
+}
+
+static void test_campaign(void) {
+    glitch_axis_t d, w, e;
+    glitch_sched_t s;
+    glitch_match_t m;
+    glitch_point_t pts[256];
+    static uint32_t words[256 * GLITCH_WORDS_PER_ATTEMPT];
+    char reply[32];
+    bool triggered;
+
+    axis(&d, 150, 250, 5);  // 21
+    axis(&w, 10, 100, 10);  // 10
+    axis(&e, 1, 3, 1);      // 3
+    match_init(&m, "Denied", "Welcome", "Boot");
+    CHECK(glitch_sched_init(&s, &d, &w, &e, 5, true, 42, MAX_POINTS), "campaign init");
+    memset(cells, 0, sizeof(cells));
+
+    uint32_t attempt = 0, n, totals[GLITCH_CLASS_COUNT] = { 0 };
+    while ((n = glitch_sched_pack(&s, pts, words, 256))) {
+        for (uint32_t i = 0; i < n; i++, attempt++) {
+            // the target sees what the PIO would be fed
+            glitch_point_t fed = { pts[i].index, words[i * 3 + 2], words[i * 3 + 0], words[i * 3 + 1] };
+            uint32_t len = target_reply(&fed, attempt, reply, &triggered);
+            uint8_t cls = glitch_classify(&m, (const uint8_t*)reply, len, triggered);
+            glitch_hist_add(cells, pts[i].index, cls);
+            totals[cls]++;
+        }
+    }
+    CHECK(attempt == 630 * 5, "every attempt run");
+
+    // the window: delay 200-220 (5 points), width 30,40 (2), edges 2
+    uint32_t hit_points = 0, wrong = 0;
+    glitch_point_t p;
+    for (uint32_t i = 0; i < s.points; i++) {
+        glitch_sched_point(&s, i, &p);
+        uint32_t sum = 0;
+        for (int c = 0; c < GLITCH_CLASS_COUNT; c++) {
+            sum += cells[i].count[c];
+        }
+        wrong += (sum != 5);
+        bool window = p.edges == 2 && p.delay >= 200 && p.delay <= 220 && p.width >= 30 && p.width <= 40;
+        if (cells[i].count[GLITCH_CLASS_SUCCESS]) {
+            hit_points++;
+            wrong += !window;
+        } else {
+            wrong += window && cells[i].count[GLITCH_CLASS_NO_TRIGGER] != 5;
+        }
+        wrong += (p.width > 80) && (cells[i].count[GLITCH_CLASS_RESET] + cells[i].count[GLITCH_CLASS_NO_TRIGGER] != 5);
+        wrong += (p.width > 70 && p.width <= 80) && (cells[i].count[GLITCH_CLASS_NONE] + cells[i].count[GLITCH_CLASS_NO_TRIGGER] != 5);
+    }
+    CHECK(!wrong, "histogram matches the target");
+    CHECK(hit_points == 10, "success window found");
+    CHECK(totals[GLITCH_CLASS_NO_TRIGGER] == 630 * 5 / 50, "missed triggers counted");
+    CHECK(totals[GLITCH_CLASS_OTHER] == 0, "no unexpected replies");
+}
+
+int main(void) {
+    printf("glitch campaign tests\n");
+    test_axis_parse();
+    test_grid_order();
+    test_shuffle();
+    test_pack();
+    test_classify();
+    test_hist_csv();
+    test_campaign();
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
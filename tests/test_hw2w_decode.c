@@ -0,0 +1,413 @@
+/*
+ * test_hw2w_decode.c — Host-side tests for the 2-wire sniffer decoder
+ *
+ * Feeds the decoder word streams as the hw2w_main PIO program pushes
+ * them (START/STOP words carry the pin levels above the event code) and
+ * checks the framed transactions: an SLE4442 main memory read, restarts,
+ * stray STOPs, unknown event codes, lost words, truncation, the idle
+ * close of a response and data without a START. Also covers the
+ * transaction queue and the text format.
+ *
+ * The benchmark decodes a long recorded stream and formats every
+ * transaction to show how many words per second the CPU side keeps up
+ * with.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_hw2w_decode test_hw2w_decode.c ../src/lib/hw2w_decode/hw2w_decode.c && ./test_hw2w_decode
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lib/hw2w_decode/hw2w_decode.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+// START: SDA low, SCL high, EV0 high, plus some unrelated high pins
+#define W_START ((0x2u << 8) | (HW2W_EV_START << 10) | (0x5u << 12))
+// STOP: SDA high, SCL high
+#define W_STOP ((0x3u << 8) | (HW2W_EV_STOP << 10) | (0x5u << 12))
+#define W_UNKNOWN ((0x1u << 8) | (0x2u << 10))
+#define W_DATA(b) ((uint32_t)(b) & 0xff)
+
+#define MAX_TXNS 64
+
+static hw2w_txn_t got[MAX_TXNS];
+static uint32_t got_count;
+
+static void collect(void* ctx, const hw2w_txn_t* t) {
+    (void)ctx;
+    if (got_count < MAX_TXNS) {
+        got[got_count] = *t;
+    }
+    got_count++;
+}
+
+static void reset(hw2w_dec_t* d) {
+    got_count = 0;
+    hw2w_dec_init(d, collect, NULL);
+}
+
+// feed words 10 us apart from ts
+static uint32_t feed(hw2w_dec_t* d, const uint32_t* words, uint32_t n, uint32_t ts) {
+    for (uint32_t i = 0; i < n; i++) {
+        hw2w_dec_word(d, words[i], ts);
+        ts += 10;
+    }
+    return ts;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_sle4442_read(void) {
+    hw2w_dec_t d;
+    uint32_t words[5 + 256];
+    uint32_t n = 0;
+
+    reset(&d);
+    words[n++] = W_START;
+    words[n++] = W_DATA(0x30);
+    words[n++] = W_DATA(0x00);
+    words[n++] = W_DATA(0x00);
+    words[n++] = W_STOP;
+    for (uint32_t i = 0; i < 256; i++) {
+        words[n++] = W_DATA(i ^ 0xa5);
+    }
+    feed(&d, words, 5, 1000);
+    feed(&d, &words[5], 255, 2000);
+    CHECK(got_count == 0, "response stays open");
+    CHECK(d.state == HW2W_DEC_RESP, "in response");
+
+    hw2w_dec_idle(&d, 2000 + 254 * 10 + 50, 100);
+    CHECK(got_count == 0, "not idle yet");
+    hw2w_dec_idle(&d, 2000 + 254 * 10 + 101, 100);
+    CHECK(got_count == 1, "idle closes the response");
+    CHECK(got[0].ts_us == 1000, "stamped with START");
+    CHECK(got[0].end_us == 2000 + 254 * 10, "end is the last word");
+    CHECK(got[0].cmd_len == 3 && got[0].data[0] == 0x30, "command bytes");
+    CHECK(got[0].resp_len == 255 && got[0].resp_total == 255, "response bytes");
+    CHECK(got[0].data[3] == 0xa5 && got[0].data[3 + 254] == (254 ^ 0xa5), "response in order");
+    CHECK(got[0].flags == 0, "no flags");
+    CHECK(d.words == 260 && d.txns == 1, "counters");
+
+    hw2w_dec_idle(&d, 1000000, 100);
+    CHECK(got_count == 1, "idle closes only once");
+}
+
+static void test_next_start_closes(void) {
+    hw2w_dec_t d;
+    const uint32_t words[] = {
+        W_START, W_DATA(0x31), W_DATA(0x00), W_DATA(0x00), W_STOP, W_DATA(0x01), W_DATA(0x02),
+        W_DATA(0x03), W_DATA(0x04), W_START, W_DATA(0x33), W_DATA(0x02), W_DATA(0xff), W_STOP,
+    };
+
+    reset(&d);
+    feed(&d, words, sizeof(words) / sizeof(words[0]), 0);
+    CHECK(got_count == 1, "second START closes the first");
+    CHECK(got[0].cmd_len == 3 && got[0].resp_len == 4, "first lengths");
+    CHECK(got[0].ts_us == 0 && got[0].end_us == 80, "first times");
+    CHECK(d.state == HW2W_DEC_RESP, "second waits for its response");
+    hw2w_dec_idle(&d, 200, 100);
+    CHECK(got_count == 1, "idle within 100 us");
+    hw2w_dec_flush(&d);
+    CHECK(got_count == 2, "flush closes it");
+    CHECK(got[1].cmd_len == 3 && got[1].resp_len == 0 && got[1].data[0] == 0x33, "second command");
+    CHECK(got[1].ts_us == 90 && got[1].end_us == 130, "second times");
+    hw2w_dec_flush(&d);
+    CHECK(got_count == 2, "flush when idle does nothing");
+}
+
+static void test_restart(void) {
+    hw2w_dec_t d;
+    const uint32_t words[] = { W_START, W_DATA(0x38), W_START, W_DATA(0x39), W_DATA(0x10), W_STOP };
+
+    reset(&d);
+    feed(&d, words, sizeof(words) / sizeof(words[0]), 0);
+    hw2w_dec_flush(&d);
+    CHECK(got_count == 2, "two transactions");
+    CHECK(got[0].flags == HW2W_TXN_RESTART, "first marked restart");
+    CHECK(got[0].cmd_len == 1 && got[0].resp_len == 0, "first lengths");
+    CHECK(got[1].flags == 0 && got[1].cmd_len == 2, "second is clean");
+}
+
+static void test_stray_and_unknown(void) {
+    hw2w_dec_t d;
+    const uint32_t words[] = { W_STOP, W_UNKNOWN, W_START, W_DATA(0x30), W_UNKNOWN, W_STOP, W_STOP };
+
+    reset(&d);
+    feed(&d, words, sizeof(words) / sizeof(words[0]), 0);
+    CHECK(d.stray_stops == 2, "STOP outside a command");
+    CHECK(got_count == 0, "unknown while idle opens nothing");
+    hw2w_dec_flush(&d);
+    CHECK(got_count == 1, "one transaction");
+    CHECK(got[0].flags == HW2W_TXN_UNKNOWN, "unknown marked");
+    CHECK(got[0].cmd_len == 1, "unknown carries no byte");
+    CHECK(got[0].end_us == 50, "end is the STOP, not the stray one after it");
+}
+
+static void test_no_start(void) {
+    hw2w_dec_t d;
+    const uint32_t words[] = { W_DATA(0xaa), W_DATA(0xbb), W_START, W_DATA(0x30), W_STOP };
+
+    reset(&d);
+    feed(&d, words, sizeof(words) / sizeof(words[0]), 500);
+    CHECK(got_count == 1, "START closes the headless one");
+    CHECK(got[0].flags == HW2W_TXN_NO_START, "marked no start");
+    CHECK(got[0].ts_us == 500 && got[0].cmd_len == 0 && got[0].resp_len == 2, "headless lengths");
+    CHECK(got[0].data[0] == 0xaa && got[0].data[1] == 0xbb, "headless bytes");
+}
+
+static void test_lost(void) {
+    hw2w_dec_t d;
+    const uint32_t a[] = { W_START, W_DATA(0x30), W_DATA(0x00) };
+    const uint32_t b[] = { W_DATA(0x01), W_DATA(0x02) };
+
+    reset(&d);
+    hw2w_dec_lost(&d, 100);
+    feed(&d, a, 3, 0);
+    hw2w_dec_lost(&d, 0);
+    hw2w_dec_flush(&d);
+    CHECK(got_count == 1 && got[0].flags == 0, "loss while idle marks nothing");
+
+    reset(&d);
+    feed(&d, a, 3, 0);
+    hw2w_dec_lost(&d, 7);
+    feed(&d, b, 2, 100);
+    hw2w_dec_flush(&d);
+    CHECK(got_count == 1, "one transaction");
+    CHECK(got[0].flags == HW2W_TXN_LOST, "marked lost");
+    CHECK(got[0].cmd_len == 4, "bytes after the gap still counted");
+}
+
+static void test_truncate(void) {
+    hw2w_dec_t d;
+    const uint32_t cmd[] = { W_START, W_DATA(0x30), W_DATA(0x00), W_DATA(0x00), W_STOP };
+
+    reset(&d);
+    feed(&d, cmd, 5, 0);
+    for (uint32_t i = 0; i < 1000; i++) {
+        hw2w_dec_word(&d, W_DATA(i), 100 + i);
+    }
+    hw2w_dec_flush(&d);
+    CHECK(got_count == 1, "one transaction");
+    CHECK(got[0].flags == HW2W_TXN_TRUNC, "marked truncated");
+    CHECK(got[0].cmd_len + got[0].resp_len == HW2W_TXN_DATA_MAX, "kept up to the limit");
+    CHECK(got[0].resp_total == 1000, "all response bytes counted");
+    CHECK(got[0].data[HW2W_TXN_DATA_MAX - 1] == (uint8_t)(HW2W_TXN_DATA_MAX - 4), "last kept byte");
+    CHECK(got[0].end_us == 100 + 999, "end is the last word");
+
+    // a long command keeps resp_total at zero
+    reset(&d);
+    hw2w_dec_word(&d, W_START, 0);
+    for (uint32_t i = 0; i < HW2W_TXN_DATA_MAX + 10; i++) {
+        hw2w_dec_word(&d, W_DATA(i), 1);
+    }
+    hw2w_dec_word(&d, W_STOP, 2);
+    hw2w_dec_flush(&d);
+    CHECK(got[0].cmd_len == HW2W_TXN_DATA_MAX && got[0].resp_total == 0, "long command");
+    CHECK(got[0].flags == HW2W_TXN_TRUNC, "long command truncated");
+}
+
+static void test_wrap(void) {
+    hw2w_dec_t d;
+    const uint32_t words[] = { W_START, W_DATA(0x30), W_STOP, W_DATA(0x01) };
+    uint32_t ts = 0xfffffff0u;
+
+    reset(&d);
+    ts = feed(&d, words, 4, ts);
+    hw2w_dec_idle(&d, ts + 50, 100);
+    CHECK(got_count == 0, "idle across the wrap");
+    hw2w_dec_idle(&d, ts + 200, 100);
+    CHECK(got_count == 1, "closed after the wrap");
+    CHECK(got[0].end_us == 0xfffffff0u + 30, "end after wrap");
+}
+
+static void test_queue(void) {
+    static hw2w_txn_t slots[4];
+    hw2w_txn_queue_t q;
+    hw2w_txn_t t;
+
+    memset(&t, 0, sizeof(t));
+    hw2w_txn_queue_init(&q, slots, 4);
+    CHECK(hw2w_txn_queue_peek(&q) == NULL, "empty");
+    hw2w_txn_queue_pop(&q);
+    CHECK(q.head == 0, "pop when empty does nothing");
+
+    for (uint32_t i = 0; i < 4; i++) {
+        t.ts_us = i;
+        t.cmd_len = 1;
+        t.resp_len = (uint16_t)i;
+        t.data[0] = (uint8_t)(0x40 + i);
+        CHECK(hw2w_txn_queue_push(&q, &t), "push fits");
+    }
+    t.ts_us = 99;
+    CHECK(!hw2w_txn_queue_push(&q, &t), "push when full fails");
+    CHECK(q.overruns == 1, "overrun counted");
+
+    for (uint32_t i = 0; i < 2; i++) {
+        const hw2w_txn_t* p = hw2w_txn_queue_peek(&q);
+        CHECK(p && p->ts_us == i && p->data[0] == 0x40 + i, "fifo order");
+        hw2w_txn_queue_pop(&q);
+    }
+    // wraps around the slots
+    for (uint32_t i = 4; i < 6; i++) {
+        t.ts_us = i;
+        CHECK(hw2w_txn_queue_push(&q, &t), "push after pop");
+    }
+    for (uint32_t i = 2; i < 6; i++) {
+        const hw2w_txn_t* p = hw2w_txn_queue_peek(&q);
+        CHECK(p && p->ts_us == i, "fifo order after wrap");
+        hw2w_txn_queue_pop(&q);
+    }
+    CHECK(hw2w_txn_queue_peek(&q) == NULL, "drained");
+    CHECK(q.overruns == 1, "overruns kept");
+}
+
+static void test_format(void) {
+    hw2w_txn_t t;
+    char out[HW2W_FMT_MAX];
+    size_t n;
+
+    memset(&t, 0, sizeof(t));
+    t.ts_us = 1001234;
+    t.cmd_len = 3;
+    t.data[0] = 0x30;
+    n = hw2w_txn_format(&t, 1000000, out, sizeof(out));
+    CHECK(strcmp(out, "    0.001234 [30 00 00]\r\n") == 0, "command only");
+    CHECK(n == strlen(out), "length returned");
+
+    t.resp_len = 18;
+    t.resp_total = 18;
+    for (uint32_t i = 0; i < 18; i++) {
+        t.data[3 + i] = (uint8_t)(0xf0 + i);
+    }
+    t.flags = HW2W_TXN_LOST;
+    hw2w_txn_format(&t, 1000000, out, sizeof(out));
+    CHECK(strcmp(out,
+                 "    0.001234 [30 00 00] 18 bytes !lost\r\n"
+                 "             F0 F1 F2 F3 F4 F5 F6 F7 F8 F9 FA FB FC FD FE FF\r\n"
+                 "             00 01\r\n") == 0,
+          "command, response and flag");
+
+    memset(&t, 0, sizeof(t));
+    t.ts_us = 5;
+    t.cmd_len = 1;
+    t.data[0] = 0x38;
+    t.flags = HW2W_TXN_RESTART;
+    hw2w_txn_format(&t, 0, out, sizeof(out));
+    CHECK(strcmp(out, "    0.000005 [38 !restart\r\n") == 0, "restart leaves the bracket open");
+
+    memset(&t, 0, sizeof(t));
+    t.ts_us = 3000000;
+    t.resp_len = 1;
+    t.resp_total = 1;
+    t.data[0] = 0x7e;
+    t.flags = HW2W_TXN_NO_START | HW2W_TXN_UNKNOWN;
+    hw2w_txn_format(&t, 0, out, sizeof(out));
+    CHECK(strcmp(out,
+                 "    3.000000 1 byte !nostart !unknown\r\n"
+                 "             7E\r\n") == 0,
+          "headless");
+
+    // the biggest transaction fits
+    memset(&t, 0xff, sizeof(t));
+    t.ts_us = 0xffffffffu;
+    t.cmd_len = 64;
+    t.resp_len = HW2W_TXN_DATA_MAX - 64;
+    t.resp_total = 0xffffffffu;
+    t.flags = 0xff;
+    n = hw2w_txn_format(&t, 0, out, sizeof(out));
+    CHECK(n < HW2W_FMT_MAX - 1, "worst case fits");
+    CHECK(n >= 2 && out[n - 2] == '\r' && out[n - 1] == '\n', "worst case not clipped");
+
+    // a short buffer clips
+    n = hw2w_txn_format(&t, 0, out, 20);
+    CHECK(n == 19 && strlen(out) == 19, "clipped to size");
+    CHECK(hw2w_txn_format(&t, 0, out, 0) == 0, "zero size");
+}
+
+/* ── Benchmark ──────────────────────────────────────────────────── */
+
+static char bench_out[HW2W_FMT_MAX];
+static size_t bench_chars;
+
+static void bench_done(void* ctx, const hw2w_txn_t* t) {
+    hw2w_txn_queue_t* q = ctx;
+    hw2w_txn_queue_push(q, t);
+}
+
+static void bench(void) {
+    static hw2w_txn_t slots[16];
+    static uint32_t words[5 + 256];
+    hw2w_txn_queue_t q;
+    hw2w_dec_t d;
+    const uint32_t reads = 20000;
+    uint32_t n = 0, ts = 0;
+
+    words[n++] = W_START;
+    words[n++] = W_DATA(0x30);
+    words[n++] = W_DATA(0x00);
+    words[n++] = W_DATA(0x00);
+    words[n++] = W_STOP;
+    for (uint32_t i = 0; n < sizeof(words) / sizeof(words[0]); i++) {
+        words[n++] = W_DATA(rand());
+    }
+
+    hw2w_txn_queue_init(&q, slots, 16);
+    hw2w_dec_init(&d, bench_done, &q);
+    double t0 = now_s();
+    for (uint32_t r = 0; r < reads; r++) {
+        ts = feed(&d, words, n, ts);
+        const hw2w_txn_t* t;
+        while ((t = hw2w_txn_queue_peek(&q))) {
+            bench_chars += hw2w_txn_format(t, 0, bench_out, sizeof(bench_out));
+            hw2w_txn_queue_pop(&q);
+        }
+    }
+    double t = now_s() - t0;
+    printf("decode + format: %.1f Mwords/s, %.1f chars per word\n",
+           (double)reads * n / t / 1e6,
+           (double)bench_chars / ((double)reads * n));
+    CHECK(d.txns == reads - 1 && q.overruns == 0, "benchmark kept up");
+}
+
+int main(void) {
+    printf("=== hw2w_decode tests ===\n\n");
+
+    test_sle4442_read();
+    test_next_start_closes();
+    test_restart();
+    test_stray_and_unknown();
+    test_no_start();
+    test_lost();
+    test_truncate();
+    test_wrap();
+    test_queue();
+    test_format();
+
+    printf("\n");
+    bench();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return tests_pass == tests_run ? 0 : 1;
+}
@@ -0,0 +1,289 @@
+/*
+ * test_i2c_scan.c — Host-side tests for the single pass I2C scan
+ *
+ * Runs the probe program through a simulated hwi2c PIO and bus: devices
+ * that ACK write and/or read, one that drives SDA low on the bus, and 10
+ * bit devices behind the 11110xx prefixes. Checks the TX word layout, RX
+ * word counts and timing tables, the bitmaps, reserved address names, the
+ * result lines and counts, and a scan cut short by a hung bus.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_i2c_scan test_i2c_scan.c ../src/lib/i2c_scan/i2c_scan.c && ./test_i2c_scan
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "lib/i2c_scan/i2c_scan.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+// stand-ins for the assembled set_scl_sda instructions
+static const uint16_t inst[4] = { 0xe700, 0xe701, 0xf700, 0xf701 };
+
+// the whole address space in one block
+#define FULL_TX (128 * I2C_SCAN_WRITE_WORDS + 128 * I2C_SCAN_READ_WORDS)
+#define FULL_RX 384
+
+static uint16_t tx[FULL_TX];
+static uint16_t rx[FULL_RX];
+
+typedef struct {
+    uint32_t ack_w[4], ack_r[4]; // 7 bit devices
+    uint32_t ack10[32];          // 10 bit devices
+    uint8_t sda_low_mask;        // bits a faulty device pulls low while it is addressed
+    uint8_t sda_low_address;     // at this 8 bit address
+} bus_t;
+
+/*
+ * Minimal hwi2c PIO and bus model: escape words run START/STOP, data
+ * words shift out a byte and push what was sampled with the ACK bit.
+ */
+static uint32_t bus_run(const bus_t* bus, const uint16_t* words, uint32_t len, uint16_t* out) {
+    uint32_t pushed = 0, byte_no = 0;
+    uint8_t first = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        uint16_t w = words[i];
+        uint32_t n = w >> 10;
+        if (n) {
+            // START is SC1_SD0 then SC0_SD0
+            if (words[i + 1] == inst[I2C_SCAN_SC1_SD0] && words[i + 2] == inst[I2C_SCAN_SC0_SD0]) {
+                byte_no = 0;
+            }
+            i += n + 1;
+            continue;
+        }
+        uint8_t data = (w >> 1) & 0xff;
+        uint8_t sampled = data;
+        bool ack = false;
+        if (byte_no == 0) {
+            first = data;
+            if (data == bus->sda_low_address) {
+                sampled &= ~bus->sda_low_mask;
+            }
+            if ((data & 0xf9) == 0xf0) {
+                // every 10 bit device behind this prefix ACKs the first byte
+                ack = i2c_scan_bit(bus->ack_w, data >> 1);
+                for (uint32_t a = 0; a < 256 && !ack; a++) {
+                    ack = i2c_scan_bit(bus->ack10, (((data >> 1) & 3u) << 8) | a);
+                }
+            } else {
+                ack = i2c_scan_bit((data & 1) ? bus->ack_r : bus->ack_w, data >> 1);
+            }
+        } else if (byte_no == 1 && (first & 0xf9) == 0xf0) {
+            ack = i2c_scan_bit(bus->ack10, (((first >> 1) & 3u) << 8) | data);
+        } else if (first & 1) {
+            sampled = 0x5a; // the device's data, master NACKs
+            ack = false;
+        }
+        out[pushed++] = (uint16_t)((sampled << 1) | (ack ? 0 : 1));
+        byte_no++;
+    }
+    return pushed;
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_build(void) {
+    uint32_t n = i2c_scan_build(tx, inst, 0, 256);
+    CHECK(n == FULL_TX, "TX words for the whole scan");
+    CHECK(tx[0] == (1u << 10) && tx[1] == inst[I2C_SCAN_SC1_SD0] && tx[2] == inst[I2C_SCAN_SC0_SD0], "START");
+    CHECK(tx[3] == ((0x00 << 1) | 1), "address 0x00 W, NACK bit set");
+    CHECK(tx[4] == (2u << 10) && tx[7] == inst[I2C_SCAN_SC1_SD1], "STOP");
+    CHECK(tx[8 + 3] == ((0x01 << 1) | 1) && tx[8 + 4] == ((0xff << 1) | 1), "read address then a NACKed read");
+    CHECK(i2c_scan_rx_words(0, 256) == FULL_RX, "RX words for the whole scan");
+    CHECK(i2c_scan_rx_words(1, 2) == 3 && i2c_scan_rx_words(2, 1) == 1 && i2c_scan_rx_words(3, 1) == 2, "RX words for parts");
+    CHECK(i2c_scan_build(tx, inst, 0xa0, 2) == I2C_SCAN_WRITE_WORDS + I2C_SCAN_READ_WORDS, "one W/R pair");
+    CHECK(i2c_scan_build_10bit(tx, inst, 2, 0, 128) == 128 * I2C_SCAN_10BIT_WORDS, "10 bit block");
+    CHECK(tx[3] == ((0xf4 << 1) | 1) && tx[4] == 1, "10 bit prefix and low byte");
+    CHECK(i2c_scan_build(tx, inst, 0, I2C_SCAN_BLOCK) <= I2C_SCAN_TX_MAX &&
+              i2c_scan_build_10bit(tx, inst, 0, 0, I2C_SCAN_BLOCK) <= I2C_SCAN_TX_MAX &&
+              i2c_scan_rx_words(0, I2C_SCAN_BLOCK) <= I2C_SCAN_RX_MAX,
+          "a block fits the stack buffers");
+}
+
+static void test_rx_tables(void) {
+    bool ok = true;
+    // the locator against a plain walk
+    for (uint32_t first = 0; first < 6; first++) {
+        uint32_t index = 0;
+        for (uint32_t a = first; a < first + 40; a++) {
+            uint32_t words = (a & 1) ? 2 : 1;
+            for (uint32_t k = 0; k < words; k++, index++) {
+                ok &= i2c_scan_rx_address(first, index) == a;
+                uint32_t cycles = k ? I2C_SCAN_BYTE_CYCLES
+                                    : I2C_SCAN_START_CYCLES + I2C_SCAN_BYTE_CYCLES + (index ? I2C_SCAN_STOP_CYCLES : 0);
+                ok &= i2c_scan_rx_cycles(first, index) == cycles;
+            }
+        }
+    }
+    CHECK(ok, "RX word address and cycle tables");
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < FULL_RX; i++) {
+        total += i2c_scan_rx_cycles(0, i);
+    }
+    total += I2C_SCAN_STOP_CYCLES;
+    // 128 write probes and 128 read probes
+    CHECK(total == 128 * (2 * I2C_SCAN_START_CYCLES + 3 * I2C_SCAN_BYTE_CYCLES + 2 * I2C_SCAN_STOP_CYCLES), "scan cycles");
+    printf("  nominal scan: %u SCL periods, 100kHz %.1fms, 400kHz %.1fms, 1MHz %.1fms\n",
+           total / I2C_SCAN_BIT_CYCLES,
+           total / 32.0 / 100.0,
+           total / 32.0 / 400.0,
+           total / 32.0 / 1000.0);
+}
+
+static void test_scan(void) {
+    bus_t bus;
+    i2c_scan_result_t r;
+    memset(&bus, 0, sizeof(bus));
+    i2c_scan_set(bus.ack_w, 0x50); // EEPROM, both
+    i2c_scan_set(bus.ack_r, 0x50);
+    i2c_scan_set(bus.ack_w, 0x3c); // write only display
+    i2c_scan_set(bus.ack_r, 0x68); // read only
+    i2c_scan_set(bus.ack_w, 0x00); // answers general call
+    bus.sda_low_address = 0x90;    // 0x48 W sees SDA pulled low
+    bus.sda_low_mask = 0x10;
+
+    i2c_scan_init(&r);
+    uint32_t n = i2c_scan_build(tx, inst, 0, 256);
+    uint32_t got = bus_run(&bus, tx, n, rx);
+    CHECK(got == FULL_RX, "simulated bus pushed every word");
+    i2c_scan_decode(&r, rx, got, 0);
+    CHECK(r.probed == 256, "all addresses probed");
+
+    bool ok = true;
+    for (uint32_t a = 0; a < 128; a++) {
+        ok &= i2c_scan_bit(r.ack_w, a) == i2c_scan_bit(bus.ack_w, a);
+        ok &= i2c_scan_bit(r.ack_r, a) == i2c_scan_bit(bus.ack_r, a);
+    }
+    CHECK(ok, "bitmaps match the bus");
+    CHECK(i2c_scan_bit(r.fault, 0x48) && !i2c_scan_bit(r.fault, 0x50), "SDA held low found");
+
+    uint32_t addresses, pairs, addresses10;
+    i2c_scan_count(&r, &addresses, &pairs, &addresses10);
+    CHECK(addresses == 5 && pairs == 1 && addresses10 == 0, "counts");
+
+    char line[96];
+    i2c_scan_format(line, sizeof(line), &r, 0x50);
+    CHECK(!strcmp(line, "0x50 (0xA0 W) (0xA1 R)"), "pair line, as the old scan printed it");
+    i2c_scan_format(line, sizeof(line), &r, 0x3c);
+    CHECK(!strcmp(line, "0x3C (0x78 W)"), "write only line");
+    i2c_scan_format(line, sizeof(line), &r, 0x68);
+    CHECK(!strcmp(line, "0x68 (0xD1 R)"), "read only line");
+    i2c_scan_format(line, sizeof(line), &r, 0x00);
+    CHECK(!strcmp(line, "0x00 (0x00 W) [general call]"), "general call line");
+    i2c_scan_format(line, sizeof(line), &r, 0x48);
+    CHECK(!strcmp(line, "0x48 SDA held low"), "fault line");
+    CHECK(i2c_scan_format(line, sizeof(line), &r, 0x10) == 0 && line[0] == '\0', "nothing at an empty address");
+    i2c_scan_set(r.stretch, 0x50);
+    int len = i2c_scan_format(line, sizeof(line), &r, 0x50);
+    CHECK(!strcmp(line, "0x50 (0xA0 W) (0xA1 R) clock stretch") && len == (int)strlen(line), "stretch note");
+    len = i2c_scan_format(line, 12, &r, 0x50);
+    CHECK(len == 11 && strlen(line) == 11, "line truncated to the buffer");
+}
+
+// the firmware scans in blocks, same result as one pass
+static void test_blocks(void) {
+    bus_t bus;
+    i2c_scan_result_t whole, blocks;
+    memset(&bus, 0, sizeof(bus));
+    for (uint32_t a = 0; a < 128; a += 7) {
+        i2c_scan_set(bus.ack_w, a);
+        if (a % 3 == 0) {
+            i2c_scan_set(bus.ack_r, a);
+        }
+    }
+    i2c_scan_init(&whole);
+    uint32_t n = i2c_scan_build(tx, inst, 0, 256);
+    i2c_scan_decode(&whole, rx, bus_run(&bus, tx, n, rx), 0);
+
+    i2c_scan_init(&blocks);
+    uint16_t block_tx[I2C_SCAN_TX_MAX], block_rx[I2C_SCAN_RX_MAX];
+    bool ok = true;
+    for (uint32_t first = 0; first < 256; first += I2C_SCAN_BLOCK) {
+        n = i2c_scan_build(block_tx, inst, first, I2C_SCAN_BLOCK);
+        uint32_t got = bus_run(&bus, block_tx, n, block_rx);
+        ok &= (got == i2c_scan_rx_words(first, I2C_SCAN_BLOCK));
+        i2c_scan_decode(&blocks, block_rx, got, first);
+    }
+    CHECK(ok, "block RX word counts");
+    CHECK(!memcmp(&whole, &blocks, sizeof(whole)), "blocks give the one pass result");
+}
+
+static void test_10bit(void) {
+    bus_t bus;
+    i2c_scan_result_t r;
+    memset(&bus, 0, sizeof(bus));
+    i2c_scan_set(bus.ack10, 0x2a5); // prefix 2, low 0xa5
+    i2c_scan_set(bus.ack10, 0x20f);
+
+    i2c_scan_init(&r);
+    uint32_t n = i2c_scan_build(tx, inst, 0, 256);
+    i2c_scan_decode(&r, rx, bus_run(&bus, tx, n, rx), 0);
+    CHECK(i2c_scan_bit(r.ack_w, 0x7a) && !i2c_scan_bit(r.ack_w, 0x78), "prefix 11110100 ACKed");
+    char line[96];
+    i2c_scan_format(line, sizeof(line), &r, 0x7a);
+    CHECK(!strcmp(line, "0x7A (0xF4 W) [10 bit address]"), "prefix line");
+
+    for (uint32_t low = 0; low < 256; low += 128) {
+        n = i2c_scan_build_10bit(tx, inst, 2, low, 128);
+        uint32_t got = bus_run(&bus, tx, n, rx);
+        CHECK(got == 256, "two RX words per 10 bit probe");
+        i2c_scan_decode_10bit(&r, rx, got, 2, low);
+    }
+    uint32_t addresses, pairs, addresses10;
+    i2c_scan_count(&r, &addresses, &pairs, &addresses10);
+    CHECK(addresses10 == 2 && i2c_scan_bit(r.ack10, 0x2a5) && i2c_scan_bit(r.ack10, 0x20f) && r.scan10, "10 bit devices found");
+}
+
+static void test_reserved(void) {
+    CHECK(!strcmp(i2c_scan_reserved(0x00, true), "START byte"), "START byte");
+    CHECK(!strcmp(i2c_scan_reserved(0x01, false), "CBUS"), "CBUS");
+    CHECK(!strcmp(i2c_scan_reserved(0x05, false), "Hs-mode master code"), "Hs-mode");
+    CHECK(!strcmp(i2c_scan_reserved(0x7c, true), "device ID"), "device ID");
+    CHECK(i2c_scan_reserved(0x08, false) == NULL && i2c_scan_reserved(0x77, true) == NULL, "ordinary range");
+}
+
+static void test_hung(void) {
+    bus_t bus;
+    i2c_scan_result_t r;
+    memset(&bus, 0, sizeof(bus));
+    i2c_scan_set(bus.ack_w, 0x20);
+    i2c_scan_set(bus.ack_w, 0x70);
+    i2c_scan_init(&r);
+    uint32_t n = i2c_scan_build(tx, inst, 0, 256);
+    bus_run(&bus, tx, n, rx);
+    // the RX DMA stopped after address 0x41 (write 0x20 is word 96)
+    uint32_t words = i2c_scan_rx_words(0, 0x42);
+    i2c_scan_decode(&r, rx, words, 0);
+    CHECK(r.probed == 0x42, "probed up to the hang");
+    CHECK(i2c_scan_bit(r.ack_w, 0x20) && !i2c_scan_bit(r.ack_w, 0x70), "found before the hang only");
+    CHECK(i2c_scan_rx_address(0, words) == 0x42, "next address is where the bus hung");
+}
+
+int main(void) {
+    printf("i2c scan tests\n");
+    test_build();
+    test_rx_tables();
+    test_scan();
+    test_blocks();
+    test_10bit();
+    test_reserved();
+    test_hung();
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
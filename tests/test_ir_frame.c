@@ -0,0 +1,403 @@
+/*
+ * test_ir_frame.c — Host-side tests for infrared frames
+ *
+ * Checks the AIR parser irtoy-air, irtx and BPIO share (good packets,
+ * a packet ending on a MARK, every error, values and frequencies out of
+ * range, too many pairs), AIR formatting round trips, IRF encode/decode
+ * through a reader that hands out a few bytes at a time, varint edges,
+ * truncated and foreign files, the size of IRF against AIR text, capture
+ * assembly from counter words and the carrier measurement.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_ir_frame test_ir_frame.c ../src/lib/ir_frame/ir_frame.c && ./test_ir_frame
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "lib/ir_frame/ir_frame.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+#define MAX_PAIRS 1024
+#define FILE_SIZE 16384
+
+// in memory file handed out `chunk` bytes per read
+typedef struct {
+    const uint8_t* data;
+    size_t len;
+    size_t pos;
+    size_t chunk;
+    uint32_t reads;
+} mem_file_t;
+
+static size_t mem_read(void* ctx, uint8_t* buf, size_t len) {
+    mem_file_t* f = ctx;
+    size_t n = f->len - f->pos;
+    if (n > len) {
+        n = len;
+    }
+    if (n > f->chunk) {
+        n = f->chunk;
+    }
+    memcpy(buf, &f->data[f->pos], n);
+    f->pos += n;
+    f->reads++;
+    return n;
+}
+
+static void mem_open(mem_file_t* f, const uint8_t* data, size_t len, size_t chunk) {
+    f->data = data;
+    f->len = len;
+    f->pos = 0;
+    f->chunk = chunk;
+    f->reads = 0;
+}
+
+static uint32_t rng_state = 0x1234567;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// an NEC-like frame: leader, 32 bits, stop MARK and timeout
+static uint32_t nec_frame(uint32_t* pairs, uint32_t code) {
+    uint32_t n = 0;
+    pairs[n++] = IR_PAIR(9000, 4500);
+    for (int i = 0; i < 32; i++) {
+        pairs[n++] = IR_PAIR(562, (code >> i) & 1 ? 1687 : 562);
+    }
+    pairs[n++] = IR_PAIR(562, IR_FRAME_TIMEOUT);
+    return n;
+}
+
+static ir_air_status_t parse_str(const char* s, uint8_t* khz, uint32_t* pairs, uint32_t max, uint32_t* count) {
+    return ir_air_parse(s, strlen(s), khz, pairs, max, count);
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_air_parse(void) {
+    uint32_t pairs[8];
+    uint32_t count;
+    uint8_t khz;
+
+    CHECK(parse_str("$38:900,1800,900,65535,;", &khz, pairs, 8, &count) == IR_AIR_OK, "parse a complete packet");
+    CHECK(khz == 38 && count == 2, "frequency and pair count");
+    CHECK(pairs[0] == IR_PAIR(900, 1800) && pairs[1] == IR_PAIR(900, 0xffff), "pairs packed mark << 16 | space");
+
+    CHECK(parse_str("junk$36:100,200,300,;\r\n", &khz, pairs, 8, &count) == IR_AIR_OK, "leading junk skipped");
+    CHECK(khz == 36 && count == 2, "odd value count gives two pairs");
+    CHECK(pairs[1] == IR_PAIR(300, IR_FRAME_TIMEOUT), "a frame ending on a MARK gets the timeout SPACE");
+
+    CHECK(parse_str("$255:1,0,;", &khz, pairs, 8, &count) == IR_AIR_OK && khz == 255, "255kHz is the limit");
+    CHECK(parse_str("$1:65535,65535,;", &khz, pairs, 8, &count) == IR_AIR_OK && pairs[0] == 0xffffffff,
+          "65535 is the largest value");
+}
+
+static void test_air_errors(void) {
+    uint32_t pairs[4];
+    uint32_t count = 99;
+    uint8_t khz;
+
+    CHECK(parse_str("38:100,200,;", &khz, pairs, 4, &count) == IR_AIR_ERROR_START, "no $");
+    CHECK(count == 0, "count cleared on error");
+    CHECK(parse_str("", &khz, pairs, 4, &count) == IR_AIR_ERROR_START, "empty string");
+    CHECK(ir_air_parse("xx\0$38:1,2,;", 12, &khz, pairs, 4, &count) == IR_AIR_ERROR_START, "stops at a NUL");
+    CHECK(parse_str("$", &khz, pairs, 4, &count) == IR_AIR_ERROR_START, "nothing after $");
+    CHECK(parse_str("$38", &khz, pairs, 4, &count) == IR_AIR_ERROR_MOD_FREQ, "no :");
+    CHECK(parse_str("$3a:1,2,;", &khz, pairs, 4, &count) == IR_AIR_ERROR_MOD_FREQ, "frequency not a number");
+    CHECK(parse_str("$256:1,2,;", &khz, pairs, 4, &count) == IR_AIR_ERROR_MOD_FREQ, "frequency over 255kHz");
+    CHECK(parse_str("$0:1,2,;", &khz, pairs, 4, &count) == IR_AIR_ERROR_MOD_FREQ, "frequency 0");
+    CHECK(parse_str("$38:", &khz, pairs, 4, &count) == IR_AIR_ERROR_LENGTH, "no data");
+    CHECK(parse_str("$38:100,200", &khz, pairs, 4, &count) == IR_AIR_ERROR_DATA, "value without a comma");
+    CHECK(parse_str("$38:100,200,", &khz, pairs, 4, &count) == IR_AIR_ERROR_DATA, "no ;");
+    CHECK(parse_str("$38:100,,;", &khz, pairs, 4, &count) == IR_AIR_ERROR_DATA, "empty value");
+    CHECK(parse_str("$38:100,x,;", &khz, pairs, 4, &count) == IR_AIR_ERROR_DATA, "value not a number");
+    CHECK(parse_str("$38:65536,1,;", &khz, pairs, 4, &count) == IR_AIR_ERROR_DATA, "value over 65535");
+    CHECK(parse_str("$38:1,1,2,2,3,3,4,4,5,;", &khz, pairs, 4, &count) == IR_AIR_ERROR_OVERFLOW, "too many pairs");
+    CHECK(parse_str("$38:1,1,2,2,3,3,4,4,;", &khz, pairs, 4, &count) == IR_AIR_OK && count == 4,
+          "exactly max pairs fits");
+    CHECK(strlen(ir_air_error_str(IR_AIR_ERROR_OVERFLOW)) > 0, "error strings");
+}
+
+static void test_air_format(void) {
+    uint32_t pairs[MAX_PAIRS], back[MAX_PAIRS];
+    uint32_t count, n = nec_frame(pairs, 0x20df10ef);
+    uint8_t khz;
+    char buf[1024];
+
+    size_t len = ir_air_format(buf, sizeof(buf), 38, pairs, n);
+    CHECK(len == strlen(buf), "format length");
+    CHECK(strncmp(buf, "$38:9000,4500,562,", 18) == 0, "format prefix");
+    CHECK(strcmp(&buf[len - 6], ",562,;") == 0, "final timeout SPACE left out");
+    CHECK(parse_str(buf, &khz, back, MAX_PAIRS, &count) == IR_AIR_OK, "formatted text parses");
+    CHECK(khz == 38 && count == n && memcmp(back, pairs, n * 4) == 0, "AIR round trip");
+
+    char small[16];
+    size_t full = ir_air_format(small, sizeof(small), 38, pairs, n);
+    CHECK(full == len && strlen(small) == sizeof(small) - 1, "truncated like snprintf");
+
+    pairs[0] = IR_PAIR(100, 200);
+    len = ir_air_format(buf, sizeof(buf), 40, pairs, 1);
+    CHECK(strcmp(buf, "$40:100,200,;") == 0, "a final SPACE that is not the timeout is kept");
+}
+
+static void test_varint_edges(void) {
+    static const uint32_t values[] = { 0, 1, 127, 128, 16383, 16384, 65534, 65535 };
+    static const size_t sizes[] = { 1, 1, 1, 2, 2, 3, 3, 3 };
+    uint8_t buf[IR_IRF_PAIR_MAX];
+    bool ok = true;
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        size_t len = ir_irf_pair(buf, IR_PAIR(values[i], values[i]));
+        ok &= (len == sizes[i] * 2);
+    }
+    CHECK(ok, "varint lengths at the 7 bit boundaries");
+    CHECK(ir_irf_pair(buf, 0xffffffff) == IR_IRF_PAIR_MAX, "largest pair fits IR_IRF_PAIR_MAX");
+    CHECK(ir_irf_frame_header(buf, 38, 0x1fffff) <= IR_IRF_FRAME_HEADER_MAX, "frame header fits");
+
+    // every boundary value round trips through a file
+    uint8_t file[256];
+    uint32_t pairs[8], back[8], got;
+    size_t n = ir_irf_header(file);
+    for (int i = 0; i < 8; i++) {
+        pairs[i] = IR_PAIR(values[i], values[7 - i]);
+    }
+    n += ir_irf_encode(&file[n], sizeof(file) - n, 56, pairs, 8);
+
+    mem_file_t f;
+    ir_irf_reader_t r;
+    uint8_t khz;
+    uint32_t count;
+    mem_open(&f, file, n, 1);
+    CHECK(ir_irf_open(&r, mem_read, &f) == IR_IRF_OK, "open");
+    CHECK(ir_irf_next(&r, &khz, &count) == IR_IRF_OK && khz == 56 && count == 8, "frame header");
+    CHECK(ir_irf_read(&r, back, 8, &got) == IR_IRF_OK && got == 8, "read pairs");
+    CHECK(memcmp(back, pairs, sizeof(pairs)) == 0, "boundary values round trip");
+    CHECK(ir_irf_next(&r, &khz, &count) == IR_IRF_END, "end of file");
+}
+
+static void test_irf_round_trip(void) {
+    static uint8_t file[FILE_SIZE];
+    static uint32_t frames[8][MAX_PAIRS];
+    uint32_t counts[8];
+    uint8_t khzs[8] = { 38, 36, 40, 56, 38, 33, 255, 1 };
+    size_t n = ir_irf_header(file);
+
+    for (int i = 0; i < 8; i++) {
+        if (i < 4) {
+            counts[i] = nec_frame(frames[i], rng());
+        } else {
+            // long random frames, more pairs than irtx's old 128 byte buffer held
+            counts[i] = 100 + rng() % 300;
+            for (uint32_t j = 0; j < counts[i]; j++) {
+                frames[i][j] = IR_PAIR(rng() % 0x10000, rng() % 0x10000);
+            }
+        }
+        size_t len = ir_irf_encode(&file[n], sizeof(file) - n, khzs[i], frames[i], counts[i]);
+        CHECK(len > 0, "frame encodes");
+        n += len;
+    }
+
+    static const size_t chunks[] = { 1, 3, 7, 64, 4096 };
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        mem_file_t f;
+        ir_irf_reader_t r;
+        uint8_t khz;
+        uint32_t count, got;
+        bool ok = true;
+        mem_open(&f, file, n, chunks[c]);
+        ok &= ir_irf_open(&r, mem_read, &f) == IR_IRF_OK;
+        for (int i = 0; i < 8; i++) {
+            uint32_t back[MAX_PAIRS], total = 0;
+            ok &= ir_irf_next(&r, &khz, &count) == IR_IRF_OK;
+            ok &= khz == khzs[i] && count == counts[i];
+            // replay in small pieces like the DMA chunks
+            do {
+                ok &= ir_irf_read(&r, &back[total], 17, &got) == IR_IRF_OK;
+                total += got;
+            } while (got && total < MAX_PAIRS);
+            ok &= total == counts[i] && memcmp(back, frames[i], total * 4) == 0;
+        }
+        ok &= ir_irf_next(&r, &khz, &count) == IR_IRF_END;
+        CHECK(ok, "eight frames round trip whatever the read size");
+    }
+
+    // skipping frames without reading them
+    mem_file_t f;
+    ir_irf_reader_t r;
+    uint8_t khz;
+    uint32_t count, got, pair;
+    mem_open(&f, file, n, 5);
+    ir_irf_open(&r, mem_read, &f);
+    ir_irf_next(&r, &khz, &count);
+    ir_irf_read(&r, &pair, 1, &got);
+    uint32_t frames_seen = 1;
+    while (ir_irf_next(&r, &khz, &count) == IR_IRF_OK) {
+        frames_seen++;
+    }
+    CHECK(frames_seen == 8, "ir_irf_next skips the rest of a frame");
+    CHECK(khz == 1 && count == counts[7], "last frame header after skipping");
+}
+
+static void test_irf_errors(void) {
+    uint8_t file[512];
+    uint32_t pairs[MAX_PAIRS], back[MAX_PAIRS];
+    uint32_t count = nec_frame(pairs, 0x12345678), got;
+    size_t n = ir_irf_header(file);
+    n += ir_irf_encode(&file[n], sizeof(file) - n, 38, pairs, count);
+    mem_file_t f;
+    ir_irf_reader_t r;
+    uint8_t khz;
+
+    uint8_t small[10];
+    CHECK(ir_irf_encode(small, sizeof(small), 38, pairs, count) == 0, "encode into a small buffer gives 0");
+
+    mem_open(&f, file, 3, 64);
+    CHECK(ir_irf_open(&r, mem_read, &f) == IR_IRF_BAD_MAGIC, "short header");
+
+    uint8_t bad[8];
+    memcpy(bad, file, sizeof(bad));
+    bad[0] = '$';
+    mem_open(&f, bad, sizeof(bad), 64);
+    CHECK(ir_irf_open(&r, mem_read, &f) == IR_IRF_BAD_MAGIC, "AIR text is not IRF");
+    memcpy(bad, file, sizeof(bad));
+    bad[4] = IR_IRF_VERSION + 1;
+    mem_open(&f, bad, sizeof(bad), 64);
+    CHECK(ir_irf_open(&r, mem_read, &f) == IR_IRF_BAD_MAGIC, "newer version refused");
+
+    // cut in the middle of the pairs
+    mem_open(&f, file, n - 3, 2);
+    ir_irf_open(&r, mem_read, &f);
+    CHECK(ir_irf_next(&r, &khz, &count) == IR_IRF_OK, "truncated file header ok");
+    CHECK(ir_irf_read(&r, back, MAX_PAIRS, &got) == IR_IRF_TRUNCATED, "truncated frame");
+    CHECK(got < count && memcmp(back, pairs, got * 4) == 0, "pairs before the cut are good");
+    CHECK(ir_irf_next(&r, &khz, &count) == IR_IRF_END, "end after truncation");
+
+    // cut inside a frame header
+    mem_open(&f, file, IR_IRF_HEADER_LEN + 1, 64);
+    ir_irf_open(&r, mem_read, &f);
+    CHECK(ir_irf_next(&r, &khz, &count) == IR_IRF_TRUNCATED, "truncated frame header");
+
+    // zero kHz and a value over 65535
+    uint8_t zero[] = { 'B', 'P', 'I', 'R', IR_IRF_VERSION, 0, 1, 1, 1 };
+    mem_open(&f, zero, sizeof(zero), 64);
+    ir_irf_open(&r, mem_read, &f);
+    CHECK(ir_irf_next(&r, &khz, &count) == IR_IRF_BAD_VALUE, "0kHz refused");
+    uint8_t big[] = { 'B', 'P', 'I', 'R', IR_IRF_VERSION, 38, 1, 0x80, 0x80, 0x04, 1 };
+    mem_open(&f, big, sizeof(big), 64);
+    ir_irf_open(&r, mem_read, &f);
+    ir_irf_next(&r, &khz, &count);
+    CHECK(ir_irf_read(&r, back, 4, &got) == IR_IRF_BAD_VALUE && got == 0, "65536 refused");
+    uint8_t endless[] = { 'B', 'P', 'I', 'R', IR_IRF_VERSION, 38, 1, 0x81, 0x81, 0x81, 0x81, 0x81, 0x01, 1 };
+    mem_open(&f, endless, sizeof(endless), 64);
+    ir_irf_open(&r, mem_read, &f);
+    ir_irf_next(&r, &khz, &count);
+    CHECK(ir_irf_read(&r, back, 4, &got) == IR_IRF_BAD_VALUE, "overlong varint refused");
+}
+
+static void test_irf_size(void) {
+    uint32_t pairs[MAX_PAIRS];
+    uint32_t count = nec_frame(pairs, 0xa55a00ff);
+    uint8_t bin[512];
+    char text[1024];
+    size_t irf = ir_irf_encode(bin, sizeof(bin), 38, pairs, count);
+    size_t air = ir_air_format(text, sizeof(text), 38, pairs, count);
+    printf("  NEC frame: %u pairs, IRF %u bytes, AIR %u bytes\n", count, (unsigned)irf, (unsigned)air);
+    CHECK(irf * 2 < air, "IRF is less than half the size of AIR text");
+    CHECK(irf <= IR_IRF_FRAME_HEADER_MAX + count * 4, "NEC pairs take at most 4 bytes");
+}
+
+static void test_capture(void) {
+    uint32_t pairs[4];
+    ir_capture_t c;
+    ir_capture_init(&c, pairs, 4);
+
+    CHECK(ir_count_us(0xffff - 900) == 900, "counter word to us");
+    CHECK(ir_count_us(0xffff) == IR_FRAME_TIMEOUT, "timeout word");
+    CHECK(ir_count_timeout(0xffffffff) && !ir_count_timeout(0xfffffffe), "timeout test uses the low 16 bits");
+
+    CHECK(!ir_capture_feed(&c, 0xffff - 9000, 0xffff - 4500), "leader");
+    CHECK(!ir_capture_feed(&c, 0xffff - 562, 0xffff - 1687), "bit");
+    CHECK(ir_capture_feed(&c, 0xffff - 562, 0xffff), "timeout ends the frame");
+    CHECK(c.count == 3 && !c.truncated, "three pairs");
+    CHECK(pairs[0] == IR_PAIR(9000, 4500) && pairs[2] == IR_PAIR(562, IR_FRAME_TIMEOUT), "captured pairs");
+
+    ir_capture_init(&c, pairs, 4);
+    for (int i = 0; i < 6; i++) {
+        ir_capture_feed(&c, 0xffff - 100, 0xffff - 200);
+    }
+    CHECK(ir_capture_feed(&c, 0xffff - 100, 0xffff), "long frame still completes");
+    CHECK(c.count == 4 && c.truncated, "truncated at max");
+    CHECK(pairs[3] == IR_PAIR(100, IR_FRAME_TIMEOUT), "truncated frame ends on the timeout");
+}
+
+// samples of a carrier with `low` 0s and `high` 1s per period, MSB first
+static uint32_t carrier_words(uint32_t* words, uint32_t count, uint32_t low, uint32_t high, uint32_t phase) {
+    uint32_t period = low + high;
+    for (uint32_t i = 0; i < count; i++) {
+        words[i] = 0;
+        for (int j = 31; j >= 0; j--) {
+            uint32_t t = (i * 32 + (31 - j) + phase) % period;
+            if (t >= low) {
+                words[i] |= 1u << j;
+            }
+        }
+    }
+    return count;
+}
+
+static void test_carrier(void) {
+    uint32_t words[8], mark, space;
+
+    // 38kHz sampled at 0.2us: 26.3us period, about 66 samples each half
+    carrier_words(words, 8, 66, 66, 0);
+    CHECK(ir_carrier_measure(words, 8, &mark, &space), "38kHz measured");
+    CHECK(mark == 66 && space == 66, "38kHz period");
+    CHECK(1000000 / ((mark + space) / 5) == 38461, "frequency the way irio computes it");
+
+    carrier_words(words, 8, 40, 85, 10);
+    CHECK(ir_carrier_measure(words, 8, &mark, &space), "mid-period start");
+    CHECK(mark == 30 && space == 85, "first run is partial, the period after is whole");
+
+    carrier_words(words, 8, 40, 85, 45);
+    CHECK(!ir_carrier_measure(words, 8, &mark, &space), "samples starting on a 1 refused");
+
+    memset(words, 0, sizeof(words));
+    CHECK(!ir_carrier_measure(words, 8, &mark, &space), "no carrier");
+    carrier_words(words, 2, 20, 200, 0);
+    CHECK(!ir_carrier_measure(words, 2, &mark, &space), "period longer than the samples");
+}
+
+int main(void) {
+    printf("=== ir_frame tests ===\n\n");
+
+    test_air_parse();
+    test_air_errors();
+    test_air_format();
+    test_varint_edges();
+    test_irf_round_trip();
+    test_irf_errors();
+    test_irf_size();
+    test_capture();
+    test_carrier();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,284 @@
+/*
+ * test_la_change.c — Host-side tests for the change-only logic capture format
+ *
+ * Round-trips random and mostly-idle sample streams through the PIO
+ * encoder model and checks the run decoder, the newest-first expander,
+ * the SUMP RLE exporter (decoded the way libsigrok's OLS driver does)
+ * and the VCD exporter against the uncompressed samples.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_la_change test_la_change.c ../src/lib/la_change/la_change.c && ./test_la_change
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "lib/la_change/la_change.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+#define MAX_RECORDS (1u << 20)
+static uint32_t records[MAX_RECORDS];
+
+static uint32_t rng_state = 0x12345678;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// bus that is idle most of the time with short bursts of activity
+static void make_bursty(uint8_t* samples, size_t count) {
+    uint8_t state = rng() & 0xff;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t r = rng() % 1000;
+        if (r < 5) {
+            state ^= 1u << (rng() % 8);
+        }
+        samples[i] = state;
+    }
+}
+
+static size_t encode_all(const uint8_t* samples, size_t count) {
+    la_change_encoder_t enc;
+    la_change_encoder_init(&enc);
+    size_t n = la_change_encode(&enc, samples, count, records, MAX_RECORDS - 1);
+    records[n++] = la_change_encoder_flush(&enc);
+    return n;
+}
+
+static bool runs_match(const uint8_t* samples, size_t count, size_t nrec) {
+    la_change_reader_t r;
+    la_change_run_t run;
+    uint64_t pos = 0;
+    la_change_reader_init(&r, records, nrec);
+    while (la_change_next_run(&r, &run)) {
+        if (run.start != pos) {
+            return false;
+        }
+        for (uint64_t i = 0; i < run.length; i++) {
+            if (pos >= count || samples[pos] != run.state) {
+                return false;
+            }
+            pos++;
+        }
+    }
+    return pos == count;
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_record_fields(void) {
+    CHECK(la_change_record_state(LA_CHANGE_RECORD(0xA5, 0x123456)) == 0xA5, "record state");
+    CHECK(la_change_record_delta(LA_CHANGE_RECORD(0, LA_CHANGE_COUNTER_MAX)) == 1, "delta at reload value");
+    CHECK(la_change_record_delta(LA_CHANGE_RECORD(0, 0)) == (1u << 24), "delta at overflow");
+}
+
+static void test_constant_stream(void) {
+    static uint8_t samples[1000];
+    memset(samples, 0x3c, sizeof(samples));
+    size_t n = encode_all(samples, sizeof(samples));
+    CHECK(n == 2, "constant stream is start + end record");
+    CHECK(la_change_total_samples(records, n) == sizeof(samples), "constant stream total");
+    CHECK(la_change_transitions(records, n) == 0, "constant stream has no transitions");
+    CHECK(runs_match(samples, sizeof(samples), n), "constant stream runs");
+}
+
+static void test_every_sample_changes(void) {
+    static uint8_t samples[4096];
+    for (size_t i = 0; i < sizeof(samples); i++) {
+        samples[i] = (uint8_t)i;
+    }
+    size_t n = encode_all(samples, sizeof(samples));
+    CHECK(n == sizeof(samples) + 1, "one record per sample plus end");
+    CHECK(la_change_transitions(records, n) == sizeof(samples) - 1, "transition count");
+    CHECK(runs_match(samples, sizeof(samples), n), "toggling stream runs");
+}
+
+static void test_random_roundtrip(void) {
+    const size_t count = 2000000;
+    uint8_t* samples = malloc(count);
+    make_bursty(samples, count);
+    size_t n = encode_all(samples, count);
+    CHECK(n < count / 50, "bursty stream compresses");
+    CHECK(la_change_total_samples(records, n) == count, "bursty total samples");
+    CHECK(runs_match(samples, count, n), "bursty stream runs");
+    free(samples);
+}
+
+static void test_counter_overflow(void) {
+    // idle for more than two counter periods, then a single edge
+    const size_t count = (2u << 24) + 77 + 1000;
+    uint8_t* samples = malloc(count);
+    memset(samples, 0x01, count);
+    memset(samples + (2u << 24) + 77, 0x03, count - ((2u << 24) + 77));
+    size_t n = encode_all(samples, count);
+    size_t markers = 0;
+    for (size_t i = 1; i + 1 < n; i++) {
+        if (la_change_record_state(records[i]) == la_change_record_state(records[i - 1])) {
+            markers++;
+        }
+    }
+    CHECK(markers == 2, "two overflow markers");
+    CHECK(la_change_transitions(records, n) == 1, "one transition across overflow");
+    CHECK(la_change_total_samples(records, n) == count, "overflow total samples");
+    CHECK(runs_match(samples, count, n), "overflow runs");
+
+    la_change_reader_t r;
+    la_change_run_t run;
+    la_change_reader_init(&r, records, n);
+    CHECK(la_change_next_run(&r, &run) && run.length == (2u << 24) + 77, "overflow markers folded into run");
+    free(samples);
+}
+
+static void test_reverse_expand(void) {
+    const size_t count = 300000;
+    uint8_t* samples = malloc(count);
+    uint8_t* out = malloc(count + 16);
+    make_bursty(samples, count);
+    size_t n = encode_all(samples, count);
+
+    la_change_reverse_t rev;
+    la_change_reverse_init(&rev, records, n);
+    size_t got = 0, k;
+    // odd chunk size to exercise runs split across calls
+    while ((k = la_change_reverse_expand(&rev, out + got, 61)) > 0) {
+        got += k;
+    }
+    CHECK(got == count, "reverse expand length");
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; i++) {
+        ok = out[i] == samples[count - 1 - i];
+    }
+    CHECK(ok, "reverse expand is newest first");
+    free(samples);
+    free(out);
+}
+
+// decode an OLS RLE stream the way libsigrok does: a flagged sample is the
+// repeat count for the next sample, then the whole buffer is reversed
+static size_t sump_decode(const uint8_t* stream, size_t len, uint8_t width, uint8_t* out, size_t max) {
+    size_t n = 0;
+    uint32_t rle_count = 0;
+    for (size_t i = 0; i + width <= len; i += width) {
+        uint32_t sample = stream[i] | (width == 2 ? (stream[i + 1] << 8) : 0);
+        uint32_t flag = (width == 2) ? 0x8000 : 0x80;
+        if (sample & flag) {
+            rle_count = sample & (flag - 1);
+            continue;
+        }
+        for (uint32_t j = 0; j <= rle_count && n < max; j++) {
+            out[n++] = (uint8_t)sample;
+        }
+        rle_count = 0;
+    }
+    for (size_t i = 0; i < n / 2; i++) {
+        uint8_t t = out[i];
+        out[i] = out[n - 1 - i];
+        out[n - 1 - i] = t;
+    }
+    return n;
+}
+
+static void check_sump(uint8_t width) {
+    const size_t count = 200000;
+    uint8_t* samples = malloc(count);
+    uint8_t* stream = malloc(count * 2 * 2);
+    uint8_t* out = malloc(count);
+    make_bursty(samples, count);
+    size_t n = encode_all(samples, count);
+
+    la_change_sump_t s;
+    la_change_sump_init(&s, records, n, width, 0xffffffff);
+    size_t len = 0, k;
+    while ((k = la_change_sump_fill(&s, stream + len, 64)) > 0) {
+        len += k;
+    }
+    size_t got = sump_decode(stream, len, width, out, count);
+    CHECK(got == count, width == 1 ? "sump 8 bit rle length" : "sump 16 bit rle length");
+    uint8_t mask = (width == 1) ? 0x7f : 0xff;
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; i++) {
+        ok = out[i] == (samples[i] & mask);
+    }
+    CHECK(ok, width == 1 ? "sump 8 bit rle samples" : "sump 16 bit rle samples");
+    CHECK(len / width < count / 10, "sump rle compresses");
+    free(samples);
+    free(stream);
+    free(out);
+}
+
+static void test_sump_rle(void) {
+    check_sump(1);
+    check_sump(2);
+}
+
+static void test_sump_entry_limit(void) {
+    static uint8_t samples[10000];
+    memset(samples, 0x11, sizeof(samples));
+    memset(samples + 5000, 0x22, 5000);
+    size_t n = encode_all(samples, sizeof(samples));
+    la_change_sump_t s;
+    uint8_t stream[256];
+    // 8 bit counts split each run into 128 sample pairs
+    la_change_sump_init(&s, records, n, 1, 7);
+    size_t len = 0, k;
+    while ((k = la_change_sump_fill(&s, stream + len, 4)) > 0) {
+        len += k;
+    }
+    CHECK(len == 7, "sump stops at the entry limit");
+    // newest first: count then value of the 0x22 run, last entry is a lone value
+    CHECK(stream[0] == (0x80 | 0x7f) && stream[1] == 0x22, "sump newest run first");
+    CHECK(stream[6] == 0x22, "sump never ends on a dangling count");
+}
+
+static void test_vcd(void) {
+    static uint8_t samples[1000];
+    memset(samples, 0x00, sizeof(samples));
+    memset(samples + 100, 0x01, 400);
+    memset(samples + 500, 0x81, 500);
+    size_t n = encode_all(samples, sizeof(samples));
+
+    la_change_vcd_t v;
+    static char text[4096];
+    size_t len = 0, k;
+    la_change_vcd_init(&v, records, n, 1000000);
+    while ((k = la_change_vcd_fill(&v, text + len, 7)) > 0) {
+        len += k;
+    }
+    text[len] = 0;
+    CHECK(strstr(text, "$timescale 1 ns $end") != NULL, "vcd timescale");
+    CHECK(strstr(text, "$var wire 1 ( IO7 $end") != NULL, "vcd IO7 variable");
+    CHECK(strstr(text, "$enddefinitions $end\n#0\n$dumpvars\n0!\n") != NULL, "vcd initial values");
+    CHECK(strstr(text, "\n#100000\n1!\n#500000\n1(\n#1000000\n") != NULL, "vcd changes at 1MHz");
+    CHECK(text[len - 1] == '\n', "vcd ends with newline");
+}
+
+int main(void) {
+    test_record_fields();
+    test_constant_stream();
+    test_every_sample_changes();
+    test_random_roundtrip();
+    test_counter_overflow();
+    test_reverse_expand();
+    test_sump_rle();
+    test_sump_entry_limit();
+    test_vcd();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/*
+ * test_led_frame.c — Host-side tests for the LED frame packer
+ *
+ * Checks the PIO word layout for every device/channel combination against
+ * the per-pixel hwled_write() path, the gamma/brightness table and the
+ * frame time used for the frames/sec report.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_led_frame test_led_frame.c ../src/lib/led_frame/led_frame.c -lm && ./test_led_frame
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "lib/led_frame/led_frame.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_ws2812_rgb(void) {
+    const uint8_t src[] = { 0x11, 0x22, 0x33, 0xaa, 0xbb, 0xcc };
+    uint32_t words[2];
+    led_frame_format_t f = { .device = LED_FRAME_WS2812, .channels = 3, .lut = NULL };
+    CHECK(led_frame_pack(&f, src, 2, words) == 2, "two words");
+    // same as ws2812_write(0x112233) which pushes pixel << 8
+    CHECK(words[0] == (0x112233u << 8), "pixel 0 in the top 24 bits");
+    CHECK(words[1] == (0xaabbccu << 8), "pixel 1 in the top 24 bits");
+    CHECK(led_frame_end_words(&f, 1000) == 0, "no end frame for WS2812");
+}
+
+static void test_ws2812_rgbw(void) {
+    const uint8_t src[] = { 0x01, 0x02, 0x03, 0x04 };
+    uint32_t word;
+    led_frame_format_t f = { .device = LED_FRAME_WS2812, .channels = 4, .lut = NULL };
+    led_frame_pack(&f, src, 1, &word);
+    CHECK(word == 0x01020304u, "RGBW uses all 32 bits");
+}
+
+static void test_apa102(void) {
+    const uint8_t rgb[] = { 0x10, 0x20, 0x30 };
+    const uint8_t hrgb[] = { 0xe3, 0x10, 0x20, 0x30 };
+    uint32_t word;
+    led_frame_format_t f = { .device = LED_FRAME_APA102, .channels = 3, .lut = NULL };
+    led_frame_pack(&f, rgb, 1, &word);
+    CHECK(word == 0xff102030u, "APA102 full brightness header");
+    f.channels = 4;
+    led_frame_pack(&f, hrgb, 1, &word);
+    CHECK(word == 0xe3102030u, "APA102 header passed through");
+
+    uint8_t lut[256];
+    led_frame_lut(lut, 1.0f, 0);
+    f.lut = lut;
+    led_frame_pack(&f, hrgb, 1, &word);
+    CHECK(word == 0xe3000000u, "lut applies to colours, not the header");
+
+    CHECK(led_frame_end_words(&f, 1) == 1, "at least one end word");
+    CHECK(led_frame_end_words(&f, 64) == 1, "64 pixels fit one end word");
+    CHECK(led_frame_end_words(&f, 65) == 2, "65 pixels need two");
+    CHECK(led_frame_end_words(&f, 4000) == 63, "4000 pixels");
+}
+
+static void test_lut(void) {
+    uint8_t lut[256];
+    led_frame_lut(lut, 1.0f, 255);
+    bool identity = true;
+    for (int i = 0; i < 256; i++) {
+        identity &= (lut[i] == i);
+    }
+    CHECK(identity, "gamma 1.0 at full brightness is identity");
+
+    led_frame_lut(lut, 2.2f, 255);
+    CHECK(lut[0] == 0 && lut[255] == 255, "gamma keeps the end points");
+    CHECK(lut[128] >= 54 && lut[128] <= 56, "gamma 2.2 mid point");
+    bool monotonic = true;
+    for (int i = 1; i < 256; i++) {
+        monotonic &= (lut[i] >= lut[i - 1]);
+    }
+    CHECK(monotonic, "gamma table is monotonic");
+
+    led_frame_lut(lut, 1.0f, 128);
+    CHECK(lut[255] == 128 && lut[100] == 50, "brightness scales linearly");
+}
+
+static void test_frame_time(void) {
+    led_frame_format_t ws = { .device = LED_FRAME_WS2812, .channels = 3 };
+    led_frame_format_t wsw = { .device = LED_FRAME_WS2812, .channels = 4 };
+    led_frame_format_t apa = { .device = LED_FRAME_APA102, .channels = 3 };
+    // 24 bits at 800kHz is 30us per pixel, plus the reset
+    CHECK(led_frame_time_us(&ws, 300, 800000) == 9000 + 65, "300 WS2812");
+    CHECK(led_frame_time_us(&ws, 1000, 800000) == 30000 + 65, "1000 WS2812");
+    CHECK(led_frame_time_us(&ws, 4000, 800000) == 120000 + 65, "4000 WS2812");
+    CHECK(led_frame_time_us(&wsw, 1000, 800000) == 40000 + 65, "1000 RGBW");
+    // (1 + 4000 + 63) words of 32 bits at 5MHz
+    CHECK(led_frame_time_us(&apa, 4000, 5000000) == (4064u * 32u + 4) / 5, "4000 APA102");
+
+    const uint32_t sizes[] = { 300, 1000, 4000 };
+    printf("frames/sec  WS2812 800kHz / RGBW / APA102 5MHz\n");
+    for (int i = 0; i < 3; i++) {
+        printf("%5u px    %6.1f / %6.1f / %6.1f\n", sizes[i], 1e6 / led_frame_time_us(&ws, sizes[i], 800000),
+               1e6 / led_frame_time_us(&wsw, sizes[i], 800000), 1e6 / led_frame_time_us(&apa, sizes[i], 5000000));
+    }
+}
+
+int main(void) {
+    test_ws2812_rgb();
+    test_ws2812_rgbw();
+    test_apa102();
+    test_lut();
+    test_frame_time();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,429 @@
+/*
+ * test_line_fmt.c — Host-side tests for the line buffered hex dump/number formatter
+ *
+ * Golden tests: the printf based ui_hex_row_config() and
+ * ui_format_print_number_3() are copied below (printing into a string)
+ * and line_fmt must produce the same bytes for every case, with and
+ * without colour. Ends with a rows/sec benchmark of both.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_line_fmt test_line_fmt.c ../src/lib/line_fmt/line_fmt.c && ./test_line_fmt
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <time.h>
+#include "lib/line_fmt/line_fmt.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+// terminal colour strings, empty when colour is off
+static const char* c_reset;
+static const char* c_grey;
+static const char* c_num;
+static const char* c_info;
+
+static void set_color(bool on) {
+    c_reset = on ? "\x1b[0m" : "";
+    c_grey = on ? "\x1b[38;2;128;128;128m" : "";
+    c_num = on ? "\x1b[38;2;83;166;230m" : "";
+    c_info = on ? "\x1b[38;2;191;165;48m" : "";
+}
+
+// reference output
+static char ref[8192];
+static uint32_t ref_len;
+
+static void rprintf(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    ref_len += vsnprintf(&ref[ref_len], sizeof(ref) - ref_len, fmt, args);
+    va_end(args);
+}
+
+// line_fmt output
+static char out[8192];
+static uint32_t out_len;
+static uint32_t flushes;
+
+static void sink(const char* buf, uint32_t len) {
+    memcpy(&out[out_len], buf, len);
+    out_len += len;
+    flushes++;
+}
+
+static void reset_output(void) {
+    ref_len = out_len = flushes = 0;
+}
+
+static bool same_output(void) {
+    return ref_len == out_len && memcmp(ref, out, ref_len) == 0;
+}
+
+/* reference: ui_hex.c before line buffering */
+
+static void ref_row_color(bool* is_grey, bool* is_nonzero, uint32_t address, uint8_t byte, uint32_t start,
+                          uint32_t requested, const char* color_func) {
+    if ((address) < start || (address) > start + requested - 1) {
+        if (!(*is_grey)) {
+            (*is_grey) = true;
+            rprintf("%s", c_grey);
+        }
+    } else {
+        if ((byte == 0x00 || byte == 0xFF)) {
+            if ((*is_grey) || (*is_nonzero)) {
+                (*is_nonzero) = false;
+                rprintf("%s", c_reset);
+            }
+        } else {
+            if ((*is_grey) || !(*is_nonzero)) {
+                (*is_nonzero) = true;
+                rprintf("%s", color_func);
+            }
+        }
+        (*is_grey) = false;
+    }
+}
+
+static void ref_ascii_color(bool* is_grey, bool* is_nonzero, uint32_t address, uint8_t byte, uint32_t start,
+                            uint32_t requested, const char* color_func) {
+    if ((address) < start || (address) > start + requested - 1) {
+        if (!(*is_grey)) {
+            (*is_grey) = true;
+            rprintf("%s", c_grey);
+        }
+    } else {
+        if (byte >= 32 && byte <= 126) {
+            if ((*is_grey) || !(*is_nonzero)) {
+                (*is_nonzero) = true;
+                rprintf("%s", color_func);
+            }
+        } else {
+            if ((*is_grey) || (*is_nonzero)) {
+                (*is_nonzero) = false;
+                rprintf("%s", c_reset);
+            }
+        }
+        (*is_grey) = false;
+    }
+}
+
+static void ref_hex_row(uint32_t address, const uint8_t* buf, uint32_t buf_size, uint32_t start, uint32_t requested,
+                        bool quiet) {
+    if (!quiet) {
+        rprintf("%08X: ", address);
+    }
+    bool is_nonzero = false;
+    bool is_grey = false;
+    for (uint32_t j = 0; j < 16; j++) {
+        if (j < buf_size) {
+            ref_row_color(&is_grey, &is_nonzero, address + j, buf[j], start, requested, c_num);
+            rprintf("%02X ", (uint8_t)buf[j]);
+        } else {
+            rprintf("   ");
+        }
+    }
+    if (!quiet) {
+        rprintf("%s|", c_reset);
+        is_nonzero = false;
+        is_grey = false;
+        for (uint32_t j = 0; j < 16; j++) {
+            if (j < buf_size) {
+                ref_ascii_color(&is_grey, &is_nonzero, address + j, buf[j], start, requested, c_info);
+                if (buf[j] >= 32 && buf[j] <= 126) {
+                    rprintf("%c", buf[j]);
+                } else {
+                    rprintf(".");
+                }
+            } else {
+                rprintf(" ");
+            }
+        }
+        rprintf("%s|\r\n", c_reset);
+    } else {
+        rprintf("%s\r\n", c_reset);
+    }
+}
+
+/* reference: ui_format.c before line buffering */
+
+static const char ascii_hex[] = "0123456789ABCDEF";
+
+static const char* ref_get_color(bool* state) {
+    const char* color = (*state) ? c_num : c_reset;
+    *state = !(*state);
+    return color;
+}
+
+static void ref_number(uint32_t value, uint32_t num_bits, uint32_t display_format) {
+    value = (num_bits < 32) ? (value & ((1u << num_bits) - 1)) : value;
+    switch (display_format) {
+        case LINE_FMT_ASCII:
+        case LINE_FMT_HEX: {
+            uint8_t nibbles = (num_bits + 3) / 4;
+            uint8_t total_bits = ((nibbles + 1) & ~1) * 4;
+            bool color_state = true;
+            rprintf("0x");
+            for (uint8_t pos = total_bits; pos > 0; pos -= 8) {
+                rprintf("%s", ref_get_color(&color_state));
+                rprintf("%c%c", ascii_hex[(value >> (pos - 4)) & 0x0F], ascii_hex[(value >> (pos - 8)) & 0x0F]);
+            }
+            rprintf("%s", c_reset);
+            break;
+        }
+        case LINE_FMT_DEC:
+            rprintf("%u", value);
+            break;
+        case LINE_FMT_BIN: {
+            uint8_t nibble_pos = num_bits % 4;
+            if (nibble_pos == 0) nibble_pos = 4;
+            bool color_state = false;
+            rprintf("0b%s", c_num);
+            for (uint8_t i = 0; i < num_bits; i++) {
+                if (nibble_pos == 0) {
+                    rprintf("%s", ref_get_color(&color_state));
+                    nibble_pos = 4;
+                }
+                nibble_pos--;
+                uint32_t bit = (value >> (num_bits - 1 - i)) & 1;
+                rprintf("%c", '0' + bit);
+            }
+            rprintf("%s", c_reset);
+            break;
+        }
+    }
+    if (num_bits != 8) {
+        rprintf(".%d", num_bits);
+    }
+}
+
+static void ref_ascii(uint32_t value) {
+    if ((char)value >= ' ' && (char)value <= '~') {
+        rprintf("'%c' ", (char)value);
+    } else {
+        rprintf("''  ");
+    }
+}
+
+static void make_colors(line_fmt_colors_t* c) {
+    line_fmt_colors(c, c_reset, c_grey, c_num, c_info);
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_hex_rows(void) {
+    uint8_t data[256];
+    srand(1);
+    for (int i = 0; i < 256; i++) {
+        // runs of 0x00/0xFF, text and binary to exercise every colour change
+        int r = rand() % 4;
+        data[i] = (r == 0) ? 0x00 : (r == 1) ? 0xff : (r == 2) ? (uint8_t)(' ' + rand() % 95) : (uint8_t)rand();
+    }
+
+    const uint32_t starts[] = { 0, 3, 0x10, 0x1f, 0x7ffffff5 };
+    const uint32_t lengths[] = { 1, 5, 16, 40, 256 };
+    const uint32_t sizes[] = { 16, 15, 7, 1, 0 };
+
+    for (int color = 0; color < 2; color++) {
+        set_color(color);
+        line_fmt_colors_t c;
+        make_colors(&c);
+        bool ok = true;
+        for (int quiet = 0; quiet < 2; quiet++) {
+            for (int s = 0; s < 5; s++) {
+                for (int n = 0; n < 5; n++) {
+                    for (int z = 0; z < 5; z++) {
+                        uint32_t row = starts[s] & 0xfffffff0;
+                        for (uint32_t r = 0; r < 3; r++) {
+                            uint32_t address = row + r * 16;
+                            reset_output();
+                            ref_hex_row(address, &data[(r * 16) & 0xff], sizes[z], starts[s], lengths[n], quiet);
+                            line_fmt_t l;
+                            line_fmt_init(&l, sink);
+                            line_fmt_hex_row(&l, &c, address, &data[(r * 16) & 0xff], sizes[z], starts[s],
+                                             lengths[n], quiet);
+                            line_fmt_flush(&l);
+                            if (!same_output()) {
+                                ok = false;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        CHECK(ok, color ? "hex rows match printf output (colour)" : "hex rows match printf output (no colour)");
+    }
+}
+
+static void test_hex_row_one_flush(void) {
+    set_color(true);
+    line_fmt_colors_t c;
+    make_colors(&c);
+    uint8_t data[16];
+    for (int i = 0; i < 16; i++) {
+        data[i] = (i & 1) ? 'A' + i : 0x80 + i; // worst case, colour changes every byte
+    }
+    reset_output();
+    line_fmt_t l;
+    line_fmt_init(&l, sink);
+    line_fmt_hex_row(&l, &c, 0, data, 16, 0, 16, false);
+    CHECK(flushes == 0, "nothing sent before the flush");
+    line_fmt_flush(&l);
+    CHECK(flushes == 1, "a full colour row is one write");
+    line_fmt_flush(&l);
+    CHECK(flushes == 1, "empty flush sends nothing");
+}
+
+static void test_overflow(void) {
+    set_color(true);
+    line_fmt_colors_t c;
+    make_colors(&c);
+    uint8_t data[16];
+    for (int i = 0; i < 16; i++) {
+        data[i] = (i & 1) ? 'A' + i : 0x80 + i;
+    }
+    // several rows into one buffer must split cleanly
+    reset_output();
+    line_fmt_t l;
+    line_fmt_init(&l, sink);
+    for (uint32_t r = 0; r < 8; r++) {
+        ref_hex_row(r * 16, data, 16, 0, 128, false);
+        line_fmt_hex_row(&l, &c, r * 16, data, 16, 0, 128, false);
+    }
+    line_fmt_flush(&l);
+    CHECK(same_output(), "rows spanning buffer flushes match");
+    CHECK(flushes > 1, "buffer flushed when full");
+
+    char big[1000];
+    memset(big, 'x', sizeof(big));
+    reset_output();
+    line_fmt_put(&l, big, sizeof(big));
+    line_fmt_flush(&l);
+    CHECK(out_len == sizeof(big) && memcmp(out, big, sizeof(big)) == 0, "long put is split");
+}
+
+static void test_numbers(void) {
+    const uint32_t values[] = { 0, 1, 0x5a, 0xff, 0x1234, 0xdeadbeef, 0x80000001 };
+    const uint32_t bits[] = { 1, 3, 4, 7, 8, 9, 12, 16, 17, 24, 31, 32 };
+    const uint32_t formats[] = { LINE_FMT_AUTO, LINE_FMT_HEX, LINE_FMT_DEC, LINE_FMT_BIN, LINE_FMT_ASCII };
+
+    for (int color = 0; color < 2; color++) {
+        set_color(color);
+        line_fmt_colors_t c;
+        make_colors(&c);
+        bool ok = true;
+        for (int v = 0; v < 7; v++) {
+            for (int b = 0; b < 12; b++) {
+                for (int f = 0; f < 5; f++) {
+                    reset_output();
+                    ref_number(values[v], bits[b], formats[f]);
+                    line_fmt_t l;
+                    line_fmt_init(&l, sink);
+                    line_fmt_number(&l, &c, values[v], bits[b], formats[f]);
+                    line_fmt_flush(&l);
+                    if (!same_output()) {
+                        printf("  %08X.%u fmt %u: '%.*s' vs '%.*s'\n", values[v], bits[b], formats[f], ref_len, ref,
+                               out_len, out);
+                        ok = false;
+                    }
+                }
+            }
+        }
+        CHECK(ok, color ? "numbers match printf output (colour)" : "numbers match printf output (no colour)");
+    }
+
+    bool ok = true;
+    for (uint32_t v = 0; v < 256; v++) {
+        reset_output();
+        ref_ascii(v);
+        line_fmt_t l;
+        line_fmt_init(&l, sink);
+        line_fmt_ascii(&l, v);
+        line_fmt_flush(&l);
+        ok &= same_output();
+    }
+    CHECK(ok, "ASCII prefix matches for all bytes");
+}
+
+static void test_dec_hex8(void) {
+    line_fmt_t l;
+    reset_output();
+    line_fmt_init(&l, sink);
+    line_fmt_dec(&l, 0);
+    line_fmt_putc(&l, ' ');
+    line_fmt_dec(&l, 4294967295u);
+    line_fmt_putc(&l, ' ');
+    line_fmt_hex8(&l, 0x00abcdefu);
+    line_fmt_flush(&l);
+    CHECK(out_len == 21 && memcmp(out, "0 4294967295 00ABCDEF", 21) == 0, "decimal and %08X");
+}
+
+/* ── Benchmark ──────────────────────────────────────────────────── */
+
+static void null_sink(const char* buf, uint32_t len) {
+    (void)buf;
+    out_len += len;
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void benchmark(void) {
+    set_color(true);
+    line_fmt_colors_t c;
+    make_colors(&c);
+    uint8_t data[4096];
+    for (int i = 0; i < 4096; i++) {
+        data[i] = (uint8_t)(i * 37 + (i >> 3));
+    }
+    const uint32_t rows = 200000;
+
+    double t0 = now();
+    for (uint32_t r = 0; r < rows; r++) {
+        ref_len = 0;
+        ref_hex_row(r * 16, &data[(r * 16) & 0xfff], 16, 0, rows * 16, false);
+    }
+    double t_ref = now() - t0;
+
+    line_fmt_t l;
+    line_fmt_init(&l, null_sink);
+    t0 = now();
+    for (uint32_t r = 0; r < rows; r++) {
+        line_fmt_hex_row(&l, &c, r * 16, &data[(r * 16) & 0xfff], 16, 0, rows * 16, false);
+        line_fmt_flush(&l);
+    }
+    double t_line = now() - t0;
+
+    printf("hex rows/sec (host)  printf: %.0f  line_fmt: %.0f  (%.1fx)\n", rows / t_ref, rows / t_line,
+           t_ref / t_line);
+}
+
+int main(void) {
+    test_hex_rows();
+    test_hex_row_one_flush();
+    test_overflow();
+    test_numbers();
+    test_dec_hex8();
+    benchmark();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,604 @@
+/*
+ * test_ow_search.c — Host-side tests for the 1-Wire ROM search and scratchpads
+ *
+ * Runs the search against a simulated bus of N devices (wired AND read
+ * slots, devices that drop out on a direction they do not match, Match
+ * ROM, Skip ROM, Convert T and Read Scratchpad) driven the way the
+ * onewire_search PIO program drives it: 64 preferred directions in, 64
+ * id/cmp pairs out. Checks the table CRC, enumeration of every device
+ * exactly once in one pass each, the bus slots it takes, a bus without
+ * devices, a device that leaves mid search, a bad ROM CRC, the C triplet
+ * path packing the same RX words, and a batched convert-all/read-all.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_ow_search test_ow_search.c ../src/lib/ow_search/ow_search.c && ./test_ow_search
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "lib/ow_search/ow_search.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+#define MAX_DEVICES 128
+
+typedef struct {
+    uint8_t rom[8];
+    uint8_t scratchpad[OW_SCRATCHPAD_LEN];
+    int16_t temp;   // raw reading the next Convert T latches
+    bool present;
+    bool selected;  // still on the bus for this transaction
+    uint32_t conversions;
+} device_t;
+
+typedef struct {
+    device_t dev[MAX_DEVICES];
+    uint32_t count;
+    uint32_t slots;  // read/write time slots
+    uint32_t resets;
+    uint32_t convert_commands;
+    int leave_at_bit;   // device `leave_device` drops off at this triplet, 0 never
+    uint32_t leave_device;
+} bus_t;
+
+static bus_t bus;
+
+static uint8_t crc8_bitwise(const uint8_t* data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t j = 0; j < len; j++) {
+        crc ^= data[j];
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8c : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+static uint32_t rng_state = 0x1234567u;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void make_rom(uint8_t* rom, uint8_t family) {
+    rom[0] = family;
+    for (int i = 1; i < 7; i++) {
+        rom[i] = (uint8_t)rng();
+    }
+    rom[7] = crc8_bitwise(rom, 7);
+}
+
+static void bus_init(void) {
+    memset(&bus, 0, sizeof(bus));
+}
+
+static device_t* bus_add(const uint8_t* rom, int16_t temp) {
+    device_t* d = &bus.dev[bus.count++];
+    memcpy(d->rom, rom, 8);
+    d->temp = temp;
+    d->present = true;
+    memset(d->scratchpad, 0, sizeof(d->scratchpad));
+    d->scratchpad[0] = 0x50; // power on 85 C
+    d->scratchpad[1] = 0x05;
+    d->scratchpad[4] = 0x7f; // 12 bit
+    d->scratchpad[5] = 0xff;
+    d->scratchpad[7] = 0x10;
+    d->scratchpad[8] = crc8_bitwise(d->scratchpad, 8);
+    return d;
+}
+
+// a bus of n distinct devices, some sharing the family code
+static void bus_random(uint32_t n) {
+    bus_init();
+    while (bus.count < n) {
+        uint8_t rom[8];
+        make_rom(rom, (rng() & 1) ? 0x28 : 0x10);
+        bool dup = false;
+        for (uint32_t i = 0; i < bus.count; i++) {
+            dup |= !memcmp(bus.dev[i].rom, rom, 8);
+        }
+        if (!dup) {
+            bus_add(rom, (int16_t)((int32_t)(rng() % 2000) - 800));
+        }
+    }
+}
+
+static bool bus_reset(void) {
+    bool presence = false;
+    bus.resets++;
+    for (uint32_t i = 0; i < bus.count; i++) {
+        bus.dev[i].selected = bus.dev[i].present;
+        presence |= bus.dev[i].present;
+    }
+    return presence;
+}
+
+static uint8_t rom_bit(const device_t* d, uint32_t bit) {
+    return (d->rom[(bit - 1) >> 3] >> ((bit - 1) & 7)) & 1;
+}
+
+// one read slot: the selected devices answer with the bit they are asked for, wired AND
+static uint8_t bus_read_slot(uint32_t bit, bool complement) {
+    uint8_t level = 1;
+    bus.slots++;
+    for (uint32_t i = 0; i < bus.count; i++) {
+        if (bus.dev[i].selected) {
+            level &= complement ? !rom_bit(&bus.dev[i], bit) : rom_bit(&bus.dev[i], bit);
+        }
+    }
+    return level;
+}
+
+// search command byte, devices then follow the triplets
+static void bus_search_command(void) {
+    bus.slots += 8;
+}
+
+// one triplet: devices whose bit does not match the direction drop out
+static void bus_triplet(uint32_t bit, uint8_t* id_bit, uint8_t* cmp_id_bit, uint8_t direction_of(uint8_t, uint8_t, uint8_t), uint8_t preferred) {
+    if (bus.leave_at_bit && (uint32_t)bus.leave_at_bit == bit) {
+        bus.dev[bus.leave_device].present = false;
+        bus.dev[bus.leave_device].selected = false;
+    }
+    *id_bit = bus_read_slot(bit, false);
+    *cmp_id_bit = bus_read_slot(bit, true);
+    uint8_t direction = direction_of(*id_bit, *cmp_id_bit, preferred);
+    bus.slots++;
+    for (uint32_t i = 0; i < bus.count; i++) {
+        if (bus.dev[i].selected && rom_bit(&bus.dev[i], bit) != direction) {
+            bus.dev[i].selected = false;
+        }
+    }
+}
+
+// the decision in hw1wire.pio onewire_search, written out independently
+static uint8_t pio_direction(uint8_t id_bit, uint8_t cmp_id_bit, uint8_t preferred) {
+    if (id_bit) {
+        return 1;
+    }
+    if (cmp_id_bit) {
+        return 0;
+    }
+    return preferred;
+}
+
+/*
+ * onewire_search PIO program model: OSR shifts right and autopulls the
+ * two direction words, ISR shifts right and autopushes every 32 bits.
+ */
+static void pio_search_pass(const uint32_t dir[OW_SEARCH_TX_WORDS], uint32_t rx[OW_SEARCH_RX_WORDS]) {
+    uint32_t isr = 0, isr_count = 0, pushed = 0;
+    for (uint32_t bit = 1; bit <= 64; bit++) {
+        uint8_t preferred = (dir[(bit - 1) >> 5] >> ((bit - 1) & 31)) & 1;
+        uint8_t id_bit, cmp_id_bit;
+        bus_triplet(bit, &id_bit, &cmp_id_bit, pio_direction, preferred);
+        isr = (isr >> 1) | ((uint32_t)id_bit << 31);
+        isr = (isr >> 1) | ((uint32_t)cmp_id_bit << 31);
+        isr_count += 2;
+        if (isr_count == 32) {
+            rx[pushed++] = isr;
+            isr = 0;
+            isr_count = 0;
+        }
+    }
+}
+
+// OWSearch with the PIO program, as hw1wire_pio.c runs it
+static ow_search_status_t search_pio(ow_search_t* s) {
+    uint32_t dir[OW_SEARCH_TX_WORDS], rx[OW_SEARCH_RX_WORDS];
+    if (!bus_reset()) {
+        ow_search_init(s);
+        return OW_SEARCH_NO_DEVICE;
+    }
+    bus_search_command();
+    ow_search_directions(s, dir);
+    pio_search_pass(dir, rx);
+    return ow_search_decode(s, rx);
+}
+
+// OWSearch with the triplets run from C when the program could not be loaded
+static ow_search_status_t search_cpu(ow_search_t* s, uint32_t rx[OW_SEARCH_RX_WORDS]) {
+    memset(rx, 0, OW_SEARCH_RX_WORDS * sizeof(uint32_t));
+    if (!bus_reset()) {
+        ow_search_init(s);
+        return OW_SEARCH_NO_DEVICE;
+    }
+    bus_search_command();
+    for (uint32_t bit = 1; bit <= 64; bit++) {
+        uint8_t id_bit, cmp_id_bit;
+        bus_triplet(bit, &id_bit, &cmp_id_bit, ow_search_triplet, ow_search_preferred(s, bit));
+        ow_search_pack(rx, bit, id_bit, cmp_id_bit);
+    }
+    return ow_search_decode(s, rx);
+}
+
+// ROM order the search visits: bit 1 first, 0 before 1
+static int rom_order(const void* a, const void* b) {
+    const uint8_t *ra = a, *rb = b;
+    for (uint32_t bit = 1; bit <= 64; bit++) {
+        int ba = (ra[(bit - 1) >> 3] >> ((bit - 1) & 7)) & 1;
+        int bb = (rb[(bit - 1) >> 3] >> ((bit - 1) & 7)) & 1;
+        if (ba != bb) {
+            return ba - bb;
+        }
+    }
+    return 0;
+}
+
+static uint8_t found[MAX_DEVICES + 8][8];
+
+// enumerate like the scan command: first, then next until the last device
+static uint32_t enumerate(uint32_t* passes) {
+    ow_search_t s;
+    uint32_t n = 0;
+    *passes = 0;
+    ow_search_init(&s);
+    do {
+        (*passes)++;
+        if (search_pio(&s) != OW_SEARCH_FOUND) {
+            break;
+        }
+        memcpy(found[n++], s.rom, 8);
+    } while (!s.last_device && n < MAX_DEVICES + 8);
+    return n;
+}
+
+static bool enumerated_all(uint32_t n) {
+    uint8_t expect[MAX_DEVICES][8];
+    if (n != bus.count) {
+        return false;
+    }
+    for (uint32_t i = 0; i < bus.count; i++) {
+        memcpy(expect[i], bus.dev[i].rom, 8);
+    }
+    qsort(expect, bus.count, 8, rom_order);
+    return !memcmp(expect, found, (size_t)n * 8);
+}
+
+// device side of Skip ROM / Match ROM and the function commands
+static void bus_write_byte(uint8_t byte) {
+    bus.slots += 8;
+    if (byte == 0x44) {
+        bus.convert_commands++;
+        for (uint32_t i = 0; i < bus.count; i++) {
+            device_t* d = &bus.dev[i];
+            if (d->selected) {
+                d->conversions++;
+                d->scratchpad[0] = (uint8_t)d->temp;
+                d->scratchpad[1] = (uint8_t)((uint16_t)d->temp >> 8);
+                d->scratchpad[8] = crc8_bitwise(d->scratchpad, 8);
+            }
+        }
+    }
+}
+
+static void bus_match_rom(const uint8_t* rom) {
+    bus_write_byte(0x55);
+    bus.slots += 64;
+    for (uint32_t i = 0; i < bus.count; i++) {
+        if (memcmp(bus.dev[i].rom, rom, 8)) {
+            bus.dev[i].selected = false;
+        }
+    }
+}
+
+static void bus_read_scratchpad(uint8_t* out) {
+    bus_write_byte(0xbe);
+    memset(out, 0xff, OW_SCRATCHPAD_LEN);
+    bus.slots += OW_SCRATCHPAD_LEN * 8;
+    for (uint32_t i = 0; i < bus.count; i++) {
+        if (bus.dev[i].selected) {
+            for (uint32_t b = 0; b < OW_SCRATCHPAD_LEN; b++) {
+                out[b] &= bus.dev[i].scratchpad[b];
+            }
+        }
+    }
+}
+
+static void scratchpad_with_crc(uint8_t* sp, uint8_t lsb, uint8_t msb, uint8_t config, uint8_t remain, uint8_t per_c) {
+    memset(sp, 0, OW_SCRATCHPAD_LEN);
+    sp[0] = lsb;
+    sp[1] = msb;
+    sp[4] = config;
+    sp[5] = 0xff;
+    sp[6] = remain;
+    sp[7] = per_c;
+    sp[8] = crc8_bitwise(sp, 8);
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_crc8(void) {
+    printf("test_crc8\n");
+    bool same = true;
+    for (int i = 0; i < 256; i++) {
+        uint8_t b = (uint8_t)i;
+        same &= (ow_crc8(&b, 1) == crc8_bitwise(&b, 1));
+    }
+    CHECK(same, "table matches the bitwise CRC for every byte");
+
+    // Maxim AN27 example ROM
+    const uint8_t rom[8] = { 0x02, 0x1c, 0xb8, 0x01, 0x00, 0x00, 0x00, 0xa2 };
+    CHECK(ow_crc8(rom, 7) == 0xa2, "AN27 example CRC");
+    CHECK(ow_crc8(rom, 8) == 0, "block with its CRC gives 0");
+    CHECK(ow_crc8(rom, 0) == 0, "empty block");
+
+    uint8_t buf[64];
+    for (int i = 0; i < 64; i++) {
+        buf[i] = (uint8_t)rng();
+    }
+    CHECK(ow_crc8(buf, 64) == crc8_bitwise(buf, 64), "long block");
+}
+
+static void test_directions(void) {
+    printf("test_directions\n");
+    ow_search_t s;
+    uint32_t dir[2];
+    ow_search_init(&s);
+    ow_search_directions(&s, dir);
+    CHECK(dir[0] == 0 && dir[1] == 0, "first pass prefers 0 everywhere");
+
+    s.rom[0] = 0xa5;
+    s.rom[1] = 0xff;
+    s.last_discrepancy = 6;
+    ow_search_directions(&s, dir);
+    // bits 1-5 from the ROM (1,0,1,0,0), bit 6 forced 1, the rest 0
+    CHECK(dir[0] == 0x25 && dir[1] == 0, "previous ROM up to the discrepancy, then 1, then 0");
+
+    s.last_discrepancy = 40;
+    memset(s.rom, 0xff, 8);
+    ow_search_directions(&s, dir);
+    CHECK(dir[0] == 0xffffffff && dir[1] == 0xff, "discrepancy in the second word");
+
+    CHECK(ow_search_triplet(0, 1, 1) == 0, "0/1 writes 0");
+    CHECK(ow_search_triplet(1, 0, 0) == 1, "1/0 writes 1");
+    CHECK(ow_search_triplet(0, 0, 0) == 0 && ow_search_triplet(0, 0, 1) == 1, "0/0 takes the preference");
+    CHECK(ow_search_triplet(1, 1, 0) == 1, "1/1 writes 1");
+}
+
+static void test_single_device(void) {
+    printf("test_single_device\n");
+    const uint8_t rom[8] = { 0x28, 0xff, 0x64, 0x1e, 0x0f, 0x00, 0x00, 0x00 };
+    uint8_t r[8];
+    memcpy(r, rom, 8);
+    r[7] = crc8_bitwise(r, 7);
+    bus_init();
+    bus_add(r, 0);
+
+    ow_search_t s;
+    ow_search_init(&s);
+    CHECK(search_pio(&s) == OW_SEARCH_FOUND, "found");
+    CHECK(!memcmp(s.rom, r, 8), "ROM");
+    CHECK(s.last_device, "it is the last device");
+    CHECK(s.last_discrepancy == 0, "no discrepancy");
+    CHECK(bus.slots == OW_SEARCH_PASS_SLOTS && bus.resets == 1, "one reset and 200 slots");
+}
+
+static void test_enumerate(uint32_t n) {
+    char msg[80];
+    printf("test_enumerate %u\n", n);
+    bus_random(n);
+    uint32_t passes;
+    uint32_t got = enumerate(&passes);
+    snprintf(msg, sizeof(msg), "%u devices found once each, in search order", n);
+    CHECK(enumerated_all(got), msg);
+    snprintf(msg, sizeof(msg), "%u devices in %u passes", n, n);
+    CHECK(passes == n, msg);
+    CHECK(bus.resets == n && bus.slots == n * OW_SEARCH_PASS_SLOTS, "one reset and 200 slots per device");
+}
+
+static void test_close_roms(void) {
+    printf("test_close_roms\n");
+    // same family and serial but one bit, the search has to branch late
+    bus_init();
+    uint8_t rom[8] = { 0x28, 0x11, 0x22, 0x33, 0x44, 0x55, 0x00, 0x00 };
+    for (int i = 0; i < 8; i++) {
+        rom[6] = (uint8_t)(1u << i);
+        rom[7] = crc8_bitwise(rom, 7);
+        bus_add(rom, 0);
+    }
+    rom[6] = 0;
+    rom[7] = crc8_bitwise(rom, 7);
+    bus_add(rom, 0);
+    uint32_t passes;
+    uint32_t got = enumerate(&passes);
+    CHECK(enumerated_all(got), "9 devices a bit apart");
+    CHECK(passes == 9, "one pass each");
+}
+
+static void test_no_device(void) {
+    printf("test_no_device\n");
+    ow_search_t s;
+    uint32_t rx[OW_SEARCH_RX_WORDS];
+    bus_init();
+    ow_search_init(&s);
+    s.last_discrepancy = 12;
+    CHECK(search_pio(&s) == OW_SEARCH_NO_DEVICE, "no presence");
+    CHECK(s.last_discrepancy == 0 && !s.last_device, "state cleared");
+
+    // 1/1 from a pass that lost every device
+    memset(rx, 0xff, sizeof(rx));
+    ow_search_init(&s);
+    CHECK(ow_search_decode(&s, rx) == OW_SEARCH_NO_DEVICE, "1/1 everywhere");
+
+    // bus stuck low: 0/0 everywhere decodes as the all zero ROM
+    memset(rx, 0, sizeof(rx));
+    CHECK(ow_search_decode(&s, rx) == OW_SEARCH_NO_DEVICE, "bus held low");
+}
+
+static void test_device_leaves(void) {
+    printf("test_device_leaves\n");
+    bus_random(4);
+    uint8_t expect[4][8];
+    for (int i = 0; i < 4; i++) {
+        memcpy(expect[i], bus.dev[i].rom, 8);
+    }
+    qsort(expect, 4, 8, rom_order);
+
+    ow_search_t s;
+    ow_search_init(&s);
+    CHECK(search_pio(&s) == OW_SEARCH_FOUND, "first found");
+    // the device the next pass heads for drops off before its last bit
+    for (uint32_t i = 0; i < bus.count; i++) {
+        if (!memcmp(bus.dev[i].rom, expect[1], 8)) {
+            bus.leave_device = i;
+        }
+    }
+    bus.leave_at_bit = 64;
+    CHECK(search_pio(&s) == OW_SEARCH_NO_DEVICE, "1/1 once it is gone");
+    CHECK(s.last_discrepancy == 0 && !s.last_device, "search restarts");
+}
+
+static void test_bad_crc(void) {
+    printf("test_bad_crc\n");
+    uint8_t rom[8];
+    make_rom(rom, 0x28);
+    rom[7] ^= 0x01;
+    bus_init();
+    bus_add(rom, 0);
+    ow_search_t s;
+    ow_search_init(&s);
+    CHECK(search_pio(&s) == OW_SEARCH_CRC, "CRC failure reported");
+    CHECK(s.last_discrepancy == 0 && !s.last_device, "state cleared");
+}
+
+static void test_cpu_path(void) {
+    printf("test_cpu_path\n");
+    bus_random(12);
+    ow_search_t a, b;
+    ow_search_init(&a);
+    ow_search_init(&b);
+    bool same = true;
+    uint32_t n = 0;
+    do {
+        uint32_t rx_cpu[OW_SEARCH_RX_WORDS], rx_pio[OW_SEARCH_RX_WORDS], dir[OW_SEARCH_TX_WORDS];
+        // PIO words for the same pass, from the same state
+        bus_reset();
+        ow_search_directions(&b, dir);
+        pio_search_pass(dir, rx_pio);
+        ow_search_status_t sb = ow_search_decode(&b, rx_pio);
+        ow_search_status_t sa = search_cpu(&a, rx_cpu);
+        same &= (sa == sb) && !memcmp(rx_cpu, rx_pio, sizeof(rx_cpu)) && !memcmp(&a, &b, sizeof(a));
+        n++;
+    } while (!a.last_device && n < 20);
+    CHECK(same, "C triplets pack the RX words the program pushes");
+    CHECK(n == 12, "both find all 12");
+}
+
+static void test_temp_decode(void) {
+    printf("test_temp_decode\n");
+    uint8_t sp[OW_SCRATCHPAD_LEN];
+    int32_t t = 0;
+
+    // DS18B20 datasheet table
+    scratchpad_with_crc(sp, 0x91, 0x01, 0x7f, 0x0c, 0x10);
+    CHECK(ow_temp_decode(0x28, sp, &t) == OW_TEMP_OK && t == 401, "+25.0625");
+    scratchpad_with_crc(sp, 0x5e, 0xff, 0x7f, 0x0c, 0x10);
+    CHECK(ow_temp_decode(0x28, sp, &t) == OW_TEMP_OK && t == -162, "-10.125");
+    scratchpad_with_crc(sp, 0x90, 0xfc, 0x7f, 0x0c, 0x10);
+    CHECK(ow_temp_decode(0x28, sp, &t) == OW_TEMP_OK && t == -880, "-55");
+    scratchpad_with_crc(sp, 0x91, 0x01, 0x1f, 0x0c, 0x10);
+    CHECK(ow_temp_decode(0x28, sp, &t) == OW_TEMP_OK && t == 400, "9 bit drops the undefined bits");
+
+    // DS18S20: 25 C, COUNT_REMAIN 12 -> 25.0, COUNT_REMAIN 4 -> 25.5
+    scratchpad_with_crc(sp, 0x32, 0x00, 0xff, 0x0c, 0x10);
+    CHECK(ow_temp_decode(0x10, sp, &t) == OW_TEMP_OK && t == 400, "DS18S20 extended 25.0");
+    scratchpad_with_crc(sp, 0x32, 0x00, 0xff, 0x04, 0x10);
+    CHECK(ow_temp_decode(0x10, sp, &t) == OW_TEMP_OK && t == 408, "DS18S20 extended 25.5");
+    scratchpad_with_crc(sp, 0xff, 0xff, 0xff, 0x10, 0x10);
+    CHECK(ow_temp_decode(0x10, sp, &t) == OW_TEMP_OK && t == -20, "DS18S20 -0.5 reads -1.25");
+
+    scratchpad_with_crc(sp, 0x91, 0x01, 0x7f, 0x0c, 0x10);
+    sp[2] ^= 0x40;
+    CHECK(ow_temp_decode(0x28, sp, &t) == OW_TEMP_CRC, "CRC failure");
+    memset(sp, 0xff, sizeof(sp));
+    CHECK(ow_temp_decode(0x28, sp, &t) == OW_TEMP_NO_DATA, "nobody answered");
+
+    CHECK(ow_temp_family(0x28) && ow_temp_family(0x10) && ow_temp_family(0x22) && ow_temp_family(0x3b),
+          "temperature families");
+    CHECK(!ow_temp_family(0x2d) && !ow_temp_family(0x01), "other families");
+}
+
+static void test_batch_convert(void) {
+    printf("test_batch_convert\n");
+    const uint32_t n = 24;
+    bus_random(n);
+    uint32_t passes;
+    uint32_t got = enumerate(&passes);
+    CHECK(got == n, "all sensors found");
+    uint32_t search_slots = bus.slots;
+
+    // one Skip ROM Convert T for the whole bus
+    bus_reset();
+    bus_write_byte(0xcc);
+    bus_write_byte(0x44);
+    CHECK(bus.convert_commands == 1, "a single conversion command");
+    bool all_converted = true;
+    for (uint32_t i = 0; i < n; i++) {
+        all_converted &= (bus.dev[i].conversions == 1);
+    }
+    CHECK(all_converted, "every sensor converted once");
+
+    // then Match ROM and Read Scratchpad each
+    bool all_read = true;
+    for (uint32_t i = 0; i < got; i++) {
+        uint8_t sp[OW_SCRATCHPAD_LEN];
+        int32_t t;
+        bus_reset();
+        bus_match_rom(found[i]);
+        bus_read_scratchpad(sp);
+        const device_t* d = NULL;
+        for (uint32_t j = 0; j < n; j++) {
+            if (!memcmp(bus.dev[j].rom, found[i], 8)) {
+                d = &bus.dev[j];
+            }
+        }
+        if (found[i][0] == 0x10) {
+            all_read &= d && ow_temp_decode(found[i][0], sp, &t) == OW_TEMP_OK;
+        } else {
+            all_read &= d && ow_temp_decode(found[i][0], sp, &t) == OW_TEMP_OK && t == d->temp;
+        }
+    }
+    CHECK(all_read, "every scratchpad reads back with a good CRC and its own reading");
+    // convert: 16 slots once, read: 8 + 64 + 8 + 72 slots per sensor
+    CHECK(bus.slots - search_slots == 16 + n * 152, "slot count of the batch");
+}
+
+int main(void) {
+    printf("=== ow_search tests ===\n\n");
+
+    test_crc8();
+    test_directions();
+    test_single_device();
+    test_enumerate(1);
+    test_enumerate(2);
+    test_enumerate(5);
+    test_enumerate(32);
+    test_enumerate(100);
+    test_close_roms();
+    test_no_device();
+    test_device_leaves();
+    test_bad_crc();
+    test_cpu_path();
+    test_temp_decode();
+    test_batch_convert();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,288 @@
+/*
+ * test_pattern.c — Host-side tests for the pattern generator vector tables
+ *
+ * Compiles text vectors (holds, nested groups, bad input), lays the table
+ * out for looped and counted runs and plays the output buffer back through
+ * a model of the wavegen PIO (32 bit words shifted out 8 bits at a time,
+ * right shift) to check the pins see the table in order, forever or N
+ * times followed by the last vector. The clock planner is checked against
+ * the divider and delay loop arithmetic for a range of rates.
+ *
+ * Build and run:
+ *   gcc -O2 -Wall -Wextra -I../src -o test_pattern test_pattern.c ../src/lib/pattern/pattern.c -lm && ./test_pattern
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "lib/pattern/pattern.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+#define CAP (128u * 1024u)
+static uint8_t table[CAP];
+static uint8_t buf[CAP];
+
+static uint32_t rng_state = 0x12345678;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static pattern_result_t compile(const char* text, uint8_t* out, uint32_t cap) {
+    pattern_result_t res;
+    pattern_compile(text, strlen(text), out, cap, &res);
+    return res;
+}
+
+// the PIO: autopull 32 bits, out pins 8 with right shift
+static uint8_t pio_sample(const uint8_t* out, uint32_t bytes, uint64_t n) {
+    uint32_t words = bytes / 4;
+    uint32_t w = (uint32_t)((n / 4) % words);
+    uint32_t word = (uint32_t)out[w * 4] | ((uint32_t)out[w * 4 + 1] << 8) | ((uint32_t)out[w * 4 + 2] << 16) |
+                    ((uint32_t)out[w * 4 + 3] << 24);
+    return (uint8_t)(word >> (8 * (n % 4)));
+}
+
+/* ── Compiler ───────────────────────────────────────────────────── */
+
+static void test_compile(void) {
+    printf("compile:\n");
+    pattern_result_t r = compile("0x01 0b10, 4 255", table, CAP);
+    CHECK(r.err == PATTERN_OK && r.len == 4, "four plain vectors");
+    CHECK(table[0] == 1 && table[1] == 2 && table[2] == 4 && table[3] == 255, "hex, binary and decimal");
+
+    r = compile("0x80:100 0", table, CAP);
+    CHECK(r.err == PATTERN_OK && r.len == 101, "hold for 100 samples");
+    CHECK(table[0] == 0x80 && table[99] == 0x80 && table[100] == 0, "held vector then the next");
+
+    r = compile("{1 0}:8", table, CAP);
+    CHECK(r.err == PATTERN_OK && r.len == 16, "group repeat");
+    bool ok = true;
+    for (uint32_t i = 0; i < 16; i++) {
+        ok &= table[i] == ((i & 1) ? 0 : 1);
+    }
+    CHECK(ok, "group alternates");
+
+    r = compile("0xff {{1:2 2}:3 {4}:2}:2 0", table, CAP);
+    // inner: 1 1 2 x3 = 9, 4 x2 = 2, total 11, x2 = 22, plus the two ends
+    CHECK(r.err == PATTERN_OK && r.len == 24, "nested groups");
+    CHECK(table[0] == 0xff && table[1] == 1 && table[3] == 2 && table[10] == 4 && table[12] == 1 && table[23] == 0,
+          "nested groups expand in order");
+
+    r = compile("{{{{1}:2}:2}:2}:2", table, CAP);
+    CHECK(r.err == PATTERN_OK && r.len == 16, "four levels deep");
+    r = compile("{{{{{1}}}}}", table, CAP);
+    CHECK(r.err == PATTERN_ERR_GROUP && r.pos == 4, "five levels is too deep");
+
+    const char* text = "1 2 3 -r 1000";
+    const char* end = pattern_compile(text, strlen(text), table, CAP, &r);
+    CHECK(r.err == PATTERN_OK && r.len == 3 && *end == '-', "stops at the flags");
+
+    end = pattern_compile(text, 3, table, CAP, &r);
+    CHECK(r.err == PATTERN_OK && r.len == 2 && end == text + 3, "respects the length");
+}
+
+static void test_errors(void) {
+    printf("errors:\n");
+    pattern_result_t r = compile("1 2 x", table, CAP);
+    CHECK(r.err == PATTERN_ERR_SYNTAX && r.pos == 4, "not a number");
+    r = compile("1 12z", table, CAP);
+    CHECK(r.err == PATTERN_ERR_SYNTAX && r.pos == 2, "junk after a number");
+    r = compile("0x", table, CAP);
+    CHECK(r.err == PATTERN_ERR_SYNTAX, "prefix without digits");
+    r = compile("0 256", table, CAP);
+    CHECK(r.err == PATTERN_ERR_VALUE && r.pos == 2, "above 0xff");
+    r = compile("1:0", table, CAP);
+    CHECK(r.err == PATTERN_ERR_REPEAT && r.pos == 1, "zero repeat");
+    r = compile("{1}:", table, CAP);
+    CHECK(r.err == PATTERN_ERR_REPEAT, "missing repeat");
+    r = compile("{1 2", table, CAP);
+    CHECK(r.err == PATTERN_ERR_GROUP, "unclosed group");
+    r = compile("1 2}", table, CAP);
+    CHECK(r.err == PATTERN_ERR_GROUP && r.pos == 3, "stray close");
+    r = compile("   ", table, CAP);
+    CHECK(r.err == PATTERN_ERR_EMPTY, "no vectors");
+    r = compile("{}:5", table, CAP);
+    CHECK(r.err == PATTERN_ERR_EMPTY, "empty group");
+    r = compile("1:9", table, 8);
+    CHECK(r.err == PATTERN_ERR_FULL, "hold overflows the table");
+    r = compile("{1 2 3}:3", table, 8);
+    CHECK(r.err == PATTERN_ERR_FULL, "group overflows the table");
+    r = compile("1 2 3 4 5 6 7 8", table, 8);
+    CHECK(r.err == PATTERN_OK && r.len == 8, "exactly full");
+    r = compile("1:4294967295", table, CAP);
+    CHECK(r.err == PATTERN_ERR_FULL, "huge repeat does not overflow the count");
+    r = compile("1:99999999999", table, CAP);
+    CHECK(r.err == PATTERN_ERR_REPEAT, "repeat above 32 bits");
+    CHECK(strcmp(pattern_error_text(PATTERN_ERR_GROUP), "unbalanced { }") == 0, "error text");
+}
+
+/* ── Layout and playback ────────────────────────────────────────── */
+
+static void test_loop(void) {
+    printf("loop:\n");
+    bool ok = true;
+    for (uint32_t len = 1; len <= 64 && ok; len++) {
+        for (uint32_t i = 0; i < len; i++) {
+            table[i] = (uint8_t)rng();
+        }
+        pattern_layout_t l;
+        ok &= pattern_layout(len, 0, CAP, &l);
+        ok &= l.bytes % 4 == 0 && l.pad == 0 && l.copies <= 4 && l.bytes == len * l.copies;
+        pattern_fill(buf, table, &l);
+        // many passes around the DMA loop
+        for (uint64_t n = 0; n < (uint64_t)l.bytes * 5 + 3; n++) {
+            ok &= pio_sample(buf, l.bytes, n) == table[n % len];
+        }
+    }
+    CHECK(ok, "looped output is the table forever, lengths 1-64");
+
+    pattern_layout_t l;
+    CHECK(pattern_layout(6, 0, CAP, &l) && l.copies == 2 && l.bytes == 12, "6 samples loop as 2 copies");
+    CHECK(pattern_layout(7, 0, CAP, &l) && l.copies == 4 && l.bytes == 28, "odd lengths loop as 4 copies");
+    CHECK(pattern_layout(8, 0, CAP, &l) && l.copies == 1, "multiples of 4 are not copied");
+    CHECK(!pattern_layout(CAP - 1, 0, CAP, &l), "4 copies must fit");
+    CHECK(!pattern_layout(0, 0, CAP, &l), "empty table");
+}
+
+static void test_repeats(void) {
+    printf("repeats:\n");
+    bool ok = true;
+    for (uint32_t len = 1; len <= 24 && ok; len++) {
+        for (uint32_t reps = 1; reps <= 9; reps++) {
+            for (uint32_t i = 0; i < len; i++) {
+                table[i] = (uint8_t)rng();
+            }
+            pattern_layout_t l;
+            ok &= pattern_layout(len, reps, CAP, &l);
+            ok &= l.bytes % 4 == 0 && l.bytes - l.pad == len * reps && l.pad < 4;
+            pattern_fill(buf, table, &l);
+            for (uint32_t n = 0; n < l.bytes; n++) {
+                uint8_t want = (n < len * reps) ? table[n % len] : table[len - 1];
+                ok &= pio_sample(buf, l.bytes, n) == want;
+            }
+        }
+    }
+    CHECK(ok, "N repeats then the last vector");
+
+    // in place, the way the command uses the big buffer
+    for (uint32_t i = 0; i < 5; i++) {
+        buf[i] = (uint8_t)(i + 1);
+    }
+    pattern_layout_t l;
+    pattern_layout(5, 3, CAP, &l);
+    pattern_fill(buf, buf, &l);
+    static const uint8_t want[16] = { 1, 2, 3, 4, 5, 1, 2, 3, 4, 5, 1, 2, 3, 4, 5, 5 };
+    CHECK(l.bytes == 16 && memcmp(buf, want, 16) == 0, "fills in place");
+
+    CHECK(pattern_max_repeats(1000, CAP) == CAP / 1000, "max repeats");
+    CHECK(pattern_layout(1000, CAP / 1000, CAP, &l), "max repeats fit");
+    CHECK(!pattern_layout(1000, CAP / 1000 + 1, CAP, &l), "one more does not");
+    CHECK(!pattern_layout(0x10000, 0x10000, UINT32_MAX, &l), "no 32 bit overflow");
+}
+
+/* ── Clock ──────────────────────────────────────────────────────── */
+
+static double clock_rate(uint32_t sys, const pattern_clock_t* c) {
+    if (c->slow) {
+        return (double)sys / (c->div_int + c->div_frac / 256.0) / (c->delay + PATTERN_SLOW_OVERHEAD);
+    }
+    return (double)sys / (c->div_int + c->div_frac / 256.0);
+}
+
+static void test_clock(void) {
+    printf("clock:\n");
+    const uint32_t sys = 150000000;
+    pattern_clock_t c;
+    CHECK(pattern_clock(sys, sys, &c) && !c.slow && c.div_int == 1 && c.div_frac == 0 && !c.jitter,
+          "full speed");
+    CHECK(pattern_clock(sys, 1000000, &c) && !c.slow && c.div_int == 150 && !c.jitter, "1MHz exact");
+    CHECK(pattern_clock(sys, 7000000, &c) && !c.slow && c.jitter && fabs(c.actual_hz - 7e6) / 7e6 < 0.002,
+          "7MHz fractional");
+    CHECK(pattern_clock(sys, 1000, &c) && c.slow && c.delay == 150000 - PATTERN_SLOW_OVERHEAD && !c.jitter,
+          "1kHz uses the delay loop");
+    CHECK(pattern_clock(sys, 1, &c) && c.slow && c.actual_hz == 1.0, "1Hz");
+    CHECK(pattern_clock(125000000, 2000, &c) && !c.slow && c.div_int == 62500, "2kHz at 125MHz fits the divider");
+    CHECK(!pattern_clock(sys, 0, &c), "0Hz");
+    CHECK(!pattern_clock(sys, sys + 1, &c), "above the system clock");
+
+    bool ok = true;
+    double worst = 0;
+    for (uint32_t i = 0; i < 200000; i++) {
+        uint32_t rate = 1 + rng() % sys;
+        if (i & 1) {
+            rate = 1 + rate % 100000;
+        }
+        ok &= pattern_clock(sys, rate, &c);
+        ok &= c.div_int >= 1 && (c.slow ? c.div_int == 1 && c.div_frac == 0 : true);
+        ok &= fabs(clock_rate(sys, &c) - c.actual_hz) / c.actual_hz < 1e-9;
+        double err = fabs(c.actual_hz - rate) / rate;
+        if (err > worst) {
+            worst = err;
+        }
+    }
+    CHECK(ok, "actual rate matches the divider and delay");
+    CHECK(worst < 0.004, "within 0.4% of the request");
+    printf("  worst rate error %.4f%%\n", worst * 100);
+}
+
+/* ── Benchmark ──────────────────────────────────────────────────── */
+
+static void bench(void) {
+    const char* text = "{0x01 0x02 0x04 0x08 0x10 0x20 0x40 0x80}:100 {0xff 0}:500 0x55:1000";
+    pattern_result_t r;
+    const uint32_t rounds = 20000;
+    double t0 = now_s();
+    for (uint32_t i = 0; i < rounds; i++) {
+        pattern_compile(text, strlen(text), table, CAP, &r);
+    }
+    double dt = now_s() - t0;
+    printf("compile: %.1f M samples/s (%u samples)\n", rounds * (double)r.len / dt / 1e6, r.len);
+
+    pattern_layout_t l;
+    pattern_layout(r.len, pattern_max_repeats(r.len, CAP), CAP, &l);
+    t0 = now_s();
+    for (uint32_t i = 0; i < 500; i++) {
+        pattern_fill(buf, table, &l);
+    }
+    dt = now_s() - t0;
+    printf("fill:    %.1f MB/s (%u bytes)\n", 500.0 * l.bytes / dt / 1e6, l.bytes);
+}
+
+int main(void) {
+    printf("=== pattern tests ===\n\n");
+    test_compile();
+    test_errors();
+    test_loop();
+    test_repeats();
+    test_clock();
+    printf("\n");
+    bench();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
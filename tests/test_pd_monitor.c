@@ -0,0 +1,332 @@
+/*
+ * test_pd_monitor.c — Host-side tests for the USB PD sink monitor
+ *
+ * Replays AP33772S register traces recorded as a poll loop sees them
+ * (a 65W charger attaching, a 9V request accepted, an OCP trip, unplug;
+ * a rejected request; a source that never answers) through the read
+ * planner and the event state machine and checks the event log. Checks
+ * the PDO decoder on SPR and EPR entries, event text, the event ring
+ * when full, and the sweep planner and tolerance check. Counts I2C
+ * transactions per poll with the planner against reading everything.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_pd_monitor test_pd_monitor.c ../src/lib/pd_monitor/pd_monitor.c && ./test_pd_monitor
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lib/pd_monitor/pd_monitor.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+#define EVENTS 64
+#define READ_ALL 9 // STATUS, OPMODE, VOLTAGE, CURRENT, TEMP, VREQ, IREQ, SRCPDO, PD_MSGRLT
+
+static pd_event_t ring[EVENTS];
+static pd_monitor_t m;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// a 65W charger: 5V 3A, 9V 3A, 15V 3A, 20V 3.25A, PPS 3.3-21V 3A
+static const uint16_t charger_pdos[] = { 0x2032, 0x205a, 0x2096, 0x24c8, 0x61d2 };
+#define CHARGER_PDOS (sizeof(charger_pdos) / sizeof(charger_pdos[0]))
+
+typedef struct {
+    uint32_t time_ms;
+    uint8_t status;
+    uint8_t opmode;
+    uint16_t voltage; // 80mV
+    uint8_t current;  // 24mA
+    uint16_t vreq;    // 50mV
+    uint16_t ireq;    // 10mA
+    uint8_t result;
+} trace_t;
+
+static uint32_t transactions;
+static uint32_t polls;
+
+// one poll as the firmware does it: STATUS and OPMODE, then what the plan asks for
+static void poll(const trace_t* t) {
+    pd_monitor_regs_t r;
+    memset(&r, 0, sizeof(r));
+    r.status = t->status;
+    r.opmode = t->opmode;
+    r.read = pd_monitor_plan(&m, t->status);
+    transactions += 2;
+    if (r.read & PD_READ_TELEMETRY) {
+        r.voltage = t->voltage;
+        r.current = t->current;
+        r.temp = 31;
+        transactions += 3;
+    }
+    if (r.read & PD_READ_CONTRACT) {
+        r.vreq = t->vreq;
+        r.ireq = t->ireq;
+        transactions += 2;
+    }
+    if (r.read & PD_READ_PDO) {
+        for (uint32_t i = 0; i < CHARGER_PDOS; i++) {
+            r.pdo[i * 2] = (uint8_t)charger_pdos[i];
+            r.pdo[i * 2 + 1] = (uint8_t)(charger_pdos[i] >> 8);
+        }
+        transactions += 1;
+    }
+    if (r.read & PD_READ_RESULT) {
+        r.result = t->result;
+        transactions += 1;
+    }
+    polls++;
+    pd_monitor_update(&m, &r, t->time_ms);
+}
+
+static uint32_t drain(pd_event_t* out, uint32_t max) {
+    uint32_t n = 0;
+    while (n < max && pd_monitor_pop(&m, &out[n])) {
+        n++;
+    }
+    return n;
+}
+
+// the events' types in order, as a string of letters 'A' + type
+static const char* types(const pd_event_t* ev, uint32_t n) {
+    static char s[EVENTS + 1];
+    for (uint32_t i = 0; i < n; i++) {
+        s[i] = 'A' + ev[i].type;
+    }
+    s[n] = 0;
+    return s;
+}
+
+static const char* seq(const pd_event_type_t* t, uint32_t n) {
+    static char s[EVENTS + 1];
+    for (uint32_t i = 0; i < n; i++) {
+        s[i] = 'A' + t[i];
+    }
+    s[n] = 0;
+    return s;
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_decode(void) {
+    pd_pdo_t p;
+    pd_monitor_pdo_decode(1, 0x2032, &p);
+    CHECK(p.type == PD_PDO_FIXED && p.min_mv == 5000 && p.max_mv == 5000 && p.ma == 3000, "fixed 5V 3A");
+    pd_monitor_pdo_decode(4, 0x24c8, &p);
+    CHECK(p.type == PD_PDO_FIXED && p.max_mv == 20000 && p.ma == 3250, "fixed 20V 3.25A");
+    pd_monitor_pdo_decode(5, 0x61d2, &p);
+    CHECK(p.type == PD_PDO_PPS && p.min_mv == 3300 && p.max_mv == 21000 && p.ma == 3000, "PPS 3.3-21V 3A");
+    pd_monitor_pdo_decode(6, 0x42b4, &p);
+    CHECK(p.type == PD_PDO_PPS && p.min_mv == 5000 && p.max_mv == 18000 && p.ma == 1000, "PPS from 5V, below 1.25A");
+    pd_monitor_pdo_decode(8, 0x3c8c, &p);
+    CHECK(p.type == PD_PDO_FIXED && p.max_mv == 28000 && p.ma == 5000, "EPR fixed 28V 5A, 200mV units");
+    pd_monitor_pdo_decode(9, 0x7d8c, &p);
+    CHECK(p.type == PD_PDO_AVS && p.min_mv == 15000 && p.max_mv == 28000, "AVS 15-28V");
+    pd_monitor_pdo_decode(2, 0, &p);
+    CHECK(p.type == PD_PDO_NONE, "empty slot");
+}
+
+static void test_attach_request(void) {
+    pd_monitor_init(&m, ring, EVENTS, 500, 200, 1000);
+    transactions = polls = 0;
+    static const trace_t attach[] = {
+        { 0, PD_STATUS_STARTED | PD_STATUS_READY | PD_STATUS_NEWPDO, PD_OPMODE_PDMOD, 62, 0, 100, 300, 0 },
+        { 100, 0, PD_OPMODE_PDMOD, 62, 1, 100, 300, 0 },
+    };
+    poll(&attach[0]);
+    pd_event_t ev[EVENTS];
+    uint32_t n = drain(ev, EVENTS);
+    static const pd_event_type_t want[] = { PD_EV_STARTED, PD_EV_SOURCE, PD_EV_READY, PD_EV_CAPS, PD_EV_PDO,
+                                            PD_EV_PDO,     PD_EV_PDO,    PD_EV_PDO,   PD_EV_PDO,  PD_EV_CONTRACT,
+                                            PD_EV_VBUS,    PD_EV_IBUS };
+    CHECK(!strcmp(types(ev, n), seq(want, sizeof(want) / sizeof(want[0]))), "attach events in order");
+    CHECK(ev[1].raw == 2 && ev[3].index == 5, "PD source with five PDOs");
+    CHECK(ev[5].index == 2 && ev[5].mv == 9000 && ev[5].ma == 3000, "PDO event carries the decode");
+    CHECK(ev[9].mv == 5000 && ev[9].ma == 3000 && ev[10].mv == 4960, "contract and VBUS");
+    CHECK(m.pdos == 5 && m.pdo_raw[4] == 0x61d2, "PDO list kept");
+
+    uint32_t before = transactions;
+    poll(&attach[1]);
+    CHECK(transactions - before == 5, "a quiet poll reads STATUS, OPMODE and telemetry only");
+    CHECK(!pd_monitor_pop(&m, &ev[0]), "nothing changed, no events");
+
+    // 9V 3A, accepted, VBUS ramps, then OCP and unplug
+    pd_monitor_request(&m, 2, 9000, 3000, 150);
+    static const trace_t run[] = {
+        { 200, 0, PD_OPMODE_PDMOD, 62, 1, 100, 300, PD_RESULT_PENDING },
+        { 300, 0, PD_OPMODE_PDMOD, 90, 1, 180, 300, PD_RESULT_ACCEPTED },
+        { 400, 0, PD_OPMODE_PDMOD, 112, 2, 180, 300, 0 },
+        { 450, 0, PD_OPMODE_PDMOD, 113, 3, 180, 300, 0 },
+        { 500, PD_STATUS_OCP, PD_OPMODE_PDMOD, 110, 130, 180, 300, 0 },
+        { 600, 0, 0, 0, 0, 0, 0, 0 },
+    };
+    uint8_t plan = pd_monitor_plan(&m, 0);
+    CHECK((plan & PD_READ_RESULT) && (plan & PD_READ_CONTRACT) && !(plan & PD_READ_PDO),
+          "pending request reads the result and contract");
+    for (uint32_t i = 0; i < sizeof(run) / sizeof(run[0]); i++) {
+        poll(&run[i]);
+    }
+    n = drain(ev, EVENTS);
+    static const pd_event_type_t want2[] = { PD_EV_REQUEST, PD_EV_ACCEPT, PD_EV_CONTRACT, PD_EV_VBUS, PD_EV_VBUS,
+                                             PD_EV_FAULT,   PD_EV_IBUS,   PD_EV_SOURCE,   PD_EV_VBUS, PD_EV_IBUS };
+    CHECK(!strcmp(types(ev, n), seq(want2, sizeof(want2) / sizeof(want2[0]))), "request to unplug events in order");
+    CHECK(ev[0].time_ms == 150 && ev[1].time_ms == 300 && ev[2].mv == 9000, "accept at 300ms, 9V contract");
+    CHECK(ev[3].mv == 7200 && ev[4].mv == 8960, "VBUS ramp in 500mV steps, small moves ignored");
+    CHECK(ev[5].raw == PD_STATUS_OCP && ev[6].ma == 3120, "OCP trip and the current");
+    CHECK(ev[7].raw == 0 && ev[8].mv == 0, "detach");
+    CHECK(m.last_result == PD_RESULT_ACCEPTED && !m.pending, "request settled");
+
+    printf("attach trace: %.1f transactions per poll planned, %d reading everything\n",
+           (double)transactions / polls,
+           READ_ALL);
+}
+
+static void test_reject_timeout(void) {
+    pd_monitor_init(&m, ring, EVENTS, 500, 200, 1000);
+    trace_t t = { 0, PD_STATUS_READY | PD_STATUS_NEWPDO, PD_OPMODE_PDMOD, 62, 0, 100, 300, 0 };
+    poll(&t);
+    pd_event_t ev[EVENTS];
+    drain(ev, EVENTS);
+
+    pd_monitor_request(&m, 5, 12000, 3000, 10);
+    t.time_ms = 50;
+    t.status = 0;
+    t.result = PD_RESULT_REJECTED;
+    poll(&t);
+    uint32_t n = drain(ev, EVENTS);
+    CHECK(n == 2 && ev[1].type == PD_EV_REJECT && m.last_result == PD_RESULT_REJECTED, "reject");
+
+    pd_monitor_request(&m, 3, 15000, 3000, 100);
+    t.result = PD_RESULT_PENDING;
+    for (uint32_t time = 200; time <= 1200; time += 100) {
+        t.time_ms = time;
+        poll(&t);
+    }
+    n = drain(ev, EVENTS);
+    CHECK(n == 2 && ev[1].type == PD_EV_TIMEOUT && ev[1].time_ms == 1100, "no answer times out");
+    CHECK(!(pd_monitor_plan(&m, 0) & PD_READ_RESULT), "stops reading the result after the timeout");
+
+    pd_monitor_request(&m, 3, 15000, 3000, 2000);
+    t.time_ms = 2100;
+    t.opmode = 0;
+    poll(&t);
+    n = drain(ev, EVENTS);
+    CHECK(!m.pending && ev[1].type == PD_EV_SOURCE, "unplug drops the request");
+}
+
+static void test_ring(void) {
+    pd_event_t small[4];
+    pd_monitor_init(&m, small, 4, 500, 200, 1000);
+    trace_t t = { 0, PD_STATUS_STARTED | PD_STATUS_READY | PD_STATUS_NEWPDO, PD_OPMODE_PDMOD, 62, 0, 100, 300, 0 };
+    poll(&t);
+    pd_event_t ev;
+    CHECK(m.lost == 8 && pd_monitor_pop(&m, &ev) && ev.type == PD_EV_STARTED, "full ring keeps the oldest");
+}
+
+static void test_text(void) {
+    char buf[64];
+    pd_event_t ev = { 0, PD_EV_PDO, 5, 0x61d2, 21000, 3000 };
+    pd_monitor_event_str(&ev, buf, sizeof(buf));
+    CHECK(!strcmp(buf, "PDO 5 PPS 3300-21000 mV 3000 mA"), "PPS PDO text");
+    ev = (pd_event_t){ 0, PD_EV_PDO, 2, 0x205a, 9000, 3000 };
+    pd_monitor_event_str(&ev, buf, sizeof(buf));
+    CHECK(!strcmp(buf, "PDO 2 fixed 9000 mV 3000 mA"), "fixed PDO text");
+    ev = (pd_event_t){ 0, PD_EV_FAULT, 0, PD_STATUS_OVP | PD_STATUS_OTP, 0, 0 };
+    pd_monitor_event_str(&ev, buf, sizeof(buf));
+    CHECK(!strcmp(buf, "fault OVP OTP"), "fault text");
+    ev = (pd_event_t){ 0, PD_EV_REQUEST, 2, 0, 9000, 3000 };
+    pd_monitor_event_str(&ev, buf, sizeof(buf));
+    CHECK(!strcmp(buf, "request PDO 2 9000 mV 3000 mA"), "request text");
+    CHECK(pd_monitor_event_str(&ev, buf, 8) > 8 && strlen(buf) == 7, "text truncates");
+}
+
+static void test_sweep(void) {
+    pd_sweep_t s;
+    pd_sweep_step_t step;
+    pd_sweep_init(&s, charger_pdos, CHARGER_PDOS, 5000);
+    static const uint16_t want[] = { 5000, 9000, 15000, 20000, 3300, 8300, 13300, 18300, 21000 };
+    static const uint8_t want_index[] = { 1, 2, 3, 4, 5, 5, 5, 5, 5 };
+    uint32_t n = 0;
+    bool ok = true;
+    while (pd_sweep_next(&s, &step)) {
+        ok &= n < 9 && step.mv == want[n] && step.index == want_index[n] && step.ma == (n == 3 ? 3250 : 3000);
+        n++;
+    }
+    CHECK(ok && n == 9, "fixed PDOs once, PPS from bottom to top in steps");
+
+    // EPR: 28V fixed and AVS 15-28V, AVS asks in 200mV units
+    uint16_t epr[9] = { 0x2032, 0, 0, 0, 0, 0, 0, 0x3c8c, 0x7d8c };
+    pd_sweep_init(&s, epr, 9, 4500);
+    static const uint16_t want_epr[] = { 5000, 28000, 15000, 19400, 23800, 28000 };
+    n = 0;
+    ok = true;
+    while (pd_sweep_next(&s, &step)) {
+        ok &= n < 6 && step.mv == want_epr[n] && step.mv % 100 == 0;
+        ok &= step.type != PD_PDO_AVS || step.mv % 200 == 0;
+        n++;
+    }
+    CHECK(ok && n == 6, "empty slots skipped, AVS steps on 200mV");
+
+    step = (pd_sweep_step_t){ 2, PD_PDO_FIXED, 9000, 3000 };
+    CHECK(pd_sweep_check(&step, 8960) && pd_sweep_check(&step, 9520), "within 5% and an ADC step");
+    CHECK(!pd_sweep_check(&step, 8400) && !pd_sweep_check(&step, 4960), "wrong voltage caught");
+}
+
+static void bench(void) {
+    // a long quiet session with a request every second
+    pd_monitor_init(&m, ring, EVENTS, 500, 200, 1000);
+    transactions = polls = 0;
+    trace_t t = { 0, PD_STATUS_READY | PD_STATUS_NEWPDO, PD_OPMODE_PDMOD, 62, 0, 100, 300, 0 };
+    pd_event_t ev;
+    double t0 = now_s();
+    for (uint32_t i = 0; i < 1000000; i++) {
+        t.time_ms = i * 10;
+        if (i % 100 == 50) {
+            pd_monitor_request(&m, 2, 9000, 3000, t.time_ms);
+        }
+        t.result = (i % 100 == 53) ? PD_RESULT_ACCEPTED : PD_RESULT_PENDING;
+        poll(&t);
+        t.status = 0;
+        while (pd_monitor_pop(&m, &ev)) {
+        }
+    }
+    double dt = now_s() - t0;
+    printf("10ms polls with a request a second: %.2f transactions per poll planned, %d reading everything\n",
+           (double)transactions / polls,
+           READ_ALL);
+    printf("state machine: %.0f ns per poll\n", dt / polls * 1e9);
+}
+
+int main(void) {
+    printf("=== pd_monitor tests ===\n\n");
+    test_decode();
+    test_attach_request();
+    test_reject_timeout();
+    test_ring();
+    test_text();
+    test_sweep();
+    printf("\n");
+    bench();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
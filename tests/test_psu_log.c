@@ -0,0 +1,390 @@
+/*
+ * test_psu_log.c — Host-side tests for the PSU data logger
+ *
+ * Feeds synthetic VOUT/current waveforms through a simulated ADC sample
+ * ring into the block reducer and checks min/max/mean/energy against a
+ * direct calculation: DC, a sine, an inrush pulse inside one block and
+ * sleep current spikes. Checks the fixed time base across gaps and the
+ * VOUT settle skip, lost record accounting when the ring fills, and that
+ * chunked drains only ever write whole, aligned, contiguous chunks.
+ * Benchmarks the reducer and the file sink (4096 byte chunks against
+ * one write per record).
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_psu_log test_psu_log.c ../src/lib/psu_log/psu_log.c -lm && ./test_psu_log
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "lib/psu_log/psu_log.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+// same scales as the firmware: VOUT through a /2 divider, 500mA full scale
+#define VOUT_SCALE (6.6f / 4096.0f)
+#define CURRENT_SCALE (0.5f / 4095.0f)
+#define PAIR_NS 4000 // full rate, 500k conversions/s over two channels
+#define RING_LEN 2048
+#define OUT_SIZE 65536
+
+static uint8_t out_buf[OUT_SIZE];
+static psu_log_ring_t out;
+static uint16_t adc_ring[RING_LEN];
+static uint32_t adc_written;
+
+typedef void (*wave_t)(uint32_t pair, uint16_t* vout, uint16_t* current);
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// DMA writes `pairs` pairs into the sample ring, the timer hands them over in
+// odd sized bites so VOUT and its current sample are sometimes split
+static void feed(psu_log_reduce_t* r, wave_t wave, uint32_t start_pair, uint32_t pairs) {
+    uint32_t pair = start_pair;
+    uint32_t left = pairs * 2;
+    while (left) {
+        uint32_t bite = 37 + (left % 23);
+        if (bite > left) {
+            bite = left;
+        }
+        uint32_t first = adc_written & (RING_LEN - 1);
+        for (uint32_t i = 0; i < bite; i++) {
+            uint32_t slot = (adc_written + i) & (RING_LEN - 1);
+            uint16_t v, c;
+            wave(pair, &v, &c);
+            if (slot & 1) {
+                adc_ring[slot] = c;
+                pair++;
+            } else {
+                adc_ring[slot] = v;
+            }
+        }
+        psu_log_reduce_process(r, adc_ring, RING_LEN, first, bite);
+        adc_written += bite;
+        left -= bite;
+    }
+}
+
+static void start(psu_log_reduce_t* r, uint32_t block_pairs, uint16_t settle) {
+    psu_log_ring_init(&out, out_buf, OUT_SIZE);
+    psu_log_reduce_init(r, &out, block_pairs, PAIR_NS, VOUT_SCALE, CURRENT_SCALE, settle);
+    adc_written = 0;
+}
+
+static psu_log_record_t record(uint32_t n) {
+    psu_log_record_t rec;
+    for (uint32_t i = 0; i < sizeof(rec); i++) {
+        ((uint8_t*)&rec)[i] = out_buf[(out.tail + n * sizeof(rec) + i) & (OUT_SIZE - 1)];
+    }
+    return rec;
+}
+
+static uint32_t records(void) {
+    return psu_log_ring_level(&out) / sizeof(psu_log_record_t);
+}
+
+// reference for one block
+typedef struct {
+    uint16_t vmin, vmax, imin, imax;
+    double vmean, imean, energy_nj;
+} ref_t;
+
+static ref_t reference(wave_t wave, uint32_t start_pair, uint32_t pairs) {
+    ref_t ref = { 0xffff, 0, 0xffff, 0, 0, 0, 0 };
+    for (uint32_t p = start_pair; p < start_pair + pairs; p++) {
+        uint16_t v, c;
+        wave(p, &v, &c);
+        ref.vmin = v < ref.vmin ? v : ref.vmin;
+        ref.vmax = v > ref.vmax ? v : ref.vmax;
+        ref.imin = c < ref.imin ? c : ref.imin;
+        ref.imax = c > ref.imax ? c : ref.imax;
+        ref.vmean += v;
+        ref.imean += c;
+        ref.energy_nj += (double)v * VOUT_SCALE * c * CURRENT_SCALE * PAIR_NS;
+    }
+    ref.vmean /= pairs;
+    ref.imean /= pairs;
+    return ref;
+}
+
+static bool matches(const psu_log_record_t* rec, const ref_t* ref) {
+    double vmean = rec->vout_mean / 16.0, imean = rec->current_mean / 16.0;
+    return rec->vout_min == ref->vmin && rec->vout_max == ref->vmax && rec->current_min == ref->imin &&
+           rec->current_max == ref->imax && fabs(vmean - ref->vmean) <= 1.0 / 32 &&
+           fabs(imean - ref->imean) <= 1.0 / 32 && fabs(rec->energy_nj - ref->energy_nj) <= 1.0 + ref->energy_nj * 1e-5;
+}
+
+/* ── Waveforms ──────────────────────────────────────────────────── */
+
+static void wave_dc(uint32_t p, uint16_t* v, uint16_t* c) {
+    (void)p;
+    *v = 2048; // 3.3V
+    *c = 819;  // 100mA
+}
+
+static void wave_sine(uint32_t p, uint16_t* v, uint16_t* c) {
+    *v = (uint16_t)(2048 + 40 * sin(p * 0.013));
+    *c = (uint16_t)(1500 + 1200 * sin(p * 0.0021));
+}
+
+// 3.3V target, 2ms inrush spike starting at pair 1100, VOUT sags
+static void wave_inrush(uint32_t p, uint16_t* v, uint16_t* c) {
+    if (p >= 1100 && p < 1600) {
+        *c = 3900;
+        *v = 1700;
+    } else {
+        *c = 8;
+        *v = 2048;
+    }
+}
+
+// sleep current with a short radio burst every 10000 pairs
+static void wave_sleep(uint32_t p, uint16_t* v, uint16_t* c) {
+    *v = 2048;
+    *c = (p % 10000) < 50 ? 1200 : (uint16_t)(2 + (p & 1));
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_waveforms(void) {
+    const struct {
+        wave_t wave;
+        const char* name;
+    } waves[] = {
+        { wave_dc, "DC" },
+        { wave_sine, "sine" },
+        { wave_inrush, "inrush" },
+        { wave_sleep, "sleep current" },
+    };
+    const uint32_t blocks[] = { 1, 250, 1000, 4096 };
+    for (int w = 0; w < 4; w++) {
+        for (int b = 0; b < 4; b++) {
+            psu_log_reduce_t r;
+            start(&r, blocks[b], 0);
+            uint32_t total = 20000;
+            feed(&r, waves[w].wave, 0, total);
+            psu_log_reduce_flush(&r);
+            uint32_t n = records();
+            uint32_t expected = (total + blocks[b] - 1) / blocks[b];
+            bool ok = (n == expected || (blocks[b] == 1 && n == OUT_SIZE / sizeof(psu_log_record_t)));
+            uint32_t checked = n < 200 ? n : 200;
+            for (uint32_t i = 0; i < checked && ok; i++) {
+                psu_log_record_t rec = record(i);
+                uint32_t pairs = (i + 1) * blocks[b] <= total ? blocks[b] : total - i * blocks[b];
+                ref_t ref = reference(waves[w].wave, i * blocks[b], pairs);
+                ok = matches(&rec, &ref) && rec.pairs == pairs && rec.flags == 0;
+            }
+            char msg[96];
+            snprintf(msg, sizeof(msg), "%s, %u pair blocks match the reference", waves[w].name, blocks[b]);
+            CHECK(ok, msg);
+        }
+    }
+}
+
+static void test_energy_total(void) {
+    // the sum of the record energies is the energy of the whole waveform
+    psu_log_reduce_t r;
+    start(&r, 500, 0);
+    feed(&r, wave_inrush, 0, 5000);
+    psu_log_reduce_flush(&r);
+    ref_t ref = reference(wave_inrush, 0, 5000);
+    double sum = 0;
+    for (uint32_t i = 0; i < records(); i++) {
+        psu_log_record_t rec = record(i);
+        sum += rec.energy_nj;
+    }
+    CHECK(fabs(sum - ref.energy_nj) < 10, "record energies add up to the total");
+    CHECK(fabs((double)r.energy_nj - ref.energy_nj) < 10, "session energy total");
+    CHECK(r.current_high == 3900 && r.vout_low == 1700, "session extremes");
+
+    // the inrush is inside block 2 and 3 only
+    psu_log_record_t b1 = record(1), b2 = record(2), b3 = record(3);
+    CHECK(b1.current_max == 8 && b2.current_max == 3900 && b3.current_max == 3900, "inrush lands in its blocks");
+    CHECK(b2.vout_min == 1700 && b1.vout_min == 2048, "VOUT sag lands in its block");
+}
+
+static void test_gaps(void) {
+    psu_log_reduce_t r;
+    start(&r, 100, 5);
+    feed(&r, wave_dc, 0, 150);      // block 0 done, 50 into block 1
+    psu_log_reduce_gap(&r, 230);    // to 80 into block 3
+    feed(&r, wave_dc, 380, 70);     // 5 skipped settling, block 3 done, 50 into block 4
+    psu_log_reduce_flush(&r);
+    CHECK(records() == 5, "gap keeps the time base");
+    psu_log_record_t rec[5];
+    for (int i = 0; i < 5; i++) {
+        rec[i] = record(i);
+    }
+    CHECK(rec[0].flags == 0 && rec[0].pairs == 100, "block before the gap");
+    CHECK(rec[1].flags == PSU_LOG_GAP && rec[1].pairs == 50, "block the gap starts in");
+    CHECK(rec[2].flags == PSU_LOG_GAP && rec[2].pairs == 0 && rec[2].energy_nj == 0, "empty block inside the gap");
+    CHECK(rec[3].flags == PSU_LOG_GAP && rec[3].pairs == 15, "block with the settle skip");
+    CHECK(rec[4].flags == 0 && rec[4].pairs == 50, "settled after the gap");
+    // a gap block reports the mean power over the whole block
+    CHECK(abs((int)rec[1].energy_nj - (int)rec[0].energy_nj) <= 1, "energy scaled up across the gap");
+    CHECK(abs((int)rec[4].energy_nj * 2 - (int)rec[0].energy_nj) <= 2, "last block energy covers its pairs");
+
+    // a current sample without its VOUT after a restart is dropped
+    start(&r, 4, 0);
+    adc_ring[1] = 500;
+    psu_log_reduce_process(&r, adc_ring, RING_LEN, 1, 1);
+    CHECK(r.position == 0, "orphan current sample ignored");
+}
+
+static void test_lost(void) {
+    static uint8_t small[256];
+    psu_log_ring_t ring;
+    psu_log_reduce_t r;
+    psu_log_ring_init(&ring, small, sizeof(small));
+    psu_log_reduce_init(&r, &ring, 10, PAIR_NS, VOUT_SCALE, CURRENT_SCALE, 0);
+    adc_written = 0;
+    feed(&r, wave_dc, 0, 200); // 20 records, 12 fit
+    uint32_t fit = sizeof(small) / sizeof(psu_log_record_t);
+    CHECK(ring.lost == 20 - fit, "lost records are counted");
+    CHECK(r.records == 20, "every block is counted");
+    // drain and continue: the next record carries the lost flag
+    ring.tail = ring.head;
+    feed(&r, wave_dc, 200, 10);
+    psu_log_record_t rec;
+    memcpy(&rec, &small[ring.tail & (sizeof(small) - 1)], sizeof(rec));
+    CHECK(rec.flags == PSU_LOG_LOST && !ring.lost_pending, "first record after a loss is flagged");
+}
+
+typedef struct {
+    uint32_t writes;
+    uint32_t bytes;
+    bool aligned;
+    bool fail;
+    FILE* f;
+} sink_t;
+
+static uint32_t sink_write(void* ctx, const uint8_t* data, uint32_t len) {
+    sink_t* s = ctx;
+    if (s->fail) {
+        return 0;
+    }
+    if ((s->bytes % 4096) != 0 || (len % 4096) != 0 || ((data - out_buf) % 4096) != 0) {
+        s->aligned = false;
+    }
+    s->writes++;
+    s->bytes += len;
+    if (s->f) {
+        fwrite(data, 1, len, s->f);
+    }
+    return len;
+}
+
+// a USB FIFO with room for 100 bytes per call
+static uint32_t sink_partial(void* ctx, const uint8_t* data, uint32_t len) {
+    uint32_t* taken = ctx;
+    (void)data;
+    len = len < 100 ? len : 100;
+    *taken += len;
+    return len;
+}
+
+static void test_drain(void) {
+    psu_log_reduce_t r;
+    start(&r, 10, 0);
+    psu_log_header_t h;
+    psu_log_header_init(&h, PAIR_NS, 10, VOUT_SCALE, CURRENT_SCALE);
+    CHECK(sizeof(h) == 32 && sizeof(psu_log_record_t) == 20, "file layout sizes");
+    psu_log_ring_put(&out, &h, sizeof(h));
+
+    sink_t s = { 0, 0, true, false, NULL };
+    for (uint32_t i = 0; i < 40; i++) {
+        feed(&r, wave_sine, i * 5000, 5000);
+        psu_log_ring_drain(&out, 4096, sink_write, &s);
+    }
+    CHECK(s.aligned && s.bytes, "drains are whole aligned chunks");
+    CHECK(psu_log_ring_level(&out) < 4096, "drain leaves less than a chunk");
+    uint32_t queued = psu_log_ring_level(&out);
+    CHECK(s.bytes + queued == sizeof(h) + r.records * sizeof(psu_log_record_t), "every byte is queued or written");
+
+    s.fail = true;
+    feed(&r, wave_sine, 0, 5000);
+    uint32_t level = psu_log_ring_level(&out);
+    CHECK(!psu_log_ring_drain(&out, 4096, sink_write, &s) && psu_log_ring_level(&out) == level,
+          "failed write keeps the data");
+    uint32_t taken = 0;
+    CHECK(!psu_log_ring_drain(&out, 1, sink_partial, &taken) && taken == 100 &&
+              psu_log_ring_level(&out) == level - 100,
+          "partial write keeps the rest");
+    s.fail = false;
+    CHECK(psu_log_ring_drain(&out, 1, sink_write, &s) && psu_log_ring_level(&out) == 0, "final drain empties the ring");
+}
+
+static void bench(void) {
+    // reducer: pairs per second at the full ADC rate is 250k
+    psu_log_reduce_t r;
+    start(&r, 250, 0);
+    for (uint32_t i = 0; i < RING_LEN; i++) {
+        adc_ring[i] = (i & 1) ? 900 + (i & 63) : 2048 - (i & 15);
+    }
+    uint32_t rounds = 20000;
+    double t0 = now_s();
+    for (uint32_t i = 0; i < rounds; i++) {
+        psu_log_reduce_process(&r, adc_ring, RING_LEN, (i * 100) & (RING_LEN - 1), 100);
+        out.tail = out.head;
+    }
+    double t = now_s() - t0;
+    printf("reducer: %.1f M pairs/s (ADC full rate 0.25 M pairs/s)\n", rounds * 50 / t / 1e6);
+
+    // file sink: 4096 byte chunks against one write per record
+    const uint32_t total = 200000; // records
+    for (int mode = 0; mode < 2; mode++) {
+        uint32_t chunk = mode ? sizeof(psu_log_record_t) : 4096;
+        FILE* f = tmpfile();
+        if (!f) {
+            return;
+        }
+        setvbuf(f, NULL, _IONBF, 0); // a write per call, like f_write to the NAND
+        sink_t s = { 0, 0, true, false, f };
+        start(&r, 1, 0);
+        t0 = now_s();
+        for (uint32_t i = 0; i < total; i++) {
+            uint16_t rec[2] = { 2048, 800 };
+            psu_log_reduce_process(&r, rec, 2, 0, 2);
+            psu_log_ring_drain(&out, chunk, sink_write, &s);
+        }
+        psu_log_ring_drain(&out, 1, sink_write, &s);
+        t = now_s() - t0;
+        printf("file sink, %4u byte writes: %6u writes, %.1f MB/s, %.0f k records/s\n",
+               chunk,
+               s.writes,
+               s.bytes / t / 1e6,
+               total / t / 1e3);
+        fclose(f);
+    }
+}
+
+int main(void) {
+    test_waveforms();
+    test_energy_total();
+    test_gaps();
+    test_lost();
+    test_drain();
+    bench();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+/*
+ * test_psu_trip.c — Host-side simulation of the PSU fault watchdog
+ *
+ * Simulates the ADC in round robin (VOUT, current sense), the DMA ring and
+ * the timer interrupt that runs the comparator, injects fault waveforms
+ * at every phase and checks the worst case trip latency against
+ * psu_trip_worst_case_us(). Also checks debounce, VOUT settling after a
+ * restart and that in-limit noise never trips.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_psu_trip test_psu_trip.c ../src/lib/psu_trip/psu_trip.c && ./test_psu_trip
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "lib/psu_trip/psu_trip.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+// same settings as pirate/psu_guard.c
+#define SAMPLE_US 25
+#define CHECK_US 50
+#define DEBOUNCE 2
+#define RING_LEN 2048
+
+#define VOUT_OK 2000
+#define VOUT_LIMIT 1800
+#define CURRENT_OK 1000
+#define CURRENT_LIMIT 1200
+
+enum { CH_VOUT = 0, CH_CURRENT = 1 };
+
+// fault waveform: what each channel reads at time t (us)
+typedef struct {
+    int channel;       // channel that faults
+    uint32_t start;    // fault start
+    uint32_t length;   // 0 for a step that stays
+    uint16_t level;    // value during the fault
+    uint32_t noise;    // +- noise on the normal level, stays inside the limits
+} fault_t;
+
+static uint16_t waveform(const fault_t* f, int channel, uint32_t t) {
+    if (channel == f->channel && t >= f->start && (f->length == 0 || t < f->start + f->length)) {
+        return f->level;
+    }
+    int noise = f->noise ? (int)(rand() % (2 * f->noise + 1)) - (int)f->noise : 0;
+    return (uint16_t)((channel == CH_VOUT ? VOUT_OK : CURRENT_OK) + noise);
+}
+
+/*
+ * Run the ADC, DMA ring and timer until `end` us.
+ * Conversion k starts (sample and hold) at adc_phase + k * SAMPLE_US and
+ * lands in ring[k] PSU_TRIP_CONVERSION_US later. The timer runs at
+ * irq_phase + j * CHECK_US. Returns the trip time, 0 if it never tripped.
+ */
+static uint32_t simulate(const fault_t* f, uint32_t adc_phase, uint32_t irq_phase, uint32_t end, uint8_t* reason) {
+    uint16_t ring[RING_LEN];
+    psu_trip_t t;
+    psu_trip_init(&t, CURRENT_LIMIT, VOUT_LIMIT, DEBOUNCE, 0);
+    memset(ring, 0, sizeof(ring));
+
+    uint32_t converted = 0; // conversions written to the ring
+    uint32_t checked = 0;   // conversions handed to the comparator
+    for (uint32_t irq = irq_phase; irq < end; irq += CHECK_US) {
+        // DMA: every conversion that finished before this interrupt
+        while (adc_phase + converted * SAMPLE_US + PSU_TRIP_CONVERSION_US <= irq) {
+            uint32_t sample_time = adc_phase + converted * SAMPLE_US;
+            ring[converted & (RING_LEN - 1)] = waveform(f, converted & 1, sample_time);
+            converted++;
+        }
+        *reason = psu_trip_process(&t, ring, RING_LEN, checked & (RING_LEN - 1), converted - checked);
+        checked = converted;
+        if (*reason) {
+            return irq;
+        }
+    }
+    return 0;
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_comparator(void) {
+    psu_trip_t t;
+    uint16_t ring[8];
+    psu_trip_init(&t, CURRENT_LIMIT, VOUT_LIMIT, 2, 0);
+
+    // even slots VOUT, odd slots current
+    for (int i = 0; i < 8; i++) {
+        ring[i] = (i & 1) ? CURRENT_OK : VOUT_OK;
+    }
+    CHECK(psu_trip_process(&t, ring, 8, 0, 8) == 0, "in limits");
+
+    ring[1] = CURRENT_LIMIT; // at the limit is fine
+    ring[3] = CURRENT_LIMIT + 1;
+    CHECK(psu_trip_process(&t, ring, 8, 0, 4) == 0, "one current sample over does not trip");
+    ring[5] = CURRENT_LIMIT + 1;
+    CHECK(psu_trip_process(&t, ring, 8, 4, 2) == PSU_TRIP_OVERCURRENT, "second current sample over trips");
+    ring[1] = ring[3] = ring[5] = CURRENT_OK;
+    CHECK(psu_trip_process(&t, ring, 8, 0, 8) == PSU_TRIP_OVERCURRENT, "trip is latched");
+
+    psu_trip_init(&t, CURRENT_LIMIT, VOUT_LIMIT, 2, 0);
+    ring[6] = VOUT_LIMIT;
+    ring[0] = VOUT_LIMIT;
+    CHECK(psu_trip_process(&t, ring, 8, 6, 4) == PSU_TRIP_UNDERVOLTAGE, "undervoltage across the ring wrap");
+
+    psu_trip_init(&t, 0, 0, 1, 0);
+    ring[0] = 0;
+    ring[1] = 4095;
+    CHECK(psu_trip_process(&t, ring, 8, 0, 8) == 0, "limits of 0 are disabled");
+}
+
+static void test_settle(void) {
+    psu_trip_t t;
+    uint16_t ring[8];
+    for (int i = 0; i < 8; i++) {
+        ring[i] = (i & 1) ? CURRENT_OK : 0; // VOUT reads low while the AMUX settles
+    }
+    psu_trip_init(&t, CURRENT_LIMIT, VOUT_LIMIT, 1, 3);
+    CHECK(psu_trip_process(&t, ring, 8, 0, 6) == 0, "VOUT ignored while settling");
+    CHECK(psu_trip_process(&t, ring, 8, 6, 2) == PSU_TRIP_UNDERVOLTAGE, "VOUT checked after settling");
+
+    psu_trip_init(&t, CURRENT_LIMIT, VOUT_LIMIT, 2, 2);
+    ring[0] = ring[2] = ring[4] = ring[6] = VOUT_OK;
+    ring[0] = VOUT_LIMIT;
+    psu_trip_process(&t, ring, 8, 0, 6);
+    psu_trip_restart(&t);
+    ring[0] = ring[2] = VOUT_LIMIT;
+    CHECK(psu_trip_process(&t, ring, 8, 0, 4) == 0, "restart clears the count and settles again");
+}
+
+static void test_vout_hold(void) {
+    psu_trip_t t;
+    uint16_t ring[16];
+    for (int i = 0; i < 16; i++) {
+        ring[i] = (i & 1) ? CURRENT_OK : 0; // the AMUX is on another (grounded) channel
+    }
+    psu_trip_init(&t, CURRENT_LIMIT, VOUT_LIMIT, 2, 2);
+    psu_trip_process(&t, ring, 16, 0, 4); // settled
+    psu_trip_vout_hold(&t, true);
+    CHECK(psu_trip_process(&t, ring, 16, 4, 8) == 0, "VOUT ignored while the AMUX is away");
+    psu_trip_restart(&t);
+    CHECK(psu_trip_process(&t, ring, 16, 12, 4) == 0, "restart keeps the hold");
+
+    ring[1] = ring[3] = CURRENT_LIMIT + 1;
+    CHECK(psu_trip_process(&t, ring, 16, 0, 4) == PSU_TRIP_OVERCURRENT, "current still trips during the hold");
+
+    psu_trip_init(&t, CURRENT_LIMIT, VOUT_LIMIT, 2, 2);
+    psu_trip_vout_hold(&t, true);
+    ring[1] = ring[3] = CURRENT_OK;
+    psu_trip_process(&t, ring, 16, 0, 8);
+    psu_trip_vout_hold(&t, false);
+    CHECK(psu_trip_process(&t, ring, 16, 8, 4) == 0, "VOUT settles again after the hold");
+    CHECK(psu_trip_process(&t, ring, 16, 12, 4) == PSU_TRIP_UNDERVOLTAGE, "VOUT checked after settling");
+}
+
+static void test_latency(void) {
+    uint32_t bound = psu_trip_worst_case_us(SAMPLE_US, CHECK_US, DEBOUNCE);
+    const struct {
+        int channel;
+        uint16_t level;
+        uint8_t reason;
+        const char* name;
+    } faults[] = {
+        { CH_VOUT, 0, PSU_TRIP_UNDERVOLTAGE, "short to ground" },
+        { CH_VOUT, VOUT_LIMIT, PSU_TRIP_UNDERVOLTAGE, "VOUT sag to the limit" },
+        { CH_CURRENT, 4095, PSU_TRIP_OVERCURRENT, "current step to full scale" },
+        { CH_CURRENT, CURRENT_LIMIT + 1, PSU_TRIP_OVERCURRENT, "current just over the limit" },
+    };
+
+    for (int i = 0; i < 4; i++) {
+        uint32_t worst = 0;
+        bool all_tripped = true;
+        bool right_reason = true;
+        // every fault start against every ADC and timer phase
+        for (uint32_t adc_phase = 0; adc_phase < 2 * SAMPLE_US; adc_phase += 3) {
+            for (uint32_t irq_phase = 0; irq_phase < CHECK_US; irq_phase += 7) {
+                for (uint32_t start = 1000; start < 1000 + 2 * SAMPLE_US; start++) {
+                    fault_t f = { faults[i].channel, start, 0, faults[i].level, 0 };
+                    uint8_t reason;
+                    uint32_t trip = simulate(&f, adc_phase, irq_phase, 5000, &reason);
+                    if (!trip) {
+                        all_tripped = false;
+                        continue;
+                    }
+                    right_reason &= (reason == faults[i].reason);
+                    if (trip - start > worst) {
+                        worst = trip - start;
+                    }
+                }
+            }
+        }
+        char msg[96];
+        snprintf(msg, sizeof(msg), "%s trips", faults[i].name);
+        CHECK(all_tripped && right_reason, msg);
+        snprintf(msg, sizeof(msg), "%s within %uus (worst %uus)", faults[i].name, bound, worst);
+        CHECK(worst <= bound, msg);
+        printf("%-28s worst case %3uus, bound %uus\n", faults[i].name, worst, bound);
+    }
+}
+
+static void test_no_false_trips(void) {
+    // a single sample spike on either channel is debounced
+    bool tripped = false;
+    for (uint32_t start = 1000; start < 1000 + 2 * SAMPLE_US; start++) {
+        fault_t v = { CH_VOUT, start, SAMPLE_US, 0, 0 };
+        fault_t c = { CH_CURRENT, start, SAMPLE_US, 4095, 0 };
+        uint8_t reason;
+        tripped |= (simulate(&v, 0, 13, 3000, &reason) != 0);
+        tripped |= (simulate(&c, 0, 13, 3000, &reason) != 0);
+    }
+    CHECK(!tripped, "spikes shorter than one sample period do not trip");
+
+    // long run of noise inside the limits
+    srand(7);
+    fault_t quiet = { CH_VOUT, 0xffffffff, 0, 0, 150 };
+    uint8_t reason;
+    CHECK(simulate(&quiet, 5, 17, 2000000, &reason) == 0, "two seconds of in-limit noise does not trip");
+}
+
+int main(void) {
+    test_comparator();
+    test_settle();
+    test_vout_hold();
+    test_latency();
+    test_no_false_trips();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,338 @@
+/*
+ * test_spd_nvm.c — Host-side tests for the DDR4/DDR5 SPD NVM helpers
+ *
+ * Uses two SPD images laid out like real modules (a DDR4 SODIMM and a
+ * DDR5 UDIMM: JEDEC base section with its CRC, manufacturer, serial and
+ * part number, the rest blank). Checks the table CRC16 against the bitwise
+ * one it replaced and the standard check value, the incremental CRC fed
+ * in file sized and odd sized pieces, the page planner and diff when a
+ * module is rewritten with one field changed, and the write cycle timer
+ * against a simulated EEPROM. Benchmarks the CRC and counts writes and
+ * polls for a skip-unchanged rewrite against writing everything.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_spd_nvm test_spd_nvm.c ../src/lib/spd_nvm/spd_nvm.c && ./test_spd_nvm
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lib/spd_nvm/spd_nvm.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+typedef struct {
+    uint16_t at;
+    uint8_t b[16];
+} spd_row_t;
+
+// rows that are not all zero
+static const spd_row_t ddr4_rows[] = {
+    { 0x000, { 0x23, 0x11, 0x0c, 0x02, 0x45, 0x21, 0x00, 0x08, 0x00, 0x60, 0x00, 0x03, 0x01, 0x0b, 0x80, 0x00 } },
+    { 0x010, { 0x00, 0x00, 0x07, 0x0d, 0xf8, 0x0f, 0x00, 0x00, 0x6e, 0x6e, 0x6e, 0x11, 0x00, 0x6e, 0xf0, 0x0a } },
+    { 0x020, { 0x20, 0x08, 0x00, 0x05, 0x00, 0xf0, 0x2b, 0x34, 0x28, 0x00, 0x78, 0x00, 0x14, 0x3c, 0x00, 0x00 } },
+    { 0x030, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x16, 0x36, 0x0b, 0x35 } },
+    { 0x040, { 0x16, 0x36, 0x0b, 0x35, 0x00, 0x00, 0x16, 0x36, 0x0b, 0x35, 0x16, 0x36, 0x0b, 0x35, 0x00, 0x00 } },
+    { 0x070, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x9c, 0xb5, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe7, 0x35, 0x42 } },
+    { 0x080, { 0x11, 0x11, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+    { 0x0f0, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x7a } },
+    { 0x140, { 0x80, 0x2c, 0x0f, 0x18, 0x30, 0xa1, 0xb2, 0xc3, 0xd4, 0x43, 0x54, 0x38, 0x47, 0x34, 0x44, 0x46 } },
+    { 0x150, { 0x53, 0x38, 0x32, 0x36, 0x36, 0x2e, 0x43, 0x38, 0x46, 0x4a, 0x20, 0x20, 0x00, 0x00, 0x80, 0x2c } },
+};
+
+static const spd_row_t ddr5_rows[] = {
+    { 0x000, { 0x30, 0x10, 0x12, 0x03, 0x00, 0x04, 0x00, 0x00, 0x00, 0x68, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+    { 0x010, { 0x00, 0x00, 0x00, 0x00, 0x2c, 0x01, 0x00, 0x00, 0xe2, 0x01, 0x00, 0x00, 0x8c, 0x0a, 0x8c, 0x0a } },
+    { 0x0c0, { 0x08, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+    { 0x1f0, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x73, 0x09 } },
+    { 0x200, { 0x80, 0xce, 0x01, 0x23, 0x23, 0x44, 0x55, 0x66, 0x00, 0x4d, 0x34, 0x32, 0x35, 0x52, 0x31, 0x47 } },
+    { 0x210, { 0x42, 0x34, 0x42, 0x42, 0x30, 0x2d, 0x43, 0x51, 0x4b, 0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00 } },
+};
+
+static uint8_t ddr4[512], ddr5[1024];
+
+static void image_load(uint8_t* img, uint32_t size, const spd_row_t* rows, uint32_t count) {
+    memset(img, 0, size);
+    for (uint32_t i = 0; i < count; i++) {
+        memcpy(&img[rows[i].at], rows[i].b, 16);
+    }
+}
+
+static void images_load(void) {
+    image_load(ddr4, sizeof(ddr4), ddr4_rows, sizeof(ddr4_rows) / sizeof(ddr4_rows[0]));
+    image_load(ddr5, sizeof(ddr5), ddr5_rows, sizeof(ddr5_rows) / sizeof(ddr5_rows[0]));
+}
+
+// the bitwise CRC the ddr4/ddr5 commands used before
+static uint16_t crc16_bitwise(const uint8_t* data, uint32_t len) {
+    uint16_t crc = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint32_t rng_state = 0x5bd1e995;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool crc_in_pieces(const spd_nvm_geometry_t* g, const uint8_t* img, uint32_t piece) {
+    spd_nvm_crc_t c;
+    spd_nvm_crc_init(&c, g);
+    for (uint32_t at = 0; at < g->size;) {
+        uint32_t n = piece ? piece : 1 + rng() % 37;
+        if (n > g->size - at) {
+            n = g->size - at;
+        }
+        spd_nvm_crc_feed(&c, &img[at], n);
+        at += n;
+    }
+    return spd_nvm_crc_ok(&c);
+}
+
+/* ── CRC ────────────────────────────────────────────────────────── */
+
+static void test_crc(void) {
+    printf("CRC16:\n");
+    CHECK(spd_nvm_crc16_update(0, (const uint8_t*)"123456789", 9) == 0x31c3, "CRC-16/XMODEM check value");
+    uint8_t buf[600];
+    bool same = true;
+    for (int i = 0; i < 200; i++) {
+        uint32_t n = rng() % sizeof(buf);
+        for (uint32_t j = 0; j < n; j++) {
+            buf[j] = rng();
+        }
+        same &= spd_nvm_crc16_update(0, buf, n) == crc16_bitwise(buf, n);
+    }
+    CHECK(same, "table matches bitwise on random data");
+    uint16_t split = spd_nvm_crc16_update(spd_nvm_crc16_update(0, buf, 100), &buf[100], 200);
+    CHECK(split == crc16_bitwise(buf, 300), "continues across calls");
+
+    images_load();
+    CHECK(crc16_bitwise(ddr4, 126) == (ddr4[126] | ddr4[127] << 8), "DDR4 image CRC (bytes 126:127)");
+    CHECK(crc16_bitwise(ddr5, 510) == (ddr5[510] | ddr5[511] << 8), "DDR5 image CRC (bytes 510:511)");
+}
+
+static void test_crc_incremental(void) {
+    printf("incremental CRC:\n");
+    images_load();
+    CHECK(crc_in_pieces(&spd_nvm_ddr4, ddr4, 128), "DDR4 in 128 byte file reads");
+    CHECK(crc_in_pieces(&spd_nvm_ddr5, ddr5, 128), "DDR5 in 128 byte file reads");
+    CHECK(crc_in_pieces(&spd_nvm_ddr5, ddr5, 1024), "DDR5 in one read");
+    bool ok = true;
+    for (int i = 0; i < 100; i++) {
+        ok &= crc_in_pieces(&spd_nvm_ddr4, ddr4, 0) && crc_in_pieces(&spd_nvm_ddr5, ddr5, 0);
+    }
+    CHECK(ok, "odd sized pieces, stored CRC split between pieces");
+
+    spd_nvm_crc_t c;
+    spd_nvm_crc_init(&c, &spd_nvm_ddr5);
+    spd_nvm_crc_feed(&c, ddr5, 511);
+    CHECK(!spd_nvm_crc_ok(&c) && !spd_nvm_crc_stored(&c), "not ok before the stored CRC arrives");
+    spd_nvm_crc_feed(&c, &ddr5[511], 1);
+    CHECK(spd_nvm_crc_ok(&c) && spd_nvm_crc_stored(&c) == 0x0973, "ok once it has");
+
+    ddr4[0x12] ^= 0x01; // tCKmin
+    CHECK(!crc_in_pieces(&spd_nvm_ddr4, ddr4, 128), "a flipped bit in the base section fails");
+    ddr4[0x12] ^= 0x01;
+    ddr4[0x145] ^= 0xff; // serial number, not covered
+    CHECK(crc_in_pieces(&spd_nvm_ddr4, ddr4, 128), "manufacturer section is not covered");
+}
+
+/* ── Planner ────────────────────────────────────────────────────── */
+
+static void test_plan(void) {
+    printf("page planner:\n");
+    static uint8_t device[1024];
+    spd_nvm_plan_t plan;
+
+    images_load();
+    memcpy(device, ddr4, sizeof(ddr4));
+    spd_nvm_plan(&spd_nvm_ddr4, device, ddr4, &plan);
+    CHECK(plan.writes == 0 && plan.skipped == 32 && plan.pages == 0, "same image: nothing to write");
+
+    // new serial number, 0x145 to 0x148 all in chunk 4 of page 1
+    ddr4[0x145] = 0x01, ddr4[0x146] = 0x02, ddr4[0x147] = 0x03, ddr4[0x148] = 0x04;
+    spd_nvm_plan(&spd_nvm_ddr4, device, ddr4, &plan);
+    CHECK(plan.writes == 1 && plan.pages == 1 && plan.mask[0] == 0 && plan.mask[1] == 1u << 4,
+          "DDR4 serial: one chunk on page 1");
+
+    // part number across a chunk boundary
+    memcpy(&ddr4[0x14b], "16G4SFD8", 8);
+    CHECK(spd_nvm_plan_page(&spd_nvm_ddr4, &device[256], &ddr4[256]) == ((1u << 4) | (1u << 5)),
+          "DDR4 part number straddles chunks 4 and 5");
+
+    // DDR5: XMP style tweak to tCKmin and its CRC
+    memcpy(device, ddr5, sizeof(ddr5));
+    ddr5[0x14] = 0x71;
+    uint16_t crc = crc16_bitwise(ddr5, 510);
+    ddr5[510] = crc, ddr5[511] = crc >> 8;
+    spd_nvm_plan(&spd_nvm_ddr5, device, ddr5, &plan);
+    CHECK(plan.writes == 2 && plan.pages == 2 && plan.mask[0] == 1u << 1 && plan.mask[3] == 1u << 7,
+          "DDR5 timing + CRC: page 0 chunk 1 and page 3 chunk 7");
+    CHECK(plan.skipped == 62, "62 of 64 chunks skipped");
+
+    // blank device
+    memset(device, 0, sizeof(device));
+    spd_nvm_plan(&spd_nvm_ddr5, device, ddr5, &plan);
+    CHECK(plan.writes == 6 && plan.pages == 4, "blank DDR5: only the non zero rows");
+    memset(device, 0xff, sizeof(device));
+    spd_nvm_plan(&spd_nvm_ddr5, device, ddr5, &plan);
+    CHECK(plan.writes == 64 && plan.pages == 8, "erased (0xff) DDR5: everything");
+}
+
+static void test_diff(void) {
+    printf("diff:\n");
+    images_load();
+    static uint8_t other[512];
+    memcpy(other, ddr4, sizeof(ddr4));
+    CHECK(spd_nvm_diff_next(ddr4, other, 0, 512) == 512, "no difference");
+    other[0x7e] ^= 1;
+    other[0x150] ^= 1;
+    uint32_t at = spd_nvm_diff_next(ddr4, other, 0, 512);
+    CHECK(at == 0x7e, "first difference");
+    at = spd_nvm_diff_next(ddr4, other, at + 1, 512);
+    CHECK(at == 0x150, "next difference");
+    CHECK(spd_nvm_diff_next(ddr4, other, at + 1, 512) == 512, "then none");
+}
+
+/* ── Write timer ────────────────────────────────────────────────── */
+
+typedef struct {
+    uint32_t polls;   // busy polls
+    uint32_t late_us; // time after the write really ended
+} sim_t;
+
+// one write of write_us: wait, then poll every poll_us until idle
+static uint32_t sim_write(spd_nvm_timer_t* t, uint32_t write_us, sim_t* s) {
+    uint32_t now = t->wait_us, busy = 0;
+    while (now < write_us) {
+        busy++;
+        now += t->poll_us;
+    }
+    s->polls += busy;
+    s->late_us += now - write_us;
+    spd_nvm_timer_done(t, busy);
+    return busy;
+}
+
+static void test_timer(void) {
+    printf("write timer:\n");
+    spd_nvm_timer_t t;
+    sim_t s = { 0 };
+    // 5ms datasheet, the part takes 3.3ms +-0.2ms
+    spd_nvm_timer_init(&t, 5000, 100);
+    for (int i = 0; i < 20; i++) {
+        sim_write(&t, 3200 + rng() % 400, &s);
+    }
+    s = (sim_t){ 0 };
+    for (int i = 0; i < 100; i++) {
+        sim_write(&t, 3200 + rng() % 400, &s);
+    }
+    CHECK(s.polls <= 200, "settled: at most 2 busy polls per write");
+    CHECK(s.late_us / 100 <= 100, "settled: idle found within one poll");
+
+    // a part that slows down (warm, worn) is followed
+    for (int i = 0; i < 20; i++) {
+        sim_write(&t, 4800, &s);
+    }
+    CHECK(t.wait_us > 4500 && t.wait_us < 4800, "follows a slower part");
+    // and a fast one
+    for (int i = 0; i < 60; i++) {
+        sim_write(&t, 1500, &s);
+    }
+    CHECK(t.wait_us >= 1400 && t.wait_us <= 1500, "follows a faster part");
+    spd_nvm_timer_init(&t, 100, 100);
+    for (int i = 0; i < 10; i++) {
+        sim_write(&t, 0, &s);
+    }
+    CHECK(t.wait_us == t.min_us, "never below the minimum");
+}
+
+/* ── Bench ──────────────────────────────────────────────────────── */
+
+static void bench(void) {
+    static uint8_t buf[1024];
+    for (uint32_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = rng();
+    }
+    volatile uint16_t sink = 0;
+    double t0 = now_s();
+    for (int i = 0; i < 20000; i++) {
+        sink ^= crc16_bitwise(buf, 510);
+    }
+    double bitwise = now_s() - t0;
+    t0 = now_s();
+    for (int i = 0; i < 20000; i++) {
+        sink ^= spd_nvm_crc16_update(0, buf, 510);
+    }
+    double table = now_s() - t0;
+    printf("CRC16 over 510 bytes: bitwise %.2f us, table %.2f us (%.1fx)\n",
+           bitwise / 20000 * 1e6,
+           table / 20000 * 1e6,
+           bitwise / table);
+
+    // rewrite a DDR5 module with a new serial number, 3.3ms writes
+    images_load();
+    static uint8_t device[1024];
+    memcpy(device, ddr5, sizeof(ddr5));
+    ddr5[0x205] ^= 0x5a;
+    spd_nvm_plan_t plan;
+    spd_nvm_plan(&spd_nvm_ddr5, device, ddr5, &plan);
+    spd_nvm_timer_t t;
+    sim_t s = { 0 }, naive = { 0 };
+    spd_nvm_timer_init(&t, 5000, 100);
+    for (int i = 0; i < 64; i++) {
+        sim_write(&t, 3300, &s);
+    }
+    spd_nvm_timer_t poll_now = { .wait_us = 0, .poll_us = 100 };
+    for (int i = 0; i < 64; i++) {
+        sim_write(&poll_now, 3300, &naive);
+        poll_now.wait_us = 0;
+    }
+    printf("DDR5 new serial: %d of 64 chunks written, %d page selects\n", plan.writes, plan.pages);
+    printf("64 writes: %.1f busy polls per write with the timer, %.1f polling from the start\n",
+           (double)s.polls / 64,
+           (double)naive.polls / 64);
+}
+
+int main(void) {
+    printf("=== spd_nvm tests ===\n\n");
+    test_crc();
+    test_crc_incremental();
+    test_plan();
+    test_diff();
+    test_timer();
+    printf("\n");
+    bench();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,409 @@
+/*
+ * test_spi_mio.c — Host-side tests for the multi-I/O SPI flash read planner
+ *
+ * Locates the basic flash parameter table in SFDP headers, decodes the
+ * quad enable requirement and picks read commands from BFPTs laid out as
+ * in flash datasheets (a Winbond W25Q128JV, a Macronix part with the QE
+ * bit in status register 1, a JESD216 table too short for the QE field,
+ * a single line part and a dual only part). Read frames go through a
+ * model of the flash on IO0-IO3, which decodes the instruction, address
+ * and mode bits nibble by nibble, checks WP# and HOLD# stay high, then
+ * answers with junk during the dummy clocks and on the unused lines so the
+ * unpacker has to pick out exactly the data.
+ *
+ * Build and run:
+ *   gcc -O2 -Wall -Wextra -I../src -o test_spi_mio test_spi_mio.c ../src/lib/spi_mio/spi_mio.c && ./test_spi_mio
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lib/spi_mio/spi_mio.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+static uint32_t rng_state = 0x12345678;
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// W25Q128JV: SFDP 1.6, one 16 DWORD BFPT at 0x80
+static const uint8_t w25q128_hdr[16] = {
+    'S', 'F', 'D', 'P', 0x06, 0x01, 0x00, 0xff, 0x00, 0x06, 0x01, 0x10, 0x80, 0x00, 0x00, 0xff,
+};
+static const uint32_t w25q128_bfpt[16] = {
+    0xfff920e5, 0x07ffffff, 0x6b08eb44, 0xbb423b08, 0xfffffffe, 0xff00ffff, 0xeb40ffff, 0x520f200c,
+    0xff00d810, 0x00a60000, 0xd6f20282, 0x0ba2a0ff, 0x7a75d7f9, 0x0a56a0a2, 0xff4df719, 0x80f830e9,
+};
+
+// Macronix layout: QE is status register 1 bit 6, 1-2-2 has 4 dummy clocks and no mode bits
+static const uint32_t mx25l_bfpt[16] = {
+    0xfff320e5, 0x07ffffff, 0x6b08eb44, 0xbb043b08, 0xfffffffe, 0xff00ffff, 0xeb44ffff, 0x520f200c,
+    0xff00d810, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00200000, 0x00000000,
+};
+
+// JESD216 (no revision letter): 9 DWORDs, no QE field
+static const uint32_t jesd216_bfpt[9] = {
+    0xfff320e5, 0x00ffffff, 0x6b08eb44, 0xbb043b08, 0xfffffffe, 0xff00ffff, 0xff00ffff, 0x520f200c, 0xff00d810,
+};
+
+// single line only, then dual output only
+static const uint32_t single_bfpt[9] = {
+    0xff8020e5, 0x003fffff, 0xffffffff, 0xffffffff, 0xfffffffe, 0xffffffff, 0xffffffff, 0x520f200c, 0xff00d810,
+};
+static const uint32_t dual_bfpt[9] = {
+    0xff8120e5, 0x003fffff, 0xffffffff, 0xffff3b08, 0xfffffffe, 0xffffffff, 0xffffffff, 0x520f200c, 0xff00d810,
+};
+
+/* ── Flash model ────────────────────────────────────────────────── */
+
+// what the part does for each read instruction, from its datasheet
+typedef struct {
+    uint8_t opcode;
+    uint8_t addr_lines;
+    uint8_t mode_clocks;
+    uint8_t dummy_clocks;
+    uint8_t data_lines;
+} model_cmd_t;
+
+static const model_cmd_t w25q128_cmds[] = {
+    { 0x03, 1, 0, 0, 1 }, { 0x3b, 1, 0, 8, 2 }, { 0xbb, 2, 2, 2, 2 }, { 0x6b, 1, 0, 8, 4 }, { 0xeb, 4, 2, 4, 4 },
+};
+
+#define FLASH_SIZE 65536
+static uint8_t flash_mem[FLASH_SIZE];
+
+typedef struct {
+    const model_cmd_t* cmd;
+    uint32_t addr;
+    bool idle_ok;   // WP# and HOLD# high outside quad phases
+    bool mode_ok;   // mode bits all ones
+} model_req_t;
+
+static uint8_t nibble_at(const uint32_t* words, uint32_t i) {
+    return (words[i / 8] >> (28 - (i % 8) * 4)) & 0x0f;
+}
+
+// take bits off the IO lines, the top bit on the highest line
+static uint32_t model_bits(const uint32_t* words, uint32_t* i, uint8_t bits, uint8_t lines, bool* idle_ok) {
+    uint32_t v = 0;
+    for (uint8_t b = 0; b < bits; b += lines) {
+        uint8_t n = nibble_at(words, (*i)++);
+        if (lines < 4 && (n & 0x0c) != 0x0c) {
+            *idle_ok = false;
+        }
+        v = (v << lines) | (n & ((1u << lines) - 1));
+    }
+    return v;
+}
+
+static bool model_decode(const uint32_t* words, uint32_t clocks, uint8_t addr_bytes, model_req_t* req) {
+    uint32_t i = 0;
+    req->idle_ok = true;
+    req->mode_ok = true;
+    uint8_t op = (uint8_t)model_bits(words, &i, 8, 1, &req->idle_ok);
+    req->cmd = NULL;
+    for (uint32_t c = 0; c < sizeof(w25q128_cmds) / sizeof(w25q128_cmds[0]); c++) {
+        if (w25q128_cmds[c].opcode == op) {
+            req->cmd = &w25q128_cmds[c];
+        }
+    }
+    if (!req->cmd) {
+        return false;
+    }
+    req->addr = model_bits(words, &i, addr_bytes * 8, req->cmd->addr_lines, &req->idle_ok);
+    for (uint8_t m = 0; m < req->cmd->mode_clocks; m++) {
+        uint8_t n = nibble_at(words, i++);
+        uint8_t ones = (1u << req->cmd->addr_lines) - 1;
+        if ((n & ones) != ones) {
+            req->mode_ok = false;
+        }
+        if (req->cmd->addr_lines < 4 && (n & 0x0c) != 0x0c) {
+            req->idle_ok = false;
+        }
+    }
+    return i == clocks;
+}
+
+// the input phase: junk while the lines are released, data after, junk on unused lines
+static uint32_t model_answer(const model_req_t* req, uint32_t clocks, uint32_t* words) {
+    uint32_t addr = req->addr;
+    uint8_t lines = req->cmd->data_lines;
+    uint8_t byte = 0;
+    int8_t bit = -1;
+    for (uint32_t i = 0; i < clocks; i++) {
+        uint8_t n = rng() & 0x0f;
+        if (i >= req->cmd->dummy_clocks) {
+            if (bit < 0) {
+                byte = flash_mem[addr++ % FLASH_SIZE];
+                bit = 8 - lines;
+            }
+            uint8_t v = (byte >> bit) & ((1u << lines) - 1);
+            bit -= lines;
+            n = lines == 1 ? (n & ~0x02) | (v << 1) : lines == 2 ? (n & ~0x03) | v : v;
+        }
+        if (i % 8 == 0) {
+            words[i / 8] = 0;
+        }
+        words[i / 8] |= (uint32_t)n << (28 - (i % 8) * 4);
+    }
+    return clocks / 8;
+}
+
+/* ── SFDP ───────────────────────────────────────────────────────── */
+
+static void test_locate(void) {
+    printf("sfdp:\n");
+    uint32_t addr = 0, dwords = 0;
+    CHECK(spi_mio_sfdp_locate(w25q128_hdr, &addr, &dwords), "W25Q128JV header");
+    CHECK(addr == 0x80 && dwords == 16, "BFPT at 0x80, 16 DWORDs");
+
+    uint8_t hdr[16];
+    memcpy(hdr, w25q128_hdr, 16);
+    hdr[11] = 20;
+    CHECK(spi_mio_sfdp_locate(hdr, &addr, &dwords) && dwords == SPI_MIO_BFPT_DWORDS, "longer table clamped");
+    hdr[11] = 9;
+    hdr[12] = 0x30;
+    CHECK(spi_mio_sfdp_locate(hdr, &addr, &dwords) && dwords == 9 && addr == 0x30, "JESD216 9 DWORD table");
+    hdr[11] = 8;
+    CHECK(!spi_mio_sfdp_locate(hdr, &addr, &dwords), "too short for a BFPT");
+
+    memcpy(hdr, w25q128_hdr, 16);
+    hdr[0] = 0xff;
+    CHECK(!spi_mio_sfdp_locate(hdr, &addr, &dwords), "erased, no signature");
+    memcpy(hdr, w25q128_hdr, 16);
+    hdr[8] = 0x81;
+    CHECK(!spi_mio_sfdp_locate(hdr, &addr, &dwords), "first table not JEDEC");
+}
+
+static void test_qer(void) {
+    printf("quad enable:\n");
+    uint8_t op = 0, bit = 0;
+    spi_mio_qer_t q = spi_mio_qer(w25q128_bfpt, 16);
+    CHECK(q == SPI_MIO_QER_SR2_BIT1, "W25Q128JV: status register 2 bit 1");
+    CHECK(!spi_mio_qe_status(q, &op, &bit), "no SR2 read instruction given, not checked");
+    CHECK(spi_mio_qe_status(SPI_MIO_QER_SR2_BIT1_35, &op, &bit) && op == 0x35 && bit == 1, "101b read with 35h");
+    CHECK(spi_mio_qe_status(SPI_MIO_QER_SR2_BIT1_31, &op, &bit) && op == 0x35 && bit == 1, "110b read with 35h");
+
+    q = spi_mio_qer(mx25l_bfpt, 16);
+    CHECK(q == SPI_MIO_QER_SR1_BIT6, "Macronix: status register 1 bit 6");
+    CHECK(spi_mio_qe_status(q, &op, &bit) && op == 0x05 && bit == 6, "read with 05h");
+
+    CHECK(spi_mio_qe_status(SPI_MIO_QER_SR2_BIT7, &op, &bit) && op == 0x3f && bit == 7, "bit 7 read with 3Fh");
+    CHECK(spi_mio_qer(jesd216_bfpt, 9) == SPI_MIO_QER_UNKNOWN, "9 DWORDs: unknown");
+    CHECK(spi_mio_qer(NULL, 0) == SPI_MIO_QER_UNKNOWN, "no SFDP: unknown");
+    CHECK(!spi_mio_qe_status(SPI_MIO_QER_UNKNOWN, &op, &bit), "unknown cannot be checked");
+    CHECK(!spi_mio_qe_status(SPI_MIO_QER_SR2_BIT1_NOREAD, &op, &bit), "no read back cannot be checked");
+    CHECK(!spi_mio_qe_status(SPI_MIO_QER_NONE, &op, &bit), "no QE bit, nothing to check");
+}
+
+/* ── Plans ──────────────────────────────────────────────────────── */
+
+static bool plan_is(const spi_mio_plan_t* p, spi_mio_mode_t mode, uint8_t op, uint8_t mode_clocks, uint8_t dummy) {
+    return p->mode == mode && p->opcode == op && p->mode_clocks == mode_clocks && p->dummy_clocks == dummy;
+}
+
+static void test_plan(void) {
+    printf("plan:\n");
+    spi_mio_plan_t p;
+    spi_mio_plan(w25q128_bfpt, 16, 4, true, 3, &p);
+    CHECK(plan_is(&p, SPI_MIO_144, 0xeb, 2, 4), "W25Q128JV quad: 1-4-4 EBh");
+    CHECK(p.addr_lines == 4 && p.data_lines == 4 && p.addr_bytes == 3, "quad address and data");
+    CHECK(spi_mio_plan_clocks(&p, 256) == 8 + 6 + 2 + 4 + 512, "1-4-4 clocks for 256 bytes");
+
+    spi_mio_plan(w25q128_bfpt, 16, 4, false, 3, &p);
+    CHECK(plan_is(&p, SPI_MIO_122, 0xbb, 2, 2), "QE clear: 1-2-2 BBh");
+    spi_mio_plan(w25q128_bfpt, 16, 2, true, 3, &p);
+    CHECK(plan_is(&p, SPI_MIO_122, 0xbb, 2, 2), "two lines wired: 1-2-2 BBh");
+    spi_mio_plan(w25q128_bfpt, 16, 1, true, 3, &p);
+    CHECK(plan_is(&p, SPI_MIO_111, 0x03, 0, 0), "one line wired: 1-1-1 03h");
+
+    spi_mio_plan(mx25l_bfpt, 16, 4, true, 3, &p);
+    CHECK(plan_is(&p, SPI_MIO_144, 0xeb, 2, 4), "Macronix quad: 1-4-4 EBh");
+    spi_mio_plan(mx25l_bfpt, 16, 2, true, 3, &p);
+    CHECK(plan_is(&p, SPI_MIO_122, 0xbb, 0, 4), "Macronix dual: 1-2-2 BBh, 4 dummy");
+
+    spi_mio_plan(jesd216_bfpt, 9, 4, spi_mio_qer(jesd216_bfpt, 9) == SPI_MIO_QER_NONE, 3, &p);
+    CHECK(plan_is(&p, SPI_MIO_122, 0xbb, 0, 4), "9 DWORDs: no quad, 1-2-2");
+    spi_mio_plan(single_bfpt, 9, 4, true, 3, &p);
+    CHECK(plan_is(&p, SPI_MIO_111, 0x03, 0, 0), "single line part: 03h");
+    spi_mio_plan(dual_bfpt, 9, 4, true, 3, &p);
+    CHECK(plan_is(&p, SPI_MIO_112, 0x3b, 0, 8), "dual output only: 1-1-2 3Bh");
+    spi_mio_plan(NULL, 0, 4, true, 3, &p);
+    CHECK(plan_is(&p, SPI_MIO_111, 0x03, 0, 0), "no SFDP: 03h");
+
+    uint32_t broken[16];
+    memcpy(broken, w25q128_bfpt, sizeof(broken));
+    broken[2] &= 0xffff00ff;
+    spi_mio_plan(broken, 16, 4, true, 3, &p);
+    CHECK(plan_is(&p, SPI_MIO_114, 0x6b, 0, 8), "1-4-4 without an instruction skipped");
+
+    spi_mio_plan(w25q128_bfpt, 16, 4, true, 4, &p);
+    CHECK(p.addr_bytes == 4 && spi_mio_plan_clocks(&p, 256) == 8 + 8 + 2 + 4 + 512, "4 byte addresses");
+    CHECK(strcmp(spi_mio_mode_name(SPI_MIO_144), "1-4-4") == 0 && strcmp(spi_mio_mode_name(SPI_MIO_111), "1-1-1") == 0,
+          "mode names");
+}
+
+/* ── Framing ────────────────────────────────────────────────────── */
+
+static void test_framing(void) {
+    printf("framing:\n");
+    // 0xA5 on IO0 one bit per clock, IO2 and IO3 high
+    CHECK(spi_mio_byte_word(0xa5) == 0xdcdccdcd, "byte word for A5h");
+    CHECK(spi_mio_byte_word(0x00) == 0xcccccccc, "byte word for 00h");
+
+    uint32_t words[SPI_MIO_FRAME_MAX_WORDS];
+    spi_mio_plan_t p;
+    spi_mio_plan(w25q128_bfpt, 16, 4, true, 3, &p);
+    uint32_t clocks = spi_mio_frame(&p, 0x123456, words);
+    CHECK(clocks == 16, "1-4-4 frame: 16 clocks");
+    CHECK(words[0] == 0xdddcdcdd && words[1] == 0x123456ff, "EBh, address nibbles, mode FFh");
+
+    spi_mio_plan(w25q128_bfpt, 16, 2, true, 3, &p);
+    clocks = spi_mio_frame(&p, 0xabcdef, words);
+    CHECK(clocks == 22, "1-2-2 frame ends mid word");
+    model_req_t req;
+    CHECK(model_decode(words, clocks, 3, &req) && req.cmd->opcode == 0xbb && req.addr == 0xabcdef, "1-2-2 decoded");
+    CHECK(req.idle_ok && req.mode_ok, "WP# and HOLD# high, mode bits ones");
+
+    spi_mio_plan(w25q128_bfpt, 16, 4, true, 4, &p);
+    clocks = spi_mio_frame(&p, 0x89abcdef, words);
+    CHECK(clocks == 18 && clocks <= SPI_MIO_FRAME_MAX_CLOCKS, "4 byte 1-4-4 frame");
+    spi_mio_plan(NULL, 0, 1, false, 4, &p);
+    CHECK(spi_mio_frame(&p, 0, words) == SPI_MIO_FRAME_MAX_CLOCKS - 8, "longest single line frame fits");
+
+    CHECK(spi_mio_read_clocks(0, 1, 3) == 24, "single line, exact words");
+    CHECK(spi_mio_read_clocks(4, 4, 1) == 8, "dummy and a byte round up");
+    CHECK(spi_mio_read_clocks(2, 2, 256) == 1032, "1-2-2 page rounds up");
+}
+
+static bool round_trip(const spi_mio_plan_t* p, uint32_t addr, uint32_t len, bool* idle_ok) {
+    static uint32_t frame[SPI_MIO_FRAME_MAX_WORDS];
+    static uint32_t answer[(8 + 32 + 8 * 300) / 8 + 1];
+    static uint8_t out[300];
+    uint32_t clocks = spi_mio_frame(p, addr, frame);
+    model_req_t req;
+    if (!model_decode(frame, clocks, p->addr_bytes, &req) || req.addr != addr || !req.mode_ok) {
+        return false;
+    }
+    *idle_ok = *idle_ok && req.idle_ok;
+    uint32_t words = model_answer(&req, spi_mio_read_clocks(p->dummy_clocks, p->data_lines, len), answer);
+    memset(out, 0x5a, sizeof(out));
+    spi_mio_rx_t rx;
+    spi_mio_rx_init(&rx, p->data_lines, p->dummy_clocks, out, len);
+    for (uint32_t w = 0; w < words; w++) {
+        spi_mio_rx_word(&rx, answer[w]);
+    }
+    if (rx.n != len || (len < sizeof(out) && out[len] != 0x5a)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        if (out[i] != flash_mem[(addr + i) % FLASH_SIZE]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_round_trip(void) {
+    printf("round trip:\n");
+    for (uint32_t i = 0; i < FLASH_SIZE; i++) {
+        flash_mem[i] = (uint8_t)rng();
+    }
+    const struct {
+        uint8_t lines;
+        bool quad_ok;
+        const char* msg;
+    } cases[] = {
+        { 1, false, "1-1-1 reads through the model" },
+        { 4, false, "1-2-2 reads through the model" },
+        { 4, true, "1-4-4 reads through the model" },
+    };
+    for (uint32_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        spi_mio_plan_t p;
+        spi_mio_plan(w25q128_bfpt, 16, cases[c].lines, cases[c].quad_ok, 3, &p);
+        bool ok = true, idle_ok = true;
+        for (uint32_t i = 0; i < 500 && ok; i++) {
+            ok = round_trip(&p, rng() % FLASH_SIZE, 1 + rng() % 300, &idle_ok);
+        }
+        CHECK(ok, cases[c].msg);
+        CHECK(idle_ok, "WP# and HOLD# high throughout");
+    }
+    // the other two dual and quad modes, forced
+    spi_mio_plan_t p = { SPI_MIO_112, 0x3b, 1, 3, 0, 8, 2 };
+    bool idle_ok = true;
+    CHECK(round_trip(&p, 0x1234, 255, &idle_ok) && idle_ok, "1-1-2 through the model");
+    p = (spi_mio_plan_t){ SPI_MIO_114, 0x6b, 1, 3, 0, 8, 4 };
+    CHECK(round_trip(&p, 0xfff0, 33, &idle_ok) && idle_ok, "1-1-4 through the model");
+
+    // a read split across words mid byte, one word at a time
+    spi_mio_plan(w25q128_bfpt, 16, 4, false, 3, &p);
+    CHECK(round_trip(&p, 7, 1, &idle_ok), "single byte after 2 dummy clocks");
+}
+
+/* ── Benchmark ──────────────────────────────────────────────────── */
+
+static void bench(void) {
+    static uint32_t answer[(4 + 4096 * 2) / 8 + 1];
+    static uint8_t out[4096];
+    spi_mio_plan_t p;
+    spi_mio_plan(w25q128_bfpt, 16, 4, true, 3, &p);
+    model_req_t req = { &w25q128_cmds[4], 0, true, true };
+    uint32_t words = model_answer(&req, spi_mio_read_clocks(p.dummy_clocks, p.data_lines, sizeof(out)), answer);
+
+    const uint32_t rounds = 2000;
+    double t0 = now_s();
+    for (uint32_t r = 0; r < rounds; r++) {
+        spi_mio_rx_t rx;
+        spi_mio_rx_init(&rx, p.data_lines, p.dummy_clocks, out, sizeof(out));
+        for (uint32_t w = 0; w < words; w++) {
+            spi_mio_rx_word(&rx, answer[w]);
+        }
+    }
+    double dt = now_s() - t0;
+    printf("unpack 1-4-4: %.1f MB/s\n", rounds * (double)sizeof(out) / dt / 1e6);
+
+    const uint8_t lines[] = { 1, 2, 4 };
+    for (uint32_t i = 0; i < sizeof(lines); i++) {
+        spi_mio_plan_t q;
+        spi_mio_plan(w25q128_bfpt, 16, lines[i], true, 3, &q);
+        printf("%s: %u clocks per 256 bytes\n", spi_mio_mode_name(q.mode), spi_mio_plan_clocks(&q, 256));
+    }
+}
+
+int main(void) {
+    printf("=== spi_mio tests ===\n\n");
+    test_locate();
+    test_qer();
+    test_plan();
+    test_framing();
+    test_round_trip();
+    printf("\n");
+    bench();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,785 @@
+/*
+ * test_svf.c — Host-side tests for the streamed SVF/XSVF player
+ *
+ * Plays files against a simulated scan chain clocked one TCK at a time:
+ * the TAP state follows TMS, each device has an instruction register and
+ * IDCODE, BYPASS, DATA and STATUS data registers that capture, shift and
+ * update like the real thing. Device 0 is nearest TDI, a second
+ * bypass-only device can sit between it and TDO for header/trailer
+ * tests. The STATUS register reads busy a set number of times and is
+ * also reloaded when Shift-DR is entered from Exit2-DR, so XSVF retries
+ * see it change. The file is handed over in random sized pieces.
+ *
+ * Checks TMS paths, the compare, SVF parsing (comments, multi-line and
+ * odd length hex, sticky fields, header/trailer, RUNTEST, STATE, TRST,
+ * FREQUENCY), mismatch and error reports, abort, and XSVF including
+ * XREPEAT retries and segmented XSDRB/C/E.
+ *
+ * The benchmark plays a large generated SVF and the matching XSVF
+ * against a byte-wide stand-in for the shifter and reports bits/s.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_svf test_svf.c ../src/lib/svf/svf.c && ./test_svf
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lib/svf/svf.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Simulated chain ────────────────────────────────────────────── */
+
+#define SIM_MAX_BITS 4096
+#define SIM_IDCODE 0x1BA01477u
+#define SIM_IR_IDCODE 0x1
+#define SIM_IR_DATA 0x2
+#define SIM_IR_STATUS 0x3
+
+typedef struct {
+    uint32_t irlen;
+    bool bypass_only;
+    uint32_t ir;
+    uint8_t sr[SIM_MAX_BITS]; // shift register, one bit per byte, circular
+    uint32_t sr_len, head;
+    uint8_t data[SIM_MAX_BITS];
+    uint32_t data_len;
+    uint32_t busy; // STATUS reads 0 this many more times
+} sim_dev_t;
+
+static struct {
+    svf_state_t state;
+    sim_dev_t dev[2];
+    uint32_t ndev;
+    uint64_t clocks;
+    uint64_t idle_clocks;
+    uint64_t delay_us;
+    uint32_t bad_shifts;  // shift called outside Shift-IR/DR
+    uint32_t bad_clocks;  // idle clocks outside a stable state
+    int trst;
+    uint32_t hz;
+    int abort_after;      // abort polls before abort, -1 never
+    // file
+    const uint8_t* file;
+    uint32_t file_len, file_pos;
+    uint32_t max_read;    // 0 = whatever fits
+} sim;
+
+static uint32_t rng = 0x2468ace1;
+
+static uint32_t xorshift(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static void dev_reset(sim_dev_t* d) {
+    d->ir = d->bypass_only ? (1u << d->irlen) - 1 : SIM_IR_IDCODE;
+}
+
+static void sim_reset(uint32_t ndev) {
+    memset(&sim, 0, sizeof(sim));
+    sim.ndev = ndev;
+    sim.state = SVF_IDLE; // not RESET, the player must get there itself
+    sim.trst = -1;
+    sim.abort_after = -1;
+    sim.dev[0].irlen = 4;
+    sim.dev[0].data_len = 1000;
+    sim.dev[1].irlen = 2;
+    sim.dev[1].bypass_only = true;
+    for (uint32_t i = 0; i < ndev; i++) {
+        dev_reset(&sim.dev[i]);
+    }
+}
+
+static uint32_t dev_dr_bits(const sim_dev_t* d, uint32_t* value) {
+    *value = 0;
+    if (d->bypass_only) {
+        return 1;
+    }
+    switch (d->ir) {
+        case SIM_IR_IDCODE:
+            *value = SIM_IDCODE;
+            return 32;
+        case SIM_IR_DATA:
+            return d->data_len;
+        case SIM_IR_STATUS:
+            *value = d->busy ? 0 : 1;
+            return 8;
+        default:
+            return 1;
+    }
+}
+
+static void dev_capture(sim_dev_t* d, bool ir) {
+    d->head = 0;
+    if (ir) {
+        // IEEE: 01 in the two bits nearest TDO
+        d->sr_len = d->irlen;
+        for (uint32_t i = 0; i < d->irlen; i++) {
+            d->sr[i] = i == 0;
+        }
+        return;
+    }
+    uint32_t v;
+    d->sr_len = dev_dr_bits(d, &v);
+    if (!d->bypass_only && d->ir == SIM_IR_DATA) {
+        memcpy(d->sr, d->data, d->data_len);
+        return;
+    }
+    if (!d->bypass_only && d->ir == SIM_IR_STATUS && d->busy) {
+        d->busy--;
+    }
+    for (uint32_t i = 0; i < d->sr_len; i++) {
+        d->sr[i] = (v >> i) & 1;
+    }
+}
+
+static void dev_update(sim_dev_t* d, bool ir) {
+    uint32_t v = 0;
+    for (uint32_t i = 0; i < d->sr_len; i++) {
+        if (ir) {
+            v |= (uint32_t)d->sr[(d->head + i) % d->sr_len] << i;
+        } else if (!d->bypass_only && d->ir == SIM_IR_DATA) {
+            d->data[i] = d->sr[(d->head + i) % d->sr_len];
+        }
+    }
+    if (ir) {
+        d->ir = v;
+    }
+}
+
+static int sim_clock(int tms, int tdi) {
+    int tdo = 0;
+    svf_state_t cur = sim.state;
+    if (cur == SVF_DRSHIFT || cur == SVF_IRSHIFT) {
+        int in = tdi;
+        for (uint32_t i = 0; i < sim.ndev; i++) {
+            sim_dev_t* d = &sim.dev[i];
+            int out = d->sr[d->head];
+            d->sr[d->head] = (uint8_t)in;
+            d->head = (d->head + 1) % d->sr_len;
+            in = out;
+        }
+        tdo = in;
+    }
+    svf_state_t next = svf_next_state(cur, tms);
+    for (uint32_t i = 0; i < sim.ndev; i++) {
+        sim_dev_t* d = &sim.dev[i];
+        switch (next) {
+            case SVF_RESET:
+                dev_reset(d);
+                break;
+            case SVF_IRCAPTURE:
+            case SVF_DRCAPTURE:
+                dev_capture(d, next == SVF_IRCAPTURE);
+                break;
+            case SVF_IRUPDATE:
+            case SVF_DRUPDATE:
+                dev_update(d, next == SVF_IRUPDATE);
+                break;
+            case SVF_DRSHIFT:
+                if (cur == SVF_DREXIT2 && !d->bypass_only && d->ir == SIM_IR_STATUS) {
+                    dev_capture(d, false);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    if (cur == SVF_IDLE && next == SVF_IDLE) {
+        sim.idle_clocks++;
+    }
+    sim.state = next;
+    sim.clocks++;
+    return tdo;
+}
+
+static void sim_tms(uint32_t tms, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        sim_clock((tms >> i) & 1, 0);
+    }
+}
+
+static void sim_shift(const uint8_t* tdi, uint8_t* tdo, uint32_t bits, bool exit) {
+    if (sim.state != SVF_DRSHIFT && sim.state != SVF_IRSHIFT) {
+        sim.bad_shifts++;
+    }
+    if (tdo) {
+        memset(tdo, 0, (bits + 7) / 8);
+    }
+    for (uint32_t i = 0; i < bits; i++) {
+        int out = sim_clock(exit && i == bits - 1, (tdi[i / 8] >> (i % 8)) & 1);
+        if (tdo && out) {
+            tdo[i / 8] |= (uint8_t)(1u << (i % 8));
+        }
+    }
+}
+
+static void sim_clocks(uint32_t count) {
+    if (sim.state != SVF_IDLE && sim.state != SVF_DRPAUSE && sim.state != SVF_IRPAUSE) {
+        sim.bad_clocks++;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        sim_clock(0, 0);
+    }
+}
+
+static void sim_delay_us(uint32_t us) {
+    sim.delay_us += us;
+}
+
+static void sim_trst(svf_trst_t mode) {
+    sim.trst = (int)mode;
+    if (mode == SVF_TRST_ON) {
+        for (uint32_t i = 0; i < sim.ndev; i++) {
+            dev_reset(&sim.dev[i]);
+        }
+    }
+}
+
+static uint32_t sim_frequency(uint32_t hz) {
+    sim.hz = (hz == 0 || hz > 10000000) ? 10000000 : hz;
+    return sim.hz;
+}
+
+static bool sim_abort(void) {
+    if (sim.abort_after < 0) {
+        return false;
+    }
+    return sim.abort_after-- == 0;
+}
+
+static uint32_t sim_read(uint8_t* buf, uint32_t cap) {
+    uint32_t n = sim.file_len - sim.file_pos;
+    if (n > cap) {
+        n = cap;
+    }
+    if (sim.max_read && n > 1) {
+        uint32_t r = 1 + xorshift() % sim.max_read;
+        if (n > r) {
+            n = r;
+        }
+    }
+    memcpy(buf, sim.file + sim.file_pos, n);
+    sim.file_pos += n;
+    return n;
+}
+
+static const svf_ops_t sim_ops = {
+    .tms = sim_tms,
+    .shift = sim_shift,
+    .clocks = sim_clocks,
+    .delay_us = sim_delay_us,
+    .trst = sim_trst,
+    .frequency = sim_frequency,
+    .abort = sim_abort,
+    .read = sim_read,
+};
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+static svf_t svf;
+static uint8_t arena[128 * 1024];
+
+static svf_err_t play(const void* file, uint32_t len, bool xsvf) {
+    sim.file = file;
+    sim.file_len = len;
+    sim.file_pos = 0;
+    svf_init(&svf, &sim_ops, arena, sizeof(arena), 1000000);
+    return xsvf ? xsvf_play(&svf) : svf_play(&svf);
+}
+
+static svf_err_t play_svf(const char* text) {
+    return play(text, (uint32_t)strlen(text), false);
+}
+
+// one bit per byte to SVF hex, most significant digit first, a newline every 64 digits
+static void to_hex(char* out, const uint8_t* bits, uint32_t n) {
+    uint32_t digits = (n + 3) / 4;
+    for (uint32_t k = 0; k < digits; k++) {
+        uint32_t nib = digits - 1 - k;
+        uint32_t v = 0;
+        for (uint32_t b = 0; b < 4; b++) {
+            uint32_t i = nib * 4 + b;
+            if (i < n && bits[i]) {
+                v |= 1u << b;
+            }
+        }
+        *out++ = "0123456789abcdef"[v];
+        if (k % 64 == 63) {
+            *out++ = '\n';
+        }
+    }
+    *out = 0;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_paths(void) {
+    uint32_t tms;
+    CHECK(svf_path(SVF_RESET, SVF_IDLE, &tms) == 1 && tms == 0, "reset to idle");
+    CHECK(svf_path(SVF_IDLE, SVF_DRSHIFT, &tms) == 3 && tms == 0x1, "idle to shift-dr");
+    CHECK(svf_path(SVF_IDLE, SVF_IRSHIFT, &tms) == 4 && tms == 0x3, "idle to shift-ir");
+    CHECK(svf_path(SVF_DREXIT1, SVF_IDLE, &tms) == 2 && tms == 0x1, "exit1 to idle");
+    CHECK(svf_path(SVF_IDLE, SVF_IDLE, &tms) == 0, "no move");
+
+    // every pair lands where it should, and no shorter TMS sequence does
+    bool ok = true, shortest = true;
+    for (int a = 0; a < SVF_STATE_COUNT; a++) {
+        for (int b = 0; b < SVF_STATE_COUNT; b++) {
+            uint32_t n = svf_path((svf_state_t)a, (svf_state_t)b, &tms);
+            svf_state_t s = (svf_state_t)a;
+            for (uint32_t i = 0; i < n; i++) {
+                s = svf_next_state(s, (tms >> i) & 1);
+            }
+            ok = ok && s == (svf_state_t)b;
+            for (uint32_t k = 1; k < n; k++) {
+                for (uint32_t seq = 0; seq < (1u << k); seq++) {
+                    s = (svf_state_t)a;
+                    for (uint32_t i = 0; i < k; i++) {
+                        s = svf_next_state(s, (seq >> i) & 1);
+                    }
+                    shortest = shortest && s != (svf_state_t)b;
+                }
+            }
+        }
+    }
+    CHECK(ok, "all paths");
+    CHECK(shortest, "all paths shortest");
+    CHECK(!strcmp(svf_state_name(SVF_DRPAUSE), "DRPAUSE"), "state name");
+}
+
+static void test_compare(void) {
+    uint8_t a[37], b[37], m[37];
+    for (uint32_t i = 0; i < sizeof(a); i++) {
+        a[i] = b[i] = (uint8_t)xorshift();
+        m[i] = 0xff;
+    }
+    CHECK(svf_compare(a, b, m, 296) == -1, "equal");
+    b[21] ^= 0x10;
+    CHECK(svf_compare(a, b, m, 296) == 21 * 8 + 4, "first difference");
+    b[3] ^= 0x01;
+    CHECK(svf_compare(a, b, m, 296) == 24, "earliest wins");
+    m[3] = 0xfe;
+    CHECK(svf_compare(a, b, m, 296) == 21 * 8 + 4, "masked bit ignored");
+    CHECK(svf_compare(a, b, m, 21 * 8 + 4) == -1, "bits past the length ignored");
+    b[21] ^= 0x10;
+    b[36] ^= 0x80;
+    CHECK(svf_compare(a, b, m, 36 * 8 + 7) == -1, "partial byte");
+    CHECK(svf_compare(a, b, m, 296) == 36 * 8 + 7, "last bit");
+}
+
+static void test_idcode(void) {
+    sim_reset(1);
+    svf_err_t err = play_svf("// read the IDCODE\n"
+                             "TRST OFF;\n"
+                             "ENDIR IDLE;\n"
+                             "ENDDR IDLE;\n"
+                             "STATE RESET;\n"
+                             "STATE IDLE;\n"
+                             "SIR 4 TDI (1);\n"
+                             "SDR 32 TDI (00000000) TDO (1BA01477) MASK (0FFFFFFF);\n");
+    CHECK(err == SVF_OK, "idcode plays");
+    CHECK(svf.result.statements == 7, "seven statements");
+    CHECK(svf.result.compares == 1, "one compare");
+    CHECK(svf.result.bits == 36, "36 bits shifted");
+    CHECK(sim.trst == SVF_TRST_OFF, "trst released");
+    CHECK(sim.state == SVF_IDLE && svf.state == SVF_IDLE, "ends in idle");
+    CHECK(sim.bad_shifts == 0, "shifts in shift states");
+
+    // wrong version nibble, compared
+    sim_reset(1);
+    err = play_svf("SIR 4 TDI (1);\n"
+                   "\n"
+                   "SDR 32 TDI (00000000)\n"
+                   "   TDO (2BA01477);\n");
+    CHECK(err == SVF_ERR_MISMATCH, "mismatch");
+    CHECK(svf.result.line == 3 && !strcmp(svf.result.cmd, "SDR"), "mismatch line and statement");
+    CHECK(svf.result.bit == 28 && svf.result.expected == 0 && svf.result.actual == 1, "mismatch bit");
+    CHECK(!strcmp(svf_error_text(err), "TDO mismatch"), "error text");
+
+    // after reset the instruction is IDCODE already
+    sim_reset(1);
+    CHECK(play_svf("sdr 32 tdo (1ba01477);") == SVF_OK, "lower case, idcode after reset");
+}
+
+static void test_data_register(void) {
+    static uint8_t value[1000];
+    static char hex[400], text[2000];
+    for (uint32_t i = 0; i < 1000; i++) {
+        value[i] = xorshift() & 1;
+    }
+    to_hex(hex, value, 1000);
+    snprintf(text, sizeof(text),
+             "! write then read back\n"
+             "SIR 4 TDI (2);\n"
+             "SDR 1000 TDI (%s);\n"
+             "SDR 1000 TDI (0) TDO (%s) ; // and again\n"
+             "SDR 1000 TDO (0);\n",
+             hex, hex);
+    for (uint32_t max_read = 1; max_read <= 61; max_read += 20) {
+        sim_reset(1);
+        sim.max_read = max_read;
+        CHECK(play_svf(text) == SVF_OK, "write and read back, split reads");
+        CHECK(memcmp(sim.dev[0].data, (uint8_t[1000]){ 0 }, 1000) == 0, "cleared by the last write");
+    }
+
+    // the stored value, and TDI sticks while the length stays
+    sim_reset(1);
+    snprintf(text, sizeof(text), "SIR 4 TDI (2); SDR 1000 TDI (%s); SDR 1000 TDO (%s);", hex, hex);
+    CHECK(play_svf(text) == SVF_OK, "sticky TDI");
+    CHECK(memcmp(sim.dev[0].data, value, 1000) == 0, "register holds the value");
+    CHECK(svf.result.bits == 2004, "bits counted");
+}
+
+static void test_hex(void) {
+    sim_reset(1);
+    sim.dev[0].data_len = 12;
+    CHECK(play_svf("SIR 4 TDI (2); SDR 12 TDI (abc);") == SVF_OK, "odd digit count");
+    uint32_t v = 0;
+    for (uint32_t i = 0; i < 12; i++) {
+        v |= (uint32_t)sim.dev[0].data[i] << i;
+    }
+    CHECK(v == 0xabc, "value");
+    CHECK(play_svf("SIR 4 TDI (2); SDR 12 TDI (0000c); SDR 12 TDO (00c);") == SVF_OK, "extra leading zeros");
+    CHECK(play_svf("SIR 4 TDI (2); SDR 12 TDI (1); SDR 12 TDO (1) MASK (fff);") == SVF_OK, "short hex");
+    CHECK(play_svf("SIR 4 TDI (2); SDR 12 TDI (fx1);") == SVF_ERR_SYNTAX, "bad digit");
+    CHECK(play_svf("SIR 4 TDI (2); SDR 12 TDI (abc") == SVF_ERR_SYNTAX, "unterminated");
+}
+
+static void test_header_trailer(void) {
+    // device 1 (2 bit IR, bypass) sits between device 0 and TDO
+    sim_reset(2);
+    svf_err_t err = play_svf("HIR 2 TDI (3);\n"
+                             "HDR 1 TDI (0);\n"
+                             "SIR 4 TDI (1);\n"
+                             "SDR 32 TDO (1BA01477);\n");
+    CHECK(err == SVF_OK, "header reaches the target");
+    CHECK(sim.dev[1].ir == 3 && sim.dev[0].ir == SIM_IR_IDCODE, "both instructions");
+
+    sim_reset(2);
+    err = play_svf("HIR 2 TDI (3);\nSIR 4 TDI (1);\nSDR 32 TDO (1BA01477);\n");
+    CHECK(err == SVF_ERR_MISMATCH && svf.result.line == 3, "missing HDR is off by one");
+
+    // the same chain seen from the other side: trailer bits
+    sim_reset(2);
+    sim.dev[0].irlen = 2;
+    sim.dev[0].bypass_only = true;
+    sim.dev[1].irlen = 4;
+    sim.dev[1].bypass_only = false;
+    dev_reset(&sim.dev[0]);
+    dev_reset(&sim.dev[1]);
+    err = play_svf("TIR 2 TDI (3);\n"
+                   "TDR 1 TDI (0);\n"
+                   "SIR 4 TDI (1);\n"
+                   "SDR 32 TDO (1BA01477);\n"
+                   "TIR 0; TDR 0;\n");
+    CHECK(err == SVF_OK, "trailer");
+}
+
+static void test_states(void) {
+    sim_reset(1);
+    CHECK(play_svf("ENDDR DRPAUSE; SDR 32 TDO (1BA01477);") == SVF_OK, "enddr");
+    CHECK(sim.state == SVF_DRPAUSE && svf.state == SVF_DRPAUSE, "ends in pause");
+
+    sim_reset(1);
+    CHECK(play_svf("STATE IDLE; STATE DRSELECT DRCAPTURE DREXIT1 DRPAUSE;") == SVF_OK, "explicit path");
+    CHECK(sim.state == SVF_DRPAUSE, "path followed");
+    CHECK(play_svf("STATE IDLE DRSHIFT;") == SVF_ERR_SYNTAX, "not adjacent");
+    CHECK(play_svf("STATE IRPAUSE; ENDIR IREXIT1;") == SVF_ERR_SYNTAX, "unstable end state");
+
+    // 100 clocks at 1 MHz take 100 us of the 1 ms
+    sim_reset(1);
+    CHECK(play_svf("RUNTEST IDLE 100 TCK 1.0E-3 SEC MAXIMUM 1 SEC ENDSTATE DRPAUSE;") == SVF_OK, "runtest");
+    CHECK(sim.idle_clocks == 100 && sim.delay_us == 900, "clocks then the rest as delay");
+    CHECK(sim.state == SVF_DRPAUSE, "runtest end state");
+    CHECK(sim.bad_clocks == 0, "clocked in idle");
+
+    sim_reset(1);
+    CHECK(play_svf("FREQUENCY 2E6 HZ; RUNTEST 1000 TCK; RUNTEST 1E-3 SEC;") == SVF_OK, "frequency");
+    CHECK(sim.hz == 2000000 && svf.tck_hz == 2000000, "frequency set");
+    CHECK(sim.idle_clocks == 1000 && sim.delay_us == 1000, "count and time");
+    CHECK(play_svf("FREQUENCY;") == SVF_OK && sim.hz == 10000000, "fastest");
+
+    sim_reset(1);
+    CHECK(play_svf("TRST ON; TRST ABSENT;") == SVF_OK && sim.trst == SVF_TRST_ABSENT, "trst");
+}
+
+static void test_errors(void) {
+    sim_reset(1);
+    CHECK(play_svf("SIR 4 TDI (1);\nPIO (HLX);\n") == SVF_ERR_UNSUPPORTED, "pio refused");
+    CHECK(svf.result.line == 2 && !strcmp(svf.result.cmd, "PIO"), "pio reported");
+    CHECK(play_svf("SIR 4 TDI (1);\n\nBOGUS 1;\n") == SVF_ERR_SYNTAX && svf.result.line == 3, "unknown statement");
+    CHECK(play_svf("SDR 32 TDI (0) TDX (0);") == SVF_ERR_SYNTAX, "unknown field");
+    CHECK(play_svf("SDR 2000000 TDI (0);") == SVF_ERR_TOO_LONG, "longer than the arena");
+    CHECK(play_svf("SIR 2000 TDI (0);") == SVF_ERR_TOO_LONG, "long SIR");
+    CHECK(play_svf("RUNTEST 10 FOO;") == SVF_ERR_SYNTAX, "runtest unit");
+
+    sim_reset(1);
+    sim.abort_after = 2;
+    CHECK(play_svf("STATE IDLE; STATE IDLE; STATE IDLE; STATE IDLE;") == SVF_ERR_ABORT, "abort");
+    CHECK(svf.result.statements == 2, "stopped between statements");
+
+    CHECK(play_svf("") == SVF_OK && svf.result.statements == 0, "empty file");
+    CHECK(sim.state == SVF_RESET, "reset at the start");
+
+    uint8_t small[4096];
+    CHECK(!svf_init(&svf, &sim_ops, small, sizeof(small), 1000000), "arena too small");
+}
+
+// XSVF commands
+enum { X_COMPLETE = 0, X_TDOMASK, X_SIR, X_SDR, X_RUNTEST, X_REPEAT = 7, X_SDRSIZE, X_SDRTDO, X_SETSDRMASKS,
+       X_SDRINC, X_SDRB, X_SDRC, X_SDRE, X_SDRTDOB, X_SDRTDOC, X_SDRTDOE, X_STATE, X_ENDIR, X_ENDDR, X_SIR2,
+       X_COMMENT, X_WAIT };
+
+static uint8_t xbuf[4096];
+static uint32_t xlen;
+
+static void xb(uint32_t n, ...) {
+    va_list ap;
+    va_start(ap, n);
+    for (uint32_t i = 0; i < n; i++) {
+        xbuf[xlen++] = (uint8_t)va_arg(ap, int);
+    }
+    va_end(ap);
+}
+
+static void x32(uint32_t v) {
+    xb(4, v >> 24, (v >> 16) & 0xff, (v >> 8) & 0xff, v & 0xff);
+}
+
+static void test_xsvf(void) {
+    sim_reset(1);
+    xlen = 0;
+    xb(2, X_STATE, 0);
+    xb(2, X_STATE, 1);
+    xb(1, X_COMMENT);
+    memcpy(xbuf + xlen, "idcode", 7);
+    xlen += 7;
+    xb(3, X_SIR, 4, 0x01);
+    xb(1, X_SDRSIZE);
+    x32(32);
+    xb(1, X_TDOMASK);
+    x32(0x0fffffff);
+    xb(1, X_SDRTDO);
+    x32(0);
+    x32(0x1ba01477);
+    xb(1, X_COMPLETE);
+    xb(3, 0xff, 0xff, 0xff); // ignored
+    CHECK(play(xbuf, xlen, true) == SVF_OK, "xsvf idcode");
+    CHECK(svf.result.statements == 8 && svf.result.compares == 1, "xsvf statements");
+
+    // mismatch reports the command number
+    xbuf[xlen - 7] = 0xbb;
+    sim_reset(1);
+    CHECK(play(xbuf, xlen, true) == SVF_ERR_MISMATCH, "xsvf mismatch");
+    CHECK(svf.result.line == 7 && !strcmp(svf.result.cmd, "XSDRTDO"), "xsvf mismatch command");
+    CHECK(svf.result.bit == 0 && svf.result.actual == 0 && svf.result.retries == 32, "all retries used, the last one reports");
+
+    // STATUS busy for 3 reads: XSDRTDO retries until it reads done
+    sim_reset(1);
+    sim.dev[0].busy = 3;
+    xlen = 0;
+    xb(1, X_RUNTEST);
+    x32(1000);
+    xb(2, X_REPEAT, 8);
+    xb(2, X_SIR2, 0);
+    xb(2, 4, SIM_IR_STATUS);
+    xb(1, X_SDRSIZE);
+    x32(8);
+    xb(3, X_SDRTDO, 0x00, 0x01);
+    xb(1, X_COMPLETE);
+    CHECK(play(xbuf, xlen, true) == SVF_OK, "retried until done");
+    CHECK(svf.result.retries == 3, "three retries");
+    // 1000 us after XSIR2, then the DR wait grew 25% per retry: 1000, 1250, 1562, 1952
+    CHECK(sim.idle_clocks + sim.delay_us == 1000 + 1952, "run time grows");
+
+    sim_reset(1);
+    sim.dev[0].busy = 3;
+    xbuf[6] = 2;
+    CHECK(play(xbuf, xlen, true) == SVF_ERR_MISMATCH && svf.result.retries == 2, "retries run out");
+
+    // a 96 bit write in three segments, read back in one
+    sim_reset(1);
+    sim.dev[0].data_len = 96;
+    xlen = 0;
+    xb(3, X_SIR, 4, SIM_IR_DATA);
+    xb(2, X_ENDDR, 1);
+    xb(1, X_SDRSIZE);
+    x32(32);
+    xb(1, X_SDRB);
+    x32(0x11111111);
+    xb(1, X_SDRC);
+    x32(0x22222222);
+    xb(1, X_SDRE);
+    x32(0x33333333);
+    xb(2, X_STATE, 1);
+    xb(2, X_ENDDR, 0);
+    xb(1, X_SDRSIZE);
+    x32(96);
+    xb(1, X_SDRTDO);
+    x32(0);
+    x32(0);
+    x32(0);
+    x32(0x33333333);
+    x32(0x22222222);
+    x32(0x11111111);
+    xb(1, X_WAIT);
+    xb(2, SVF_DRPAUSE, SVF_IDLE);
+    x32(500);
+    xb(1, X_COMPLETE);
+    CHECK(play(xbuf, xlen, true) == SVF_OK, "segmented write");
+    CHECK(sim.bad_shifts == 0 && svf.result.bits == 4 + 96 + 96, "one scan in three parts");
+    CHECK(sim.delay_us == 500 && sim.state == SVF_IDLE, "xwait");
+
+    sim_reset(1);
+    xlen = 0;
+    xb(2, X_STATE, 1);
+    xb(1, X_SETSDRMASKS);
+    CHECK(play(xbuf, xlen, true) == SVF_ERR_UNSUPPORTED && svf.result.line == 2, "unsupported command");
+    CHECK(!strcmp(svf.result.cmd, "XSETSDRMASKS"), "unsupported named");
+    xlen = 0;
+    xb(1, X_SDRSIZE);
+    x32(2000000);
+    CHECK(play(xbuf, xlen, true) == SVF_ERR_TOO_LONG, "xsvf too long");
+    xlen = 0;
+    xb(2, X_SIR, 8);
+    CHECK(play(xbuf, xlen, true) == SVF_ERR_SYNTAX, "truncated");
+}
+
+/* ── Benchmark ──────────────────────────────────────────────────── */
+
+// a single register as long as each scan: TDO is the previous TDI
+static uint8_t bench_reg[32768];
+
+static void bench_tms(uint32_t tms, uint32_t count) {
+    (void)tms;
+    (void)count;
+}
+
+static void bench_shift(const uint8_t* tdi, uint8_t* tdo, uint32_t bits, bool exit) {
+    (void)exit;
+    uint32_t n = (bits + 7) / 8;
+    if (tdo) {
+        memcpy(tdo, bench_reg, n);
+    }
+    memcpy(bench_reg, tdi, n);
+}
+
+static void bench_clocks(uint32_t count) {
+    (void)count;
+}
+
+static const svf_ops_t bench_ops = {
+    .tms = bench_tms,
+    .shift = bench_shift,
+    .clocks = bench_clocks,
+    .delay_us = sim_delay_us,
+    .trst = sim_trst,
+    .read = sim_read,
+};
+
+static void bench(void) {
+    const uint32_t bits = 8192, scans = 1000;
+    uint32_t text_cap = scans * (bits / 2 + bits / 64 + 64);
+    char* text = malloc(text_cap);
+    uint8_t* xsvf = malloc(scans * (2 * bits / 8 + 1) + 16);
+    static uint8_t value[8192], prev[8192];
+    static char hex[8192 / 4 + 8192 / 256 + 1];
+    uint32_t tl = 0, xl = 0;
+
+    xsvf[xl++] = X_SDRSIZE;
+    xsvf[xl++] = 0;
+    xsvf[xl++] = 0;
+    xsvf[xl++] = bits >> 8;
+    xsvf[xl++] = 0;
+    for (uint32_t k = 0; k < scans; k++) {
+        for (uint32_t i = 0; i < bits; i++) {
+            value[i] = xorshift() & 1;
+        }
+        to_hex(hex, value, bits);
+        if (k == 0) {
+            tl += sprintf(text + tl, "SDR %u TDI (%s);\n", bits, hex);
+        } else {
+            tl += sprintf(text + tl, "SDR %u TDI (%s)\n TDO (", bits, hex);
+            to_hex(hex, prev, bits);
+            tl += sprintf(text + tl, "%s);\n", hex);
+        }
+        xsvf[xl++] = X_SDRTDO;
+        for (uint32_t j = 0; j < 2; j++) {
+            const uint8_t* v = j ? prev : value;
+            for (uint32_t b = bits / 8; b-- > 0;) {
+                uint8_t byte = 0;
+                for (uint32_t i = 0; i < 8; i++) {
+                    byte |= (uint8_t)((k || !j ? v[b * 8 + i] : 0) << i);
+                }
+                xsvf[xl++] = byte;
+            }
+        }
+        memcpy(prev, value, bits);
+    }
+    xsvf[xl++] = X_COMPLETE;
+
+    memset(&sim, 0, sizeof(sim));
+    for (int x = 0; x < 2; x++) {
+        memset(bench_reg, 0, sizeof(bench_reg));
+        sim.file = x ? xsvf : (const uint8_t*)text;
+        sim.file_len = x ? xl : tl;
+        sim.file_pos = 0;
+        sim.max_read = 0;
+        svf_init(&svf, &bench_ops, arena, sizeof(arena), 10000000);
+        double t0 = now_s();
+        svf_err_t err = x ? xsvf_play(&svf) : svf_play(&svf);
+        double t = now_s() - t0;
+        CHECK(err == SVF_OK && svf.result.compares == scans - (x ? 0 : 1), x ? "xsvf bench" : "svf bench");
+        printf("%s: %u KB file, %u scans of %u bits, %.1f ms, %.1f Mbit/s (%.1f MB/s of file)\n",
+               x ? "XSVF" : "SVF ",
+               (x ? xl : tl) / 1024,
+               scans,
+               bits,
+               t * 1e3,
+               svf.result.bits / t / 1e6,
+               (x ? xl : tl) / t / 1e6);
+    }
+    free(text);
+    free(xsvf);
+}
+
+int main(void) {
+    printf("=== svf tests ===\n\n");
+    test_paths();
+    test_compare();
+    test_idcode();
+    test_data_register();
+    test_hex();
+    test_header_trailer();
+    test_states();
+    test_errors();
+    test_xsvf();
+    printf("\n");
+    bench();
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return tests_pass == tests_run ? 0 : 1;
+}
@@ -0,0 +1,453 @@
+/*
+ * test_uart_mon.c — Host-side tests for the two channel UART monitor
+ *
+ * Feeds the merge synthetic timestamped chunks from channels A and B and
+ * RTS/CTS events, polled in random order, and checks that records come
+ * out in time order with every byte of each channel in sequence. Also
+ * covers chunk splitting, timestamp clamping, full lanes, 32 bit time
+ * wrap, the hex/ASCII view and the log record format.
+ *
+ * The benchmark runs the merge with the view and with the log packer to
+ * show how many bytes per second the CPU side keeps up with.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_uart_mon test_uart_mon.c ../src/lib/uart_mon/uart_mon.c && ./test_uart_mon
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lib/uart_mon/uart_mon.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+// 115200 baud 8N1
+#define BYTE_NS 86806
+
+static char out_text[1 << 16];
+static size_t out_len;
+
+static void out_write(void* ctx, const char* buf, size_t len) {
+    (void)ctx;
+    if (out_len + len < sizeof(out_text)) {
+        memcpy(&out_text[out_len], buf, len);
+        out_len += len;
+        out_text[out_len] = 0;
+    }
+}
+
+static void out_reset(void) {
+    out_len = 0;
+    out_text[0] = 0;
+}
+
+static size_t null_bytes;
+
+static void null_write(void* ctx, const char* buf, size_t len) {
+    (void)ctx;
+    (void)buf;
+    null_bytes += len;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_merge_order(void) {
+    umon_merge_t m;
+    umon_rec_t r;
+    umon_merge_init(&m);
+
+    umon_push_data(&m, UMON_CH_B, 100, BYTE_NS, (const uint8_t*)"OK", 2);
+    umon_push_data(&m, UMON_CH_A, 50, BYTE_NS, (const uint8_t*)"AT", 2);
+    CHECK(!umon_pop(&m, &r, false), "held while the line lane was never seen");
+
+    umon_seen(&m, UMON_LANE_LINES, 200);
+    CHECK(umon_pop(&m, &r, false) && r.chan == UMON_CH_A && r.ts_us == 50, "A first");
+    CHECK(r.len == 2 && memcmp(r.data, "AT", 2) == 0, "A data");
+    // A was seen up to the end of "AT" (~224us), B at 100 is earlier
+    CHECK(umon_pop(&m, &r, false) && r.chan == UMON_CH_B && r.ts_us == 100, "then B");
+    CHECK(!umon_pop(&m, &r, false), "empty");
+}
+
+static void test_hold_until_seen(void) {
+    umon_merge_t m;
+    umon_rec_t r;
+    umon_merge_init(&m);
+    umon_seen(&m, UMON_LANE_LINES, 1000);
+
+    umon_push_data(&m, UMON_CH_A, 100, BYTE_NS, (const uint8_t*)"x", 1);
+    CHECK(!umon_pop(&m, &r, false), "B unseen");
+    umon_seen(&m, UMON_CH_B, 90);
+    CHECK(!umon_pop(&m, &r, false), "B may still push at 95");
+    umon_seen(&m, UMON_CH_B, 100);
+    CHECK(umon_pop(&m, &r, false) && r.ts_us == 100, "released once B is seen up to it");
+
+    // seen never goes back
+    umon_seen(&m, UMON_CH_B, 50);
+    CHECK(m.lane[UMON_CH_B].floor_us == 100, "floor kept");
+
+    umon_push_data(&m, UMON_CH_A, 5000, BYTE_NS, (const uint8_t*)"y", 1);
+    CHECK(!umon_pop(&m, &r, false), "B behind");
+    CHECK(umon_pop(&m, &r, true) && r.ts_us == 5000, "flush takes it anyway");
+}
+
+static void test_split_and_clamp(void) {
+    umon_merge_t m;
+    umon_rec_t r;
+    uint8_t data[70];
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)i;
+    }
+    umon_merge_init(&m);
+
+    CHECK(umon_push_data(&m, UMON_CH_A, 1000, BYTE_NS, data, 70) == 70, "all taken");
+    CHECK(m.lane[UMON_CH_A].tail == 3, "three records");
+    CHECK(m.lane[UMON_CH_A].rec[1].ts_us == 1000 + 32 * BYTE_NS / 1000, "second record time");
+    CHECK(m.lane[UMON_CH_A].rec[2].len == 6 && m.lane[UMON_CH_A].rec[2].data[0] == 64, "third record");
+
+    // a poll estimate earlier than the end of the last chunk is clamped
+    uint32_t end = 1000 + (uint32_t)(70ull * BYTE_NS / 1000);
+    umon_push_data(&m, UMON_CH_A, 1500, BYTE_NS, data, 1);
+    CHECK(m.lane[UMON_CH_A].rec[3].ts_us == end, "clamped to the end of the last chunk");
+    CHECK(umon_push_drop(&m, UMON_CH_A, 10, 5), "drop");
+    CHECK(m.lane[UMON_CH_A].rec[4].ts_us == end + BYTE_NS / 1000, "drop clamped");
+
+    uint32_t last = 0;
+    bool ordered = true;
+    int n = 0;
+    while (umon_pop(&m, &r, true)) {
+        ordered &= (n == 0) || !umon_before(r.ts_us, last);
+        last = r.ts_us;
+        n++;
+    }
+    CHECK(n == 5 && ordered, "lane order kept");
+}
+
+static void test_lane_full(void) {
+    umon_merge_t m;
+    umon_rec_t r;
+    static uint8_t data[2000];
+    umon_merge_init(&m);
+
+    CHECK(umon_space(&m, UMON_CH_B) == UMON_LANE_DEPTH * UMON_CHUNK_MAX, "empty lane space");
+    CHECK(umon_push_data(&m, UMON_CH_B, 0, BYTE_NS, data, sizeof(data)) == UMON_LANE_DEPTH * UMON_CHUNK_MAX,
+          "takes what fits");
+    CHECK(umon_space(&m, UMON_CH_B) == 0, "full");
+    CHECK(umon_push_data(&m, UMON_CH_B, 0, BYTE_NS, data, 1) == 0, "nothing more");
+    CHECK(!umon_push_drop(&m, UMON_CH_B, 0, 1), "drop refused");
+    CHECK(umon_pop(&m, &r, true), "pop one");
+    CHECK(umon_space(&m, UMON_CH_B) == UMON_CHUNK_MAX, "one record free");
+
+    for (uint32_t i = 0; i < UMON_LANE_DEPTH; i++) {
+        CHECK(umon_push_line(&m, i, 0), "line fits");
+    }
+    CHECK(!umon_push_line(&m, 99, 0), "line lane full");
+}
+
+static void test_wrap(void) {
+    umon_merge_t m;
+    umon_rec_t r;
+    umon_merge_init(&m);
+
+    umon_push_data(&m, UMON_CH_A, 0x00000010u, BYTE_NS, (const uint8_t*)"a", 1);
+    umon_push_data(&m, UMON_CH_B, 0xffffff00u, BYTE_NS, (const uint8_t*)"b", 1);
+    umon_push_line(&m, 0xfffffff0u, UMON_LINE_RTS);
+    umon_seen(&m, UMON_LANE_LINES, 0x100);
+    umon_seen(&m, UMON_CH_B, 0x100);
+    CHECK(umon_pop(&m, &r, false) && r.chan == UMON_CH_B, "before the wrap");
+    CHECK(umon_pop(&m, &r, false) && r.type == UMON_REC_LINE, "line just before the wrap");
+    CHECK(umon_pop(&m, &r, false) && r.chan == UMON_CH_A, "after the wrap");
+}
+
+// two channels sending chunks at random times, polled at random points
+static void test_random_merge(void) {
+    static umon_merge_t m;
+    umon_rec_t r;
+    uint32_t next[2] = { 0xfff00000u, 0xfff00000u };  // wire time of the next byte, wraps
+    uint32_t sent[2] = { 0, 0 }, got[2] = { 0, 0 };
+    uint32_t lines_sent = 0, lines_got = 0;
+    bool seq_ok = true, order_ok = true, have_last = false;
+    uint32_t last = 0, now = 0xfff00000u;
+    uint8_t lines = 0;
+
+    umon_merge_init(&m);
+    for (int poll = 0; poll < 20000; poll++) {
+        now += 50 + rng() % 400;
+        // each channel: some bytes arrived since the last poll
+        for (int ch = 0; ch < 2; ch++) {
+            if (rng() % 3) {
+                continue;
+            }
+            uint32_t n = 1 + rng() % 40;
+            uint8_t buf[64];
+            for (uint32_t i = 0; i < n; i++) {
+                buf[i] = (uint8_t)(sent[ch] + i);
+            }
+            uint32_t ts = now - (uint32_t)((uint64_t)n * BYTE_NS / 1000);
+            if (umon_before(ts, next[ch])) {
+                ts = next[ch];
+            }
+            if (umon_space(&m, (uint8_t)ch) < n) {
+                continue;
+            }
+            umon_push_data(&m, (uint8_t)ch, ts, BYTE_NS, buf, n);
+            sent[ch] += n;
+            next[ch] = ts + (uint32_t)((uint64_t)n * BYTE_NS / 1000);
+        }
+        if (rng() % 20 == 0 && umon_push_line(&m, now, lines ^= UMON_LINE_CTS)) {
+            lines_sent++;
+        }
+        // polled in random order, a lane is seen only some of the time
+        for (int lane = 0; lane < UMON_LANES; lane++) {
+            if (rng() % 4) {
+                umon_seen(&m, (uint8_t)lane, lane == UMON_LANE_LINES ? now : now - 200);
+            }
+        }
+        while (umon_pop(&m, &r, false)) {
+            if (have_last && umon_before(r.ts_us, last)) {
+                order_ok = false;
+            }
+            last = r.ts_us;
+            have_last = true;
+            if (r.type == UMON_REC_LINE) {
+                lines_got++;
+                continue;
+            }
+            for (uint32_t i = 0; i < r.len; i++) {
+                seq_ok &= (r.data[i] == (uint8_t)(got[r.chan]++));
+            }
+        }
+    }
+    while (umon_pop(&m, &r, true)) {
+        if (r.type == UMON_REC_LINE) {
+            lines_got++;
+        } else {
+            got[r.chan] += r.len;
+        }
+    }
+    CHECK(order_ok, "merged stream is in time order across the wrap");
+    CHECK(seq_ok, "every channel's bytes in sequence");
+    CHECK(got[0] == sent[0] && got[1] == sent[1], "no bytes lost");
+    CHECK(lines_got == lines_sent, "all line events");
+}
+
+static void test_format(void) {
+    umon_fmt_t f;
+    umon_rec_t r;
+    memset(&r, 0, sizeof(r));
+    out_reset();
+    umon_fmt_init(&f, out_write, NULL, 1000, BYTE_NS, 1000);
+
+    r.type = UMON_REC_DATA;
+    r.chan = UMON_CH_A;
+    r.ts_us = 2234;
+    r.len = 7;
+    memcpy(r.data, "Hello\r\n", 7);
+    umon_fmt_rec(&f, &r);
+    CHECK(out_len == 0, "line kept open");
+
+    r.chan = UMON_CH_B;
+    r.ts_us = 2500;
+    r.len = 4;
+    memcpy(r.data, "OK\r\n", 4);
+    umon_fmt_rec(&f, &r);
+    CHECK(strcmp(out_text,
+                 "    0.001234 A 48 65 6C 6C 6F 0D 0A                             Hello..\r\n") == 0,
+          "A line on channel change");
+
+    out_reset();
+    r.type = UMON_REC_LINE;
+    r.ts_us = 3000;
+    r.lines = UMON_LINE_CTS;
+    umon_fmt_rec(&f, &r);
+    CHECK(strcmp(out_text,
+                 "    0.001500 B 4F 4B 0D 0A                                      OK..\r\n"
+                 "    0.002000 - RTS 0 CTS 1\r\n") == 0,
+          "B flushed before the line event");
+
+    out_reset();
+    r.type = UMON_REC_DROP;
+    r.chan = UMON_CH_A;
+    r.ts_us = 3100;
+    r.lost = 12;
+    umon_fmt_rec(&f, &r);
+    CHECK(strcmp(out_text, "    0.002100 A lost 12 bytes\r\n") == 0, "drop");
+
+    // 20 bytes in two records: line full at 16
+    out_reset();
+    r.type = UMON_REC_DATA;
+    r.ts_us = 10000;
+    r.len = 10;
+    memcpy(r.data, "0123456789", 10);
+    umon_fmt_rec(&f, &r);
+    r.ts_us = 10000 + 10 * BYTE_NS / 1000;
+    umon_fmt_rec(&f, &r);
+    umon_fmt_flush(&f);
+    CHECK(strstr(out_text, "A 30 31 32 33 34 35 36 37 38 39 30 31 32 33 34 35  0123456789012345\r\n") != NULL,
+          "full line");
+    CHECK(strstr(out_text, "    0.010388 A 36 37 38 39") != NULL, "continuation stamped with its byte");
+
+    // a quiet gap starts a new line
+    out_reset();
+    r.len = 1;
+    r.ts_us = 20000;
+    umon_fmt_rec(&f, &r);
+    r.ts_us = 20500;
+    umon_fmt_rec(&f, &r);
+    CHECK(out_len == 0, "no gap yet");
+    r.ts_us = 22000;
+    umon_fmt_rec(&f, &r);
+    CHECK(strstr(out_text, "    0.019000 A 30 30 ") != NULL, "gap ends the line");
+    umon_fmt_flush(&f);
+    CHECK(strstr(out_text, "    0.021000 A 30 ") != NULL, "new line after the gap");
+    size_t len = out_len;
+    umon_fmt_flush(&f);
+    CHECK(out_len == len, "flush with nothing open writes nothing");
+
+    // colours around the channel lines, not the events
+    out_reset();
+    f.chan_color[UMON_CH_A] = "\x1b[32m";
+    f.chan_color[UMON_CH_B] = "\x1b[33m";
+    f.reset = "\x1b[0m";
+    r.chan = UMON_CH_B;
+    r.ts_us = 30000;
+    umon_fmt_rec(&f, &r);
+    umon_fmt_flush(&f);
+    CHECK(strncmp(out_text, "\x1b[33m    0.029000 B 30", 22) == 0, "channel colour");
+    CHECK(out_len > 6 && strcmp(&out_text[out_len - 6], "\x1b[0m\r\n") == 0, "reset at the end");
+}
+
+static void test_log(void) {
+    uint8_t hdr[UMON_LOG_HEADER_LEN];
+    uint8_t buf[UMON_REC_PACKED_MAX];
+    uint32_t baud, t0;
+    umon_rec_t a, b;
+
+    umon_log_header(hdr, 115200, 0xdeadbeef);
+    CHECK(memcmp(hdr, "BPUM\x01", 5) == 0, "magic and version");
+    CHECK(umon_log_header_parse(hdr, &baud, &t0) && baud == 115200 && t0 == 0xdeadbeef, "header round trip");
+    hdr[4] = 2;
+    CHECK(!umon_log_header_parse(hdr, &baud, &t0), "newer version refused");
+
+    memset(&a, 0, sizeof(a));
+    a.ts_us = 0x12345678;
+    a.type = UMON_REC_DATA;
+    a.chan = UMON_CH_B;
+    a.len = UMON_CHUNK_MAX;
+    for (int i = 0; i < UMON_CHUNK_MAX; i++) {
+        a.data[i] = (uint8_t)(i * 7);
+    }
+    size_t n = umon_rec_pack(&a, buf);
+    CHECK(n == UMON_REC_HEADER_LEN + UMON_CHUNK_MAX, "data record size");
+    CHECK(buf[0] == 0x78 && buf[3] == 0x12, "little endian time");
+    CHECK(umon_rec_unpack(&b, buf, n) == n && b.ts_us == a.ts_us && b.chan == 1 && memcmp(b.data, a.data, a.len) == 0,
+          "data round trip");
+    CHECK(umon_rec_unpack(&b, buf, n - 1) == 0, "short data refused");
+
+    memset(&a, 0, sizeof(a));
+    a.type = UMON_REC_DROP;
+    a.lost = 70000;
+    n = umon_rec_pack(&a, buf);
+    CHECK(n == UMON_REC_HEADER_LEN + 4 && umon_rec_unpack(&b, buf, n) == n && b.lost == 70000, "drop round trip");
+
+    a.type = UMON_REC_LINE;
+    a.lines = UMON_LINE_RTS | UMON_LINE_CTS;
+    n = umon_rec_pack(&a, buf);
+    CHECK(n == UMON_REC_HEADER_LEN && umon_rec_unpack(&b, buf, n) == n && b.lines == 3, "line round trip");
+
+    buf[4] = 7;
+    CHECK(umon_rec_unpack(&b, buf, n) == 0, "bad type refused");
+    buf[4] = UMON_REC_LINE;
+    buf[7] = 1;
+    CHECK(umon_rec_unpack(&b, buf, n + 1) == 0, "line with data refused");
+}
+
+static void bench(void) {
+    static umon_merge_t m;
+    umon_fmt_t f;
+    umon_rec_t r;
+    uint8_t chunk[256], packed[UMON_REC_PACKED_MAX];
+    const uint32_t polls = 200000;
+    uint32_t now = 0;
+    size_t log_bytes = 0;
+    for (uint32_t i = 0; i < sizeof(chunk); i++) {
+        chunk[i] = (uint8_t)rng();
+    }
+
+    for (int mode = 0; mode < 2; mode++) {
+        umon_merge_init(&m);
+        umon_fmt_init(&f, null_write, NULL, 0, 1000, 100);
+        null_bytes = 0;
+        uint64_t bytes = 0;
+        double t0 = now_s();
+        for (uint32_t p = 0; p < polls; p++) {
+            now += 256;
+            for (uint8_t ch = 0; ch < 2; ch++) {
+                uint32_t n = umon_push_data(&m, ch, now - 256, 1000, chunk, 128);
+                bytes += n;
+                umon_seen(&m, ch, now);
+            }
+            umon_seen(&m, UMON_LANE_LINES, now);
+            while (umon_pop(&m, &r, false)) {
+                if (mode) {
+                    log_bytes += umon_rec_pack(&r, packed);
+                } else {
+                    umon_fmt_rec(&f, &r);
+                }
+            }
+        }
+        double t = now_s() - t0;
+        if (mode) {
+            printf("merge + log records: %.1f MB/s, %.2f log bytes per byte\n", bytes / t / 1e6, (double)log_bytes / bytes);
+        } else {
+            printf("merge + hex view:    %.1f MB/s, %.2f text bytes per byte\n", bytes / t / 1e6, (double)null_bytes / bytes);
+        }
+    }
+}
+
+int main(void) {
+    printf("=== uart_mon tests ===\n\n");
+
+    test_merge_order();
+    test_hold_until_seen();
+    test_split_and_clamp();
+    test_lane_full();
+    test_wrap();
+    test_random_merge();
+    test_format();
+    test_log();
+
+    printf("\n");
+    bench();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return tests_pass == tests_run ? 0 : 1;
+}
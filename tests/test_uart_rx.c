@@ -0,0 +1,342 @@
+/*
+ * test_uart_rx.c — Host-side tests for the UART mode receive ring and view
+ *
+ * A fake DMA writes entries (data plus the UART error bits) into a ring
+ * in bursts, the reader polls at random intervals and must get every
+ * byte in order with its flags, or a lost count that adds up when it was
+ * lapped. The view is checked for line breaks on full lines and quiet
+ * gaps, the time column, error marks, lost lines and number formats.
+ *
+ * The benchmark renders a stream through the view and reports the
+ * highest baud rate (8N1) the CPU side keeps up with.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -o test_uart_rx test_uart_rx.c ../src/lib/uart_rx/uart_rx.c ../src/lib/line_fmt/line_fmt.c && ./test_uart_rx
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lib/uart_rx/uart_rx.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+#define RING_LEN 256
+
+static uint16_t ring[RING_LEN];
+static uint32_t dma_written;
+
+// the DMA side: entries land in the ring, wrapping
+static void dma_put(uint16_t entry) {
+    ring[dma_written & (RING_LEN - 1)] = entry;
+    dma_written++;
+}
+
+static char out_text[1 << 16];
+static size_t out_len;
+static uint32_t out_flushes;
+
+static void out_write(const char* buf, uint32_t len) {
+    if (out_len + len < sizeof(out_text)) {
+        memcpy(&out_text[out_len], buf, len);
+        out_len += len;
+        out_text[out_len] = 0;
+    }
+    out_flushes++;
+}
+
+static void out_reset(void) {
+    out_len = 0;
+    out_text[0] = 0;
+    out_flushes = 0;
+}
+
+static uint32_t null_bytes;
+
+static void null_write(const char* buf, uint32_t len) {
+    (void)buf;
+    null_bytes += len;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static line_fmt_t line;
+static line_fmt_colors_t no_colors;
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_ring_basic(void) {
+    urx_ring_t r;
+    uint16_t e;
+
+    dma_written = 0;
+    urx_init(&r, ring, RING_LEN);
+    CHECK(!urx_get(&r, &e), "empty");
+    dma_put(0x41);
+    dma_put(0x42 | (URX_ERR_FE << 8));
+    dma_put(0x00 | ((URX_ERR_FE | URX_ERR_BE) << 8));
+    dma_put(0x43 | (URX_ERR_OE << 8));
+    CHECK(urx_advance(&r, dma_written) == 0, "nothing lost");
+    CHECK(urx_avail(&r) == 4, "four waiting");
+    CHECK(urx_get(&r, &e) && e == 0x41, "first");
+    CHECK(urx_get(&r, &e) && URX_ENTRY_DATA(e) == 0x42 && URX_ENTRY_ERR(e) == URX_ERR_FE, "framing error kept");
+    CHECK(urx_get(&r, &e) && URX_ENTRY_ERR(e) == (URX_ERR_FE | URX_ERR_BE), "break kept");
+    CHECK(urx_get(&r, &e) && URX_ENTRY_ERR(e) == URX_ERR_OE, "overrun kept");
+    CHECK(!urx_get(&r, &e), "drained");
+    CHECK(r.errors[0] == 2 && r.errors[1] == 0 && r.errors[2] == 1 && r.errors[3] == 1, "error counts");
+    CHECK(r.peak == 4, "peak");
+
+    dma_put(1);
+    dma_put(2);
+    urx_advance(&r, dma_written);
+    urx_flush(&r);
+    CHECK(urx_avail(&r) == 0 && !urx_get(&r, &e), "flushed");
+}
+
+static void test_ring_lapped(void) {
+    urx_ring_t r;
+    uint16_t e;
+
+    dma_written = 0;
+    urx_init(&r, ring, RING_LEN);
+    for (uint32_t i = 0; i < RING_LEN - URX_MARGIN; i++) {
+        dma_put((uint16_t)(i & 0xff));
+    }
+    CHECK(urx_advance(&r, dma_written) == 0, "full up to the margin is fine");
+    dma_put(0x55);
+    uint32_t lost = urx_advance(&r, dma_written);
+    CHECK(lost == RING_LEN - URX_MARGIN + 1 - RING_LEN / 2, "lapped drops down to half");
+    CHECK(urx_avail(&r) == RING_LEN / 2, "half left");
+    CHECK(urx_get(&r, &e) && e == (lost & 0xff), "oldest kept entry");
+    CHECK(r.lost == lost, "lost counted");
+
+    // the DMA went round more than once
+    urx_flush(&r);
+    for (uint32_t i = 0; i < 3 * RING_LEN + 7; i++) {
+        dma_put((uint16_t)(i & 0xff));
+    }
+    lost = urx_advance(&r, dma_written);
+    CHECK(urx_avail(&r) == RING_LEN / 2, "half left after laps");
+    CHECK(urx_get(&r, &e) && e == ((3 * RING_LEN + 7 - RING_LEN / 2) & 0xff), "newest half kept");
+}
+
+// random bursts and polls: every byte comes out once, in order, or is counted lost
+static void test_ring_random(void) {
+    urx_ring_t r;
+    uint16_t e;
+    uint32_t next = 0, sent = 0, got = 0, lost = 0;
+    bool order = true;
+
+    dma_written = 0;
+    urx_init(&r, ring, RING_LEN);
+    for (uint32_t round = 0; round < 20000; round++) {
+        uint32_t burst = rng() % (round % 100 == 0 ? 600 : 40);
+        for (uint32_t i = 0; i < burst; i++) {
+            dma_put((uint16_t)((sent & 0xff) | ((sent % 97 == 0) ? (URX_ERR_PE << 8) : 0)));
+            sent++;
+        }
+        uint32_t l = urx_advance(&r, dma_written);
+        lost += l;
+        next += l;
+        uint32_t take = rng() % 64;
+        while (take-- && urx_get(&r, &e)) {
+            if (URX_ENTRY_DATA(e) != (next & 0xff) || (URX_ENTRY_ERR(e) != 0) != (next % 97 == 0)) {
+                order = false;
+            }
+            next++;
+            got++;
+        }
+    }
+    while (urx_get(&r, &e)) {
+        got++;
+    }
+    CHECK(order, "bytes in order with their flags");
+    CHECK(got + lost == sent, "every byte taken or counted lost");
+    CHECK(lost == r.lost && lost > 0, "laps happened and were counted");
+    CHECK(r.peak <= RING_LEN - URX_MARGIN + 600, "peak measured");
+}
+
+static void test_view(void) {
+    urx_fmt_t f;
+
+    line_fmt_init(&line, out_write);
+    urx_fmt_init(&f, &line, &no_colors, LINE_FMT_HEX, 8, 1000000, 500, true);
+
+    out_reset();
+    urx_fmt_entry(&f, 0x48, 1001234);
+    urx_fmt_entry(&f, 0x69 | (URX_ERR_FE << 8), 1001300);
+    CHECK(out_len == 0, "line stays open");
+    urx_fmt_idle(&f, 1001700);
+    CHECK(out_len == 0, "not quiet long enough");
+    urx_fmt_idle(&f, 1001801);
+    CHECK(strcmp(out_text, "    0.001234 0x48 0x69!FE\r\n") == 0, "idle ends the line");
+    CHECK(out_flushes == 1, "one write per line");
+
+    // a gap between bytes ends the line too
+    out_reset();
+    urx_fmt_entry(&f, 0x00 | ((URX_ERR_FE | URX_ERR_BE) << 8), 2000000);
+    urx_fmt_entry(&f, 0x31, 2000600);
+    urx_fmt_end(&f);
+    CHECK(strcmp(out_text,
+                 "    1.000000 0x00!FE!BE\r\n"
+                 "    1.000600 0x31\r\n") == 0,
+          "gap starts a new line");
+
+    // full lines
+    out_reset();
+    for (uint32_t i = 0; i < 20; i++) {
+        urx_fmt_entry(&f, (uint16_t)i, 3000000 + i * 10);
+    }
+    urx_fmt_end(&f);
+    CHECK(strcmp(out_text,
+                 "    2.000000 0x00 0x01 0x02 0x03 0x04 0x05 0x06 0x07 0x08 0x09 0x0A 0x0B 0x0C 0x0D 0x0E 0x0F\r\n"
+                 "    2.000160 0x10 0x11 0x12 0x13\r\n") == 0,
+          "16 per line");
+    CHECK(out_flushes == 2, "two writes");
+
+    out_reset();
+    urx_fmt_entry(&f, 0x7e, 4000000);
+    urx_fmt_lost(&f, 12, 4000100);
+    CHECK(strcmp(out_text,
+                 "    3.000000 0x7E\r\n"
+                 "    3.000100 lost 12 bytes\r\n") == 0,
+          "lost on its own line");
+
+    // no time column, ASCII, decimal and other widths
+    urx_fmt_init(&f, &line, &no_colors, LINE_FMT_ASCII, 8, 0, 500, false);
+    out_reset();
+    urx_fmt_entry(&f, 'A', 0);
+    urx_fmt_entry(&f, 0x0d | (URX_ERR_OE << 8), 1);
+    urx_fmt_end(&f);
+    CHECK(strcmp(out_text, "'A' 0x41 ''  0x0D!OE\r\n") == 0, "ascii");
+
+    urx_fmt_init(&f, &line, &no_colors, LINE_FMT_DEC, 8, 0, 500, false);
+    out_reset();
+    urx_fmt_entry(&f, 200, 0);
+    urx_fmt_lost(&f, 3, 1);
+    CHECK(strcmp(out_text, "200\r\nlost 3 bytes\r\n") == 0, "decimal, lost without time");
+
+    urx_fmt_init(&f, &line, &no_colors, LINE_FMT_BIN, 7, 0, 500, false);
+    out_reset();
+    urx_fmt_entry(&f, 0x55, 0);
+    urx_fmt_end(&f);
+    CHECK(strcmp(out_text, "0b1010101.7\r\n") == 0, "7 bits");
+
+    out_reset();
+    urx_fmt_end(&f);
+    urx_fmt_idle(&f, 1000000);
+    CHECK(out_len == 0, "nothing open, nothing written");
+}
+
+static void test_drain(void) {
+    urx_ring_t r;
+    urx_fmt_t f;
+
+    dma_written = 0;
+    urx_init(&r, ring, RING_LEN);
+    line_fmt_init(&line, out_write);
+    urx_fmt_init(&f, &line, &no_colors, LINE_FMT_HEX, 8, 0, 1000, true);
+
+    // 3 bytes 100us each, the last one ended at 10000
+    out_reset();
+    dma_put('a');
+    dma_put('b');
+    dma_put('c');
+    urx_advance(&r, dma_written);
+    CHECK(urx_fmt_drain(&f, &r, 10000, 100000) == 3, "three rendered");
+    CHECK(out_len == 0, "line open until quiet");
+    CHECK(urx_fmt_drain(&f, &r, 10500, 100000) == 0, "nothing new");
+    CHECK(out_len == 0, "still within the gap");
+    urx_fmt_drain(&f, &r, 11001, 100000);
+    CHECK(strcmp(out_text, "    0.009800 0x61 0x62 0x63\r\n") == 0, "stamped back to back");
+
+    // across the 32 bit wrap
+    urx_fmt_init(&f, &line, &no_colors, LINE_FMT_HEX, 8, 0xffffff00u, 1000, true);
+    out_reset();
+    dma_put(0x01);
+    dma_put(0x02);
+    urx_advance(&r, dma_written);
+    urx_fmt_drain(&f, &r, 0x50, 100000);
+    urx_fmt_end(&f);
+    CHECK(strcmp(out_text, "    0.000236 0x01 0x02\r\n") == 0, "wrap");
+}
+
+/* ── Benchmark ──────────────────────────────────────────────────── */
+
+static void bench(void) {
+    urx_ring_t r;
+    urx_fmt_t f;
+    line_fmt_colors_t colors;
+    const uint32_t polls = 200000, per_poll = 64;
+
+    line_fmt_colors(&colors, "\x1b[0m", "\x1b[38;2;128;128;128m", "\x1b[38;2;83;166;230m", "\x1b[38;2;191;165;48m");
+    for (int mode = 0; mode < 2; mode++) {
+        dma_written = 0;
+        null_bytes = 0;
+        urx_init(&r, ring, RING_LEN);
+        line_fmt_init(&line, null_write);
+        urx_fmt_init(&f, &line, mode ? &colors : &no_colors, LINE_FMT_HEX, 8, 0, 1000, mode != 0);
+        uint32_t now = 0;
+        double t0 = now_s();
+        for (uint32_t p = 0; p < polls; p++) {
+            for (uint32_t i = 0; i < per_poll; i++) {
+                dma_put((uint16_t)(rng() & 0xff));
+            }
+            now += 640;
+            urx_advance(&r, dma_written);
+            urx_fmt_drain(&f, &r, now, 10000);
+        }
+        double t = now_s() - t0;
+        double bytes = (double)polls * per_poll;
+        printf("ring + view%s: %.1f MB/s, %.0f baud (8N1), %.1f terminal bytes per byte\n",
+               mode ? " (colour, time)" : "",
+               bytes / t / 1e6,
+               bytes * 10 / t,
+               null_bytes / bytes);
+        CHECK(r.lost == 0, "benchmark kept up");
+    }
+}
+
+int main(void) {
+    printf("=== uart_rx tests ===\n\n");
+
+    line_fmt_colors(&no_colors, "", "", "", "");
+    test_ring_basic();
+    test_ring_lapped();
+    test_ring_random();
+    test_view();
+    test_drain();
+
+    printf("\n");
+    bench();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return tests_pass == tests_run ? 0 : 1;
+}
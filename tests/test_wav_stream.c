@@ -0,0 +1,585 @@
+/*
+ * test_wav_stream.c — Host-side tests for the I2S WAV player and recorder
+ *
+ * Checks the RIFF chunk walk against canonical files, LIST and odd sized
+ * chunks, WAVE_FORMAT_EXTENSIBLE headers, unfinished recordings and the
+ * usual broken files. Checks the 8/16/24-bit mono/stereo/multichannel
+ * converters against hand made samples, that feeding a file in reads of
+ * any size gives the same words as converting it in one go, the recorder
+ * header and i2s_in word conversion.
+ *
+ * Then builds a FAT image in RAM with the firmware's FatFs and plays a
+ * file through the same aligned read + convert loop as the wav command,
+ * comparing the throughput with small unaligned reads.
+ *
+ * Build and run:
+ *   gcc -O2 -I../src -I../src/fatfs -Istubs -o test_wav_stream test_wav_stream.c ../src/lib/wav_stream/wav_stream.c ../src/fatfs/ff.c && ./test_wav_stream
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lib/wav_stream/wav_stream.h"
+#include "ff.h"
+#include "diskio.h"
+
+static int tests_run = 0;
+static int tests_pass = 0;
+
+#define CHECK(expr, msg)                                             \
+    do {                                                             \
+        tests_run++;                                                 \
+        if (!(expr)) {                                               \
+            printf("FAIL: %s  (%s:%d)\n", msg, __FILE__, __LINE__); \
+        } else {                                                     \
+            tests_pass++;                                            \
+        }                                                            \
+    } while (0)
+
+/* ── Helpers ────────────────────────────────────────────────────── */
+
+typedef struct {
+    const uint8_t* data;
+    uint32_t len;
+} mem_file_t;
+
+static size_t mem_read_at(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+    mem_file_t* f = ctx;
+    if (offset >= f->len) {
+        return 0;
+    }
+    if (len > f->len - offset) {
+        len = f->len - offset;
+    }
+    memcpy(buf, &f->data[offset], len);
+    return len;
+}
+
+static wav_status_t parse(wav_info_t* info, const uint8_t* data, uint32_t len) {
+    mem_file_t f = { data, len };
+    return wav_parse(info, mem_read_at, &f, len);
+}
+
+static uint8_t file[4096];
+static uint32_t file_len;
+
+static void put(const void* p, uint32_t len) {
+    memcpy(&file[file_len], p, len);
+    file_len += len;
+}
+
+static void put16(uint16_t v) {
+    uint8_t b[2] = { (uint8_t)v, (uint8_t)(v >> 8) };
+    put(b, 2);
+}
+
+static void put32(uint32_t v) {
+    put16((uint16_t)v);
+    put16((uint16_t)(v >> 16));
+}
+
+static void chunk(const char* id, uint32_t size) {
+    put(id, 4);
+    put32(size);
+}
+
+static void riff(void) {
+    file_len = 0;
+    chunk("RIFF", 0); // size is not checked
+    put("WAVE", 4);
+}
+
+static void fmt_pcm(uint16_t tag, uint16_t channels, uint32_t rate, uint16_t bits) {
+    chunk("fmt ", 16);
+    put16(tag);
+    put16(channels);
+    put32(rate);
+    put32(rate * channels * bits / 8);
+    put16(channels * bits / 8);
+    put16(bits);
+}
+
+static void fmt_extensible(uint16_t channels, uint32_t rate, uint16_t bits, uint16_t subformat) {
+    static const uint8_t tail[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80,
+                                      0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 };
+    chunk("fmt ", 40);
+    put16(0xfffe);
+    put16(channels);
+    put32(rate);
+    put32(rate * channels * bits / 8);
+    put16(channels * bits / 8);
+    put16(bits);
+    put16(22);   // cbSize
+    put16(bits); // valid bits
+    put32(3);    // channel mask
+    put16(subformat);
+    put(tail, sizeof(tail));
+}
+
+static uint32_t rng_state = 12345;
+static uint32_t rng(void) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 8;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ── RAM disk for FatFs ─────────────────────────────────────────── */
+
+#define RAM_SECTOR 512
+#define RAM_SECTORS (16 * 1024 * 1024 / RAM_SECTOR)
+
+static uint8_t* ram_disk;
+static uint32_t ram_reads, ram_read_sectors;
+
+DSTATUS disk_initialize(BYTE pdrv) {
+    (void)pdrv;
+    return 0;
+}
+
+DSTATUS disk_status(BYTE pdrv) {
+    (void)pdrv;
+    return 0;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE* buff, LBA_t sector, UINT count) {
+    (void)pdrv;
+    ram_reads++;
+    ram_read_sectors += count;
+    memcpy(buff, &ram_disk[(size_t)sector * RAM_SECTOR], (size_t)count * RAM_SECTOR);
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count) {
+    (void)pdrv;
+    memcpy(&ram_disk[(size_t)sector * RAM_SECTOR], buff, (size_t)count * RAM_SECTOR);
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff) {
+    (void)pdrv;
+    switch (cmd) {
+        case GET_SECTOR_COUNT:
+            *(LBA_t*)buff = RAM_SECTORS;
+            return RES_OK;
+        case GET_SECTOR_SIZE:
+            *(WORD*)buff = RAM_SECTOR;
+            return RES_OK;
+        case GET_BLOCK_SIZE:
+            *(DWORD*)buff = 1;
+            return RES_OK;
+        case CTRL_SYNC:
+            return RES_OK;
+        default:
+            return RES_PARERR;
+    }
+}
+
+int ff_cre_syncobj(BYTE vol, FF_SYNC_t* sobj) {
+    static mutex_t mutex;
+    (void)vol;
+    *sobj = &mutex;
+    return 1;
+}
+
+int ff_req_grant(FF_SYNC_t sobj) {
+    sobj->locked = 1;
+    return 1;
+}
+
+void ff_rel_grant(FF_SYNC_t sobj) {
+    sobj->locked = 0;
+}
+
+int ff_del_syncobj(FF_SYNC_t sobj) {
+    (void)sobj;
+    return 1;
+}
+
+// ff.c tells the USB mass storage side about changes
+void refresh_usbmsdrive(void) {
+}
+
+static size_t fat_read_at(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+    FIL* fp = ctx;
+    UINT got;
+    if (f_lseek(fp, offset) != FR_OK || f_read(fp, buf, (UINT)len, &got) != FR_OK) {
+        return 0;
+    }
+    return got;
+}
+
+/* ── Tests ──────────────────────────────────────────────────────── */
+
+static void test_parse(void) {
+    wav_info_t info;
+
+    riff();
+    fmt_pcm(1, 2, 44100, 16);
+    chunk("data", 8);
+    put("\x01\x00\x02\x00\x03\x00\x04\x00", 8);
+    CHECK(parse(&info, file, file_len) == WAV_OK, "canonical file parses");
+    CHECK(info.channels == 2 && info.rate == 44100 && info.bits == 16 && info.block_align == 4,
+          "canonical format");
+    CHECK(info.data_offset == WAV_HEADER_LEN && info.data_size == 8 && info.frames == 2, "canonical data chunk");
+
+    // LIST before fmt, an odd sized chunk and its pad byte before data
+    riff();
+    chunk("LIST", 10);
+    put("INFOISFT\x02\x00", 10);
+    fmt_pcm(1, 1, 8000, 8);
+    chunk("junk", 3);
+    put("abc\x00", 4);
+    chunk("data", 5);
+    put("\x80\x81\x82\x83\x84", 5);
+    CHECK(parse(&info, file, file_len) == WAV_OK, "LIST and odd chunks are skipped");
+    CHECK(info.channels == 1 && info.rate == 8000 && info.bits == 8, "format after LIST");
+    CHECK(info.data_offset == file_len - 5 && info.frames == 5, "data found past the pad byte");
+
+    riff();
+    fmt_extensible(2, 48000, 24, 1);
+    chunk("data", 12);
+    put("\x00\x00\x10\x00\x00\x20\x00\x00\x30\x00\x00\x40", 12);
+    CHECK(parse(&info, file, file_len) == WAV_OK, "extensible PCM parses");
+    CHECK(info.bits == 24 && info.block_align == 6 && info.frames == 2, "extensible 24-bit format");
+
+    riff();
+    fmt_extensible(2, 48000, 16, 3); // IEEE float subformat
+    chunk("data", 0);
+    CHECK(parse(&info, file, file_len) == WAV_UNSUPPORTED, "extensible float is unsupported");
+
+    // an unfinished recording, the data size was never written
+    riff();
+    fmt_pcm(1, 2, 44100, 16);
+    chunk("data", 0xffffffff);
+    put("\x01\x00\x02\x00\x03\x00\x04\x00\x05\x00", 10);
+    CHECK(parse(&info, file, file_len) == WAV_OK, "unfinished data size parses");
+    CHECK(info.data_size == 8 && info.frames == 2, "data clamped to the file, whole frames");
+
+    riff();
+    fmt_pcm(1, 2, 44100, 16);
+    chunk("data", 0);
+    put("\x01\x00\x02\x00", 4);
+    CHECK(parse(&info, file, file_len) == WAV_OK && info.frames == 1, "zero data size takes the rest");
+}
+
+static void test_parse_errors(void) {
+    wav_info_t info;
+
+    CHECK(parse(&info, (const uint8_t*)"RIFX", 4) == WAV_NOT_RIFF, "short file");
+    riff();
+    memcpy(file, "RIFX", 4);
+    CHECK(parse(&info, file, file_len) == WAV_NOT_RIFF, "big endian RIFX");
+    riff();
+    memcpy(&file[8], "AVI ", 4);
+    CHECK(parse(&info, file, file_len) == WAV_NOT_WAVE, "not WAVE");
+
+    riff();
+    CHECK(parse(&info, file, file_len) == WAV_NO_FMT, "no chunks");
+    riff();
+    chunk("data", 0);
+    CHECK(parse(&info, file, file_len) == WAV_NO_FMT, "data before fmt");
+    riff();
+    fmt_pcm(1, 2, 44100, 16);
+    CHECK(parse(&info, file, file_len) == WAV_NO_DATA, "no data chunk");
+    riff();
+    fmt_pcm(1, 2, 44100, 16);
+    put("da", 2);
+    CHECK(parse(&info, file, file_len) == WAV_TRUNCATED, "chunk header cut off");
+    riff();
+    chunk("fmt ", 16);
+    put16(1);
+    CHECK(parse(&info, file, file_len) == WAV_TRUNCATED, "fmt chunk cut off");
+    riff();
+    chunk("LIST", 0xfffffff0);
+    CHECK(parse(&info, file, file_len) != WAV_OK, "wrapping chunk size");
+
+    riff();
+    fmt_pcm(3, 2, 44100, 32);
+    chunk("data", 0);
+    CHECK(parse(&info, file, file_len) == WAV_UNSUPPORTED, "float format tag");
+    riff();
+    fmt_pcm(1, 2, 44100, 32);
+    chunk("data", 0);
+    CHECK(parse(&info, file, file_len) == WAV_UNSUPPORTED, "32-bit PCM");
+    riff();
+    fmt_pcm(1, 0, 44100, 16);
+    chunk("data", 0);
+    CHECK(parse(&info, file, file_len) == WAV_UNSUPPORTED, "no channels");
+    riff();
+    fmt_pcm(1, 2, 44100, 16);
+    file[12 + 8 + 12] = 3; // block align
+    chunk("data", 0);
+    CHECK(parse(&info, file, file_len) == WAV_UNSUPPORTED, "bad block align");
+
+    CHECK(strcmp(wav_status_str(WAV_OK), "OK") == 0, "status string");
+    CHECK(strlen(wav_status_str(WAV_TRUNCATED)) > 0, "error string");
+}
+
+static void test_convert(void) {
+    uint32_t out[8];
+    wav_info_t info = { 0 };
+
+    info.channels = 1;
+    info.bits = 8;
+    info.block_align = 1;
+    const uint8_t u8[3] = { 0x80, 0xff, 0x00 };
+    CHECK(wav_convert(&info, u8, 3, out) == 3, "8-bit frame count");
+    CHECK(out[0] == 0x00000000 && out[1] == 0x7f007f00 && out[2] == 0x80008000, "8-bit unsigned to signed, both sides");
+
+    info.bits = 16;
+    info.block_align = 2;
+    const uint8_t s16m[4] = { 0x34, 0x12, 0xff, 0xff };
+    wav_convert(&info, s16m, 2, out);
+    CHECK(out[0] == 0x12341234 && out[1] == 0xffffffff, "16-bit mono duplicated");
+
+    info.channels = 2;
+    info.block_align = 4;
+    const uint8_t s16s[8] = { 0x34, 0x12, 0x78, 0x56, 0x00, 0x80, 0xff, 0x7f };
+    wav_convert(&info, s16s, 2, out);
+    CHECK(out[0] == 0x12345678 && out[1] == 0x80007fff, "16-bit stereo left high");
+
+    info.bits = 24;
+    info.block_align = 6;
+    const uint8_t s24s[6] = { 0xaa, 0x34, 0x12, 0xbb, 0x78, 0x56 };
+    wav_convert(&info, s24s, 1, out);
+    CHECK(out[0] == 0x12345678, "24-bit stereo keeps the top 16 bits");
+
+    info.channels = 1;
+    info.block_align = 3;
+    wav_convert(&info, s24s, 2, out);
+    CHECK(out[0] == 0x12341234 && out[1] == 0x56785678, "24-bit mono");
+
+    info.channels = 4;
+    info.bits = 16;
+    info.block_align = 8;
+    const uint8_t s16q[16] = { 1, 0, 2, 0, 3, 0, 4, 0, 5, 0, 6, 0, 7, 0, 8, 0 };
+    wav_convert(&info, s16q, 2, out);
+    CHECK(out[0] == 0x00010002 && out[1] == 0x00050006, "4 channels use the first two");
+
+    info.channels = 3;
+    info.bits = 8;
+    info.block_align = 3;
+    const uint8_t u8t[3] = { 0x81, 0x82, 0x83 };
+    wav_convert(&info, u8t, 1, out);
+    CHECK(out[0] == 0x01000200, "3 channel 8-bit");
+}
+
+static void test_stream(void) {
+    static const struct {
+        uint16_t channels, bits;
+    } formats[] = { { 1, 8 }, { 2, 8 }, { 1, 16 }, { 2, 16 }, { 1, 24 }, { 2, 24 }, { 6, 24 }, { 3, 16 } };
+    static uint8_t data[3000];
+    static uint32_t ref[3000], got[3000 + 1];
+
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)rng();
+    }
+
+    for (uint32_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+        wav_info_t info = { 0 };
+        info.channels = formats[f].channels;
+        info.bits = formats[f].bits;
+        info.block_align = info.channels * info.bits / 8;
+        uint32_t frames = sizeof(data) / info.block_align;
+        wav_convert(&info, data, frames, ref);
+
+        bool same = true;
+        for (int round = 0; round < 20 && same; round++) {
+            wav_stream_t s;
+            wav_stream_init(&s, &info);
+            uint32_t n = 0;
+            size_t pos = 0;
+            while (pos < sizeof(data)) {
+                size_t len = (round == 0) ? 1 : 1 + rng() % 97;
+                if (len > sizeof(data) - pos) {
+                    len = sizeof(data) - pos;
+                }
+                n += wav_stream_feed(&s, &data[pos], len, &got[n]);
+                pos += len;
+            }
+            same = (n == frames) && memcmp(ref, got, frames * 4) == 0 &&
+                   s.carry_len == sizeof(data) - frames * info.block_align;
+        }
+        char msg[64];
+        snprintf(msg, sizeof(msg), "split feed matches, %u ch %u-bit", info.channels, info.bits);
+        CHECK(same, msg);
+    }
+}
+
+static void test_record(void) {
+    uint8_t hdr[WAV_HEADER_LEN + 6];
+    wav_info_t info;
+
+    CHECK(wav_header_build(hdr, 1, 16000, 16, 6) == WAV_HEADER_LEN, "header length");
+    memset(&hdr[WAV_HEADER_LEN], 0, 6);
+    CHECK(parse(&info, hdr, sizeof(hdr)) == WAV_OK, "recorded header parses");
+    CHECK(info.channels == 1 && info.rate == 16000 && info.bits == 16 && info.frames == 3, "recorded header format");
+    CHECK(hdr[4] == 42 && hdr[28] == 0x00 && hdr[29] == 0x7d, "RIFF size and byte rate");
+
+    wav_header_build(hdr, 1, 48000, 24, 0);
+    CHECK(parse(&info, hdr, WAV_HEADER_LEN) == WAV_OK && info.bits == 24 && info.frames == 0, "empty 24-bit recording");
+
+    // the sample MSB arrives at bit 30, one bit clock after the word select edge
+    uint32_t words[3] = { 0x1234u << 15, 0x8000u << 15, 0x123456u << 7 };
+    uint8_t pcm[9];
+    CHECK(wav_from_i2s_in(words, 2, 16, pcm) == 4, "16-bit byte count");
+    CHECK(pcm[0] == 0x34 && pcm[1] == 0x12 && pcm[2] == 0x00 && pcm[3] == 0x80, "16-bit samples");
+    CHECK(wav_from_i2s_in(&words[2], 1, 24, pcm) == 3, "24-bit byte count");
+    CHECK(pcm[0] == 0x56 && pcm[1] == 0x34 && pcm[2] == 0x12, "24-bit sample");
+}
+
+static void test_read_len(void) {
+    CHECK(wav_read_len(44, 8192, 100000) == 8192 - 44, "first read ends on a chunk boundary");
+    CHECK(wav_read_len(8192, 8192, 100000) == 8192, "aligned reads are whole chunks");
+    CHECK(wav_read_len(8192, 8192, 100) == 100, "last read is the rest");
+}
+
+// write a WAV to the RAM disk, data_offset not sector aligned
+static bool fat_make_wav(const char* name, uint32_t frames) {
+    FIL fp;
+    UINT bw;
+    uint8_t hdr[WAV_HEADER_LEN];
+    static uint8_t block[4096];
+
+    if (f_open(&fp, name, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+        return false;
+    }
+    wav_header_build(hdr, 2, 44100, 16, frames * 4);
+    // move data to offset 70 with a LIST chunk between fmt and data
+    uint8_t list[26] = { 'L', 'I', 'S', 'T', 18, 0, 0, 0, 'I', 'N', 'F', 'O', 'I', 'S', 'F', 'T', 6, 0, 0, 0, 'b', 'p', '5', 0, 0, 0 };
+    bool ok = f_write(&fp, hdr, 36, &bw) == FR_OK && f_write(&fp, list, sizeof(list), &bw) == FR_OK &&
+              f_write(&fp, &hdr[36], 8, &bw) == FR_OK;
+    rng_state = 777;
+    for (uint32_t left = frames * 4; ok && left;) {
+        uint32_t len = left < sizeof(block) ? left : sizeof(block);
+        for (uint32_t i = 0; i < len; i++) {
+            block[i] = (uint8_t)rng();
+        }
+        ok = f_write(&fp, block, len, &bw) == FR_OK && bw == len;
+        left -= len;
+    }
+    return f_close(&fp) == FR_OK && ok;
+}
+
+// the wav command's loop: first read aligns the file position, then whole chunks
+static uint32_t fat_play(const char* name, uint32_t chunk, bool align, uint32_t* sum, double* secs) {
+    static uint8_t raw[8192];
+    static uint32_t words[2][8192 + 1];
+    FIL fp;
+    wav_info_t info;
+    wav_stream_t s;
+    UINT got;
+    uint32_t frames = 0, ping = 0;
+
+    *sum = 0;
+    if (f_open(&fp, name, FA_READ) != FR_OK) {
+        return 0;
+    }
+    if (wav_parse(&info, fat_read_at, &fp, (uint32_t)f_size(&fp)) != WAV_OK) {
+        f_close(&fp);
+        return 0;
+    }
+    f_lseek(&fp, info.data_offset);
+    wav_stream_init(&s, &info);
+
+    ram_reads = ram_read_sectors = 0;
+    double t0 = now_s();
+    uint32_t pos = info.data_offset, left = info.data_size;
+    while (left) {
+        uint32_t len = align ? wav_read_len(pos, chunk, left) : (left < chunk ? left : chunk);
+        if (f_read(&fp, raw, len, &got) != FR_OK || got != len) {
+            break;
+        }
+        uint32_t n = wav_stream_feed(&s, raw, len, words[ping]);
+        for (uint32_t i = 0; i < n; i++) {
+            *sum = *sum * 31 + words[ping][i];
+        }
+        frames += n;
+        ping ^= 1;
+        pos += len;
+        left -= len;
+    }
+    *secs = now_s() - t0;
+    f_close(&fp);
+    return frames;
+}
+
+static void test_fatfs(void) {
+    static FATFS fs;
+    static uint8_t work[FF_MAX_SS];
+    const uint32_t frames = 44100 * 30; // 30 seconds of CD audio
+
+    ram_disk = calloc(RAM_SECTORS, RAM_SECTOR);
+    if (!ram_disk) {
+        CHECK(false, "RAM disk");
+        return;
+    }
+    MKFS_PARM opt = { FM_FAT | FM_SFD, 1, 0, 0, 16384 };
+    CHECK(f_mkfs("", &opt, work, sizeof(work)) == FR_OK, "mkfs on the RAM disk");
+    CHECK(f_mount(&fs, "", 1) == FR_OK, "mount the RAM disk");
+    CHECK(fat_make_wav("cd.wav", frames), "write a WAV file");
+
+    // reference: the same bytes converted in one go
+    static uint8_t pcm[4];
+    rng_state = 777;
+    wav_info_t info = { 0 };
+    info.channels = 2;
+    info.bits = 16;
+    info.block_align = 4;
+    uint32_t ref = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        uint32_t w;
+        for (int b = 0; b < 4; b++) {
+            pcm[b] = (uint8_t)rng();
+        }
+        wav_convert(&info, pcm, 1, &w);
+        ref = ref * 31 + w;
+    }
+
+    uint32_t sum;
+    double t_aligned, t_small;
+    uint32_t n = fat_play("cd.wav", 8192, true, &sum, &t_aligned);
+    uint32_t reads_aligned = ram_reads, sectors_aligned = ram_read_sectors;
+    CHECK(n == frames && sum == ref, "aligned 8KB reads play every frame");
+
+    n = fat_play("cd.wav", 2000, false, &sum, &t_small);
+    uint32_t reads_small = ram_reads, sectors_small = ram_read_sectors;
+    CHECK(n == frames && sum == ref, "2000 byte reads play every frame");
+    CHECK(reads_aligned * 8 < reads_small, "aligned reads use multi-sector disk reads");
+
+    double mb = frames * 4.0 / 1e6;
+    printf("RAM FatFs, 8192 byte aligned reads: %6u disk reads, %6u sectors, %.0f MB/s, %.0fx realtime\n",
+           reads_aligned,
+           sectors_aligned,
+           mb / t_aligned,
+           30.0 / t_aligned);
+    printf("RAM FatFs, 2000 byte reads:         %6u disk reads, %6u sectors, %.0f MB/s, %.0fx realtime\n",
+           reads_small,
+           sectors_small,
+           mb / t_small,
+           30.0 / t_small);
+
+    f_mount(NULL, "", 0);
+    free(ram_disk);
+}
+
+int main(void) {
+    printf("=== wav_stream tests ===\n\n");
+
+    test_parse();
+    test_parse_errors();
+    test_convert();
+    test_stream();
+    test_record();
+    test_read_len();
+    test_fatfs();
+
+    printf("\n%d/%d tests passed\n", tests_pass, tests_run);
+    return (tests_pass == tests_run) ? 0 : 1;
+}